@@ -0,0 +1,87 @@
+#!/usr/bin/python
+
+import os
+from glob import glob
+import argparse
+import shutil
+import throughput as tp
+
+class cd:
+    def __init__(self, newPath):
+        self.newPath = os.path.expanduser(newPath)
+
+    def __enter__(self):
+        self.savedPath = os.getcwd()
+        os.chdir(self.newPath)
+
+    def __exit__(self, etype, value, traceback):
+        os.chdir(self.savedPath)
+
+def CleanUp():
+    for f in glob("*.vtk"):
+        os.remove(f)
+    for f in glob("*.dat"):
+        os.remove(f)
+    for f in glob("profile.json"):
+        os.remove(f)
+
+# Throughput of the kernels using triangle residues and parameter vector, for
+# an executable storing these as arrays of structures (ASTRIX_SOA=0) and one
+# storing them as structure of arrays (ASTRIX_SOA=1), for every conservation
+# law. Both executables should be built with ASTRIX_TIMING=1 and copied, for
+# example to bin/astrix-cpu-aos and bin/astrix-cpu-soa. Use -d to run on the
+# device with executables built by 'make'.
+parser = argparse.ArgumentParser()
+parser.add_argument("directory")
+parser.add_argument("aos")
+parser.add_argument("soa")
+parser.add_argument("-d", "--device", action='store_true')
+parser.add_argument("-n", "--threads", default='1')
+parser.add_argument("-r", "--resolution", default='128')
+parser.add_argument("-t", "--time", default='0.05')
+args = parser.parse_args()
+
+direc = os.path.abspath(args.directory)
+binaries = [os.path.abspath(args.aos), os.path.abspath(args.soa)]
+
+device = 'host'
+extraArgs = ["-t", args.threads]
+if args.device:
+    device = 'device'
+    extraArgs = ["-d"]
+
+# Kernels to report for fusedResidualFlag 0 and 1
+regions = [['0', ['Param', 'CalcResidual', 'CalcTotalResNtot',
+                  'CalcTotalResLDA', 'AddResidual']],
+           ['1', ['CalcResidualFused', 'CalcTotalResNtot',
+                  'CalcTotalResLDA', 'AddResidual']]]
+
+timing = []
+for cl, problemDir in tp.problems:
+    with cd(direc + '/' + problemDir):
+        # Keep original input file, restored after benchmark
+        shutil.copyfile('astrix.in', 'astrix.in.orig')
+
+        for fused, fusedRegions in regions:
+            eps = []
+            for binary in binaries:
+                eps.append(tp.RunThroughput([binary, "-cl", cl] + extraArgs +
+                                            ["astrix.in"],
+                                            args.resolution, args.time,
+                                            [['fusedResidualFlag', fused]],
+                                            fusedRegions, device))
+                CleanUp()
+
+            for r in fusedRegions:
+                if r in eps[0] and r in eps[1]:
+                    timing.append([cl, fused, r, eps[0][r], eps[1][r]])
+
+        shutil.move('astrix.in.orig', 'astrix.in')
+
+print("{:>10} {:>5} {:>18} {:>14} {:>14} {:>8}".format("law", "fused",
+                                                       "kernel", "AoS el/s",
+                                                       "SoA el/s", "speedup"))
+for cl, fused, r, t0, t1 in timing:
+    print("{:>10} {:>5} {:>18} {:>14.4g} {:>14.4g} {:>8.2f}".format(cl, fused,
+                                                                   r, t0, t1,
+                                                                   t1/t0))
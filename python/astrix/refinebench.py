@@ -0,0 +1,77 @@
+#!/usr/bin/python
+
+import os
+from glob import glob
+import argparse
+import shutil
+import subprocess
+import parameterfile as pf
+
+class cd:
+    def __init__(self, newPath):
+        self.newPath = os.path.expanduser(newPath)
+
+    def __enter__(self):
+        self.savedPath = os.getcwd()
+        os.chdir(self.newPath)
+
+    def __exit__(self, etype, value, traceback):
+        os.chdir(self.savedPath)
+
+def CleanUp():
+    for f in glob("*.vtk"):
+        os.remove(f)
+    for f in glob("*.dat"):
+        os.remove(f)
+
+def VerticesPerSecond(output):
+    """Extract number of vertices inserted per second from Astrix output
+
+    :param output: Standard output of an Astrix run with -v 1.
+
+    :type output: string
+    """
+    for line in output.splitlines():
+        if line.startswith("Refine:") and "vertices/s" in line:
+            return float(line.split(',')[1].split()[0])
+    return float('nan')
+
+# Host thread scaling of mesh refinement: builds the initial mesh of the
+# Kelvin-Helmholtz test at high resolution without taking any time steps
+parser = argparse.ArgumentParser()
+parser.add_argument("directory")
+parser.add_argument("-n", "--maxthreads", type=int, default=8)
+parser.add_argument("-r", "--resolution", default='1500')
+args = parser.parse_args()
+
+direc = os.path.abspath(args.directory)
+
+with cd(direc + '/run/euler/kh'):
+    # Keep original input file, restored after benchmark
+    shutil.copyfile('astrix.in', 'astrix.in.orig')
+    pf.ChangeParameter('./astrix.in', [['equivalentPointsX', args.resolution],
+                                       ['maxSimulationTime', '0.0'],
+                                       ['writeVTK', '0']])
+
+    threads = []
+    t = 1
+    while t <= args.maxthreads:
+        threads.append(t)
+        t = 2*t
+
+    rate = []
+    for n in threads:
+        output = subprocess.check_output([direc + "/bin/astrix-cpu",
+                                          "-v", "1", "-t", str(n),
+                                          "astrix.in"])
+        rate.append(VerticesPerSecond(output.decode()))
+        CleanUp()
+
+    shutil.move('astrix.in.orig', 'astrix.in')
+
+print("{:>8} {:>16} {:>10} {:>10}".format("threads", "vertices/s",
+                                           "speedup", "efficiency"))
+for n, r in zip(threads, rate):
+    print("{:>8d} {:>16.6g} {:>10.2f} {:>10.2f}".format(n, r,
+                                                        r/rate[0],
+                                                        r/(n*rate[0])))
@@ -0,0 +1,76 @@
+#!/usr/bin/python
+
+import os
+from glob import glob
+import argparse
+import shutil
+import subprocess
+import parameterfile as pf
+
+class cd:
+    def __init__(self, newPath):
+        self.newPath = os.path.expanduser(newPath)
+
+    def __enter__(self):
+        self.savedPath = os.getcwd()
+        os.chdir(self.newPath)
+
+    def __exit__(self, etype, value, traceback):
+        os.chdir(self.savedPath)
+
+def CleanUp():
+    for f in glob("*.vtk"):
+        os.remove(f)
+    for f in glob("*.dat"):
+        os.remove(f)
+
+def TimePerCell(output):
+    """Extract time per cell per time step (microseconds) from Astrix output
+
+    :param output: Standard output of an Astrix run.
+
+    :type output: string
+    """
+    for line in output.splitlines():
+        if line.startswith("Time/cell/step (mus):"):
+            return float(line.split(':')[1])
+    return float('nan')
+
+# Host thread scaling of the CPU-only build on the Kelvin-Helmholtz test
+parser = argparse.ArgumentParser()
+parser.add_argument("directory")
+parser.add_argument("-n", "--maxthreads", type=int, default=8)
+parser.add_argument("-r", "--resolution", default='256')
+parser.add_argument("-t", "--time", default='0.1')
+args = parser.parse_args()
+
+direc = os.path.abspath(args.directory)
+
+with cd(direc + '/run/euler/kh'):
+    # Keep original input file, restored after benchmark
+    shutil.copyfile('astrix.in', 'astrix.in.orig')
+    pf.ChangeParameter('./astrix.in', [['equivalentPointsX', args.resolution],
+                                       ['maxSimulationTime', args.time],
+                                       ['writeVTK', '0']])
+
+    threads = []
+    t = 1
+    while t <= args.maxthreads:
+        threads.append(t)
+        t = 2*t
+
+    timing = []
+    for n in threads:
+        output = subprocess.check_output([direc + "/bin/astrix-cpu",
+                                          "-t", str(n), "astrix.in"])
+        timing.append(TimePerCell(output.decode()))
+        CleanUp()
+
+    shutil.move('astrix.in.orig', 'astrix.in')
+
+print("{:>8} {:>16} {:>10} {:>10}".format("threads", "mus/cell/step",
+                                           "speedup", "efficiency"))
+for n, t in zip(threads, timing):
+    print("{:>8d} {:>16.4f} {:>10.2f} {:>10.2f}".format(n, t,
+                                                        timing[0]/t,
+                                                        timing[0]/(n*t)))
@@ -0,0 +1,74 @@
+#!/usr/bin/python
+
+import os
+from glob import glob
+import argparse
+import shutil
+import throughput as tp
+
+class cd:
+    def __init__(self, newPath):
+        self.newPath = os.path.expanduser(newPath)
+
+    def __enter__(self):
+        self.savedPath = os.getcwd()
+        os.chdir(self.newPath)
+
+    def __exit__(self, etype, value, traceback):
+        os.chdir(self.savedPath)
+
+def CleanUp():
+    for f in glob("*.vtk"):
+        os.remove(f)
+    for f in glob("*.dat"):
+        os.remove(f)
+    for f in glob("profile.json"):
+        os.remove(f)
+
+# Throughput of the host residual loops over triangles, one triangle at a
+# time (hostSimdFlag 0) and vectorised over triangles (hostSimdFlag 1), for
+# every conservation law. Requires a CPU-only build with ASTRIX_TIMING=1, and
+# ASTRIX_NATIVE=1 to use the vector instructions of the build machine.
+parser = argparse.ArgumentParser()
+parser.add_argument("directory")
+parser.add_argument("-n", "--threads", default='1')
+parser.add_argument("-r", "--resolution", default='128')
+parser.add_argument("-t", "--time", default='0.05')
+args = parser.parse_args()
+
+direc = os.path.abspath(args.directory)
+
+# Kernels to report for fusedResidualFlag 0 and 1
+regions = [['0', ['CalcResidual', 'CalcTotalResNtot', 'CalcTotalResLDA']],
+           ['1', ['CalcResidualFused']]]
+
+timing = []
+for cl, problemDir in tp.problems:
+    with cd(direc + '/' + problemDir):
+        # Keep original input file, restored after benchmark
+        shutil.copyfile('astrix.in', 'astrix.in.orig')
+
+        for fused, fusedRegions in regions:
+            tps = []
+            for simd in ['0', '1']:
+                tps.append(tp.RunThroughput([direc + "/bin/astrix-cpu",
+                                             "-cl", cl, "-t", args.threads,
+                                             "astrix.in"],
+                                            args.resolution, args.time,
+                                            [['fusedResidualFlag', fused],
+                                             ['hostSimdFlag', simd]],
+                                            fusedRegions, 'host'))
+                CleanUp()
+
+            for r in fusedRegions:
+                if r in tps[0] and r in tps[1]:
+                    timing.append([cl, r, tps[0][r], tps[1][r]])
+
+        shutil.move('astrix.in.orig', 'astrix.in')
+
+print("{:>10} {:>18} {:>14} {:>14} {:>8}".format("law", "kernel",
+                                                 "scalar tri/s",
+                                                 "simd tri/s", "speedup"))
+for cl, r, t0, t1 in timing:
+    print("{:>10} {:>18} {:>14.4g} {:>14.4g} {:>8.2f}".format(cl, r, t0, t1,
+                                                             t1/t0))
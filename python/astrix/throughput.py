@@ -0,0 +1,58 @@
+#!/usr/bin/python
+
+import json
+import subprocess
+import parameterfile as pf
+
+# Problems used for throughput benchmarks: conservation law and directory
+problems = [['cart_euler', 'run/euler/kh'],
+            ['cart_iso', 'run/euler/linear'],
+            ['advect', 'run/scalar/advect/vortex'],
+            ['burgers', 'run/scalar/burgers/vortex']]
+
+def ElementsPerSecond(profileFile, regions, device):
+    """Extract throughput (elements per second) from Astrix profile
+
+    :param profileFile: Profile written by Astrix compiled with ASTRIX_TIMING=1.
+    :param regions: Names of profiled regions to consider.
+    :param device: Consider regions run on 'host' or 'device'.
+
+    :type profileFile: string
+    :type regions: list of strings
+    :type device: string
+    """
+    with open(profileFile) as f:
+        profile = json.load(f)
+
+    result = {}
+    for r in profile['regions']:
+        if r['device'] == device and r['name'] in regions and r['totalTime'] > 0.0:
+            result[r['name']] = 1.0e3*r['elements']/r['totalTime']
+    return result
+
+def RunThroughput(command, resolution, time, parameter, regions, device):
+    """Run Astrix on a static mesh in the current directory and extract throughput
+
+    Edits astrix.in in the current directory to use a static mesh of the given resolution without VTK output, runs command and returns the throughput of the profiled regions.
+
+    :param command: Command line to run Astrix, including input file.
+    :param resolution: Value for equivalentPointsX.
+    :param time: Value for maxSimulationTime.
+    :param parameter: List of pairs of strings [parameterName, parameterValue] to change in addition.
+    :param regions: Names of profiled regions to consider.
+    :param device: Consider regions run on 'host' or 'device'.
+
+    :type command: list of strings
+    :type resolution: string
+    :type time: string
+    :type parameter: List of string pairs
+    :type regions: list of strings
+    :type device: string
+    """
+    pf.ChangeParameter('./astrix.in',
+                       [['equivalentPointsX', resolution],
+                        ['maxSimulationTime', time],
+                        ['adaptiveMeshFlag', '0'],
+                        ['writeVTK', '0']] + parameter)
+    subprocess.check_output(command)
+    return ElementsPerSecond('profile.json', regions, device)
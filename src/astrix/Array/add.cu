@@ -14,7 +14,7 @@ Astrix is distributed in the hope that it will be useful, but WITHOUT ANY WARRAN
 You should have received a copy of the GNU General Public License
 along with Astrix.  If not, see <http://www.gnu.org/licenses/>.
 */
-#include <cuda_runtime_api.h>
+#include "../Common/cudaRuntime.h"
 
 #include "./array.h"
 #include "../Common/cudaLow.h"
@@ -31,7 +31,7 @@ __global__ void
 devAddValue(unsigned int startIndex, unsigned int endIndex,
             T *data, T value)
 {
-  int i = blockIdx.x*blockDim.x + threadIdx.x + startIndex;
+  unsigned int i = blockIdx.x*blockDim.x + threadIdx.x + startIndex;
 
   while (i < endIndex) {
     data[i] += value;
@@ -59,7 +59,8 @@ void Array<T>::AddValue(T value, unsigned int startIndex,
                                        devAddValue<T>,
                                        (size_t) 0, 0);
 
-    devAddValue<<<nBlocks, nThreads>>>(startIndex, endIndex, deviceVec, value);
+    LaunchKernel(nBlocks, nThreads, devAddValue)
+      (startIndex, endIndex, deviceVec, value);
     gpuErrchk(cudaPeekAtLastError());
     gpuErrchk(cudaDeviceSynchronize());
   } else {
@@ -35,10 +35,12 @@ Array<T>::Array()
   hostVec = 0;
   deviceVec = 0;
   size = 0;
-  realSize = dynArrayStep;
+  realSize = PhysicalSize(size);
+  nComponent = 1;
 
   // Allocate initial memory
-  hostVec = (T *)malloc(nDims*realSize*sizeof(T));
+  hostVec = (T *)ArrayPool::Allocate(nDims*realSize*sizeof(T), 0);
+  nAllocationHost++;
   memAllocatedHost += nDims*realSize*sizeof(T);
 }
 
@@ -56,15 +58,17 @@ Array<T>::Array(unsigned int _nDims, int _cudaFlag)
   hostVec = 0;
   deviceVec = 0;
   size = 0;
-  realSize = dynArrayStep;
+  realSize = PhysicalSize(size);
+  nComponent = 1;
 
   // Allocate initial memory
-  hostVec = (T *)malloc(nDims*realSize*sizeof(T));
+  hostVec = (T *)ArrayPool::Allocate(nDims*realSize*sizeof(T), 0);
+  nAllocationHost++;
   memAllocatedHost += nDims*realSize*sizeof(T);
 
   if (cudaFlag == 1) {
-    gpuErrchk(cudaMalloc(reinterpret_cast<void**>(&deviceVec),
-                         nDims*realSize*sizeof(T)));
+    deviceVec = (T *)ArrayPool::Allocate(nDims*realSize*sizeof(T), 1);
+    nAllocationDevice++;
     memAllocatedDevice += nDims*realSize*sizeof(T);
   }
 }
@@ -84,15 +88,17 @@ Array<T>::Array(unsigned int _nDims,
   hostVec = 0;
   deviceVec = 0;
   size = _size;
-  realSize = ((size + dynArrayStep)/dynArrayStep)*dynArrayStep;
+  realSize = PhysicalSize(size);
+  nComponent = 1;
 
   // Allocate initial memory
-  hostVec = (T *)malloc(nDims*realSize*sizeof(T));
+  hostVec = (T *)ArrayPool::Allocate(nDims*realSize*sizeof(T), 0);
+  nAllocationHost++;
   memAllocatedHost += nDims*realSize*sizeof(T);
 
   if (cudaFlag == 1) {
-    gpuErrchk(cudaMalloc(reinterpret_cast<void**>(&deviceVec),
-                         nDims*realSize*sizeof(T)));
+    deviceVec = (T *)ArrayPool::Allocate(nDims*realSize*sizeof(T), 1);
+    nAllocationDevice++;
     memAllocatedDevice += nDims*realSize*sizeof(T);
   }
 }
@@ -112,15 +118,17 @@ Array<T>::Array(unsigned int _nDims, int _cudaFlag,
   hostVec = 0;
   deviceVec = 0;
   size = _size;
-  realSize = ((size + dynArrayStep)/dynArrayStep)*dynArrayStep;
+  realSize = PhysicalSize(size);
+  nComponent = 1;
 
   // Allocate initial memory
-  hostVec = (T *)malloc(nDims*realSize*sizeof(T));
+  hostVec = (T *)ArrayPool::Allocate(nDims*realSize*sizeof(T), 0);
+  nAllocationHost++;
   memAllocatedHost += nDims*realSize*sizeof(T);
 
   if (cudaFlag == 1) {
-    gpuErrchk(cudaMalloc(reinterpret_cast<void**>(&deviceVec),
-                         nDims*realSize*sizeof(T)));
+    deviceVec = (T *)ArrayPool::Allocate(nDims*realSize*sizeof(T), 1);
+    nAllocationDevice++;
     memAllocatedDevice += nDims*realSize*sizeof(T);
   }
 }
@@ -133,12 +141,12 @@ template <class T>
 Array<T>::~Array()
 {
   // Free host memory
-  free(hostVec);
+  ArrayPool::Free(hostVec, 0);
   memAllocatedHost -= nDims*realSize*sizeof(T);
 
   if (cudaFlag == 1) {
     // Free device memory
-    gpuErrchk(cudaFree(deviceVec));
+    ArrayPool::Free(deviceVec, 1);
     memAllocatedDevice -= nDims*realSize*sizeof(T);
   }
 }
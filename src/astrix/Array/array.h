@@ -16,8 +16,14 @@ along with Astrix.  If not, see <http://www.gnu.org/licenses/>.
 #ifndef ASTRIX_ARRAY_H
 #define ASTRIX_ARRAY_H
 
+#ifndef CPU_ASTRIX
 #include <thrust/host_vector.h>
 #include <thrust/device_vector.h>
+#endif
+#include <cstdint>
+
+#include "../Common/cudaRuntime.h"
+#include "./pool.h"
 
 namespace astrix {
 
@@ -60,6 +66,10 @@ template <class T> class Array
   static int64_t memAllocatedHost;
   //! Total amount of memory (bytes) allocated on device in all Array's
   static int64_t memAllocatedDevice;
+  //! Total number of host allocations (malloc and realloc) in all Array's
+  static int64_t nAllocationHost;
+  //! Total number of device allocations (cudaMalloc) in all Array's
+  static int64_t nAllocationDevice;
 
   //! Transform from host vector to device vector
   void TransformToDevice();
@@ -74,6 +84,12 @@ template <class T> class Array
   unsigned int GetRealSize() const;
   //! Return number of dimensions
   unsigned int GetDimension() const;
+  //! Store the \a _nComponent components of every element contiguously
+  /*! Component c of element i of dimension n is then found at component c*realSize + i from GetPointer(n), i.e. the Array is a structure of arrays. Only SetSize() and SetEqual(const Array*) take this layout into account; all other operations treat every element as a single T.
+    \param _nComponent Number of components, each of size sizeof(T)/_nComponent*/
+  void SetComponentLayout(unsigned int _nComponent) { nComponent = _nComponent; }
+  //! Return number of components stored contiguously (1 if elements are stored whole)
+  unsigned int GetComponentLayout() const { return nComponent; }
   //! Set size of Array on host
   void SetSizeHost(unsigned int _size);
   //! Set size of Array on device
@@ -131,10 +147,10 @@ template <class T> class Array
 
   //! Sort array, together with \a arrayB
   void Sort(Array<T> *arrayB);
-  //! Create index array for sorting
+  //! Create index array for sorting; stable, on host and device
   template<class S>
     void SortByKey(Array<S> *indexArray);
-  //! Create index array for sorting dimension N
+  //! Create index array for sorting first N elements; stable, on host and device
   template<class S>
     void SortByKey(Array<S> *indexArray, unsigned int N);
 
@@ -242,9 +258,12 @@ template <class T> class Array
   //! Size of array
   unsigned int size;
   //! Physical size of array (larger than \a size because of \a dynArrayStep)
+  /*! Depends on the history of SetSize() calls, so two Arrays of equal size can have different physical sizes: operations involving multi-dimensional Arrays must use the physical size of every Array.*/
   unsigned int realSize;
   //! Number of dimensions of array
   unsigned int nDims;
+  //! Number of components of every element stored contiguously, see SetComponentLayout()
+  unsigned int nComponent;
   //! Flag whether to use device memory or host memory
   int cudaFlag;
 
@@ -252,12 +271,26 @@ template <class T> class Array
   T *hostVec;
   //! Pointer to device memory
   T *deviceVec;
+
+  //! Physical size needed for \a _size elements
+  /*! Round \a _size up to a multiple of \a dynArrayStep, and further up so that all \a nDims dimensions fill the block handed out by ArrayPool.
+    \param _size Number of elements per dimension*/
+  unsigned int PhysicalSize(unsigned int _size) const
+  {
+    unsigned int minSize = ((_size + dynArrayStep)/dynArrayStep)*dynArrayStep;
+    std::size_t elementSize = nDims*sizeof(T);
+    return ArrayPool::BlockSize(minSize*elementSize)/elementSize;
+  }
 };
 
 template <typename T>
 int64_t Array<T>::memAllocatedHost = 0;
 template <typename T>
 int64_t Array<T>::memAllocatedDevice = 0;
+template <typename T>
+int64_t Array<T>::nAllocationHost = 0;
+template <typename T>
+int64_t Array<T>::nAllocationDevice = 0;
 
 }  // namespace astrix
 #endif
@@ -14,9 +14,12 @@ Astrix is distributed in the hope that it will be useful, but WITHOUT ANY WARRAN
 You should have received a copy of the GNU General Public License
 along with Astrix.  If not, see <http://www.gnu.org/licenses/>.
 */
+#ifndef CPU_ASTRIX
 #include <thrust/remove.h>
 #include <thrust/distance.h>
 #include <thrust/device_vector.h>
+#endif
+#include <algorithm>
 
 #include "./array.h"
 #include "../Common/cudaLow.h"
@@ -32,6 +35,7 @@ int Array<T>::RemoveValue(T value)
 {
   int newSize = 0;
 
+#ifndef CPU_ASTRIX
   if (cudaFlag == 1) {
     thrust::device_ptr<T> dev_ptr(deviceVec);
     thrust::device_ptr<T> iter;
@@ -40,8 +44,9 @@ int Array<T>::RemoveValue(T value)
 
     newSize = iter - dev_ptr;
   }
+#endif
   if (cudaFlag == 0) {
-    int *iter = thrust::remove(hostVec, hostVec + size, value);
+    T *iter = std::remove(hostVec, hostVec + size, value);
     newSize = iter - hostVec;
   }
 
@@ -57,6 +62,7 @@ int Array<T>::RemoveValue(T value, int maxIndex)
 {
   int newSize = 0;
 
+#ifndef CPU_ASTRIX
   if (cudaFlag == 1) {
     thrust::device_ptr<T> dev_ptr(deviceVec);
     thrust::device_ptr<T> iter;
@@ -65,8 +71,9 @@ int Array<T>::RemoveValue(T value, int maxIndex)
 
     newSize = iter - dev_ptr;
   }
+#endif
   if (cudaFlag == 0) {
-    int *iter = thrust::remove(hostVec, hostVec + maxIndex, value);
+    T *iter = std::remove(hostVec, hostVec + maxIndex, value);
     newSize = iter - hostVec;
   }
 
@@ -87,7 +94,7 @@ devCompact(int N, T *destArray, T *srcArray,
 
   while (i < N) {
     if (keepFlag[i] == 1) {
-      for (unsigned int n = 0; n < nDims; n++)
+      for (int n = 0; n < nDims; n++)
         destArray[keepFlagScan[i] + n*realSize] = srcArray[i + n*realSize];
     }
     i += gridDim.x*blockDim.x;
@@ -115,25 +122,26 @@ void Array<T>::Compact(int nKeep,
                                        devCompact<T>,
                                        (size_t) 0, 0);
 
-    T *temp;
-    gpuErrchk(cudaMalloc(reinterpret_cast<void**>(&temp),
-                         nDims*realSize*sizeof(T)));
+    T *temp = (T *)ArrayPool::Allocate(nDims*realSize*sizeof(T), 1);
+    nAllocationDevice++;
     gpuErrchk(cudaMemcpy(temp, deviceVec,
                          nDims*realSize*sizeof(T),
                          cudaMemcpyDeviceToDevice));
 
-    devCompact<<<nBlocks, nThreads>>>(size, deviceVec, temp,
-                                      pKeepFlag, pKeepFlagScan,
-                                      realSize, nDims);
+    LaunchKernel(nBlocks, nThreads, devCompact)
+      (size, deviceVec, temp,
+       pKeepFlag, pKeepFlagScan,
+       realSize, nDims);
     gpuErrchk( cudaPeekAtLastError() );
     gpuErrchk( cudaDeviceSynchronize() );
 
-    gpuErrchk(cudaFree(temp));
+    ArrayPool::Free(temp, 1);
   }
 
   if (cudaFlag == 0) {
     // Temporary array
-    T *temp = (T *)malloc(nDims*realSize*sizeof(T));
+    T *temp = (T *)ArrayPool::Allocate(nDims*realSize*sizeof(T), 0);
+    nAllocationHost++;
     memcpy(temp, hostVec, nDims*realSize*sizeof(T));
 
     for (unsigned int n = 0; n < nDims; n++)
@@ -141,7 +149,7 @@ void Array<T>::Compact(int nKeep,
         if (pKeepFlag[i] == 1)
           hostVec[pKeepFlagScan[i] + n*realSize] = temp[i + n*realSize];
 
-    free(temp);
+    ArrayPool::Free(temp, 0);
   }
 
   SetSize(nKeep);
@@ -32,7 +32,7 @@ devSetToDiff(int N, T *array, T *pA, T *pB, int realSize, int nDims,
   int i = blockIdx.x*blockDim.x + threadIdx.x;
 
   while (i < N) {
-    for (unsigned int n = 0; n < nDims; n++)
+    for (int n = 0; n < nDims; n++)
       array[i + n*realSize] = pA[i + n*rSA] - pB[i + n*rSB];
     i += gridDim.x*blockDim.x;
   }
@@ -61,8 +61,9 @@ void Array<T>::SetToDiff(Array<T> *A, Array<T> *B)
                                        devSetToDiff<T>,
                                        (size_t) 0, 0);
 
-    devSetToDiff<<<nBlocks, nThreads>>>(size, deviceVec, pA, pB,
-                                        realSize, nDims, rSA, rSB);
+    LaunchKernel(nBlocks, nThreads, devSetToDiff)
+      (size, deviceVec, pA, pB,
+       realSize, nDims, rSA, rSB);
     gpuErrchk( cudaPeekAtLastError() );
     gpuErrchk( cudaDeviceSynchronize() );
   }
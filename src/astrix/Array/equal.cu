@@ -15,6 +15,7 @@ You should have received a copy of the GNU General Public License
 along with Astrix.  If not, see <http://www.gnu.org/licenses/>.
 */
 #include <iostream>
+#include <stdexcept>
 
 #include "./array.h"
 #include "../Common/cudaLow.h"
@@ -28,14 +29,33 @@ namespace astrix {
 template <class T>
 void Array<T>::SetEqual(const Array *B)
 {
-  if (cudaFlag == 1)
-    gpuErrchk(cudaMemcpy(deviceVec, B->GetDevicePointer(),
-                         nDims*realSize*sizeof(T),
-                         cudaMemcpyDeviceToDevice));
+  if (B->GetComponentLayout() != nComponent) {
+    std::cout << "Error in Array::SetEqual: layouts differ" << std::endl;
+    throw std::runtime_error("");
+  }
+
+  // Physical sizes of this Array and B may differ: copy every dimension,
+  // and every component in case of a structure of arrays
+  std::size_t componentSize = sizeof(T)/nComponent;
+  unsigned int realSizeB = B->realSize;
+
+  if (cudaFlag == 1) {
+    for (unsigned int i = 0; i < nDims; i++)
+      for (unsigned int c = 0; c < nComponent; c++)
+        gpuErrchk(cudaMemcpy((char *) GetDevicePointer(i) +
+                             c*realSize*componentSize,
+                             (char *) B->GetDevicePointer(i) +
+                             c*realSizeB*componentSize,
+                             size*componentSize,
+                             cudaMemcpyDeviceToDevice));
+  }
 
   if (cudaFlag == 0) {
     for (unsigned int i = 0; i < nDims; i++)
-      memcpy(GetHostPointer(i), B->GetHostPointer(i), size*sizeof(T));
+      for (unsigned int c = 0; c < nComponent; c++)
+        memcpy((char *) GetHostPointer(i) + c*realSize*componentSize,
+               (char *) B->GetHostPointer(i) + c*realSizeB*componentSize,
+               size*componentSize);
   }
 }
 
@@ -79,8 +99,9 @@ void Array<T>::SetEqualComb(const Array<S> *B, unsigned int N, unsigned int M)
                                        devSetEqualComb<T, S>,
                                        (size_t) 0, 0);
 
-    devSetEqualComb<<<nBlocks, nThreads>>>(size, deviceVec, pB,
-                                                  realSize, N, M);
+    LaunchKernel(nBlocks, nThreads, devSetEqualComb)
+      (size, deviceVec, pB,
+       realSize, N, M);
 
     gpuErrchk( cudaPeekAtLastError() );
     gpuErrchk( cudaDeviceSynchronize() );
@@ -107,7 +128,7 @@ void Array<T>::SetEqual(const Array<T> *B, unsigned int N, unsigned int M)
 {
   if (cudaFlag == 1)
     gpuErrchk(cudaMemcpy(GetDevicePointer(N), B->GetDevicePointer(M),
-                         realSize*sizeof(T),
+                         size*sizeof(T),
                          cudaMemcpyDeviceToDevice));
 
   if (cudaFlag == 0)
@@ -186,6 +207,10 @@ template void Array<int>::Concat(Array *A);
 template void Array<unsigned int>::SetEqual(const Array *B);
 template void Array<unsigned int>::SetEqual(const Array *B, int startPosition);
 
+//###################################################
+
+template void Array<int3>::SetEqual(const Array *B);
+
 template void Array<float>::SetEqualComb(const Array<float2> *B,
                                          unsigned int N, unsigned int M);
 template void Array<float2>::SetEqual(const Array *B);
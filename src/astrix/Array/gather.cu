@@ -57,7 +57,8 @@ void Array<T>::GatherIf(Array<T> *in, Array<int> *map, int value, int maxIndex)
                                        devGatherIf<T>,
                                        (size_t) 0, 0);
 
-    devGatherIf<<<nBlocks, nThreads>>>(deviceVec, pIn, pMap, value, maxIndex);
+    LaunchKernel(nBlocks, nThreads, devGatherIf)
+      (deviceVec, pIn, pMap, value, maxIndex);
     gpuErrchk(cudaPeekAtLastError());
     gpuErrchk(cudaDeviceSynchronize());
   } else {
@@ -103,7 +104,8 @@ void Array<T>::Gather(Array<T> *in, Array<int> *map, int maxIndex)
                                        devGather<T>,
                                        (size_t) 0, 0);
 
-    devGather<<<nBlocks, nThreads>>>(deviceVec, pIn, pMap, maxIndex);
+    LaunchKernel(nBlocks, nThreads, devGather)
+      (deviceVec, pIn, pMap, maxIndex);
     gpuErrchk(cudaPeekAtLastError());
     gpuErrchk(cudaDeviceSynchronize());
   } else {
@@ -148,7 +150,8 @@ void Array<T>::Scatter(Array<T> *in, Array<int> *map, int maxIndex)
                                        devScatter<T>,
                                        (size_t) 0, 0);
 
-    devScatter<<<nBlocks, nThreads>>>(deviceVec, pIn, pMap, maxIndex);
+    LaunchKernel(nBlocks, nThreads, devScatter)
+      (deviceVec, pIn, pMap, maxIndex);
     gpuErrchk(cudaPeekAtLastError());
     gpuErrchk(cudaDeviceSynchronize());
   } else {
@@ -197,8 +200,9 @@ void Array<T>::ScatterSeries(Array<S> *map, unsigned int maxIndex)
                                        devScatterSeries<T, S>,
                                        (size_t) 0, 0);
 
-    devScatterSeries<<<nBlocks, nThreads>>>(deviceVec, pMap, maxIndex,
-                                            mapDim, mapRS);
+    LaunchKernel(nBlocks, nThreads, devScatterSeries)
+      (deviceVec, pMap, maxIndex,
+       mapDim, mapRS);
     gpuErrchk(cudaPeekAtLastError());
     gpuErrchk(cudaDeviceSynchronize());
   } else {
@@ -14,9 +14,12 @@ Astrix is distributed in the hope that it will be useful, but WITHOUT ANY WARRAN
 You should have received a copy of the GNU General Public License
 along with Astrix.  If not, see <http://www.gnu.org/licenses/>.
 */
+#ifndef CPU_ASTRIX
 #include <thrust/host_vector.h>
 #include <thrust/device_vector.h>
 #include <thrust/inner_product.h>
+#endif
+#include <numeric>
 #include <iostream>
 
 #include "./array.h"
@@ -35,14 +38,16 @@ T Array<T>::InnerProduct(Array<T> *A)
 
   T *pA = A->GetPointer();
 
+#ifndef CPU_ASTRIX
   if (cudaFlag == 1) {
     thrust::device_ptr<T> dev_ptr(deviceVec);
     thrust::device_ptr<T> dev_ptrA(&(pA[0]));
 
     result = thrust::inner_product(dev_ptrA, dev_ptrA + size, dev_ptr, (T) 0.0);
   }
+#endif
   if (cudaFlag == 0) {
-    result = thrust::inner_product(pA, pA + size, hostVec, (T) 0.0);
+    result = std::inner_product(pA, pA + size, hostVec, (T) 0.0);
   }
 
   return result;
@@ -27,7 +27,7 @@ template<class T>
 __global__ void
 devInvert(int N, T *array, int realSize, int nDims)
 {
-  unsigned int i = blockIdx.x*blockDim.x + threadIdx.x;
+  int i = blockIdx.x*blockDim.x + threadIdx.x;
 
   while (i < N) {
     for (int n = 0; n < nDims; n++) {
@@ -56,8 +56,9 @@ void Array<T>::Invert()
                                        devInvert<T>,
                                        (size_t) 0, 0);
 
-    devInvert<<<nBlocks, nThreads>>>(size, deviceVec,
-                                     realSize, nDims);
+    LaunchKernel(nBlocks, nThreads, devInvert)
+      (size, deviceVec,
+       realSize, nDims);
     gpuErrchk( cudaPeekAtLastError() );
     gpuErrchk( cudaDeviceSynchronize() );
   }
@@ -26,14 +26,14 @@ namespace astrix {
 template<class T>
 __global__ void
 devLinComb1(int N, int nDims, int realSize, T *pA,
-           T a1, T *pA1)
+            T a1, T *pA1, int rS1)
 {
   for (int n = 0; n < nDims; n++) {
-    unsigned int i = blockIdx.x*blockDim.x + threadIdx.x;
+    int i = blockIdx.x*blockDim.x + threadIdx.x;
 
     while (i < N) {
       pA[i + n*realSize] =
-        a1*pA1[i + n*realSize];
+        a1*pA1[i + n*rS1];
 
       i += gridDim.x*blockDim.x;
     }
@@ -47,16 +47,16 @@ devLinComb1(int N, int nDims, int realSize, T *pA,
 template<class T>
 __global__ void
 devLinComb2(int N, int nDims, int realSize, T *pA,
-            T a1, T *pA1,
-            T a2, T *pA2)
+            T a1, T *pA1, int rS1,
+            T a2, T *pA2, int rS2)
 {
   for (int n = 0; n < nDims; n++) {
-    unsigned int i = blockIdx.x*blockDim.x + threadIdx.x;
+    int i = blockIdx.x*blockDim.x + threadIdx.x;
 
     while (i < N) {
       pA[i + n*realSize] =
-        a1*pA1[i + n*realSize] +
-        a2*pA1[i + n*realSize];
+        a1*pA1[i + n*rS1] +
+        a2*pA2[i + n*rS2];
 
       i += gridDim.x*blockDim.x;
     }
@@ -70,45 +70,18 @@ devLinComb2(int N, int nDims, int realSize, T *pA,
 template<class T>
 __global__ void
 devLinComb3(int N, int nDims, int realSize, T *pA,
-            T a1, T *pA1,
-            T a2, T *pA2,
-            T a3, T *pA3)
+            T a1, T *pA1, int rS1,
+            T a2, T *pA2, int rS2,
+            T a3, T *pA3, int rS3)
 {
   for (int n = 0; n < nDims; n++) {
-    unsigned int i = blockIdx.x*blockDim.x + threadIdx.x;
+    int i = blockIdx.x*blockDim.x + threadIdx.x;
 
     while (i < N) {
       pA[i + n*realSize] =
-        a1*pA1[i + n*realSize] +
-        a2*pA2[i + n*realSize] +
-        a3*pA3[i + n*realSize];
-
-      i += gridDim.x*blockDim.x;
-    }
-  }
-}
-
-//######################################################################
-//
-//######################################################################
-
-template<class T>
-__global__ void
-devLinComb4(int N, int nDims, int realSize, T *pA,
-            T a1, T *pA1,
-            T a2, T *pA2,
-            T a3, T *pA3,
-            T a4, T *pA4)
-{
-  for (int n = 0; n < nDims; n++) {
-    unsigned int i = blockIdx.x*blockDim.x + threadIdx.x;
-
-    while (i < N) {
-      pA[i + n*realSize] =
-        a1*pA1[i + n*realSize] +
-        a2*pA2[i + n*realSize] +
-        a3*pA3[i + n*realSize] +
-        a4*pA4[i + n*realSize];
+        a1*pA1[i + n*rS1] +
+        a2*pA2[i + n*rS2] +
+        a3*pA3[i + n*rS3];
 
       i += gridDim.x*blockDim.x;
     }
@@ -133,8 +106,9 @@ void Array<T>::LinComb(T a1, Array<T> *A1)
                                        devLinComb1<T>,
                                        (size_t) 0, 0);
 
-    devLinComb1<<<nBlocks, nThreads>>>(size, nDims, realSize, deviceVec,
-                                       a1, pA1);
+    LaunchKernel(nBlocks, nThreads, devLinComb1)
+      (size, nDims, realSize, deviceVec,
+       a1, pA1, A1->GetRealSize());
     gpuErrchk( cudaPeekAtLastError() );
     gpuErrchk( cudaDeviceSynchronize() );
   }
@@ -169,9 +143,10 @@ void Array<T>::LinComb(T a1, Array<T> *A1,
                                        devLinComb2<T>,
                                        (size_t) 0, 0);
 
-    devLinComb2<<<nBlocks, nThreads>>>(size, nDims, realSize, deviceVec,
-                                       a1, pA1,
-                                       a2, pA2);
+    LaunchKernel(nBlocks, nThreads, devLinComb2)
+      (size, nDims, realSize, deviceVec,
+       a1, pA1, A1->GetRealSize(),
+       a2, pA2, A2->GetRealSize());
     gpuErrchk( cudaPeekAtLastError() );
     gpuErrchk( cudaDeviceSynchronize() );
   }
@@ -210,10 +185,11 @@ void Array<T>::LinComb(T a1, Array<T> *A1,
                                        devLinComb3<T>,
                                        (size_t) 0, 0);
 
-    devLinComb3<<<nBlocks, nThreads>>>(size, nDims, realSize, deviceVec,
-                                       a1, pA1,
-                                       a2, pA2,
-                                       a3, pA3);
+    LaunchKernel(nBlocks, nThreads, devLinComb3)
+      (size, nDims, realSize, deviceVec,
+       a1, pA1, A1->GetRealSize(),
+       a2, pA2, A2->GetRealSize(),
+       a3, pA3, A3->GetRealSize());
     gpuErrchk( cudaPeekAtLastError() );
     gpuErrchk( cudaDeviceSynchronize() );
   }
@@ -0,0 +1,175 @@
+// -*-c++-*-
+/*! \file pool.cpp
+\brief Functions for ArrayPool class
+
+\section LICENSE
+Copyright (c) 2017 Sijme-Jan Paardekooper
+
+This file is part of Astrix.
+
+Astrix is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+
+Astrix is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Astrix.  If not, see <http://www.gnu.org/licenses/>.*/
+
+#include "../Common/cudaRuntime.h"
+#include <iostream>
+#include <cstdlib>
+#include <stdexcept>
+
+#include "./pool.h"
+#include "../Common/cudaLow.h"
+
+namespace astrix {
+
+int64_t ArrayPool::nHit[2] = {0, 0};
+int64_t ArrayPool::nMiss[2] = {0, 0};
+int64_t ArrayPool::bytesInUse[2] = {0, 0};
+int64_t ArrayPool::bytesInUsePeak[2] = {0, 0};
+int64_t ArrayPool::bytesCached[2] = {0, 0};
+std::vector<void *> ArrayPool::freeList[2][ArrayPool::nClass];
+std::unordered_map<void *, int> ArrayPool::blockClass[2];
+
+//#########################################################################
+// Return size class for request of nBytes bytes: smallest k >= minClass
+// with 2^k >= nBytes
+//#########################################################################
+
+int ArrayPool::SizeClass(std::size_t nBytes)
+{
+  int k = minClass;
+  while (k < nClass - 1 && ((std::size_t) 1 << k) < nBytes) k++;
+  return k;
+}
+
+//#########################################################################
+// Size of block (bytes) handed out for a request of nBytes bytes
+//#########################################################################
+
+std::size_t ArrayPool::BlockSize(std::size_t nBytes)
+{
+  return (std::size_t) 1 << SizeClass(nBytes);
+}
+
+//#########################################################################
+/*! Return block of at least \a nBytes bytes, reusing a cached block of the
+same size class if available. If the system is out of memory, all cached
+blocks are released and the allocation is tried once more.
+
+\param nBytes Number of bytes requested
+\param cudaFlag Allocate on host (=0) or device (=1)*/
+//#########################################################################
+
+void *ArrayPool::Allocate(std::size_t nBytes, int cudaFlag)
+{
+  int k = SizeClass(nBytes);
+  std::size_t blockSize = (std::size_t) 1 << k;
+
+  void *ptr = 0;
+  if (freeList[cudaFlag][k].size() > 0) {
+    ptr = freeList[cudaFlag][k].back();
+    freeList[cudaFlag][k].pop_back();
+    bytesCached[cudaFlag] -= blockSize;
+    nHit[cudaFlag]++;
+  } else {
+    if (cudaFlag == 0) {
+      ptr = malloc(blockSize);
+      if (ptr == 0) {
+        Release();
+        ptr = malloc(blockSize);
+      }
+      if (ptr == 0) {
+        std::cout << "Could not allocate " << blockSize
+                  << " bytes on host" << std::endl;
+        throw std::runtime_error("");
+      }
+    } else {
+      if (cudaMalloc(&ptr, blockSize) != cudaSuccess) {
+        Release();
+        gpuErrchk(cudaMalloc(&ptr, blockSize));
+      }
+    }
+    nMiss[cudaFlag]++;
+  }
+
+  blockClass[cudaFlag][ptr] = k;
+
+  bytesInUse[cudaFlag] += blockSize;
+  if (bytesInUse[cudaFlag] > bytesInUsePeak[cudaFlag])
+    bytesInUsePeak[cudaFlag] = bytesInUse[cudaFlag];
+
+  return ptr;
+}
+
+//#########################################################################
+/*! Return block to the pool. The block is cached for later use and not
+returned to the system.
+
+\param *ptr Pointer to block obtained from Allocate()
+\param cudaFlag Block lives on host (=0) or device (=1)*/
+//#########################################################################
+
+void ArrayPool::Free(void *ptr, int cudaFlag)
+{
+  if (ptr == 0) return;
+
+  std::unordered_map<void *, int>::iterator it = blockClass[cudaFlag].find(ptr);
+  if (it == blockClass[cudaFlag].end()) {
+    std::cout << "Freeing block not allocated by ArrayPool" << std::endl;
+    throw std::runtime_error("");
+  }
+
+  int k = it->second;
+  blockClass[cudaFlag].erase(it);
+
+  freeList[cudaFlag][k].push_back(ptr);
+
+  std::size_t blockSize = (std::size_t) 1 << k;
+  bytesInUse[cudaFlag] -= blockSize;
+  bytesCached[cudaFlag] += blockSize;
+}
+
+//#########################################################################
+/*! Release all cached blocks on host and device. Must be called before the
+device is reset.*/
+//#########################################################################
+
+void ArrayPool::Release()
+{
+  for (int k = 0; k < nClass; k++) {
+    for (unsigned int i = 0; i < freeList[0][k].size(); i++)
+      free(freeList[0][k][i]);
+    freeList[0][k].clear();
+
+    for (unsigned int i = 0; i < freeList[1][k].size(); i++)
+      gpuErrchk(cudaFree(freeList[1][k][i]));
+    freeList[1][k].clear();
+  }
+
+  bytesCached[0] = 0;
+  bytesCached[1] = 0;
+}
+
+//#########################################################################
+// Output statistics to screen
+//#########################################################################
+
+void ArrayPool::PrintStatistics()
+{
+  const char *name[2] = {"host", "device"};
+
+  for (int c = 0; c < 2; c++) {
+    if (nHit[c] + nMiss[c] == 0) continue;
+
+    std::cout << "Memory pool (" << name[c] << "): "
+              << nHit[c] << " hits, "
+              << nMiss[c] << " misses, peak "
+              << (double) bytesInUsePeak[c]/(1024.0*1024.0) << " Mb in use, "
+              << (double) bytesCached[c]/(1024.0*1024.0) << " Mb cached"
+              << std::endl;
+  }
+}
+
+}  // namespace astrix
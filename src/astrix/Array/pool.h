@@ -0,0 +1,78 @@
+/*! \file pool.h
+\brief Header file for ArrayPool class
+
+\section LICENSE
+Copyright (c) 2017 Sijme-Jan Paardekooper
+
+This file is part of Astrix.
+
+Astrix is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+
+Astrix is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Astrix.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef ASTRIX_ARRAY_POOL_H
+#define ASTRIX_ARRAY_POOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <unordered_map>
+
+namespace astrix {
+
+//! Caching memory pool used by all Array's
+/*! Memory is handed out in blocks whose size is a power of two. Blocks that
+are freed are kept in a list per size class and reused by the next request of
+the same class, so that Array's that are repeatedly created or resized do not
+go through malloc or cudaMalloc. Because an Array fills its whole block (see
+Array::PhysicalSize), growing Array's double their capacity.
+
+Host (cudaFlag = 0) and device (cudaFlag = 1) memory are kept separately.
+The pool is not thread safe: Array's should not be created, resized or
+destroyed inside parallel regions.*/
+class ArrayPool
+{
+ public:
+  //! Return block of at least \a nBytes bytes on host or device
+  static void *Allocate(std::size_t nBytes, int cudaFlag);
+  //! Return block \a ptr to the pool; \a ptr = 0 is ignored
+  static void Free(void *ptr, int cudaFlag);
+  //! Release all cached blocks back to the system
+  static void Release();
+  //! Size of block (bytes) handed out for a request of \a nBytes bytes
+  static std::size_t BlockSize(std::size_t nBytes);
+
+  //! Output statistics to screen
+  static void PrintStatistics();
+
+  //! Number of requests served from cache
+  static int64_t nHit[2];
+  //! Number of requests needing a fresh allocation
+  static int64_t nMiss[2];
+  //! Bytes in blocks currently handed out
+  static int64_t bytesInUse[2];
+  //! Maximum of \a bytesInUse
+  static int64_t bytesInUsePeak[2];
+  //! Bytes in cached blocks
+  static int64_t bytesCached[2];
+
+ private:
+  //! Number of size classes; class k holds blocks of 2^k bytes
+  static const int nClass = 64;
+  //! Smallest size class
+  static const int minClass = 8;
+
+  //! Cached blocks for every size class
+  static std::vector<void *> freeList[2][nClass];
+  //! Size class of all blocks handed out
+  static std::unordered_map<void *, int> blockClass[2];
+
+  //! Return size class for request of \a nBytes bytes
+  static int SizeClass(std::size_t nBytes);
+};
+
+}  // namespace astrix
+#endif  // ASTRIX_ARRAY_POOL_H
@@ -14,9 +14,13 @@ Astrix is distributed in the hope that it will be useful, but WITHOUT ANY WARRAN
 You should have received a copy of the GNU General Public License
 along with Astrix.  If not, see <http://www.gnu.org/licenses/>.
 */
+#ifndef CPU_ASTRIX
 #include <thrust/host_vector.h>
 #include <thrust/device_vector.h>
 #include <thrust/extrema.h>
+#endif
+#include <algorithm>
+#include <numeric>
 #include <iostream>
 
 #include "./array.h"
@@ -33,6 +37,7 @@ T Array<T>::Minimum()
 {
   T result = 0;
 
+#ifndef CPU_ASTRIX
   if (cudaFlag == 1) {
     thrust::device_ptr<T> dev_ptr(deviceVec);
 
@@ -40,9 +45,9 @@ T Array<T>::Minimum()
       thrust::min_element(dev_ptr, dev_ptr + size);
     result = *iter;
   }
+#endif
   if (cudaFlag == 0) {
-    typename thrust::host_vector<T>::iterator iter =
-      thrust::min_element(hostVec, hostVec + size);
+    T *iter = std::min_element(hostVec, hostVec + size);
     result = *iter;
   }
 
@@ -58,6 +63,7 @@ T Array<T>::Minimum(int N)
 {
   T result = 0;
 
+#ifndef CPU_ASTRIX
   if (cudaFlag == 1) {
     thrust::device_ptr<T> dev_ptr(&deviceVec[N*realSize]);
 
@@ -65,9 +71,9 @@ T Array<T>::Minimum(int N)
       thrust::min_element(dev_ptr, dev_ptr + size);
     result = *iter;
   }
+#endif
   if (cudaFlag == 0) {
-    typename thrust::host_vector<T>::iterator iter =
-      thrust::min_element(hostVec + N*realSize, hostVec + N*realSize + size);
+    T *iter = std::min_element(hostVec + N*realSize, hostVec + N*realSize + size);
     result = *iter;
   }
 
@@ -83,6 +89,7 @@ T Array<T>::Maximum()
 {
   T result = 0;
 
+#ifndef CPU_ASTRIX
   if (cudaFlag == 1) {
     thrust::device_ptr<T> dev_ptr(deviceVec);
 
@@ -90,9 +97,9 @@ T Array<T>::Maximum()
       thrust::max_element(dev_ptr, dev_ptr + size);
     result = *iter;
   }
+#endif
   if (cudaFlag == 0) {
-    typename thrust::host_vector<T>::iterator iter =
-      thrust::max_element(hostVec, hostVec + size);
+    T *iter = std::max_element(hostVec, hostVec + size);
     result = *iter;
   }
 
@@ -108,6 +115,7 @@ T Array<T>::Maximum(int N)
 {
   T result = 0;
 
+#ifndef CPU_ASTRIX
   if (cudaFlag == 1) {
     thrust::device_ptr<T> dev_ptr(&deviceVec[N*realSize]);
 
@@ -115,9 +123,9 @@ T Array<T>::Maximum(int N)
       thrust::max_element(dev_ptr, dev_ptr + size);
     result = *iter;
   }
+#endif
   if (cudaFlag == 0) {
-    typename thrust::host_vector<T>::iterator iter =
-      thrust::max_element(hostVec + N*realSize, hostVec + N*realSize + size);
+    T *iter = std::max_element(hostVec + N*realSize, hostVec + N*realSize + size);
     result = *iter;
   }
 
@@ -154,6 +162,7 @@ S Array<T>::MaximumComb(int N)
 {
   S result = 0;
 
+#ifndef CPU_ASTRIX
   if (cudaFlag == 1) {
     thrust::device_ptr<T> dev_ptr(&deviceVec[0]);
 
@@ -167,13 +176,14 @@ S Array<T>::MaximumComb(int N)
     if (N == 0) result = res.x;
     if (N == 1) result = res.y;
   }
+#endif
   if (cudaFlag == 0) {
-    typename thrust::host_vector<T>::iterator iter;
+    T *iter = hostVec;
 
     if (N == 0)
-      iter = thrust::max_element(hostVec, hostVec + size, compare_x<T>());
+      iter = std::max_element(hostVec, hostVec + size, compare_x<T>());
     if (N == 1)
-      iter = thrust::max_element(hostVec, hostVec + size, compare_y<T>());
+      iter = std::max_element(hostVec, hostVec + size, compare_y<T>());
     if (N == 0) result = (*iter).x;
     if (N == 1) result = (*iter).y;
   }
@@ -187,6 +197,7 @@ S Array<T>::MinimumComb(int N)
 {
   S result = 0;
 
+#ifndef CPU_ASTRIX
   if (cudaFlag == 1) {
     thrust::device_ptr<T> dev_ptr(&deviceVec[0]);
 
@@ -201,13 +212,14 @@ S Array<T>::MinimumComb(int N)
     if (N == 0) result = res.x;
     if (N == 1) result = res.y;
   }
+#endif
   if (cudaFlag == 0) {
-    typename thrust::host_vector<T>::iterator iter;
+    T *iter = hostVec;
 
     if (N == 0)
-      iter = thrust::min_element(hostVec, hostVec + size, compare_x<T>());
+      iter = std::min_element(hostVec, hostVec + size, compare_x<T>());
     if (N == 1)
-      iter = thrust::min_element(hostVec, hostVec + size, compare_y<T>());
+      iter = std::min_element(hostVec, hostVec + size, compare_y<T>());
     if (N == 0) result = (*iter).x;
     if (N == 1) result = (*iter).y;
   }
@@ -224,15 +236,16 @@ T Array<T>::Sum()
 {
   T result = (T) 0;
 
+#ifndef CPU_ASTRIX
   if (cudaFlag == 1) {
     thrust::device_ptr<T> dev_ptr(deviceVec);
 
     result =
       thrust::reduce(dev_ptr, dev_ptr + size, (T) 0, thrust::plus<T>());
   }
+#endif
   if (cudaFlag == 0) {
-    result =
-      thrust::reduce(hostVec, hostVec + size, (T) 0, thrust::plus<T>());
+    result = std::accumulate(hostVec, hostVec + size, (T) 0);
   }
 
   return result;
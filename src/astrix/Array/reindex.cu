@@ -28,7 +28,7 @@ __global__ void
 devReindex(int N, T *destArray, T *srcArray, unsigned int *reindex,
            int realSize, int nDims)
 {
-  for (unsigned int n = 0; n < nDims; n++) {
+  for (int n = 0; n < nDims; n++) {
     int i = blockIdx.x*blockDim.x + threadIdx.x;
 
     while (i < N) {
@@ -54,28 +54,29 @@ void Array<T>::Reindex(unsigned int *reindex)
                                        devReindex<T>,
                                        (size_t) 0, 0);
 
-    T *temp;
-    gpuErrchk(cudaMalloc(reinterpret_cast<void**>(&temp),
-                         nDims*realSize*sizeof(T)));
+    T *temp = (T *)ArrayPool::Allocate(nDims*realSize*sizeof(T), 1);
+    nAllocationDevice++;
 
-    devReindex<<<nBlocks, nThreads>>>(size, temp, deviceVec, reindex,
-                                      realSize, nDims);
+    LaunchKernel(nBlocks, nThreads, devReindex)
+      (size, temp, deviceVec, reindex,
+       realSize, nDims);
     gpuErrchk( cudaPeekAtLastError() );
     gpuErrchk( cudaDeviceSynchronize() );
 
-    gpuErrchk(cudaFree(deviceVec));
+    ArrayPool::Free(deviceVec, 1);
     deviceVec = temp;
   }
 
   if (cudaFlag == 0) {
     // Temporary array
-    T *temp = (T *)malloc(nDims*realSize*sizeof(T));
+    T *temp = (T *)ArrayPool::Allocate(nDims*realSize*sizeof(T), 0);
+    nAllocationHost++;
 
     for (unsigned int n = 0; n < nDims; n++)
       for (unsigned int i = 0; i < size; i++)
         temp[i + n*realSize] = hostVec[reindex[i] + n*realSize];
 
-    free(hostVec);
+    ArrayPool::Free(hostVec, 0);
     hostVec = temp;
   }
 }
@@ -96,28 +97,29 @@ void Array<T>::Reindex(unsigned int *reindex, unsigned int N)
                                        devReindex<T>,
                                        (size_t) 0, 0);
 
-    T *temp;
-    gpuErrchk(cudaMalloc(reinterpret_cast<void**>(&temp),
-                         nDims*realSize*sizeof(T)));
+    T *temp = (T *)ArrayPool::Allocate(nDims*realSize*sizeof(T), 1);
+    nAllocationDevice++;
 
-    devReindex<<<nBlocks, nThreads>>>(N, temp, deviceVec, reindex,
-                                      realSize, nDims);
+    LaunchKernel(nBlocks, nThreads, devReindex)
+      (N, temp, deviceVec, reindex,
+       realSize, nDims);
     gpuErrchk( cudaPeekAtLastError() );
     gpuErrchk( cudaDeviceSynchronize() );
 
-    gpuErrchk(cudaFree(deviceVec));
+    ArrayPool::Free(deviceVec, 1);
     deviceVec = temp;
   }
 
   if (cudaFlag == 0) {
     // Temporary array
-    T *temp = (T *)malloc(nDims*realSize*sizeof(T));
+    T *temp = (T *)ArrayPool::Allocate(nDims*realSize*sizeof(T), 0);
+    nAllocationHost++;
 
     for (unsigned int n = 0; n < nDims; n++)
       for (unsigned int i = 0; i < N; i++)
         temp[i + n*realSize] = hostVec[reindex[i] + n*realSize];
 
-    free(hostVec);
+    ArrayPool::Free(hostVec, 0);
     hostVec = temp;
   }
 }
@@ -131,7 +133,7 @@ devInverseReindex(int N, int *destArray, int *srcArray,
                   unsigned int *reindex, int realSize, int nDims,
                   int maxValue, bool ignoreValue)
 {
-  for (unsigned int n = 0; n < nDims; n++) {
+  for (int n = 0; n < nDims; n++) {
     int i = blockIdx.x*blockDim.x + threadIdx.x;
 
     while (i < N) {
@@ -165,7 +167,7 @@ devInverseReindexInt2Bool(int N, int2 *destArray, int2 *srcArray,
                           unsigned int *reindex, int realSize, int nDims,
                           int maxValue, bool ignoreValue)
 {
-  for (unsigned int n = 0; n < nDims; n++) {
+  for (int n = 0; n < nDims; n++) {
     int i = blockIdx.x*blockDim.x + threadIdx.x;
 
     while (i < N) {
@@ -215,7 +217,7 @@ devInverseReindexInt3Bool(int N, int3 *destArray, int3 *srcArray,
                           unsigned int *reindex, int realSize, int nDims,
                           int maxValue, bool ignoreValue)
 {
-  for (unsigned int n = 0; n < nDims; n++) {
+  for (int n = 0; n < nDims; n++) {
     int i = blockIdx.x*blockDim.x + threadIdx.x;
 
     while (i < N) {
@@ -280,7 +282,7 @@ __global__ void
 devInverseReindexInt(int N, int *destArray, int *srcArray,
                      int *reindex, int realSize, int nDims)
 {
-  for (unsigned int n = 0; n < nDims; n++) {
+  for (int n = 0; n < nDims; n++) {
     int i = blockIdx.x*blockDim.x + threadIdx.x;
 
     while (i < N) {
@@ -300,7 +302,7 @@ __global__ void
 devInverseReindexInt3(int N, int3 *destArray, int3 *srcArray,
                       int *reindex, int realSize, int nDims)
 {
-  for (unsigned int n = 0; n < nDims; n++) {
+  for (int n = 0; n < nDims; n++) {
     int i = blockIdx.x*blockDim.x + threadIdx.x;
 
     while (i < N) {
@@ -332,22 +334,23 @@ void Array<int>::InverseReindex(int *reindex)
                                        devInverseReindexInt,
                                        (size_t) 0, 0);
 
-    int *temp;
-    gpuErrchk(cudaMalloc(reinterpret_cast<void**>(&temp),
-                         nDims*realSize*sizeof(int)));
+    int *temp = (int *)ArrayPool::Allocate(nDims*realSize*sizeof(int), 1);
+    nAllocationDevice++;
 
-    devInverseReindexInt<<<nBlocks, nThreads>>>(size, temp, deviceVec, reindex,
-                                                realSize, nDims);
+    LaunchKernel(nBlocks, nThreads, devInverseReindexInt)
+      (size, temp, deviceVec, reindex,
+       realSize, nDims);
     gpuErrchk( cudaPeekAtLastError() );
     gpuErrchk( cudaDeviceSynchronize() );
 
-    gpuErrchk(cudaFree(deviceVec));
+    ArrayPool::Free(deviceVec, 1);
     deviceVec = temp;
   }
 
   if (cudaFlag == 0) {
     // Temporary array
-    int *temp = (int *)malloc(nDims*realSize*sizeof(int));
+    int *temp = (int *)ArrayPool::Allocate(nDims*realSize*sizeof(int), 0);
+    nAllocationHost++;
 
     for (unsigned int n = 0; n < nDims; n++) {
       for (unsigned int i = 0; i < size; i++) {
@@ -356,7 +359,7 @@ void Array<int>::InverseReindex(int *reindex)
       }
     }
 
-    free(hostVec);
+    ArrayPool::Free(hostVec, 0);
     hostVec = temp;
   }
 }
@@ -377,22 +380,23 @@ void Array<int3>::InverseReindex(int *reindex)
                                        devInverseReindexInt,
                                        (size_t) 0, 0);
 
-    int3 *temp;
-    gpuErrchk(cudaMalloc(reinterpret_cast<void**>(&temp),
-                         nDims*realSize*sizeof(int3)));
+    int3 *temp = (int3 *)ArrayPool::Allocate(nDims*realSize*sizeof(int3), 1);
+    nAllocationDevice++;
 
-    devInverseReindexInt3<<<nBlocks, nThreads>>>(size, temp, deviceVec, reindex,
-                                                 realSize, nDims);
+    LaunchKernel(nBlocks, nThreads, devInverseReindexInt3)
+      (size, temp, deviceVec, reindex,
+       realSize, nDims);
     gpuErrchk( cudaPeekAtLastError() );
     gpuErrchk( cudaDeviceSynchronize() );
 
-    gpuErrchk(cudaFree(deviceVec));
+    ArrayPool::Free(deviceVec, 1);
     deviceVec = temp;
   }
 
   if (cudaFlag == 0) {
     // Temporary array
-    int3 *temp = (int3 *)malloc(nDims*realSize*sizeof(int3));
+    int3 *temp = (int3 *)ArrayPool::Allocate(nDims*realSize*sizeof(int3), 0);
+    nAllocationHost++;
 
     for (unsigned int n = 0; n < nDims; n++) {
       for (unsigned int i = 0; i < size; i++) {
@@ -405,7 +409,7 @@ void Array<int3>::InverseReindex(int *reindex)
       }
     }
 
-    free(hostVec);
+    ArrayPool::Free(hostVec, 0);
     hostVec = temp;
   }
 }
@@ -428,23 +432,24 @@ void Array<int>::InverseReindex(unsigned int *reindex,
                                        devInverseReindex,
                                        (size_t) 0, 0);
 
-    int *temp;
-    gpuErrchk(cudaMalloc(reinterpret_cast<void**>(&temp),
-                         nDims*realSize*sizeof(int)));
+    int *temp = (int *)ArrayPool::Allocate(nDims*realSize*sizeof(int), 1);
+    nAllocationDevice++;
 
-    devInverseReindex<<<nBlocks, nThreads>>>(size, temp, deviceVec, reindex,
-                                             realSize, nDims, maxValue,
-                                             ignoreValue);
+    LaunchKernel(nBlocks, nThreads, devInverseReindex)
+      (size, temp, deviceVec, reindex,
+       realSize, nDims, maxValue,
+       ignoreValue);
     gpuErrchk( cudaPeekAtLastError() );
     gpuErrchk( cudaDeviceSynchronize() );
 
-    gpuErrchk(cudaFree(deviceVec));
+    ArrayPool::Free(deviceVec, 1);
     deviceVec = temp;
   }
 
   if (cudaFlag == 0) {
     // Temporary array
-    int *temp = (int *)malloc(nDims*realSize*sizeof(int));
+    int *temp = (int *)ArrayPool::Allocate(nDims*realSize*sizeof(int), 0);
+    nAllocationHost++;
 
     for (unsigned int n = 0; n < nDims; n++) {
       for (unsigned int i = 0; i < size; i++) {
@@ -465,7 +470,7 @@ void Array<int>::InverseReindex(unsigned int *reindex,
       }
     }
 
-    free(hostVec);
+    ArrayPool::Free(hostVec, 0);
     hostVec = temp;
   }
 }
@@ -488,22 +493,22 @@ void Array<int2>::InverseReindex(unsigned int *reindex,
                                        devInverseReindexInt2Bool,
                                        (size_t) 0, 0);
 
-    int2 *temp;
-    gpuErrchk(cudaMalloc(reinterpret_cast<void**>(&temp),
-                         nDims*realSize*sizeof(int2)));
+    int2 *temp = (int2 *)ArrayPool::Allocate(nDims*realSize*sizeof(int2), 1);
+    nAllocationDevice++;
 
-    devInverseReindexInt2Bool<<<nBlocks, nThreads>>>
+    LaunchKernel(nBlocks, nThreads, devInverseReindexInt2Bool)
       (size, temp, deviceVec, reindex, realSize, nDims, maxValue, ignoreValue);
     gpuErrchk( cudaPeekAtLastError() );
     gpuErrchk( cudaDeviceSynchronize() );
 
-    gpuErrchk(cudaFree(deviceVec));
+    ArrayPool::Free(deviceVec, 1);
     deviceVec = temp;
   }
 
   if (cudaFlag == 0) {
     // Temporary array
-    int2 *temp = (int2 *)malloc(nDims*realSize*sizeof(int2));
+    int2 *temp = (int2 *)ArrayPool::Allocate(nDims*realSize*sizeof(int2), 0);
+    nAllocationHost++;
 
     for (unsigned int n = 0; n < nDims; n++) {
       for (unsigned int i = 0; i < size; i++) {
@@ -539,7 +544,7 @@ void Array<int2>::InverseReindex(unsigned int *reindex,
       }
     }
 
-    free(hostVec);
+    ArrayPool::Free(hostVec, 0);
     hostVec = temp;
   }
 }
@@ -562,23 +567,23 @@ void Array<int3>::InverseReindex(unsigned int *reindex,
                                        devInverseReindexInt3Bool,
                                        (size_t) 0, 0);
 
-    int3 *temp;
-    gpuErrchk(cudaMalloc(reinterpret_cast<void**>(&temp),
-                         nDims*realSize*sizeof(int3)));
+    int3 *temp = (int3 *)ArrayPool::Allocate(nDims*realSize*sizeof(int3), 1);
+    nAllocationDevice++;
 
-    devInverseReindexInt3Bool<<<nBlocks, nThreads>>>
+    LaunchKernel(nBlocks, nThreads, devInverseReindexInt3Bool)
       (size, temp, deviceVec, reindex, realSize, nDims, maxValue, ignoreValue);
     gpuErrchk( cudaPeekAtLastError() );
     gpuErrchk( cudaDeviceSynchronize() );
 
-    gpuErrchk(cudaFree(deviceVec));
+    ArrayPool::Free(deviceVec, 1);
     deviceVec = temp;
   }
 
   if (cudaFlag == 0) {
     // Temporary array
     int3 *temp =
-      (int3 *)malloc(nDims*realSize*sizeof(int3));
+      (int3 *)ArrayPool::Allocate(nDims*realSize*sizeof(int3), 0);
+    nAllocationHost++;
 
     for (unsigned int n = 0; n < nDims; n++) {
       for (unsigned int i = 0; i < size; i++) {
@@ -629,7 +634,7 @@ void Array<int3>::InverseReindex(unsigned int *reindex,
       }
     }
 
-    free(hostVec);
+    ArrayPool::Free(hostVec, 0);
     hostVec = temp;
   }
 }
@@ -58,7 +58,8 @@ int Array<T>::RemoveEvery(int start, int step)
                                        devFillKeepFlag,
                                        (size_t) 0, 0);
 
-    devFillKeepFlag<<<nBlocks, nThreads>>>(size, pKeepFlag, start, step);
+    LaunchKernel(nBlocks, nThreads, devFillKeepFlag)
+      (size, pKeepFlag, start, step);
     gpuErrchk( cudaPeekAtLastError() );
     gpuErrchk( cudaDeviceSynchronize() );
   }
@@ -102,7 +103,8 @@ int Array<T>::RemoveEvery(int start, int step, Array<S> *A)
                                        devFillKeepFlag,
                                        (size_t) 0, 0);
 
-    devFillKeepFlag<<<nBlocks, nThreads>>>(size, pKeepFlag, start, step);
+    LaunchKernel(nBlocks, nThreads, devFillKeepFlag)
+      (size, pKeepFlag, start, step);
     gpuErrchk( cudaPeekAtLastError() );
     gpuErrchk( cudaDeviceSynchronize() );
   }
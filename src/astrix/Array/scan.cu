@@ -14,8 +14,10 @@ Astrix is distributed in the hope that it will be useful, but WITHOUT ANY WARRAN
 You should have received a copy of the GNU General Public License
 along with Astrix.  If not, see <http://www.gnu.org/licenses/>.
 */
+#ifndef CPU_ASTRIX
 #include <thrust/host_vector.h>
 #include <thrust/device_vector.h>
+#endif
 #include <iostream>
 
 #include "./array.h"
@@ -35,6 +37,7 @@ T Array<T>::ExclusiveScan(Array<T> *result)
   T *pResult = result->GetPointer();
   T total = 0;
 
+#ifndef CPU_ASTRIX
   if (cudaFlag == 1) {
     thrust::device_ptr<T> dev_ptr(deviceVec);
     thrust::device_ptr<T> dev_ptr_result(pResult);
@@ -46,10 +49,16 @@ T Array<T>::ExclusiveScan(Array<T> *result)
     result->GetSingleValue(&temp2, size - 1);
     total = temp1 + temp2;
   }
+#endif
   if (cudaFlag == 0) {
-    thrust::exclusive_scan(hostVec, hostVec + size, pResult);
-
-    total = pResult[size - 1] + hostVec[size - 1];
+    T sum = 0;
+    for (unsigned int i = 0; i < size; i++) {
+      T temp = hostVec[i];
+      pResult[i] = sum;
+      sum += temp;
+    }
+
+    total = sum;
   }
 
   return total;
@@ -67,6 +76,7 @@ T Array<T>::ExclusiveScan(Array<T> *result, unsigned int N)
   T *pResult = result->GetPointer();
   T total = 0;
 
+#ifndef CPU_ASTRIX
   if (cudaFlag == 1) {
     thrust::device_ptr<T> dev_ptr(deviceVec);
     thrust::device_ptr<T> dev_ptr_result(pResult);
@@ -78,10 +88,16 @@ T Array<T>::ExclusiveScan(Array<T> *result, unsigned int N)
     result->GetSingleValue(&temp2, N - 1);
     total = temp1 + temp2;
   }
+#endif
   if (cudaFlag == 0) {
-    thrust::exclusive_scan(hostVec, hostVec + N, pResult);
-
-    total = pResult[N-1] + hostVec[N-1];
+    T sum = 0;
+    for (unsigned int i = 0; i < N; i++) {
+      T temp = hostVec[i];
+      pResult[i] = sum;
+      sum += temp;
+    }
+
+    total = sum;
   }
 
   return total;
@@ -61,8 +61,9 @@ int Array<T>::SelectLargerThan(T value, Array<S> *A)
                                        devSelectLargerThan<T>,
                                        (size_t) 0, 0);
 
-    devSelectLargerThan<<<nBlocks, nThreads>>>(size, deviceVec, value,
-                                               pSelectFlag);
+    LaunchKernel(nBlocks, nThreads, devSelectLargerThan)
+      (size, deviceVec, value,
+       pSelectFlag);
     gpuErrchk(cudaPeekAtLastError());
     gpuErrchk(cudaDeviceSynchronize());
   } else {
@@ -126,8 +127,9 @@ int Array<T>::SelectWhereDifferent(Array<T> *A, Array<S> *B)
                                        devSelectWhereDifferent<T>,
                                        (size_t) 0, 0);
 
-    devSelectWhereDifferent<<<nBlocks, nThreads>>>(size, deviceVec,
-                                                   compareData, pSelectFlag);
+    LaunchKernel(nBlocks, nThreads, devSelectWhereDifferent)
+      (size, deviceVec,
+       compareData, pSelectFlag);
     gpuErrchk(cudaPeekAtLastError());
     gpuErrchk(cudaDeviceSynchronize());
   } else {
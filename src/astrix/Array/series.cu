@@ -28,8 +28,8 @@ __global__ void
 devSetToSeries(T *array, int realSize, int nDims,
                unsigned int startIndex, unsigned int endIndex)
 {
-  for (unsigned int n = 0; n < nDims; n++) {
-    int i = blockIdx.x*blockDim.x + threadIdx.x + startIndex;
+  for (int n = 0; n < nDims; n++) {
+    unsigned int i = blockIdx.x*blockDim.x + threadIdx.x + startIndex;
 
     while (i < endIndex) {
       array[i + n*realSize] = i;
@@ -54,9 +54,10 @@ void Array<T>::SetToSeries()
                                        devSetToSeries<T>,
                                        (size_t) 0, 0);
 
-    devSetToSeries<<<nBlocks, nThreads>>>(deviceVec,
-                                          realSize, nDims,
-                                          0, size);
+    LaunchKernel(nBlocks, nThreads, devSetToSeries)
+      (deviceVec,
+       realSize, nDims,
+       0, size);
     gpuErrchk( cudaPeekAtLastError() );
     gpuErrchk( cudaDeviceSynchronize() );
   }
@@ -85,9 +86,10 @@ void Array<T>::SetToSeries(unsigned int startIndex,
                                        devSetToSeries<T>,
                                        (size_t) 0, 0);
 
-    devSetToSeries<<<nBlocks, nThreads>>>(deviceVec,
-                                          realSize, nDims,
-                                          startIndex, endIndex);
+    LaunchKernel(nBlocks, nThreads, devSetToSeries)
+      (deviceVec,
+       realSize, nDims,
+       startIndex, endIndex);
     gpuErrchk( cudaPeekAtLastError() );
     gpuErrchk( cudaDeviceSynchronize() );
   }
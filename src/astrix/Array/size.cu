@@ -61,32 +61,30 @@ void Array<T>::SetSizeHost(unsigned int _size)
 {
   size = _size;
 
-  // New physical size
-  unsigned int realSizeNew = ((size + dynArrayStep)/dynArrayStep)*dynArrayStep;
+  // Minimum physical size
+  unsigned int realSizeMin = ((size + dynArrayStep)/dynArrayStep)*dynArrayStep;
 
   // Adjust physical size if not big enough or at least two times too big
-  if (realSize < realSizeNew || 2*realSizeNew < realSize) {
-    // Need to allocate more memory
-    if (realSize < realSizeNew) {
-      // Reallocate memory
-      hostVec = (T *)realloc(hostVec, nDims*realSizeNew*sizeof(T));
-
-      // Shift data to right
-      for (int n = nDims - 1; n > 0; n--)
-        for (int i = realSize - 1; i >= 0; i--)
-          hostVec[n*realSizeNew + i] = hostVec[n*realSize + i];
-    }
-
-    if (2*realSizeNew < realSize) {
-      // Shift data to left
-      for (unsigned int n = 1; n < nDims; n++)
-        memcpy(&(hostVec[n*realSizeNew]),
-               &(hostVec[n*realSize]),
-               realSizeNew*sizeof(T));
-
-      // Reallocate memory
-      hostVec = (T *)realloc(hostVec, nDims*realSizeNew*sizeof(T));
-    }
+  if (realSize < realSizeMin || 2*realSizeMin < realSize) {
+    // New physical size, filling block from memory pool
+    unsigned int realSizeNew = PhysicalSize(size);
+
+    T *temp = (T *)ArrayPool::Allocate(nDims*realSizeNew*sizeof(T), 0);
+    nAllocationHost++;
+
+    unsigned int nToCopy = realSize;
+    if (realSizeNew < realSize) nToCopy = realSizeNew;
+
+    // Every component block moves when the physical size changes
+    std::size_t componentSize = sizeof(T)/nComponent;
+    for (unsigned int n = 0; n < nDims; n++)
+      for (unsigned int c = 0; c < nComponent; c++)
+        memcpy((char *) &(temp[n*realSizeNew]) + c*realSizeNew*componentSize,
+               (char *) &(hostVec[n*realSize]) + c*realSize*componentSize,
+               nToCopy*componentSize);
+
+    ArrayPool::Free(hostVec, 0);
+    hostVec = temp;
 
     int alloc = (int)nDims*((int)realSizeNew-(int)realSize)*(int)sizeof(T);
     if (alloc > 0) memAllocatedHost += alloc;
@@ -105,36 +103,43 @@ void Array<T>::SetSizeDevice(unsigned int _size)
 {
   unsigned int sizeNew = _size;
 
-  // New physical size
-  unsigned int realSizeNew =
+  // Minimum physical size
+  unsigned int realSizeMin =
     ((sizeNew + dynArrayStep)/dynArrayStep)*dynArrayStep;
 
   // Adjust physical size if not big enough or at least two times too big
-  if (realSize < realSizeNew ||
-      2*realSizeNew < realSize ||
-      (nDims > 1 && realSize != realSizeNew)) {
+  if (realSize < realSizeMin || 2*realSizeMin < realSize) {
+    // New physical size, filling block from memory pool
+    unsigned int realSizeNew = PhysicalSize(sizeNew);
+
     // Manual realloc on device
-    T *temp;
-    gpuErrchk(cudaMalloc(reinterpret_cast<void**>(&temp),
-                         nDims*realSizeNew*sizeof(T)));
+    T *temp = (T *)ArrayPool::Allocate(nDims*realSizeNew*sizeof(T), 1);
+    nAllocationDevice++;
 
     unsigned int nToCopy = size;
     if (sizeNew < size) nToCopy = sizeNew;
 
+    // Every component block moves when the physical size changes
+    std::size_t componentSize = sizeof(T)/nComponent;
     for (unsigned int n = 0; n < nDims; n++)
-      gpuErrchk(cudaMemcpy(&(temp[n*realSizeNew]), &(deviceVec[n*realSize]),
-                           nToCopy*sizeof(T),
-                           cudaMemcpyDeviceToDevice));
-
-    gpuErrchk(cudaFree(deviceVec));
+      for (unsigned int c = 0; c < nComponent; c++)
+        gpuErrchk(cudaMemcpy((char *) &(temp[n*realSizeNew]) +
+                             c*realSizeNew*componentSize,
+                             (char *) &(deviceVec[n*realSize]) +
+                             c*realSize*componentSize,
+                             nToCopy*componentSize,
+                             cudaMemcpyDeviceToDevice));
+
+    ArrayPool::Free(deviceVec, 1);
     deviceVec = temp;
-  }
 
-  int alloc = (int)nDims*((int)realSizeNew-(int)realSize)*(int)sizeof(T);
-  if (alloc > 0) memAllocatedDevice += alloc;
-  if (alloc < 0) memAllocatedDevice -= std::abs(alloc);
+    int alloc = (int)nDims*((int)realSizeNew-(int)realSize)*(int)sizeof(T);
+    if (alloc > 0) memAllocatedDevice += alloc;
+    if (alloc < 0) memAllocatedDevice -= std::abs(alloc);
+
+    realSize = realSizeNew;
+  }
 
-  realSize = realSizeNew;
   size = sizeNew;
 }
 
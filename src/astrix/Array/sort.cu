@@ -14,17 +14,24 @@ Astrix is distributed in the hope that it will be useful, but WITHOUT ANY WARRAN
 You should have received a copy of the GNU General Public License
 along with Astrix.  If not, see <http://www.gnu.org/licenses/>.
 */
+#ifndef CPU_ASTRIX
 #include <thrust/host_vector.h>
 #include <thrust/device_vector.h>
 #include <thrust/sort.h>
 #include <thrust/iterator/zip_iterator.h>
+#endif
+#include <algorithm>
 #include <iostream>
+#include <utility>
+#include <vector>
 
 #include "./array.h"
 #include "../Common/cudaLow.h"
 
 namespace astrix {
 
+#ifndef CPU_ASTRIX
+
 //############################################################
 //! Structure holding sorting operator
 //############################################################
@@ -71,6 +78,31 @@ struct subSubSortCompare
   }
 };
 
+#endif  // CPU_ASTRIX
+
+//###################################################
+//! Sort \a key[0..N-1] on host, applying the same permutation to \a value
+//###################################################
+
+template <class T, class S>
+void HostSortByKey(T *key, S *value, unsigned int N)
+{
+  std::vector<std::pair<T, S> > temp(N);
+  for (unsigned int i = 0; i < N; i++)
+    temp[i] = std::make_pair(key[i], value[i]);
+
+  // Stable, so that equal keys keep their original order
+  std::stable_sort(temp.begin(), temp.end(),
+                   [](const std::pair<T, S> &a, const std::pair<T, S> &b) {
+                     return a.first < b.first;
+                   });
+
+  for (unsigned int i = 0; i < N; i++) {
+    key[i] = temp[i].first;
+    value[i] = temp[i].second;
+  }
+}
+
 //###################################################
 // Sort array, producing indexing array
 //###################################################
@@ -81,13 +113,15 @@ void Array<T>::SortByKey(Array<S> *indexArray)
 {
   S *index = indexArray->GetPointer();
 
+#ifndef CPU_ASTRIX
   if (cudaFlag == 1) {
     thrust::device_ptr<T> dev_ptr(deviceVec);
     thrust::device_ptr<S> dev_ptr_index(index);
-    thrust::sort_by_key(dev_ptr, dev_ptr + size, dev_ptr_index);
+    thrust::stable_sort_by_key(dev_ptr, dev_ptr + size, dev_ptr_index);
   }
+#endif
   if (cudaFlag == 0) {
-    thrust::sort_by_key(hostVec, &(hostVec[size]), index);
+    HostSortByKey(hostVec, index, size);
   }
 }
 
@@ -101,13 +135,15 @@ void Array<T>::SortByKey(Array<S> *indexArray, unsigned int N)
 {
   S *index = indexArray->GetPointer();
 
+#ifndef CPU_ASTRIX
   if (cudaFlag == 1) {
     thrust::device_ptr<T> dev_ptr(deviceVec);
     thrust::device_ptr<S> dev_ptr_index(index);
-    thrust::sort_by_key(dev_ptr, dev_ptr + N, dev_ptr_index);
+    thrust::stable_sort_by_key(dev_ptr, dev_ptr + N, dev_ptr_index);
   }
+#endif
   if (cudaFlag == 0) {
-    thrust::sort_by_key(hostVec, &(hostVec[N]), index);
+    HostSortByKey(hostVec, index, N);
   }
 }
 
@@ -120,6 +156,7 @@ void Array<T>::Sort(Array<T> *arrayB)
 {
   T *B = arrayB->GetPointer();
 
+#ifndef CPU_ASTRIX
   if (cudaFlag == 1) {
     thrust::device_ptr<T> dev_ptr(deviceVec);
     thrust::device_ptr<T> dev_ptr_B(B);
@@ -130,12 +167,19 @@ void Array<T>::Sort(Array<T> *arrayB)
                                                     dev_ptr_B + size)),
        subSortCompare());
   }
+#endif
   if (cudaFlag == 0) {
-    thrust::sort
-      (thrust::make_zip_iterator(thrust::make_tuple(hostVec, B)),
-       thrust::make_zip_iterator(thrust::make_tuple(&(hostVec[size]),
-                                                    &(B[size]))),
-       subSortCompare());
+    std::vector<std::pair<T, T> > temp(size);
+    for (unsigned int i = 0; i < size; i++)
+      temp[i] = std::make_pair(hostVec[i], B[i]);
+
+    // Sort on first element, if equal use second
+    std::sort(temp.begin(), temp.end());
+
+    for (unsigned int i = 0; i < size; i++) {
+      hostVec[i] = temp[i].first;
+      B[i] = temp[i].second;
+    }
   }
 }
 
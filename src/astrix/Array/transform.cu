@@ -29,9 +29,9 @@ template <class T>
 void Array<T>::CopyToDevice()
 {
   // Make sure we have enough space...
-  if (deviceVec != 0) gpuErrchk(cudaFree(deviceVec));
-  gpuErrchk(cudaMalloc(reinterpret_cast<void**>(&deviceVec),
-                       nDims*realSize*sizeof(T)));
+  ArrayPool::Free(deviceVec, 1);
+  deviceVec = (T *)ArrayPool::Allocate(nDims*realSize*sizeof(T), 1);
+  nAllocationDevice++;
 
   gpuErrchk(cudaMemcpy(deviceVec, hostVec,
                        nDims*realSize*sizeof(T),
@@ -45,8 +45,9 @@ void Array<T>::CopyToDevice()
 template <class T>
 void Array<T>::CopyToHost()
 {
-  free(hostVec);
-  hostVec = (T *)malloc(nDims*realSize*sizeof(T));
+  ArrayPool::Free(hostVec, 0);
+  hostVec = (T *)ArrayPool::Allocate(nDims*realSize*sizeof(T), 0);
+  nAllocationHost++;
   gpuErrchk(cudaMemcpy(hostVec, deviceVec,
                        nDims*realSize*sizeof(T),
                        cudaMemcpyDeviceToHost));
@@ -63,11 +64,11 @@ void Array<T>::TransformToDevice()
   if (cudaFlag == 1) return;
 
   // Free any allocated device memory
-  if (deviceVec != 0) gpuErrchk(cudaFree(deviceVec));
+  ArrayPool::Free(deviceVec, 1);
 
   // Allocate fresh device memory
-  gpuErrchk(cudaMalloc(reinterpret_cast<void**>(&deviceVec),
-                       nDims*realSize*sizeof(T)));
+  deviceVec = (T *)ArrayPool::Allocate(nDims*realSize*sizeof(T), 1);
+  nAllocationDevice++;
 
   // Copy to device
   gpuErrchk(cudaMemcpy(deviceVec, hostVec,
@@ -89,10 +90,11 @@ void Array<T>::TransformToHost()
   if (cudaFlag == 0) return;
 
   // Free memory allocated on host
-  free(hostVec);
+  ArrayPool::Free(hostVec, 0);
 
   // Allocate fresh host memory
-  hostVec = (T *)malloc(nDims*realSize*sizeof(T));
+  hostVec = (T *)ArrayPool::Allocate(nDims*realSize*sizeof(T), 0);
+  nAllocationHost++;
 
   // Copy to host
   gpuErrchk(cudaMemcpy(hostVec, deviceVec,
@@ -100,7 +102,7 @@ void Array<T>::TransformToHost()
                        cudaMemcpyDeviceToHost));
 
   // Free device memory
-  gpuErrchk(cudaFree(deviceVec));
+  ArrayPool::Free(deviceVec, 1);
   deviceVec = 0;
 
   // Now living on host
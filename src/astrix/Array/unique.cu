@@ -57,7 +57,7 @@ void Array<T>::ScatterUnique(Array<int> *A, Array<int> *B,
     cudaOccupancyMaxPotentialBlockSize
       (&nBlocks, &nThreads, devScatterUnique<T>, (size_t) 0, 0);
 
-    devScatterUnique<<<nBlocks, nThreads>>>
+    LaunchKernel(nBlocks, nThreads, devScatterUnique)
       (maxIndex, pA, pB, deviceVec, ignoreValue, value);
 
     gpuErrchk( cudaPeekAtLastError() );
@@ -55,9 +55,10 @@ void Array<T>::SetToValue(T value)
                                        devSetToValue<T>,
                                        (size_t) 0, 0);
 
-    devSetToValue<<<nBlocks, nThreads>>>(size, deviceVec, value,
-                                         0, size,
-                                         realSize, nDims);
+    LaunchKernel(nBlocks, nThreads, devSetToValue)
+      (size, deviceVec, value,
+       0, size,
+       realSize, nDims);
     gpuErrchk( cudaPeekAtLastError() );
     gpuErrchk( cudaDeviceSynchronize() );
   }
@@ -86,9 +87,10 @@ void Array<T>::SetToValue(T value, unsigned int startIndex,
                                        devSetToValue<T>,
                                        (size_t) 0, 0);
 
-    devSetToValue<<<nBlocks, nThreads>>>(size, deviceVec, value,
-                                         startIndex, endIndex,
-                                         realSize, nDims);
+    LaunchKernel(nBlocks, nThreads, devSetToValue)
+      (size, deviceVec, value,
+       startIndex, endIndex,
+       realSize, nDims);
     gpuErrchk( cudaPeekAtLastError() );
     gpuErrchk( cudaDeviceSynchronize() );
   }
@@ -18,6 +18,8 @@ along with Astrix.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <algorithm>
 
+#ifndef CPU_ASTRIX
+
 //######################################################################
 //! Atomic add for double
 //######################################################################
@@ -50,16 +52,42 @@ __device__ inline int AstrixAtomicAdd(int* address, int val)
   return atomicAdd(address, val);
 }
 
+#endif  // CPU_ASTRIX
+
 namespace astrix {
 
 //######################################################################
-// Atomic add wrapper; on host do normal add
+// Atomic add wrapper; on host use compare-and-swap loop, so that it can
+// be used from OpenMP threads (also for floating point types)
 //######################################################################
 
 template<typename T>
 __host__ __device__
 T AtomicAdd(T *x, T y)
 {
+#ifndef __CUDA_ARCH__
+  T old, sum;
+  __atomic_load(x, &old, __ATOMIC_RELAXED);
+  do {
+    sum = old + y;
+  } while (!__atomic_compare_exchange(x, &old, &sum, true,
+                                      __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+  return old;
+#else
+  return AstrixAtomicAdd(x, y);
+#endif
+}
+
+//######################################################################
+// Add for scattering triangle contributions to vertices: atomic on the
+// device; host loops process triangles by colour, so that no two threads
+// update the same vertex and a normal add is enough
+//######################################################################
+
+template<typename T>
+__host__ __device__
+T ScatterAdd(T *x, T y)
+{
 #ifndef __CUDA_ARCH__
   T old = *x;
   *x += y;
@@ -70,7 +98,8 @@ T AtomicAdd(T *x, T y)
 }
 
 //######################################################################
-// Atomic max wrapper; on host do normal max
+// Atomic max wrapper; on host use compare-and-swap loop, so that it can
+// be used from OpenMP threads
 //######################################################################
 
 template<typename T>
@@ -78,8 +107,10 @@ __host__ __device__
 T AtomicMax(T *x, T y)
 {
 #ifndef __CUDA_ARCH__
-  T old = *x;
-  *x = std::max(old, y);
+  T old = __atomic_load_n(x, __ATOMIC_RELAXED);
+  while (old < y &&
+         !__atomic_compare_exchange_n(x, &old, y, true,
+                                      __ATOMIC_RELAXED, __ATOMIC_RELAXED));
   return old;
 #else
   return atomicMax(x, y);
@@ -87,7 +118,7 @@ T AtomicMax(T *x, T y)
 }
 
 //######################################################################
-// Atomic CAS wrapper; on host do normal CAS
+// Atomic CAS wrapper; returns old value of *x
 //######################################################################
 
 template<typename T>
@@ -95,16 +126,16 @@ __host__ __device__
 T AtomicCAS(T *x, T cmp, T y)
 {
 #ifndef __CUDA_ARCH__
-  T old = *x;
-  if (*x == cmp) *x = y;
-  return old;
+  __atomic_compare_exchange_n(x, &cmp, y, false,
+                              __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+  return cmp;
 #else
   return atomicCAS(x, cmp, y);
 #endif
 }
 
 //######################################################################
-// Atomic Exchange wrapper; on host do normal exchange
+// Atomic Exchange wrapper; returns old value of *x
 //######################################################################
 
 template<typename T>
@@ -112,14 +143,28 @@ __host__ __device__
 T AtomicExch(T *x, T y)
 {
 #ifndef __CUDA_ARCH__
-  T old = *x;
-  *x = y;
-  return old;
+  return __atomic_exchange_n(x, y, __ATOMIC_RELAXED);
 #else
   return atomicExch(x, y);
 #endif
 }
 
+//######################################################################
+// Atomic load wrapper, for reading values that other threads may be
+// modifying with the functions above
+//######################################################################
+
+template<typename T>
+__host__ __device__
+T AtomicLoad(T *x)
+{
+#ifndef __CUDA_ARCH__
+  return __atomic_load_n(x, __ATOMIC_RELAXED);
+#else
+  return *((volatile T *) x);
+#endif
+}
+
 }  // namespace astrix
 
 #endif  // ASTRIX_ATOMIC_H
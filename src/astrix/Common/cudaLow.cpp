@@ -12,7 +12,7 @@ Astrix is distributed in the hope that it will be useful, but WITHOUT ANY WARRAN
 
 You should have received a copy of the GNU General Public License
 along with Astrix.  If not, see <http://www.gnu.org/licenses/>.*/
-#include <cuda_runtime_api.h>
+#include "./cudaRuntime.h"
 #include <iostream>
 #include <fstream>
 #include <cstdlib>
@@ -16,6 +16,8 @@ along with Astrix.  If not, see <http://www.gnu.org/licenses/>.
 #ifndef ASTRIX_CUDA_LOW_H
 #define ASTRIX_CUDA_LOW_H
 
+#include "./cudaRuntime.h"
+
 //! Macro handling device errors through gpuAssert
 /*! Every CUDA function should be called using this macro, so that upon error
  the program exists indicating where the error occurred.*/
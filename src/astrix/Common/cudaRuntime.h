@@ -0,0 +1,243 @@
+/*! \file cudaRuntime.h
+\brief Header file providing the CUDA runtime, or host replacements for it.
+
+When compiling with nvcc, this simply includes the CUDA runtime API. When compiling a CPU-only build (CPU_ASTRIX defined, see target astrix-cpu in the Makefile), no CUDA toolkit is available and this file provides host versions of the CUDA vector types, the function qualifiers and the few runtime calls Astrix uses. Device memory can not be allocated in a CPU-only build; all work is done through the host (cudaFlag = 0) path.
+
+\section LICENSE
+Copyright (c) 2017 Sijme-Jan Paardekooper
+
+This file is part of Astrix.
+
+Astrix is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+
+Astrix is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Astrix.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef ASTRIX_CUDA_RUNTIME_H
+#define ASTRIX_CUDA_RUNTIME_H
+
+#ifndef CPU_ASTRIX
+
+#include <cuda_runtime.h>
+
+//! Launch kernel \a ... on \a nBlocks blocks of \a nThreads threads
+/*! Wrapper around the <<<nBlocks, nThreads>>> launch syntax, so that kernel launches compile in CPU-only builds. Use as LaunchKernel(nBlocks, nThreads, devKernel<T>)(arguments).*/
+#define LaunchKernel(nBlocks, nThreads, ...) __VA_ARGS__<<<nBlocks, nThreads>>>
+
+#else  // CPU_ASTRIX
+
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+//##############################################################################
+// Function qualifiers
+//##############################################################################
+
+#define __host__
+#define __device__
+#define __global__
+#define __forceinline__ __attribute__((always_inline)) inline
+
+//##############################################################################
+// Vector types, matching the layout of the CUDA types
+//##############################################################################
+
+struct __attribute__((aligned(8))) float2 { float x, y; };
+struct float3 { float x, y, z; };
+struct __attribute__((aligned(16))) float4 { float x, y, z, w; };
+struct __attribute__((aligned(16))) double2 { double x, y; };
+struct double3 { double x, y, z; };
+struct __attribute__((aligned(16))) double4 { double x, y, z, w; };
+struct __attribute__((aligned(8))) int2 { int x, y; };
+struct int3 { int x, y, z; };
+struct __attribute__((aligned(16))) int4 { int x, y, z, w; };
+struct __attribute__((aligned(8))) uint2 { unsigned int x, y; };
+struct uint3 { unsigned int x, y, z; };
+struct __attribute__((aligned(16))) uint4 { unsigned int x, y, z, w; };
+
+inline float2 make_float2(float x, float y)
+{ float2 r = {x, y}; return r; }
+inline float3 make_float3(float x, float y, float z)
+{ float3 r = {x, y, z}; return r; }
+inline float4 make_float4(float x, float y, float z, float w)
+{ float4 r = {x, y, z, w}; return r; }
+inline double2 make_double2(double x, double y)
+{ double2 r = {x, y}; return r; }
+inline double3 make_double3(double x, double y, double z)
+{ double3 r = {x, y, z}; return r; }
+inline double4 make_double4(double x, double y, double z, double w)
+{ double4 r = {x, y, z, w}; return r; }
+inline int2 make_int2(int x, int y)
+{ int2 r = {x, y}; return r; }
+inline int3 make_int3(int x, int y, int z)
+{ int3 r = {x, y, z}; return r; }
+inline int4 make_int4(int x, int y, int z, int w)
+{ int4 r = {x, y, z, w}; return r; }
+inline uint2 make_uint2(unsigned int x, unsigned int y)
+{ uint2 r = {x, y}; return r; }
+inline uint3 make_uint3(unsigned int x, unsigned int y, unsigned int z)
+{ uint3 r = {x, y, z}; return r; }
+inline uint4 make_uint4(unsigned int x, unsigned int y, unsigned int z,
+                        unsigned int w)
+{ uint4 r = {x, y, z, w}; return r; }
+
+//! Kernel launch dimensions
+struct dim3
+{
+  unsigned int x, y, z;
+  dim3(unsigned int _x = 1, unsigned int _y = 1, unsigned int _z = 1)
+    : x(_x), y(_y), z(_z) {}
+};
+
+// Kernels are compiled but never launched in a CPU-only build; these only
+// serve to make kernel bodies valid host code
+static const uint3 threadIdx = {0, 0, 0};
+static const uint3 blockIdx = {0, 0, 0};
+static const dim3 blockDim(1, 1, 1);
+static const dim3 gridDim(1, 1, 1);
+
+//##############################################################################
+// Math functions that CUDA provides for both host and device
+//##############################################################################
+
+inline int min(int a, int b) { return a < b ? a : b; }
+inline int max(int a, int b) { return a > b ? a : b; }
+inline unsigned int min(unsigned int a, unsigned int b)
+{ return a < b ? a : b; }
+inline unsigned int max(unsigned int a, unsigned int b)
+{ return a > b ? a : b; }
+// Floating point min and max return the other argument if one is NaN, as
+// fmin and fmax do, but are written as compare and select so that loops
+// using them can be vectorised
+inline float min(float a, float b) { return (a < b || b != b) ? a : b; }
+inline float max(float a, float b) { return (a > b || b != b) ? a : b; }
+inline double min(double a, double b) { return (a < b || b != b) ? a : b; }
+inline double max(double a, double b) { return (a > b || b != b) ? a : b; }
+inline double min(float a, double b) { return min((double) a, b); }
+inline double max(float a, double b) { return max((double) a, b); }
+inline double min(double a, float b) { return min(a, (double) b); }
+inline double max(double a, float b) { return max(a, (double) b); }
+
+using std::isnan;
+using std::isinf;
+
+inline float rsqrtf(float x) { return 1.0f/sqrtf(x); }
+inline double rsqrt(double x) { return 1.0/sqrt(x); }
+
+//##############################################################################
+// Runtime API
+//##############################################################################
+
+//! Error codes returned by the runtime replacements
+enum cudaError_t {cudaSuccess = 0,
+                  cudaErrorNoDevice = 100
+};
+typedef cudaError_t cudaError;
+
+//! Return string describing error \a code
+inline const char *cudaGetErrorString(cudaError_t code)
+{
+  if (code == cudaSuccess) return "no error";
+  return "no CUDA-capable device is available (CPU-only build)";
+}
+
+//! Direction of memory copies
+enum cudaMemcpyKind {cudaMemcpyHostToHost = 0,
+                     cudaMemcpyHostToDevice = 1,
+                     cudaMemcpyDeviceToHost = 2,
+                     cudaMemcpyDeviceToDevice = 3
+};
+
+//! No devices are available in a CPU-only build
+inline cudaError_t cudaGetDeviceCount(int *count)
+{
+  *count = 0;
+  return cudaSuccess;
+}
+
+inline cudaError_t cudaDeviceReset() { return cudaSuccess; }
+inline cudaError_t cudaDeviceSynchronize() { return cudaSuccess; }
+inline cudaError_t cudaPeekAtLastError() { return cudaSuccess; }
+
+inline cudaError_t cudaMalloc(void **devPtr, std::size_t size)
+{
+  *devPtr = 0;
+  return cudaErrorNoDevice;
+}
+inline cudaError_t cudaFree(void *devPtr)
+{
+  return (devPtr == 0 ? cudaSuccess : cudaErrorNoDevice);
+}
+inline cudaError_t cudaMemcpy(void *dst, const void *src,
+                              std::size_t count, cudaMemcpyKind kind)
+{
+  return cudaErrorNoDevice;
+}
+
+template<class T>
+inline cudaError_t cudaOccupancyMaxPotentialBlockSize(int *minGridSize,
+                                                      int *blockSize,
+                                                      T func,
+                                                      std::size_t dynSMem,
+                                                      int blockSizeLimit)
+{
+  *minGridSize = 1;
+  *blockSize = 1;
+  return cudaSuccess;
+}
+
+//! Events measure host wall clock time in a CPU-only build
+typedef std::chrono::steady_clock::time_point *cudaEvent_t;
+
+inline cudaError_t cudaEventCreate(cudaEvent_t *event)
+{
+  *event = new std::chrono::steady_clock::time_point();
+  return cudaSuccess;
+}
+inline cudaError_t cudaEventDestroy(cudaEvent_t event)
+{
+  delete event;
+  return cudaSuccess;
+}
+inline cudaError_t cudaEventRecord(cudaEvent_t event, int stream = 0)
+{
+  *event = std::chrono::steady_clock::now();
+  return cudaSuccess;
+}
+inline cudaError_t cudaEventSynchronize(cudaEvent_t event)
+{
+  return cudaSuccess;
+}
+//! Elapsed time between events in milliseconds
+inline cudaError_t cudaEventElapsedTime(float *ms, cudaEvent_t start,
+                                        cudaEvent_t stop)
+{
+  *ms = std::chrono::duration<float, std::milli>(*stop - *start).count();
+  return cudaSuccess;
+}
+
+namespace astrix {
+
+//! Stand-in for a kernel launch in a CPU-only build
+/*! All device code paths require cudaFlag = 1, which is refused by Device in a CPU-only build. Reaching a kernel launch is therefore a logic error.*/
+template<typename... Args>
+void NoDeviceLaunch(Args... args)
+{
+  std::cout << "Kernel launch in CPU-only build" << std::endl;
+  throw std::runtime_error("");
+}
+
+}  // namespace astrix
+
+#define LaunchKernel(nBlocks, nThreads, ...) astrix::NoDeviceLaunch
+
+#endif  // CPU_ASTRIX
+
+#endif  // ASTRIX_CUDA_RUNTIME_H
@@ -16,6 +16,8 @@ along with Astrix.  If not, see <http://www.gnu.org/licenses/>.
 #ifndef ASTRIX_DEFINITIONS_H
 #define ASTRIX_DEFINITIONS_H
 
+#include "./cudaRuntime.h"
+
 /*! \namespace astrix
 \brief Namespace encapsulating all of Astrix
 */
@@ -23,7 +23,7 @@
 #ifndef ASTRIX_HELPER_MATH_H
 #define ASTRIX_HELPER_MATH_H
 
-#include "cuda_runtime.h"
+#include "./cudaRuntime.h"
 
 typedef unsigned int uint;
 typedef unsigned short ushort;
@@ -32,7 +32,7 @@ typedef unsigned short ushort;
 #define EXIT_WAIVED 2
 #endif
 
-#ifndef __CUDACC__
+#if !defined(__CUDACC__) && !defined(CPU_ASTRIX)
 #include <math.h>
 
 ////////////////////////////////////////////////////////////////////////////////
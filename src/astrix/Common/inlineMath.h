@@ -35,6 +35,28 @@ __host__ __device__ inline int Sign(const T a) {
   return a >= (T) 0 ? 1 : -1;
 }
 
+//###################################################
+// Pseudo-random number in [0, 2^31) for index i. This
+// is a bijection on [0, 2^31): different indices give
+// different numbers, so it can be used as a random
+// permutation without storing it. Every step (xor with
+// shifted self, multiplication by odd number modulo
+// 2^31) is invertible.
+//###################################################
+
+__host__ __device__ inline unsigned int UniqueRandom(unsigned int i) {
+  const unsigned int mask = 0x7fffffffu;
+
+  unsigned int x = i & mask;
+  x ^= x >> 16;
+  x = (x*0x7feb352du) & mask;
+  x ^= x >> 15;
+  x = (x*0x846ca68bu) & mask;
+  x ^= x >> 16;
+
+  return x;
+}
+
 }  // namespace astrix
 
 #endif
@@ -14,10 +14,22 @@ Astrix is distributed in the hope that it will be useful, but WITHOUT ANY WARRAN
 You should have received a copy of the GNU General Public License
 along with Astrix.  If not, see <http://www.gnu.org/licenses/>.
 */
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <stdexcept>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 #include "./nvtxEvent.h"
 
 namespace astrix {
 
+int nvtxEvent::traceFlag = 0;
+std::chrono::steady_clock::time_point nvtxEvent::traceStart;
+std::vector<nvtxEvent::TraceEvent> nvtxEvent::trace;
+
 uint32_t nvtxEvent::colors[] = {
   0x0000ff00,
   0x000000ff,
@@ -36,6 +48,12 @@ nvtxEvent::nvtxEvent(const char *name, int _colorID)
 {
   colorID = _colorID % num_colors;
 
+  if (traceFlag == 1) {
+    traceName = name;
+    startTime = std::chrono::steady_clock::now();
+  }
+
+#ifndef CPU_ASTRIX
   // Set attributes
   nvtxEventAttributes_t eventAttrib = {0};
   eventAttrib.version = NVTX_VERSION;
@@ -47,6 +65,7 @@ nvtxEvent::nvtxEvent(const char *name, int _colorID)
 
   // Push event
   nvtxRangePushEx(&eventAttrib);
+#endif
 }
 
 //#############################################################################
@@ -55,8 +74,81 @@ nvtxEvent::nvtxEvent(const char *name, int _colorID)
 
 nvtxEvent::~nvtxEvent()
 {
+#ifndef CPU_ASTRIX
   // Pop event
   nvtxRangePop();
+#endif
+
+  if (traceFlag == 1) {
+    std::chrono::steady_clock::time_point endTime =
+      std::chrono::steady_clock::now();
+
+    TraceEvent e;
+    e.name = traceName;
+    e.start = std::chrono::duration<double, std::micro>
+      (startTime - traceStart).count();
+    e.duration = std::chrono::duration<double, std::micro>
+      (endTime - startTime).count();
+    e.thread = 0;
+#ifdef _OPENMP
+    e.thread = omp_get_thread_num();
+#endif
+    e.colorID = colorID;
+
+#pragma omp critical (nvtxTrace)
+    trace.push_back(e);
+  }
+}
+
+//#############################################################################
+/*! Start recording events for a host time line. Events that exist at the
+time tracing is enabled are not recorded.*/
+//#############################################################################
+
+void nvtxEvent::EnableTrace()
+{
+  traceFlag = 1;
+  traceStart = std::chrono::steady_clock::now();
+}
+
+//#############################################################################
+/*! Write all recorded events to \a fileName as complete events in the Chrome
+trace event format. Nothing is written if tracing is not enabled.
+
+\param *fileName Output file name*/
+//#############################################################################
+
+void nvtxEvent::WriteTrace(const char *fileName)
+{
+  if (traceFlag == 0) return;
+
+  std::ofstream outFile;
+  outFile.open(fileName);
+
+  outFile << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [";
+
+  for (unsigned int i = 0; i < trace.size(); i++) {
+    if (i > 0) outFile << ",";
+    outFile << std::endl << std::fixed << std::setprecision(3)
+            << "  {\"name\": \"" << trace[i].name << "\", "
+            << "\"ph\": \"X\", "
+            << "\"ts\": " << trace[i].start << ", "
+            << "\"dur\": " << trace[i].duration << ", "
+            << "\"pid\": 0, "
+            << "\"tid\": " << trace[i].thread << ", "
+            << "\"args\": {\"color\": \"#"
+            << std::hex << std::setw(6) << std::setfill('0')
+            << (colors[trace[i].colorID] & 0x00ffffff)
+            << std::dec << std::setfill(' ') << "\"}}";
+  }
+
+  outFile << std::endl << "]}" << std::endl;
+  outFile.close();
+
+  if (!outFile) {
+    std::cout << "Error writing " << fileName << std::endl;
+    throw std::runtime_error("");
+  }
 }
 
 }  // namespace astrix
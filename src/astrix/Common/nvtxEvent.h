@@ -17,7 +17,13 @@ along with Astrix.  If not, see <http://www.gnu.org/licenses/>.
 #ifndef ASTRIX_NVTX_EVENT_H
 #define ASTRIX_NVTX_EVENT_H
 
+#ifndef CPU_ASTRIX
 #include <nvToolsExt.h>
+#endif
+#include <cstdint>
+#include <chrono>
+#include <string>
+#include <vector>
 
 namespace astrix {
 
@@ -25,7 +31,12 @@ namespace astrix {
 /*! The NVIDIA Visual Profiler allows for user-defined colors to appear in the
 time line to easily identify functions that take up most of the time. Creating
  an nvtxEvent object starts such a colored time line, while destroying it ends
-the time line.*/
+the time line. In a CPU-only build, no NVTX events are created.
+
+If tracing is enabled (see EnableTrace()), every event is also recorded on the
+host as a range with name, start time, duration and thread, in both CUDA and
+CPU-only builds. WriteTrace() writes these in the Chrome trace event format,
+which can be viewed in chrome://tracing or Perfetto.*/
 class nvtxEvent
 {
  public:
@@ -38,7 +49,39 @@ class nvtxEvent
   //! Destroy NVTX event
   ~nvtxEvent();
 
+  //! Start recording events for a host time line
+  static void EnableTrace();
+  //! Write recorded events to file \a fileName in Chrome trace format
+  static void WriteTrace(const char *fileName);
+
  private:
+  //! Event as recorded for host time line
+  struct TraceEvent
+  {
+    //! Name of event
+    std::string name;
+    //! Start time (microseconds since EnableTrace())
+    double start;
+    //! Duration (microseconds)
+    double duration;
+    //! Thread that created event
+    int thread;
+    //! Color ID of event
+    int colorID;
+  };
+
+  //! Name of this event (only kept when tracing)
+  std::string traceName;
+  //! Creation time of this event
+  std::chrono::steady_clock::time_point startTime;
+
+  //! Flag whether to record events
+  static int traceFlag;
+  //! Time tracing was enabled
+  static std::chrono::steady_clock::time_point traceStart;
+  //! Recorded events
+  static std::vector<TraceEvent> trace;
+
   //! Color for this event
   int colorID;
   //! Number of available colors
@@ -1,5 +1,5 @@
 /*! \file profile.cpp
-\brief Output simple profiling information
+\brief Collect kernel timings in memory and output them as JSON
 
 \section LICENSE
 Copyright (c) 2017 Sijme-Jan Paardekooper
@@ -13,60 +13,125 @@ Astrix is distributed in the hope that it will be useful, but WITHOUT ANY WARRAN
 You should have received a copy of the GNU General Public License
 along with Astrix.  If not, see <http://www.gnu.org/licenses/>.*/
 #include <iostream>
+#include <iomanip>
 #include <fstream>
+#include <stdexcept>
+#include <cstdint>
+#include <string>
+#include <map>
 
 #include "./profile.h"
 
 namespace astrix {
 
+//! Accumulated timings of one region on either host or device
+struct ProfileRegion
+{
+  //! Number of invocations
+  int64_t nCall;
+  //! Total number of elements processed
+  int64_t nElement;
+  //! Total elapsed time (ms)
+  double totalTime;
+  //! Minimum elapsed time of single invocation (ms)
+  double minTime;
+  //! Maximum elapsed time of single invocation (ms)
+  double maxTime;
+
+  ProfileRegion() : nCall(0), nElement(0), totalTime(0.0),
+                    minTime(0.0), maxTime(0.0) {}
+};
+
+//! All regions, with separate timings for host (0) and device (1)
+static std::map<std::string, ProfileRegion[2]> profileRegions;
+//! Number of time steps between profile dumps (0: only at exit)
+static int profileInterval = 0;
+
 //#########################################################################
-//
+// Add timing of one invocation to region regionName
 //#########################################################################
 
-void WriteProfileFile(const char *fileName, int nElement,
-                      float elapsedTime, int cudaFlag)
+void AddProfile(const char *regionName, int nElement,
+                float elapsedTime, int cudaFlag)
 {
-  int maxElementCPU = 0;
-  float maxTimeCPU = 0.0;
-  float totalTimeCPU = 0.0;
-  int maxElementGPU = 0;
-  float maxTimeGPU = 0.0;
-  float totalTimeGPU = 0.0;
-
-  // Read current file if it exists
-  std::ifstream infile;
-  infile.open(fileName);
-  if (infile.is_open()) {
-    // Get current number of elements and elapsed time
-    infile >> maxElementCPU >> maxTimeCPU >> totalTimeCPU;
-    infile >> maxElementGPU >> maxTimeGPU >> totalTimeGPU;
-  }
-  infile.close();
+  ProfileRegion& p = profileRegions[regionName][cudaFlag];
 
-  if (cudaFlag == 1) {
-    totalTimeGPU += elapsedTime;
-    if (maxElementGPU < nElement) {
-      maxElementGPU = nElement;
-      maxTimeGPU = elapsedTime;
-    }
-  } else {
-    totalTimeCPU += elapsedTime;
-    if (maxElementCPU < nElement) {
-      maxElementCPU = nElement;
-      maxTimeCPU = elapsedTime;
+  if (p.nCall == 0 || elapsedTime < p.minTime) p.minTime = elapsedTime;
+  if (p.nCall == 0 || elapsedTime > p.maxTime) p.maxTime = elapsedTime;
+
+  p.nCall++;
+  p.nElement += nElement;
+  p.totalTime += elapsedTime;
+}
+
+//#########################################################################
+/*! Write all regions to JSON file \a fileName as a list of records, one for
+every region and device it ran on. Times are in ms; \a nsPerElement is the
+total time divided by the total number of elements processed.*/
+//#########################################################################
+
+void WriteProfile(const char *fileName)
+{
+  if (profileRegions.size() == 0) return;
+
+  const char *deviceName[2] = {"host", "device"};
+
+  std::ofstream outFile;
+  outFile.open(fileName);
+
+  outFile << "{" << std::endl << "  \"regions\": [";
+
+  int first = 1;
+  for (std::map<std::string, ProfileRegion[2]>::iterator it =
+         profileRegions.begin(); it != profileRegions.end(); ++it) {
+    for (int c = 0; c < 2; c++) {
+      ProfileRegion& p = it->second[c];
+      if (p.nCall == 0) continue;
+
+      double nsPerElement = 0.0;
+      if (p.nElement > 0) nsPerElement = 1.0e6*p.totalTime/p.nElement;
+
+      if (first == 0) outFile << ",";
+      first = 0;
+
+      outFile << std::endl << std::setprecision(8)
+              << "    {\"name\": \"" << it->first << "\", "
+              << "\"device\": \"" << deviceName[c] << "\", "
+              << "\"calls\": " << p.nCall << ", "
+              << "\"elements\": " << p.nElement << ", "
+              << "\"totalTime\": " << p.totalTime << ", "
+              << "\"minTime\": " << p.minTime << ", "
+              << "\"maxTime\": " << p.maxTime << ", "
+              << "\"nsPerElement\": " << nsPerElement << "}";
     }
   }
 
-  std::ofstream outfile;
-  outfile.open(fileName);
+  outFile << std::endl << "  ]" << std::endl << "}" << std::endl;
+  outFile.close();
+
+  if (!outFile) {
+    std::cout << "Error writing " << fileName << std::endl;
+    throw std::runtime_error("");
+  }
+}
+
+//#########################################################################
+// Set number of time steps between profile dumps
+//#########################################################################
+
+void SetProfileInterval(int nStep)
+{
+  profileInterval = nStep;
+}
+
+//#########################################################################
+// Write profile if nTimeStep is a multiple of the interval
+//#########################################################################
 
-  outfile << maxElementCPU << " "
-          << maxTimeCPU << " "
-          << totalTimeCPU << std::endl;
-  outfile << maxElementGPU << " "
-          << maxTimeGPU << " "
-          << totalTimeGPU << std::endl;
-  outfile.close();
+void WriteProfileInterval(int nTimeStep)
+{
+  if (profileInterval > 0 && nTimeStep % profileInterval == 0)
+    WriteProfile("profile.json");
 }
 
 }  // namespace astrix
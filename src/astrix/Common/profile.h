@@ -1,5 +1,5 @@
 /*! \file profile.h
-\brief Header file for writing profile info to file.
+\brief Header file for collecting kernel timings in memory and writing them to file.
 
 \section LICENSE
 Copyright (c) 2017 Sijme-Jan Paardekooper
@@ -18,13 +18,27 @@ along with Astrix.  If not, see <http://www.gnu.org/licenses/>.
 
 namespace astrix {
 
-//! Write kernel profiling info to file
-/*! Write simple statistics to text file
+//! Add timing of one invocation of a kernel to the profile
+/*! Timings are accumulated in memory per region and per device; nothing is written to disc until WriteProfile() is called.
+  \param *regionName Name of region (usually the kernel name)
+  \param nElement Number of elements processed
+  \param elapsedTime Elapsed time (ms)
+  \param cudaFlag Kernel ran on host (=0) or device (=1)
+*/
+void AddProfile(const char *regionName, int nElement,
+                float elapsedTime, int cudaFlag);
+
+//! Write accumulated profile of all regions to JSON file
+/*! Nothing is written if no timings have been recorded, which is the case if Astrix is compiled without TIME_ASTRIX.
   \param *fileName Output file name
-  \param X Number of elements processed
-  \param T Elapsed time
 */
-void WriteProfileFile(const char *fileName, int X, float T, int cudaFlag);
+void WriteProfile(const char *fileName);
+
+//! Set number of time steps between profile dumps (0: only at exit)
+void SetProfileInterval(int nStep);
+
+//! Write profile to profile.json if \a nTimeStep is a multiple of the interval
+void WriteProfileInterval(int nTimeStep);
 
 }  // namespace astrix
 
@@ -16,8 +16,13 @@ along with Astrix.  If not, see <http://www.gnu.org/licenses/>.
 #ifndef ASTRIX_STATE_H
 #define ASTRIX_STATE_H
 
+#include <iostream>
+#include <stdexcept>
+
 namespace astrix {
 
+template <class T> class Array;
+
   namespace state {
 
     //! Return density from state vector: by default, return zero
@@ -177,6 +182,230 @@ namespace astrix {
       state.w = ener;
     }
 
+    //######################################################################
+    // Memory layout of state vector arrays. By default, an Array<real4>
+    // stores one real4 after another (array of structures). If compiled
+    // with SOA_ASTRIX, arrays accessed through state::Pointer store every
+    // component contiguously (structure of arrays): component c of entry n
+    // of dimension d sits at GetPointer(d) + c*GetRealSize() + n, counted
+    // in units of real. Kernels index a state::Pointer as if it were a
+    // realNeq*, so that they do not depend on the layout. Such arrays must
+    // be passed to state::SetLayout() once after construction, so that
+    // Array::SetSize() and Array::SetEqual() move whole component blocks;
+    // state::GetPointer() checks this. Other Array operations (Compact,
+    // Reindex, Gather, ...) are not layout-aware and must not be used on
+    // them.
+    //######################################################################
+
+#ifndef SOA_ASTRIX
+
+    //! Pointer to state vectors stored as array of structures
+    template<class realNeq> using Pointer = realNeq*;
+    //! Read-only pointer to state vectors, not aliased by other pointers
+    template<class realNeq> using ConstPointer = const realNeq* __restrict__;
+
+    //! Set memory layout of Array \a a accessed through state::Pointer
+    template<class realNeq>
+      inline void SetLayout(Array<realNeq> *a) { }
+    //! Pointer to state vectors for dimension \a dim of Array \a a
+    template<class realNeq>
+      inline Pointer<realNeq> GetPointer(const Array<realNeq> *a,
+                                         unsigned int dim = 0) {
+      return a->GetPointer(dim);
+    }
+    //! Pointer to local storage for \a stride state vectors at \a *p
+    template<class realNeq>
+      __host__ __device__
+      inline Pointer<realNeq> MakePointer(realNeq *p, unsigned int stride) {
+      return p;
+    }
+
+#else
+
+    //! Reference to state vector stored as structure of arrays
+    /*! Behaves as a realNeq&: components can be read and written through
+      the members x, y, z (and w), and the whole state vector can be read
+      and assigned. Only specialisations for real3 and real4 exist.*/
+    template<class realNeq> class Reference;
+
+    //! Reference to real3 stored as structure of arrays
+    template<>
+      class Reference<real3> {
+    public:
+      __host__ __device__
+        Reference(real *p, unsigned int stride) :
+      x(p[0]), y(p[stride]), z(p[2*stride]) {}
+
+      __host__ __device__
+        operator real3() const {
+        real3 s;
+        s.x = x;
+        s.y = y;
+        s.z = z;
+        return s;
+      }
+      __host__ __device__
+        Reference& operator=(const real3& s) {
+        x = s.x;
+        y = s.y;
+        z = s.z;
+        return *this;
+      }
+      __host__ __device__
+        Reference& operator=(const Reference& r) {
+        return *this = (real3) r;
+      }
+      __host__ __device__
+        Reference& operator+=(const real3& s) {
+        x += s.x;
+        y += s.y;
+        z += s.z;
+        return *this;
+      }
+      __host__ __device__
+        Reference& operator-=(const real3& s) {
+        x -= s.x;
+        y -= s.y;
+        z -= s.z;
+        return *this;
+      }
+
+      //! First component
+      real &x;
+      //! Second component
+      real &y;
+      //! Third component
+      real &z;
+    };
+
+    //! Reference to real4 stored as structure of arrays
+    template<>
+      class Reference<real4> {
+    public:
+      __host__ __device__
+        Reference(real *p, unsigned int stride) :
+      x(p[0]), y(p[stride]), z(p[2*stride]), w(p[3*stride]) {}
+
+      __host__ __device__
+        operator real4() const {
+        real4 s;
+        s.x = x;
+        s.y = y;
+        s.z = z;
+        s.w = w;
+        return s;
+      }
+      __host__ __device__
+        Reference& operator=(const real4& s) {
+        x = s.x;
+        y = s.y;
+        z = s.z;
+        w = s.w;
+        return *this;
+      }
+      __host__ __device__
+        Reference& operator=(const Reference& r) {
+        return *this = (real4) r;
+      }
+      __host__ __device__
+        Reference& operator+=(const real4& s) {
+        x += s.x;
+        y += s.y;
+        z += s.z;
+        w += s.w;
+        return *this;
+      }
+      __host__ __device__
+        Reference& operator-=(const real4& s) {
+        x -= s.x;
+        y -= s.y;
+        z -= s.z;
+        w -= s.w;
+        return *this;
+      }
+
+      //! First component
+      real &x;
+      //! Second component
+      real &y;
+      //! Third component
+      real &z;
+      //! Fourth component
+      real &w;
+    };
+
+    //! Pointer to state vectors stored as structure of arrays
+    template<class realNeq>
+      class Pointer {
+    public:
+      __host__ __device__
+        Pointer(real *_p, unsigned int _stride) : p(_p), stride(_stride) {}
+
+      __host__ __device__
+        Reference<realNeq> operator[](int n) const {
+        return Reference<realNeq>(p + n, stride);
+      }
+      __host__ __device__
+        Pointer operator+(int n) const {
+        return Pointer(p + n, stride);
+      }
+
+    private:
+      //! First component of first state vector
+      real *p;
+      //! Distance between components (in units of real)
+      unsigned int stride;
+    };
+
+    //! Pointer to scalar state: layouts are identical
+    template<>
+      class Pointer<real> {
+    public:
+      __host__ __device__
+        Pointer(real *_p, unsigned int _stride) : p(_p) {}
+
+      __host__ __device__
+        real& operator[](int n) const {
+        return p[n];
+      }
+      __host__ __device__
+        Pointer operator+(int n) const {
+        return Pointer(p + n, 1);
+      }
+
+    private:
+      //! First state
+      real *p;
+    };
+
+    //! Read-only pointer to state vectors
+    template<class realNeq> using ConstPointer = Pointer<realNeq>;
+
+    //! Set memory layout of Array \a a accessed through state::Pointer
+    template<class realNeq>
+      inline void SetLayout(Array<realNeq> *a) {
+      a->SetComponentLayout(sizeof(realNeq)/sizeof(real));
+    }
+    //! Pointer to state vectors for dimension \a dim of Array \a a
+    template<class realNeq>
+      inline Pointer<realNeq> GetPointer(const Array<realNeq> *a,
+                                         unsigned int dim = 0) {
+      if (a->GetComponentLayout() != sizeof(realNeq)/sizeof(real)) {
+        std::cout << "Error in state::GetPointer: Array not set to "
+                  << "structure of arrays layout" << std::endl;
+        throw std::runtime_error("");
+      }
+      return Pointer<realNeq>((real *) a->GetPointer(dim), a->GetRealSize());
+    }
+    //! Pointer to local storage for \a stride state vectors at \a *p
+    template<class realNeq>
+      __host__ __device__
+      inline Pointer<realNeq> MakePointer(realNeq *p, unsigned int stride) {
+      return Pointer<realNeq>((real *) p, stride);
+    }
+
+#endif  // SOA_ASTRIX
+
   }  // namespace state
 
 }  // namespace astrix
@@ -0,0 +1,103 @@
+/*! \file workqueue.h
+\brief Header file for distributing host loops over OpenMP threads with work stealing.
+
+\section LICENSE
+Copyright (c) 2017 Sijme-Jan Paardekooper
+
+This file is part of Astrix.
+
+Astrix is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+
+Astrix is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Astrix.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef ASTRIX_WORKQUEUE_H
+#define ASTRIX_WORKQUEUE_H
+
+#include <cstdint>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace astrix {
+
+//! Distribute loop over [0, n) over OpenMP threads with work stealing
+/*! Every thread starts on its own contiguous part of [0, n), so that on a Morton-ordered mesh threads work in different regions of the mesh and rarely compete for the same triangles. Work is taken in chunks of \a chunkSize elements. A thread that has finished its own part steals chunks from the parts of the other threads, so that a few large cavities do not leave the other threads idle. Construct outside a parallel region and call Next() from inside:
+
+\code
+WorkQueue queue(n, 64);
+#pragma omp parallel
+{
+  int begin, end;
+  while (queue.Next(begin, end))
+    for (int i = begin; i < end; i++) ...
+}
+\endcode
+
+Without OpenMP there is a single part and Next() simply returns consecutive chunks.*/
+class WorkQueue
+{
+ public:
+  //! Constructor; split [0, \a n) into one part per thread
+  WorkQueue(int n, int chunkSize)
+  {
+    nPart = 1;
+#ifdef _OPENMP
+    nPart = omp_get_max_threads();
+#endif
+    chunk = chunkSize;
+    part.resize(nPart);
+    for (int i = 0; i < nPart; i++) {
+      part[i].next = (int) ((int64_t) n*i/nPart);
+      part[i].end = (int) ((int64_t) n*(i + 1)/nPart);
+    }
+  }
+
+  //! Get next chunk [\a begin, \a end) for the calling thread
+  /*! Returns 0 if all work has been handed out.*/
+  bool Next(int &begin, int &end)
+  {
+    int self = 0;
+#ifdef _OPENMP
+    self = omp_get_thread_num() % nPart;
+#endif
+    // Own part first, then steal from the others
+    for (int i = 0; i < nPart; i++) {
+      Part *p = &part[(self + i) % nPart];
+      if (__atomic_load_n(&(p->next), __ATOMIC_RELAXED) >= p->end) continue;
+      begin = __atomic_fetch_add(&(p->next), chunk, __ATOMIC_RELAXED);
+      if (begin < p->end) {
+        end = begin + chunk;
+        if (end > p->end) end = p->end;
+        return 1;
+      }
+    }
+    return 0;
+  }
+
+ private:
+  //! Part of the loop initially assigned to one thread
+  struct Part {
+    //! Start of next chunk to hand out
+    int next;
+    //! End of part
+    int end;
+    //! Keep counters of different threads in separate cache lines
+    char pad[56];
+  };
+
+  //! Number of parts (threads)
+  int nPart;
+  //! Number of elements handed out at a time
+  int chunk;
+  //! Parts of the loop, one per thread
+  std::vector<Part> part;
+};
+
+}  // namespace astrix
+
+#endif  // ASTRIX_WORKQUEUE_H
@@ -13,11 +13,15 @@ Astrix is distributed in the hope that it will be useful, but WITHOUT ANY WARRAN
 You should have received a copy of the GNU General Public License
 along with Astrix.  If not, see <http://www.gnu.org/licenses/>.
 */
-#include <cuda_runtime_api.h>
+#include "../Common/cudaRuntime.h"
 #include <iostream>
 #include <stdexcept>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 #include "device.h"
+#include "../Array/pool.h"
 
 namespace astrix {
 
@@ -25,10 +29,18 @@ namespace astrix {
 // Initialise CUDA
 //###########################################################################
 
-Device::Device(int _cudaFlag)
+Device::Device(int _cudaFlag, int _nThreads)
 {
   cudaFlag = _cudaFlag;
 
+  // Threads for parallel loops on host; without OpenMP these are serial
+  nThreads = 1;
+#ifdef _OPENMP
+  if (_nThreads > 0) omp_set_num_threads(_nThreads);
+  nThreads = omp_get_max_threads();
+#endif
+  std::cout << "Host threads: " << nThreads << std::endl;
+
   // Check for CUDA capable devices
   deviceCount = 0;
   cudaError_t error_id = cudaGetDeviceCount(&deviceCount);
@@ -50,6 +62,7 @@ Device::Device(int _cudaFlag)
                 << " CUDA Capable device(s)" << std::endl;
     }
 
+#ifndef CPU_ASTRIX
     // Output some device properties
     for (int dev = 0; dev < deviceCount; ++dev) {
       cudaGetDeviceProperties(&prop, dev);
@@ -90,6 +103,7 @@ Device::Device(int _cudaFlag)
       std::cout << "    Theoretical bandwidth: "
                 << bandWidth << " GB/s" << std::endl;
     }
+#endif
   } else {
     std::cout << "Not using CUDA device" << std::endl;
   }
@@ -101,6 +115,9 @@ Device::Device(int _cudaFlag)
 
 Device::~Device()
 {
+  // Cached device memory has to be released before reset
+  ArrayPool::Release();
+
   if (cudaFlag == 1) cudaDeviceReset();
 }
 
@@ -123,4 +140,13 @@ int Device::GetCudaFlag()
   return cudaFlag;
 }
 
+//###########################################################################
+// Return number of threads used on host
+//###########################################################################
+
+int Device::GetThreadCount()
+{
+  return nThreads;
+}
+
 }  // namespace astrix
@@ -17,10 +17,12 @@ along with Astrix.  If not, see <http://www.gnu.org/licenses/>.
 #ifndef ASTRIX_DEVICE_H
 #define ASTRIX_DEVICE_H
 
+#include "../Common/cudaRuntime.h"
+
 namespace astrix {
 
 //! Simple class containing information about device
-/*! This class is used to hold some very basic information about the machine the simulation is run on: whether we want to use any CUDA capable device, and how many CUDA-capable devices there are in total.
+/*! This class is used to hold some very basic information about the machine the simulation is run on: whether we want to use any CUDA capable device, how many CUDA-capable devices there are in total, and how many threads are used for computations on the host.
 */
 
 class Device
@@ -28,9 +30,9 @@ class Device
  public:
   //! Constructor
   /*! Construct Device object. Count number of CUDA-capable devices and display capabilities on screen. By default, device 0 is used.
-    \param _cudaFlag Flag whether to run on CUDA device. If set to zero, still count CUDA devices but do not use them to for computation.*/
-
-  explicit Device(int _cudaFlag);
+    \param _cudaFlag Flag whether to run on CUDA device. If set to zero, still count CUDA devices but do not use them to for computation.
+    \param _nThreads Number of threads for host computations. If zero, use the OpenMP default (OMP_NUM_THREADS or all cores).*/
+  Device(int _cudaFlag, int _nThreads);
   //! Destructor
   /*! Free Device object. If using CUDA, reset device for clean exit.*/
   ~Device();
@@ -39,13 +41,19 @@ class Device
   int GetDeviceCount();
   //! Return flag whether using CUDA
   int GetCudaFlag();
+  //! Return number of threads used on host
+  int GetThreadCount();
 
+#ifndef CPU_ASTRIX
   cudaDeviceProp prop;
+#endif
  private:
   //! Flag whether using CUDA device
   int cudaFlag;
   //! Number of CUDA-capable devices
   int deviceCount;
+  //! Number of threads used for host computations
+  int nThreads;
 };
 
 }  // namespace astrix
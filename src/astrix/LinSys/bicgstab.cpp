@@ -1,5 +1,6 @@
 // -*-c++-*-
 /*! \file bicgstab.cpp
+\brief Preconditioned BiCGStab solver
 
 \section LICENSE
 Copyright (c) 2017 Sijme-Jan Paardekooper
@@ -13,91 +14,131 @@ Astrix is distributed in the hope that it will be useful, but WITHOUT ANY WARRAN
 You should have received a copy of the GNU General Public License
 along with Astrix.  If not, see <http://www.gnu.org/licenses/>.
 */
-#include <cuda_runtime_api.h>
+#include "../Common/cudaRuntime.h"
 #include <iostream>
+#include <cmath>
+#include <chrono>
 
 #include "../Common/definitions.h"
 #include "../Array/array.h"
-#include "../Mesh/mesh.h"
-#include "../Device/device.h"
+#include "./linsys.h"
 
 namespace astrix {
 
-void LinSys::BiCGStab(Array<real> *x, Array<real> *b, int l)
+//#########################################################################
+/*! Solve A x = b with the right-preconditioned BiCGStab method of van der Vorst (1992). On entry, \a x holds the initial guess; on exit the approximate solution. Iteration stops once the residual |b - A x| is smaller than \a tolerance |b|, or after \a maxIter iterations. Returns the number of iterations used.
+
+\param *A Linear operator
+\param *x Solution vector (input: initial guess)
+\param *b Right-hand side
+\param maxIter Maximum number of iterations
+\param tolerance Required reduction of residual*/
+//#########################################################################
+
+int LinSys::BiCGStab(LinearOperator *A, Array<real> *x, Array<real> *b,
+                     int maxIter, real tolerance)
 {
+  auto start = std::chrono::high_resolution_clock::now();
+
+  unsigned int N = b->GetSize();
+
+  r->SetSize(N);
+  rhat->SetSize(N);
+  p->SetSize(N);
+  phat->SetSize(N);
+  v->SetSize(N);
+  s->SetSize(N);
+  shat->SetSize(N);
+  t->SetSize(N);
+
+  real bNorm = sqrt(b->InnerProduct(b));
+  if (bNorm == (real) 0.0) bNorm = (real) 1.0;
+
   // r = b - A*x
-  MultiplyByMatrix(x, v);
+  A->MultiplyByMatrix(x, v);
   r->SetToDiff(b, v);
 
   // rhat = r
   rhat->SetEqual(r);
 
   real rho0  = 1.0;
-  real alpha = 0.0;
+  real alpha = 1.0;
   real omega = 1.0;
 
-  u->SetToValue(0.0);
+  p->SetToValue(0.0);
+  v->SetToValue(0.0);
 
-  for (int k = 0; k <= maxIter; k += l) {
-    // Array<real> *uhat = new Array<real>(1,
-    real rho1 = r->InnerProduct(rhat);
-    real beta = alpha*rho1/rho0;
+  int nIter = 0;
+  int convergedFlag = (sqrt(r->InnerProduct(r)) <= tolerance*bNorm);
 
-    // u = r - beta*u
-    CalcU(beta);
+  while (convergedFlag == 0 && nIter < maxIter) {
+    nIter++;
 
-    // v = A*u
-    MultiplyByMatrix(u, v);
+    // rho1 = (rhat, r)
+    real rho1 = rhat->InnerProduct(r);
 
-    real gamma = v->InnerProduct(rhat);
+    // Breakdown: no progress possible
+    if (rho1 == (real) 0.0) break;
 
-    // alpha = rho/gamma
-    alpha = rho0/gamma;
+    real beta = (rho1/rho0)*(alpha/omega);
 
-    // r = ri -alpha*v
-    CalcR(alpha);
+    // p = r + beta*(p - omega*v)
+    p->LinComb(1.0, r, beta, p, -beta*omega, v);
 
-    // s = A*r
-    MultiplyByMatrix(r, s);
+    // v = A*M^-1*p
+    A->Precondition(p, phat);
+    A->MultiplyByMatrix(phat, v);
 
-    // x = xi + alpha*u
-    CalcX(alpha);
+    real gamma = rhat->InnerProduct(v);
+    if (gamma == (real) 0.0) break;
+    alpha = rho1/gamma;
 
-    // rho1 = (rhat, s)
-    rho1 = s->InnerProduct(rhat);
+    // s = r - alpha*v
+    s->LinComb(1.0, r, -alpha, v);
 
-    beta = alpha*rho1/rho0;
-    rho0 = rho1;
+    // Converged on half step: x = x + alpha*M^-1*p
+    if (sqrt(s->InnerProduct(s)) <= tolerance*bNorm) {
+      x->LinComb(1.0, x, alpha, phat);
+      convergedFlag = 1;
+      break;
+    }
+
+    // t = A*M^-1*s
+    A->Precondition(s, shat);
+    A->MultiplyByMatrix(shat, t);
+
+    real tt = t->InnerProduct(t);
+    omega = (real) 0.0;
+    if (tt > (real) 0.0) omega = t->InnerProduct(s)/tt;
 
-    // v = s - beta*v
-    CalcV(beta);
-
-    // w = A*v
-    MultiplyByMatrix(v, w);
-
-    // gamma = (w, rhat)
-    real gamma = w->InnerProduct(rhat);
-
-    alpha = rho0/gamma;
-
-    // u = r - beta*u
-    // r = r - alpha*v
-    // s = s - alpha*w
-    // t = A*s
-
-    // omega1 = (r, s)
-    // mu = (s, s)
-    // nu = (s, t)
-    // tau = (t, t)
-    // omega2 = (r, t)
-    // tau = tau - nu*nu/mu
-    // omega2 = (omega2 - nu*omega1/mu)/tau
-    // omega1 = (omega1 - nu*omega2)/mu
-    // xi+2 = x + omega1*r + omega2*s + alpha*u
-    // ri+2 = r - omega1*s - omega2*t
-    // If accurate enough quit
-    // u = u - omega1*v - omega2*w
+    // x = x + alpha*M^-1*p + omega*M^-1*s
+    x->LinComb(1.0, x, alpha, phat, omega, shat);
+
+    // r = s - omega*t
+    r->LinComb(1.0, s, -omega, t);
+
+    convergedFlag = (sqrt(r->InnerProduct(r)) <= tolerance*bNorm);
+
+    // Breakdown: no further progress possible
+    if (omega == (real) 0.0) break;
+
+    rho0 = rho1;
   }
+
+  auto finish = std::chrono::high_resolution_clock::now();
+  std::chrono::duration<double> elapsed = finish - start;
+
+  nSolve++;
+  nIteration += nIter;
+  if (convergedFlag == 0) nFail++;
+  solveTime += elapsed.count();
+
+  if (verboseLevel > 1)
+    std::cout << "BiCGStab: " << nIter << " iterations, "
+              << (convergedFlag == 1 ? "converged" : "not converged")
+              << std::endl;
+
+  return nIter;
 }
 
 }  // namespace astrix
@@ -14,46 +14,79 @@ Astrix is distributed in the hope that it will be useful, but WITHOUT ANY WARRAN
 You should have received a copy of the GNU General Public License
 along with Astrix.  If not, see <http://www.gnu.org/licenses/>.*/
 
-#include <cuda_runtime_api.h>
+#include "../Common/cudaRuntime.h"
 #include <iostream>
+#include <iomanip>
 
 #include "../Common/definitions.h"
 #include "../Array/array.h"
-#include "../Mesh/mesh.h"
 #include "../Device/device.h"
 #include "./linsys.h"
 
 namespace astrix {
 
 //#########################################################################
-/*! Define Arrays, create Mesh and setup simulation.
+/*! Define work Arrays for iterative solver. Their size is set when solving.
   \param _verboseLevel How much information to output to stdout in Astrix.
-  \param _debugLevel Level of extra checks for correct mesh.
-  \param *fileName Input file name
-  \param *device Device to be used for computation.
-  \param restartNumber Number of saved file to restore from*/
+  \param _debugLevel Level of extra checks.
+  \param *_device Device to be used for computation.*/
 //#########################################################################
 
 LinSys::LinSys(int _verboseLevel,
                int _debugLevel,
-               Device *_device,
-               Mesh *_mesh)
+               Device *_device)
 {
   // How much to output to screen
   verboseLevel = _verboseLevel;
   debugLevel = _debugLevel;
   device = _device;
-  mesh = _mesh;
 
   cudaFlag = device->GetCudaFlag();
+
+  r    = new Array<real>(1, cudaFlag);
+  rhat = new Array<real>(1, cudaFlag);
+  p    = new Array<real>(1, cudaFlag);
+  phat = new Array<real>(1, cudaFlag);
+  v    = new Array<real>(1, cudaFlag);
+  s    = new Array<real>(1, cudaFlag);
+  shat = new Array<real>(1, cudaFlag);
+  t    = new Array<real>(1, cudaFlag);
+
+  nSolve = 0;
+  nIteration = 0;
+  nFail = 0;
+  solveTime = 0.0;
 }
 
 // #########################################################################
-// Destructor for simulation object
+// Destructor for LinSys object
 // #########################################################################
 
 LinSys::~LinSys()
 {
+  delete r;
+  delete rhat;
+  delete p;
+  delete phat;
+  delete v;
+  delete s;
+  delete shat;
+  delete t;
+}
+
+//#########################################################################
+// Output statistics to screen
+//#########################################################################
+
+void LinSys::PrintStatistics()
+{
+  if (nSolve == 0) return;
+
+  std::cout << std::setprecision(6)
+            << "BiCGStab: " << nSolve << " solves, "
+            << (double) nIteration/(double) nSolve << " iterations/solve, "
+            << nFail << " not converged, "
+            << solveTime << " s" << std::endl;
 }
 
 }  // namespace astrix
@@ -15,12 +15,30 @@ along with Astrix.  If not, see <http://www.gnu.org/licenses/>.*/
 #ifndef ASTRIX_LINSYS_H
 #define ASTRIX_LINSYS_H
 
+#include <cstdint>
+
 namespace astrix {
 
-class Mesh;
 template <class T> class Array;
 class Device;
 
+//! LinearOperator: matrix A of a linear system A x = b
+/*! The matrix is never stored: classes deriving from LinearOperator only need to be able to multiply a vector by A, and to apply a preconditioner M, an approximation to A that is easy to invert.*/
+
+class LinearOperator
+{
+ public:
+  virtual ~LinearOperator() {}
+
+  //! Calculate vOut = A vIn
+  virtual void MultiplyByMatrix(Array<real> *vIn, Array<real> *vOut) = 0;
+  //! Calculate vOut = M^-1 vIn
+  virtual void Precondition(Array<real> *vIn, Array<real> *vOut) = 0;
+};
+
+//! LinSys: class for solving linear systems
+/*! Iterative solver for A x = b, with A a LinearOperator. Vectors are Array's of reals, which can live on the host or on the device.*/
+
 class LinSys
 {
  public:
@@ -29,7 +47,12 @@ class LinSys
   //! Destructor, releases all dynamically allocated memory
   ~LinSys();
 
-  void BiCGStab(Array<real> *x, Array<real> *b);
+  //! Solve A x = b using preconditioned BiCGStab
+  int BiCGStab(LinearOperator *A, Array<real> *x, Array<real> *b,
+               int maxIter, real tolerance);
+
+  //! Output iteration statistics to screen
+  void PrintStatistics();
 
  private:
   Device *device;
@@ -42,10 +65,31 @@ class LinSys
   //! Level of debugging
   int debugLevel;
 
-  //! Mesh on which to do simulation
-  Mesh *mesh;
-
-  void MultiplyByMatrix(Array<real> *vIn, Array<real> *vOut);
+  //! Residual b - A x
+  Array<real> *r;
+  //! Shadow residual
+  Array<real> *rhat;
+  //! Search direction
+  Array<real> *p;
+  //! Preconditioned search direction
+  Array<real> *phat;
+  //! A phat
+  Array<real> *v;
+  //! Intermediate residual
+  Array<real> *s;
+  //! Preconditioned intermediate residual
+  Array<real> *shat;
+  //! A shat
+  Array<real> *t;
+
+  //! Number of calls to BiCGStab()
+  int64_t nSolve;
+  //! Total number of iterations
+  int64_t nIteration;
+  //! Number of solves not converged within maximum number of iterations
+  int64_t nFail;
+  //! Total time spent solving (s)
+  double solveTime;
 };
 
 }  // namespace astrix
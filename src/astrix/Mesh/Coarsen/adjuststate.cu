@@ -406,7 +406,7 @@ void Coarsen::AdjustState(Connectivity *connectivity,
                                        devAdjustStateCoarsen<realNeq, CL>,
                                        (size_t) 0, 0);
 
-    devAdjustStateCoarsen<realNeq, CL><<<nBlocks, nThreads>>>
+    LaunchKernel(nBlocks, nThreads, devAdjustStateCoarsen<realNeq, CL>)
       (nRemove, pVertexRemove, pVertexTriangleList,
        maxTriPerVert, pTv, pTe, pEt,
        pVertexArea, nVertex, pVc,
@@ -306,7 +306,7 @@ void Coarsen::FindAllowedTargetTriangles(Connectivity *connectivity,
        devFindAllowedTargetTriangle,
        (size_t) 0, 0);
 
-    devFindAllowedTargetTriangle<<<nBlocks, nThreads>>>
+    LaunchKernel(nBlocks, nThreads, devFindAllowedTargetTriangle)
       (pVertexRemove, nRemove, pVertexTriangleList,
        maxTriPerVert, pTv, pTe, pEt,
        nVertex, pVc, Px, Py,
@@ -314,6 +314,7 @@ void Coarsen::FindAllowedTargetTriangles(Connectivity *connectivity,
     gpuErrchk( cudaPeekAtLastError() );
     gpuErrchk( cudaDeviceSynchronize() );
   } else {
+#pragma omp parallel for schedule(dynamic, 64)
     for (int n = 0; n < nRemove; n++)
       FindAllowedTargetTriangleSingle(pVertexRemove[n],
                                       &(pVertexTriangleList[n*maxTriPerVert]),
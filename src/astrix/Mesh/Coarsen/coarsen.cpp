@@ -15,7 +15,11 @@ You should have received a copy of the GNU General Public License
 along with Astrix.  If not, see <http://www.gnu.org/licenses/>.*/
 
 #include <iostream>
-#include <cuda_runtime_api.h>
+#include "../../Common/cudaRuntime.h"
+#include <iomanip>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 #include "../../Common/definitions.h"
 #include "../../Array/array.h"
@@ -40,15 +44,14 @@ Coarsen::Coarsen(int _cudaFlag, int _debugLevel, int _verboseLevel)
   // Allocate Arrays of default size
   vertexRemove = new Array<int>(1, cudaFlag);
   vertexTriangle = new Array<int>(1, cudaFlag);
+  vertexRemoveTriangle = new Array<int>(1, cudaFlag);
   vertexArea = new Array<real>(1, cudaFlag);
+  edgeNeedsChecking = new Array<int>(1, cudaFlag);
 
-  randomVector = new Array<unsigned int>(1, cudaFlag);
-  if (cudaFlag == 1)
-    randomVector->TransformToHost();
-  randomVector->SetSize(10000000);
-  randomVector->SetToRandom();
-  if (cudaFlag == 1)
-    randomVector->TransformToDevice();
+  nVertexRemoved = 0;
+  nVertexCandidate = 0;
+  nCoarsenCycle = 0;
+  coarsenTime = 0.0;
 }
 
 //#########################################################################
@@ -59,9 +62,32 @@ Coarsen::~Coarsen()
 {
   delete vertexRemove;
   delete vertexTriangle;
+  delete vertexRemoveTriangle;
   delete vertexArea;
+  delete edgeNeedsChecking;
+}
 
-  delete randomVector;
+//#########################################################################
+// Output removal rate and deletion set statistics to screen
+//#########################################################################
+
+void Coarsen::PrintStatistics() const
+{
+  if (nVertexRemoved == 0) return;
+
+  int nThread = 1;
+#ifdef _OPENMP
+  nThread = omp_get_max_threads();
+#endif
+  std::cout << std::setprecision(6)
+            << "Coarsen: " << nVertexRemoved << " vertices removed in "
+            << nCoarsenCycle << " cycles, " << coarsenTime << " s, "
+            << (double) nVertexRemoved/coarsenTime << " vertices/s";
+  if (cudaFlag == 0) std::cout << " on " << nThread << " threads";
+  std::cout << "; " << (double) nVertexRemoved/nCoarsenCycle
+            << " vertices/cycle, "
+            << 100.0*(double) nVertexRemoved/nVertexCandidate
+            << "% of candidates in deletion sets" << std::endl;
 }
 
 }
@@ -15,6 +15,8 @@ along with Astrix.  If not, see <http://www.gnu.org/licenses/>.*/
 #ifndef ASTRIX_COARSEN_H
 #define ASTRIX_COARSEN_H
 
+#include <cstdint>
+
 namespace astrix {
 
 // Forward declarations
@@ -43,6 +45,9 @@ class Coarsen
                        Delaunay *delaunay,
                        int maxCycle);
 
+  //! Output removal rate and deletion set statistics to screen
+  void PrintStatistics() const;
+
  private:
   //! Flag whether to use device or host
   int cudaFlag;
@@ -52,13 +57,23 @@ class Coarsen
 
   //! Indices of vertices to be removed
   Array <int> *vertexRemove;
-  //! Every vertex has at least one triangle associated with it
+  //! Every vertex has at least one triangle associated with it; kept up to date between coarsening cycles
   Array <int> *vertexTriangle;
-  //! Vector of random numbers to insert points randomly for efficiency
-  //Array <unsigned int> *randomVector;
+  //! Triangle associated with every vertex in \a vertexRemove
+  Array <int> *vertexRemoveTriangle;
   //! Area associated with vertex (Voronoi cell)
   Array<real> *vertexArea;
-  Array<unsigned int> *randomVector;
+  //! Edges of triangles changed by removing vertices, to be checked for Delaunay-hood
+  Array<int> *edgeNeedsChecking;
+
+  //! Total number of vertices removed
+  int64_t nVertexRemoved;
+  //! Total number of candidates for removal passed to FindParallelDeletionSet()
+  int64_t nVertexCandidate;
+  //! Total number of coarsening cycles that removed vertices
+  int64_t nCoarsenCycle;
+  //! Total time spent removing vertices (s)
+  double coarsenTime;
 
   //! Check if removing vertices leads to encroached segment
   void CheckEncroach(Connectivity *connectivity,
@@ -84,6 +99,13 @@ class Coarsen
                      Array<int> *vertexNeighbour);
   //! Find single triangle for every vertex
   void FillVertexTriangle(Connectivity *connectivity);
+  //! Update vertexTriangle for triangles removed by Remove()
+  void UpdateVertexTriangle(Connectivity *connectivity,
+                            Array<int> *vertexTriangleList,
+                            int maxTriPerVert,
+                            Array<int> *triangleKeepFlag);
+  //! Repair vertexTriangle after edge flips
+  void RepairVertexTriangle(Connectivity *connectivity);
   //! Maximum number of triangles per vertex
   int MaxTriPerVert(Connectivity *connectivity);
   //! Flag vertices for removal
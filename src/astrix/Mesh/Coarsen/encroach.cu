@@ -439,13 +439,13 @@ void Coarsen::CheckEncroach(Connectivity *connectivity,
     connectivity->Transform();
     if (cudaFlag == 1) {
       vertexRemove->TransformToHost();
-      vertexTriangle->TransformToHost();
+      vertexRemoveTriangle->TransformToHost();
       vertexRemoveFlag->TransformToHost();
 
       cudaFlag = 0;
     } else {
       vertexRemove->TransformToDevice();
-      vertexTriangle->TransformToDevice();
+      vertexRemoveTriangle->TransformToDevice();
       vertexRemoveFlag->TransformToDevice();
 
       cudaFlag = 1;
@@ -462,7 +462,7 @@ void Coarsen::CheckEncroach(Connectivity *connectivity,
   real *pParam = predicates->GetParamPointer(cudaFlag);
 
   int *pVertexRemove = vertexRemove->GetPointer();
-  int *pVertexTriangle = vertexTriangle->GetPointer();
+  int *pVertexTriangle = vertexRemoveTriangle->GetPointer();
   int *pVertexRemoveFlag = vertexRemoveFlag->GetPointer();
 
   real Px = mp->maxx - mp->minx;
@@ -477,7 +477,7 @@ void Coarsen::CheckEncroach(Connectivity *connectivity,
                                        devCheckEncroachCoarsen,
                                        (size_t) 0, 0);
 
-    devCheckEncroachCoarsen<<<nBlocks, nThreads>>>
+    LaunchKernel(nBlocks, nThreads, devCheckEncroachCoarsen)
       (nRemove, pVertexRemove, nVertex,
        pTv, pTe, pEt, pVc, Px, Py,
        predicates, pParam, pVertexTriangle,
@@ -486,6 +486,7 @@ void Coarsen::CheckEncroach(Connectivity *connectivity,
     gpuErrchk( cudaDeviceSynchronize() );
   } else {
     // Check if removing vertex would lead to encroached segment
+#pragma omp parallel for schedule(dynamic, 64)
     for (int n = 0; n < nRemove; n++)
       CheckEncroachCoarsenSingle(n, nVertex,
                                  pTv, pTe, pEt, pVc,
@@ -498,13 +499,13 @@ void Coarsen::CheckEncroach(Connectivity *connectivity,
     connectivity->Transform();
     if (cudaFlag == 1) {
       vertexRemove->TransformToHost();
-      vertexTriangle->TransformToHost();
+      vertexRemoveTriangle->TransformToHost();
       vertexRemoveFlag->TransformToHost();
 
       cudaFlag = 0;
     } else {
       vertexRemove->TransformToDevice();
-      vertexTriangle->TransformToDevice();
+      vertexRemoveTriangle->TransformToDevice();
       vertexRemoveFlag->TransformToDevice();
 
       cudaFlag = 1;
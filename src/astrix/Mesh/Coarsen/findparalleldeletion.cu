@@ -20,7 +20,8 @@ along with Astrix.  If not, see <http://www.gnu.org/licenses/>.*/
 #include "../../Array/array.h"
 #include "./coarsen.h"
 #include "../../Common/cudaLow.h"
-#include "./unique_triangle.h"
+#include "../../Common/atomic.h"
+#include "../../Common/inlineMath.h"
 #include "../Connectivity/connectivity.h"
 
 namespace astrix {
@@ -255,39 +256,12 @@ devFillAffectedTriangles(int3 *pTv, int3 *pTe, int2 *pEt,
   }
 }
 
-//######################################################################
-/*! \brief Kernel filling array \a pTriangleAffectedIndex
-
-Removing a vertex affects the triangles sharing that vertex plus all the neighbours of that triangle. This results in 2*\a maxTriPerVert triangles maximum. The array \a pTriangleAffectedIndex relates these triangles to the vertices to be removed
-
-\param nRemove Total number of vertices to be removed
-\param maxTriPerVert Maximum number of traingles sharing any vertex
-\param *pTriangleAffectedIndex Pointer to output array*/
-//######################################################################
-
-__global__ void
-devFillAffectedIndex(int nRemove, int maxTriPerVert,
-                     int *pTriangleAffectedIndex)
-{
-  int n = blockIdx.x*blockDim.x + threadIdx.x;
-
-  while (n < nRemove) {
-    for (int i = 0; i < maxTriPerVert; i++) {
-      pTriangleAffectedIndex[i + n*maxTriPerVert] = n;
-      pTriangleAffectedIndex[i + n*maxTriPerVert + nRemove*maxTriPerVert] = n;
-    }
-
-    n += blockDim.x*gridDim.x;
-  }
-}
-
 //############################################################################
 /*! \brief Fill array of triangles affected by vertex removal
 
-Removing a vertex affects the triangles sharing that vertex plus all the neighbours of that triangle. This results in 2*\a maxTriPerVert triangles maximum, which are put in \a triangleAffected. The array \a triangleAffectedIndex relates these triangles to the vertices to be removed
+Removing a vertex affects the triangles sharing that vertex plus all the neighbours of that triangle. This results in 2*\a maxTriPerVert triangles maximum, which are put in \a triangleAffected.
 
 \param *triangleAffected Pointer to output Array containing affected triangles
-\param *triangleAffectedIndex Pointer to output Array containing index of the vertex relating to the affected triangles
 \param *edgeTriangles Pointer to Array containing triangles neighbouring edges
 \param *triangleEdges Pointer to Array containing edges belonging to triangles
 \param *triangleVertices Pointer to Array containing vertices belonging to triangles
@@ -300,7 +274,6 @@ Removing a vertex affects the triangles sharing that vertex plus all the neighbo
 //############################################################################
 
 void FillAffectedTriangles(Array<int> *triangleAffected,
-                           Array<int> *triangleAffectedIndex,
                            Connectivity *connectivity,
                            Array<int> *vertexTriangle,
                            Array<int> *vertexRemove,
@@ -315,14 +288,12 @@ void FillAffectedTriangles(Array<int> *triangleAffected,
       vertexRemove->TransformToHost();
       vertexTriangle->TransformToHost();
       triangleAffected->TransformToHost();
-      triangleAffectedIndex->TransformToHost();
 
       cudaFlag = 0;
     } else {
       vertexRemove->TransformToDevice();
       vertexTriangle->TransformToDevice();
       triangleAffected->TransformToDevice();
-      triangleAffectedIndex->TransformToDevice();
 
       cudaFlag = 1;
     }
@@ -336,30 +307,6 @@ void FillAffectedTriangles(Array<int> *triangleAffected,
   int *pVertexRemove = vertexRemove->GetPointer();
 
   int *pTriangleAffected = triangleAffected->GetPointer();
-  int *pTriangleAffectedIndex = triangleAffectedIndex->GetPointer();
-
-  // Fill neighbouring triangles array
-  if (cudaFlag == 1) {
-    int nBlocks = 128;
-    int nThreads = 128;
-
-    // Base nThreads and nBlocks on maximum occupancy
-    cudaOccupancyMaxPotentialBlockSize(&nBlocks, &nThreads,
-                                       devFillAffectedIndex,
-                                       (size_t) 0, 0);
-
-    devFillAffectedIndex<<<nBlocks, nThreads>>>
-      (nRemove, maxTriPerVert, pTriangleAffectedIndex);
-    gpuErrchk( cudaPeekAtLastError() );
-    gpuErrchk( cudaDeviceSynchronize() );
-  } else {
-    for (int n = 0; n < nRemove; n++) {
-      for (int i = 0; i < maxTriPerVert; i++) {
-        pTriangleAffectedIndex[i + n*maxTriPerVert] = n;
-        pTriangleAffectedIndex[i + n*maxTriPerVert + nRemove*maxTriPerVert] = n;
-      }
-    }
-  }
 
   // Fill array of affected triangles
   if (cudaFlag == 1) {
@@ -371,12 +318,13 @@ void FillAffectedTriangles(Array<int> *triangleAffected,
                                        devFillAffectedTriangles,
                                        (size_t) 0, 0);
 
-    devFillAffectedTriangles<<<nBlocks, nThreads>>>
+    LaunchKernel(nBlocks, nThreads, devFillAffectedTriangles)
       (pTv, pTe, pEt, pVertexTriangle, pVertexRemove, nVertex,
        maxTriPerVert, nRemove, pTriangleAffected);
     gpuErrchk( cudaPeekAtLastError() );
     gpuErrchk( cudaDeviceSynchronize() );
   } else {
+#pragma omp parallel for schedule(dynamic, 64)
     for (int n = 0; n < nRemove; n++)
       FillAffectedTrianglesSingle(n, pTv, pTe, pEt,
                                   pVertexTriangle, pVertexRemove, nVertex,
@@ -389,22 +337,125 @@ void FillAffectedTriangles(Array<int> *triangleAffected,
       vertexRemove->TransformToHost();
       vertexTriangle->TransformToHost();
       triangleAffected->TransformToHost();
-      triangleAffectedIndex->TransformToHost();
 
       cudaFlag = 0;
     } else {
       vertexRemove->TransformToDevice();
       vertexTriangle->TransformToDevice();
       triangleAffected->TransformToDevice();
-      triangleAffectedIndex->TransformToDevice();
 
       cudaFlag = 1;
     }
   }
 }
 
+//######################################################################
+/*! \brief Claim triangles affected by removing vertex \a pVertexRemove[n]
+
+Every affected triangle is claimed by the candidate with the largest random number, using atomic operations. Since the final claim does not depend on the order in which candidates are processed, the deletion set does not depend on the number of threads.
+
+\param n Index in \a pVertexRemove to consider
+\param maxTriPerVert Maximum number of triangles sharing any vertex
+\param nRemove Total number of vertices to be removed
+\param *pTriangleAffected Pointer to list of affected triangles
+\param *pTriangleClaim Pointer to claims on triangles (output)*/
+//######################################################################
+
+__host__ __device__
+void ClaimAffectedSingle(int n, int maxTriPerVert, int nRemove,
+                         const int *pTriangleAffected, int *pTriangleClaim)
+{
+  int randomInt = (int) UniqueRandom(n);
+
+  for (int i = 0; i < maxTriPerVert; i++) {
+    int t1 = pTriangleAffected[i + n*maxTriPerVert];
+    int t2 = pTriangleAffected[i + (n + nRemove)*maxTriPerVert];
+    if (t1 != -1) AtomicMax(&(pTriangleClaim[t1]), randomInt);
+    if (t2 != -1) AtomicMax(&(pTriangleClaim[t2]), randomInt);
+  }
+}
+
+//######################################################################
+/*! \brief Kernel claiming triangles affected by vertex removal
+
+\param maxTriPerVert Maximum number of triangles sharing any vertex
+\param nRemove Total number of vertices to be removed
+\param *pTriangleAffected Pointer to list of affected triangles
+\param *pTriangleClaim Pointer to claims on triangles (output)*/
+//######################################################################
+
+__global__ void
+devClaimAffected(int maxTriPerVert, int nRemove,
+                 const int *pTriangleAffected, int *pTriangleClaim)
+{
+  int n = blockIdx.x*blockDim.x + threadIdx.x;
+
+  while (n < nRemove) {
+    ClaimAffectedSingle(n, maxTriPerVert, nRemove,
+                        pTriangleAffected, pTriangleClaim);
+
+    n += blockDim.x*gridDim.x;
+  }
+}
+
+//######################################################################
+/*! \brief Check if vertex \a pVertexRemove[n] holds the claim on all its affected triangles
+
+\param n Index in \a pVertexRemove to consider
+\param maxTriPerVert Maximum number of triangles sharing any vertex
+\param nRemove Total number of vertices to be removed
+\param *pTriangleAffected Pointer to list of affected triangles
+\param *pTriangleClaim Pointer to claims on triangles
+\param *pUniqueFlag Pointer to output array: 1 if vertex can be removed in parallel, 0 otherwise*/
+//######################################################################
+
+__host__ __device__
+void FlagUniqueSingle(int n, int maxTriPerVert, int nRemove,
+                      const int *pTriangleAffected,
+                      const int *pTriangleClaim, int *pUniqueFlag)
+{
+  int randomInt = (int) UniqueRandom(n);
+  int ret = 1;
+
+  for (int i = 0; i < maxTriPerVert; i++) {
+    int t1 = pTriangleAffected[i + n*maxTriPerVert];
+    int t2 = pTriangleAffected[i + (n + nRemove)*maxTriPerVert];
+    if (t1 != -1)
+      if (pTriangleClaim[t1] != randomInt) ret = 0;
+    if (t2 != -1)
+      if (pTriangleClaim[t2] != randomInt) ret = 0;
+  }
+
+  pUniqueFlag[n] = ret;
+}
+
+//######################################################################
+/*! \brief Kernel checking which vertices hold the claim on all their affected triangles
+
+\param maxTriPerVert Maximum number of triangles sharing any vertex
+\param nRemove Total number of vertices to be removed
+\param *pTriangleAffected Pointer to list of affected triangles
+\param *pTriangleClaim Pointer to claims on triangles
+\param *pUniqueFlag Pointer to output array: 1 if vertex can be removed in parallel, 0 otherwise*/
+//######################################################################
+
+__global__ void
+devFlagUnique(int maxTriPerVert, int nRemove,
+              const int *pTriangleAffected,
+              const int *pTriangleClaim, int *pUniqueFlag)
+{
+  int n = blockIdx.x*blockDim.x + threadIdx.x;
+
+  while (n < nRemove) {
+    FlagUniqueSingle(n, maxTriPerVert, nRemove,
+                     pTriangleAffected, pTriangleClaim, pUniqueFlag);
+
+    n += blockDim.x*gridDim.x;
+  }
+}
+
 //#############################################################################
-/*! Find set of vertices that can be removed in parallel. First, we create a list of triangles that will be affected by vertex removal. Then, we find the unique values and compact Arrays \a vertexRemove and \a vertexTriangle
+/*! Find set of vertices that can be removed in parallel. First, we create a list of triangles that will be affected by vertex removal. Every candidate then claims its affected triangles with a random priority, and only candidates holding the claim on all of their affected triangles are kept: Arrays \a vertexRemove and \a vertexRemoveTriangle are compacted accordingly. Unlike sorting the list of affected triangles, claiming runs in parallel on the host as well as on the device.
 
 \param maxTriPerVert Maximum number of triangles sharing a vertex*/
 //#############################################################################
@@ -412,65 +463,76 @@ void FillAffectedTriangles(Array<int> *triangleAffected,
 void Coarsen::FindParallelDeletionSet(Connectivity *connectivity,
                                       int maxTriPerVert)
 {
-  unsigned int nRemove = vertexRemove->GetSize();
+  int nRemove = vertexRemove->GetSize();
   int nVertex = connectivity->vertexCoordinates->GetSize();
-
-  // Shuffle points to add to maximise parallelisation
-  Array<unsigned int> *randomNumbers =
-    new Array<unsigned int>(1, cudaFlag, nRemove);
-
-  randomNumbers->SetEqual(randomVector);
-  Array<unsigned int> *randomPermutation =
-    new Array<unsigned int>(1, cudaFlag, nRemove);
-  randomPermutation->SetToSeries();
-  unsigned int *pRandomPermutation = randomPermutation->GetPointer();
-
-  randomNumbers->SortByKey(randomPermutation);
-
-  vertexRemove->Reindex(pRandomPermutation);
-  vertexTriangle->Reindex(pRandomPermutation);
-
-  delete randomNumbers;
-  delete randomPermutation;
+  int nTriangle = connectivity->triangleVertices->GetSize();
 
   Array <int> *triangleAffected =
     new Array<int>(1, cudaFlag, (unsigned int) (2*nRemove*maxTriPerVert));
   triangleAffected->SetToValue(-1);
 
-  Array <int> *triangleAffectedIndex =
-    new Array<int>(1, cudaFlag, (unsigned int) (2*nRemove*maxTriPerVert));
-
   FillAffectedTriangles(triangleAffected,
-                        triangleAffectedIndex,
                         connectivity,
-                        vertexTriangle,
+                        vertexRemoveTriangle,
                         vertexRemove,
                         maxTriPerVert,
                         nRemove, cudaFlag, nVertex);
 
-  // Sort triangleAffected, together with triangleAffectedIndex
-  // In case of equal, use triangleAffectedIndex
-  triangleAffected->Sort(triangleAffectedIndex);
+  Array <int> *triangleClaim =
+    new Array<int>(1, cudaFlag, (unsigned int) nTriangle);
+  triangleClaim->SetToValue(-1);
 
-  // Find unique values
   Array <int> *uniqueFlag =
-    new Array<int>(1, cudaFlag, nRemove);
+    new Array<int>(1, cudaFlag, (unsigned int) nRemove);
   Array <int> *uniqueFlagScan =
-    new Array<int>(1, cudaFlag, nRemove);
+    new Array<int>(1, cudaFlag, (unsigned int) nRemove);
+
+  int *pTriangleAffected = triangleAffected->GetPointer();
+  int *pTriangleClaim = triangleClaim->GetPointer();
+  int *pUniqueFlag = uniqueFlag->GetPointer();
+
+  if (cudaFlag == 1) {
+    int nBlocks = 128;
+    int nThreads = 128;
+
+    // Base nThreads and nBlocks on maximum occupancy
+    cudaOccupancyMaxPotentialBlockSize(&nBlocks, &nThreads,
+                                       devClaimAffected,
+                                       (size_t) 0, 0);
+
+    LaunchKernel(nBlocks, nThreads, devClaimAffected)
+      (maxTriPerVert, nRemove, pTriangleAffected, pTriangleClaim);
+    gpuErrchk( cudaPeekAtLastError() );
+    gpuErrchk( cudaDeviceSynchronize() );
 
-  // Find unique values
-  FindUniqueTriangleAffected(triangleAffected,
-                             triangleAffectedIndex,
-                             uniqueFlag,
-                             2*nRemove*maxTriPerVert, cudaFlag);
+    // Base nThreads and nBlocks on maximum occupancy
+    cudaOccupancyMaxPotentialBlockSize(&nBlocks, &nThreads,
+                                       devFlagUnique,
+                                       (size_t) 0, 0);
+
+    LaunchKernel(nBlocks, nThreads, devFlagUnique)
+      (maxTriPerVert, nRemove, pTriangleAffected, pTriangleClaim,
+       pUniqueFlag);
+    gpuErrchk( cudaPeekAtLastError() );
+    gpuErrchk( cudaDeviceSynchronize() );
+  } else {
+#pragma omp parallel for
+    for (int n = 0; n < nRemove; n++)
+      ClaimAffectedSingle(n, maxTriPerVert, nRemove,
+                          pTriangleAffected, pTriangleClaim);
+#pragma omp parallel for
+    for (int n = 0; n < nRemove; n++)
+      FlagUniqueSingle(n, maxTriPerVert, nRemove,
+                       pTriangleAffected, pTriangleClaim, pUniqueFlag);
+  }
 
-  // Compact arrays to new nRefine
+  // Compact arrays to new nRemove
   nRemove = uniqueFlag->ExclusiveScan(uniqueFlagScan, nRemove);
   vertexRemove->Compact(nRemove, uniqueFlag, uniqueFlagScan);
-  vertexTriangle->Compact(nRemove, uniqueFlag, uniqueFlagScan);
+  vertexRemoveTriangle->Compact(nRemove, uniqueFlag, uniqueFlagScan);
 
   delete triangleAffected;
-  delete triangleAffectedIndex;
+  delete triangleClaim;
 
   delete uniqueFlag;
   delete uniqueFlagScan;
@@ -139,12 +139,13 @@ void Coarsen::FlagVertexRemove(Connectivity *connectivity,
                                        devFillVertexRemoveFlag,
                                        (size_t) 0, 0);
 
-    devFillVertexRemoveFlag<<<nBlocks, nThreads>>>
+    LaunchKernel(nBlocks, nThreads, devFillVertexRemoveFlag)
       (nTriangle, pTv, nVertex,
        pTriangleWantRefine, pVertexRemoveFlag);
     gpuErrchk( cudaPeekAtLastError() );
     gpuErrchk( cudaDeviceSynchronize() );
   } else {
+#pragma omp parallel for
     for (int i = 0; i < nTriangle; i++)
       FillVertexRemoveFlagSingle(i, pTv, nVertex,
                                  pTriangleWantRefine, pVertexRemoveFlag);
@@ -122,7 +122,7 @@ int Coarsen::MaxTriPerVert(Connectivity *connectivity)
                                        devFillTrianglePerVertex,
                                        (size_t) 0, 0);
 
-    devFillTrianglePerVertex<<<nBlocks, nThreads>>>
+    LaunchKernel(nBlocks, nThreads, devFillTrianglePerVertex)
       (nTriangle, pTv, nVertex, pTrianglePerVertex);
     gpuErrchk( cudaPeekAtLastError() );
     gpuErrchk( cudaDeviceSynchronize() );
@@ -249,13 +249,14 @@ void Coarsen::FindVertexNeighbours(Connectivity *connectivity,
                                        devFindVertexNeighbour,
                                        (size_t) 0, 0);
 
-    devFindVertexNeighbour<<<nBlocks, nThreads>>>
+    LaunchKernel(nBlocks, nThreads, devFindVertexNeighbour)
       (pVertexRemove, nRemove, pVertexTriangleList,
        maxTriPerVert, pTv, pTe, pEt,
        nVertex, pTriangleTarget, pVertexNeighbour);
     gpuErrchk( cudaPeekAtLastError() );
     gpuErrchk( cudaDeviceSynchronize() );
   } else {
+#pragma omp parallel for
     for (int n = 0; n < nRemove; n++)
       FindVertexNeighbourSingle(pVertexRemove[n],
                                 &(pVertexTriangleList[n*maxTriPerVert]),
@@ -137,7 +137,7 @@ void Coarsen::RejectLargeTriangles(Connectivity *connectivity,
                                        devReject,
                                        (size_t) 0, 0);
 
-    devReject<<<nBlocks, nThreads>>>
+    LaunchKernel(nBlocks, nThreads, devReject)
       (nTriangle, pTv, nVertex, pVc, Px, Py, pTriangleWantRefine);
     gpuErrchk( cudaPeekAtLastError() );
     gpuErrchk( cudaDeviceSynchronize() );
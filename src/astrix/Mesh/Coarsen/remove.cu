@@ -68,6 +68,43 @@ void devAdjustEdge(int nEdge, int2 *pEt, int *pTriangleKeepFlagScan)
   }
 }
 
+//#########################################################################
+/*! \brief Adjust \a vertexTriangle for removed triangles
+
+\param n Vertex index to consider
+\param *pVertexTriangle Pointer to triangle for every vertex
+\param *pTriangleKeepFlagScan Scanned array of flags whether triangles are to be kept*/
+//#########################################################################
+
+__host__ __device__
+void AdjustVertexTriangleSingle(int n, int *pVertexTriangle,
+                                int *pTriangleKeepFlagScan)
+{
+  int t = pVertexTriangle[n];
+  if (t != -1) pVertexTriangle[n] = pTriangleKeepFlagScan[t];
+}
+
+//#########################################################################
+/*! \brief Kernel adjusting \a vertexTriangle for removed triangles
+
+\param nVertex Total number of vertices in Mesh
+\param *pVertexTriangle Pointer to triangle for every vertex
+\param *pTriangleKeepFlagScan Scanned array of flags whether triangles are to be kept*/
+//#########################################################################
+
+__global__
+void devAdjustVertexTriangle(int nVertex, int *pVertexTriangle,
+                             int *pTriangleKeepFlagScan)
+{
+  int n = blockIdx.x*blockDim.x + threadIdx.x;
+
+  while (n < nVertex) {
+    AdjustVertexTriangleSingle(n, pVertexTriangle, pTriangleKeepFlagScan);
+
+    n += blockDim.x*gridDim.x;
+  }
+}
+
 //#########################################################################
 /*! \brief Adjust \a triangleVertices and \a triangleEdges for removed vertices and edges
 
@@ -161,6 +198,57 @@ void devAdjustTriangle(int nTriangle, int3 *pTv, int3 *pTe, int nVertex,
   }
 }
 
+//#########################################################################
+/*! \brief Flag edges of triangle changed by removing vertex for Delaunay check
+
+\param i Index in \a pVertexTriangleList to consider
+\param *pVertexTriangleList Pointer to list of triangles sharing removed vertices
+\param *pTriangleKeepFlag Pointer to flags whether triangles are kept
+\param *pTe Pointer to triangle edges, already adjusted for removed edges
+\param *pEnC Pointer to array edgeNeedsChecking (output)*/
+//#########################################################################
+
+__host__ __device__
+void FlagEdgeCheckSingle(int i, const int *pVertexTriangleList,
+                         const int *pTriangleKeepFlag,
+                         const int3 *pTe, int *pEnC)
+{
+  int t = pVertexTriangleList[i];
+
+  if (t != -1) {
+    if (pTriangleKeepFlag[t] == 1) {
+      pEnC[pTe[t].x] = pTe[t].x;
+      pEnC[pTe[t].y] = pTe[t].y;
+      pEnC[pTe[t].z] = pTe[t].z;
+    }
+  }
+}
+
+//#########################################################################
+/*! \brief Kernel flagging edges of triangles changed by removing vertices
+
+\param N Total number of entries in \a pVertexTriangleList
+\param *pVertexTriangleList Pointer to list of triangles sharing removed vertices
+\param *pTriangleKeepFlag Pointer to flags whether triangles are kept
+\param *pTe Pointer to triangle edges, already adjusted for removed edges
+\param *pEnC Pointer to array edgeNeedsChecking (output)*/
+//#########################################################################
+
+__global__
+void devFlagEdgeCheck(int N, const int *pVertexTriangleList,
+                      const int *pTriangleKeepFlag,
+                      const int3 *pTe, int *pEnC)
+{
+  int i = blockIdx.x*blockDim.x + threadIdx.x;
+
+  while (i < N) {
+    FlagEdgeCheckSingle(i, pVertexTriangleList, pTriangleKeepFlag,
+                        pTe, pEnC);
+
+    i += blockDim.x*gridDim.x;
+  }
+}
+
 //#########################################################################
 /*! \brief Remove vertex \a vRemove from Mesh, adjusting surrounding connections
 
@@ -476,7 +564,7 @@ void devRemoveVertex(int nRemove, int *pVertexRemove, int *pVertexTriangleList,
 }
 
 //#########################################################################
-/*! Remove vertices from Mesh. The Array \a vertexRemove contains a list of vertices to be removed, and we have found target triangles in \a triangleTarget. First we remove the vertices and then we adjust all indices.
+/*! Remove vertices from Mesh. The Array \a vertexRemove contains a list of vertices to be removed, and we have found target triangles in \a triangleTarget. First we remove the vertices and then we adjust all indices. On return, \a edgeNeedsChecking[i] = i if edge \a i belongs to a triangle that was changed, and -1 otherwise; only these edges can have lost the Delaunay property.
 
 \param *vertexTriangleList Pointer to Array of triangles sharing vertex
 \param maxTriPerVert Maximum number of triangles sharing any vertex
@@ -503,6 +591,7 @@ void Coarsen::Remove(Connectivity *connectivity,
       triangleTarget->TransformToHost();
       vertexTriangleList->TransformToHost();
       vertexRemove->TransformToHost();
+      vertexTriangle->TransformToHost();
       triangleWantRefine->TransformToHost();
 
       cudaFlag = 0;
@@ -513,6 +602,7 @@ void Coarsen::Remove(Connectivity *connectivity,
       triangleTarget->TransformToDevice();
       vertexTriangleList->TransformToDevice();
       vertexRemove->TransformToDevice();
+      vertexTriangle->TransformToDevice();
       triangleWantRefine->TransformToDevice();
 
       cudaFlag = 1;
@@ -557,7 +647,7 @@ void Coarsen::Remove(Connectivity *connectivity,
                                        devRemoveVertex,
                                        (size_t) 0, 0);
 
-    devRemoveVertex<<<nBlocks, nThreads>>>
+    LaunchKernel(nBlocks, nThreads, devRemoveVertex)
       (nRemove, pVertexRemove,
        pVertexTriangleList, maxTriPerVert,
        pTv, pTe, pEt,
@@ -566,6 +656,7 @@ void Coarsen::Remove(Connectivity *connectivity,
     gpuErrchk( cudaPeekAtLastError() );
     gpuErrchk( cudaDeviceSynchronize() );
   } else {
+#pragma omp parallel for
     for (int n = 0; n < nRemove; n++)
       RemoveVertex(pVertexRemove[n],
                    &(pVertexTriangleList[n*maxTriPerVert]), maxTriPerVert,
@@ -574,6 +665,10 @@ void Coarsen::Remove(Connectivity *connectivity,
                    nVertex, pTriangleTarget[n]);
   }
 
+  // Keep vertexTriangle valid for next cycle
+  UpdateVertexTriangle(connectivity, vertexTriangleList, maxTriPerVert,
+                       triangleKeepFlag);
+
   Array<int> *vertexKeepFlagScan =
     new Array<int>(1, cudaFlag, (unsigned int) nVertex);
   Array<int> *triangleKeepFlagScan =
@@ -600,12 +695,13 @@ void Coarsen::Remove(Connectivity *connectivity,
                                        devAdjustTriangle,
                                        (size_t) 0, 0);
 
-    devAdjustTriangle<<<nBlocks, nThreads>>>
+    LaunchKernel(nBlocks, nThreads, devAdjustTriangle)
       (nTriangle, pTv, pTe, nVertex, nvKeep,
        pVertexKeepFlagScan, pEdgeKeepFlagScan);
     gpuErrchk( cudaPeekAtLastError() );
     gpuErrchk( cudaDeviceSynchronize() );
   } else {
+#pragma omp parallel for
     for (int n = 0; n < nTriangle; n++)
       AdjustTriangleSingle(n, pTv, pTe, nVertex, nvKeep,
                            pVertexKeepFlagScan, pEdgeKeepFlagScan);
@@ -621,19 +717,69 @@ void Coarsen::Remove(Connectivity *connectivity,
                                        devAdjustEdge,
                                        (size_t) 0, 0);
 
-    devAdjustEdge<<<nBlocks, nThreads>>>
+    LaunchKernel(nBlocks, nThreads, devAdjustEdge)
       (nEdge, pEt, pTriangleKeepFlagScan);
     gpuErrchk( cudaPeekAtLastError() );
     gpuErrchk( cudaDeviceSynchronize() );
   } else {
+#pragma omp parallel for
     for (int n = 0; n < nEdge; n++)
       AdjustEdgeSingle(n, pEt, pTriangleKeepFlagScan);
   }
 
+  // Adjust vertexTriangle for removed triangles
+  int *pVertexTriangle = vertexTriangle->GetPointer();
+
+  if (cudaFlag == 1) {
+    int nBlocks = 128;
+    int nThreads = 128;
+
+    // Base nThreads and nBlocks on maximum occupancy
+    cudaOccupancyMaxPotentialBlockSize(&nBlocks, &nThreads,
+                                       devAdjustVertexTriangle,
+                                       (size_t) 0, 0);
+
+    LaunchKernel(nBlocks, nThreads, devAdjustVertexTriangle)
+      (nVertex, pVertexTriangle, pTriangleKeepFlagScan);
+    gpuErrchk( cudaPeekAtLastError() );
+    gpuErrchk( cudaDeviceSynchronize() );
+  } else {
+#pragma omp parallel for
+    for (int n = 0; n < nVertex; n++)
+      AdjustVertexTriangleSingle(n, pVertexTriangle, pTriangleKeepFlagScan);
+  }
+
+  // Flag edges of changed triangles for checking Delaunay-hood
+  edgeNeedsChecking->SetSize(neKeep);
+  edgeNeedsChecking->SetToValue(-1);
+  int *pEnC = edgeNeedsChecking->GetPointer();
+
+  if (cudaFlag == 1) {
+    int nBlocks = 128;
+    int nThreads = 128;
+
+    // Base nThreads and nBlocks on maximum occupancy
+    cudaOccupancyMaxPotentialBlockSize(&nBlocks, &nThreads,
+                                       devFlagEdgeCheck,
+                                       (size_t) 0, 0);
+
+    LaunchKernel(nBlocks, nThreads, devFlagEdgeCheck)
+      (nRemove*maxTriPerVert, pVertexTriangleList, pTriangleKeepFlag,
+       pTe, pEnC);
+    gpuErrchk( cudaPeekAtLastError() );
+    gpuErrchk( cudaDeviceSynchronize() );
+  } else {
+#pragma omp parallel for
+    for (int n = 0; n < nRemove*maxTriPerVert; n++)
+      FlagEdgeCheckSingle(n, pVertexTriangleList, pTriangleKeepFlag,
+                          pTe, pEnC);
+  }
+
   connectivity->vertexCoordinates->Compact(nvKeep, vertexKeepFlag,
                                            vertexKeepFlagScan);
   vertexState->Compact(nvKeep, vertexKeepFlag, vertexKeepFlagScan);
   vertexArea->Compact(nvKeep, vertexKeepFlag, vertexKeepFlagScan);
+  vertexTriangle->Compact(nvKeep, vertexKeepFlag, vertexKeepFlagScan);
   triangleWantRefine->Compact(ntKeep, triangleKeepFlag, triangleKeepFlagScan);
 
   connectivity->triangleVertices->Compact(ntKeep, triangleKeepFlag,
@@ -663,6 +809,7 @@ void Coarsen::Remove(Connectivity *connectivity,
       triangleTarget->TransformToHost();
       vertexTriangleList->TransformToHost();
       vertexRemove->TransformToHost();
+      vertexTriangle->TransformToHost();
       triangleWantRefine->TransformToHost();
 
       cudaFlag = 0;
@@ -673,6 +820,7 @@ void Coarsen::Remove(Connectivity *connectivity,
       triangleTarget->TransformToDevice();
       vertexTriangleList->TransformToDevice();
       vertexRemove->TransformToDevice();
+      vertexTriangle->TransformToDevice();
       triangleWantRefine->TransformToDevice();
 
       cudaFlag = 1;
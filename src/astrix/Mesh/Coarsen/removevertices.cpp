@@ -15,7 +15,8 @@ You should have received a copy of the GNU General Public License
 along with Astrix.  If not, see <http://www.gnu.org/licenses/>.
 */
 #include <iostream>
-#include <cuda_runtime_api.h>
+#include <chrono>
+#include "../../Common/cudaRuntime.h"
 
 #include "../../Common/definitions.h"
 #include "../../Array/array.h"
@@ -29,7 +30,7 @@ along with Astrix.  If not, see <http://www.gnu.org/licenses/>.
 namespace astrix {
 
 //#########################################################################
-/*! Coarsen mesh. First calculate an estimate of the discretization error and flag triangles that can be coarsened. Then remove as many vertices as possible from mesh.
+/*! Coarsen mesh. First calculate an estimate of the discretization error and flag triangles that can be coarsened. Then remove as many vertices as possible from mesh. The triangle associated with every vertex is kept up to date between cycles rather than recomputed. Returns the number of vertices removed.
 
 \param *vertexState Pointer to state vector at vertices
 \param specificHeatRatio Ratio of specific heats
@@ -54,20 +55,21 @@ int Coarsen::RemoveVertices(Connectivity *connectivity,
   int nVertex = connectivity->vertexCoordinates->GetSize();
   int nVertexOld = nVertex;
 
+  // For every vertex, a single triangle associated with it
+  RepairVertexTriangle(connectivity);
+
   int nCycle = 0;
   int finishedCoarsen = 0;
-  int removedVerticesFlag = 0;
 
   while (!finishedCoarsen) {
     if (verboseLevel > 1) std::cout << "Coarsen cycle " << nCycle;
 
+    std::chrono::high_resolution_clock::time_point startTime =
+      std::chrono::high_resolution_clock::now();
+
     RejectLargeTriangles(connectivity, meshParameter, triangleWantRefine);
 
-    // For every vertex, a single triangle associated with it
     nVertex = connectivity->vertexCoordinates->GetSize();
-    vertexTriangle->SetSize(nVertex);
-
-    FillVertexTriangle(connectivity);
     int maxTriPerVert = MaxTriPerVert(connectivity);
 
     Array<int> *vertexRemoveFlag =
@@ -93,8 +95,8 @@ int Coarsen::RemoveVertices(Connectivity *connectivity,
       vertexRemove->SetToSeries();
       vertexRemove->Compact(nRemove, vertexRemoveFlag,
                             vertexRemoveFlagScan);
-      vertexTriangle->Compact(nRemove, vertexRemoveFlag,
-                              vertexRemoveFlagScan);
+      vertexRemoveTriangle->SetSize(nRemove);
+      vertexRemoveTriangle->Gather(vertexTriangle, vertexRemove, nRemove);
 
       vertexRemoveFlag->SetSize(nRemove);
       vertexRemoveFlag->SetToValue(1);
@@ -112,18 +114,19 @@ int Coarsen::RemoveVertices(Connectivity *connectivity,
       } else {
         vertexRemove->Compact(nRemove, vertexRemoveFlag,
                               vertexRemoveFlagScan);
-        vertexTriangle->Compact(nRemove, vertexRemoveFlag,
-                                vertexRemoveFlagScan);
+        vertexRemoveTriangle->Compact(nRemove, vertexRemoveFlag,
+                                      vertexRemoveFlagScan);
 
         if (verboseLevel > 1)
           std::cout << ", vertices to be removed: " << nRemove << ", ";
+        nVertexCandidate += nRemove;
 
         // Find list of vertices that can be removed in parallel
         FindParallelDeletionSet(connectivity, maxTriPerVert);
         nRemove = vertexRemove->GetSize();
 
         if (verboseLevel > 1)
-          std::cout << "in parallel: " << nRemove << std::endl;
+          std::cout << "in parallel: " << nRemove;
 
         if (debugLevel > 0) {
           if (nRemove == 0) {
@@ -181,11 +184,28 @@ int Coarsen::RemoveVertices(Connectivity *connectivity,
         delete vertexTriangleList;
         delete triangleTarget;
 
+        // Only edges of changed triangles need checking; in debug mode,
+        // verify afterwards that all edges are Delaunay
+        int nEdgeCheck = edgeNeedsChecking->RemoveValue(-1);
         delaunay->MakeDelaunay<realNeq, CL>(connectivity, vertexState,
                                             predicates, meshParameter, 0,
-                                            0, 0, 0);
+                                            edgeNeedsChecking, nEdgeCheck, 0);
+        if (debugLevel > 0)
+          delaunay->CheckDelaunay(connectivity, predicates, meshParameter);
 
-        removedVerticesFlag = 1;
+        // Flipping edges may have invalidated vertexTriangle
+        RepairVertexTriangle(connectivity);
+
+        double cycleTime = std::chrono::duration<double>
+          (std::chrono::high_resolution_clock::now() - startTime).count();
+        coarsenTime += cycleTime;
+        nVertexRemoved += nRemove;
+        nCoarsenCycle++;
+
+        if (verboseLevel > 1)
+          std::cout << ", " << 1000.0*cycleTime << " ms, "
+                    << (double) nRemove/cycleTime << " vertices/s"
+                    << std::endl;
       }
     }
 
@@ -199,7 +219,7 @@ int Coarsen::RemoveVertices(Connectivity *connectivity,
 
   delete nvtxCoarsen;
 
-  return nVertexOld - nVertex;
+  return nVertexOld - connectivity->vertexCoordinates->GetSize();
 }
 
 //##############################################################################
@@ -221,13 +221,14 @@ void Coarsen::FindTargetTriangles(Connectivity *connectivity,
                                        devFindTargetTriangle,
                                        (size_t) 0, 0);
 
-    devFindTargetTriangle<<<nBlocks, nThreads>>>
+    LaunchKernel(nBlocks, nThreads, devFindTargetTriangle)
       (pVertexRemove, nRemove, pVertexTriangleList,
        maxTriPerVert, pTv, pTe, pEt,
        nVertex, pTriangleWantRefine, pAllowed, pTriangleTarget);
     gpuErrchk( cudaPeekAtLastError() );
     gpuErrchk( cudaDeviceSynchronize() );
   } else {
+#pragma omp parallel for
     for (int n = 0; n < nRemove; n++)
       pTriangleTarget[n] =
         FindTargetTriangle(pVertexRemove[n],
@@ -206,7 +206,7 @@ void devFillVertexTriangleList(int nRemove, int *pVertexTriangle,
 }
 
 //#########################################################################
-/*! We know that \a vertexTriangle[n] contains a triangle sharing vertex \a v = \a vertexRemove[n]. Starting from this triangle, we circle around \a v listing all triangles we encounter. Result is stored in \a vertexTriangleList
+/*! We know that \a vertexRemoveTriangle[n] contains a triangle sharing vertex \a v = \a vertexRemove[n]. Starting from this triangle, we circle around \a v listing all triangles we encounter. Result is stored in \a vertexTriangleList
 
 \param *vertexTriangleList Pointer to output Array (size nRemove*maxTriPerVert)
 \param maxTriPerVert Maximum number of triangles sharing single vertex */
@@ -221,13 +221,13 @@ void Coarsen::CreateVertexTriangleList(Connectivity *connectivity,
   if (transformFlag == 1) {
     connectivity->Transform();
     if (cudaFlag == 1) {
-      vertexTriangle->TransformToHost();
+      vertexRemoveTriangle->TransformToHost();
       vertexTriangleList->TransformToHost();
       vertexRemove->TransformToHost();
 
       cudaFlag = 0;
     } else {
-      vertexTriangle->TransformToDevice();
+      vertexRemoveTriangle->TransformToDevice();
       vertexTriangleList->TransformToDevice();
       vertexRemove->TransformToDevice();
 
@@ -237,7 +237,7 @@ void Coarsen::CreateVertexTriangleList(Connectivity *connectivity,
 
   int nVertex = connectivity->vertexCoordinates->GetSize();
 
-  int *pVertexTriangle = vertexTriangle->GetPointer();
+  int *pVertexTriangle = vertexRemoveTriangle->GetPointer();
   int *pVertexTriangleList = vertexTriangleList->GetPointer();
   int *pVertexRemove = vertexRemove->GetPointer();
   int nRemove = vertexRemove->GetSize();
@@ -256,13 +256,14 @@ void Coarsen::CreateVertexTriangleList(Connectivity *connectivity,
                                        devFillVertexTriangleList,
                                        (size_t) 0, 0);
 
-    devFillVertexTriangleList<<<nBlocks, nThreads>>>
+    LaunchKernel(nBlocks, nThreads, devFillVertexTriangleList)
       (nRemove, pVertexTriangle, pVertexRemove,
        nVertex, pTv, pTe, pEt,
        maxTriPerVert, pVertexTriangleList);
     gpuErrchk( cudaPeekAtLastError() );
     gpuErrchk( cudaDeviceSynchronize() );
   } else {
+#pragma omp parallel for
     for (int n = 0; n < nRemove; n++)
       FillVertexTriangleListSingle(n, pVertexTriangle, pVertexRemove,
                                    nVertex, pTv, pTe, pEt,
@@ -272,13 +273,13 @@ void Coarsen::CreateVertexTriangleList(Connectivity *connectivity,
   if (transformFlag == 1) {
     connectivity->Transform();
     if (cudaFlag == 1) {
-      vertexTriangle->TransformToHost();
+      vertexRemoveTriangle->TransformToHost();
       vertexTriangleList->TransformToHost();
       vertexRemove->TransformToHost();
 
       cudaFlag = 0;
     } else {
-      vertexTriangle->TransformToDevice();
+      vertexRemoveTriangle->TransformToDevice();
       vertexTriangleList->TransformToDevice();
       vertexRemove->TransformToDevice();
 
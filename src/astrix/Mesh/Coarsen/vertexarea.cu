@@ -139,7 +139,7 @@ void Coarsen::CalcVertexArea(Connectivity *connectivity,
                                        devCCalcVertexArea,
                                        (size_t) 0, 0);
 
-    devCCalcVertexArea<<<nBlocks, nThreads>>>
+    LaunchKernel(nBlocks, nThreads, devCCalcVertexArea)
       (nVertex, nTriangle, pTv, pVertexArea, pVc, Px, Py);
 
     gpuErrchk( cudaPeekAtLastError() );
@@ -30,7 +30,7 @@ namespace astrix {
 //#########################################################################
 /*! \brief Set triangle \a n as the triangle for its vertices
 
-  For every vertex we want to know one triangle sharing it and put the result in \a *pVertexTriangle. Here, we consider triangle \a n and set it as the \a vertexTriangle for its vertices using atomic operations.
+  For every vertex we want to know one triangle sharing it and put the result in \a *pVertexTriangle. Here, we consider triangle \a n and set it as the \a vertexTriangle for its vertices if it is larger than the current value, using atomic operations.
 
 \param n Index of triangle to consider
 \param *tv1 Pointer to first vertex of triangle
@@ -54,15 +54,15 @@ void FillVertexTriangleSingle(int n, int3 *pTv,
   while (b < 0) b += nVertex;
   while (c < 0) c += nVertex;
 
-  AtomicExch(&(pVertexTriangle[a]), n);
-  AtomicExch(&(pVertexTriangle[b]), n);
-  AtomicExch(&(pVertexTriangle[c]), n);
+  AtomicMax(&(pVertexTriangle[a]), n);
+  AtomicMax(&(pVertexTriangle[b]), n);
+  AtomicMax(&(pVertexTriangle[c]), n);
 }
 
 //#########################################################################
 /*! \brief Kernel setting \a vertexTriangle for all vertices
 
-  For every vertex we want to know one triangle sharing it and put the result in \a *pVertexTriangle. Here, we loop through all triangles and set it as the \a vertexTriangle for its vertices using atomic operations. Then \a pVertexTriangle will contain the triangle that has last written to it.
+  For every vertex we want to know one triangle sharing it and put the result in \a *pVertexTriangle. Here, we loop through all triangles and set it as the \a vertexTriangle for its vertices using atomic operations. Then \a pVertexTriangle will contain the largest triangle sharing the vertex.
 
 \param nTriangle Total number of triangles in Mesh
 \param *tv1 Pointer to first vertex of triangle
@@ -86,7 +86,7 @@ void devFillVertexTriangle(int nTriangle, int3 *pTv,
 }
 
 //#########################################################################
-/*! For every vertex we want to know one triangle sharing it, and put the result in \a vertexTriangle. Here, we loop through all triangles and set it as the \a vertexTriangle for its vertices using atomic operations. Then \a vertexTriangle will contain the triangle that has last written to it.*/
+/*! For every vertex we want to know one triangle sharing it, and put the result in \a vertexTriangle. Here, we loop through all triangles and set it as the \a vertexTriangle for its vertices using atomic operations. Then \a vertexTriangle will contain the largest triangle sharing the vertex, independent of the order in which triangles are processed.*/
 //#########################################################################
 
 void Coarsen::FillVertexTriangle(Connectivity *connectivity)
@@ -111,6 +111,8 @@ void Coarsen::FillVertexTriangle(Connectivity *connectivity)
 
   int3 *pTv = connectivity->triangleVertices->GetPointer();
 
+  vertexTriangle->SetSize(nVertex);
+  vertexTriangle->SetToValue(-1);
   int *pVertexTriangle = vertexTriangle->GetPointer();
 
   if (cudaFlag == 1) {
@@ -122,11 +124,12 @@ void Coarsen::FillVertexTriangle(Connectivity *connectivity)
                                        devFillVertexTriangle,
                                        (size_t) 0, 0);
 
-    devFillVertexTriangle<<<nBlocks, nThreads>>>
+    LaunchKernel(nBlocks, nThreads, devFillVertexTriangle)
       (nTriangle, pTv, nVertex, pVertexTriangle);
     gpuErrchk( cudaPeekAtLastError() );
     gpuErrchk( cudaDeviceSynchronize() );
   } else {
+#pragma omp parallel for
     for (int n = 0; n < nTriangle; n++)
       FillVertexTriangleSingle(n, pTv, nVertex, pVertexTriangle);
   }
@@ -146,4 +149,311 @@ void Coarsen::FillVertexTriangle(Connectivity *connectivity)
 
 }
 
+//#########################################################################
+/*! \brief Check whether vertex \a v is part of triangle \a t
+
+\param t Triangle to consider
+\param v Vertex to look for
+\param *pTv Pointer to triangle vertices
+\param nVertex Total number of vertices in Mesh*/
+//#########################################################################
+
+__host__ __device__
+int VertexInTriangle(int t, int v, const int3 *pTv, int nVertex)
+{
+  int a = pTv[t].x;
+  int b = pTv[t].y;
+  int c = pTv[t].z;
+  while (a >= nVertex) a -= nVertex;
+  while (b >= nVertex) b -= nVertex;
+  while (c >= nVertex) c -= nVertex;
+  while (a < 0) a += nVertex;
+  while (b < 0) b += nVertex;
+  while (c < 0) c += nVertex;
+
+  return (a == v || b == v || c == v);
+}
+
+//#########################################################################
+/*! \brief Forget \a vertexTriangle of vertex \a v if its triangle is removed
+
+\param v Vertex to consider
+\param *pTriangleKeepFlag Pointer to flags whether triangles are kept
+\param *pVertexTriangle Pointer to triangle for every vertex; set to -1 if triangle is removed*/
+//#########################################################################
+
+__host__ __device__
+void ResetVertexTriangleSingle(int v, const int *pTriangleKeepFlag,
+                               int *pVertexTriangle)
+{
+  int t = pVertexTriangle[v];
+  if (t != -1)
+    if (pTriangleKeepFlag[t] == 0) pVertexTriangle[v] = -1;
+}
+
+//#########################################################################
+/*! \brief Kernel forgetting \a vertexTriangle of vertices whose triangle is removed
+
+\param nVertex Total number of vertices in Mesh
+\param *pTriangleKeepFlag Pointer to flags whether triangles are kept
+\param *pVertexTriangle Pointer to triangle for every vertex; set to -1 if triangle is removed*/
+//#########################################################################
+
+__global__
+void devResetVertexTriangle(int nVertex, const int *pTriangleKeepFlag,
+                            int *pVertexTriangle)
+{
+  int v = blockIdx.x*blockDim.x + threadIdx.x;
+
+  while (v < nVertex) {
+    ResetVertexTriangleSingle(v, pTriangleKeepFlag, pVertexTriangle);
+
+    v += blockDim.x*gridDim.x;
+  }
+}
+
+//#########################################################################
+/*! \brief Set \a vertexTriangle for vertices of triangle \a pVertexTriangleList[n] if it is kept
+
+\param n Index in \a pVertexTriangleList to consider
+\param *pVertexTriangleList Pointer to triangles around removed vertices
+\param *pTriangleKeepFlag Pointer to flags whether triangles are kept
+\param *pTv Pointer to triangle vertices
+\param nVertex Total number of vertices in Mesh
+\param *pVertexTriangle Pointer to triangle for every vertex (output)*/
+//#########################################################################
+
+__host__ __device__
+void KeepVertexTriangleSingle(int n, const int *pVertexTriangleList,
+                              const int *pTriangleKeepFlag, const int3 *pTv,
+                              int nVertex, int *pVertexTriangle)
+{
+  int t = pVertexTriangleList[n];
+
+  if (t != -1) {
+    if (pTriangleKeepFlag[t] == 1) {
+      int a = pTv[t].x;
+      int b = pTv[t].y;
+      int c = pTv[t].z;
+      while (a >= nVertex) a -= nVertex;
+      while (b >= nVertex) b -= nVertex;
+      while (c >= nVertex) c -= nVertex;
+      while (a < 0) a += nVertex;
+      while (b < 0) b += nVertex;
+      while (c < 0) c += nVertex;
+
+      AtomicMax(&(pVertexTriangle[a]), t);
+      AtomicMax(&(pVertexTriangle[b]), t);
+      AtomicMax(&(pVertexTriangle[c]), t);
+    }
+  }
+}
+
+//#########################################################################
+/*! \brief Kernel setting \a vertexTriangle for vertices of kept triangles around removed vertices
+
+\param N Total number of entries in \a pVertexTriangleList
+\param *pVertexTriangleList Pointer to triangles around removed vertices
+\param *pTriangleKeepFlag Pointer to flags whether triangles are kept
+\param *pTv Pointer to triangle vertices
+\param nVertex Total number of vertices in Mesh
+\param *pVertexTriangle Pointer to triangle for every vertex (output)*/
+//#########################################################################
+
+__global__
+void devKeepVertexTriangle(int N, const int *pVertexTriangleList,
+                           const int *pTriangleKeepFlag, const int3 *pTv,
+                           int nVertex, int *pVertexTriangle)
+{
+  int n = blockIdx.x*blockDim.x + threadIdx.x;
+
+  while (n < N) {
+    KeepVertexTriangleSingle(n, pVertexTriangleList, pTriangleKeepFlag,
+                             pTv, nVertex, pVertexTriangle);
+
+    n += blockDim.x*gridDim.x;
+  }
+}
+
+//#########################################################################
+/*! After removing vertices, but before compacting the triangle Arrays, make sure every vertex is associated with a triangle that is kept. Only triangles around removed vertices change, and every vertex of a removed triangle is part of one of the kept triangles around the same removed vertex. Vertices whose triangle is removed are therefore given the largest kept triangle from \a vertexTriangleList that contains them, which does not depend on the order of processing.
+
+\param *vertexTriangleList Pointer to triangles around removed vertices
+\param maxTriPerVert Maximum number of triangles sharing any vertex
+\param *triangleKeepFlag Pointer to flags whether triangles are kept*/
+//#########################################################################
+
+void Coarsen::UpdateVertexTriangle(Connectivity *connectivity,
+                                   Array<int> *vertexTriangleList,
+                                   int maxTriPerVert,
+                                   Array<int> *triangleKeepFlag)
+{
+  int nVertex = connectivity->vertexCoordinates->GetSize();
+  int N = vertexRemove->GetSize()*maxTriPerVert;
+
+  const int3 *pTv = connectivity->triangleVertices->GetPointer();
+  const int *pVertexTriangleList = vertexTriangleList->GetPointer();
+  const int *pTriangleKeepFlag = triangleKeepFlag->GetPointer();
+  int *pVertexTriangle = vertexTriangle->GetPointer();
+
+  if (cudaFlag == 1) {
+    int nBlocks = 128;
+    int nThreads = 128;
+
+    // Base nThreads and nBlocks on maximum occupancy
+    cudaOccupancyMaxPotentialBlockSize(&nBlocks, &nThreads,
+                                       devResetVertexTriangle,
+                                       (size_t) 0, 0);
+
+    LaunchKernel(nBlocks, nThreads, devResetVertexTriangle)
+      (nVertex, pTriangleKeepFlag, pVertexTriangle);
+    gpuErrchk( cudaPeekAtLastError() );
+    gpuErrchk( cudaDeviceSynchronize() );
+
+    // Base nThreads and nBlocks on maximum occupancy
+    cudaOccupancyMaxPotentialBlockSize(&nBlocks, &nThreads,
+                                       devKeepVertexTriangle,
+                                       (size_t) 0, 0);
+
+    LaunchKernel(nBlocks, nThreads, devKeepVertexTriangle)
+      (N, pVertexTriangleList, pTriangleKeepFlag, pTv,
+       nVertex, pVertexTriangle);
+    gpuErrchk( cudaPeekAtLastError() );
+    gpuErrchk( cudaDeviceSynchronize() );
+  } else {
+#pragma omp parallel for
+    for (int v = 0; v < nVertex; v++)
+      ResetVertexTriangleSingle(v, pTriangleKeepFlag, pVertexTriangle);
+#pragma omp parallel for
+    for (int n = 0; n < N; n++)
+      KeepVertexTriangleSingle(n, pVertexTriangleList, pTriangleKeepFlag,
+                               pTv, nVertex, pVertexTriangle);
+  }
+}
+
+//#########################################################################
+/*! \brief Make sure \a pVertexTriangle[v] contains vertex \a v
+
+If the triangle associated with \a v no longer contains \a v, which happens when edges are flipped, look for \a v in the neighbours of the old triangle and in their neighbours. If \a v is not found, \a pVertexTriangle[v] is set to -1.
+
+\param v Vertex to consider
+\param *pTv Pointer to triangle vertices
+\param *pTe Pointer to triangle edges
+\param *pEt Pointer to edge triangles
+\param nVertex Total number of vertices in Mesh
+\param nTriangle Total number of triangles in Mesh
+\param *pVertexTriangle Pointer to triangle for every vertex*/
+//#########################################################################
+
+__host__ __device__
+void RepairVertexTriangleSingle(int v, const int3 *pTv, const int3 *pTe,
+                                const int2 *pEt, int nVertex, int nTriangle,
+                                int *pVertexTriangle)
+{
+  int t = pVertexTriangle[v];
+
+  if (t < 0 || t >= nTriangle) {
+    pVertexTriangle[v] = -1;
+    return;
+  }
+  if (VertexInTriangle(t, v, pTv, nVertex)) return;
+
+  int ret = -1;
+
+  int e[] = {pTe[t].x, pTe[t].y, pTe[t].z};
+
+  // Direct neighbours
+  for (int n = 0; n < 3; n++) {
+    int t1 = pEt[e[n]].x;
+    if (t1 == t) t1 = pEt[e[n]].y;
+    if (t1 != -1 && ret == -1)
+      if (VertexInTriangle(t1, v, pTv, nVertex)) ret = t1;
+  }
+
+  // Neighbours of neighbours
+  for (int n = 0; n < 3; n++) {
+    int t1 = pEt[e[n]].x;
+    if (t1 == t) t1 = pEt[e[n]].y;
+    if (t1 != -1 && ret == -1) {
+      int f[] = {pTe[t1].x, pTe[t1].y, pTe[t1].z};
+      for (int m = 0; m < 3; m++) {
+        int t2 = pEt[f[m]].x;
+        if (t2 == t1) t2 = pEt[f[m]].y;
+        if (t2 != -1 && t2 != t && ret == -1)
+          if (VertexInTriangle(t2, v, pTv, nVertex)) ret = t2;
+      }
+    }
+  }
+
+  pVertexTriangle[v] = ret;
+}
+
+//#########################################################################
+/*! \brief Kernel making sure \a pVertexTriangle[v] contains vertex \a v
+
+\param nVertex Total number of vertices in Mesh
+\param *pTv Pointer to triangle vertices
+\param *pTe Pointer to triangle edges
+\param *pEt Pointer to edge triangles
+\param nTriangle Total number of triangles in Mesh
+\param *pVertexTriangle Pointer to triangle for every vertex*/
+//#########################################################################
+
+__global__
+void devRepairVertexTriangle(int nVertex, const int3 *pTv, const int3 *pTe,
+                             const int2 *pEt, int nTriangle,
+                             int *pVertexTriangle)
+{
+  int v = blockIdx.x*blockDim.x + threadIdx.x;
+
+  while (v < nVertex) {
+    RepairVertexTriangleSingle(v, pTv, pTe, pEt, nVertex, nTriangle,
+                               pVertexTriangle);
+
+    v += blockDim.x*gridDim.x;
+  }
+}
+
+//#########################################################################
+/*! Make sure \a vertexTriangle is valid for the current Mesh, so that it does not have to be rebuilt from scratch every coarsening cycle. Entries that are still valid are kept; vertices that have lost their triangle through edge flips are usually found in a nearby triangle. Only if the number of vertices has changed or some vertices could not be found locally is \a vertexTriangle filled again from all triangles.*/
+//#########################################################################
+
+void Coarsen::RepairVertexTriangle(Connectivity *connectivity)
+{
+  int nVertex = connectivity->vertexCoordinates->GetSize();
+  int nTriangle = connectivity->triangleVertices->GetSize();
+
+  if ((int) vertexTriangle->GetSize() != nVertex) {
+    FillVertexTriangle(connectivity);
+    return;
+  }
+
+  const int3 *pTv = connectivity->triangleVertices->GetPointer();
+  const int3 *pTe = connectivity->triangleEdges->GetPointer();
+  const int2 *pEt = connectivity->edgeTriangles->GetPointer();
+  int *pVertexTriangle = vertexTriangle->GetPointer();
+
+  if (cudaFlag == 1) {
+    int nBlocks = 128;
+    int nThreads = 128;
+
+    // Base nThreads and nBlocks on maximum occupancy
+    cudaOccupancyMaxPotentialBlockSize(&nBlocks, &nThreads,
+                                       devRepairVertexTriangle,
+                                       (size_t) 0, 0);
+
+    LaunchKernel(nBlocks, nThreads, devRepairVertexTriangle)
+      (nVertex, pTv, pTe, pEt, nTriangle, pVertexTriangle);
+    gpuErrchk( cudaPeekAtLastError() );
+    gpuErrchk( cudaDeviceSynchronize() );
+  } else {
+#pragma omp parallel for
+    for (int v = 0; v < nVertex; v++)
+      RepairVertexTriangleSingle(v, pTv, pTe, pEt, nVertex, nTriangle,
+                                 pVertexTriangle);
+  }
+
+  if (vertexTriangle->Minimum() < 0) FillVertexTriangle(connectivity);
+}
+
 }
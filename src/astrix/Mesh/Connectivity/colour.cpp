@@ -0,0 +1,157 @@
+// -*-c++-*-
+/*! \file colour.cpp
+\brief Functions for colouring triangles
+
+\section LICENSE
+Copyright (c) 2017 Sijme-Jan Paardekooper
+
+This file is part of Astrix.
+
+Astrix is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+
+Astrix is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Astrix.  If not, see <http://www.gnu.org/licenses/>.*/
+
+#include "../../Common/cudaRuntime.h"
+#include <iostream>
+#include <algorithm>
+
+#include "../../Common/definitions.h"
+#include "../../Array/array.h"
+#include "./connectivity.h"
+
+namespace astrix {
+
+//#########################################################################
+/*! Partition triangles into colours such that no two triangles of the same
+colour share a vertex. Host loops scattering triangle quantities to vertices
+can then process one colour at a time, running over the triangles of a colour
+in parallel without atomic operations. Since the colouring only depends on the
+Mesh, the order in which contributions are added to a vertex does not depend
+on the number of threads, and results are bit-reproducible.
+
+Colours are assigned greedily in order of triangle index, so that after a
+Morton ordering neighbouring triangles end up in different colours while
+triangles of one colour are still spread evenly through memory. Each sweep
+assigns at most 32 colours (one bit per colour in a vertex mask); triangles
+that do not fit are coloured in a next sweep. On the device, conflicts are
+handled by atomic operations and nothing is done. Requires \a
+triangleVerticesWrapped to be up to date, see CalcTriangleVerticesWrapped().*/
+//#########################################################################
+
+void Connectivity::CalcTriangleColour()
+{
+  if (cudaFlag == 1) {
+    triangleColour->SetSize(0);
+    triangleColourOffset->SetSize(1);
+    triangleColourOffset->SetToValue(0);
+    colourValid = 1;
+    return;
+  }
+
+  int nTriangle = triangleVertices->GetSize();
+  int nVertex = vertexCoordinates->GetSize();
+
+  // Wrapped vertices: periodic images map to the same vertex
+  const int3 *pTv = triangleVerticesWrapped->GetPointer();
+
+  // Colour for every triangle, -1 if not coloured yet
+  Array<int> *colour = new Array<int>(1, 0, nTriangle);
+  colour->SetToValue(-1);
+  int *pColour = colour->GetPointer();
+
+  // Colours used by triangles sharing vertex in current sweep
+  Array<unsigned int> *vertexMask = new Array<unsigned int>(1, 0, nVertex);
+  unsigned int *pMask = vertexMask->GetPointer();
+
+  int nColour = 0;
+  int nColoured = 0;
+
+  while (nColoured < nTriangle) {
+    vertexMask->SetToValue(0);
+    int nColourSweep = 0;
+
+    for (int n = 0; n < nTriangle; n++) {
+      if (pColour[n] != -1) continue;
+
+      int a = pTv[n].x;
+      int b = pTv[n].y;
+      int c = pTv[n].z;
+
+      unsigned int used = pMask[a] | pMask[b] | pMask[c];
+
+      // No colour left in this sweep
+      if (used == 0xffffffffu) continue;
+
+      // Lowest colour not used by any neighbour
+      int k = 0;
+      while ((used & (1u << k)) != 0) k++;
+
+      pMask[a] |= (1u << k);
+      pMask[b] |= (1u << k);
+      pMask[c] |= (1u << k);
+
+      pColour[n] = nColour + k;
+      nColourSweep = std::max(nColourSweep, k + 1);
+      nColoured++;
+    }
+
+    nColour += nColourSweep;
+  }
+
+  delete vertexMask;
+
+  // Count triangles per colour and convert into offsets
+  triangleColourOffset->SetSize(nColour + 1);
+  triangleColourOffset->SetToValue(0);
+  int *pOffset = triangleColourOffset->GetPointer();
+
+  for (int n = 0; n < nTriangle; n++) pOffset[pColour[n] + 1]++;
+  for (int i = 0; i < nColour; i++) pOffset[i + 1] += pOffset[i];
+
+  // Sort triangles by colour, keeping triangle order within a colour
+  triangleColour->SetSize(nTriangle);
+  int *pTc = triangleColour->GetPointer();
+
+  Array<int> *position = new Array<int>(1, 0, nColour + 1);
+  position->SetEqual(triangleColourOffset);
+  int *pPos = position->GetPointer();
+
+  for (int n = 0; n < nTriangle; n++) pTc[pPos[pColour[n]]++] = n;
+
+  delete position;
+  delete colour;
+
+  colourValid = 1;
+}
+
+//#########################################################################
+/*! Mark the colouring as out of date after triangles have changed. It is then only recalculated by UpdateTriangleColour() when a host scatter loop needs it, so that refinement steps followed by the gather path never colour the Mesh.*/
+//#########################################################################
+
+void Connectivity::InvalidateTriangleColour()
+{
+  colourValid = 0;
+}
+
+//#########################################################################
+// Recalculate colouring if triangles changed since it was last calculated
+//#########################################################################
+
+void Connectivity::UpdateTriangleColour()
+{
+  if (colourValid == 0) CalcTriangleColour();
+}
+
+//#########################################################################
+// Return number of triangle colours
+//#########################################################################
+
+int Connectivity::GetNColour()
+{
+  return triangleColourOffset->GetSize() - 1;
+}
+
+}  // namespace astrix
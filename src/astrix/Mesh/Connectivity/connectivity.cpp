@@ -14,7 +14,7 @@ Astrix is distributed in the hope that it will be useful, but WITHOUT ANY WARRAN
 You should have received a copy of the GNU General Public License
 along with Astrix.  If not, see <http://www.gnu.org/licenses/>.*/
 
-#include <cuda_runtime_api.h>
+#include "../../Common/cudaRuntime.h"
 #include <iostream>
 
 #include "../../Common/definitions.h"
@@ -38,9 +38,23 @@ Connectivity::Connectivity(int _cudaFlag)
   // Allocate arrays (note large size to minimise additional allocation calls)
   vertexCoordinates = new Array<real2>(1, cudaFlag, 0, 128*8192);
   triangleVertices = new Array<int3>(1, cudaFlag, 0, 128*8192);
+  triangleVerticesWrapped = new Array<int3>(1, cudaFlag, 0, 128*8192);
+  triangleShift = new Array<int>(1, cudaFlag, 0, 128*8192);
   triangleEdges = new Array<int3>(1, cudaFlag, 0, 128*8192);
   edgeTriangles = new Array<int2>(1, cudaFlag, 0, 128*8192);
   vertexArea = new Array<real>(1, cudaFlag, 0, 128*8192);
+  vertexTriangle = new Array<int>(1, cudaFlag, 0, 3*128*8192);
+  vertexTriangleOffset = new Array<int>(1, cudaFlag, 0, 128*8192);
+  vertexTriangleWork = new Array<int>(1, cudaFlag, 0, 3*128*8192);
+  vertexTriangleOffsetWork = new Array<int>(1, cudaFlag, 0, 128*8192);
+  cornerVertex = new Array<int>(1, cudaFlag);
+  cornerTriangle = new Array<int>(1, cudaFlag);
+
+  // Colouring is only used by the host, so these always live on the host
+  triangleColour = new Array<int>(1, 0, 0, 128*8192);
+  triangleColourOffset = new Array<int>(1, 0, 1);
+  triangleColourOffset->SetToValue(0);
+  colourValid = 1;
 }
 
 //#########################################################################
@@ -52,9 +66,19 @@ Connectivity::~Connectivity()
   // Release memory
   delete vertexCoordinates;
   delete triangleVertices;
+  delete triangleVerticesWrapped;
+  delete triangleShift;
   delete triangleEdges;
   delete edgeTriangles;
   delete vertexArea;
+  delete vertexTriangle;
+  delete vertexTriangleOffset;
+  delete vertexTriangleWork;
+  delete vertexTriangleOffsetWork;
+  delete cornerVertex;
+  delete cornerTriangle;
+  delete triangleColour;
+  delete triangleColourOffset;
 }
 
 //#########################################################################
@@ -67,16 +91,32 @@ void Connectivity::Transform()
   if (cudaFlag == 1) {
     vertexCoordinates->TransformToHost();
     triangleVertices->TransformToHost();
+    triangleVerticesWrapped->TransformToHost();
+    triangleShift->TransformToHost();
     triangleEdges->TransformToHost();
     edgeTriangles->TransformToHost();
     vertexArea->TransformToHost();
+    vertexTriangle->TransformToHost();
+    vertexTriangleOffset->TransformToHost();
+    vertexTriangleWork->TransformToHost();
+    vertexTriangleOffsetWork->TransformToHost();
+    cornerVertex->TransformToHost();
+    cornerTriangle->TransformToHost();
     cudaFlag = 0;
   } else {
     vertexCoordinates->TransformToDevice();
     triangleVertices->TransformToDevice();
+    triangleVerticesWrapped->TransformToDevice();
+    triangleShift->TransformToDevice();
     triangleEdges->TransformToDevice();
     edgeTriangles->TransformToDevice();
     vertexArea->TransformToDevice();
+    vertexTriangle->TransformToDevice();
+    vertexTriangleOffset->TransformToDevice();
+    vertexTriangleWork->TransformToDevice();
+    vertexTriangleOffsetWork->TransformToDevice();
+    cornerVertex->TransformToDevice();
+    cornerTriangle->TransformToDevice();
     cudaFlag = 1;
   }
 }
@@ -90,9 +130,13 @@ void Connectivity::CopyToHost()
 {
   vertexCoordinates->CopyToHost();
   triangleVertices->CopyToHost();
+  triangleVerticesWrapped->CopyToHost();
+  triangleShift->CopyToHost();
   triangleEdges->CopyToHost();
   edgeTriangles->CopyToHost();
   vertexArea->CopyToHost();
+  vertexTriangle->CopyToHost();
+  vertexTriangleOffset->CopyToHost();
 }
 
 //#########################################################################
@@ -104,9 +148,13 @@ void Connectivity::CopyToDevice()
 {
   vertexCoordinates->CopyToDevice();
   triangleVertices->CopyToDevice();
+  triangleVerticesWrapped->CopyToDevice();
+  triangleShift->CopyToDevice();
   triangleEdges->CopyToDevice();
   edgeTriangles->CopyToDevice();
   vertexArea->CopyToDevice();
+  vertexTriangle->CopyToDevice();
+  vertexTriangleOffset->CopyToDevice();
 }
 
 }  // namespace astrix
@@ -34,12 +34,26 @@ class Connectivity
   Array <real2> *vertexCoordinates;
   //! Vertices belonging to triangles
   Array <int3> *triangleVertices;
+  //! Vertices belonging to triangles, periodic images mapped back onto original vertex
+  Array <int3> *triangleVerticesWrapped;
+  //! Periodic image of every triangle vertex, 4 bits per corner
+  /*! Corner \a k of triangle \a n is vertex triangleVerticesWrapped[n] + i*nVertex of \a triangleVertices, with i = ((triangleShift[n] >> 4*k) & 15) - 4. See TriangleShiftImage().*/
+  Array <int> *triangleShift;
   //! Edges belonging to triangles
   Array <int3> *triangleEdges;
   //! Triangles associated with edges
   Array <int2> *edgeTriangles;
   //! Vertex area (area of Voronoi cell)
   Array <real> *vertexArea;
+  //! Triangles sharing vertices: 3*triangle + corner, sorted by vertex
+  Array <int> *vertexTriangle;
+  //! Start of every vertex in \a vertexTriangle; size is nVertex + 1
+  Array <int> *vertexTriangleOffset;
+  //! Triangles sorted by colour (host only)
+  /*! Triangles of the same colour do not share any vertex, so that they can scatter to their vertices in parallel without atomic operations. Only filled if \a cudaFlag = 0.*/
+  Array <int> *triangleColour;
+  //! Start of every colour in \a triangleColour; size is number of colours + 1
+  Array <int> *triangleColourOffset;
 
   //! Transform from device to host or vice versa
   void Transform();
@@ -50,11 +64,40 @@ class Connectivity
 
   void CheckEdgeTriangles();
 
+  //! Fill \a triangleVerticesWrapped and \a triangleShift
+  void CalcTriangleVerticesWrapped();
   //! Calculate area associated with vertices (Voronoi cells)
   void CalcVertexArea(real Px, real Py);
+  //! Recalculate area of listed vertices only
+  void UpdateVertexArea(Array<int> *vertexList, int nList, real Px, real Py);
+  //! Create list of triangles sharing every vertex
+  void CalcVertexTriangle();
+  //! Update list of triangles sharing every vertex for flagged vertices only
+  void UpdateVertexTriangle(Array<int> *triangleList, int nList,
+                            Array<int> *triangleFlag,
+                            Array<int> *vertexFlag);
+  //! Partition triangles into sets not sharing any vertex
+  void CalcTriangleColour();
+  //! Mark triangle colouring as out of date
+  void InvalidateTriangleColour();
+  //! Partition triangles into colours if colouring is out of date
+  void UpdateTriangleColour();
+  //! Return number of triangle colours
+  int GetNColour();
  private:
   //! Flag whether date resides on host (0) or device (1)
   int cudaFlag;
+  //! Flag whether \a triangleColour is up to date
+  int colourValid;
+
+  //! Workspace: new \a vertexTriangle in UpdateVertexTriangle()
+  Array <int> *vertexTriangleWork;
+  //! Workspace: new \a vertexTriangleOffset in UpdateVertexTriangle()
+  Array <int> *vertexTriangleOffsetWork;
+  //! Workspace: vertices at corners of listed triangles
+  Array <int> *cornerVertex;
+  //! Workspace: 3*triangle + corner for corners of listed triangles
+  Array <int> *cornerTriangle;
 };
 
 }  // namespace astrix
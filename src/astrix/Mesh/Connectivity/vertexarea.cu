@@ -26,6 +26,32 @@ along with Astrix.  If not, see <http://www.gnu.org/licenses/>.*/
 
 namespace astrix {
 
+//##############################################################################
+/*! \brief Return one third of the area of triangle \a n
+
+\param n Index of triangle to consider
+\param *pTv Pointer triangle vertices
+\param nVertex Total number of vertices in Mesh
+\param *pVc Pointer to vertex coordinates
+\param Px Periodic domain size x
+\param Py Periodic domain size y*/
+//##############################################################################
+
+__host__ __device__
+real TriangleAreaThird(int n, int3 *pTv, int nVertex,
+                       real2 *pVc, real Px, real Py)
+{
+  const real onethird = (real) (1.0/3.0);
+  const real half  = (real) 0.5;
+
+  real Ax, Bx, Cx, Ay, By, Cy;
+  GetTriangleCoordinates(pVc, pTv[n].x, pTv[n].y, pTv[n].z,
+                         nVertex, Px, Py,
+                         Ax, Bx, Cx, Ay, By, Cy);
+
+  return half*((Ax - Cx)*(By - Cy) - (Ay - Cy)*(Bx - Cx))*onethird;
+}
+
 //##############################################################################
 /*! \brief Add contribution of area of triangle \a n to the area of its vertices
 
@@ -46,19 +72,11 @@ void VertexAreaSingle(int n, int3 *pTv,
                       real *pVertexArea, int nVertex,
                       real2 *pVc, real Px, real Py, int nTriangle)
 {
-  const real onethird = (real) (1.0/3.0);
-  const real half  = (real) 0.5;
-
   int a = pTv[n].x;
   int b = pTv[n].y;
   int c = pTv[n].z;
 
-  real Ax, Bx, Cx, Ay, By, Cy;
-  GetTriangleCoordinates(pVc, a, b, c,
-                         nVertex, Px, Py,
-                         Ax, Bx, Cx, Ay, By, Cy);
-
-  real A = half*((Ax - Cx)*(By - Cy) - (Ay - Cy)*(Bx - Cx))*onethird;
+  real A = TriangleAreaThird(n, pTv, nVertex, pVc, Px, Py);
 
   while (a >= nVertex) a -= nVertex;
   while (b >= nVertex) b -= nVertex;
@@ -129,7 +147,7 @@ void Connectivity::CalcVertexArea(real Px, real Py)
                                        devCalcVertexArea,
                                        (size_t) 0, 0);
 
-    devCalcVertexArea<<<nBlocks, nThreads>>>
+    LaunchKernel(nBlocks, nThreads, devCalcVertexArea)
       (nVertex, nTriangle, pTv, pVertexArea, pVc, Px, Py);
 
     gpuErrchk( cudaPeekAtLastError() );
@@ -140,4 +158,112 @@ void Connectivity::CalcVertexArea(real Px, real Py)
   }
 }
 
+//##############################################################################
+/*! \brief Calculate area of listed vertex \a pVl[i] from its triangles
+
+Gathers the contributions of all triangles sharing the vertex, in order of triangle index, so that the result is the same as for CalcVertexArea() on the host.
+
+\param i Index in vertex list
+\param *pVl Pointer to list of vertices
+\param *pVt Pointer to vertex triangle list (3*triangle + corner)
+\param *pVtOffset Pointer to start of every vertex in vertex triangle list
+\param *pTv Pointer triangle vertices
+\param *pVertexArea Pointer to output array containing vertex areas
+\param nVertex Total number of vertices in Mesh
+\param *pVc Pointer to vertex coordinates
+\param Px Periodic domain size x
+\param Py Periodic domain size y*/
+//##############################################################################
+
+__host__ __device__
+void UpdateVertexAreaSingle(int i, int *pVl, int *pVt, int *pVtOffset,
+                            int3 *pTv, real *pVertexArea, int nVertex,
+                            real2 *pVc, real Px, real Py)
+{
+  int v = pVl[i];
+
+  real A = (real) 0.0;
+  for (int k = pVtOffset[v]; k < pVtOffset[v + 1]; k++)
+    A += TriangleAreaThird(pVt[k]/3, pTv, nVertex, pVc, Px, Py);
+
+  pVertexArea[v] = A;
+}
+
+//######################################################################
+/*! \brief Kernel calculating area of listed vertices
+
+\param nList Number of vertices in list
+\param *pVl Pointer to list of vertices
+\param *pVt Pointer to vertex triangle list (3*triangle + corner)
+\param *pVtOffset Pointer to start of every vertex in vertex triangle list
+\param *pTv Pointer triangle vertices
+\param *pVertexArea Pointer to output array containing vertex areas
+\param nVertex Total number of vertices in Mesh
+\param *pVc Pointer to vertex coordinates
+\param Px Periodic domain size x
+\param Py Periodic domain size y*/
+//######################################################################
+
+__global__ void
+devUpdateVertexArea(int nList, int *pVl, int *pVt, int *pVtOffset,
+                    int3 *pTv, real *pVertexArea, int nVertex,
+                    real2 *pVc, real Px, real Py)
+{
+  int i = blockIdx.x*blockDim.x + threadIdx.x;
+
+  while (i < nList) {
+    UpdateVertexAreaSingle(i, pVl, pVt, pVtOffset, pTv, pVertexArea,
+                           nVertex, pVc, Px, Py);
+
+    i += blockDim.x*gridDim.x;
+  }
+}
+
+//#########################################################################
+/*! Recalculate the area of the vertices in \a vertexList only, from the
+triangles sharing each vertex. Needs an up to date vertex triangle list
+(CalcVertexTriangle()); areas of all other vertices must still be valid.
+
+\param *vertexList List of vertices to update
+\param nList Number of vertices in list
+\param Px Periodic domain size x
+\param Py Periodic domain size y*/
+//#########################################################################
+
+void Connectivity::UpdateVertexArea(Array<int> *vertexList, int nList,
+                                    real Px, real Py)
+{
+  int nVertex = vertexCoordinates->GetSize();
+
+  real2 *pVc = vertexCoordinates->GetPointer();
+  int3 *pTv = triangleVertices->GetPointer();
+  int *pVt = vertexTriangle->GetPointer();
+  int *pVtOffset = vertexTriangleOffset->GetPointer();
+  int *pVl = vertexList->GetPointer();
+
+  vertexArea->SetSize(nVertex);
+  real *pVertexArea = vertexArea->GetPointer();
+
+  if (cudaFlag == 1) {
+    int nBlocks = 128;
+    int nThreads = 128;
+
+    // Base nThreads and nBlocks on maximum occupancy
+    cudaOccupancyMaxPotentialBlockSize(&nBlocks, &nThreads,
+                                       devUpdateVertexArea,
+                                       (size_t) 0, 0);
+
+    LaunchKernel(nBlocks, nThreads, devUpdateVertexArea)
+      (nList, pVl, pVt, pVtOffset, pTv, pVertexArea, nVertex, pVc, Px, Py);
+
+    gpuErrchk( cudaPeekAtLastError() );
+    gpuErrchk( cudaDeviceSynchronize() );
+  } else {
+#pragma omp parallel for
+    for (int i = 0; i < nList; i++)
+      UpdateVertexAreaSingle(i, pVl, pVt, pVtOffset, pTv, pVertexArea,
+                             nVertex, pVc, Px, Py);
+  }
+}
+
 }  // namespace astrix
@@ -0,0 +1,556 @@
+// -*-c++-*-
+/*! \file vertextriangle.cu
+\brief Functions for creating list of triangles sharing every vertex
+
+\section LICENSE
+Copyright (c) 2017 Sijme-Jan Paardekooper
+
+This file is part of Astrix.
+
+Astrix is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+
+Astrix is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Astrix.  If not, see <http://www.gnu.org/licenses/>.*/
+#include <iostream>
+#include <utility>
+
+#include "../../Common/definitions.h"
+#include "../../Array/array.h"
+#include "../../Common/cudaLow.h"
+#include "./connectivity.h"
+
+namespace astrix {
+
+//##############################################################################
+/*! \brief Set sort key for the three corners of triangle \a n
+
+Corner \a k of triangle \a n gets entry 3*n + k; its key is the vertex at that corner, with periodic copies mapped back onto the original vertex.
+
+\param n Index of triangle to consider
+\param *pTv Pointer triangle vertices
+\param nVertex Total number of vertices in Mesh
+\param *pKey Pointer to output array of keys (size 3*nTriangle)*/
+//##############################################################################
+
+__host__ __device__
+void FillVertexTriangleKeySingle(int n, int3 *pTv, int nVertex, int *pKey)
+{
+  int a = pTv[n].x;
+  int b = pTv[n].y;
+  int c = pTv[n].z;
+  while (a >= nVertex) a -= nVertex;
+  while (a < 0) a += nVertex;
+  while (b >= nVertex) b -= nVertex;
+  while (b < 0) b += nVertex;
+  while (c >= nVertex) c -= nVertex;
+  while (c < 0) c += nVertex;
+
+  pKey[3*n + 0] = a;
+  pKey[3*n + 1] = b;
+  pKey[3*n + 2] = c;
+}
+
+//######################################################################
+/*! \brief Kernel setting sort keys for all triangle corners
+
+\param nTriangle Total number of triangles
+\param *pTv Pointer triangle vertices
+\param nVertex Total number of vertices in Mesh
+\param *pKey Pointer to output array of keys (size 3*nTriangle)*/
+//######################################################################
+
+__global__ void
+devFillVertexTriangleKey(int nTriangle, int3 *pTv, int nVertex, int *pKey)
+{
+  // n = triangle number
+  int n = blockIdx.x*blockDim.x + threadIdx.x;
+
+  while (n < nTriangle) {
+    FillVertexTriangleKeySingle(n, pTv, nVertex, pKey);
+
+    n += blockDim.x*gridDim.x;
+  }
+}
+
+//##############################################################################
+/*! \brief Find start of vertices in sorted list of keys
+
+Entry \a i of the sorted keys is the first entry of all vertices larger than the previous key, up to and including key \a i. The last entry also closes all remaining vertices.
+
+\param i Index in sorted keys to consider
+\param N Total number of keys (3*nTriangle)
+\param nVertex Total number of vertices in Mesh
+\param *pKey Pointer to sorted keys
+\param *pOffset Pointer to output offsets (size nVertex + 1)*/
+//##############################################################################
+
+__host__ __device__
+void FillVertexTriangleOffsetSingle(int i, int N, int nVertex,
+                                    int *pKey, int *pOffset)
+{
+  int k = pKey[i];
+  int kPrev = -1;
+  if (i > 0) kPrev = pKey[i - 1];
+
+  for (int v = kPrev + 1; v <= k; v++) pOffset[v] = i;
+
+  if (i == N - 1)
+    for (int v = k + 1; v <= nVertex; v++) pOffset[v] = N;
+}
+
+//######################################################################
+/*! \brief Kernel finding start of vertices in sorted list of keys
+
+\param N Total number of keys (3*nTriangle)
+\param nVertex Total number of vertices in Mesh
+\param *pKey Pointer to sorted keys
+\param *pOffset Pointer to output offsets (size nVertex + 1)*/
+//######################################################################
+
+__global__ void
+devFillVertexTriangleOffset(int N, int nVertex, int *pKey, int *pOffset)
+{
+  int i = blockIdx.x*blockDim.x + threadIdx.x;
+
+  while (i < N) {
+    FillVertexTriangleOffsetSingle(i, N, nVertex, pKey, pOffset);
+
+    i += blockDim.x*gridDim.x;
+  }
+}
+
+//#########################################################################
+/*! Create compressed list of triangles sharing every vertex. Entries
+\a vertexTriangleOffset[v] up to \a vertexTriangleOffset[v + 1] of \a
+vertexTriangle hold 3*t + k for every triangle t that has vertex v as corner k.
+Triangles are sorted by index for every vertex, so that gathering over this
+list adds contributions in the same order as looping over triangles.*/
+//#########################################################################
+
+void Connectivity::CalcVertexTriangle()
+{
+  int nTriangle = triangleVertices->GetSize();
+  int nVertex = vertexCoordinates->GetSize();
+  int N = 3*nTriangle;
+
+  int3 *pTv = triangleVertices->GetPointer();
+
+  Array<int> *key = new Array<int>(1, cudaFlag, N);
+  int *pKey = key->GetPointer();
+
+  if (cudaFlag == 1) {
+    int nBlocks = 128;
+    int nThreads = 128;
+
+    // Base nThreads and nBlocks on maximum occupancy
+    cudaOccupancyMaxPotentialBlockSize(&nBlocks, &nThreads,
+                                       devFillVertexTriangleKey,
+                                       (size_t) 0, 0);
+
+    LaunchKernel(nBlocks, nThreads, devFillVertexTriangleKey)
+      (nTriangle, pTv, nVertex, pKey);
+
+    gpuErrchk( cudaPeekAtLastError() );
+    gpuErrchk( cudaDeviceSynchronize() );
+  } else {
+#pragma omp parallel for
+    for (int n = 0; n < nTriangle; n++)
+      FillVertexTriangleKeySingle(n, pTv, nVertex, pKey);
+  }
+
+  // Stable sort keeps triangles in order for every vertex
+  vertexTriangle->SetSize(N);
+  vertexTriangle->SetToSeries();
+  key->SortByKey(vertexTriangle, N);
+
+  vertexTriangleOffset->SetSize(nVertex + 1);
+  int *pOffset = vertexTriangleOffset->GetPointer();
+
+  // Without triangles no key sets the offsets: all lists are empty
+  if (N == 0) {
+    vertexTriangleOffset->SetToValue(0);
+    delete key;
+    return;
+  }
+
+  if (cudaFlag == 1) {
+    int nBlocks = 128;
+    int nThreads = 128;
+
+    // Base nThreads and nBlocks on maximum occupancy
+    cudaOccupancyMaxPotentialBlockSize(&nBlocks, &nThreads,
+                                       devFillVertexTriangleOffset,
+                                       (size_t) 0, 0);
+
+    LaunchKernel(nBlocks, nThreads, devFillVertexTriangleOffset)
+      (N, nVertex, pKey, pOffset);
+
+    gpuErrchk( cudaPeekAtLastError() );
+    gpuErrchk( cudaDeviceSynchronize() );
+  } else {
+#pragma omp parallel for
+    for (int i = 0; i < N; i++)
+      FillVertexTriangleOffsetSingle(i, N, nVertex, pKey, pOffset);
+  }
+
+  delete key;
+}
+
+//##############################################################################
+/*! \brief Set vertex and entry for the three corners of listed triangle \a pTl[i]
+
+\param i Index in list of triangles
+\param *pTl Pointer to list of triangles
+\param *pTv Pointer triangle vertices
+\param nVertex Total number of vertices in Mesh
+\param *pCv Pointer to output vertices at corners (size 3*nList)
+\param *pCt Pointer to output entries 3*triangle + corner (size 3*nList)*/
+//##############################################################################
+
+__host__ __device__
+void FillCornerSingle(int i, int *pTl, int3 *pTv, int nVertex,
+                      int *pCv, int *pCt)
+{
+  int n = pTl[i];
+
+  int a = pTv[n].x;
+  int b = pTv[n].y;
+  int c = pTv[n].z;
+  while (a >= nVertex) a -= nVertex;
+  while (a < 0) a += nVertex;
+  while (b >= nVertex) b -= nVertex;
+  while (b < 0) b += nVertex;
+  while (c >= nVertex) c -= nVertex;
+  while (c < 0) c += nVertex;
+
+  pCv[3*i + 0] = a;
+  pCv[3*i + 1] = b;
+  pCv[3*i + 2] = c;
+  pCt[3*i + 0] = 3*n + 0;
+  pCt[3*i + 1] = 3*n + 1;
+  pCt[3*i + 2] = 3*n + 2;
+}
+
+//######################################################################
+/*! \brief Kernel setting vertex and entry for corners of listed triangles
+
+\param nList Number of triangles in list
+\param *pTl Pointer to list of triangles
+\param *pTv Pointer triangle vertices
+\param nVertex Total number of vertices in Mesh
+\param *pCv Pointer to output vertices at corners (size 3*nList)
+\param *pCt Pointer to output entries 3*triangle + corner (size 3*nList)*/
+//######################################################################
+
+__global__ void
+devFillCorner(int nList, int *pTl, int3 *pTv, int nVertex,
+              int *pCv, int *pCt)
+{
+  int i = blockIdx.x*blockDim.x + threadIdx.x;
+
+  while (i < nList) {
+    FillCornerSingle(i, pTl, pTv, nVertex, pCv, pCt);
+
+    i += blockDim.x*gridDim.x;
+  }
+}
+
+//##############################################################################
+/*! \brief Return first position in sorted array \a *pA of size \a N with value not smaller than \a x
+
+\param *pA Pointer to sorted array
+\param N Size of array
+\param x Value to look for*/
+//##############################################################################
+
+__host__ __device__
+int LowerBound(const int *pA, int N, int x)
+{
+  int lo = 0;
+  int hi = N;
+  while (lo < hi) {
+    int mid = (lo + hi)/2;
+    if (pA[mid] < x)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return lo;
+}
+
+//##############################################################################
+/*! \brief Count triangles sharing vertex \a v after triangles have changed
+
+Unflagged vertices keep their old number of triangles. For flagged vertices, count the old entries of triangles that did not change plus the corners of changed triangles at \a v.
+
+\param v Vertex to consider
+\param nVertex Total number of vertices in Mesh
+\param nVertexOld Number of vertices in old list
+\param *pVt Pointer to old vertex triangle list
+\param *pOffset Pointer to old offsets
+\param *pTf Pointer to flags whether triangle changed
+\param *pVf Pointer to flags whether vertex is corner of changed triangle
+\param nCorner Number of corners of changed triangles
+\param *pCv Pointer to sorted vertices at corners of changed triangles
+\param *pCount Pointer to output number of triangles (size nVertex + 1)*/
+//##############################################################################
+
+__host__ __device__
+void CountVertexTriangleSingle(int v, int nVertex, int nVertexOld,
+                               int *pVt, int *pOffset, int *pTf, int *pVf,
+                               int nCorner, int *pCv, int *pCount)
+{
+  // Last entry, so that the scan gives the total
+  if (v == nVertex) {
+    pCount[v] = 0;
+    return;
+  }
+
+  if (pVf[v] == 0) {
+    pCount[v] = 0;
+    if (v < nVertexOld) pCount[v] = pOffset[v + 1] - pOffset[v];
+    return;
+  }
+
+  int count = 0;
+  if (v < nVertexOld)
+    for (int j = pOffset[v]; j < pOffset[v + 1]; j++)
+      if (pTf[pVt[j]/3] == 0) count++;
+
+  count += LowerBound(pCv, nCorner, v + 1) - LowerBound(pCv, nCorner, v);
+
+  pCount[v] = count;
+}
+
+//######################################################################
+/*! \brief Kernel counting triangles sharing every vertex after triangles have changed
+
+\param nVertex Total number of vertices in Mesh
+\param nVertexOld Number of vertices in old list
+\param *pVt Pointer to old vertex triangle list
+\param *pOffset Pointer to old offsets
+\param *pTf Pointer to flags whether triangle changed
+\param *pVf Pointer to flags whether vertex is corner of changed triangle
+\param nCorner Number of corners of changed triangles
+\param *pCv Pointer to sorted vertices at corners of changed triangles
+\param *pCount Pointer to output number of triangles (size nVertex + 1)*/
+//######################################################################
+
+__global__ void
+devCountVertexTriangle(int nVertex, int nVertexOld,
+                       int *pVt, int *pOffset, int *pTf, int *pVf,
+                       int nCorner, int *pCv, int *pCount)
+{
+  int v = blockIdx.x*blockDim.x + threadIdx.x;
+
+  while (v <= nVertex) {
+    CountVertexTriangleSingle(v, nVertex, nVertexOld, pVt, pOffset,
+                              pTf, pVf, nCorner, pCv, pCount);
+
+    v += blockDim.x*gridDim.x;
+  }
+}
+
+//##############################################################################
+/*! \brief Fill new list of triangles sharing vertex \a v
+
+Unflagged vertices copy their old list. For flagged vertices, the old entries of triangles that did not change and the corners of changed triangles at \a v are merged, so that triangles remain sorted by index.
+
+\param v Vertex to consider
+\param nVertexOld Number of vertices in old list
+\param *pVt Pointer to old vertex triangle list
+\param *pOffset Pointer to old offsets
+\param *pTf Pointer to flags whether triangle changed
+\param *pVf Pointer to flags whether vertex is corner of changed triangle
+\param nCorner Number of corners of changed triangles
+\param *pCv Pointer to sorted vertices at corners of changed triangles
+\param *pCt Pointer to entries 3*triangle + corner belonging to \a pCv
+\param *pVtNew Pointer to output vertex triangle list
+\param *pOffsetNew Pointer to new offsets*/
+//##############################################################################
+
+__host__ __device__
+void FillVertexTriangleUpdateSingle(int v, int nVertexOld,
+                                    int *pVt, int *pOffset,
+                                    int *pTf, int *pVf,
+                                    int nCorner, int *pCv, int *pCt,
+                                    int *pVtNew, int *pOffsetNew)
+{
+  int k = pOffsetNew[v];
+
+  if (pVf[v] == 0) {
+    if (v >= nVertexOld) return;
+    for (int j = pOffset[v]; j < pOffset[v + 1]; j++)
+      pVtNew[k++] = pVt[j];
+    return;
+  }
+
+  int j = 0;
+  int jEnd = 0;
+  if (v < nVertexOld) {
+    j = pOffset[v];
+    jEnd = pOffset[v + 1];
+  }
+  int c = LowerBound(pCv, nCorner, v);
+  int cEnd = LowerBound(pCv, nCorner, v + 1);
+
+  while (j < jEnd || c < cEnd) {
+    // Skip old entries of changed triangles
+    if (j < jEnd && pTf[pVt[j]/3] != 0) {
+      j++;
+      continue;
+    }
+
+    if (c == cEnd || (j < jEnd && pVt[j] < pCt[c]))
+      pVtNew[k++] = pVt[j++];
+    else
+      pVtNew[k++] = pCt[c++];
+  }
+}
+
+//######################################################################
+/*! \brief Kernel filling new list of triangles sharing every vertex
+
+\param nVertex Total number of vertices in Mesh
+\param nVertexOld Number of vertices in old list
+\param *pVt Pointer to old vertex triangle list
+\param *pOffset Pointer to old offsets
+\param *pTf Pointer to flags whether triangle changed
+\param *pVf Pointer to flags whether vertex is corner of changed triangle
+\param nCorner Number of corners of changed triangles
+\param *pCv Pointer to sorted vertices at corners of changed triangles
+\param *pCt Pointer to entries 3*triangle + corner belonging to \a pCv
+\param *pVtNew Pointer to output vertex triangle list
+\param *pOffsetNew Pointer to new offsets*/
+//######################################################################
+
+__global__ void
+devFillVertexTriangleUpdate(int nVertex, int nVertexOld,
+                            int *pVt, int *pOffset, int *pTf, int *pVf,
+                            int nCorner, int *pCv, int *pCt,
+                            int *pVtNew, int *pOffsetNew)
+{
+  int v = blockIdx.x*blockDim.x + threadIdx.x;
+
+  while (v < nVertex) {
+    FillVertexTriangleUpdateSingle(v, nVertexOld, pVt, pOffset, pTf, pVf,
+                                   nCorner, pCv, pCt, pVtNew, pOffsetNew);
+
+    v += blockDim.x*gridDim.x;
+  }
+}
+
+//#########################################################################
+/*! Update \a vertexTriangle and \a vertexTriangleOffset after the triangles in \a triangleList have changed, without sorting all triangle corners as CalcVertexTriangle() does. Only the corners of the listed triangles are sorted, and only the lists of flagged vertices are rebuilt; the lists of all other vertices are copied to their new position in a single pass. The result is identical to CalcVertexTriangle(). Triangles and vertices must not have been reordered or removed since the lists were last calculated.
+
+\param *triangleList List of triangles that are new or have changed
+\param nList Number of triangles in \a triangleList
+\param *triangleFlag Flag for every triangle: 1 if in \a triangleList, 0 otherwise
+\param *vertexFlag Flag for every vertex: 1 if corner of a triangle in \a triangleList, 0 otherwise*/
+//#########################################################################
+
+void Connectivity::UpdateVertexTriangle(Array<int> *triangleList, int nList,
+                                        Array<int> *triangleFlag,
+                                        Array<int> *vertexFlag)
+{
+  int nVertex = vertexCoordinates->GetSize();
+  int nVertexOld = vertexTriangleOffset->GetSize() - 1;
+  int nCorner = 3*nList;
+
+  int3 *pTv = triangleVertices->GetPointer();
+  int *pTl = triangleList->GetPointer();
+  int *pTf = triangleFlag->GetPointer();
+  int *pVf = vertexFlag->GetPointer();
+
+  // Corners of listed triangles, sorted by vertex
+  cornerVertex->SetSize(nCorner);
+  cornerTriangle->SetSize(nCorner);
+  int *pCv = cornerVertex->GetPointer();
+  int *pCt = cornerTriangle->GetPointer();
+
+  if (cudaFlag == 1) {
+    int nBlocks = 128;
+    int nThreads = 128;
+
+    // Base nThreads and nBlocks on maximum occupancy
+    cudaOccupancyMaxPotentialBlockSize(&nBlocks, &nThreads,
+                                       devFillCorner,
+                                       (size_t) 0, 0);
+
+    LaunchKernel(nBlocks, nThreads, devFillCorner)
+      (nList, pTl, pTv, nVertex, pCv, pCt);
+
+    gpuErrchk( cudaPeekAtLastError() );
+    gpuErrchk( cudaDeviceSynchronize() );
+  } else {
+#pragma omp parallel for
+    for (int i = 0; i < nList; i++)
+      FillCornerSingle(i, pTl, pTv, nVertex, pCv, pCt);
+  }
+
+  // Stable sort keeps triangles in order for every vertex
+  cornerVertex->SortByKey(cornerTriangle, nCorner);
+
+  int *pVt = vertexTriangle->GetPointer();
+  int *pOffset = vertexTriangleOffset->GetPointer();
+
+  // Count triangles for every vertex and convert into offsets
+  vertexTriangleOffsetWork->SetSize(nVertex + 1);
+  int *pOffsetNew = vertexTriangleOffsetWork->GetPointer();
+
+  if (cudaFlag == 1) {
+    int nBlocks = 128;
+    int nThreads = 128;
+
+    // Base nThreads and nBlocks on maximum occupancy
+    cudaOccupancyMaxPotentialBlockSize(&nBlocks, &nThreads,
+                                       devCountVertexTriangle,
+                                       (size_t) 0, 0);
+
+    LaunchKernel(nBlocks, nThreads, devCountVertexTriangle)
+      (nVertex, nVertexOld, pVt, pOffset, pTf, pVf, nCorner, pCv, pOffsetNew);
+
+    gpuErrchk( cudaPeekAtLastError() );
+    gpuErrchk( cudaDeviceSynchronize() );
+  } else {
+#pragma omp parallel for
+    for (int v = 0; v <= nVertex; v++)
+      CountVertexTriangleSingle(v, nVertex, nVertexOld, pVt, pOffset,
+                                pTf, pVf, nCorner, pCv, pOffsetNew);
+  }
+
+  int N = vertexTriangleOffsetWork->ExclusiveScan(vertexTriangleOffsetWork,
+                                                  nVertex + 1);
+
+  vertexTriangleWork->SetSize(N);
+  int *pVtNew = vertexTriangleWork->GetPointer();
+
+  if (cudaFlag == 1) {
+    int nBlocks = 128;
+    int nThreads = 128;
+
+    // Base nThreads and nBlocks on maximum occupancy
+    cudaOccupancyMaxPotentialBlockSize(&nBlocks, &nThreads,
+                                       devFillVertexTriangleUpdate,
+                                       (size_t) 0, 0);
+
+    LaunchKernel(nBlocks, nThreads, devFillVertexTriangleUpdate)
+      (nVertex, nVertexOld, pVt, pOffset, pTf, pVf, nCorner, pCv, pCt,
+       pVtNew, pOffsetNew);
+
+    gpuErrchk( cudaPeekAtLastError() );
+    gpuErrchk( cudaDeviceSynchronize() );
+  } else {
+#pragma omp parallel for
+    for (int v = 0; v < nVertex; v++)
+      FillVertexTriangleUpdateSingle(v, nVertexOld, pVt, pOffset, pTf, pVf,
+                                     nCorner, pCv, pCt, pVtNew, pOffsetNew);
+  }
+
+  std::swap(vertexTriangle, vertexTriangleWork);
+  std::swap(vertexTriangleOffset, vertexTriangleOffsetWork);
+}
+
+}  // namespace astrix
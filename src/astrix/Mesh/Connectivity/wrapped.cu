@@ -0,0 +1,146 @@
+// -*-c++-*-
+/*! \file wrapped.cu
+\brief Functions for creating triangle vertices without periodic images
+
+\section LICENSE
+Copyright (c) 2017 Sijme-Jan Paardekooper
+
+This file is part of Astrix.
+
+Astrix is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+
+Astrix is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Astrix.  If not, see <http://www.gnu.org/licenses/>.*/
+#include <iostream>
+
+#include "../../Common/definitions.h"
+#include "../../Array/array.h"
+#include "../../Common/cudaLow.h"
+#include "./connectivity.h"
+
+namespace astrix {
+
+//##############################################################################
+/*! \brief Map vertices of triangle \a n back onto original vertices
+
+Vertex indices in \a pTv can refer to one of eight periodic images, i.e. v + i*nVertex with -4 <= i <= 4. Store v in \a pTvw and i + 4 in four bits per corner of \a pTs.
+
+\param n Index of triangle to consider
+\param *pTv Pointer triangle vertices
+\param nVertex Total number of vertices in Mesh
+\param *pTvw Pointer to output triangle vertices without periodic images
+\param *pTs Pointer to output periodic image codes*/
+//##############################################################################
+
+__host__ __device__
+void FillTriangleVerticesWrappedSingle(int n, int3 *pTv, int nVertex,
+                                       int3 *pTvw, int *pTs)
+{
+  int a = pTv[n].x;
+  int b = pTv[n].y;
+  int c = pTv[n].z;
+
+  int ia = 0;
+  int ib = 0;
+  int ic = 0;
+  while (a >= nVertex) {
+    a -= nVertex;
+    ia++;
+  }
+  while (a < 0) {
+    a += nVertex;
+    ia--;
+  }
+  while (b >= nVertex) {
+    b -= nVertex;
+    ib++;
+  }
+  while (b < 0) {
+    b += nVertex;
+    ib--;
+  }
+  while (c >= nVertex) {
+    c -= nVertex;
+    ic++;
+  }
+  while (c < 0) {
+    c += nVertex;
+    ic--;
+  }
+
+  pTvw[n].x = a;
+  pTvw[n].y = b;
+  pTvw[n].z = c;
+
+  pTs[n] = (ia + 4) | ((ib + 4) << 4) | ((ic + 4) << 8);
+}
+
+//######################################################################
+/*! \brief Kernel mapping vertices of all triangles back onto original vertices
+
+\param nTriangle Total number of triangles
+\param *pTv Pointer triangle vertices
+\param nVertex Total number of vertices in Mesh
+\param *pTvw Pointer to output triangle vertices without periodic images
+\param *pTs Pointer to output periodic image codes*/
+//######################################################################
+
+__global__ void
+devFillTriangleVerticesWrapped(int nTriangle, int3 *pTv, int nVertex,
+                               int3 *pTvw, int *pTs)
+{
+  // n = triangle number
+  int n = blockIdx.x*blockDim.x + threadIdx.x;
+
+  while (n < nTriangle) {
+    FillTriangleVerticesWrappedSingle(n, pTv, nVertex, pTvw, pTs);
+
+    n += blockDim.x*gridDim.x;
+  }
+}
+
+//#########################################################################
+/*! Fill \a triangleVerticesWrapped and \a triangleShift from \a
+triangleVertices. Kernels that only need the state at the vertices of a
+triangle can then load the vertex indices directly, rather than mapping
+periodic images back in a loop that depends on the data. This has to be called
+whenever \a triangleVertices has changed, i.e. after refining, coarsening or
+reading the Mesh.*/
+//#########################################################################
+
+void Connectivity::CalcTriangleVerticesWrapped()
+{
+  int nTriangle = triangleVertices->GetSize();
+  int nVertex = vertexCoordinates->GetSize();
+
+  triangleVerticesWrapped->SetSize(nTriangle);
+  triangleShift->SetSize(nTriangle);
+
+  int3 *pTv = triangleVertices->GetPointer();
+  int3 *pTvw = triangleVerticesWrapped->GetPointer();
+  int *pTs = triangleShift->GetPointer();
+
+  if (cudaFlag == 1) {
+    int nBlocks = 128;
+    int nThreads = 128;
+
+    // Base nThreads and nBlocks on maximum occupancy
+    cudaOccupancyMaxPotentialBlockSize(&nBlocks, &nThreads,
+                                       devFillTriangleVerticesWrapped,
+                                       (size_t) 0, 0);
+
+    LaunchKernel(nBlocks, nThreads, devFillTriangleVerticesWrapped)
+      (nTriangle, pTv, nVertex, pTvw, pTs);
+
+    gpuErrchk( cudaPeekAtLastError() );
+    gpuErrchk( cudaDeviceSynchronize() );
+  } else {
+#pragma omp parallel for
+    for (int n = 0; n < nTriangle; n++)
+      FillTriangleVerticesWrappedSingle(n, pTv, nVertex, pTvw, pTs);
+  }
+}
+
+}  // namespace astrix
@@ -297,7 +297,7 @@ void Delaunay::AdjustState(Connectivity * const connectivity,
                                        devAdjustState<realNeq, CL>,
                                        (size_t) 0, 0);
 
-    devAdjustState<realNeq, CL><<<nBlocks, nThreads>>>
+    LaunchKernel(nBlocks, nThreads, devAdjustState<realNeq, CL>)
       (nNonDel, pEnd, pTv, pTe, pEt, nVertex, pVc, pVarea,
        predicates, pParam, Px, Py, pState);
 
@@ -14,6 +14,7 @@ Astrix is distributed in the hope that it will be useful, but WITHOUT ANY WARRAN
 You should have received a copy of the GNU General Public License
 along with Astrix.  If not, see <http://www.gnu.org/licenses/>.*/
 #include <iostream>
+#include <algorithm>
 
 #include "../../Common/definitions.h"
 #include "../../Array/array.h"
@@ -27,17 +28,90 @@ along with Astrix.  If not, see <http://www.gnu.org/licenses/>.*/
 
 namespace astrix {
 
+//#########################################################################
+/*! \brief Find points for checking edge \a i for Delaunay-hood
+
+Edge \a i is Delaunay if point d, the vertex of the first neighbouring triangle opposite \a i, does not lie in the circumcircle of the second neighbouring triangle (a, b, c). Returns 0 for edges on a segment, which need no checking, and 1 otherwise.
+
+\param i Index of edge to check
+\param *pVc Pointer to vertex coordinates
+\param *pTv Pointer to triangle vertices
+\param *pTe Pointer to triangle edges
+\param *pEt Pointer to edge triangles
+\param nVertex Total number of vertices in Mesh
+\param Px Periodic domain size x
+\param Py Periodic domain size y
+\param ax x coordinate of point a (output)
+\param ay y coordinate of point a (output)
+\param bx x coordinate of point b (output)
+\param by y coordinate of point b (output)
+\param cx x coordinate of point c (output)
+\param cy y coordinate of point c (output)
+\param dx x coordinate of point d (output)
+\param dy y coordinate of point d (output)*/
+//#########################################################################
+
+__host__ __device__
+int EdgeIncirclePoints(int i,
+                       real2 *pVc,
+                       const int3* __restrict__ pTv,
+                       const int3* __restrict__ pTe,
+                       int2 *pEt,
+                       int nVertex, real Px, real Py,
+                       real& ax, real& ay, real& bx, real& by,
+                       real& cx, real& cy, real& dx, real& dy)
+{
+  int t1 = pEt[i].x;
+  int t2 = pEt[i].y;
+
+  if (t1 == -1 || t2 == -1) return 0;
+
+  int a = pTv[t1].x;
+  int b = pTv[t1].y;
+  int c = pTv[t1].z;
+
+  int e1 = pTe[t1].x;
+  int e2 = pTe[t1].y;
+  int e3 = pTe[t1].z;
+
+  int f =   (i == e1)*b +  (i == e2)*c +  (i == e3)*a;
+
+  int d = (i == e1)*c + (i == e2)*a + (i == e3)*b;
+  GetTriangleCoordinatesSingle(pVc, d, nVertex, Px, Py, dx, dy);
+
+  a = pTv[t2].x;
+  b = pTv[t2].y;
+  c = pTv[t2].z;
+
+  GetTriangleCoordinates(pVc, a, b, c,
+                         nVertex, Px, Py,
+                         ax, bx, cx, ay, by, cy);
+
+  // Going to test if d lies in circle of t2
+  e1 = pTe[t2].x;
+  e2 = pTe[t2].y;
+  e3 = pTe[t2].z;
+
+  b = (i == e1)*a + (i == e2)*b + (i == e3)*c;
+
+  // Edge is between (e, c) and (f, b)
+
+  // PERIODIC
+  TranslateVertexToVertex(b, f, Px, Py, nVertex, dx, dy);
+
+  return 1;
+}
+
 //#########################################################################
 /*! \brief Check edge \a i for Delaunay-hood
 
-Check edge \a i and write result in \a eNonDel (1 if not Delaunay, 0 otherwise)
+Check edge \a i; return \a i if not Delaunay, -1 otherwise
 
 \param i Index of edge to check
 \param *pVc Pointer to vertex coordinates
 \param *pTv Pointer to triangle vertices
 \param *pTe Pointer to triangle edges
 \param *pEt Pointer to edge triangles
-\param *pEnd Pointer to list of edges that are not Delaunay (output)
 \param *pred Pointer to initialised Predicates object
 \param *pParam Pointer to initialised Predicates parameter vector
 \param nVertex Total number of vertices in Mesh
@@ -57,52 +131,81 @@ int CheckEdge(int i,
   // Assume edge is Delaunay
   int ret = -1;
 
-  int t1 = pEt[i].x;
-  int t2 = pEt[i].y;
-
-  if (t1 != -1 && t2 != -1) {
-    int a = pTv[t1].x;
-    int b = pTv[t1].y;
-    int c = pTv[t1].z;
-
-    int e1 = pTe[t1].x;
-    int e2 = pTe[t1].y;
-    int e3 = pTe[t1].z;
-
-    int f =   (i == e1)*b +  (i == e2)*c +  (i == e3)*a;
-
-    int d = (i == e1)*c + (i == e2)*a + (i == e3)*b;
-    real dx, dy;
-    GetTriangleCoordinatesSingle(pVc, d, nVertex, Px, Py, dx, dy);
+  real ax, ay, bx, by, cx, cy, dx, dy;
+  if (EdgeIncirclePoints(i, pVc, pTv, pTe, pEt, nVertex, Px, Py,
+                         ax, ay, bx, by, cx, cy, dx, dy) == 1) {
+    real detNew = pred->incircle(ax, ay, bx, by, cx, cy, dx, dy, pParam);
 
-    a = pTv[t2].x;
-    b = pTv[t2].y;
-    c = pTv[t2].z;
+    // Edge is not Delaunay
+    if (detNew > (real) 0.0) ret = i;
+  }
 
-    real ax, bx, cx, ay, by, cy;
-    GetTriangleCoordinates(pVc, a, b, c,
-                           nVertex, Px, Py,
-                           ax, bx, cx, ay, by, cy);
+  return ret;
+}
 
-    // Going to test if d lies in circle of t2
-    e1 = pTe[t2].x;
-    e2 = pTe[t2].y;
-    e3 = pTe[t2].z;
+//#########################################################################
+/*! \brief Check edges for Delaunay-hood on host in batches
 
-    b = (i == e1)*a + (i == e2)*b + (i == e3)*c;
+Check edges \a pEnC[j] (or edges j if \a pEnC == 0) for 0 <= j < \a nCheck and write result in \a pEnd[j] (edge index if not Delaunay, -1 otherwise). Points are gathered for a batch of edges first, so that the floating-point filter of the incircle test can be evaluated for the whole batch at once.
 
-    // Edge is between (e, c) and (f, b)
+\param nCheck Number of edges to check
+\param *pEnC Pointer to list of edges to check, or 0 to check all edges
+\param *pVc Pointer to vertex coordinates
+\param *pTv Pointer to triangle vertices
+\param *pTe Pointer to triangle edges
+\param *pEt Pointer to edge triangles
+\param *pEnd Pointer to list of edges that are not Delaunay (output)
+\param *pred Pointer to initialised Predicates object
+\param nVertex Total number of vertices in Mesh
+\param Px Periodic domain size x
+\param Py Periodic domain size y*/
+//#########################################################################
 
-    // PERIODIC
-    TranslateVertexToVertex(b, f, Px, Py, nVertex, dx, dy);
+void CheckEdgeBatch(int nCheck, const int *pEnC,
+                    real2 *pVc,
+                    const int3* __restrict__ pTv,
+                    const int3* __restrict__ pTe,
+                    int2 *pEt,
+                    int *pEnd, const Predicates *pred,
+                    int nVertex, real Px, real Py)
+{
+  IncircleBatch batch;
+  // Index j of every test in batch
+  int index[IncircleBatch::size];
+
+  for (int start = 0; start < nCheck; start += IncircleBatch::size) {
+    int end = std::min(start + IncircleBatch::size, nCheck);
+
+    // Gather points
+    int n = 0;
+    for (int j = start; j < end; j++) {
+      int i = j;
+      if (pEnC != 0) i = pEnC[j];
+
+      // Assume edge is Delaunay
+      pEnd[j] = -1;
+
+      if (EdgeIncirclePoints(i, pVc, pTv, pTe, pEt, nVertex, Px, Py,
+                             batch.ax[n], batch.ay[n],
+                             batch.bx[n], batch.by[n],
+                             batch.cx[n], batch.cy[n],
+                             batch.dx[n], batch.dy[n]) == 1) {
+        index[n] = j;
+        n++;
+      }
+    }
 
-    real detNew = pred->incircle(ax, ay, bx, by, cx, cy, dx, dy, pParam);
+    pred->incircle(&batch, n, PREDICATE_CHECKEDGE);
 
-    // Edge is not Delaunay
-    if (detNew > (real) 0.0) ret = i;
+    // Edges that are not Delaunay
+    for (int k = 0; k < n; k++) {
+      if (batch.det[k] > (real) 0.0) {
+        int j = index[k];
+        pEnd[j] = j;
+        if (pEnC != 0) pEnd[j] = pEnC[j];
+      }
+    }
   }
-
-  return ret;
 }
 
 //######################################################################
@@ -239,7 +342,7 @@ void Delaunay::CheckEdges(Connectivity * const connectivity,
       gpuErrchk( cudaEventRecord(start, 0) );
 #endif
 
-      devCheckEdge<<<nBlocks, nThreads>>>
+      LaunchKernel(nBlocks, nThreads, devCheckEdge)
         (nEdge, pVc, pTv, pTe, pEt, pEnd, predicates, pParam, nVertex, Px, Py);
 
 #ifdef TIME_ASTRIX
@@ -254,10 +357,8 @@ void Delaunay::CheckEdges(Connectivity * const connectivity,
       gpuErrchk( cudaEventRecord(start, 0) );
 #endif
 
-      for (int i = 0; i < nEdge; i++)
-        pEnd[i] =
-          CheckEdge(i, pVc, pTv, pTe, pEt, predicates,
-                    pParam, nVertex, Px, Py);
+      CheckEdgeBatch(nEdge, 0, pVc, pTv, pTe, pEt, pEnd, predicates,
+                     nVertex, Px, Py);
 
       // Make structured mesh less uniform
       if (meshParameter->structuredFlag == 2) {
@@ -300,7 +401,7 @@ void Delaunay::CheckEdges(Connectivity * const connectivity,
       gpuErrchk( cudaEventRecord(start, 0) );
 #endif
 
-      devCheckEdgeLimit<<<nBlocks, nThreads>>>
+      LaunchKernel(nBlocks, nThreads, devCheckEdgeLimit)
         (nEdgeCheck, pEnC, pVc, pTv, pTe, pEt, pEnd,
          predicates, pParam, nVertex, Px, Py);
 
@@ -316,10 +417,8 @@ void Delaunay::CheckEdges(Connectivity * const connectivity,
       gpuErrchk( cudaEventRecord(start, 0) );
 #endif
 
-      for (int i = 0; i < nEdgeCheck; i++)
-        pEnd[i] =
-          CheckEdge(pEnC[i], pVc, pTv, pTe, pEt, predicates,
-                    pParam, nVertex, Px, Py);
+      CheckEdgeBatch(nEdgeCheck, pEnC, pVc, pTv, pTe, pEt, pEnd, predicates,
+                     nVertex, Px, Py);
 
 #ifdef TIME_ASTRIX
       gpuErrchk( cudaEventRecord(stop, 0) );
@@ -330,8 +429,40 @@ void Delaunay::CheckEdges(Connectivity * const connectivity,
 
 #ifdef TIME_ASTRIX
   gpuErrchk( cudaEventElapsedTime(&elapsedTime, start, stop) );
-  WriteProfileFile("CheckEdge.prof", nEdgeCheck, elapsedTime, cudaFlag);
+  AddProfile("CheckEdge", nEdgeCheck, elapsedTime, cudaFlag);
 #endif
 }
 
+//#########################################################################
+/*! Check that all edges of the Mesh are Delaunay. Used in debug mode to verify that repairing only the edges touched by insertion, removal and flipping has left the whole Mesh Delaunay. Throws an exception if any edge is not Delaunay.
+
+\param *connectivity Pointer to basic Mesh data
+\param *predicates Pointer to Predicates object
+\param *meshParameter Pointer to Mesh parameters*/
+//#########################################################################
+
+void Delaunay::CheckDelaunay(Connectivity * const connectivity,
+                             const Predicates *predicates,
+                             const MeshParameter *meshParameter)
+{
+  int nEdge = connectivity->edgeTriangles->GetSize();
+
+  // Check all edges through an explicit list, so that structured meshes are
+  // not perturbed as in a full check
+  Array<int> *edgeAll = new Array<int>(1, cudaFlag, nEdge);
+  edgeAll->SetToSeries();
+
+  edgeNonDelaunay->SetSize(nEdge);
+  CheckEdges(connectivity, predicates, meshParameter, edgeAll, nEdge);
+
+  delete edgeAll;
+
+  int nNonDel = edgeNonDelaunay->RemoveValue(-1);
+  if (nNonDel > 0) {
+    std::cout << "Error: " << nNonDel << " edges not Delaunay after repair"
+              << std::endl;
+    throw std::runtime_error("");
+  }
+}
+
 }  // namespace astrix
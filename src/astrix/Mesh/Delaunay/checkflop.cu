@@ -216,7 +216,7 @@ void Delaunay::CheckEdgesFlop(Connectivity * const connectivity,
       gpuErrchk( cudaEventRecord(start, 0) );
 #endif
 
-      devCheckEdgeFlop<<<nBlocks, nThreads>>>
+      LaunchKernel(nBlocks, nThreads, devCheckEdgeFlop)
         (nEdge, pVc, pTv, pTe, pEt, pEnd, predicates, pParam, nVertex, Px, Py);
 
 #ifdef TIME_ASTRIX
@@ -257,7 +257,7 @@ void Delaunay::CheckEdgesFlop(Connectivity * const connectivity,
       gpuErrchk( cudaEventRecord(start, 0) );
 #endif
 
-      devCheckEdgeFlopLimit<<<nBlocks, nThreads>>>
+      LaunchKernel(nBlocks, nThreads, devCheckEdgeFlopLimit)
         (nEdgeCheck, pEnC, pVc, pTv, pTe, pEt, pEnd,
          predicates, pParam, nVertex, Px, Py);
 
@@ -286,7 +286,7 @@ void Delaunay::CheckEdgesFlop(Connectivity * const connectivity,
 
 #ifdef TIME_ASTRIX
   gpuErrchk( cudaEventElapsedTime(&elapsedTime, start, stop) );
-  WriteProfileFile("CheckFlop.prof", nEdgeCheck, elapsedTime, cudaFlag);
+  AddProfile("CheckFlop", nEdgeCheck, elapsedTime, cudaFlag);
 #endif
 }
 
@@ -14,7 +14,7 @@ Astrix is distributed in the hope that it will be useful, but WITHOUT ANY WARRAN
 You should have received a copy of the GNU General Public License
 along with Astrix.  If not, see <http://www.gnu.org/licenses/>.*/
 
-#include <cuda_runtime_api.h>
+#include "../../Common/cudaRuntime.h"
 #include <iostream>
 
 #include "../../Common/definitions.h"
@@ -41,6 +41,7 @@ Delaunay::Delaunay(int _cudaFlag, int _debugLevel)
 
   triangleAffected = new Array<int>(1, cudaFlag, 0, 128*8192);
   triangleAffectedEdge = new Array<int>(1, cudaFlag, 0, 128*8192);
+  edgeFrontier = new Array<int>(1, cudaFlag, 0, 128*8192);
 }
 
 //#########################################################################
@@ -54,6 +55,7 @@ Delaunay::~Delaunay()
 
   delete triangleAffected;
   delete triangleAffectedEdge;
+  delete edgeFrontier;
 }
 
 }  // namespace astrix
@@ -44,6 +44,11 @@ class Delaunay
                       const int nEdgeCheck,
                       const int flopFlag);
 
+  //! Throw exception if any edge is not Delaunay
+  void CheckDelaunay(Connectivity * const connectivity,
+                     const Predicates *predicates,
+                     const MeshParameter *meshParameter);
+
  private:
   //! Flag whether to use device or host
   int cudaFlag;
@@ -60,6 +65,8 @@ class Delaunay
   Array <int> *triangleAffected;
   //! Indices in edgeNonDelaunay for affected triangles
   Array <int> *triangleAffectedEdge;
+  //! Edges that need checking in the next cycle
+  Array <int> *edgeFrontier;
 
   //! Check if any edges are not Delaunay
   void CheckEdges(Connectivity * const connectivity,
@@ -82,6 +89,9 @@ class Delaunay
   //! Fill triangle substitute Array for repairing edges
   void FillTriangleSubstitute(Connectivity * const connectivity,
                               const int nNonDel);
+  //! Find edges that need checking after flipping
+  int FlagFrontier(Connectivity * const connectivity,
+                   const int nFlip);
   //! Repair damaged edges after flipping
   void EdgeRepair(Connectivity * const connectivity,
                   Array<int> * const edgeNeedsChecking,
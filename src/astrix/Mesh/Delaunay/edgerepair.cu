@@ -167,7 +167,7 @@ void Delaunay::EdgeRepair(Connectivity * const connectivity,
 #ifdef TIME_ASTRIX
       gpuErrchk( cudaEventRecord(start, 0) );
 #endif
-      devEdgeRepair<<<nBlocks, nThreads>>>
+      LaunchKernel(nBlocks, nThreads, devEdgeRepair)
         (nEdge, pTsub, pTe, pEt);
 #ifdef TIME_ASTRIX
       gpuErrchk( cudaEventRecord(stop, 0) );
@@ -189,7 +189,7 @@ void Delaunay::EdgeRepair(Connectivity * const connectivity,
 
 #ifdef TIME_ASTRIX
   gpuErrchk( cudaEventElapsedTime(&elapsedTime, start, stop) );
-  WriteProfileFile("EdgeRepair.prof", nEdge, elapsedTime, cudaFlag);
+  AddProfile("EdgeRepair", nEdge, elapsedTime, cudaFlag);
 #endif
   } else {
     int *pEnC = edgeNeedsChecking->GetPointer();
@@ -206,7 +206,7 @@ void Delaunay::EdgeRepair(Connectivity * const connectivity,
 #ifdef TIME_ASTRIX
       gpuErrchk( cudaEventRecord(start, 0) );
 #endif
-      devEdgeRepairLimit<<<nBlocks, nThreads>>>
+      LaunchKernel(nBlocks, nThreads, devEdgeRepairLimit)
         (nEdgeCheck, pEnC, pTsub, pTe, pEt);
 #ifdef TIME_ASTRIX
       gpuErrchk( cudaEventRecord(stop, 0) );
@@ -228,7 +228,7 @@ void Delaunay::EdgeRepair(Connectivity * const connectivity,
 
 #ifdef TIME_ASTRIX
     gpuErrchk( cudaEventElapsedTime(&elapsedTime, start, stop) );
-    WriteProfileFile("EdgeRepair.prof", nEdgeCheck, elapsedTime, cudaFlag);
+    AddProfile("EdgeRepair", nEdgeCheck, elapsedTime, cudaFlag);
 #endif
   }
 }
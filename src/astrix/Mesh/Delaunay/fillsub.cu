@@ -114,7 +114,7 @@ void Delaunay::FillTriangleSubstitute(Connectivity * const connectivity,
 #ifdef TIME_ASTRIX
     gpuErrchk( cudaEventRecord(start, 0) );
 #endif
-    devFillTriangleSubstitute<<<nBlocks, nThreads>>>
+    LaunchKernel(nBlocks, nThreads, devFillTriangleSubstitute)
       (nNonDel, pEnd, pTsub, pEt);
 #ifdef TIME_ASTRIX
     gpuErrchk( cudaEventRecord(stop, 0) );
@@ -136,7 +136,7 @@ void Delaunay::FillTriangleSubstitute(Connectivity * const connectivity,
 
 #ifdef TIME_ASTRIX
   gpuErrchk( cudaEventElapsedTime(&elapsedTime, start, stop) );
-  WriteProfileFile("FillSub.prof", nNonDel, elapsedTime, cudaFlag);
+  AddProfile("FillSub", nNonDel, elapsedTime, cudaFlag);
 #endif
 }
 
@@ -56,7 +56,7 @@ devSelectParallelFlip(int nFlip,
                       int *pTriangleTaken,
                       const int2* __restrict__ pEt)
 {
-  unsigned int i = blockIdx.x*blockDim.x + threadIdx.x;
+  int i = blockIdx.x*blockDim.x + threadIdx.x;
 
   while (i < nFlip) {
     SelectParallelFlip(i, pEdgeNonDelaunay, pTriangleTaken, pEt);
@@ -82,7 +82,7 @@ __global__ void
 devFillAffectedTriangles(int nFlip, int *pTaff, int *pTaffEdge,
                          int *pEnd, int2 *pEt)
 {
-  unsigned int i = blockIdx.x*blockDim.x + threadIdx.x;
+  int i = blockIdx.x*blockDim.x + threadIdx.x;
 
   while (i < nFlip) {
     int e = pEnd[i];
@@ -133,7 +133,7 @@ void FillAffectedTriangles(Array<int> * const triangleAffected,
                                        devFillAffectedTriangles,
                                        (size_t) 0, 0);
 
-    devFillAffectedTriangles<<<nBlocks, nThreads>>>
+    LaunchKernel(nBlocks, nThreads, devFillAffectedTriangles)
       (nFlip, pTaff, pTaffEdge, pEnd, pEt);
 
     gpuErrchk( cudaPeekAtLastError() );
@@ -191,7 +191,7 @@ int Delaunay::FindParallelFlipSet(Connectivity * const connectivity,
 #ifdef TIME_ASTRIX
   gpuErrchk( cudaEventRecord(start, 0) );
 #endif
-    devSelectParallelFlip<<<nBlocks, nThreads>>>
+    LaunchKernel(nBlocks, nThreads, devSelectParallelFlip)
       (nFlip, pEdgeNonDelaunay, pTriangleTaken, pEt);
 #ifdef TIME_ASTRIX
   gpuErrchk( cudaEventRecord(stop, 0) );
@@ -219,7 +219,7 @@ int Delaunay::FindParallelFlipSet(Connectivity * const connectivity,
 
 #ifdef TIME_ASTRIX
   gpuErrchk( cudaEventElapsedTime(&elapsedTime, start, stop) );
-  WriteProfileFile("ParallelFlip.prof", nFlip, elapsedTime, cudaFlag);
+  AddProfile("ParallelFlip", nFlip, elapsedTime, cudaFlag);
 #endif
 
 #else
@@ -215,7 +215,7 @@ void Delaunay::FlipEdge(Connectivity * const connectivity,
 #ifdef TIME_ASTRIX
     gpuErrchk( cudaEventRecord(start, 0) );
 #endif
-    devFlipEdge<<<nBlocks, nThreads>>>
+    LaunchKernel(nBlocks, nThreads, devFlipEdge)
       (nNonDel, pEnd, pTv, pTe, pEt, nVertex);
 #ifdef TIME_ASTRIX
     gpuErrchk( cudaEventRecord(stop, 0) );
@@ -237,7 +237,7 @@ void Delaunay::FlipEdge(Connectivity * const connectivity,
 
 #ifdef TIME_ASTRIX
   gpuErrchk( cudaEventElapsedTime(&elapsedTime, start, stop) );
-  WriteProfileFile("FlipEdge.prof", nNonDel, elapsedTime, cudaFlag);
+  AddProfile("FlipEdge", nNonDel, elapsedTime, cudaFlag);
 #endif
 }
 
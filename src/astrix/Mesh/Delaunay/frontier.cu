@@ -0,0 +1,115 @@
+// -*-c++-*-
+/*! \file frontier.cu
+\brief Functions for finding edges that need checking after flipping
+
+\section LICENSE
+Copyright (c) 2017 Sijme-Jan Paardekooper
+
+This file is part of Astrix.
+
+Astrix is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+
+Astrix is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Astrix.  If not, see <http://www.gnu.org/licenses/>.*/
+#include <iostream>
+
+#include "../../Common/definitions.h"
+#include "../../Array/array.h"
+#include "./delaunay.h"
+#include "../../Common/cudaLow.h"
+#include "../Connectivity/connectivity.h"
+
+namespace astrix {
+
+//#########################################################################
+/*! \brief Flag edges of the two triangles sharing flipped edge \a pEnd[i]
+
+\param i Index in \a pEnd to consider
+\param *pEnd Pointer to array containing flipped edges
+\param *pTe Pointer to triangle edges
+\param *pEt Pointer to edge triangles
+\param *pEf Pointer to frontier; pEf[e] = e if edge \a e needs checking (output)*/
+//#########################################################################
+
+__host__ __device__
+void FlagFrontierSingle(int i, const int *pEnd, const int3 *pTe,
+                        const int2 *pEt, int *pEf)
+{
+  int e = pEnd[i];
+
+  // Flipped edges are never on a segment: both triangles exist
+  int t1 = pEt[e].x;
+  int t2 = pEt[e].y;
+
+  pEf[pTe[t1].x] = pTe[t1].x;
+  pEf[pTe[t1].y] = pTe[t1].y;
+  pEf[pTe[t1].z] = pTe[t1].z;
+  pEf[pTe[t2].x] = pTe[t2].x;
+  pEf[pTe[t2].y] = pTe[t2].y;
+  pEf[pTe[t2].z] = pTe[t2].z;
+}
+
+//#########################################################################
+/*! \brief Kernel flagging edges of the two triangles sharing flipped edges
+
+\param nFlip Number of flipped edges
+\param *pEnd Pointer to array containing flipped edges
+\param *pTe Pointer to triangle edges
+\param *pEt Pointer to edge triangles
+\param *pEf Pointer to frontier; pEf[e] = e if edge \a e needs checking (output)*/
+//#########################################################################
+
+__global__ void
+devFlagFrontier(int nFlip, const int *pEnd, const int3 *pTe,
+                const int2 *pEt, int *pEf)
+{
+  int i = blockIdx.x*blockDim.x + threadIdx.x;
+
+  while (i < nFlip) {
+    FlagFrontierSingle(i, pEnd, pTe, pEt, pEf);
+
+    i += gridDim.x*blockDim.x;
+  }
+}
+
+//#########################################################################
+/*! After flipping the first \a nFlip entries of \a edgeNonDelaunay, only the edges of the quadrilaterals containing the flipped edges can have lost the Delaunay property. Add these to \a edgeFrontier, which on entry contains the edges that were found not to be Delaunay in this cycle, and compact \a edgeFrontier into a sorted list of edges to check in the next cycle. The same list contains all edges that may need repairing. Returns the number of edges in the list.
+
+\param *connectivity Pointer to basic Mesh data
+\param nFlip Number of edges flipped*/
+//#########################################################################
+
+int Delaunay::FlagFrontier(Connectivity * const connectivity,
+                           const int nFlip)
+{
+  int *pEnd = edgeNonDelaunay->GetPointer();
+  int *pEf = edgeFrontier->GetPointer();
+
+  const int3 *pTe = connectivity->triangleEdges->GetPointer();
+  const int2 *pEt = connectivity->edgeTriangles->GetPointer();
+
+  if (cudaFlag == 1) {
+    int nBlocks = 128;
+    int nThreads = 128;
+
+    // Base nThreads and nBlocks on maximum occupancy
+    cudaOccupancyMaxPotentialBlockSize(&nBlocks, &nThreads,
+                                       devFlagFrontier,
+                                       (size_t) 0, 0);
+
+    LaunchKernel(nBlocks, nThreads, devFlagFrontier)
+      (nFlip, pEnd, pTe, pEt, pEf);
+    gpuErrchk( cudaPeekAtLastError() );
+    gpuErrchk( cudaDeviceSynchronize() );
+  } else {
+    for (int i = 0; i < nFlip; i++)
+      FlagFrontierSingle(i, pEnd, pTe, pEt, pEf);
+  }
+
+  // Keep only flagged edges (note: size of Array not changed!)
+  return edgeFrontier->RemoveValue(-1);
+}
+
+}  // namespace astrix
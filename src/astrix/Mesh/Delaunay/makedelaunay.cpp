@@ -13,7 +13,7 @@ Astrix is distributed in the hope that it will be useful, but WITHOUT ANY WARRAN
 
 You should have received a copy of the GNU General Public License
 along with Astrix.  If not, see <http://www.gnu.org/licenses/>.*/
-#include <cuda_runtime_api.h>
+#include "../../Common/cudaRuntime.h"
 #include <iostream>
 
 #include "../../Common/definitions.h"
@@ -26,13 +26,16 @@ along with Astrix.  If not, see <http://www.gnu.org/licenses/>.*/
 namespace astrix {
 
 //#########################################################################
-/*! Transform triangulated Mesh into Delaunay Mesh. This is achieved by flipping edges that do not have the Delaunay property. First, we make a list of edges that are not Delaunay, then we select those that can be flipped in parallel, we adjust the state vector in order to conserve mass, momentum and energy, and finally we flip the edges. A repair step ensures all edges have the correct neighbouring triangles. This is repeated until all edges are Delaunay.
+/*! Transform triangulated Mesh into Delaunay Mesh. This is achieved by flipping edges that do not have the Delaunay property. First, we make a list of edges that are not Delaunay, then we select those that can be flipped in parallel, we adjust the state vector in order to conserve mass, momentum and energy, and finally we flip the edges. A repair step ensures all edges have the correct neighbouring triangles. This is repeated until all edges are Delaunay. Only the first cycle checks the edges listed in \a edgeNeedsChecking (or all edges if \a edgeNeedsChecking == 0); subsequent cycles only check the edges that were not Delaunay in the previous cycle together with the edges of the quadrilaterals in which edges were flipped, since all other edges are unaffected by flipping.
 
 \param *connectivity Pointer to basic Mesh data
 \param *vertexState Pointer to state vector
 \param *predicates Pointer to Predicates object, used to check Delaunay property without roundoff error
 \param *meshParameter Pointer to Mesh parameters
-\param maxCycle Maximum number of cycles. If <= 0, cycle until all edges are Delaunay*/
+\param maxCycle Maximum number of cycles. If <= 0, cycle until all edges are Delaunay
+\param *edgeNeedsChecking List of edges to check in the first cycle. If 0, all edges are checked
+\param nEdgeCheck Number of edges in \a edgeNeedsChecking
+\param flopFlag If 1, do a single cycle of flopping instead*/
 //#########################################################################
 
 template<class realNeq, ConservationLaw CL>
@@ -52,27 +55,31 @@ void Delaunay::MakeDelaunay(Connectivity * const connectivity,
 
   triangleSubstitute->SetSize(nTriangle);
 
-  if (edgeNeedsChecking == 0)
-    edgeNonDelaunay->SetSize(nEdge);
-  else
-    edgeNonDelaunay->SetSize(nEdgeCheck);
-
   triangleAffected->SetSize(2*nEdge);
   triangleAffectedEdge->SetSize(2*nEdge);
 
+  // Edges to check in current cycle
+  Array<int> *edgeCheck = edgeNeedsChecking;
+  int nCheck = nEdgeCheck;
+
   int finished = 0;
   int nCycle = 0;
   while (!finished) {
+    if (edgeCheck == 0)
+      edgeNonDelaunay->SetSize(nEdge);
+    else
+      edgeNonDelaunay->SetSize(nCheck);
+
     nvtxEvent *nvtxTemp = new nvtxEvent("CheckEdge", 1);
 
     if (flopFlag != 1) {
-      // Check all edges for Delaunay property
+      // Check edges for Delaunay property
       CheckEdges(connectivity, predicates, meshParameter,
-                 edgeNeedsChecking, nEdgeCheck);
+                 edgeCheck, nCheck);
     } else {
-      // Check all edges if can be flopped
+      // Check edges if can be flopped
       CheckEdgesFlop(connectivity, predicates, meshParameter,
-                     edgeNeedsChecking, nEdgeCheck);
+                     edgeCheck, nCheck);
       finished = 1;
     }
 
@@ -88,6 +95,11 @@ void Delaunay::MakeDelaunay(Connectivity * const connectivity,
       // No more edges to flip: done
       finished = 1;
     } else {
+      // Edges that are not Delaunay need checking again unless flipped
+      edgeFrontier->SetSize(nEdge);
+      edgeFrontier->SetToValue(-1);
+      edgeFrontier->Scatter(edgeNonDelaunay, edgeNonDelaunay, nNonDel);
+
       nvtxTemp = new nvtxEvent("Parallel", 3);
 
       // Find edges that can be flipped in parallel
@@ -113,8 +125,12 @@ void Delaunay::MakeDelaunay(Connectivity * const connectivity,
       delete nvtxTemp;
       nvtxTemp = new nvtxEvent("Repair", 6);
 
+      // Only edges of flipped quadrilaterals can need repair or checking
+      edgeCheck = edgeFrontier;
+      nCheck = FlagFrontier(connectivity, nNonDel);
+
       // Repair
-      EdgeRepair(connectivity, edgeNeedsChecking, nEdgeCheck);
+      EdgeRepair(connectivity, edgeCheck, nCheck);
 
       delete nvtxTemp;
     }
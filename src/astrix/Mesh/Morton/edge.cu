@@ -104,11 +104,12 @@ void Morton::OrderEdge(Connectivity * const connectivity)
                                        devFillMortonEdge,
                                        (size_t) 0, 0);
 
-    devFillMortonEdge<<<nBlocks, nThreads>>>
+    LaunchKernel(nBlocks, nThreads, devFillMortonEdge)
       (nEdge, pEt, pTv, pVmort, pMortValues, nVertex);
     gpuErrchk(cudaPeekAtLastError());
     gpuErrchk(cudaDeviceSynchronize());
   } else {
+#pragma omp parallel for
     for (int i = 0; i < nEdge; i++)
       FillMortonEdgeSingle(i, pEt, pTv, pVmort, pMortValues, nVertex);
   }
@@ -14,7 +14,7 @@ Astrix is distributed in the hope that it will be useful, but WITHOUT ANY WARRAN
 You should have received a copy of the GNU General Public License
 along with Astrix.  If not, see <http://www.gnu.org/licenses/>.*/
 
-#include <cuda_runtime_api.h>
+#include "../../Common/cudaRuntime.h"
 #include <iostream>
 
 #include "../../Common/definitions.h"
@@ -32,6 +32,7 @@ namespace astrix {
 Morton::Morton(int _cudaFlag)
 {
   cudaFlag = _cudaFlag;
+  nOrder = 0;
 
   mortValues = new Array<unsigned int>(1, cudaFlag);
   index = new Array<unsigned int>(1, cudaFlag);
@@ -51,4 +52,13 @@ Morton::~Morton()
   delete vertexMorton;
 }
 
+//#########################################################################
+/*! Return number of times Order() has been called. Vertex, triangle and edge indices are only stable between calls if this number does not change.*/
+//#########################################################################
+
+int Morton::GetNOrder() const
+{
+  return nOrder;
+}
+
 }  // namespace astrix
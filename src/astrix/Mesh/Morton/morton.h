@@ -38,9 +38,14 @@ class Morton
                Array<int> * const triangleWantRefine,
                Array<realNeq> * const vertexState);
 
+  //! Return number of times Order() has been called
+  int GetNOrder() const;
+
  private:
   //! Flag whether to use device or host
   int cudaFlag;
+  //! Number of times Order() has been called
+  int nOrder;
 
   //! Minimum vertex x coordinate
   real minx;
@@ -13,7 +13,7 @@ Astrix is distributed in the hope that it will be useful, but WITHOUT ANY WARRAN
 
 You should have received a copy of the GNU General Public License
 along with Astrix.  If not, see <http://www.gnu.org/licenses/>.*/
-#include <cuda_runtime_api.h>
+#include "../../Common/cudaRuntime.h"
 #include <iostream>
 
 #include "../../Common/definitions.h"
@@ -40,6 +40,8 @@ void Morton::Order(Connectivity * const connectivity,
   nvtxEvent *nvtxMorton = new nvtxEvent("Morton", 5);
   nvtxEvent *temp = new nvtxEvent("Minmax", 1);
 
+  nOrder++;
+
   int nVertex = connectivity->vertexCoordinates->GetSize();
   int nEdge = connectivity->edgeTriangles->GetSize();
 
@@ -117,11 +117,12 @@ void Morton::OrderTriangle(Connectivity * const connectivity,
                                        devFillMortonTriangle,
                                        (size_t) 0, 0);
 
-    devFillMortonTriangle<<<nBlocks, nThreads>>>
+    LaunchKernel(nBlocks, nThreads, devFillMortonTriangle)
       (nTriangle, pTv, pVmort, pMortValues, nVertex);
     gpuErrchk(cudaPeekAtLastError());
     gpuErrchk(cudaDeviceSynchronize());
   } else {
+#pragma omp parallel for
     for (int i = 0; i < nTriangle; i++)
       FillMortonTriangleSingle(i, pTv, pVmort, pMortValues, nVertex);
   }
@@ -90,12 +90,13 @@ void Morton::CalcValues(Connectivity * const connectivity)
                                        devCalcMortonValuesVertex,
                                        (size_t) 0, 0);
 
-    devCalcMortonValuesVertex<<<nBlocks, nThreads>>>
+    LaunchKernel(nBlocks, nThreads, devCalcMortonValuesVertex)
       (nVertex, pVmort, pVc, minx, maxx, miny, maxy);
 
     gpuErrchk( cudaPeekAtLastError() );
     gpuErrchk( cudaDeviceSynchronize() );
   } else {
+#pragma omp parallel for
     for (int i = 0; i < nVertex; i++) {
       unsigned short x = 65533*(pVc[i].x - minx)/(maxx - minx) + 1;
       unsigned short y = 65533*(pVc[i].y - miny)/(maxy - miny) + 1;
@@ -13,7 +13,7 @@ Astrix is distributed in the hope that it will be useful, but WITHOUT ANY WARRAN
 You should have received a copy of the GNU General Public License
 along with Astrix.  If not, see <http://www.gnu.org/licenses/>.*/
 
-#include <cuda_runtime_api.h>
+#include "../../Common/cudaRuntime.h"
 #include <iostream>
 #include <stdexcept>
 #include <cmath>
@@ -90,6 +90,18 @@ void MeshParameter::CheckValidity()
     std::cout << "Need minError < maxError!" << std::endl;
     throw std::runtime_error("");
   }
+  if (nBufferLayer < 0) {
+    std::cout << "Invalid value for nBufferLayer" << std::endl;
+    throw std::runtime_error("");
+  }
+  if (nRefineLevel < 0) {
+    std::cout << "Invalid value for nRefineLevel" << std::endl;
+    throw std::runtime_error("");
+  }
+  if (nStepAdapt < 0) {
+    std::cout << "Invalid value for nStepAdapt" << std::endl;
+    throw std::runtime_error("");
+  }
   if (qualityBound < 1.0 ||
       std::isinf(qualityBound) ||
       std::isnan(qualityBound)) {
@@ -60,6 +60,12 @@ class MeshParameter
   real minError;
   //! If discretization error larger than maxError, refine Mesh
   real maxError;
+  //! Number of layers of triangles around refined regions that are never coarsened
+  int nBufferLayer;
+  //! Number of adaptation steps with error below minError before a refined triangle can be coarsened
+  int nRefineLevel;
+  //! Adapt mesh every nStepAdapt time steps during the run (0: only initial mesh)
+  int nStepAdapt;
 
   //! Triangle size for initial Mesh (derived from \a equivalentPointsX)
   real baseResolution;
@@ -13,7 +13,7 @@ Astrix is distributed in the hope that it will be useful, but WITHOUT ANY WARRAN
 You should have received a copy of the GNU General Public License
 along with Astrix.  If not, see <http://www.gnu.org/licenses/>.*/
 
-#include <cuda_runtime_api.h>
+#include "../../Common/cudaRuntime.h"
 #include <iostream>
 #include <fstream>
 #include <sstream>
@@ -138,6 +138,21 @@ void MeshParameter::ReadFromFile(const char *fileName)
           secondWord.find_first_not_of("0123456789.-e") == std::string::npos)
         qualityBound = atof(secondWord.c_str());
     }
+    if (firstWord == "nBufferLayer") {
+      if (!secondWord.empty() &&
+          secondWord.find_first_not_of("0123456789") == std::string::npos)
+        nBufferLayer = atof(secondWord.c_str());
+    }
+    if (firstWord == "nRefineLevel") {
+      if (!secondWord.empty() &&
+          secondWord.find_first_not_of("0123456789") == std::string::npos)
+        nRefineLevel = atof(secondWord.c_str());
+    }
+    if (firstWord == "nStepAdapt") {
+      if (!secondWord.empty() &&
+          secondWord.find_first_not_of("0123456789") == std::string::npos)
+        nStepAdapt = atof(secondWord.c_str());
+    }
     if (firstWord == "structuredFlag") {
       if (!secondWord.empty() &&
           secondWord.find_first_not_of("012") == std::string::npos)
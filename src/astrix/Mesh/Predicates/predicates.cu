@@ -17,6 +17,8 @@ along with Astrix.  If not, see <http://www.gnu.org/licenses/>.*/
 #include <cmath>
 
 #include "../../Common/definitions.h"
+#include <iomanip>
+
 #include "../../Array/array.h"
 #include "./predicates.h"
 #include "../../Device/device.h"
@@ -119,7 +121,13 @@ Predicates::Predicates(Device *device)
   if (device->GetDeviceCount() > 0) {
     param->CopyToDevice();
     real *pParamDevice = param->GetDevicePointer();
-    devInitPredicates<<<1, 1>>>(pParamDevice);
+    LaunchKernel(1, 1, devInitPredicates)
+      (pParamDevice);
+  }
+
+  for (int i = 0; i < PREDICATE_N_CALLER; i++) {
+    nBatchTest[i] = 0;
+    nBatchExact[i] = 0;
   }
 }
 
@@ -132,4 +140,95 @@ Predicates::~Predicates()
   delete param;
 }
 
+//#########################################################################
+/*! Test for the first \a n entries of \a batch whether point d lies in the circle through a, b and c. First, the determinant and its error bound are evaluated in floating point for the whole batch, which vectorises. Only tests for which the sign of the determinant is not certain are redone with adaptive exact arithmetic. Gives the same signs as calling incircle() for every test separately. Host only.
+
+\param *batch Pointer to batch of tests; results are written in batch->det
+\param n Number of tests in batch
+\param caller Caller, for statistics*/
+//#########################################################################
+
+void Predicates::incircle(IncircleBatch *batch, int n,
+                          PredicateCaller caller) const
+{
+  const real *pParam = param->GetHostPointer();
+  real errboundA = pParam[9];
+
+  real *ax = batch->ax, *ay = batch->ay;
+  real *bx = batch->bx, *by = batch->by;
+  real *cx = batch->cx, *cy = batch->cy;
+  real *dx = batch->dx, *dy = batch->dy;
+  real *det = batch->det;
+  real *permanent = batch->permanent;
+
+  // Floating-point filter
+  int nExact = 0;
+#pragma omp simd reduction(+:nExact)
+  for (int i = 0; i < n; i++) {
+    real adx = ax[i] - dx[i];
+    real bdx = bx[i] - dx[i];
+    real cdx = cx[i] - dx[i];
+    real ady = ay[i] - dy[i];
+    real bdy = by[i] - dy[i];
+    real cdy = cy[i] - dy[i];
+
+    real bdxcdy = bdx * cdy;
+    real cdxbdy = cdx * bdy;
+    real alift = adx * adx + ady * ady;
+
+    real cdxady = cdx * ady;
+    real adxcdy = adx * cdy;
+    real blift = bdx * bdx + bdy * bdy;
+
+    real adxbdy = adx * bdy;
+    real bdxady = bdx * ady;
+    real clift = cdx * cdx + cdy * cdy;
+
+    det[i] = alift * (bdxcdy - cdxbdy)
+           + blift * (cdxady - adxcdy)
+           + clift * (adxbdy - bdxady);
+
+    permanent[i] = (Absolute(bdxcdy) + Absolute(cdxbdy)) * alift
+                 + (Absolute(cdxady) + Absolute(adxcdy)) * blift
+                 + (Absolute(adxbdy) + Absolute(bdxady)) * clift;
+
+    real errbound = errboundA * permanent[i];
+    nExact += (det[i] <= errbound && -det[i] <= errbound);
+  }
+
+  // Ambiguous cases: adaptive exact arithmetic
+  if (nExact > 0) {
+    for (int i = 0; i < n; i++) {
+      real errbound = errboundA * permanent[i];
+      if (det[i] <= errbound && -det[i] <= errbound)
+        det[i] = incircleadapt(ax[i], ay[i], bx[i], by[i],
+                               cx[i], cy[i], dx[i], dy[i],
+                               permanent[i], pParam);
+    }
+  }
+
+  nBatchTest[caller] += n;
+  nBatchExact[caller] += nExact;
+}
+
+//#########################################################################
+// Output filter statistics to screen
+//#########################################################################
+
+void Predicates::PrintStatistics() const
+{
+  const char *callerName[PREDICATE_N_CALLER] = {"CheckEdge"};
+
+  for (int i = 0; i < PREDICATE_N_CALLER; i++) {
+    if (nBatchTest[i] == 0) continue;
+
+    std::cout << std::setprecision(6)
+              << "Predicates " << callerName[i] << ": "
+              << nBatchTest[i] << " tests, "
+              << 100.0*(double) (nBatchTest[i] - nBatchExact[i])/
+                 (double) nBatchTest[i]
+              << "% decided by filter" << std::endl;
+  }
+}
+
 }  // namespace astrix
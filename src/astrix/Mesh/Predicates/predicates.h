@@ -16,12 +16,37 @@ along with Astrix.  If not, see <http://www.gnu.org/licenses/>.
 #ifndef ASTRIX_PREDICATES_H
 #define ASTRIX_PREDICATES_H
 
+#include <cstdint>
+
 namespace astrix {
 
 // Forward declaration Array
 template <class T> class Array;
 class Device;
 
+//! Callers of batched predicates, for which statistics are kept
+enum PredicateCaller {PREDICATE_CHECKEDGE,   /*!< Delaunay::CheckEdges*/
+                      PREDICATE_N_CALLER     /*!< Number of callers*/
+};
+
+//! Batch of incircle tests
+/*! Coordinates are stored as a structure of arrays, so that the floating-point filter can be evaluated for all tests in the batch at once. Test i checks whether (dx[i], dy[i]) lies in the circle through (ax[i], ay[i]), (bx[i], by[i]) and (cx[i], cy[i]); the result is written in det[i].*/
+struct IncircleBatch
+{
+  //! Maximum number of tests in batch
+  static const int size = 256;
+
+  real ax[size], ay[size];
+  real bx[size], by[size];
+  real cx[size], cy[size];
+  real dx[size], dy[size];
+
+  //! Result, same sign as incircle()
+  real det[size];
+  //! Permanent of determinant, needed for error bound
+  real permanent[size];
+};
+
 //! Class for exact geometric predicates
 /*! Creating and updating Delaunay triangulations requires exact evaluation of certain geometric tests, in particular whether a point d lies inside or outside the circle through three other points a, b and c, and whether three points a, b and c are orientated in anti-clockwise direction or not. This class uses the algorithms by Shewchuck (1997).*/
 class Predicates
@@ -69,6 +94,12 @@ class Predicates
                 real cx, real cy,
                 const real * const pParam) const;
 
+  //! Incircle test for a batch of points (host only)
+  void incircle(IncircleBatch *batch, int n, PredicateCaller caller) const;
+
+  //! Output filter statistics to screen
+  void PrintStatistics() const;
+
   //! Get pointer to parameter vector
   /*! Return pointer to parameter vector, either device pointer (if \a cudaFlag = 1) or host pointer (if cudaFlag = 0). Note that both exist unless there is no CUDA capable device.
     \param cudaFlag Flag whether to return device pointer (= 1) or host pointer (= 0).
@@ -79,6 +110,11 @@ class Predicates
   //! Parameter vector.
   Array<real> *param;
 
+  //! Number of batched tests per caller
+  mutable int64_t nBatchTest[PREDICATE_N_CALLER];
+  //! Number of batched tests not decided by the filter per caller
+  mutable int64_t nBatchExact[PREDICATE_N_CALLER];
+
   //! Return absolute value of \a a
   /*! Compute absolute value of \a a
     \param a Value we need the absolute value of
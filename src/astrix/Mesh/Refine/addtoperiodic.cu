@@ -101,7 +101,7 @@ void Refine::AddToPeriodic(Connectivity * const connectivity,
                                        devAddToPeriodic,
                                        (size_t) 0, 0);
 
-    devAddToPeriodic<<<nBlocks, nThreads>>>
+    LaunchKernel(nBlocks, nThreads, devAddToPeriodic)
       (nTriangle, pTv, nVertex, nAdd);
     gpuErrchk( cudaPeekAtLastError() );
     gpuErrchk( cudaDeviceSynchronize() );
@@ -13,7 +13,7 @@ Astrix is distributed in the hope that it will be useful, but WITHOUT ANY WARRAN
 
 You should have received a copy of the GNU General Public License
 along with Astrix.  If not, see <http://www.gnu.org/licenses/>.*/
-#include <cuda_runtime_api.h>
+#include "../../Common/cudaRuntime.h"
 #include <iostream>
 
 #include "../../Common/definitions.h"
@@ -71,6 +71,9 @@ int Refine::AddVertices(Connectivity * const connectivity,
     badTriangles->SetSize(nRefine);
     badTriangles->SetToValue(-1);
 
+    // No initiating triangles: start walks from locate grid
+    BuildLocateGrid(connectivity, meshParameter);
+
     // Find triangles for all new vertices
     try {
       FindTriangles(connectivity, meshParameter, predicates);
@@ -272,7 +272,7 @@ int Refine::TestTrianglesQuality(Connectivity * const connectivity,
                                          devTestQualityW,
                                          (size_t) 0, 0);
 
-      devTestQualityW<<<nBlocks, nThreads>>>
+      LaunchKernel(nBlocks, nThreads, devTestQualityW)
         (nTriangle, pTv, pVc,
          pBadTriangles, pWantRefine, dMax,
          nVertex, Px, Py, qualityBound);
@@ -303,7 +303,7 @@ int Refine::TestTrianglesQuality(Connectivity * const connectivity,
 #ifdef TIME_ASTRIX
       gpuErrchk( cudaEventRecord(start, 0) );
 #endif
-      devTestQuality<<<nBlocks, nThreads>>>
+      LaunchKernel(nBlocks, nThreads, devTestQuality)
         (nTriangle, pTv, pVc, pBadTriangles,
          dMax, nVertex, Px, Py, qualityBound);
 #ifdef TIME_ASTRIX
@@ -330,7 +330,7 @@ int Refine::TestTrianglesQuality(Connectivity * const connectivity,
 
 #ifdef TIME_ASTRIX
   gpuErrchk( cudaEventElapsedTime(&elapsedTime, start, stop) );
-  WriteProfileFile("TestQuality.prof", nTriangle, elapsedTime, cudaFlag);
+  AddProfile("TestQuality", nTriangle, elapsedTime, cudaFlag);
 #endif
 
   nvtxTemp = new nvtxEvent("Remove", 3);
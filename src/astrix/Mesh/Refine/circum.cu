@@ -153,7 +153,7 @@ void Refine::FindCircum(Connectivity * const connectivity,
 #ifdef TIME_ASTRIX
     gpuErrchk( cudaEventRecord(start, 0) );
 #endif
-    devCircum<<<nBlocks, nThreads>>>
+    LaunchKernel(nBlocks, nThreads, devCircum)
       (nRefine, pTv, pVc, pVcAdd, pBt, nVertex, Px, Py);
 #ifdef TIME_ASTRIX
     gpuErrchk( cudaEventRecord(stop, 0) );
@@ -176,7 +176,7 @@ void Refine::FindCircum(Connectivity * const connectivity,
 
 #ifdef TIME_ASTRIX
   gpuErrchk( cudaEventElapsedTime(&elapsedTime, start, stop) );
-  WriteProfileFile("Circum.prof", nRefine, elapsedTime, cudaFlag);
+  AddProfile("Circum", nRefine, elapsedTime, cudaFlag);
 #endif
 
   delete nvtxCircum;
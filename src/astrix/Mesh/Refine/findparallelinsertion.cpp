@@ -13,7 +13,7 @@ Astrix is distributed in the hope that it will be useful, but WITHOUT ANY WARRAN
 You should have received a copy of the GNU General Public License
 along with Astrix.  If not, see <http://www.gnu.org/licenses/>.*/
 
-#include <cuda_runtime_api.h>
+#include "../../Common/cudaRuntime.h"
 #include <iostream>
 
 #include "../../Common/definitions.h"
@@ -30,7 +30,7 @@ namespace astrix {
 //#########################################################################
 /*! \brief Find independent set of insertion points
 
-Upon return, \a elementAdd and \a vertexCoordinatesAdd are compacted to a set that can be inserted in one parallel step. This set is found by finding the cavities of the insertion points, keeping an insertion point \i only if none of the triangles in its cavity are needed by points > \a i. To optimize the set, we randomize the order by assigning a unique random number to each insertion point, and keep insertion point \a i with associated random number \a r only if none of the triangles in its cavity are needed by points with associated random number > \a r.
+Upon return, \a elementAdd and \a vertexCoordinatesAdd are compacted to a set that can be inserted in one parallel step. This set is found by finding the cavities of the insertion points, keeping an insertion point \i only if none of the triangles in its cavity are needed by points > \a i. To optimize the set, we randomize the order by assigning a unique random number to each insertion point, and keep insertion point \a i with associated random number \a r only if none of the triangles in its cavity are needed by points with associated random number > \a r. Points that were not kept get up to maxInsertionRound - 1 more rounds among themselves, in which the cavities of points already kept are blocked.
 
 \param *connectivity Pointer to basic Mesh data
 \param *vertexOrder The order in which vertices were inserted. All entries relating to the independent set will be removed
@@ -60,11 +60,27 @@ void Refine::FindParallelInsertionSet(Connectivity * const connectivity,
   // Set pTriangleInCavity[n] = pRandomPermutation[i] if triangle \a t is part
   // of the cavity of point i and available (i.e. not locked by another
   // insertion point).
-  LockTriangles(connectivity, predicates, meshParameter, triangleInCavity);
-
-  // Select cavities that are independent
-  FindIndependentCavities(connectivity, predicates, meshParameter,
-                          triangleInCavity, uniqueFlag);
+  triangleInCavity->SetToValue(-1);
+  uniqueFlag->SetToValue(0);
+
+  // Points losing a triangle to a point with higher priority compete again
+  // among themselves, with the cavities of the selected points blocked,
+  // rather than waiting for the next refine cycle
+  int nSelected = 0;
+  for (int round = 0; round < maxInsertionRound; round++) {
+    if (round > 0) BlockSelectedCavities(triangleInCavity, uniqueFlag);
+
+    LockTriangles(connectivity, predicates, meshParameter,
+                  triangleInCavity, uniqueFlag, round > 0);
+
+    // Select cavities that are independent
+    FindIndependentCavities(connectivity, predicates, meshParameter,
+                            triangleInCavity, uniqueFlag);
+
+    int nSelectedNew = uniqueFlag->Sum();
+    if (nSelectedNew == nSelected || nSelectedNew == (int) nRefine) break;
+    nSelected = nSelectedNew;
+  }
 
   // Compact arrays to new nRefine
   nRefine = uniqueFlag->ExclusiveScan(uniqueFlagScan, nRefine);
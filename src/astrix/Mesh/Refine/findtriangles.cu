@@ -27,9 +27,158 @@ along with Astrix.  If not, see <http://www.gnu.org/licenses/>.*/
 #include "../Connectivity/connectivity.h"
 #include "../Param/meshparameter.h"
 #include "../../Common/profile.h"
+#include "../../Common/atomic.h"
 
 namespace astrix {
 
+//#########################################################################
+/*! \brief Find Morton index of locate grid cell containing (x, y)
+
+The locate grid has 2^\a level cells in each direction. Cells are numbered by interleaving the bits of their x and y index, so that cells close in space are close in memory, just like the Morton-ordered triangles they refer to. Points outside the domain are assigned to the nearest cell.
+
+\param x X-coordinate of point
+\param y Y-coordinate of point
+\param level Refinement level of locate grid
+\param minx Left x boundary
+\param maxx Right x boundary
+\param miny Left y boundary
+\param maxy Right y boundary*/
+//#########################################################################
+
+__host__ __device__
+int LocateCell(real x, real y, int level,
+               real minx, real maxx, real miny, real maxy)
+{
+  int nCell = 1 << level;
+
+  real fx = (real) nCell*(x - minx)/(maxx - minx);
+  real fy = (real) nCell*(y - miny)/(maxy - miny);
+  if (!(fx > (real) 0.0)) fx = (real) 0.0;
+  if (!(fy > (real) 0.0)) fy = (real) 0.0;
+  if (fx > (real) (nCell - 1)) fx = (real) (nCell - 1);
+  if (fy > (real) (nCell - 1)) fy = (real) (nCell - 1);
+
+  int i = (int) fx;
+  int j = (int) fy;
+
+  int cell = 0;
+  for (int k = 0; k < level; k++)
+    cell |= ((i >> k) & 1) << (2*k) | ((j >> k) & 1) << (2*k + 1);
+
+  return cell;
+}
+
+//#########################################################################
+/*! \brief Store triangle \a t in the locate grid cell containing its centroid
+
+\param t Triangle to consider
+\param *pTv Pointer to triangle vertices
+\param *pVc Pointer to vertex coordinates
+\param nVertex Total number of vertices in Mesh
+\param Px Periodic domain size x
+\param Py Periodic domain size y
+\param level Refinement level of locate grid
+\param minx Left x boundary
+\param maxx Right x boundary
+\param miny Left y boundary
+\param maxy Right y boundary
+\param *pCt Pointer to locate grid (output)*/
+//#########################################################################
+
+__host__ __device__
+void FillLocateGridSingle(int t, const int3* __restrict__ pTv,
+                          const real2* __restrict__ pVc,
+                          int nVertex, real Px, real Py, int level,
+                          real minx, real maxx, real miny, real maxy,
+                          int *pCt)
+{
+  real ax, bx, cx, ay, by, cy;
+  GetTriangleCoordinates(pVc, pTv[t].x, pTv[t].y, pTv[t].z,
+                         nVertex, Px, Py,
+                         ax, bx, cx, ay, by, cy);
+
+  real x = (ax + bx + cx)/(real) 3.0;
+  real y = (ay + by + cy)/(real) 3.0;
+
+  // Any triangle in the cell will do as a starting point
+  pCt[LocateCell(x, y, level, minx, maxx, miny, maxy)] = t;
+}
+
+//#########################################################################
+/*! \brief Kernel filling the locate grid with triangles
+
+\param nTriangle Total number of triangles in Mesh
+\param *pTv Pointer to triangle vertices
+\param *pVc Pointer to vertex coordinates
+\param nVertex Total number of vertices in Mesh
+\param Px Periodic domain size x
+\param Py Periodic domain size y
+\param level Refinement level of locate grid
+\param minx Left x boundary
+\param maxx Right x boundary
+\param miny Left y boundary
+\param maxy Right y boundary
+\param *pCt Pointer to locate grid (output)*/
+//#########################################################################
+
+__global__ void
+devFillLocateGrid(int nTriangle, const int3* __restrict__ pTv,
+                  const real2* __restrict__ pVc,
+                  int nVertex, real Px, real Py, int level,
+                  real minx, real maxx, real miny, real maxy,
+                  int *pCt)
+{
+  int t = blockIdx.x*blockDim.x + threadIdx.x;
+
+  while (t < nTriangle) {
+    FillLocateGridSingle(t, pTv, pVc, nVertex, Px, Py, level,
+                         minx, maxx, miny, maxy, pCt);
+
+    t += gridDim.x*blockDim.x;
+  }
+}
+
+//#########################################################################
+/*! \brief Find triangle to start walk towards (x, y)
+
+If a valid starting triangle \a tStart is given it is used; otherwise the triangle stored in the locate grid cell containing (x, y) is returned.
+
+\param tStart Suggested starting triangle, -1 if none
+\param x X-coordinate of point to find triangle for
+\param y Y-coordinate of point to find triangle for
+\param *pCt Pointer to locate grid
+\param level Refinement level of locate grid
+\param minx Left x boundary
+\param maxx Right x boundary
+\param miny Left y boundary
+\param maxy Right y boundary*/
+//#########################################################################
+
+__host__ __device__
+int StartTriangle(int tStart, real x, real y, const int *pCt, int level,
+                  real minx, real maxx, real miny, real maxy)
+{
+  if (tStart >= 0) return tStart;
+
+  return pCt[LocateCell(x, y, level, minx, maxx, miny, maxy)];
+}
+
+//#########################################################################
+/*! \brief Histogram bin for a walk of \a nSteps steps
+
+Bin b contains walks of 2^b up to 2^(b + 1) - 1 steps; the last bin contains all longer walks.
+
+\param nSteps Number of triangles visited*/
+//#########################################################################
+
+__host__ __device__
+int WalkStepBin(int nSteps)
+{
+  int b = 0;
+  while (b < Refine::nWalkStepBin - 1 && (nSteps >> (b + 1)) > 0) b++;
+  return b;
+}
+
 //#########################################################################
 /*! \brief Find triangle to put (x,y) in
 
@@ -202,7 +351,14 @@ Walk through the mesh trying to find triangles containing points specified in \a
 \param *pParam Pointer to initialised Predicates parameter vector
 \param nVertex Total number of vertices in Mesh
 \param Px Periodic domain size x
-\param Py Periodic domain size y*/
+\param Py Periodic domain size y
+\param *pCt Pointer to locate grid, used if \a refineIndex is negative
+\param level Refinement level of locate grid
+\param minx Left x boundary
+\param maxx Right x boundary
+\param miny Left y boundary
+\param maxy Right y boundary
+\param *pWalkStep Pointer to histogram of walk lengths (output)*/
 //######################################################################
 
 __global__ void
@@ -213,7 +369,10 @@ devFindTriangles(int nRefine, int nTriangle,
                  const int3* __restrict__ pTe,
                  const int2* __restrict__ pEt,
                  const Predicates *pred, real *pParam,
-                 int nVertex, real Px, real Py)
+                 int nVertex, real Px, real Py,
+                 const int *pCt, int level,
+                 real minx, real maxx, real miny, real maxy,
+                 int *pWalkStep)
 {
   int i = blockIdx.x*blockDim.x + threadIdx.x;
 
@@ -224,12 +383,17 @@ devFindTriangles(int nRefine, int nTriangle,
 
     int a = 0;
 
+    int tStart = StartTriangle(refineIndex[i], x, y, pCt, level,
+                               minx, maxx, miny, maxy);
+
     // Find triangle or edge to place vertex
-    int t = FindTriangle(refineIndex[i], x, y, nTriangle,
+    int t = FindTriangle(tStart, x, y, nTriangle,
                          pVc, pTv, pTe, pEt,
                          pred, pParam,
                          nVertex, Px, Py, 0, a);
 
+    AtomicAdd(&pWalkStep[WalkStepBin(a)], 1);
+
     pVcAdd[i].x = x;
     pVcAdd[i].y = y;
 
@@ -240,7 +404,7 @@ devFindTriangles(int nRefine, int nTriangle,
 }
 
 //#########################################################################
-/*! When we have created a list of points (x,y) to insert into the mesh in \a vertexCoordinatesAdd, we have to find triangles to put these points in. This is done by walking through the grid, starting from the triangle that initiated the point, until we have found either a suitable triangle or a suitable edge. Results are put in \a elementAdd
+/*! When we have created a list of points (x,y) to insert into the mesh in \a vertexCoordinatesAdd, we have to find triangles to put these points in. This is done by walking through the grid, starting from the triangle that initiated the point, until we have found either a suitable triangle or a suitable edge. Results are put in \a elementAdd. If no initiating triangle is given (\a badTriangles is -1), the walk starts from the locate grid, which must have been set up using BuildLocateGrid(). The number of steps taken is added to the walk length histogram.
 
 \param *connectivity Pointer to basic Mesh data
 \param *meshParameter Pointer to mesh parameters
@@ -278,6 +442,17 @@ void Refine::FindTriangles(Connectivity * const connectivity,
   real Px = meshParameter->maxx - meshParameter->minx;
   real Py = meshParameter->maxy - meshParameter->miny;
 
+  real minx = meshParameter->minx;
+  real maxx = meshParameter->maxx;
+  real miny = meshParameter->miny;
+  real maxy = meshParameter->maxy;
+
+  int *pCt = cellTriangle->GetPointer();
+
+  walkStepCount->SetSize(nWalkStepBin);
+  walkStepCount->SetToValue(0);
+  int *pWalkStep = walkStepCount->GetPointer();
+
   // Find trangles to put new vertices in
   if (cudaFlag == 1) {
     int nBlocks = 26;
@@ -291,12 +466,14 @@ void Refine::FindTriangles(Connectivity * const connectivity,
 #ifdef TIME_ASTRIX
     gpuErrchk( cudaEventRecord(start, 0) );
 #endif
-    devFindTriangles<<<nBlocks, nThreads>>>
+    LaunchKernel(nBlocks, nThreads, devFindTriangles)
       (nRefine, nTriangle, pBadTriangles,
        pElementAdd, pVcAdd,
        pVc, pTv, pTe, pEt,
        predicates, pParam,
-       nVertex, Px, Py);
+       nVertex, Px, Py,
+       pCt, locateLevel, minx, maxx, miny, maxy,
+       pWalkStep);
 #ifdef TIME_ASTRIX
     gpuErrchk( cudaEventRecord(stop, 0) );
     gpuErrchk( cudaEventSynchronize(stop) );
@@ -317,13 +494,18 @@ void Refine::FindTriangles(Connectivity * const connectivity,
 
       int nSteps = 0;
 
+      int tStart = StartTriangle(pBadTriangles[i], x, y, pCt, locateLevel,
+                                 minx, maxx, miny, maxy);
+
       // Find triangle or edge to place vertex
-      int t = FindTriangle(pBadTriangles[i], x, y, nTriangle,
+      int t = FindTriangle(tStart, x, y, nTriangle,
                            pVc, pTv, pTe, pEt,
                            predicates, pParam,
                            nVertex, Px, Py, printFlag,
                            nSteps);
 
+      pWalkStep[WalkStepBin(nSteps)]++;
+
       pVcAdd[i].x = x;
       pVcAdd[i].y = y;
 
@@ -346,10 +528,73 @@ void Refine::FindTriangles(Connectivity * const connectivity,
 
 #ifdef TIME_ASTRIX
   gpuErrchk( cudaEventElapsedTime(&elapsedTime, start, stop) );
-  WriteProfileFile("FindTriangle.prof", nRefine, elapsedTime, cudaFlag);
+  AddProfile("FindTriangle", nRefine, elapsedTime, cudaFlag);
 #endif
 
+  // Add to walk length histogram
+  for (int b = 0; b < nWalkStepBin; b++) {
+    int n = 0;
+    walkStepCount->GetSingleValue(&n, b);
+    nWalkStep[b] += n;
+  }
+
   delete nvtxFind;
 }
 
+//#########################################################################
+/*! Set up the locate grid, a uniform grid over the domain in which every cell holds a triangle close to it, if any. FindTriangles() uses it to start walks for points without an initiating triangle, which would otherwise start from triangle 0 and cross a large part of the Mesh. The grid has roughly one cell per triangle and has to be rebuilt whenever triangles are added or renumbered.
+
+\param *connectivity Pointer to basic Mesh data
+\param *meshParameter Pointer to mesh parameters*/
+//#########################################################################
+
+void Refine::BuildLocateGrid(Connectivity * const connectivity,
+                             const MeshParameter *meshParameter)
+{
+  int nVertex = connectivity->vertexCoordinates->GetSize();
+  int nTriangle = connectivity->triangleVertices->GetSize();
+
+  const real2 *pVc = connectivity->vertexCoordinates->GetPointer();
+  const int3 *pTv = connectivity->triangleVertices->GetPointer();
+
+  real minx = meshParameter->minx;
+  real maxx = meshParameter->maxx;
+  real miny = meshParameter->miny;
+  real maxy = meshParameter->maxy;
+
+  real Px = maxx - minx;
+  real Py = maxy - miny;
+
+  // Largest grid with no more cells than triangles
+  locateLevel = 0;
+  while (locateLevel < maxLocateLevel &&
+         (1 << (2*locateLevel + 2)) <= nTriangle)
+    locateLevel++;
+
+  cellTriangle->SetSize(1 << (2*locateLevel));
+  cellTriangle->SetToValue(-1);
+  int *pCt = cellTriangle->GetPointer();
+
+  if (cudaFlag == 1) {
+    int nBlocks = 128;
+    int nThreads = 128;
+
+    // Base nThreads and nBlocks on maximum occupancy
+    cudaOccupancyMaxPotentialBlockSize(&nBlocks, &nThreads,
+                                       devFillLocateGrid,
+                                       (size_t) 0, 0);
+
+    LaunchKernel(nBlocks, nThreads, devFillLocateGrid)
+      (nTriangle, pTv, pVc, nVertex, Px, Py, locateLevel,
+       minx, maxx, miny, maxy, pCt);
+
+    gpuErrchk( cudaPeekAtLastError() );
+    gpuErrchk( cudaDeviceSynchronize() );
+  } else {
+    for (int t = 0; t < nTriangle; t++)
+      FillLocateGridSingle(t, pTv, pVc, nVertex, Px, Py, locateLevel,
+                           minx, maxx, miny, maxy, pCt);
+  }
+}
+
 }  // namespace astrix
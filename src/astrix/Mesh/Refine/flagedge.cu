@@ -26,6 +26,7 @@ along with Astrix.  If not, see <http://www.gnu.org/licenses/>.*/
 #include "../Param/meshparameter.h"
 #include "./../triangleLow.h"
 #include "../../Common/profile.h"
+#include "../../Common/workqueue.h"
 
 namespace astrix {
 
@@ -275,7 +276,7 @@ devFlagEdgesForChecking(int nRefine, real2 *pVcAdd, int *pElementAdd,
                         const Predicates *pred, real *pParam,
                         int *warningFlag, int *pEnC)
 {
-  unsigned int i = blockIdx.x*blockDim.x + threadIdx.x;
+  int i = blockIdx.x*blockDim.x + threadIdx.x;
 
   while (i < nRefine) {
     FlagEdgeForChecking(i, pVcAdd, pElementAdd, nTriangle,
@@ -341,7 +342,7 @@ void Refine::FlagEdgesForChecking(Connectivity * const connectivity,
 #ifdef TIME_ASTRIX
     gpuErrchk( cudaEventRecord(start, 0) );
 #endif
-    devFlagEdgesForChecking<<<nBlocks, nThreads>>>
+    LaunchKernel(nBlocks, nThreads, devFlagEdgesForChecking)
       (nRefine, pVcAdd, pElementAdd, nTriangle,
        pTv, pTe, pEt, pVc, nVertex, Px, Py, predicates,
        pParam, &warningFlag, pEnC);
@@ -356,10 +357,16 @@ void Refine::FlagEdgesForChecking(Connectivity * const connectivity,
 #ifdef TIME_ASTRIX
     gpuErrchk( cudaEventRecord(start, 0) );
 #endif
-    for (int n = 0; n < (int) nRefine; n++)
-      FlagEdgeForChecking(n, pVcAdd, pElementAdd, nTriangle,
-                          pTv, pTe, pEt, pVc, nVertex, Px, Py,
-                          predicates, pParam, &warningFlag, pEnC);
+    WorkQueue queue(nRefine, 64);
+#pragma omp parallel
+    {
+      int begin, end;
+      while (queue.Next(begin, end))
+        for (int n = begin; n < end; n++)
+          FlagEdgeForChecking(n, pVcAdd, pElementAdd, nTriangle,
+                              pTv, pTe, pEt, pVc, nVertex, Px, Py,
+                              predicates, pParam, &warningFlag, pEnC);
+    }
 #ifdef TIME_ASTRIX
     gpuErrchk( cudaEventRecord(stop, 0) );
     gpuErrchk( cudaEventSynchronize(stop) );
@@ -375,7 +382,7 @@ void Refine::FlagEdgesForChecking(Connectivity * const connectivity,
 
 #ifdef TIME_ASTRIX
   gpuErrchk( cudaEventElapsedTime(&elapsedTime, start, stop) );
-  WriteProfileFile("FlagEdge.prof", nRefine, elapsedTime, cudaFlag);
+  AddProfile("FlagEdge", nRefine, elapsedTime, cudaFlag);
 #endif
 }
 
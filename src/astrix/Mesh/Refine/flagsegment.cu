@@ -96,7 +96,7 @@ int Refine::FlagSegment(Connectivity * const connectivity,
                                        devFlagOnSegment,
                                        (size_t) 0, 0);
 
-    devFlagOnSegment<<<nBlocks, nThreads>>>
+    LaunchKernel(nBlocks, nThreads, devFlagOnSegment)
       (nRefine, pElementAdd, pEt, pOnSegmentFlag, nTriangle);
 
     gpuErrchk(cudaPeekAtLastError());
@@ -13,9 +13,10 @@ Astrix is distributed in the hope that it will be useful, but WITHOUT ANY WARRAN
 
 You should have received a copy of the GNU General Public License
 along with Astrix.  If not, see <http://www.gnu.org/licenses/>.*/
-#include <cuda_runtime_api.h>
+#include "../../Common/cudaRuntime.h"
 #include <iostream>
 #include <fstream>
+#include <chrono>
 
 #include "../../Common/definitions.h"
 #include "../../Array/array.h"
@@ -28,6 +29,22 @@ along with Astrix.  If not, see <http://www.gnu.org/licenses/>.*/
 
 namespace astrix {
 
+//#########################################################################
+/*! \brief Add wall clock time since \a tStage to \a stageTime and reset \a tStage
+
+\param &tStage Start time of stage; set to current time on return
+\param &stageTime Time spent in stage (s)*/
+//#########################################################################
+
+void AddStageTime(std::chrono::high_resolution_clock::time_point& tStage,
+                  double& stageTime)
+{
+  auto now = std::chrono::high_resolution_clock::now();
+  std::chrono::duration<double> elapsed = now - tStage;
+  stageTime += elapsed.count();
+  tStage = now;
+}
+
 //#########################################################################
 /*! Function to improve quality of Mesh by adding new vertices, until the requirements as specified in MeshParameter are met. Returns the number of vertices that were added.
 
@@ -53,21 +70,27 @@ int Refine::ImproveQuality(Connectivity * const connectivity,
 {
   nvtxEvent *nvtxRefine = new nvtxEvent("Refine", 1);
 
+  auto start = std::chrono::high_resolution_clock::now();
+
   int nVertexOld = connectivity->vertexCoordinates->GetSize();
   int nEdge = connectivity->edgeTriangles->GetSize();
   edgeNeedsChecking->SetSize(nEdge);
 
   int finished = 0;
   int ncycle = 0;
-  int addedVerticesFlag = 0;
-  int nAddedSinceMorton = 0;
   real maxFracAddedMorton = 0.07;
 
-  // Maintain Delaunay triangulation
-  delaunay->MakeDelaunay<realNeq, CL>(connectivity, vertexState,
-                                      predicates, meshParameter, 0, 0, 0, 0);
+  // Insertion, removal and flipping keep the Mesh Delaunay, checking only
+  // the edges they touched. In debug mode, verify all edges here.
+  if (debugLevel > 0)
+    delaunay->CheckDelaunay(connectivity, predicates, meshParameter);
 
   while (!finished) {
+    // Wall clock time spent in every stage of this cycle
+    double cycleTime[nRefineStage];
+    for (int n = 0; n < nRefineStage; n++) cycleTime[n] = 0.0;
+    auto tStage = std::chrono::high_resolution_clock::now();
+
     if (verboseLevel > 1)
       std::cout << "Refine cycle " << ncycle;
 
@@ -81,12 +104,14 @@ int Refine::ImproveQuality(Connectivity * const connectivity,
     int nRefine = TestTrianglesQuality(connectivity,
                                        meshParameter,
                                        triangleWantRefine);
+    AddStageTime(tStage, cycleTime[STAGE_QUALITY]);
 
     if (verboseLevel > 2)
       std::cout << "Finding circumcentres..." << std::endl;
 
     // New points will be added in circumcentres of bad triangles
     FindCircum(connectivity, meshParameter, nRefine);
+    AddStageTime(tStage, cycleTime[STAGE_CIRCUM]);
 
     if (nRefine == 0) {
       // No bad triangles: done
@@ -106,12 +131,14 @@ int Refine::ImproveQuality(Connectivity * const connectivity,
         std::cout << "Error finding triangles" << std::endl;
         throw;
       }
+      AddStageTime(tStage, cycleTime[STAGE_FIND]);
 
       if (verboseLevel > 2)
         std::cout << "Testing encroachment..." << std::endl;
 
       // Check if any new vertex encroaches segment
       TestEncroach(connectivity, meshParameter, nRefine);
+      AddStageTime(tStage, cycleTime[STAGE_ENCROACH]);
 
       if (verboseLevel > 1)
         std::cout << ", nBadTriangle = " << nRefine << ", ";
@@ -122,13 +149,13 @@ int Refine::ImproveQuality(Connectivity * const connectivity,
       // Find unique triangle set
       FindParallelInsertionSet(connectivity, 0, 0, 0,
                                predicates, meshParameter);
+      AddStageTime(tStage, cycleTime[STAGE_SELECT]);
 
       nRefine = elementAdd->GetSize();
       if (nRefine == 0) {
         finished = 1;
       } else {
-        addedVerticesFlag = 1;
-        nAddedSinceMorton += nRefine;
+        int nVertexCycle = connectivity->vertexCoordinates->GetSize();
 
         // If necessary, interpolate state
         if (vertexState != 0)
@@ -151,6 +178,7 @@ int Refine::ImproveQuality(Connectivity * const connectivity,
         int nTriangleOld = connectivity->triangleVertices->GetSize();
         InsertVertices<realNeq, CL>(connectivity, meshParameter, predicates,
                                     vertexState, triangleWantRefine);
+        AddStageTime(tStage, cycleTime[STAGE_INSERT]);
 
         // Output memory usage to stdout
         if (verboseLevel > 1) {
@@ -189,7 +217,7 @@ int Refine::ImproveQuality(Connectivity * const connectivity,
         SplitSegment<realNeq, CL>(connectivity, meshParameter, predicates,
                                   vertexState, triangleWantRefine,
                                   specificHeatRatio, nTriangleOld);
-
+        AddStageTime(tStage, cycleTime[STAGE_SPLIT]);
 
         int nEdgeCheck = edgeNeedsChecking->RemoveValue(-1);
 
@@ -200,37 +228,60 @@ int Refine::ImproveQuality(Connectivity * const connectivity,
         delaunay->MakeDelaunay<realNeq, CL>(connectivity, vertexState,
                                             predicates, meshParameter, 0,
                                             edgeNeedsChecking, nEdgeCheck, 0);
+        if (debugLevel > 0)
+          delaunay->CheckDelaunay(connectivity, predicates, meshParameter);
+        AddStageTime(tStage, cycleTime[STAGE_DELAUNAY]);
 
-        if (verboseLevel > 2)
-          std::cout << "Morton..." << std::endl;
-
-        // Morton ordering to preserve data locality
+        // Morton ordering to restore data locality, once enough vertices
+        // have been appended since the last one (possibly in earlier calls)
         int nVertex = connectivity->vertexCoordinates->GetSize();
-        real fracAdded = (real) nAddedSinceMorton/(real) nVertex;
+        nVertexSinceMorton += nVertex - nVertexCycle;
+        real fracAdded = (real) nVertexSinceMorton/(real) nVertex;
         if (debugLevel < 10 && fracAdded > maxFracAddedMorton) {
+          if (verboseLevel > 2)
+            std::cout << "Morton..." << std::endl;
+
           morton->Order<realNeq, CL>(connectivity,
                                      triangleWantRefine,
                                      vertexState);
-          nAddedSinceMorton = 0;
+          nVertexSinceMorton = 0;
         }
+        AddStageTime(tStage, cycleTime[STAGE_MORTON]);
       }
     }
 
+    if (verboseLevel > 1) {
+      // Last cycle did not finish its line
+      if (finished) std::cout << std::endl;
+      std::cout << "  stage times (ms):";
+      for (int n = 0; n < nRefineStage; n++)
+        std::cout << " " << stageName[n] << " " << 1000.0*cycleTime[n];
+      std::cout << std::endl;
+    }
+    for (int n = 0; n < nRefineStage; n++) stageTime[n] += cycleTime[n];
+
     ncycle++;
   }
 
-  // Final Morton ordering
-  if (debugLevel >= 10 || nAddedSinceMorton > 0)
-    morton->Order<realNeq, CL>(connectivity, triangleWantRefine, vertexState);
-
   if (verboseLevel > 1)
     std::cout << std::endl
               << "Number of cycles needed: " << ncycle << std::endl;
 
+  int nAdded = connectivity->vertexCoordinates->GetSize() - nVertexOld;
+
+  // Final Morton ordering when debugging
+  if (debugLevel >= 10)
+    morton->Order<realNeq, CL>(connectivity, triangleWantRefine, vertexState);
+
+  auto finish = std::chrono::high_resolution_clock::now();
+  std::chrono::duration<double> elapsed = finish - start;
+  nVertexInserted += nAdded;
+  refineTime += elapsed.count();
+
   delete nvtxRefine;
 
   // Return number of vertices added
-  return connectivity->vertexCoordinates->GetSize() - nVertexOld;
+  return nAdded;
 }
 
 //##############################################################################
@@ -24,6 +24,8 @@ along with Astrix.  If not, see <http://www.gnu.org/licenses/>.*/
 #include "../Param/meshparameter.h"
 #include "./../triangleLow.h"
 #include "../../Common/profile.h"
+#include "../../Common/workqueue.h"
+#include "../../Common/inlineMath.h"
 
 namespace astrix {
 
@@ -46,7 +48,6 @@ Start at the insertion triangle and move in clockwise direction along the edge o
 \param Py Periodic domain size y
 \param *pred Pointer to Predicates object
 \param *pParam Pointer to parameter vector associated with Predicates
-\param *pRandom Random integers associated with insertion points
 \param *pUniqueFlag Pointer to array flagging whether point can be inserted in parallel*/
 //#########################################################################
 
@@ -59,7 +60,7 @@ void FindIndependentCavity(int i, real2 *pVcAdd, int *pElementAdd,
                            const real2* __restrict__ pVc,
                            int nVertex, real Px,
                            real Py, const Predicates *pred, real *pParam,
-                           unsigned int *pRandom, int *pUniqueFlag)
+                           int *pUniqueFlag)
 {
   real dx = pVcAdd[i].x;
   real dy = pVcAdd[i].y;
@@ -69,7 +70,8 @@ void FindIndependentCavity(int i, real2 *pVcAdd, int *pElementAdd,
   // Flag if cavity lies across periodic boundary
   int translateFlag = 0;
 
-  int randomInt = (int) pRandom[i];
+  // Priority of insertion point
+  int randomInt = (int) UniqueRandom(i);
 
   // Start at insertion triangle
   int tStart = pElementAdd[i];
@@ -97,7 +99,7 @@ void FindIndependentCavity(int i, real2 *pVcAdd, int *pElementAdd,
 
   while (finished == 0) {
     // We know t is in cavity: if pTiC == -i - 2, we have already encountered
-    // t and we can move on; if pTiC == pRandom[i] it is available, otherwise
+    // t and we can move on; if pTiC == randomInt it is available, otherwise
     // it is needed by a point with higher priority.
     if (pTiC[t] != -i - 2) {
       if (pTiC[t] != randomInt) {
@@ -216,7 +218,7 @@ void FindIndependentCavity(int i, real2 *pVcAdd, int *pElementAdd,
 //#########################################################################
 /*! \brief Kernel finding points that can be inserted in parallel
 
-Upon return, pUniqueFlag[i] = 1 is point can be inserted independently of all others, otherwise pUniqueFlag[i] = 0
+Upon return, pUniqueFlag[i] = 1 is point can be inserted independently of all others, otherwise pUniqueFlag[i] = 0. Points already selected in an earlier round (pUniqueFlag[i] = 1) are skipped.
 
 \param nRefine Total number of insertion points
 \param *pVcAdd Coordinates of insertion points
@@ -232,7 +234,6 @@ Upon return, pUniqueFlag[i] = 1 is point can be inserted independently of all ot
 \param Py Periodic domain size y
 \param *pred Pointer to Predicates object
 \param *pParam Pointer to parameter vector associated with Predicates
-\param *pRandom Random integers associated with insertion points
 \param *pUniqueFlag Pointer to array flagging whether point can be inserted in parallel (output)*/
 //#########################################################################
 
@@ -245,14 +246,15 @@ devFindIndependentCavities(int nRefine, real2 *pVcAdd, int *pElementAdd,
                            const real2* __restrict__ pVc,
                            int nVertex, real Px, real Py,
                            const Predicates *pred, real *pParam,
-                           unsigned int *pRandom, int *pUniqueFlag)
+                           int *pUniqueFlag)
 {
-  unsigned int i = blockIdx.x*blockDim.x + threadIdx.x;
+  int i = blockIdx.x*blockDim.x + threadIdx.x;
 
   while (i < nRefine) {
-    FindIndependentCavity(i, pVcAdd, pElementAdd, nTriangle,
-                          pTiC, pTv, pTe, pEt, pVc, nVertex, Px, Py,
-                          pred, pParam, pRandom, pUniqueFlag);
+    if (pUniqueFlag[i] == 0)
+      FindIndependentCavity(i, pVcAdd, pElementAdd, nTriangle,
+                            pTiC, pTv, pTe, pEt, pVc, nVertex, Px, Py,
+                            pred, pParam, pUniqueFlag);
 
     i += gridDim.x*blockDim.x;
   }
@@ -266,8 +268,8 @@ Upon return, pUniqueFlag[i] = 1 is point can be inserted independently of all ot
 \param *connectivity Pointer to basic Mesh data
 \param *predicates Pointer to Predicates object
 \param *meshParameter Pointer to Mesh parameters
-\param *triangleInCavity pTriangleInCavity[n] = pRandomPermutation[i]: triangle n is part of cavity of insertion point i and available.
-\param *uniqueFlag Upon return, pUniqueFlag[i] = 1 is point can be inserted independently of all others, otherwise pUniqueFlag[i] = 0.*/
+\param *triangleInCavity pTriangleInCavity[n] = UniqueRandom(i): triangle n is part of cavity of insertion point i and available.
+\param *uniqueFlag Upon return, pUniqueFlag[i] = 1 is point can be inserted independently of all others, otherwise pUniqueFlag[i] = 0. Entries that are 1 on entry are kept.*/
 //#########################################################################
 
 void Refine::FindIndependentCavities(Connectivity * const connectivity,
@@ -290,9 +292,6 @@ void Refine::FindIndependentCavities(Connectivity * const connectivity,
   int *pTiC = triangleInCavity->GetPointer();
   int *pUniqueFlag = uniqueFlag->GetPointer();
 
-  // Shuffle points to add to maximise parallelisation
-  unsigned int *pRandomPermutation = randomUnique->GetPointer();
-
   unsigned int nVertex = connectivity->vertexCoordinates->GetSize();
   real2 *pVc = connectivity->vertexCoordinates->GetPointer();
   int3 *pTv = connectivity->triangleVertices->GetPointer();
@@ -319,10 +318,10 @@ void Refine::FindIndependentCavities(Connectivity * const connectivity,
 #ifdef TIME_ASTRIX
     gpuErrchk( cudaEventRecord(start, 0) );
 #endif
-    devFindIndependentCavities<<<nBlocks, nThreads>>>
+    LaunchKernel(nBlocks, nThreads, devFindIndependentCavities)
       (nRefine, pVcAdd, pElementAdd, nTriangle, pTiC,
        pTv, pTe, pEt, pVc, nVertex, Px, Py, predicates,
-       pParam, pRandomPermutation, pUniqueFlag);
+       pParam, pUniqueFlag);
 #ifdef TIME_ASTRIX
     gpuErrchk( cudaEventRecord(stop, 0) );
     gpuErrchk( cudaEventSynchronize(stop) );
@@ -334,11 +333,17 @@ void Refine::FindIndependentCavities(Connectivity * const connectivity,
 #ifdef TIME_ASTRIX
     gpuErrchk( cudaEventRecord(start, 0) );
 #endif
-    for (int n = 0; n < (int) nRefine; n++)
-      FindIndependentCavity(n, pVcAdd, pElementAdd, nTriangle,
-                            pTiC, pTv, pTe, pEt, pVc, nVertex, Px, Py,
-                            predicates, pParam, pRandomPermutation,
-                            pUniqueFlag);
+    WorkQueue queue(nRefine, 64);
+#pragma omp parallel
+    {
+      int begin, end;
+      while (queue.Next(begin, end))
+        for (int n = begin; n < end; n++)
+          if (pUniqueFlag[n] == 0)
+            FindIndependentCavity(n, pVcAdd, pElementAdd, nTriangle,
+                                  pTiC, pTv, pTe, pEt, pVc, nVertex, Px, Py,
+                                  predicates, pParam, pUniqueFlag);
+    }
 #ifdef TIME_ASTRIX
     gpuErrchk( cudaEventRecord(stop, 0) );
     gpuErrchk( cudaEventSynchronize(stop) );
@@ -347,7 +352,7 @@ void Refine::FindIndependentCavities(Connectivity * const connectivity,
 
 #ifdef TIME_ASTRIX
   gpuErrchk( cudaEventElapsedTime(&elapsedTime, start, stop) );
-  WriteProfileFile("IndependentCavities.prof", nRefine, elapsedTime, cudaFlag);
+  AddProfile("IndependentCavities", nRefine, elapsedTime, cudaFlag);
 #endif
 }
 
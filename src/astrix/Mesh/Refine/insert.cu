@@ -54,7 +54,9 @@ namespace astrix {
 \param periodicFlagY Flag whether domain is periodic in y
 \param *pred Pointer to initialised Predicates object
 \param *pParam Pointer to initialised Predicates parameter vector
-\param *pWantRefine Pointer to array of flags whether to refine triangles. Value of the initial triangle is set to that of the new triangles (either 1 if creating a new Mesh or 0 is refining during a simulation) */
+\param *pWantRefine Pointer to array of flags whether to refine triangles. Value of the initial triangle is set to that of the new triangles (either 1 if creating a new Mesh or 0 is refining during a simulation)
+\param *pRefineLevel Pointer to triangle refinement levels
+\param refineLevel Refinement level of new triangles and of the triangles they were split from */
 //#########################################################################
 
 __host__ __device__
@@ -65,7 +67,7 @@ void InsertVertex(int n, int t, int e, int nVertex, int nEdge,
                   real minx, real maxx, real miny, real maxy,
                   int nvAdd, int periodicFlagX, int periodicFlagY,
                   const Predicates *pred, real *pParam,
-                  int *pWantRefine)
+                  int *pWantRefine, int *pRefineLevel, int refineLevel)
 {
   int i = n + nVertex;
 
@@ -107,8 +109,12 @@ void InsertVertex(int n, int t, int e, int nVertex, int nEdge,
     pVc[i].x = x;
     pVc[i].y = y;
 
-    if (pWantRefine != 0)
+    if (pWantRefine != 0) {
       pWantRefine[t] = pWantRefine[indexInTriangleArray];
+      pRefineLevel[t] = refineLevel;
+      pRefineLevel[indexInTriangleArray] = refineLevel;
+      pRefineLevel[indexInTriangleArray + 1] = refineLevel;
+    }
 
     int a = pTv[t].x;
     int b = pTv[t].y;
@@ -181,6 +187,10 @@ void InsertVertex(int n, int t, int e, int nVertex, int nEdge,
       if (pWantRefine != 0) {
         pWantRefine[t1] = pWantRefine[indexInTriangleArray];
         pWantRefine[t2] = pWantRefine[indexInTriangleArray];
+        pRefineLevel[t1] = refineLevel;
+        pRefineLevel[t2] = refineLevel;
+        pRefineLevel[indexInTriangleArray] = refineLevel;
+        pRefineLevel[indexInTriangleArray + 1] = refineLevel;
       }
 
       int tv11 = pTv[t1].x;
@@ -479,8 +489,11 @@ void InsertVertex(int n, int t, int e, int nVertex, int nEdge,
       int t = t1;
       if (t == -1) t = t2;
 
-      if (pWantRefine != 0)
+      if (pWantRefine != 0) {
         pWantRefine[t] = pWantRefine[indexInTriangleArray];
+        pRefineLevel[t] = refineLevel;
+        pRefineLevel[indexInTriangleArray] = refineLevel;
+      }
 
       // Find vertex of neighbouring triangle not belonging to edge
       int v1    = pTv[t].x;
@@ -567,7 +580,9 @@ void InsertVertex(int n, int t, int e, int nVertex, int nEdge,
 \param periodicFlagY Flag whether domain is periodic in y
 \param *pred Pointer to initialised Predicates object
 \param *pParam Pointer to initialised Predicates parameter vector
-\param *pWantRefine Pointer to array of flags whether to refine triangles. Value of the initial triangle is set to that of the new triangles (either 1 if creating a new Mesh or 0 is refining during a simulation) */
+\param *pWantRefine Pointer to array of flags whether to refine triangles. Value of the initial triangle is set to that of the new triangles (either 1 if creating a new Mesh or 0 is refining during a simulation)
+\param *pRefineLevel Pointer to triangle refinement levels
+\param refineLevel Refinement level of new triangles and of the triangles they were split from */
 //######################################################################
 
 __global__ void
@@ -578,7 +593,7 @@ devInsertVertices(int nRefine, int *pElementAdd,
                   real minx, real maxx, real miny, real maxy, int nvAdd,
                   int periodicFlagX, int periodicFlagY,
                   const Predicates *pred, real *pParam,
-                  int *pWantRefine)
+                  int *pWantRefine, int *pRefineLevel, int refineLevel)
 {
   int i = blockIdx.x*blockDim.x + threadIdx.x;
 
@@ -598,7 +613,7 @@ devInsertVertices(int nRefine, int *pElementAdd,
                  pVc, pTv, pTe, pEt,
                  minx, maxx, miny, maxy,
                  nvAdd, periodicFlagX, periodicFlagY,
-                 pred, pParam, pWantRefine);
+                 pred, pParam, pWantRefine, pRefineLevel, refineLevel);
 
     i += blockDim.x*gridDim.x;
   }
@@ -670,11 +685,13 @@ void Refine::InsertVertices(Connectivity * const connectivity,
   edgeNeedsChecking->SetToSeries(nEdge, nEdge + ne_add);
 
   int *pWantRefine = 0;
+  int *pRefineLevel = 0;
   if (triangleWantRefine != 0) {
     triangleWantRefine->SetSize(nTriangle + nt_add);
     triangleWantRefine->SetToValue(1 - (vertexState != 0), nTriangle,
                                    triangleWantRefine->GetSize());
     pWantRefine = triangleWantRefine->GetPointer();
+    pRefineLevel = triangleWantRefine->GetPointer(1);
   }
 
   real *pParam = predicates->GetParamPointer(cudaFlag);
@@ -695,7 +712,7 @@ void Refine::InsertVertices(Connectivity * const connectivity,
 #ifdef TIME_ASTRIX
     gpuErrchk( cudaEventRecord(start, 0) );
 #endif
-    devInsertVertices<<<nBlocks, nThreads>>>
+    LaunchKernel(nBlocks, nThreads, devInsertVertices)
       (nRefine, pElementAdd,
        nVertex, nEdge, nTriangle,
        pVcAdd, pOnSegmentFlagScan,
@@ -703,7 +720,8 @@ void Refine::InsertVertices(Connectivity * const connectivity,
        meshParameter->minx, meshParameter->maxx,
        meshParameter->miny, meshParameter->maxy, nv_add,
        meshParameter->periodicFlagX, meshParameter->periodicFlagY,
-       predicates, pParam, pWantRefine);
+       predicates, pParam, pWantRefine, pRefineLevel,
+       meshParameter->nRefineLevel);
 #ifdef TIME_ASTRIX
     gpuErrchk( cudaEventRecord(stop, 0) );
     gpuErrchk( cudaEventSynchronize(stop) );
@@ -715,6 +733,8 @@ void Refine::InsertVertices(Connectivity * const connectivity,
 #ifdef TIME_ASTRIX
     gpuErrchk( cudaEventRecord(start, 0) );
 #endif
+    // Cavities are independent: no two points touch the same triangle
+#pragma omp parallel for
     for (int n = 0; n < nRefine; n++) {
       int t = pElementAdd[n];
       int e = -1;
@@ -731,7 +751,8 @@ void Refine::InsertVertices(Connectivity * const connectivity,
                    meshParameter->minx, meshParameter->maxx,
                    meshParameter->miny, meshParameter->maxy, nv_add,
                    meshParameter->periodicFlagX, meshParameter->periodicFlagY,
-                   predicates, pParam, pWantRefine);
+                   predicates, pParam, pWantRefine, pRefineLevel,
+                   meshParameter->nRefineLevel);
     }
 #ifdef TIME_ASTRIX
     gpuErrchk( cudaEventRecord(stop, 0) );
@@ -741,7 +762,7 @@ void Refine::InsertVertices(Connectivity * const connectivity,
 
 #ifdef TIME_ASTRIX
   gpuErrchk( cudaEventElapsedTime(&elapsedTime, start, stop) );
-  WriteProfileFile("Insert.prof", nRefine, elapsedTime, cudaFlag);
+  AddProfile("Insert", nRefine, elapsedTime, cudaFlag);
 #endif
 
   delete onSegmentFlagScan;
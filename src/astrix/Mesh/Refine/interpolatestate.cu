@@ -198,7 +198,7 @@ void Refine::InterpolateState(Connectivity * const connectivity,
                                        devInterpolateState<realNeq, CL>,
                                        (size_t) 0, 0);
 
-    devInterpolateState<realNeq, CL><<<nBlocks, nThreads>>>
+    LaunchKernel(nBlocks, nThreads, devInterpolateState<realNeq, CL>)
       (nRefine, pElementAdd, state,
        nVertex, nTriangle, pVcAdd, pVc, pTv, pEt,
        pWantRefine, specificHeatRatio, Px, Py);
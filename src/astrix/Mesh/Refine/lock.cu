@@ -15,6 +15,7 @@ You should have received a copy of the GNU General Public License
 along with Astrix.  If not, see <http://www.gnu.org/licenses/>.*/
 
 #include <iostream>
+#include <climits>
 
 #include "../../Common/definitions.h"
 #include "../../Array/array.h"
@@ -26,13 +27,15 @@ along with Astrix.  If not, see <http://www.gnu.org/licenses/>.*/
 #include "./../triangleLow.h"
 #include "../../Common/atomic.h"
 #include "../../Common/profile.h"
+#include "../../Common/workqueue.h"
+#include "../../Common/inlineMath.h"
 
 namespace astrix {
 
 //#########################################################################
 /*! \brief Lock the cavity of insertion point
 
-Start at the insertion triangle and move in clockwise direction along the edge of the cavity, flagging all triangles as part of the cavity of \i by setting pTiC[t] = randomInt. If a triangle is associated with multiple cavities, pick the largest value of randomInt.
+Start at the insertion triangle and move in clockwise direction along the edge of the cavity, flagging all triangles as part of the cavity of \i by setting pTiC[t] = randomInt. If a triangle is associated with multiple cavities, pick the largest value of randomInt. On the device, we stop as soon as we encounter a triangle claimed by a point with a larger randomInt, since this point can not be inserted anyway. On the host, where threads claim triangles in an order that depends on scheduling, the whole cavity is claimed, so that the final pTiC, and therefore the insertion set, does not depend on the number of threads.
 
 \param VcAdd Coordinates of insertion point
 \param elementAdd Insertion triangle or edge
@@ -47,11 +50,12 @@ Start at the insertion triangle and move in clockwise direction along the edge o
 \param Py Periodic domain size y
 \param *pred Pointer to Predicates object
 \param *pParam Pointer to parameter vector associated with Predicates
-\param randomInt Random integer associated with insertion point */
+\param randomInt Random integer associated with insertion point
+\param claimFlag If 0, do not claim any triangles but only check whether the cavity contains a triangle blocked by BlockSelectedCavities() */
 //#########################################################################
 
 __host__ __device__
-void LockTriangle(const real2 VcAdd,
+int LockTriangle(const real2 VcAdd,
                   const int elementAdd,
                   const int nTriangle,
                   int * const pTiC,
@@ -63,7 +67,8 @@ void LockTriangle(const real2 VcAdd,
                   const real Px, const real Py,
                   const Predicates *pred,
                   const real * const pParam,
-                  const int randomInt)
+                  const int randomInt,
+                  const int claimFlag)
 {
   real dx = VcAdd.x;
   real dy = VcAdd.y;
@@ -97,10 +102,19 @@ void LockTriangle(const real2 VcAdd,
   int finished = 0;
 
   while (finished == 0) {
-    // Set pTiC to maximum of pTiC and pRandom
-    int old = AtomicMax(&(pTiC[t]), randomInt);
-    // Stop if old pTic[t] was larger
-    if (old > randomInt) finished = 1;
+    if (claimFlag == 0) {
+      // Cavity needs triangle of point selected in earlier round
+      if (AtomicLoad(&(pTiC[t])) == INT_MAX) return 1;
+    } else {
+      // Set pTiC to maximum of pTiC and randomInt
+      int old = AtomicMax(&(pTiC[t]), randomInt);
+      // Stop if old pTic[t] was larger
+#ifdef __CUDA_ARCH__
+      if (old > randomInt) finished = 1;
+#else
+      (void) old;
+#endif
+    }
 
     if (finished == 0) {
     int tNext = -1;
@@ -204,12 +218,14 @@ void LockTriangle(const real2 VcAdd,
     if ((t == tStart && eCrossed == eStart) || t == -1) finished = 1;
     }
   }
+
+  return 0;
 }
 
 //#########################################################################
 /*! \brief Kernel locking the cavities of insertion points
 
-Upon return, pTiC[t] = pRandom[i] means that triangle \a t is part of the cavity of point \a i and available (i.e. not locked by another insertion point).
+Upon return, pTiC[t] = UniqueRandom(i) means that triangle \a t is part of the cavity of point \a i and available (i.e. not locked by another insertion point). Points with pUniqueFlag[i] = 1 have been selected in an earlier round and are skipped.
 
 \param nRefine Total number of insertion points
 \param *pVcAdd Coordinates of insertion points
@@ -225,7 +241,8 @@ Upon return, pTiC[t] = pRandom[i] means that triangle \a t is part of the cavity
 \param Py Periodic domain size y
 \param *pred Pointer to Predicates object
 \param *pParam Pointer to parameter vector associated with Predicates
-\param *pRandom Random integers associated with insertion points */
+\param *pUniqueFlag Pointer to flags whether point was already selected
+\param checkBlocked Flag whether to skip points whose cavity contains a blocked triangle*/
 //#########################################################################
 
   __global__ void
@@ -236,14 +253,22 @@ devLockTriangles(int nRefine, real2 *pVcAdd, int *pElementAdd, int nTriangle,
                  const int2* __restrict__ pEt,
                  real2 *pVc,
                  int nVertex, real Px, real Py, const Predicates *pred,
-                 real *pParam, unsigned int *pRandom)
+                 real *pParam, const int *pUniqueFlag, int checkBlocked)
 {
-  unsigned int i = blockIdx.x*blockDim.x + threadIdx.x;
+  int i = blockIdx.x*blockDim.x + threadIdx.x;
 
   while (i < nRefine) {
-    LockTriangle(pVcAdd[i], pElementAdd[i], nTriangle, pTiC,
-                 pTv, pTe, pEt, pVc, nVertex, Px, Py, pred,
-                 pParam, pRandom[i]);
+    if (pUniqueFlag[i] == 0) {
+      int blocked = 0;
+      if (checkBlocked == 1)
+        blocked = LockTriangle(pVcAdd[i], pElementAdd[i], nTriangle, pTiC,
+                               pTv, pTe, pEt, pVc, nVertex, Px, Py, pred,
+                               pParam, (int) UniqueRandom(i), 0);
+      if (blocked == 0)
+        LockTriangle(pVcAdd[i], pElementAdd[i], nTriangle, pTiC,
+                     pTv, pTe, pEt, pVc, nVertex, Px, Py, pred,
+                     pParam, (int) UniqueRandom(i), 1);
+    }
 
     i += gridDim.x*blockDim.x;
   }
@@ -252,18 +277,22 @@ devLockTriangles(int nRefine, real2 *pVcAdd, int *pElementAdd, int nTriangle,
 //#########################################################################
 /*! \brief Lock triangles in cavities of insertion points
 
-Upon return, pTriangleInCavity[n] = pRandomPermutation[i]: triangle n is part of cavity of insertion point i and available.
+Upon return, pTriangleInCavity[n] = UniqueRandom(i): triangle n is part of cavity of insertion point i and available. Entries of \a triangleInCavity are raised, so it must be set to -1 (or blocked by BlockSelectedCavities()) beforehand.
 
 \param *connectivity Pointer to basic Mesh data
 \param *predicates Pointer to Predicates object
 \param *meshParameter Pointer to Mesh parameters
-\param *triangleInCavity Pointer to output Array of size \a nTriangle*/
+\param *triangleInCavity Pointer to output Array of size \a nTriangle
+\param *uniqueFlag Flags whether points were selected in an earlier round; these are skipped
+\param checkBlocked Flag whether to skip points whose cavity contains a triangle blocked by BlockSelectedCavities(). These can never be selected, and would otherwise stop others from being selected.*/
 //#########################################################################
 
 void Refine::LockTriangles(Connectivity * const connectivity,
                            const Predicates *predicates,
                            const MeshParameter *meshParameter,
-                           Array<int> *triangleInCavity)
+                           Array<int> *triangleInCavity,
+                           const Array<int> *uniqueFlag,
+                           const int checkBlocked)
 {
 #ifdef TIME_ASTRIX
   cudaEvent_t start, stop;
@@ -276,9 +305,6 @@ void Refine::LockTriangles(Connectivity * const connectivity,
   unsigned int nTriangle = connectivity->triangleVertices->GetSize();
   unsigned int nRefine = elementAdd->GetSize();
 
-  // Shuffle points to add to maximise parallelisation
-  unsigned int *pRandomPermutation = randomUnique->GetPointer();
-
   unsigned int nVertex = connectivity->vertexCoordinates->GetSize();
   real2 *pVc = connectivity->vertexCoordinates->GetPointer();
   int3 *pTv = connectivity->triangleVertices->GetPointer();
@@ -291,9 +317,10 @@ void Refine::LockTriangles(Connectivity * const connectivity,
   real2 *pVcAdd = vertexCoordinatesAdd->GetPointer();
   int *pElementAdd = elementAdd->GetPointer();
 
-  // pTiC[n] = pRandom[i]: triangle n is part of cavity of new vertex i
+  // pTiC[n] = UniqueRandom(i): triangle n is part of cavity of new vertex i.
+  // Random priorities maximise the number of points inserted in parallel.
   int *pTiC = triangleInCavity->GetPointer();
-  triangleInCavity->SetToValue(-1);
+  const int *pUniqueFlag = uniqueFlag->GetPointer();
 
   if (cudaFlag == 1) {
     int nBlocks = 128;
@@ -307,10 +334,10 @@ void Refine::LockTriangles(Connectivity * const connectivity,
 #ifdef TIME_ASTRIX
     gpuErrchk( cudaEventRecord(start, 0) );
 #endif
-    devLockTriangles<<<nBlocks, nThreads>>>
+    LaunchKernel(nBlocks, nThreads, devLockTriangles)
       (nRefine, pVcAdd, pElementAdd, nTriangle, pTiC,
        pTv, pTe, pEt, pVc, nVertex, Px, Py, predicates,
-       pParam, pRandomPermutation);
+       pParam, pUniqueFlag, checkBlocked);
 #ifdef TIME_ASTRIX
     gpuErrchk( cudaEventRecord(stop, 0) );
     gpuErrchk( cudaEventSynchronize(stop) );
@@ -322,10 +349,27 @@ void Refine::LockTriangles(Connectivity * const connectivity,
 #ifdef TIME_ASTRIX
     gpuErrchk( cudaEventRecord(start, 0) );
 #endif
-    for (int n = 0; n < static_cast<int>(nRefine); n++)
-      LockTriangle(pVcAdd[n], pElementAdd[n], nTriangle, pTiC,
-                   pTv, pTe, pEt, pVc, nVertex, Px, Py, predicates,
-                   pParam, pRandomPermutation[n]);
+    WorkQueue queue(nRefine, 64);
+#pragma omp parallel
+    {
+      int begin, end;
+      while (queue.Next(begin, end)) {
+        for (int n = begin; n < end; n++) {
+          if (pUniqueFlag[n] == 0) {
+            int blocked = 0;
+            if (checkBlocked == 1)
+              blocked = LockTriangle(pVcAdd[n], pElementAdd[n], nTriangle,
+                                     pTiC, pTv, pTe, pEt, pVc, nVertex,
+                                     Px, Py, predicates, pParam,
+                                     (int) UniqueRandom(n), 0);
+            if (blocked == 0)
+              LockTriangle(pVcAdd[n], pElementAdd[n], nTriangle, pTiC,
+                           pTv, pTe, pEt, pVc, nVertex, Px, Py, predicates,
+                           pParam, (int) UniqueRandom(n), 1);
+          }
+        }
+      }
+    }
 #ifdef TIME_ASTRIX
     gpuErrchk( cudaEventRecord(stop, 0) );
     gpuErrchk( cudaEventSynchronize(stop) );
@@ -334,8 +378,87 @@ void Refine::LockTriangles(Connectivity * const connectivity,
 
 #ifdef TIME_ASTRIX
   gpuErrchk( cudaEventElapsedTime(&elapsedTime, start, stop) );
-  WriteProfileFile("LockTriangle.prof", nRefine, elapsedTime, cudaFlag);
+  AddProfile("LockTriangle", nRefine, elapsedTime, cudaFlag);
 #endif
 }
 
+//#########################################################################
+/*! \brief Block triangle \a t if it is in the cavity of a selected point
+
+After FindIndependentCavities(), pTiC[t] = -i - 2 for triangles in the cavity of point \i that were visited before a conflict was found. If \a i was selected, the triangle is blocked by setting it to the highest possible priority. Triangles blocked in an earlier round stay blocked; all others are released by setting them to -1. Only the point with priority INT_MAX could claim a blocked triangle, but that point always wins the first round.
+
+\param t Triangle to consider
+\param *pTiC Pointer to Array triangleInCavity
+\param *pUniqueFlag Pointer to flags whether points were selected*/
+//#########################################################################
+
+__host__ __device__
+void BlockSelectedCavitySingle(int t, int *pTiC, const int *pUniqueFlag)
+{
+  int ret = -1;
+  // Blocked in an earlier round
+  if (pTiC[t] == INT_MAX) ret = INT_MAX;
+  // Visited by point i
+  if (pTiC[t] < -1)
+    if (pUniqueFlag[-pTiC[t] - 2] == 1) ret = INT_MAX;
+  pTiC[t] = ret;
+}
+
+//#########################################################################
+/*! \brief Kernel blocking the cavities of selected points
+
+\param nTriangle Total number of triangles in Mesh
+\param *pTiC Pointer to Array triangleInCavity
+\param *pUniqueFlag Pointer to flags whether points were selected*/
+//#########################################################################
+
+__global__ void
+devBlockSelectedCavities(int nTriangle, int *pTiC, const int *pUniqueFlag)
+{
+  int n = blockIdx.x*blockDim.x + threadIdx.x;
+
+  while (n < nTriangle) {
+    BlockSelectedCavitySingle(n, pTiC, pUniqueFlag);
+
+    n += gridDim.x*blockDim.x;
+  }
+}
+
+//#########################################################################
+/*! \brief Block cavities of selected points and release all other triangles
+
+Prepares \a triangleInCavity for another round of LockTriangles() and FindIndependentCavities() among the points that were not selected, so that they can not claim triangles needed by selected points.
+
+\param *triangleInCavity Pointer to Array triangleInCavity
+\param *uniqueFlag Flags whether points were selected*/
+//#########################################################################
+
+void Refine::BlockSelectedCavities(Array<int> *triangleInCavity,
+                                   const Array<int> *uniqueFlag)
+{
+  int nTriangle = triangleInCavity->GetSize();
+  int *pTiC = triangleInCavity->GetPointer();
+  const int *pUniqueFlag = uniqueFlag->GetPointer();
+
+  if (cudaFlag == 1) {
+    int nBlocks = 128;
+    int nThreads = 128;
+
+    // Base nThreads and nBlocks on maximum occupancy
+    cudaOccupancyMaxPotentialBlockSize(&nBlocks, &nThreads,
+                                       devBlockSelectedCavities,
+                                       (size_t) 0, 0);
+
+    LaunchKernel(nBlocks, nThreads, devBlockSelectedCavities)
+      (nTriangle, pTiC, pUniqueFlag);
+
+    gpuErrchk( cudaPeekAtLastError() );
+    gpuErrchk( cudaDeviceSynchronize() );
+  } else {
+#pragma omp parallel for
+    for (int n = 0; n < nTriangle; n++)
+      BlockSelectedCavitySingle(n, pTiC, pUniqueFlag);
+  }
+}
+
 }  // namespace astrix
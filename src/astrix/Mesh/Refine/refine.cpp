@@ -14,8 +14,12 @@ Astrix is distributed in the hope that it will be useful, but WITHOUT ANY WARRAN
 You should have received a copy of the GNU General Public License
 along with Astrix.  If not, see <http://www.gnu.org/licenses/>.*/
 
-#include <cuda_runtime_api.h>
+#include "../../Common/cudaRuntime.h"
 #include <iostream>
+#include <iomanip>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 #include "../../Common/definitions.h"
 #include "../../Array/array.h"
@@ -23,6 +27,10 @@ along with Astrix.  If not, see <http://www.gnu.org/licenses/>.*/
 
 namespace astrix {
 
+const char *Refine::stageName[nRefineStage] =
+  {"quality", "circum", "find", "encroach", "select", "insert", "split",
+   "delaunay", "morton"};
+
 //#########################################################################
 /*! Constructor for Refine class.
 
@@ -45,9 +53,16 @@ Refine::Refine(int _cudaFlag, int _debugLevel, int _verboseLevel)
   triangleAffectedIndex = new Array<int>(1, cudaFlag);
   edgeNeedsChecking = new Array<int>(1, cudaFlag);
 
-  randomUnique = new Array<unsigned int>(1, cudaFlag, 10000000);
-  randomUnique->SetToSeries();
-  randomUnique->Shuffle();
+  locateLevel = 0;
+  cellTriangle = new Array<int>(1, cudaFlag, 1);
+  cellTriangle->SetToValue(-1);
+  walkStepCount = new Array<int>(1, cudaFlag, nWalkStepBin);
+  for (int b = 0; b < nWalkStepBin; b++) nWalkStep[b] = 0;
+
+  nVertexSinceMorton = 0;
+  nVertexInserted = 0;
+  refineTime = 0.0;
+  for (int n = 0; n < nRefineStage; n++) stageTime[n] = 0.0;
 }
 
 //#########################################################################
@@ -62,7 +77,51 @@ Refine::~Refine()
   delete triangleAffected;
   delete triangleAffectedIndex;
   delete edgeNeedsChecking;
-  delete randomUnique;
+  delete cellTriangle;
+  delete walkStepCount;
+}
+
+//#########################################################################
+// Output walk length histogram and insertion rate to screen
+//#########################################################################
+
+void Refine::PrintStatistics() const
+{
+  int64_t nWalk = 0;
+  for (int b = 0; b < nWalkStepBin; b++) nWalk += nWalkStep[b];
+
+  if (nVertexInserted > 0) {
+    int nThread = 1;
+#ifdef _OPENMP
+    nThread = omp_get_max_threads();
+#endif
+    std::cout << std::setprecision(6)
+              << "Refine: " << nVertexInserted << " vertices added in "
+              << refineTime << " s, "
+              << (double) nVertexInserted/refineTime << " vertices/s";
+    if (cudaFlag == 0) std::cout << " on " << nThread << " threads";
+    std::cout << std::endl;
+
+    std::cout << "Refine times (s):";
+    for (int n = 0; n < nRefineStage; n++)
+      std::cout << " " << stageName[n] << " " << stageTime[n];
+    std::cout << std::endl;
+  }
+
+  if (nWalk == 0) return;
+
+  std::cout << "FindTriangle: " << nWalk << " walks; steps:";
+  for (int b = 0; b < nWalkStepBin; b++) {
+    if (nWalkStep[b] == 0) continue;
+
+    std::cout << " " << (1 << b);
+    if (b == nWalkStepBin - 1)
+      std::cout << "+";
+    else if (b > 0)
+      std::cout << "-" << (2 << b) - 1;
+    std::cout << ": " << nWalkStep[b];
+  }
+  std::cout << std::endl;
 }
 
 }  // namespace astrix
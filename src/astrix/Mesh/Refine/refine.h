@@ -15,6 +15,8 @@ along with Astrix.  If not, see <http://www.gnu.org/licenses/>.*/
 #ifndef ASTRIX_REFINE_H
 #define ASTRIX_REFINE_H
 
+#include <cstdint>
+
 namespace astrix {
 
 // Forward declarations
@@ -52,6 +54,14 @@ class Refine
                   Array<real2> * const vertexBoundaryCoordinates,
                   Array<int> * const vertexOrder);
 
+  //! Output walk length and insertion rate statistics to screen
+  void PrintStatistics() const;
+
+  //! Number of bins in walk length histogram
+  static const int nWalkStepBin = 16;
+  //! Maximum number of rounds selecting independent insertion points per cycle
+  static const int maxInsertionRound = 2;
+
  private:
   //! Flag whether to use device or host
   int cudaFlag;
@@ -72,8 +82,33 @@ class Refine
   Array <int> *triangleAffectedIndex;
   //! Flag if edge needs checking for Delaunay-hood
   Array<int> *edgeNeedsChecking;
-  //! Unique random numbers
-  Array<unsigned int> *randomUnique;
+  //! Maximum refinement level of locate grid
+  static const int maxLocateLevel = 10;
+  //! Refinement level of locate grid: 2^locateLevel cells in each direction
+  int locateLevel;
+  //! Triangle in every locate grid cell (Morton order), -1 if empty
+  Array<int> *cellTriangle;
+  //! Walk length histogram of last call to FindTriangles()
+  Array<int> *walkStepCount;
+  //! Walk length histogram, accumulated over all calls to FindTriangles()
+  int64_t nWalkStep[nWalkStepBin];
+
+  //! Stages of a refine cycle, timed separately
+  enum RefineStage {STAGE_QUALITY, STAGE_CIRCUM, STAGE_FIND, STAGE_ENCROACH,
+                    STAGE_SELECT, STAGE_INSERT, STAGE_SPLIT, STAGE_DELAUNAY,
+                    STAGE_MORTON, nRefineStage};
+  //! Names of refine stages for output
+  static const char *stageName[nRefineStage];
+  //! Time spent in every stage of ImproveQuality() (s)
+  double stageTime[nRefineStage];
+
+  //! Vertices added since the last Morton ordering, over all calls
+  int nVertexSinceMorton;
+
+  //! Total number of vertices added by ImproveQuality()
+  int64_t nVertexInserted;
+  //! Total time spent in ImproveQuality() (s)
+  double refineTime;
 
   //! Find low-quality triangles
   int TestTrianglesQuality(Connectivity * const connectivity,
@@ -83,6 +118,9 @@ class Refine
   void FindCircum(Connectivity * const connectivity,
                   const MeshParameter *meshParameter,
                   const int nRefine);
+  //! Set up grid for finding starting triangles
+  void BuildLocateGrid(Connectivity * const connectivity,
+                       const MeshParameter *meshParameter);
   //! Find triangles or edges to put new vertices in/on
   void FindTriangles(Connectivity * const connectivity,
                      const MeshParameter *meshParameter,
@@ -131,7 +169,12 @@ class Refine
   void LockTriangles(Connectivity * const connectivity,
                      const Predicates *predicates,
                      const MeshParameter *meshParameter,
-                     Array<int> *triangleInCavity);
+                     Array<int> *triangleInCavity,
+                     const Array<int> *uniqueFlag,
+                     const int checkBlocked);
+  //! Block cavities of selected points and release all other triangles
+  void BlockSelectedCavities(Array<int> *triangleInCavity,
+                             const Array<int> *uniqueFlag);
   void FindIndependentCavities(Connectivity * const connectivity,
                                const Predicates *predicates,
                                const MeshParameter *meshParameter,
@@ -468,7 +468,7 @@ void Refine::TestEncroach(Connectivity * const connectivity,
 #ifdef TIME_ASTRIX
     gpuErrchk( cudaEventRecord(start, 0) );
 #endif
-    devTestEncroach<<<nBlocks, nThreads>>>
+    LaunchKernel(nBlocks, nThreads, devTestEncroach)
       (nRefine, pElementAdd, pVcAdd,
        pTv, pTe, pEt, pVc, nVertex, Px, Py, nTriangle);
 #ifdef TIME_ASTRIX
@@ -495,7 +495,7 @@ void Refine::TestEncroach(Connectivity * const connectivity,
 
 #ifdef TIME_ASTRIX
   gpuErrchk( cudaEventElapsedTime(&elapsedTime, start, stop) );
-  WriteProfileFile("TestEncroach.prof", nRefine, elapsedTime, cudaFlag);
+  AddProfile("TestEncroach", nRefine, elapsedTime, cudaFlag);
 #endif
 
   delete nvtxEncroach;
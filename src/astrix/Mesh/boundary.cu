@@ -326,7 +326,7 @@ void Mesh::ConstructBoundaries()
                                        devSetVertexOuterBoundary,
                                        (size_t) 0, 0);
 
-    devSetVertexOuterBoundary<<<nBlocks, nThreads>>>
+    LaunchKernel(nBlocks, nThreads, devSetVertexOuterBoundary)
       (meshParameter->problemDef, pVbc, nVertexOuterBoundary,
        meshParameter->periodicFlagX, meshParameter->periodicFlagY,
        meshParameter->minx, meshParameter->maxx, meshParameter->miny,
@@ -356,7 +356,7 @@ void Mesh::ConstructBoundaries()
                                        devSetVertexInnerBoundary,
                                        (size_t) 0, 0);
 
-    devSetVertexInnerBoundary<<<nBlocks, nThreads>>>
+    LaunchKernel(nBlocks, nThreads, devSetVertexInnerBoundary)
       (meshParameter->problemDef, pVbc,
        nVertexInnerBoundary, nVertexOuterBoundary,
        meshParameter->minx, meshParameter->maxx,
@@ -519,6 +519,11 @@ void Mesh::ConstructBoundaries()
     delete vertexExtraOrder;
   }
 
+  // Removing the initial vertices and connecting periodic boundaries do not
+  // keep track of edges that need checking: check all edges
+  delaunay->MakeDelaunay<real, CL_ADVECT>(connectivity, 0, predicates,
+                                          meshParameter, 0, 0, 0, 0);
+
   if (verboseLevel > 0)
     std::cout << "Boundaries done" << std::endl;
 }
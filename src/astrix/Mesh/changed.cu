@@ -0,0 +1,389 @@
+// -*-c++-*-
+/*! \file changed.cu
+\brief Functions for finding triangles and vertices changed by refinement
+
+\section LICENSE
+Copyright (c) 2017 Sijme-Jan Paardekooper
+
+This file is part of Astrix.
+
+Astrix is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+
+Astrix is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Astrix.  If not, see <http://www.gnu.org/licenses/>.*/
+#include <iostream>
+#include <stdexcept>
+#include <cmath>
+
+#include "../Common/definitions.h"
+#include "../Array/array.h"
+#include "./mesh.h"
+#include "../Common/atomic.h"
+#include "../Common/cudaLow.h"
+#include "./Connectivity/connectivity.h"
+#include "./Param/meshparameter.h"
+
+namespace astrix {
+
+// Defined in findboundaryvertices.cu
+void FlagToList(Array<int> *flag, Array<int> *list, Array<int> *flagScan);
+
+//######################################################################
+/*! \brief Check if triangle corners \a a and \a b refer to the same vertex and periodic image
+
+Periodic images are encoded by adding multiples of the number of vertices, which changes when vertices are added. Therefore compare vertex and image separately.
+
+\param a Corner in old Mesh
+\param nVertexA Number of vertices in old Mesh
+\param b Corner in new Mesh
+\param nVertexB Number of vertices in new Mesh*/
+//######################################################################
+
+__host__ __device__
+int SameCorner(int a, int nVertexA, int b, int nVertexB)
+{
+  int imageA = 0;
+  while (a >= nVertexA) {
+    a -= nVertexA;
+    imageA++;
+  }
+  while (a < 0) {
+    a += nVertexA;
+    imageA--;
+  }
+
+  int imageB = 0;
+  while (b >= nVertexB) {
+    b -= nVertexB;
+    imageB++;
+  }
+  while (b < 0) {
+    b += nVertexB;
+    imageB--;
+  }
+
+  return (a == b && imageA == imageB);
+}
+
+//######################################################################
+/*! \brief Flag triangle \a n if it is new or its vertices have changed
+
+\param n Index of triangle to consider
+\param nTriangleOld Number of triangles before refinement
+\param nVertexOld Number of vertices before refinement
+\param nVertex Current number of vertices
+\param *pTvOld Pointer to triangle vertices before refinement
+\param *pTv Pointer to current triangle vertices
+\param *pChangedFlag Pointer to output flags*/
+//######################################################################
+
+__host__ __device__
+void FlagChangedTriangleSingle(int n, int nTriangleOld,
+                               int nVertexOld, int nVertex,
+                               int3 *pTvOld, int3 *pTv, int *pChangedFlag)
+{
+  int ret = 1;
+  if (n < nTriangleOld)
+    ret = (SameCorner(pTvOld[n].x, nVertexOld, pTv[n].x, nVertex) == 0 ||
+           SameCorner(pTvOld[n].y, nVertexOld, pTv[n].y, nVertex) == 0 ||
+           SameCorner(pTvOld[n].z, nVertexOld, pTv[n].z, nVertex) == 0);
+
+  pChangedFlag[n] = ret;
+}
+
+//######################################################################
+/*! \brief Kernel flagging triangles that are new or whose vertices have changed
+
+\param nTriangle Current number of triangles
+\param nTriangleOld Number of triangles before refinement
+\param nVertexOld Number of vertices before refinement
+\param nVertex Current number of vertices
+\param *pTvOld Pointer to triangle vertices before refinement
+\param *pTv Pointer to current triangle vertices
+\param *pChangedFlag Pointer to output flags*/
+//######################################################################
+
+__global__ void
+devFlagChangedTriangle(int nTriangle, int nTriangleOld,
+                       int nVertexOld, int nVertex,
+                       int3 *pTvOld, int3 *pTv, int *pChangedFlag)
+{
+  // n = triangle number
+  int n = blockIdx.x*blockDim.x + threadIdx.x;
+
+  while (n < nTriangle) {
+    FlagChangedTriangleSingle(n, nTriangleOld, nVertexOld, nVertex,
+                              pTvOld, pTv, pChangedFlag);
+
+    n += blockDim.x*gridDim.x;
+  }
+}
+
+//######################################################################
+/*! \brief Flag the vertices of changed triangle \a pTc[i]
+
+\param i Index in list of changed triangles
+\param *pTc Pointer to list of changed triangles
+\param *pTv Pointer to triangle vertices
+\param nVertex Total number of vertices in Mesh
+\param *pVertexFlag Pointer to output flags*/
+//######################################################################
+
+__host__ __device__
+void FlagChangedVertexSingle(int i, int *pTc, int3 *pTv, int nVertex,
+                             int *pVertexFlag)
+{
+  int n = pTc[i];
+
+  int a = pTv[n].x;
+  int b = pTv[n].y;
+  int c = pTv[n].z;
+  while (a >= nVertex) a -= nVertex;
+  while (b >= nVertex) b -= nVertex;
+  while (c >= nVertex) c -= nVertex;
+  while (a < 0) a += nVertex;
+  while (b < 0) b += nVertex;
+  while (c < 0) c += nVertex;
+
+  AtomicExch(&(pVertexFlag[a]), 1);
+  AtomicExch(&(pVertexFlag[b]), 1);
+  AtomicExch(&(pVertexFlag[c]), 1);
+}
+
+//######################################################################
+/*! \brief Kernel flagging the vertices of changed triangles
+
+\param nChanged Number of changed triangles
+\param *pTc Pointer to list of changed triangles
+\param *pTv Pointer to triangle vertices
+\param nVertex Total number of vertices in Mesh
+\param *pVertexFlag Pointer to output flags*/
+//######################################################################
+
+__global__ void
+devFlagChangedVertex(int nChanged, int *pTc, int3 *pTv, int nVertex,
+                     int *pVertexFlag)
+{
+  int i = blockIdx.x*blockDim.x + threadIdx.x;
+
+  while (i < nChanged) {
+    FlagChangedVertexSingle(i, pTc, pTv, nVertex, pVertexFlag);
+
+    i += blockDim.x*gridDim.x;
+  }
+}
+
+//#########################################################################
+/*! Compare triangles with \a triangleVerticesOld, which holds the triangles before refinement, and make a list of all triangles that are new or have different vertices in \a triangleChanged. Only valid if no vertices or triangles have been reordered or removed since \a triangleVerticesOld was filled. Returns the number of changed triangles.
+
+\param nTriangleOld Number of triangles before refinement
+\param nVertexOld Number of vertices before refinement*/
+//#########################################################################
+
+int Mesh::FindChangedTriangles(int nTriangleOld, int nVertexOld)
+{
+  int nTriangle = connectivity->triangleVertices->GetSize();
+  int nVertex = connectivity->vertexCoordinates->GetSize();
+
+  int3 *pTv = connectivity->triangleVertices->GetPointer();
+  int3 *pTvOld = triangleVerticesOld->GetPointer();
+
+  triangleChangedFlag->SetSize(nTriangle);
+  int *pChangedFlag = triangleChangedFlag->GetPointer();
+
+  if (cudaFlag == 1) {
+    int nBlocks = 128;
+    int nThreads = 128;
+
+    // Base nThreads and nBlocks on maximum occupancy
+    cudaOccupancyMaxPotentialBlockSize(&nBlocks, &nThreads,
+                                       devFlagChangedTriangle,
+                                       (size_t) 0, 0);
+
+    LaunchKernel(nBlocks, nThreads, devFlagChangedTriangle)
+      (nTriangle, nTriangleOld, nVertexOld, nVertex,
+       pTvOld, pTv, pChangedFlag);
+
+    gpuErrchk( cudaPeekAtLastError() );
+    gpuErrchk( cudaDeviceSynchronize() );
+  } else {
+#pragma omp parallel for
+    for (int n = 0; n < nTriangle; n++)
+      FlagChangedTriangleSingle(n, nTriangleOld, nVertexOld, nVertex,
+                                pTvOld, pTv, pChangedFlag);
+  }
+
+  FlagToList(triangleChangedFlag, triangleChanged, flagScan);
+
+  return triangleChanged->GetSize();
+}
+
+//#########################################################################
+/*! Make a list of all vertices of the triangles in \a triangleChanged in \a vertexChanged. These are the only vertices whose area or boundary flag can have changed by refinement: any vertex of a triangle that was replaced is a vertex of one of the replacing triangles. Returns the number of changed vertices.
+
+\param nChanged Number of changed triangles*/
+//#########################################################################
+
+int Mesh::FindChangedVertices(int nChanged)
+{
+  int nVertex = connectivity->vertexCoordinates->GetSize();
+
+  int3 *pTv = connectivity->triangleVertices->GetPointer();
+  int *pTc = triangleChanged->GetPointer();
+
+  vertexChangedFlag->SetSize(nVertex);
+  vertexChangedFlag->SetToValue(0);
+  int *pVertexFlag = vertexChangedFlag->GetPointer();
+
+  if (cudaFlag == 1) {
+    int nBlocks = 128;
+    int nThreads = 128;
+
+    // Base nThreads and nBlocks on maximum occupancy
+    cudaOccupancyMaxPotentialBlockSize(&nBlocks, &nThreads,
+                                       devFlagChangedVertex,
+                                       (size_t) 0, 0);
+
+    LaunchKernel(nBlocks, nThreads, devFlagChangedVertex)
+      (nChanged, pTc, pTv, nVertex, pVertexFlag);
+
+    gpuErrchk( cudaPeekAtLastError() );
+    gpuErrchk( cudaDeviceSynchronize() );
+  } else {
+#pragma omp parallel for
+    for (int i = 0; i < nChanged; i++)
+      FlagChangedVertexSingle(i, pTc, pTv, nVertex, pVertexFlag);
+  }
+
+  FlagToList(vertexChangedFlag, vertexChanged, flagScan);
+
+  return vertexChanged->GetSize();
+}
+
+//#########################################################################
+/*! Check the incremental geometry update after refinement against a full recalculation. Used in debug mode to verify that \a triangleChanged and \a vertexChanged contained everything refinement changed. Normals, edge lengths, boundary flags and the triangles sharing every vertex must be identical; vertex areas may differ by round-off because triangles are added in a different order. Leaves the fully recalculated geometry in place. Throws an exception if any quantity differs.*/
+//#########################################################################
+
+void Mesh::CheckChangedGeometry()
+{
+  int nTriangle = connectivity->triangleVertices->GetSize();
+  int nVertex = connectivity->vertexCoordinates->GetSize();
+
+  // Keep incremental results
+  Array<real2> *normalInc = new Array<real2>(3, cudaFlag, nTriangle);
+  normalInc->SetEqual(triangleEdgeNormals);
+  Array<real3> *lengthInc = new Array<real3>(1, cudaFlag, nTriangle);
+  lengthInc->SetEqual(triangleEdgeLength);
+  Array<real> *areaInc = new Array<real>(1, cudaFlag, nVertex);
+  areaInc->SetEqual(connectivity->vertexArea);
+  Array<int> *flagInc = new Array<int>(1, cudaFlag, nVertex);
+  flagInc->SetEqual(vertexBoundaryFlag);
+  Array<int> *vtInc =
+    new Array<int>(1, cudaFlag, connectivity->vertexTriangle->GetSize());
+  vtInc->SetEqual(connectivity->vertexTriangle);
+  Array<int> *offsetInc = new Array<int>(1, cudaFlag, nVertex + 1);
+  offsetInc->SetEqual(connectivity->vertexTriangleOffset);
+
+  CalcNormalEdge();
+  connectivity->CalcVertexTriangle();
+  connectivity->CalcVertexArea(GetPx(), GetPy());
+  FindBoundaryVertices();
+
+  // Compare full and incremental results on the host
+  Array<real2> *normalFull = new Array<real2>(3, cudaFlag, nTriangle);
+  normalFull->SetEqual(triangleEdgeNormals);
+  Array<real3> *lengthFull = new Array<real3>(1, cudaFlag, nTriangle);
+  lengthFull->SetEqual(triangleEdgeLength);
+  Array<real> *areaFull = new Array<real>(1, cudaFlag, nVertex);
+  areaFull->SetEqual(connectivity->vertexArea);
+  Array<int> *flagFull = new Array<int>(1, cudaFlag, nVertex);
+  flagFull->SetEqual(vertexBoundaryFlag);
+  Array<int> *vtFull =
+    new Array<int>(1, cudaFlag, connectivity->vertexTriangle->GetSize());
+  vtFull->SetEqual(connectivity->vertexTriangle);
+  Array<int> *offsetFull = new Array<int>(1, cudaFlag, nVertex + 1);
+  offsetFull->SetEqual(connectivity->vertexTriangleOffset);
+
+  if (cudaFlag == 1) {
+    normalInc->TransformToHost();
+    lengthInc->TransformToHost();
+    areaInc->TransformToHost();
+    flagInc->TransformToHost();
+    normalFull->TransformToHost();
+    lengthFull->TransformToHost();
+    areaFull->TransformToHost();
+    flagFull->TransformToHost();
+    vtInc->TransformToHost();
+    offsetInc->TransformToHost();
+    vtFull->TransformToHost();
+    offsetFull->TransformToHost();
+  }
+
+  int nWrongTriangle = 0;
+  for (int n = 0; n < nTriangle; n++) {
+    int wrong = 0;
+    for (int d = 0; d < 3; d++) {
+      real2 a = normalInc->GetPointer(d)[n];
+      real2 b = normalFull->GetPointer(d)[n];
+      if (a.x != b.x || a.y != b.y) wrong = 1;
+    }
+    real3 a = lengthInc->GetPointer()[n];
+    real3 b = lengthFull->GetPointer()[n];
+    if (a.x != b.x || a.y != b.y || a.z != b.z) wrong = 1;
+    nWrongTriangle += wrong;
+  }
+
+  int nWrongVertex = 0;
+  real *pAreaInc = areaInc->GetPointer();
+  real *pAreaFull = areaFull->GetPointer();
+  int *pFlagInc = flagInc->GetPointer();
+  int *pFlagFull = flagFull->GetPointer();
+  for (int i = 0; i < nVertex; i++)
+    if (pFlagInc[i] != pFlagFull[i] ||
+        std::abs(pAreaInc[i] - pAreaFull[i]) >
+        (real) 1.0e-4*std::abs(pAreaFull[i]))
+      nWrongVertex++;
+
+  // Triangles sharing every vertex must match exactly
+  int nWrongList = 0;
+  int *pVtInc = vtInc->GetPointer();
+  int *pOffsetInc = offsetInc->GetPointer();
+  int *pVtFull = vtFull->GetPointer();
+  int *pOffsetFull = offsetFull->GetPointer();
+  if (vtInc->GetSize() != vtFull->GetSize()) {
+    nWrongList = nVertex;
+  } else {
+    for (int i = 0; i < nVertex; i++) {
+      int wrong = (pOffsetInc[i] != pOffsetFull[i] ||
+                   pOffsetInc[i + 1] != pOffsetFull[i + 1]);
+      for (int j = pOffsetFull[i]; j < pOffsetFull[i + 1] && wrong == 0; j++)
+        if (pVtInc[j] != pVtFull[j]) wrong = 1;
+      nWrongList += wrong;
+    }
+  }
+
+  delete normalInc;
+  delete lengthInc;
+  delete areaInc;
+  delete flagInc;
+  delete normalFull;
+  delete lengthFull;
+  delete areaFull;
+  delete flagFull;
+  delete vtInc;
+  delete offsetInc;
+  delete vtFull;
+  delete offsetFull;
+
+  if (nWrongTriangle > 0 || nWrongVertex > 0 || nWrongList > 0) {
+    std::cout << "Error: incremental geometry update wrong for "
+              << nWrongTriangle << " triangles and "
+              << nWrongVertex << " vertices, triangle lists wrong for "
+              << nWrongList << " vertices" << std::endl;
+    throw std::runtime_error("");
+  }
+}
+
+}  // namespace astrix
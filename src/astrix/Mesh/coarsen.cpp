@@ -14,8 +14,9 @@ Astrix is distributed in the hope that it will be useful, but WITHOUT ANY WARRAN
 You should have received a copy of the GNU General Public License
 along with Astrix.  If not, see <http://www.gnu.org/licenses/>.
 */
-#include <cuda_runtime_api.h>
+#include "../Common/cudaRuntime.h"
 #include <iostream>
+#include <chrono>
 
 #include "../Common/definitions.h"
 #include "../Array/array.h"
@@ -43,12 +44,11 @@ int Mesh::RemoveVertices(Array<realNeq> *vertexState,
   // Return if skipping this time step
   if (nTimeStep % meshParameter->nStepSkipCoarsen != 0) return 0;
 
-  int nTriangle = connectivity->triangleVertices->GetSize();
-
-  triangleWantRefine->SetSize(nTriangle);
+  std::chrono::high_resolution_clock::time_point startTime =
+    std::chrono::high_resolution_clock::now();
 
   // Flag triangles if refinement / coarsening is needed
-  FillWantRefine<realNeq, CL>(vertexState, specificHeatRatio);
+  FillWantRefine<realNeq, CL>(vertexState, specificHeatRatio, nTimeStep);
 
   int nRemove =
     coarsen->RemoveVertices<realNeq, CL>(connectivity,
@@ -59,12 +59,25 @@ int Mesh::RemoveVertices(Array<realNeq> *vertexState,
                                          meshParameter,
                                          delaunay, 1);
 
+  // Triangles may have changed even if no vertices were removed
+  connectivity->CalcTriangleVerticesWrapped();
+
   if (nRemove > 0) {
     CalcNormalEdge();
     connectivity->CalcVertexArea(GetPx(), GetPy());
+    connectivity->CalcVertexTriangle();
+    connectivity->CalcTriangleColour();
     FindBoundaryVertices();
   }
 
+  // Triangles at boundary may have changed as well
+  FindBoundaryTriangles();
+
+  CountAdaptStep(nTimeStep);
+  nAdaptRemoved += nRemove;
+  adaptTime += std::chrono::duration<double>
+    (std::chrono::high_resolution_clock::now() - startTime).count();
+
   return nRemove;
 }
 
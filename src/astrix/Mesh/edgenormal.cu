@@ -31,7 +31,8 @@ namespace astrix {
 
 \param n Index of triangle to consider
 \param nTriangle Total number of triangles in Mesh
-\param *pTv Pointer to triangle vertices
+\param *pTv Pointer to triangle vertices without periodic images
+\param *pTs Pointer to periodic shift codes of triangles
 \param *pVc Pointer to vertex coordinates
 \param *pTn1 Pointer to triangle normals first edge (output)
 \param *pTn2 Pointer to triangle normals second edge (output)
@@ -43,7 +44,8 @@ namespace astrix {
 //######################################################################
 
 __host__ __device__
-void CalcNormalEdgeSingle(int n, int nTriangle, int3 *pTv, real2 *pVc,
+void CalcNormalEdgeSingle(int n, int nTriangle, int3 *pTv, int *pTs,
+                          real2 *pVc,
                           real2 *pTn1, real2 *pTn2, real2 *pTn3,
                           real3 *triL, int nVertex, real Px, real Py)
 {
@@ -55,9 +57,8 @@ void CalcNormalEdgeSingle(int n, int nTriangle, int3 *pTv, real2 *pVc,
   int c = pTv[n].z;
 
   real ax, bx, cx, ay, by, cy;
-  GetTriangleCoordinates(pVc, a, b, c,
-                         nVertex, Px, Py,
-                         ax, bx, cx, ay, by, cy);
+  GetTriangleCoordinatesWrapped(pVc, a, b, c, pTs[n], Px, Py,
+                                ax, bx, cx, ay, by, cy);
 
   // Vector along face
   real facedx = bx - cx;
@@ -137,7 +138,8 @@ void CalcNormalEdgeSingle(int n, int nTriangle, int3 *pTv, real2 *pVc,
 /*! \brief Kernel calculating normals and edge lengths for all triangles
 
 \param nTriangle Total number of triangles in Mesh
-\param *pTv Pointer to triangle vertices
+\param *pTv Pointer to triangle vertices without periodic images
+\param *pTs Pointer to periodic shift codes of triangles
 \param *pVc Pointer to vertex coordinates
 \param *pTn1 Pointer to triangle normals first edge (output)
 \param *pTn2 Pointer to triangle normals second edge (output)
@@ -149,7 +151,7 @@ void CalcNormalEdgeSingle(int n, int nTriangle, int3 *pTv, real2 *pVc,
 //######################################################################
 
 __global__ void
-devCalcNormalEdge(int nTriangle, int3 *pTv, real2 *pVc,
+devCalcNormalEdge(int nTriangle, int3 *pTv, int *pTs, real2 *pVc,
                   real2 *pTn1, real2 *pTn2, real2 *pTn3,
                   real3 *triL, int nVertex,
                   real Px, real Py)
@@ -158,7 +160,7 @@ devCalcNormalEdge(int nTriangle, int3 *pTv, real2 *pVc,
   int n = blockIdx.x*blockDim.x + threadIdx.x;
 
   while (n < nTriangle) {
-    CalcNormalEdgeSingle(n, nTriangle, pTv, pVc,
+    CalcNormalEdgeSingle(n, nTriangle, pTv, pTs, pVc,
                          pTn1, pTn2, pTn3,
                          triL, nVertex, Px, Py);
 
@@ -174,7 +176,8 @@ triangles in Mesh*/
 void Mesh::CalcNormalEdge()
 {
   real2 *pVc = connectivity->vertexCoordinates->GetPointer();
-  int3 *pTv = connectivity->triangleVertices->GetPointer();
+  int3 *pTv = connectivity->triangleVerticesWrapped->GetPointer();
+  int *pTs = connectivity->triangleShift->GetPointer();
 
   int nTriangle = connectivity->triangleVertices->GetSize();
   int nVertex = connectivity->vertexCoordinates->GetSize();
@@ -199,17 +202,207 @@ void Mesh::CalcNormalEdge()
                                        devCalcNormalEdge,
                                        (size_t) 0, 0);
 
-    devCalcNormalEdge<<<nBlocks, nThreads>>>
-      (nTriangle, pTv, pVc, pTn1, pTn2, pTn3, triL, nVertex, Px, Py);
+    LaunchKernel(nBlocks, nThreads, devCalcNormalEdge)
+      (nTriangle, pTv, pTs, pVc, pTn1, pTn2, pTn3, triL, nVertex, Px, Py);
 
     gpuErrchk( cudaPeekAtLastError() );
     gpuErrchk( cudaDeviceSynchronize() );
   } else {
+#pragma omp parallel for
     for (int n = 0; n < nTriangle; n++)
-      CalcNormalEdgeSingle(n, nTriangle, pTv, pVc,
+      CalcNormalEdgeSingle(n, nTriangle, pTv, pTs, pVc,
                            pTn1, pTn2, pTn3, triL,
                            nVertex, Px, Py);
   }
 }
 
+//######################################################################
+/*! \brief Kernel calculating normals and edge lengths for listed triangles
+
+\param nChanged Number of triangles in list
+\param *pTc Pointer to list of triangles to consider
+\param nTriangle Total number of triangles in Mesh
+\param *pTv Pointer to triangle vertices without periodic images
+\param *pTs Pointer to periodic shift codes of triangles
+\param *pVc Pointer to vertex coordinates
+\param *pTn1 Pointer to triangle normals first edge (output)
+\param *pTn2 Pointer to triangle normals second edge (output)
+\param *pTn3 Pointer to triangle normals third edge (output)
+\param *triL Pointer to array of triangle edge lengths (output)
+\param nVertex Total number of vertices in Mesh
+\param Px Periodic domain size x
+\param Py Periodic domain size y*/
+//######################################################################
+
+__global__ void
+devUpdateNormalEdge(int nChanged, int *pTc, int nTriangle,
+                    int3 *pTv, int *pTs, real2 *pVc,
+                    real2 *pTn1, real2 *pTn2, real2 *pTn3,
+                    real3 *triL, int nVertex,
+                    real Px, real Py)
+{
+  int i = blockIdx.x*blockDim.x + threadIdx.x;
+
+  while (i < nChanged) {
+    CalcNormalEdgeSingle(pTc[i], nTriangle, pTv, pTs, pVc,
+                         pTn1, pTn2, pTn3,
+                         triL, nVertex, Px, Py);
+
+    i += blockDim.x*gridDim.x;
+  }
+}
+
+//######################################################################
+/*! Calculate inward-pointing normals (length unity) and edge lengths for the
+triangles in \a triangleChanged only. Normals and edge lengths of all other
+triangles must still be valid, i.e. they have not changed and have not been
+reordered since the last call to CalcNormalEdge().
+
+\param nChanged Number of triangles in \a triangleChanged*/
+//######################################################################
+
+void Mesh::UpdateNormalEdge(int nChanged)
+{
+  real2 *pVc = connectivity->vertexCoordinates->GetPointer();
+  int3 *pTv = connectivity->triangleVerticesWrapped->GetPointer();
+  int *pTs = connectivity->triangleShift->GetPointer();
+  int *pTc = triangleChanged->GetPointer();
+
+  int nTriangle = connectivity->triangleVertices->GetSize();
+  int nVertex = connectivity->vertexCoordinates->GetSize();
+
+  triangleEdgeNormals->SetSize(nTriangle);
+  real2 *pTn1 = triangleEdgeNormals->GetPointer(0);
+  real2 *pTn2 = triangleEdgeNormals->GetPointer(1);
+  real2 *pTn3 = triangleEdgeNormals->GetPointer(2);
+
+  triangleEdgeLength->SetSize(nTriangle);
+  real3 *triL = triangleEdgeLength->GetPointer();
+
+  real Px = meshParameter->maxx - meshParameter->minx;
+  real Py = meshParameter->maxy - meshParameter->miny;
+
+  if (cudaFlag == 1) {
+    int nBlocks = 128;
+    int nThreads = 128;
+
+    // Base nThreads and nBlocks on maximum occupancy
+    cudaOccupancyMaxPotentialBlockSize(&nBlocks, &nThreads,
+                                       devUpdateNormalEdge,
+                                       (size_t) 0, 0);
+
+    LaunchKernel(nBlocks, nThreads, devUpdateNormalEdge)
+      (nChanged, pTc, nTriangle, pTv, pTs, pVc, pTn1, pTn2, pTn3, triL,
+       nVertex, Px, Py);
+
+    gpuErrchk( cudaPeekAtLastError() );
+    gpuErrchk( cudaDeviceSynchronize() );
+  } else {
+#pragma omp parallel for
+    for (int i = 0; i < nChanged; i++)
+      CalcNormalEdgeSingle(pTc[i], nTriangle, pTv, pTs, pVc,
+                           pTn1, pTn2, pTn3, triL,
+                           nVertex, Px, Py);
+  }
+}
+
+//######################################################################
+/*! \brief Calculate minimum edge length of triangle \a n
+
+\param n Index of triangle to consider
+\param *pTv Pointer to triangle vertices
+\param *pVc Pointer to vertex coordinates
+\param nVertex Total number of vertices in Mesh
+\param Px Periodic domain size x
+\param Py Periodic domain size y
+\param *pTl Pointer to minimum edge length of triangles (output)*/
+//######################################################################
+
+__host__ __device__
+void CalcMinEdgeLengthSingle(int n, const int3 *pTv, const real2 *pVc,
+                             int nVertex, real Px, real Py, real *pTl)
+{
+  real ax, bx, cx, ay, by, cy;
+  GetTriangleCoordinates(pVc, pTv[n].x, pTv[n].y, pTv[n].z,
+                         nVertex, Px, Py,
+                         ax, bx, cx, ay, by, cy);
+
+  // Three edges
+  real l1 = sqrt((ax - bx)*(ax - bx) + (ay - by)*(ay - by));
+  real l2 = sqrt((ax - cx)*(ax - cx) + (ay - cy)*(ay - cy));
+  real l3 = sqrt((cx - bx)*(cx - bx) + (cy - by)*(cy - by));
+
+  pTl[n] = min(l1, min(l2, l3));
+}
+
+//######################################################################
+/*! \brief Kernel calculating minimum edge length of all triangles
+
+\param nTriangle Total number of triangles in Mesh
+\param *pTv Pointer to triangle vertices
+\param *pVc Pointer to vertex coordinates
+\param nVertex Total number of vertices in Mesh
+\param Px Periodic domain size x
+\param Py Periodic domain size y
+\param *pTl Pointer to minimum edge length of triangles (output)*/
+//######################################################################
+
+__global__ void
+devCalcMinEdgeLength(int nTriangle, const int3 *pTv, const real2 *pVc,
+                     int nVertex, real Px, real Py, real *pTl)
+{
+  int n = blockIdx.x*blockDim.x + threadIdx.x;
+
+  while (n < nTriangle) {
+    CalcMinEdgeLengthSingle(n, pTv, pVc, nVertex, Px, Py, pTl);
+
+    n += gridDim.x*blockDim.x;
+  }
+}
+
+//######################################################################
+/*! Return the length of the shortest edge in the Mesh. Computed where the Mesh lives, so no data is copied between device and host.*/
+//######################################################################
+
+real Mesh::MinimumEdgeLength()
+{
+  const real2 *pVc = connectivity->vertexCoordinates->GetPointer();
+  const int3 *pTv = connectivity->triangleVertices->GetPointer();
+
+  int nTriangle = connectivity->triangleVertices->GetSize();
+  int nVertex = connectivity->vertexCoordinates->GetSize();
+
+  real Px = meshParameter->maxx - meshParameter->minx;
+  real Py = meshParameter->maxy - meshParameter->miny;
+
+  triangleMinEdgeLength->SetSize(nTriangle);
+  real *pTl = triangleMinEdgeLength->GetPointer();
+
+  if (cudaFlag == 1) {
+    int nBlocks = 128;
+    int nThreads = 128;
+
+    // Base nThreads and nBlocks on maximum occupancy
+    cudaOccupancyMaxPotentialBlockSize(&nBlocks, &nThreads,
+                                       devCalcMinEdgeLength,
+                                       (size_t) 0, 0);
+
+    LaunchKernel(nBlocks, nThreads, devCalcMinEdgeLength)
+      (nTriangle, pTv, pVc, nVertex, Px, Py, pTl);
+
+    gpuErrchk( cudaPeekAtLastError() );
+    gpuErrchk( cudaDeviceSynchronize() );
+  } else {
+#pragma omp parallel for
+    for (int n = 0; n < nTriangle; n++)
+      CalcMinEdgeLengthSingle(n, pTv, pVc, nVertex, Px, Py, pTl);
+  }
+
+  real minEdgeLength = Px;
+  if (nTriangle > 0)
+    minEdgeLength = std::min(minEdgeLength, triangleMinEdgeLength->Minimum());
+
+  return minEdgeLength;
+}
+
 }  // namespace astrix
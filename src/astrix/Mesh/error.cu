@@ -62,12 +62,6 @@ void CalcOperatorEnergySingle(int i, int nVertex, int nTriangle,
   int a = pTv[i].x;
   int b = pTv[i].y;
   int c = pTv[i].z;
-  while (a >= nVertex) a -= nVertex;
-  while (b >= nVertex) b -= nVertex;
-  while (c >= nVertex) c -= nVertex;
-  while (a < 0) a += nVertex;
-  while (b < 0) b += nVertex;
-  while (c < 0) c += nVertex;
 
   // Triangle edge lengths
   real tl1 = triL[i].x;
@@ -167,12 +161,6 @@ void CalcOperatorEnergySingle(int i, int nVertex, int nTriangle,
   int a = pTv[i].x;
   int b = pTv[i].y;
   int c = pTv[i].z;
-  while (a >= nVertex) a -= nVertex;
-  while (b >= nVertex) b -= nVertex;
-  while (c >= nVertex) c -= nVertex;
-  while (a < 0) a += nVertex;
-  while (b < 0) b += nVertex;
-  while (c < 0) c += nVertex;
 
   // Triangle edge lengths
   real tl1 = triL[i].x;
@@ -236,12 +224,6 @@ void CalcErrorEstimateSingle(int i, int nVertex, int3 *pTv,
   int a = pTv[i].x;
   int b = pTv[i].y;
   int c = pTv[i].z;
-  while (a >= nVertex) a -= nVertex;
-  while (b >= nVertex) b -= nVertex;
-  while (c >= nVertex) c -= nVertex;
-  while (a < 0) a += nVertex;
-  while (b < 0) b += nVertex;
-  while (c < 0) c += nVertex;
 
   // Error estimate at vertices
   real E1 = fabs(pVertexOperator[a] - pTriangleOperator[i]);
@@ -280,7 +262,7 @@ devCalcOperatorEnergy(int nVertex, int nTriangle,
                       real *pVertexOperator,
                       real *pTriangleOperator)
 {
-  unsigned int i = blockIdx.x*blockDim.x + threadIdx.x;
+  int i = blockIdx.x*blockDim.x + threadIdx.x;
 
   while (i < nTriangle) {
     CalcOperatorEnergySingle(i, nVertex, nTriangle, pTv, G, triL,
@@ -311,7 +293,7 @@ devCalcErrorEstimate(int nTriangle, int nVertex, int3 *pTv,
                      real *pTriangleOperator,
                      real *pErrorEstimate)
 {
-  unsigned int i = blockIdx.x*blockDim.x + threadIdx.x;
+  int i = blockIdx.x*blockDim.x + threadIdx.x;
 
   while (i < nTriangle) {
     CalcErrorEstimateSingle(i, nVertex, pTv,
@@ -338,7 +320,7 @@ void Mesh::CalcErrorEstimate(Array<realNeq> *vertexState, real G)
   int nVertex = connectivity->vertexCoordinates->GetSize();
 
   // Triangle vertex indices
-  int3 *pTv = connectivity->triangleVertices->GetPointer();
+  int3 *pTv = connectivity->triangleVerticesWrapped->GetPointer();
 
   // Inward pointing edge normals
   real2 *pTn1 = triangleEdgeNormals->GetPointer(0);
@@ -380,7 +362,7 @@ void Mesh::CalcErrorEstimate(Array<realNeq> *vertexState, real G)
                                        devCalcOperatorEnergy<realNeq, CL>,
                                        (size_t) 0, 0);
 
-    devCalcOperatorEnergy<realNeq, CL><<<nBlocks, nThreads>>>
+    LaunchKernel(nBlocks, nThreads, devCalcOperatorEnergy<realNeq, CL>)
       (nVertex, nTriangle, pTv, G, triL,
        pTn1, pTn2, pTn3,
        pVertexArea, state,
@@ -406,7 +388,7 @@ void Mesh::CalcErrorEstimate(Array<realNeq> *vertexState, real G)
                                        devCalcErrorEstimate,
                                        (size_t) 0, 0);
 
-    devCalcErrorEstimate<<<nBlocks, nThreads>>>
+    LaunchKernel(nBlocks, nThreads, devCalcErrorEstimate)
       (nTriangle, nVertex, pTv,
        pVertexOperator, pTriangleOperator,
        pErrorEstimate);
@@ -414,6 +396,7 @@ void Mesh::CalcErrorEstimate(Array<realNeq> *vertexState, real G)
     gpuErrchk( cudaPeekAtLastError() );
     gpuErrchk( cudaDeviceSynchronize() );
   } else {
+#pragma omp parallel for
     for (int i = 0; i < nTriangle; i++)
       CalcErrorEstimateSingle(i, nVertex, pTv,
                               pVertexOperator, pTriangleOperator,
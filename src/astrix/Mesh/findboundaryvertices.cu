@@ -163,6 +163,119 @@ devFindBoundaries(int nTriangle, int3 *pTv, int nVertex,
   }
 }
 
+//######################################################################
+/*! \brief Flag whether vertex \a i lies on boundary
+
+\param i Index of vertex to consider
+\param *pVertexBoundaryFlag Pointer to array of boundary flags
+\param *pFlag Pointer to output flags: 1 if vertex on boundary, 0 otherwise*/
+//######################################################################
+
+__host__ __device__
+void FlagBoundaryVertexSingle(int i, int *pVertexBoundaryFlag, int *pFlag)
+{
+  pFlag[i] = (pVertexBoundaryFlag[i] != 0);
+}
+
+//######################################################################
+/*! \brief Kernel flagging vertices on boundary
+
+\param nVertex Total number of vertices in Mesh
+\param *pVertexBoundaryFlag Pointer to array of boundary flags
+\param *pFlag Pointer to output flags: 1 if vertex on boundary, 0 otherwise*/
+//######################################################################
+
+__global__ void
+devFlagBoundaryVertex(int nVertex, int *pVertexBoundaryFlag, int *pFlag)
+{
+  // n = vertex number
+  int n = blockIdx.x*blockDim.x + threadIdx.x;
+
+  while (n < nVertex) {
+    FlagBoundaryVertexSingle(n, pVertexBoundaryFlag, pFlag);
+
+    n += blockDim.x*gridDim.x;
+  }
+}
+
+//######################################################################
+/*! \brief Flag whether triangle \a n touches boundary
+
+\param n Triangle to consider
+\param *pTv Pointer to triangle vertices without periodic images
+\param *pEt Pointer to edge triangles
+\param *pTe Pointer to triangle edges
+\param *pVertexBoundaryFlag Pointer to array of boundary flags
+\param *pBoundaryFlag Pointer to output flags: 1 if any vertex of triangle lies on boundary, 0 otherwise
+\param *pSegmentFlag Pointer to output flags: 1 if any edge of triangle lies on boundary, 0 otherwise*/
+//######################################################################
+
+__host__ __device__
+void FlagBoundaryTriangleSingle(int n, int3 *pTv, int2 *pEt, int3 *pTe,
+                                int *pVertexBoundaryFlag,
+                                int *pBoundaryFlag, int *pSegmentFlag)
+{
+  pBoundaryFlag[n] = (pVertexBoundaryFlag[pTv[n].x] != 0 ||
+                      pVertexBoundaryFlag[pTv[n].y] != 0 ||
+                      pVertexBoundaryFlag[pTv[n].z] != 0);
+
+  int e1 = pTe[n].x;
+  int e2 = pTe[n].y;
+  int e3 = pTe[n].z;
+
+  pSegmentFlag[n] = (pEt[e1].x == -1 || pEt[e1].y == -1 ||
+                     pEt[e2].x == -1 || pEt[e2].y == -1 ||
+                     pEt[e3].x == -1 || pEt[e3].y == -1);
+}
+
+//######################################################################
+/*! \brief Kernel flagging triangles touching boundary
+
+\param nTriangle Total number of triangles in Mesh
+\param *pTv Pointer to triangle vertices without periodic images
+\param *pEt Pointer to edge triangles
+\param *pTe Pointer to triangle edges
+\param *pVertexBoundaryFlag Pointer to array of boundary flags
+\param *pBoundaryFlag Pointer to output flags: 1 if any vertex of triangle lies on boundary, 0 otherwise
+\param *pSegmentFlag Pointer to output flags: 1 if any edge of triangle lies on boundary, 0 otherwise*/
+//######################################################################
+
+__global__ void
+devFlagBoundaryTriangle(int nTriangle, int3 *pTv, int2 *pEt, int3 *pTe,
+                        int *pVertexBoundaryFlag,
+                        int *pBoundaryFlag, int *pSegmentFlag)
+{
+  // n = triangle number
+  int n = blockIdx.x*blockDim.x + threadIdx.x;
+
+  while (n < nTriangle) {
+    FlagBoundaryTriangleSingle(n, pTv, pEt, pTe, pVertexBoundaryFlag,
+                               pBoundaryFlag, pSegmentFlag);
+
+    n += blockDim.x*gridDim.x;
+  }
+}
+
+//######################################################################
+/*! \brief Fill \a list with all indices \a i for which \a flag[i] == 1, in increasing order
+
+\param *flag Array of flags (0 or 1)
+\param *list Output list
+\param *flagScan Workspace for exclusive scan of \a flag*/
+//######################################################################
+
+void FlagToList(Array<int> *flag, Array<int> *list, Array<int> *flagScan)
+{
+  int N = flag->GetSize();
+
+  flagScan->SetSize(N);
+  int nList = flag->ExclusiveScan(flagScan, N);
+
+  list->SetSize(N);
+  list->SetToSeries();
+  list->Compact(nList, flag, flagScan);
+}
+
 //######################################################################
 /*! Find vertices at boundaries; useful for setting boundary conditions. On
 return, \a vertexBoundaryFlag is -1 if vertex not on boundary, otherwise 0 and then +1 if on left boundary, +2 if on right boundary, +4 if on bottom boundary, +8 if on top bpoundary; i.e. 10 indicates a vertex both on top and right boundary*/
@@ -197,7 +310,7 @@ void Mesh::FindBoundaryVertices()
                                        devFindBoundaries,
                                        (size_t) 0, 0);
 
-    devFindBoundaries<<<nBlocks, nThreads>>>
+    LaunchKernel(nBlocks, nThreads, devFindBoundaries)
       (nTriangle, pTv, nVertex, pEt, pTe, pVertexBoundaryFlag);
 
     gpuErrchk( cudaPeekAtLastError() );
@@ -217,17 +330,236 @@ void Mesh::FindBoundaryVertices()
                                        devFillBoundaryFlag,
                                        (size_t) 0, 0);
 
-    devFillBoundaryFlag<<<nBlocks, nThreads>>>
+    LaunchKernel(nBlocks, nThreads, devFillBoundaryFlag)
       (nVertex, pVc, minx, miny, maxx, maxy,
        pVertexBoundaryFlag);
 
     gpuErrchk( cudaPeekAtLastError() );
     gpuErrchk( cudaDeviceSynchronize() );
   } else {
+#pragma omp parallel for
     for (int i = 0; i < nVertex; i++)
       FillBoundaryFlagSingle(i, pVc, minx, miny, maxx, maxy,
                              pVertexBoundaryFlag);
   }
+
+  ListBoundaryVertices();
+}
+
+//######################################################################
+/*! Make list of vertices on the boundary (\a boundaryVertices) from \a vertexBoundaryFlag, so that boundary conditions need not consider the whole Mesh.*/
+//######################################################################
+
+void Mesh::ListBoundaryVertices()
+{
+  int nVertex = connectivity->vertexCoordinates->GetSize();
+  int *pVertexBoundaryFlag = vertexBoundaryFlag->GetPointer();
+
+  Array<int> *vertexFlag = new Array<int>(1, cudaFlag, nVertex);
+  int *pVertexFlag = vertexFlag->GetPointer();
+
+  if (cudaFlag == 1) {
+    int nBlocks = 128;
+    int nThreads = 128;
+
+    // Base nThreads and nBlocks on maximum occupancy
+    cudaOccupancyMaxPotentialBlockSize(&nBlocks, &nThreads,
+                                       devFlagBoundaryVertex,
+                                       (size_t) 0, 0);
+
+    LaunchKernel(nBlocks, nThreads, devFlagBoundaryVertex)
+      (nVertex, pVertexBoundaryFlag, pVertexFlag);
+
+    gpuErrchk( cudaPeekAtLastError() );
+    gpuErrchk( cudaDeviceSynchronize() );
+  } else {
+#pragma omp parallel for
+    for (int i = 0; i < nVertex; i++)
+      FlagBoundaryVertexSingle(i, pVertexBoundaryFlag, pVertexFlag);
+  }
+
+  FlagToList(vertexFlag, boundaryVertices, flagScan);
+
+  delete vertexFlag;
+}
+
+//######################################################################
+/*! \brief Kernel finding vertices lying at boundaries for listed triangles
+
+\param nChanged Number of triangles in list
+\param *pTc Pointer to list of triangles
+\param *pTv Pointer to triangle vertices
+\param nVertex Total number of vertices in Mesh
+\param *pEt Pointer to edge triangles
+\param *pTe Pointer to triangle edges
+\param *pVertexBoundaryFlag Pointer to array of boundary flags: set to -1 if vertex on boundary*/
+//######################################################################
+
+__global__ void
+devUpdateBoundaries(int nChanged, int *pTc, int3 *pTv, int nVertex,
+                    int2 *pEt, int3 *pTe, int *pVertexBoundaryFlag)
+{
+  int i = blockIdx.x*blockDim.x + threadIdx.x;
+
+  while (i < nChanged) {
+    FindBoundariesSingle(pTc[i], pTv, nVertex, pEt, pTe,
+                         pVertexBoundaryFlag);
+
+    i += blockDim.x*gridDim.x;
+  }
+}
+
+//######################################################################
+/*! \brief Kernel separating boundaries left/right/top/bottom for listed vertices
+
+\param nChangedVertex Number of vertices in list
+\param *pVl Pointer to list of vertices
+\param *pVc Pointer to vertex coordinates
+\param minx Left x boundary
+\param maxx Right x boundary
+\param miny Left y boundary
+\param maxy Right y boundary
+\param *pVertexBoundaryFlag Pointer to array of boundary flags*/
+//######################################################################
+
+__global__ void
+devUpdateBoundaryFlag(int nChangedVertex, int *pVl, real2 *pVc,
+                      real minx, real miny, real maxx, real maxy,
+                      int *pVertexBoundaryFlag)
+{
+  int i = blockIdx.x*blockDim.x + threadIdx.x;
+
+  while (i < nChangedVertex) {
+    FillBoundaryFlagSingle(pVl[i], pVc, minx, miny, maxx, maxy,
+                           pVertexBoundaryFlag);
+
+    i += blockDim.x*gridDim.x;
+  }
+}
+
+//######################################################################
+/*! Update \a vertexBoundaryFlag after refinement, considering only the triangles in \a triangleChanged and the vertices in \a vertexChanged. Refinement only adds vertices and never removes a boundary edge, so that flags of vertices outside \a vertexChanged remain valid. Vertices flagged -1 by changed boundary edges are all in \a vertexChanged and get their final flag from their coordinates as in FindBoundaryVertices().
+
+\param nChangedVertex Number of vertices in \a vertexChanged
+\param nChanged Number of triangles in \a triangleChanged
+\param nVertexOld Number of vertices before refinement*/
+//######################################################################
+
+void Mesh::UpdateBoundaryVertices(int nChangedVertex, int nChanged,
+                                  int nVertexOld)
+{
+  int nVertex = connectivity->vertexCoordinates->GetSize();
+
+  real2 *pVc = connectivity->vertexCoordinates->GetPointer();
+  int3 *pTv = connectivity->triangleVertices->GetPointer();
+  int3 *pTe = connectivity->triangleEdges->GetPointer();
+  int2 *pEt = connectivity->edgeTriangles->GetPointer();
+  int *pTc = triangleChanged->GetPointer();
+  int *pVl = vertexChanged->GetPointer();
+
+  vertexBoundaryFlag->SetSize(nVertex);
+  if (nVertexOld < nVertex)
+    vertexBoundaryFlag->SetToValue(0, nVertexOld, nVertex);
+  int *pVertexBoundaryFlag = vertexBoundaryFlag->GetPointer();
+
+  real minx = meshParameter->minx;
+  real maxx = meshParameter->maxx;
+  real miny = meshParameter->miny;
+  real maxy = meshParameter->maxy;
+
+  // Find boundaries
+  if (cudaFlag == 1) {
+    int nBlocks = 128;
+    int nThreads = 128;
+
+    // Base nThreads and nBlocks on maximum occupancy
+    cudaOccupancyMaxPotentialBlockSize(&nBlocks, &nThreads,
+                                       devUpdateBoundaries,
+                                       (size_t) 0, 0);
+
+    LaunchKernel(nBlocks, nThreads, devUpdateBoundaries)
+      (nChanged, pTc, pTv, nVertex, pEt, pTe, pVertexBoundaryFlag);
+
+    gpuErrchk( cudaPeekAtLastError() );
+    gpuErrchk( cudaDeviceSynchronize() );
+  } else {
+    for (int i = 0; i < nChanged; i++)
+      FindBoundariesSingle(pTc[i], pTv, nVertex, pEt, pTe,
+                           pVertexBoundaryFlag);
+  }
+
+  // Fill boundary flags
+  if (cudaFlag == 1) {
+    int nBlocks = 128;
+    int nThreads = 128;
+
+    // Base nThreads and nBlocks on maximum occupancy
+    cudaOccupancyMaxPotentialBlockSize(&nBlocks, &nThreads,
+                                       devUpdateBoundaryFlag,
+                                       (size_t) 0, 0);
+
+    LaunchKernel(nBlocks, nThreads, devUpdateBoundaryFlag)
+      (nChangedVertex, pVl, pVc, minx, miny, maxx, maxy,
+       pVertexBoundaryFlag);
+
+    gpuErrchk( cudaPeekAtLastError() );
+    gpuErrchk( cudaDeviceSynchronize() );
+  } else {
+#pragma omp parallel for
+    for (int i = 0; i < nChangedVertex; i++)
+      FillBoundaryFlagSingle(pVl[i], pVc, minx, miny, maxx, maxy,
+                             pVertexBoundaryFlag);
+  }
+
+  ListBoundaryVertices();
+}
+
+//######################################################################
+/*! Find triangles with a vertex on the boundary (\a boundaryTriangles) and triangles with an edge on the boundary (\a segmentTriangles). Needs to be called whenever triangles change, even if \a vertexBoundaryFlag does not.*/
+//######################################################################
+
+void Mesh::FindBoundaryTriangles()
+{
+  int nTriangle = connectivity->triangleVertices->GetSize();
+
+  int3 *pTv = connectivity->triangleVerticesWrapped->GetPointer();
+  int3 *pTe = connectivity->triangleEdges->GetPointer();
+  int2 *pEt = connectivity->edgeTriangles->GetPointer();
+
+  int *pVertexBoundaryFlag = vertexBoundaryFlag->GetPointer();
+
+  Array<int> *boundaryFlag = new Array<int>(1, cudaFlag, nTriangle);
+  Array<int> *segmentFlag = new Array<int>(1, cudaFlag, nTriangle);
+  int *pBoundaryFlag = boundaryFlag->GetPointer();
+  int *pSegmentFlag = segmentFlag->GetPointer();
+
+  if (cudaFlag == 1) {
+    int nBlocks = 128;
+    int nThreads = 128;
+
+    // Base nThreads and nBlocks on maximum occupancy
+    cudaOccupancyMaxPotentialBlockSize(&nBlocks, &nThreads,
+                                       devFlagBoundaryTriangle,
+                                       (size_t) 0, 0);
+
+    LaunchKernel(nBlocks, nThreads, devFlagBoundaryTriangle)
+      (nTriangle, pTv, pEt, pTe, pVertexBoundaryFlag,
+       pBoundaryFlag, pSegmentFlag);
+
+    gpuErrchk( cudaPeekAtLastError() );
+    gpuErrchk( cudaDeviceSynchronize() );
+  } else {
+#pragma omp parallel for
+    for (int n = 0; n < nTriangle; n++)
+      FlagBoundaryTriangleSingle(n, pTv, pEt, pTe, pVertexBoundaryFlag,
+                                 pBoundaryFlag, pSegmentFlag);
+  }
+
+  FlagToList(boundaryFlag, boundaryTriangles, flagScan);
+  FlagToList(segmentFlag, segmentTriangles, flagScan);
+
+  delete boundaryFlag;
+  delete segmentFlag;
 }
 
 }  // namespace astrix
@@ -13,10 +13,10 @@ Astrix is distributed in the hope that it will be useful, but WITHOUT ANY WARRAN
 
 You should have received a copy of the GNU General Public License
 along with Astrix.  If not, see <http://www.gnu.org/licenses/>.*/
-#include <cuda_runtime_api.h>
-#include <cuda_profiler_api.h>
+#include "../Common/cudaRuntime.h"
 #include <iostream>
 #include <fstream>
+#include <chrono>
 #include <cmath>
 
 #include "../Common/definitions.h"
@@ -26,7 +26,6 @@ along with Astrix.  If not, see <http://www.gnu.org/licenses/>.*/
 #include "./Refine/refine.h"
 #include "./Connectivity/connectivity.h"
 #include "./Param/meshparameter.h"
-#include "./triangleLow.h"
 
 namespace astrix {
 
@@ -44,16 +43,22 @@ int Mesh::ImproveQuality(Array<realNeq> *vertexState,
 {
   if (nTimeStep % meshParameter->nStepSkipRefine != 0) return 0;
 
-  int nTriangle = connectivity->triangleVertices->GetSize();
-  int nVertex = connectivity->vertexCoordinates->GetSize();
-  int nEdge = connectivity->edgeTriangles->GetSize();
+  std::chrono::high_resolution_clock::time_point startTime =
+    std::chrono::high_resolution_clock::now();
 
   int nAdded = 0;
 
+  int nVertexOld = connectivity->vertexCoordinates->GetSize();
+  int nTriangleOld = connectivity->triangleVertices->GetSize();
+  int nMortonOld = morton->GetNOrder();
+
   // Flag triangles if refinement is needed
   if (vertexState != 0) {
-    triangleWantRefine->SetSize(nTriangle);
-    FillWantRefine<realNeq, CL>(vertexState, specificHeatRatio);
+    FillWantRefine<realNeq, CL>(vertexState, specificHeatRatio, nTimeStep);
+
+    // Keep triangles to find out which ones refinement changes
+    triangleVerticesOld->SetSize(nTriangleOld);
+    triangleVerticesOld->SetEqual(connectivity->triangleVertices);
 
     nAdded = refine->ImproveQuality<realNeq, CL>(connectivity,
                                                  meshParameter,
@@ -81,52 +86,52 @@ int Mesh::ImproveQuality(Array<realNeq> *vertexState,
     }
   }
 
-  nVertex = connectivity->vertexCoordinates->GetSize();
-  nTriangle = connectivity->triangleVertices->GetSize();
-  nEdge = connectivity->edgeTriangles->GetSize();
-
   // Minimum edge length
-
-  if (cudaFlag == 1) {
-    connectivity->vertexCoordinates->CopyToHost();
-    connectivity->triangleVertices->CopyToHost();
-  }
-
-  real2 *pVc = connectivity->vertexCoordinates->GetHostPointer();
-  int3 *pTv = connectivity->triangleVertices->GetHostPointer();
-
   real Px = meshParameter->maxx - meshParameter->minx;
-  real Py = meshParameter->maxy - meshParameter->miny;
-
-  real minEdgeLength = Px;
+  std::cout << "L/lmin = " << Px/MinimumEdgeLength() << std::endl;
 
-  for (int i = 0; i < nTriangle; i++) {
-    int a = pTv[i].x;
-    int b = pTv[i].y;
-    int c = pTv[i].z;
+  // Triangles may have changed even if no vertices were added
+  connectivity->CalcTriangleVerticesWrapped();
 
-    real ax, bx, cx, ay, by, cy;
-    GetTriangleCoordinates(pVc, a, b, c,
-                           nVertex, Px, Py,
-                           ax, bx, cx, ay, by, cy);
-
-    // Three edges
-    real l1 = sqrt((ax - bx)*(ax - bx) + (ay - by)*(ay - by));
-    real l2 = sqrt((ax - cx)*(ax - cx) + (ay - cy)*(ay - cy));
-    real l3 = sqrt((cx - bx)*(cx - bx) + (cy - by)*(cy - by));
-
-    real lmin = std::min(l1, std::min(l2, l3));
-
-    minEdgeLength = std::min(minEdgeLength, lmin);
+  if (nAdded > 0) {
+    if (vertexState != 0 && morton->GetNOrder() == nMortonOld) {
+      // No reordering: only update triangles changed by refinement
+      int nChanged = FindChangedTriangles(nTriangleOld, nVertexOld);
+      int nChangedVertex = FindChangedVertices(nChanged);
+      UpdateNormalEdge(nChanged);
+      connectivity->UpdateVertexTriangle(triangleChanged, nChanged,
+                                         triangleChangedFlag,
+                                         vertexChangedFlag);
+      connectivity->UpdateVertexArea(vertexChanged, nChangedVertex,
+                                     GetPx(), GetPy());
+      // Colouring is only needed by the scatter path; redo when asked for
+      connectivity->InvalidateTriangleColour();
+      UpdateBoundaryVertices(nChangedVertex, nChanged, nVertexOld);
+      if (debugLevel > 0) CheckChangedGeometry();
+
+      if (verboseLevel > 1)
+        std::cout << "Geometry updated for " << nChanged << " of "
+                  << connectivity->triangleVertices->GetSize()
+                  << " triangles" << std::endl;
+    } else {
+      // Calculate triangle normals and areas
+      CalcNormalEdge();
+      connectivity->CalcVertexArea(GetPx(), GetPy());
+      connectivity->CalcVertexTriangle();
+      connectivity->InvalidateTriangleColour();
+      FindBoundaryVertices();
+    }
   }
 
-  std::cout << "L/lmin = " << Px/minEdgeLength << std::endl;
+  // Triangles at boundary may have changed as well
+  FindBoundaryTriangles();
 
-  if (nAdded > 0) {
-    // Calculate triangle normals and areas
-    CalcNormalEdge();
-    connectivity->CalcVertexArea(GetPx(), GetPy());
-    FindBoundaryVertices();
+  // Only count refinement driven by the state, not initial mesh construction
+  if (vertexState != 0) {
+    CountAdaptStep(nTimeStep);
+    nAdaptAdded += nAdded;
+    adaptTime += std::chrono::duration<double>
+      (std::chrono::high_resolution_clock::now() - startTime).count();
   }
 
   return nAdded;
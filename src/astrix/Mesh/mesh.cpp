@@ -14,12 +14,13 @@ Astrix is distributed in the hope that it will be useful, but WITHOUT ANY WARRAN
 You should have received a copy of the GNU General Public License
 along with Astrix.  If not, see <http://www.gnu.org/licenses/>.*/
 
-#include <cuda_runtime_api.h>
+#include "../Common/cudaRuntime.h"
 #include <iostream>
 #include <fstream>
 #include <sstream>
 #include <stdexcept>
 #include <cmath>
+#include <iomanip>
 
 #include "../Common/definitions.h"
 #include "../Array/array.h"
@@ -62,11 +63,32 @@ Mesh::Mesh(int meshVerboseLevel, int meshDebugLevel, int meshCudaFlag,
 
   // Define arrays
   vertexBoundaryFlag = new Array<int>(1, cudaFlag);
+  boundaryVertices = new Array<int>(1, cudaFlag);
+  boundaryTriangles = new Array<int>(1, cudaFlag);
+  segmentTriangles = new Array<int>(1, cudaFlag);
 
-  triangleWantRefine = new Array<int>(1, cudaFlag);
+  // Second dimension holds refinement levels, so that these follow the
+  // triangles through every reordering, insertion and compaction
+  triangleWantRefine = new Array<int>(2, cudaFlag);
   triangleEdgeNormals = new Array<real2>(3, cudaFlag);
   triangleEdgeLength = new Array<real3>(1, cudaFlag);
   triangleErrorEstimate = new Array<real>(1, cudaFlag);
+  triangleBuffer = new Array<int>(1, cudaFlag);
+  triangleBufferNew = new Array<int>(1, cudaFlag);
+  triangleMinEdgeLength = new Array<real>(1, cudaFlag);
+  triangleVerticesOld = new Array<int3>(1, cudaFlag);
+  triangleChanged = new Array<int>(1, cudaFlag);
+  vertexChanged = new Array<int>(1, cudaFlag);
+  triangleChangedFlag = new Array<int>(1, cudaFlag);
+  vertexChangedFlag = new Array<int>(1, cudaFlag);
+  flagScan = new Array<int>(1, cudaFlag);
+
+  nAdaptAdded = 0;
+  nAdaptRemoved = 0;
+  nAdaptStep = 0;
+  lastAdaptStep = -1;
+  lastLevelStep = -1;
+  adaptTime = 0.0;
 
   try {
     Init(fileName, restartNumber);
@@ -76,11 +98,23 @@ Mesh::Mesh(int meshVerboseLevel, int meshDebugLevel, int meshCudaFlag,
 
     // Clean up; destructor won't be called
     delete vertexBoundaryFlag;
+    delete boundaryVertices;
+    delete boundaryTriangles;
+    delete segmentTriangles;
 
     delete triangleWantRefine;
     delete triangleEdgeNormals;
     delete triangleEdgeLength;
     delete triangleErrorEstimate;
+    delete triangleBuffer;
+    delete triangleBufferNew;
+    delete triangleMinEdgeLength;
+    delete triangleVerticesOld;
+    delete triangleChanged;
+    delete vertexChanged;
+    delete triangleChangedFlag;
+    delete vertexChangedFlag;
+    delete flagScan;
 
     delete predicates;
     delete morton;
@@ -101,11 +135,23 @@ Mesh::Mesh(int meshVerboseLevel, int meshDebugLevel, int meshCudaFlag,
 Mesh::~Mesh()
 {
   delete vertexBoundaryFlag;
+  delete boundaryVertices;
+  delete boundaryTriangles;
+  delete segmentTriangles;
 
   delete triangleWantRefine;
   delete triangleEdgeNormals;
   delete triangleEdgeLength;
   delete triangleErrorEstimate;
+  delete triangleBuffer;
+  delete triangleBufferNew;
+  delete triangleMinEdgeLength;
+  delete triangleVerticesOld;
+  delete triangleChanged;
+  delete vertexChanged;
+  delete triangleChangedFlag;
+  delete vertexChangedFlag;
+  delete flagScan;
 
   delete predicates;
   delete morton;
@@ -265,6 +311,15 @@ int Mesh::IsAdaptive()
   return meshParameter->adaptiveMeshFlag;
 }
 
+//#########################################################################
+// Return number of time steps between adaptations during the run
+//#########################################################################
+
+int Mesh::GetAdaptInterval()
+{
+  return meshParameter->nStepAdapt;
+}
+
 //#########################################################################
 // Return total vertex area
 //#########################################################################
@@ -284,6 +339,16 @@ const int* Mesh::VertexBoundaryFlagData()
   return vertexBoundaryFlag->GetPointer();
 }
 
+int Mesh::GetNBoundaryVertex()
+{
+  return boundaryVertices->GetSize();
+}
+
+const int* Mesh::BoundaryVertexData()
+{
+  return boundaryVertices->GetPointer();
+}
+
 const real* Mesh::VertexAreaData()
 {
   return connectivity->vertexArea->GetPointer();
@@ -299,6 +364,16 @@ const int3* Mesh::TriangleVerticesData()
   return connectivity->triangleVertices->GetPointer();
 }
 
+const int3* Mesh::TriangleVerticesWrappedData()
+{
+  return connectivity->triangleVerticesWrapped->GetPointer();
+}
+
+const int* Mesh::TriangleShiftData()
+{
+  return connectivity->triangleShift->GetPointer();
+}
+
 const real2* Mesh::TriangleEdgeNormalsData(int dim)
 {
   return triangleEdgeNormals->GetPointer(dim);
@@ -314,24 +389,126 @@ const int2* Mesh::EdgeTrianglesData()
   return connectivity->edgeTriangles->GetPointer();
 }
 
+int Mesh::GetNBoundaryTriangle()
+{
+  return boundaryTriangles->GetSize();
+}
+
+const int* Mesh::BoundaryTriangleData()
+{
+  return boundaryTriangles->GetPointer();
+}
+
+int Mesh::GetNSegmentTriangle()
+{
+  return segmentTriangles->GetSize();
+}
+
+const int* Mesh::SegmentTriangleData()
+{
+  return segmentTriangles->GetPointer();
+}
+
+const int* Mesh::VertexTriangleData()
+{
+  return connectivity->vertexTriangle->GetPointer();
+}
+
+const int* Mesh::VertexTriangleOffsetData()
+{
+  return connectivity->vertexTriangleOffset->GetPointer();
+}
+
+int Mesh::GetNTriangleColour()
+{
+  connectivity->UpdateTriangleColour();
+  return connectivity->GetNColour();
+}
+
+const int* Mesh::TriangleColourData()
+{
+  connectivity->UpdateTriangleColour();
+  return connectivity->triangleColour->GetPointer();
+}
+
+const int* Mesh::TriangleColourOffsetData()
+{
+  connectivity->UpdateTriangleColour();
+  return connectivity->triangleColourOffset->GetPointer();
+}
+
+void Mesh::PrintStatistics()
+{
+  predicates->PrintStatistics();
+  refine->PrintStatistics();
+  coarsen->PrintStatistics();
+
+  if (nAdaptStep > 0)
+    std::cout << std::setprecision(6)
+              << "Adapt: " << nAdaptStep << " steps, "
+              << nAdaptAdded << " vertices added, "
+              << nAdaptRemoved << " vertices removed; per step "
+              << (double) nAdaptAdded/nAdaptStep << " added, "
+              << (double) nAdaptRemoved/nAdaptStep << " removed, "
+              << adaptTime/nAdaptStep << " s" << std::endl;
+}
+
+//#########################################################################
+/*! Count the number of distinct time steps at which the mesh is adapted, so that vertices added and removed can be reported per step.
+
+\param nTimeStep Number of time steps taken so far*/
+//#########################################################################
+
+void Mesh::CountAdaptStep(int nTimeStep)
+{
+  if (nTimeStep != lastAdaptStep) {
+    nAdaptStep++;
+    lastAdaptStep = nTimeStep;
+  }
+}
+
 void Mesh::Transform()
 {
   connectivity->Transform();
 
   if (cudaFlag == 1) {
     vertexBoundaryFlag->TransformToHost();
+    boundaryVertices->TransformToHost();
+    boundaryTriangles->TransformToHost();
+    segmentTriangles->TransformToHost();
     triangleWantRefine->TransformToHost();
     triangleEdgeNormals->TransformToHost();
     triangleEdgeLength->TransformToHost();
     triangleErrorEstimate->TransformToHost();
+    triangleBuffer->TransformToHost();
+    triangleBufferNew->TransformToHost();
+    triangleMinEdgeLength->TransformToHost();
+    triangleVerticesOld->TransformToHost();
+    triangleChanged->TransformToHost();
+    vertexChanged->TransformToHost();
+    triangleChangedFlag->TransformToHost();
+    vertexChangedFlag->TransformToHost();
+    flagScan->TransformToHost();
 
     cudaFlag = 0;
   } else {
     vertexBoundaryFlag->TransformToDevice();
+    boundaryVertices->TransformToDevice();
+    boundaryTriangles->TransformToDevice();
+    segmentTriangles->TransformToDevice();
     triangleWantRefine->TransformToDevice();
     triangleEdgeNormals->TransformToDevice();
     triangleEdgeLength->TransformToDevice();
     triangleErrorEstimate->TransformToDevice();
+    triangleBuffer->TransformToDevice();
+    triangleBufferNew->TransformToDevice();
+    triangleMinEdgeLength->TransformToDevice();
+    triangleVerticesOld->TransformToDevice();
+    triangleChanged->TransformToDevice();
+    vertexChanged->TransformToDevice();
+    triangleChangedFlag->TransformToDevice();
+    vertexChangedFlag->TransformToDevice();
+    flagScan->TransformToDevice();
 
     cudaFlag = 1;
   }
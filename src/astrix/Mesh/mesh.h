@@ -16,8 +16,9 @@ along with Astrix.  If not, see <http://www.gnu.org/licenses/>.
 #ifndef ASTRIX_MESH_H
 #define ASTRIX_MESH_H
 
-#include <cuda_runtime_api.h>
+#include "../Common/cudaRuntime.h"
 #include <string>
+#include <cstdint>
 
 namespace astrix {
 
@@ -68,6 +69,8 @@ class Mesh
   int GetNEdge();
   //! Return if mesh is adaptive
   int IsAdaptive();
+  //! Return number of time steps between adaptations during the run
+  int GetAdaptInterval();
   //! Return size of domain in x
   real GetPx();
   //! Return size of domain in y
@@ -89,11 +92,19 @@ class Mesh
   const real2* VertexCoordinatesData();
   //! Return pointer to vertex boundary flag data
   const int* VertexBoundaryFlagData();
+  //! Return number of vertices on boundary
+  int GetNBoundaryVertex();
+  //! Return list of vertices on boundary
+  const int* BoundaryVertexData();
   //! Return pointer to vertex area data
   const real* VertexAreaData();
 
   //! Return pointer to triangle vertices data
   const int3* TriangleVerticesData();
+  //! Return pointer to triangle vertices data without periodic images
+  const int3* TriangleVerticesWrappedData();
+  //! Return pointer to periodic image codes of triangle vertices
+  const int* TriangleShiftData();
   //! Return pointer to triangle edges data
   const int3* TriangleEdgesData();
   //! Return pointer to triangle edge normals data
@@ -104,10 +115,32 @@ class Mesh
   //! Return edge triangles data
   const int2* EdgeTrianglesData();
 
+  //! Return number of triangles with a vertex on the boundary
+  int GetNBoundaryTriangle();
+  //! Return list of triangles with a vertex on the boundary
+  const int* BoundaryTriangleData();
+  //! Return number of triangles with an edge on the boundary
+  int GetNSegmentTriangle();
+  //! Return list of triangles with an edge on the boundary
+  const int* SegmentTriangleData();
+
+  //! Return list of triangles sharing vertices
+  const int* VertexTriangleData();
+  //! Return start of every vertex in vertex triangle data
+  const int* VertexTriangleOffsetData();
+  //! Return number of triangle colours (host only)
+  int GetNTriangleColour();
+  //! Return triangles sorted by colour (host only)
+  const int* TriangleColourData();
+  //! Return start of every colour in triangle colour data (host only)
+  const int* TriangleColourOffsetData();
+
   // Allow switch between host and device memory
 
   //! Transform all Arrays
   void Transform();
+  //! Output statistics of geometric predicates to screen
+  void PrintStatistics();
 
  private:
   //! Basic Mesh structure
@@ -127,8 +160,14 @@ class Mesh
 
   //! Flag whether vertex is part of boundary
   Array <int> *vertexBoundaryFlag;
-
-  //! Flag whether triangle needs to be refined
+  //! Vertices on boundary
+  Array <int> *boundaryVertices;
+  //! Triangles with at least one vertex on boundary
+  Array <int> *boundaryTriangles;
+  //! Triangles with at least one edge on boundary
+  Array <int> *segmentTriangles;
+
+  //! Flag whether triangle needs to be refined (dimension 0) and triangle refinement level (dimension 1)
   Array <int> *triangleWantRefine;
   //! Normal vector to triangle edges (normalized)
   Array <real2> *triangleEdgeNormals;
@@ -136,6 +175,40 @@ class Mesh
   Array <real3> *triangleEdgeLength;
   //! Estimate of discretization error
   Array <real> *triangleErrorEstimate;
+  //! Workspace: flag whether triangle is in buffer zone around refined region
+  Array <int> *triangleBuffer;
+  //! Workspace: buffer zone flags including next layer of triangles
+  Array <int> *triangleBufferNew;
+  //! Workspace: shortest edge of every triangle
+  Array <real> *triangleMinEdgeLength;
+  //! Workspace: triangle vertices before refinement
+  Array <int3> *triangleVerticesOld;
+  //! Workspace: triangles changed by refinement
+  Array <int> *triangleChanged;
+  //! Workspace: vertices of triangles changed by refinement
+  Array <int> *vertexChanged;
+  //! Workspace: flag whether triangle changed by refinement
+  Array <int> *triangleChangedFlag;
+  //! Workspace: flag whether vertex belongs to changed triangle
+  Array <int> *vertexChangedFlag;
+  //! Workspace: exclusive scan of flags when making lists
+  Array <int> *flagScan;
+
+  //! Number of vertices added by adaptive refinement
+  int64_t nAdaptAdded;
+  //! Number of vertices removed by adaptive coarsening
+  int64_t nAdaptRemoved;
+  //! Number of time steps at which mesh was adapted
+  int nAdaptStep;
+  //! Last time step at which mesh was adapted
+  int lastAdaptStep;
+  //! Last time step at which triangle refinement levels were updated
+  int lastLevelStep;
+  //! Total time spent adapting mesh (s)
+  double adaptTime;
+
+  //! Keep track of time steps at which mesh is adapted
+  void CountAdaptStep(int nTimeStep);
 
   // Runtime flags
 
@@ -155,8 +228,24 @@ class Mesh
 
   //! Calculate triangle normals and edge lengths
   void CalcNormalEdge();
+  //! Calculate triangle normals and edge lengths for changed triangles only
+  void UpdateNormalEdge(int nChanged);
   //! Flag vertices where boundary conditions need to be applied
   void FindBoundaryVertices();
+  //! Update boundary flags of vertices of changed triangles only
+  void UpdateBoundaryVertices(int nChangedVertex, int nChanged,
+                              int nVertexOld);
+  //! Make list of vertices on boundary from boundary flags
+  void ListBoundaryVertices();
+
+  //! Find triangles that changed since triangleVerticesOld was filled
+  int FindChangedTriangles(int nTriangleOld, int nVertexOld);
+  //! Find vertices of changed triangles
+  int FindChangedVertices(int nChanged);
+  //! Check incremental geometry update against full recalculation
+  void CheckChangedGeometry();
+  //! Find triangles where boundary conditions need to be applied
+  void FindBoundaryTriangles();
 
   //! Construct mesh boundaries
   void ConstructBoundaries();
@@ -175,7 +264,8 @@ class Mesh
   void CalcErrorEstimate(Array<realNeq> *vertexState, real G);
   //! Check which triangles want refining based of state
   template<class realNeq, ConservationLaw CL>
-  void FillWantRefine(Array<realNeq> *vertexState, real specificHeatRatio);
+  void FillWantRefine(Array<realNeq> *vertexState, real specificHeatRatio,
+                      int nTimeStep);
 
   // Debugging functions
 
@@ -183,6 +273,8 @@ class Mesh
   real MaxEdgeLengthTriangle(int i);
   //! Return maximum edge length for whole grid
   real MaximumEdgeLength();
+  //! Return minimum edge length for whole grid
+  real MinimumEdgeLength();
   //! Check if any vertex encroaches upon segment (slow, used for debugging)
   void CheckEncroachSlow();
   //! Check if all triangles are legal (used for debugging)
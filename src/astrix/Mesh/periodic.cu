@@ -144,9 +144,9 @@ void Mesh::MakePeriodic()
                                          devFindEdgeBetween,
                                          (size_t) 0, 0);
 
-      devFindEdgeBetween<<<nBlocks, nThreads>>>
+      LaunchKernel(nBlocks, nThreads, devFindEdgeBetween)
         (nTriangle, vLeft1, vLeft2, pTv, pTe, &(pEdgeLeftRight[0]));
-      devFindEdgeBetween<<<nBlocks, nThreads>>>
+      LaunchKernel(nBlocks, nThreads, devFindEdgeBetween)
         (nTriangle, vRight2, vRight1, pTv, pTe, &(pEdgeLeftRight[1]));
 
       gpuErrchk( cudaPeekAtLastError() );
@@ -291,9 +291,9 @@ void Mesh::MakePeriodic()
                                          devFindEdgeBetween,
                                          (size_t) 0, 0);
 
-      devFindEdgeBetween<<<nBlocks, nThreads>>>
+      LaunchKernel(nBlocks, nThreads, devFindEdgeBetween)
         (nTriangle, vBottom2, vBottom1, pTv, pTe, &(pEdgeBottomTop[0]));
-      devFindEdgeBetween<<<nBlocks, nThreads>>>
+      LaunchKernel(nBlocks, nThreads, devFindEdgeBetween)
         (nTriangle, vTop1, vTop2, pTv, pTe, &(pEdgeBottomTop[1]));
 
       gpuErrchk( cudaPeekAtLastError() );
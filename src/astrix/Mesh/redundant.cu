@@ -393,7 +393,7 @@ void Mesh::RemoveRedundant(Array<int> *vertexOrder,
                                        devFlagVertexRemove,
                                        (size_t) 0, 0);
 
-    devFlagVertexRemove<<<nBlocks, nThreads>>>
+    LaunchKernel(nBlocks, nThreads, devFlagVertexRemove)
       (nVertex, pVertexOrder, pVertexRemoveFlag);
 
     gpuErrchk( cudaPeekAtLastError() );
@@ -413,7 +413,7 @@ void Mesh::RemoveRedundant(Array<int> *vertexOrder,
                                        devFlagTriangleRemove,
                                        (size_t) 0, 0);
 
-    devFlagTriangleRemove<<<nBlocks, nThreads>>>
+    LaunchKernel(nBlocks, nThreads, devFlagTriangleRemove)
       (nTriangle, pTv, pVertexRemoveFlag,
        pVertexOrder, nVertexOuterBoundary, pTriangleRemoveFlag, nVertex);
 
@@ -436,7 +436,7 @@ void Mesh::RemoveRedundant(Array<int> *vertexOrder,
                                        devFlagEdgeRemove,
                                        (size_t) 0, 0);
 
-    devFlagEdgeRemove<<<nBlocks, nThreads>>>
+    LaunchKernel(nBlocks, nThreads, devFlagEdgeRemove)
       (nEdge, pEt, pTriangleRemoveFlag, pEdgeRemoveFlag);
 
     gpuErrchk( cudaPeekAtLastError() );
@@ -459,7 +459,7 @@ void Mesh::RemoveRedundant(Array<int> *vertexOrder,
        devAdjustTriangleVertices,
        (size_t) 0, 0);
 
-    devAdjustTriangleVertices<<<nBlocks, nThreads>>>
+    LaunchKernel(nBlocks, nThreads, devAdjustTriangleVertices)
       (nTriangle, pTv, pVertexFlagScan, nVertex);
 
     gpuErrchk( cudaPeekAtLastError() );
@@ -481,7 +481,7 @@ void Mesh::RemoveRedundant(Array<int> *vertexOrder,
                                        devAdjustEdgeTriangles,
                                        (size_t) 0, 0);
 
-    devAdjustEdgeTriangles<<<nBlocks, nThreads>>>
+    LaunchKernel(nBlocks, nThreads, devAdjustEdgeTriangles)
       (nEdge, pEt, pTriangleFlagScan);
 
     gpuErrchk( cudaPeekAtLastError() );
@@ -503,7 +503,7 @@ void Mesh::RemoveRedundant(Array<int> *vertexOrder,
                                        devAdjustTriangleEdges,
                                        (size_t) 0, 0);
 
-    devAdjustTriangleEdges<<<nBlocks, nThreads>>>
+    LaunchKernel(nBlocks, nThreads, devAdjustTriangleEdges)
       (nTriangle, pTe, pEdgeFlagScan);
 
     gpuErrchk( cudaPeekAtLastError() );
@@ -13,7 +13,7 @@ Astrix is distributed in the hope that it will be useful, but WITHOUT ANY WARRAN
 
 You should have received a copy of the GNU General Public License
 along with Astrix.  If not, see <http://www.gnu.org/licenses/>.*/
-#include <cuda_runtime_api.h>
+#include "../Common/cudaRuntime.h"
 #include <iostream>
 #include <fstream>
 
@@ -318,9 +318,13 @@ void Mesh::ReadFromDisk(int nSave)
 
   if (cudaFlag == 1) connectivity->CopyToDevice();
 
+  connectivity->CalcTriangleVerticesWrapped();
   CalcNormalEdge();
   connectivity->CalcVertexArea(GetPx(), GetPy());
+  connectivity->CalcVertexTriangle();
+  connectivity->CalcTriangleColour();
   FindBoundaryVertices();
+  FindBoundaryTriangles();
 
   std::cout << "Done reading mesh from disk" << std::endl;
 }
@@ -14,7 +14,7 @@ Astrix is distributed in the hope that it will be useful, but WITHOUT ANY WARRAN
 You should have received a copy of the GNU General Public License
 along with Astrix.  If not, see <http://www.gnu.org/licenses/>.
 */
-#include <cuda_runtime_api.h>
+#include "../Common/cudaRuntime.h"
 #include <iostream>
 #include <cmath>
 
@@ -268,9 +268,13 @@ void Mesh::CreateStructuredMesh()
   */
 
   // Calculate triangle normals and areas
+  connectivity->CalcTriangleVerticesWrapped();
   CalcNormalEdge();
   connectivity->CalcVertexArea(GetPx(), GetPy());
+  connectivity->CalcVertexTriangle();
+  connectivity->CalcTriangleColour();
   FindBoundaryVertices();
+  FindBoundaryTriangles();
 }
 
 }  // namespace astrix
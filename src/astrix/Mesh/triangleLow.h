@@ -281,6 +281,92 @@ void GetTriangleCoordinatesSingle(const real2* __restrict__ pVc,
   ay = pVc[a].y + dya;
 }
 
+//##############################################################################
+/*! \brief Periodic image of corner \a k of a triangle
+
+Decode periodic image \a i from the shift code of a triangle (see Connectivity::triangleShift). The vertex index in \a triangleVertices is the index in \a triangleVerticesWrapped plus i*nVertex.
+
+\param shift Periodic shift code of triangle
+\param k Corner of triangle (0, 1 or 2)*/
+//##############################################################################
+
+__host__ __device__ inline
+int TriangleShiftImage(const int shift, const int k)
+{
+  return ((shift >> 4*k) & 15) - 4;
+}
+
+//##############################################################################
+/*! \brief Translation of periodic image in x-direction
+
+Returns 1 if periodic image \a i lies in the positive x direction, -1 if it lies in the negative x direction, zero otherwise. Equal to CanVertexBeTranslatedX(v + i*N, N) for 0 <= v < N.
+
+\param i Periodic image (-4 <= i <= 4)*/
+//##############################################################################
+
+__host__ __device__ inline
+real ImageTranslationX(const int i)
+{
+  if (i == 4 || i == 1 || i == -2) return (real) 1.0;
+  if (i == -4 || i == 2 || i == -1) return (real) -1.0;
+  return (real) 0.0;
+}
+
+//##############################################################################
+/*! \brief Translation of periodic image in y-direction
+
+Returns 1 if periodic image \a i lies in the positive y direction, -1 if it lies in the negative y direction, zero otherwise. Equal to CanVertexBeTranslatedY(v + i*N, N) for 0 <= v < N.
+
+\param i Periodic image (-4 <= i <= 4)*/
+//##############################################################################
+
+__host__ __device__ inline
+real ImageTranslationY(const int i)
+{
+  if (i >= 2) return (real) 1.0;
+  if (i <= -2) return (real) -1.0;
+  return (real) 0.0;
+}
+
+//######################################################################
+/*! Find coordinates of triangle from vertices without periodic images and the periodic shift code of the triangle. Gives the same result as GetTriangleCoordinates, without loops depending on the vertex indices.
+
+\param *pVc Pointer to vertex coordinates
+\param a First vertex of triangle, without periodic image
+\param b Second vertex of triangle, without periodic image
+\param c Third vertex of triangle, without periodic image
+\param shift Periodic shift code of triangle
+\param Px Periodic domain size x
+\param Py Periodic domain size y
+\param ax Output x coordinate of first vertex
+\param bx Output x coordinate of second vertex
+\param cx Output x coordinate of third vertex
+\param ay Output y coordinate of first vertex
+\param by Output y coordinate of second vertex
+\param cy Output y coordinate of third vertex*/
+//######################################################################
+
+__host__ __device__ inline
+void GetTriangleCoordinatesWrapped(const real2* __restrict__ pVc,
+                                   const int a, const int b, const int c,
+                                   const int shift,
+                                   const real Px, const real Py,
+                                   real& ax, real& bx, real& cx,
+                                   real& ay, real& by, real& cy)
+{
+  int ia = TriangleShiftImage(shift, 0);
+  int ib = TriangleShiftImage(shift, 1);
+  int ic = TriangleShiftImage(shift, 2);
+
+  // Vertex coordinates
+  ax = pVc[a].x + ImageTranslationX(ia)*Px;
+  bx = pVc[b].x + ImageTranslationX(ib)*Px;
+  cx = pVc[c].x + ImageTranslationX(ic)*Px;
+  ay = pVc[a].y + ImageTranslationY(ia)*Py;
+  by = pVc[b].y + ImageTranslationY(ib)*Py;
+  cy = pVc[c].y + ImageTranslationY(ic)*Py;
+}
+
 }  // namespace astrix
 
 #endif  // ASTRIX_TRIANGLE_LOW_H
@@ -14,6 +14,7 @@ Astrix is distributed in the hope that it will be useful, but WITHOUT ANY WARRAN
 You should have received a copy of the GNU General Public License
 along with Astrix.  If not, see <http://www.gnu.org/licenses/>.*/
 #include <iostream>
+#include <utility>
 
 #include "../Common/definitions.h"
 #include "../Array/array.h"
@@ -27,25 +28,39 @@ namespace astrix {
 // #########################################################################
 /*! \brief Check if triangle i needs refining based on ErrorEstimate
 
+A triangle with an error above \a maxError is flagged for refinement and gets the highest refinement level \a nRefineLevel. A triangle with an error below \a minError is only flagged for coarsening at refinement level zero; otherwise its level is lowered by one if \a updateLevel = 1.
+
 \param i Index of triangle to consider
 \param *pErrorEstimate Pointer to array with estimates of local truncation error
  (LTE)
 \param maxError Limit of LTE above which to flag triangle for refinement
 \param minError Limit of LTE below which to flag triangle for refinement
-\param *pWantRefine Pointer to output array: 1 if triangle needs refining, -1 if it can be coarsened, 0 if nothing needs to happen*/
+\param nRefineLevel Highest refinement level
+\param updateLevel Flag whether to lower refinement levels
+\param *pWantRefine Pointer to output array: 1 if triangle needs refining, -1 if it can be coarsened, 0 if nothing needs to happen
+\param *pRefineLevel Pointer to triangle refinement levels*/
 // #########################################################################
 
 __host__ __device__
 void FillWantRefineSingle(int i, real *pErrorEstimate,
                           real maxError, real minError,
-                          int *pWantRefine)
+                          int nRefineLevel, int updateLevel,
+                          int *pWantRefine, int *pRefineLevel)
 {
   int ret = 0;
+  int level = min(max(pRefineLevel[i], 0), nRefineLevel);
 
-  if (pErrorEstimate[i] > maxError) ret = 1;
-  if (pErrorEstimate[i] < minError) ret = -1;
+  if (pErrorEstimate[i] > maxError) {
+    ret = 1;
+    level = nRefineLevel;
+  }
+  if (pErrorEstimate[i] < minError) {
+    if (level == 0) ret = -1;
+    if (updateLevel == 1 && level > 0) level--;
+  }
 
   pWantRefine[i] = ret;
+  pRefineLevel[i] = level;
 }
 
 //######################################################################
@@ -56,17 +71,108 @@ void FillWantRefineSingle(int i, real *pErrorEstimate,
  (LTE)
 \param maxError Limit of LTE above which to flag triangle for refinement
 \param minError Limit of LTE below which to flag triangle for refinement
-\param *pWantRefine Pointer to output array: 1 if triangle needs refining, -1 if it can be coarsened, 0 if nothing needs to happen*/
+\param nRefineLevel Highest refinement level
+\param updateLevel Flag whether to lower refinement levels
+\param *pWantRefine Pointer to output array: 1 if triangle needs refining, -1 if it can be coarsened, 0 if nothing needs to happen
+\param *pRefineLevel Pointer to triangle refinement levels*/
 //######################################################################
 
 __global__ void
 devFillWantRefine(int nTriangle, real *pErrorEstimate,
-                  real maxError, real minError, int *pWantRefine)
+                  real maxError, real minError,
+                  int nRefineLevel, int updateLevel,
+                  int *pWantRefine, int *pRefineLevel)
+{
+  int i = blockIdx.x*blockDim.x + threadIdx.x;
+
+  while (i < nTriangle) {
+    FillWantRefineSingle(i, pErrorEstimate, maxError, minError,
+                         nRefineLevel, updateLevel, pWantRefine, pRefineLevel);
+
+    i += blockDim.x*gridDim.x;
+  }
+}
+
+//######################################################################
+/*! \brief Add edge neighbours of buffer triangles to buffer zone
+
+\param i Index of triangle to consider
+\param *pTe Pointer to triangle edges
+\param *pEt Pointer to edge triangles
+\param *pBufferOld Pointer to buffer flags of previous layer (1 if in buffer)
+\param *pBufferNew Pointer to buffer flags including new layer (output)*/
+//######################################################################
+
+__host__ __device__
+void SpreadBufferSingle(int i, const int3 *pTe, const int2 *pEt,
+                        const int *pBufferOld, int *pBufferNew)
+{
+  int ret = (pBufferOld[i] == 1);
+
+  int e[] = {pTe[i].x, pTe[i].y, pTe[i].z};
+
+  for (int n = 0; n < 3; n++) {
+    int t = pEt[e[n]].x;
+    if (t == i) t = pEt[e[n]].y;
+    if (t != -1)
+      if (pBufferOld[t] == 1) ret = 1;
+  }
+
+  pBufferNew[i] = ret;
+}
+
+//######################################################################
+/*! \brief Kernel adding edge neighbours of buffer triangles to buffer zone
+
+\param nTriangle Total number of triangles in Mesh
+\param *pTe Pointer to triangle edges
+\param *pEt Pointer to edge triangles
+\param *pBufferOld Pointer to buffer flags of previous layer (1 if in buffer)
+\param *pBufferNew Pointer to buffer flags including new layer (output)*/
+//######################################################################
+
+__global__ void
+devSpreadBuffer(int nTriangle, const int3 *pTe, const int2 *pEt,
+                const int *pBufferOld, int *pBufferNew)
+{
+  int i = blockIdx.x*blockDim.x + threadIdx.x;
+
+  while (i < nTriangle) {
+    SpreadBufferSingle(i, pTe, pEt, pBufferOld, pBufferNew);
+
+    i += blockDim.x*gridDim.x;
+  }
+}
+
+//######################################################################
+/*! \brief Do not coarsen triangle if it is part of the buffer zone
+
+\param i Index of triangle to consider
+\param *pBuffer Pointer to buffer flags
+\param *pWantRefine Pointer to refinement flags, -1 reset to 0 in buffer*/
+//######################################################################
+
+__host__ __device__
+void KeepBufferSingle(int i, const int *pBuffer, int *pWantRefine)
+{
+  if (pBuffer[i] == 1 && pWantRefine[i] == -1) pWantRefine[i] = 0;
+}
+
+//######################################################################
+/*! \brief Kernel making sure triangles in the buffer zone are not coarsened
+
+\param nTriangle Total number of triangles in Mesh
+\param *pBuffer Pointer to buffer flags
+\param *pWantRefine Pointer to refinement flags, -1 reset to 0 in buffer*/
+//######################################################################
+
+__global__ void
+devKeepBuffer(int nTriangle, const int *pBuffer, int *pWantRefine)
 {
   int i = blockIdx.x*blockDim.x + threadIdx.x;
 
   while (i < nTriangle) {
-    FillWantRefineSingle(i, pErrorEstimate, maxError, minError, pWantRefine);
+    KeepBufferSingle(i, pBuffer, pWantRefine);
 
     i += blockDim.x*gridDim.x;
   }
@@ -75,21 +181,38 @@ devFillWantRefine(int nTriangle, real *pErrorEstimate,
 // #########################################################################
 /*! Flag triangles for refinement or coarsening based on an estimate of the local truncation error (LTE). First the LTE is computed; then we fill the Array triangleWantRefine with either 1 (triangle needs refining), -1 (triangle can be coarsened) or 0 (nothing needs to happen).
 
+The second dimension of triangleWantRefine holds a refinement level for every triangle, which provides hysteresis between the two error thresholds. A triangle with an error above maxError is set to level \a nRefineLevel. At every time step at which its error is below minError, the level is lowered by one, and the triangle can only be coarsened once it has reached level zero. A refined triangle is therefore kept for \a nRefineLevel adaptation steps after its error has dropped, rather than being coarsened and refined back and forth. Triangles created or split by inserting vertices during the run get level \a nRefineLevel as well (see Refine::InsertVertices), so that vertices inserted to keep the mesh quality are not removed again at the next coarsening step. With \a nRefineLevel = 0 every triangle with an error below minError can be coarsened.
+
+If \a nBufferLayer > 0, triangles within \a nBufferLayer edge neighbours of a triangle that needs refining are never flagged for coarsening. Between the two error thresholds this gives a buffer zone in which a moving feature stays resolved until the next refinement step, so that the mesh is not coarsened just ahead of a feature only to be refined again a few steps later. The buffer should therefore be roughly as wide as the number of triangles the feature crosses between two adaptation steps, \a nStepAdapt time steps apart. The motion of features is not predicted: there is no look-ahead along the flow, and the buffer is symmetric around flagged triangles.
+
 \param *vertexState Pointer to Array containing state vector (density etc). Needed to compute LTE
-\param specificHeatRatio Ratio of specific heats*/
+\param specificHeatRatio Ratio of specific heats
+\param nTimeStep Number of time steps taken so far. Refinement levels are lowered at most once per time step*/
 // #########################################################################
 
 template<class realNeq, ConservationLaw CL>
-void Mesh::FillWantRefine(Array<realNeq> *vertexState, real specificHeatRatio)
+void Mesh::FillWantRefine(Array<realNeq> *vertexState, real specificHeatRatio,
+                          int nTimeStep)
 {
   int nTriangle = connectivity->triangleVertices->GetSize();
 
+  // Triangles without refinement level (new or restored mesh) start at zero
+  int nOld = triangleWantRefine->GetSize();
+  triangleWantRefine->SetSize(nTriangle);
+  if (nOld < nTriangle) triangleWantRefine->SetToValue(0, nOld, nTriangle);
+
   CalcErrorEstimate<realNeq, CL>(vertexState, specificHeatRatio);
   real *pErrorEstimate = triangleErrorEstimate->GetPointer();
   int *pWantRefine = triangleWantRefine->GetPointer();
+  int *pRefineLevel = triangleWantRefine->GetPointer(1);
 
   real minError = meshParameter->minError;
   real maxError = meshParameter->maxError;
+  int nRefineLevel = meshParameter->nRefineLevel;
+
+  // Coarsening and refining may both ask for flags in the same time step
+  int updateLevel = (nTimeStep != lastLevelStep);
+  lastLevelStep = nTimeStep;
 
   if (cudaFlag == 1) {
     int nBlocks = 128;
@@ -100,13 +223,79 @@ void Mesh::FillWantRefine(Array<realNeq> *vertexState, real specificHeatRatio)
                                        devFillWantRefine,
                                        (size_t) 0, 0);
 
-    devFillWantRefine<<<nBlocks, nThreads>>>
-      (nTriangle, pErrorEstimate, maxError, minError, pWantRefine);
+    LaunchKernel(nBlocks, nThreads, devFillWantRefine)
+      (nTriangle, pErrorEstimate, maxError, minError,
+       nRefineLevel, updateLevel, pWantRefine, pRefineLevel);
+    gpuErrchk( cudaPeekAtLastError() );
+    gpuErrchk( cudaDeviceSynchronize() );
+  } else {
+#pragma omp parallel for
+    for (int i = 0; i < nTriangle; i++)
+      FillWantRefineSingle(i, pErrorEstimate, maxError, minError,
+                           nRefineLevel, updateLevel,
+                           pWantRefine, pRefineLevel);
+  }
+
+  int nBufferLayer = meshParameter->nBufferLayer;
+  if (nBufferLayer == 0) return;
+
+  const int3 *pTe = connectivity->triangleEdges->GetPointer();
+  const int2 *pEt = connectivity->edgeTriangles->GetPointer();
+
+  // Buffer starts as triangles that need refining
+  triangleBuffer->SetSize(nTriangle);
+  triangleBufferNew->SetSize(nTriangle);
+  triangleBuffer->SetEqual(triangleWantRefine);
+
+  Array<int> *bufferOld = triangleBuffer;
+  Array<int> *bufferNew = triangleBufferNew;
+
+  // Add one layer of neighbours at a time
+  for (int n = 0; n < nBufferLayer; n++) {
+    int *pBufferOld = bufferOld->GetPointer();
+    int *pBufferNew = bufferNew->GetPointer();
+
+    if (cudaFlag == 1) {
+      int nBlocks = 128;
+      int nThreads = 128;
+
+      // Base nThreads and nBlocks on maximum occupancy
+      cudaOccupancyMaxPotentialBlockSize(&nBlocks, &nThreads,
+                                         devSpreadBuffer,
+                                         (size_t) 0, 0);
+
+      LaunchKernel(nBlocks, nThreads, devSpreadBuffer)
+        (nTriangle, pTe, pEt, pBufferOld, pBufferNew);
+      gpuErrchk( cudaPeekAtLastError() );
+      gpuErrchk( cudaDeviceSynchronize() );
+    } else {
+#pragma omp parallel for
+      for (int i = 0; i < nTriangle; i++)
+        SpreadBufferSingle(i, pTe, pEt, pBufferOld, pBufferNew);
+    }
+
+    std::swap(bufferOld, bufferNew);
+  }
+
+  int *pBuffer = bufferOld->GetPointer();
+
+  if (cudaFlag == 1) {
+    int nBlocks = 128;
+    int nThreads = 128;
+
+    // Base nThreads and nBlocks on maximum occupancy
+    cudaOccupancyMaxPotentialBlockSize(&nBlocks, &nThreads,
+                                       devKeepBuffer,
+                                       (size_t) 0, 0);
+
+    LaunchKernel(nBlocks, nThreads, devKeepBuffer)
+      (nTriangle, pBuffer, pWantRefine);
     gpuErrchk( cudaPeekAtLastError() );
     gpuErrchk( cudaDeviceSynchronize() );
   } else {
+#pragma omp parallel for
     for (int i = 0; i < nTriangle; i++)
-      FillWantRefineSingle(i, pErrorEstimate, maxError, minError, pWantRefine);
+      KeepBufferSingle(i, pBuffer, pWantRefine);
   }
 }
 
@@ -116,15 +305,19 @@ void Mesh::FillWantRefine(Array<realNeq> *vertexState, real specificHeatRatio)
 
 template void
 Mesh::FillWantRefine<real, CL_ADVECT>(Array<real> *vertexState,
-                                      real specificHeatRatio);
+                                      real specificHeatRatio,
+                                      int nTimeStep);
 template void
 Mesh::FillWantRefine<real, CL_BURGERS>(Array<real> *vertexState,
-                                     real specificHeatRatio);
+                                     real specificHeatRatio,
+                                     int nTimeStep);
 template void
 Mesh::FillWantRefine<real3, CL_CART_ISO>(Array<real3> *vertexState,
-                                     real specificHeatRatio);
+                                     real specificHeatRatio,
+                                     int nTimeStep);
 template void
 Mesh::FillWantRefine<real4, CL_CART_EULER>(Array<real4> *vertexState,
-                                           real specificHeatRatio);
+                                           real specificHeatRatio,
+                                           int nTimeStep);
 
 }  // namespace astrix
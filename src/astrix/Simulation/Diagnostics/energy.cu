@@ -86,12 +86,13 @@ real Diagnostics<T, CL>::TotalEnergy(Array<T> *state, Mesh *mesh)
                                        devTotalEnergy<T, CL>,
                                        (size_t) 0, 0);
 
-    devTotalEnergy<T, CL><<<nBlocks, nThreads>>>
+    LaunchKernel(nBlocks, nThreads, devTotalEnergy<T, CL>)
       (nVertex, pVarea, pState, pE);
 
     gpuErrchk( cudaPeekAtLastError() );
     gpuErrchk( cudaDeviceSynchronize() );
   } else {
+#pragma omp parallel for
     for (unsigned int n = 0; n < nVertex; n++)
       TotalEnergySingle<T, CL>(n, pVarea, pState, pE);
   }
@@ -106,12 +106,13 @@ real Diagnostics<T, CL>::KineticEnergy(Array<T> *state, Mesh *mesh)
                                        devKineticEnergy<T, CL>,
                                        (size_t) 0, 0);
 
-    devKineticEnergy<T, CL><<<nBlocks, nThreads>>>
+    LaunchKernel(nBlocks, nThreads, devKineticEnergy<T, CL>)
       (nVertex, pVarea, pState, pE);
 
     gpuErrchk( cudaPeekAtLastError() );
     gpuErrchk( cudaDeviceSynchronize() );
   } else {
+#pragma omp parallel for
     for (unsigned int n = 0; n < nVertex; n++)
       KineticEnergySingle<T, CL>(n, pVarea, pState, pE);
   }
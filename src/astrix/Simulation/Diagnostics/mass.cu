@@ -128,12 +128,13 @@ real Diagnostics<T, CL>::TotalMass(Array<T> *state, Mesh *mesh)
                                        (size_t) 0, 0);
 
     // Execute kernel...
-    devFillMassArray<T, CL><<<nBlocks, nThreads>>>
+    LaunchKernel(nBlocks, nThreads, devFillMassArray<T, CL>)
       (nVertex, pState, pVarea, pVm);
 
     gpuErrchk(cudaPeekAtLastError());
     gpuErrchk(cudaDeviceSynchronize());
   } else {
+#pragma omp parallel for
     for (unsigned int n = 0; n < nVertex; n++)
       FillMassArraySingle<T, CL>(n, pState, pVarea, pVm);
   }
@@ -98,12 +98,13 @@ real Diagnostics<T, CL>::ThermalEnergy(Array<T> *state,
                                        devThermalEnergy<T, CL>,
                                        (size_t) 0, 0);
 
-    devThermalEnergy<T, CL><<<nBlocks, nThreads>>>
+    LaunchKernel(nBlocks, nThreads, devThermalEnergy<T, CL>)
       (nVertex, pVarea, pState, pVp, pE);
 
     gpuErrchk( cudaPeekAtLastError() );
     gpuErrchk( cudaDeviceSynchronize() );
   } else {
+#pragma omp parallel for
     for (unsigned int n = 0; n < nVertex; n++)
       ThermalEnergySingle<T, CL>(n, pVarea, pState, pVp, pE);
   }
@@ -13,7 +13,7 @@ Astrix is distributed in the hope that it will be useful, but WITHOUT ANY WARRAN
 You should have received a copy of the GNU General Public License
 along with Astrix.  If not, see <http://www.gnu.org/licenses/>.*/
 
-#include <cuda_runtime_api.h>
+#include "../../Common/cudaRuntime.h"
 #include <iostream>
 #include <stdexcept>
 #include <cmath>
@@ -76,6 +76,54 @@ void SimulationParameter::CheckValidity(ConservationLaw CL)
     std::cout << "Invalid value for selectiveLumpFlag" << std::endl;
     throw std::runtime_error("");
   }
+  if (gatherResidueFlag != 0 && gatherResidueFlag != 1) {
+    std::cout << "Invalid value for gatherResidueFlag" << std::endl;
+    throw std::runtime_error("");
+  }
+  if (fusedResidualFlag != 0 && fusedResidualFlag != 1) {
+    std::cout << "Invalid value for fusedResidualFlag" << std::endl;
+    throw std::runtime_error("");
+  }
+  if (hostSimdFlag != 0 && hostSimdFlag != 1) {
+    std::cout << "Invalid value for hostSimdFlag" << std::endl;
+    throw std::runtime_error("");
+  }
+  if (maxTimeLevel < 0 || maxTimeLevel > 16) {
+    std::cout << "Invalid value for maxTimeLevel" << std::endl;
+    throw std::runtime_error("");
+  }
+  if (implicitFlag != 0 && implicitFlag != 1) {
+    std::cout << "Invalid value for implicitFlag" << std::endl;
+    throw std::runtime_error("");
+  }
+  if (implicitFlag == 1 && maxTimeLevel > 0) {
+    std::cout << "Local time stepping not possible with implicitFlag = 1"
+              << std::endl;
+    throw std::runtime_error("");
+  }
+  // Solver parameters only matter for implicit integration
+  if (implicitFlag == 1) {
+    if (implicitCFLnumber <= 0.0) {
+      std::cout << "Invalid value for implicitCFLnumber" << std::endl;
+      throw std::runtime_error("");
+    }
+    if (maxNewtonIter < 1) {
+      std::cout << "Invalid value for maxNewtonIter" << std::endl;
+      throw std::runtime_error("");
+    }
+    if (newtonTolerance <= 0.0 || newtonTolerance >= 1.0) {
+      std::cout << "Invalid value for newtonTolerance" << std::endl;
+      throw std::runtime_error("");
+    }
+    if (maxKrylovIter < 1) {
+      std::cout << "Invalid value for maxKrylovIter" << std::endl;
+      throw std::runtime_error("");
+    }
+    if (krylovTolerance <= 0.0 || krylovTolerance >= 1.0) {
+      std::cout << "Invalid value for krylovTolerance" << std::endl;
+      throw std::runtime_error("");
+    }
+  }
   if (intScheme == SCHEME_UNDEFINED) {
     std::cout << "Invalid value for integrationScheme" << std::endl;
     throw std::runtime_error("");
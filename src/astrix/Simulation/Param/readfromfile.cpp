@@ -13,7 +13,7 @@ Astrix is distributed in the hope that it will be useful, but WITHOUT ANY WARRAN
 You should have received a copy of the GNU General Public License
 along with Astrix.  If not, see <http://www.gnu.org/licenses/>.*/
 
-#include <cuda_runtime_api.h>
+#include "../../Common/cudaRuntime.h"
 #include <iostream>
 #include <fstream>
 #include <sstream>
@@ -120,6 +120,76 @@ void SimulationParameter::ReadFromFile(const char *fileName,
         selectiveLumpFlag = atof(secondWord.c_str());
     }
 
+    // Flag to gather residue at vertices
+    if (firstWord == "gatherResidueFlag") {
+      if (!secondWord.empty() &&
+          secondWord.find_first_not_of("01") == std::string::npos)
+        gatherResidueFlag = atof(secondWord.c_str());
+    }
+
+    // Flag to fuse parameter vector, residual and signal speed passes
+    if (firstWord == "fusedResidualFlag") {
+      if (!secondWord.empty() &&
+          secondWord.find_first_not_of("01") == std::string::npos)
+        fusedResidualFlag = atof(secondWord.c_str());
+    }
+
+    // Flag to vectorise host residual loops
+    if (firstWord == "hostSimdFlag") {
+      if (!secondWord.empty() &&
+          secondWord.find_first_not_of("01") == std::string::npos)
+        hostSimdFlag = atof(secondWord.c_str());
+    }
+
+    // Maximum level for local time stepping
+    if (firstWord == "maxTimeLevel") {
+      if (!secondWord.empty() &&
+          secondWord.find_first_not_of("0123456789") == std::string::npos)
+        maxTimeLevel = atof(secondWord.c_str());
+    }
+
+    // Implicit time integration flag
+    if (firstWord == "implicitFlag") {
+      if (!secondWord.empty() &&
+          secondWord.find_first_not_of("01") == std::string::npos)
+        implicitFlag = atof(secondWord.c_str());
+    }
+
+    // Courant number for implicit time integration
+    if (firstWord == "implicitCFLnumber") {
+      if (!secondWord.empty() &&
+          secondWord.find_first_not_of("0123456789-.e") == std::string::npos)
+        implicitCFLnumber = atof(secondWord.c_str());
+    }
+
+    // Maximum number of Newton iterations
+    if (firstWord == "maxNewtonIter") {
+      if (!secondWord.empty() &&
+          secondWord.find_first_not_of("0123456789") == std::string::npos)
+        maxNewtonIter = atof(secondWord.c_str());
+    }
+
+    // Tolerance for Newton iterations
+    if (firstWord == "newtonTolerance") {
+      if (!secondWord.empty() &&
+          secondWord.find_first_not_of("0123456789-.e") == std::string::npos)
+        newtonTolerance = atof(secondWord.c_str());
+    }
+
+    // Maximum number of BiCGStab iterations
+    if (firstWord == "maxKrylovIter") {
+      if (!secondWord.empty() &&
+          secondWord.find_first_not_of("0123456789") == std::string::npos)
+        maxKrylovIter = atof(secondWord.c_str());
+    }
+
+    // Tolerance for BiCGStab iterations
+    if (firstWord == "krylovTolerance") {
+      if (!secondWord.empty() &&
+          secondWord.find_first_not_of("0123456789-.e") == std::string::npos)
+        krylovTolerance = atof(secondWord.c_str());
+    }
+
     // Courant number
     if (firstWord == "CFLnumber") {
       if (!secondWord.empty() &&
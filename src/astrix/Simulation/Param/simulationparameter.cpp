@@ -14,7 +14,7 @@ Astrix is distributed in the hope that it will be useful, but WITHOUT ANY WARRAN
 You should have received a copy of the GNU General Public License
 along with Astrix.  If not, see <http://www.gnu.org/licenses/>.*/
 
-#include <cuda_runtime_api.h>
+#include "../../Common/cudaRuntime.h"
 #include <iostream>
 
 #include "../../Common/definitions.h"
@@ -44,6 +44,18 @@ SimulationParameter::SimulationParameter()
   specificHeatRatio = -1.0;
   CFLnumber = -1.0;
   preferMinMaxBlend = 2;
+
+  // Optional parameters, set to defaults for input files without them
+  gatherResidueFlag = 0;
+  fusedResidualFlag = 0;
+  hostSimdFlag = 1;
+  maxTimeLevel = 0;
+  implicitFlag = 0;
+  implicitCFLnumber = 20.0;
+  maxNewtonIter = 10;
+  newtonTolerance = 1.0e-3;
+  maxKrylovIter = 50;
+  krylovTolerance = 1.0e-2;
 }
 
 //#########################################################################
@@ -48,6 +48,26 @@ class SimulationParameter
   real CFLnumber;
   //! Preference for using minimum/maximum value of blend parameter
   int preferMinMaxBlend;
+  //! Flag whether vertices gather residue from triangles (1) or triangles scatter residue to vertices (0)
+  int gatherResidueFlag;
+  //! Flag whether to compute parameter vector, residual and signal speed in a single pass over triangles (1) or in separate passes (0)
+  int fusedResidualFlag;
+  //! Flag whether host loops over triangles computing residuals are vectorised over batches of triangles (1) or run one triangle at a time (0)
+  int hostSimdFlag;
+  //! Maximum level for local time stepping: triangles take time steps up to 2^maxTimeLevel times the global minimum (0: all triangles take the same time step)
+  int maxTimeLevel;
+  //! Flag whether to integrate implicitly (backward Euler, solved with Newton-Krylov iterations)
+  int implicitFlag;
+  //! Courant number for implicit integration (may be much larger than 1)
+  real implicitCFLnumber;
+  //! Maximum number of Newton iterations per implicit time step
+  int maxNewtonIter;
+  //! Required reduction of nonlinear residual in implicit time step
+  real newtonTolerance;
+  //! Maximum number of BiCGStab iterations per Newton iteration
+  int maxKrylovIter;
+  //! Required reduction of linear residual in every Newton iteration
+  real krylovTolerance;
 
   //! Ratio of specific heats
   real specificHeatRatio;
@@ -60,12 +60,6 @@ void CalcShockSensorSingle(int i, int nVertex,
   int a = pTv[i].x;
   int b = pTv[i].y;
   int c = pTv[i].z;
-  while (a >= nVertex) a -= nVertex;
-  while (b >= nVertex) b -= nVertex;
-  while (c >= nVertex) c -= nVertex;
-  while (a < 0) a += nVertex;
-  while (b < 0) b += nVertex;
-  while (c < 0) c += nVertex;
 
   // State at first vertex
   real dens = pState[a].x;
@@ -167,12 +161,6 @@ void CalcShockSensorSingle(int i, int nVertex,
     int a = pTv[i].x;
     int b = pTv[i].y;
     int c = pTv[i].z;
-    while (a >= nVertex) a -= nVertex;
-    while (b >= nVertex) b -= nVertex;
-    while (c >= nVertex) c -= nVertex;
-    while (a < 0) a += nVertex;
-    while (b < 0) b += nVertex;
-    while (c < 0) c += nVertex;
 
     // State at vertices
     real u1 = pState[a];
@@ -235,7 +223,7 @@ devCalcShockSensor(int nVertex, int nTriangle,
                    real iDv, realNeq *pState, real *pShockSensor,
                    const real G, const real G1, const real *pVp)
 {
-  unsigned int i = blockIdx.x*blockDim.x + threadIdx.x;
+  int i = blockIdx.x*blockDim.x + threadIdx.x;
 
   while (i < nTriangle) {
     CalcShockSensorSingle<CL>(i, nVertex, pTv, pTl, pTn1, pTn2, pTn3,
@@ -262,7 +250,7 @@ void Simulation<realNeq, CL>::CalcShockSensor()
   int nTriangle = mesh->GetNTriangle();
 
   // Triangle vertex indices
-  const int3 *pTv = mesh->TriangleVerticesData();
+  const int3 *pTv = mesh->TriangleVerticesWrappedData();
 
   // Inward pointing edge normals
   const real2 *pTn1 = mesh->TriangleEdgeNormalsData(0);
@@ -293,13 +281,14 @@ void Simulation<realNeq, CL>::CalcShockSensor()
                                        devCalcShockSensor<realNeq, CL>,
                                        (size_t) 0, 0);
 
-    devCalcShockSensor<realNeq, CL><<<nBlocks, nThreads>>>
+    LaunchKernel(nBlocks, nThreads, devCalcShockSensor<realNeq, CL>)
       (nVertex, nTriangle, pTv, pTl, pTn1, pTn2, pTn3,
        1.0/(maxVel - minVel), pState, pShockSensor, G, G - 1.0, pVp);
 
     gpuErrchk( cudaPeekAtLastError() );
     gpuErrchk( cudaDeviceSynchronize() );
   } else {
+#pragma omp parallel for
     for (int i = 0; i < nTriangle; i++)
       CalcShockSensorSingle<CL>(i, nVertex, pTv, pTl, pTn1, pTn2, pTn3,
                                 1.0/(maxVel - minVel), pState, pShockSensor,
@@ -162,7 +162,8 @@ void ExtrapolateSingle(int n, const int3 *pTv, const real2 *pVc,
 
 If a triangle has exactly one vertex on the boundary, we extrapolate the state to this vertex by using the state at the other two vertices.
 
-\param nTriangle Total number of triangles in Mesh
+\param nBoundaryTriangle Number of triangles with a vertex on the boundary
+\param *pBt Pointer to list of triangles with a vertex on the boundary
 \param *pTv Pointer to triangle vertices
 \param *pVc Pointer to coordinates of vertices
 \param *pVbf Pointer to array of boundary flags
@@ -171,15 +172,17 @@ If a triangle has exactly one vertex on the boundary, we extrapolate the state t
 
 template<class realNeq, ConservationLaw CL>
 __global__ void
-devExtrapolateBoundaries(int nTriangle, const int3 *pTv, const real2 *pVc,
+devExtrapolateBoundaries(int nBoundaryTriangle, const int *pBt,
+                         const int3 *pTv, const real2 *pVc,
                          const int *pVbf, realNeq *pState)
 {
-  // n=triangle number
-  int n = blockIdx.x*blockDim.x + threadIdx.x;
+  int i = blockIdx.x*blockDim.x + threadIdx.x;
 
-  while (n < nTriangle) {
+  while (i < nBoundaryTriangle) {
+    // n = triangle number
+    int n = pBt[i];
     ExtrapolateSingle(n, pTv, pVc, pVbf, pState);
-    n += blockDim.x*gridDim.x;
+    i += blockDim.x*gridDim.x;
   }
 }
 
@@ -240,21 +243,23 @@ void SetCornersToZero(int n, const int *pVbf, real *pState)
 
 When extrapolating, the corners of the mesh need special attention. In this function, we set the state to zero.
 
-\param nVertex Total number of vertices in Mesh
+\param nBoundaryVertex Number of vertices on boundary
+\param *pBv Pointer to list of vertices on boundary
 \param *pVbf Pointer to array of boundary flags
 \param *pState Pointer to state vector*/
 //######################################################################
 
 template<class realNeq, ConservationLaw CL>
 __global__ void
-devSetCornersToZero(int nVertex, const int *pVbf, realNeq *pState)
+devSetCornersToZero(int nBoundaryVertex, const int *pBv,
+                    const int *pVbf, realNeq *pState)
 {
-  int n = blockIdx.x*blockDim.x + threadIdx.x;
+  int i = blockIdx.x*blockDim.x + threadIdx.x;
 
-  while (n < nVertex) {
-    SetCornersToZero(n, pVbf, pState);
+  while (i < nBoundaryVertex) {
+    SetCornersToZero(pBv[i], pVbf, pState);
 
-    n += blockDim.x*gridDim.x;
+    i += blockDim.x*gridDim.x;
   }
 }
 
@@ -317,7 +322,8 @@ void ExtrapolateCorners(int n, const int *pVbf,
 
 The state has been set to zero in the corners previously. Now extrapolate the state from the two segments coming together in the corner.
 
-\param nTriangle Total number of triangles in Mesh
+\param nBoundaryTriangle Number of triangles with a vertex on the boundary
+\param *pBt Pointer to list of triangles with a vertex on the boundary
 \param *pVbf Pointer to array of boundary flags
 \param *pTv Pointer to triangle vertices
 \param *pState Pointer to state vector*/
@@ -325,28 +331,31 @@ The state has been set to zero in the corners previously. Now extrapolate the st
 
 template<class realNeq, ConservationLaw CL>
 __global__ void
-devExtrapolateCorners(int nTriangle, const int *pVbf,
+devExtrapolateCorners(int nBoundaryTriangle, const int *pBt, const int *pVbf,
                       const int3* __restrict__ pTv, realNeq *pState)
 {
-  int n = blockIdx.x*blockDim.x + threadIdx.x;
+  int i = blockIdx.x*blockDim.x + threadIdx.x;
 
-  while (n < nTriangle) {
-    ExtrapolateCorners(n, pVbf, pTv, pState);
-    n += blockDim.x*gridDim.x;
+  while (i < nBoundaryTriangle) {
+    ExtrapolateCorners(pBt[i], pVbf, pTv, pState);
+    i += blockDim.x*gridDim.x;
   }
 }
 
 //######################################################################
-/*! Consider all triangles in the Mesh. If a triangle has exactly one
-vertex on the boundary, we extrapolate the state to this vertex by using
-the state at the other two vertices.*/
+/*! Consider all triangles with a vertex on the boundary. If a triangle has
+exactly one vertex on the boundary, we extrapolate the state to this vertex by
+using the state at the other two vertices.*/
 //######################################################################
 
 template <class realNeq, ConservationLaw CL>
 void Simulation<realNeq, CL>::ExtrapolateBoundaries()
 {
-  int nTriangle = mesh->GetNTriangle();
-  int nVertex = mesh->GetNVertex();
+  // Only triangles and vertices at the boundary need to be considered
+  int nBoundaryTriangle = mesh->GetNBoundaryTriangle();
+  const int *pBt = mesh->BoundaryTriangleData();
+  int nBoundaryVertex = mesh->GetNBoundaryVertex();
+  const int *pBv = mesh->BoundaryVertexData();
 
   realNeq *pState = vertexState->GetPointer();
 
@@ -365,14 +374,14 @@ void Simulation<realNeq, CL>::ExtrapolateBoundaries()
                                        (size_t) 0, 0);
 
     // Execute kernel...
-    devExtrapolateBoundaries<<<nBlocks, nThreads>>>
-      (nTriangle, pTv, pVc, pVbf, pState);
+    LaunchKernel(nBlocks, nThreads, devExtrapolateBoundaries)
+      (nBoundaryTriangle, pBt, pTv, pVc, pVbf, pState);
     gpuErrchk( cudaPeekAtLastError() );
     gpuErrchk( cudaDeviceSynchronize() );
   } else {
     // Extrapolate x
-    for (int n = 0; n < nTriangle; n++)
-      ExtrapolateSingle(n, pTv, pVc, pVbf, pState);
+    for (int i = 0; i < nBoundaryTriangle; i++)
+      ExtrapolateSingle(pBt[i], pTv, pVc, pVbf, pState);
   }
 
   // Set the state to zero in the corners
@@ -386,14 +395,15 @@ void Simulation<realNeq, CL>::ExtrapolateBoundaries()
                                        (size_t) 0, 0);
 
     // Execute kernel...
-    devSetCornersToZero<<<nBlocks, nThreads>>>
-      (nVertex, pVbf, pState);
+    LaunchKernel(nBlocks, nThreads, devSetCornersToZero)
+      (nBoundaryVertex, pBv, pVbf, pState);
     gpuErrchk( cudaPeekAtLastError() );
     gpuErrchk( cudaDeviceSynchronize() );
   } else {
     // Set corners to zero
-    for (int n = 0; n < nVertex; n++)
-      SetCornersToZero(n, pVbf, pState);
+#pragma omp parallel for
+    for (int i = 0; i < nBoundaryVertex; i++)
+      SetCornersToZero(pBv[i], pVbf, pState);
   }
 
   // Set the state in the corners to the average of the to joining sides
@@ -407,13 +417,13 @@ void Simulation<realNeq, CL>::ExtrapolateBoundaries()
                                        (size_t) 0, 0);
 
     // Execute kernel...
-    devExtrapolateCorners<<<nBlocks, nThreads>>>
-      (nTriangle, pVbf, pTv, pState);
+    LaunchKernel(nBlocks, nThreads, devExtrapolateCorners)
+      (nBoundaryTriangle, pBt, pVbf, pTv, pState);
     gpuErrchk( cudaPeekAtLastError() );
     gpuErrchk( cudaDeviceSynchronize() );
   } else {
-    for (int n = 0; n < nTriangle; n++)
-      ExtrapolateCorners(n, pVbf, pTv, pState);
+    for (int i = 0; i < nBoundaryTriangle; i++)
+      ExtrapolateCorners(pBt[i], pVbf, pTv, pState);
   }
 }
 
@@ -88,7 +88,8 @@ void SetBoundaryNohVertex(int n, real *pState,
 
 At the outer boundaries the state is set to the analytic solution
 
-\param nVertex Total number of vertices in Mesh
+\param nBoundaryVertex Number of vertices on boundary
+\param *pBv Pointer to list of vertices on boundary
 \param *pState Pointer to state vector
 \param *pVc Pointer to coordinates of vertices
 \param *pVbf Pointer to array of boundary flags
@@ -98,17 +99,18 @@ At the outer boundaries the state is set to the analytic solution
 
 template<class realNeq, ConservationLaw CL>
 __global__ void
-devSetNohBoundaries(int nVertex, realNeq *pState,
+devSetNohBoundaries(int nBoundaryVertex, const int *pBv, realNeq *pState,
                     const real2 *pVc, const int *pVbf,
                     real simulationTime, real iG1)
 {
-  // n=vertex number
-  int n = blockIdx.x*blockDim.x + threadIdx.x;
+  int i = blockIdx.x*blockDim.x + threadIdx.x;
 
-  while (n < nVertex) {
+  while (i < nBoundaryVertex) {
+    // n = vertex number
+    int n = pBv[i];
     SetBoundaryNohVertex(n, pState, pVc, pVbf,
                          simulationTime, iG1);
-    n += blockDim.x*gridDim.x;
+    i += blockDim.x*gridDim.x;
   }
 }
 
@@ -119,7 +121,9 @@ devSetNohBoundaries(int nVertex, realNeq *pState,
 template <class realNeq, ConservationLaw CL>
 void Simulation<realNeq, CL>::SetNohBoundaries()
 {
-  int nVertex = mesh->GetNVertex();
+  // Only vertices on the boundary need to be considered
+  int nBoundaryVertex = mesh->GetNBoundaryVertex();
+  const int *pBv = mesh->BoundaryVertexData();
 
   const real2 *pVc = mesh->VertexCoordinatesData();
   const int *pVbf = mesh->VertexBoundaryFlagData();
@@ -137,15 +141,16 @@ void Simulation<realNeq, CL>::SetNohBoundaries()
                                        (size_t) 0, 0);
 
     // Execute kernel...
-    devSetNohBoundaries<realNeq, CL><<<nBlocks, nThreads>>>
-      (nVertex, pState, pVc, pVbf,
+    LaunchKernel(nBlocks, nThreads, devSetNohBoundaries<realNeq, CL>)
+      (nBoundaryVertex, pBv, pState, pVc, pVbf,
        simulationTime, 1.0/(G - 1.0));
 
     gpuErrchk(cudaPeekAtLastError());
     gpuErrchk(cudaDeviceSynchronize());
   } else {
-    for (int n = 0; n < nVertex; n++)
-      SetBoundaryNohVertex(n, pState, pVc, pVbf,
+#pragma omp parallel for
+    for (int i = 0; i < nBoundaryVertex; i++)
+      SetBoundaryNohVertex(pBv[i], pState, pVc, pVbf,
                                simulationTime,
                                1.0/(G - 1.0));
   }
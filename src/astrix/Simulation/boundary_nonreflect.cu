@@ -48,7 +48,8 @@ void SetNonReflectingVertex(int n, realNeq *pState, realNeq *pStateOld,
   Non-reflecting boundaries are implemented by setting the currect state equal
 to the old state, so that the state at the boundary never changes.
 
-\param nVertex Total number of vertices in Mesh
+\param nBoundaryVertex Number of vertices on boundary
+\param *pBv Pointer to list of vertices on boundary
 \param *pState Pointer to state vector
 \param *pStateOld Pointer to old state vector
 \param *pVbf Pointer to array of boundary flags*/
@@ -56,15 +57,17 @@ to the old state, so that the state at the boundary never changes.
 
 template<class realNeq, ConservationLaw CL>
 __global__ void
-devSetNonReflectingBoundaries(int nVertex, realNeq *pState, realNeq *pStateOld,
+devSetNonReflectingBoundaries(int nBoundaryVertex, const int *pBv,
+                              realNeq *pState, realNeq *pStateOld,
                               const int *pVbf)
 {
-  // n=vertex number
-  int n = blockIdx.x*blockDim.x + threadIdx.x;
+  int i = blockIdx.x*blockDim.x + threadIdx.x;
 
-  while (n < nVertex) {
+  while (i < nBoundaryVertex) {
+    // n = vertex number
+    int n = pBv[i];
     SetNonReflectingVertex<realNeq, CL>(n, pState, pStateOld, pVbf);
-    n += blockDim.x*gridDim.x;
+    i += blockDim.x*gridDim.x;
   }
 }
 
@@ -76,7 +79,9 @@ equal to the old state, so that the state at the boundary never changes.*/
 template <class realNeq, ConservationLaw CL>
 void Simulation<realNeq, CL>::SetNonReflectingBoundaries()
 {
-  int nVertex = mesh->GetNVertex();
+  // Only vertices on the boundary need to be considered
+  int nBoundaryVertex = mesh->GetNBoundaryVertex();
+  const int *pBv = mesh->BoundaryVertexData();
 
   realNeq *pState = vertexState->GetPointer();
   realNeq *pStateOld = vertexStateOld->GetPointer();
@@ -94,14 +99,15 @@ void Simulation<realNeq, CL>::SetNonReflectingBoundaries()
        (size_t) 0, 0);
 
     // Execute kernel...
-    devSetNonReflectingBoundaries<realNeq, CL><<<nBlocks, nThreads>>>
-      (nVertex, pState, pStateOld, pVbf);
+    LaunchKernel(nBlocks, nThreads, devSetNonReflectingBoundaries<realNeq, CL>)
+      (nBoundaryVertex, pBv, pState, pStateOld, pVbf);
     gpuErrchk( cudaPeekAtLastError() );
     gpuErrchk( cudaDeviceSynchronize() );
   } else {
     // Set boundary state to previous state (= initial state)
-    for (int n = 0; n < nVertex; n++)
-      SetNonReflectingVertex<realNeq, CL>(n, pState, pStateOld, pVbf);
+#pragma omp parallel for
+    for (int i = 0; i < nBoundaryVertex; i++)
+      SetNonReflectingVertex<realNeq, CL>(pBv[i], pState, pStateOld, pVbf);
   }
 }
 
@@ -16,6 +16,7 @@ along with Astrix.  If not, see <http://www.gnu.org/licenses/>.*/
 #include "../Common/definitions.h"
 #include "../Array/array.h"
 #include "./simulation.h"
+#include "./timelevel.h"
 #include "../Mesh/mesh.h"
 #include "../Common/cudaLow.h"
 #include "../Common/inlineMath.h"
@@ -517,6 +518,7 @@ void SetReflectingSingle(int n, real dt, realNeq *pState, const int3 *pTv,
 Reflecting boundary conditions are implemented "weakly" by adding a corrective flux that counteracts any flow through the boundary.
 
 \param dt Time step
+\param *pTdt Pointer to time step of triangles with local time stepping, or zero
 \param *pState Pointer to state vector
 \param *pTv Pointer to triangle vertices
 \param *pTe Pointer to triangle edges
@@ -526,7 +528,8 @@ Reflecting boundary conditions are implemented "weakly" by adding a corrective f
 \param *pTn1 Pointer to first edge normal of triangle
 \param *pTn2 Pointer to first edge normal of triangle
 \param *pTn3 Pointer to first edge normal of triangle
-\param nTriangle Total number of triangles in Mesh
+\param nSegmentTriangle Number of triangles with an edge on the boundary
+\param *pSt Pointer to list of triangles with an edge on the boundary
 \param nVertex Total number of vertices in Mesh
 \param G1 Ratio of specific heats - 1
 \param *pVp Pointer to external potential at vertices*/
@@ -534,28 +537,30 @@ Reflecting boundary conditions are implemented "weakly" by adding a corrective f
 
 template<class realNeq, ConservationLaw CL>
 __global__ void
-devSetReflecting(real dt, realNeq *pState, const int3 *pTv,
+devSetReflecting(real dt, const real *pTdt, realNeq *pState, const int3 *pTv,
                  const int3* __restrict__ pTe,
                  const int2* __restrict__ pEt,
                  const real *pVarea, const real3 *pTl,
                  const real2 *pTn1, const real2 *pTn2, const real2 *pTn3,
-                 int nTriangle, int nVertex, real G1, real *pVp)
+                 int nSegmentTriangle, const int *pSt,
+                 int nVertex, real G1, real *pVp)
 {
-  unsigned int n = blockIdx.x*blockDim.x + threadIdx.x;
+  int i = blockIdx.x*blockDim.x + threadIdx.x;
 
-  while (n < nTriangle) {
-    SetReflectingSingle<realNeq, CL>(n, dt, pState,
-                                     pTv, pTe, pEt,
+  while (i < nSegmentTriangle) {
+    int n = pSt[i];
+    SetReflectingSingle<realNeq, CL>(n, TriangleTimestep(n, dt, pTdt),
+                                     pState, pTv, pTe, pEt,
                                      pVarea, pTl,
                                      pTn1, pTn2, pTn3,
                                      nVertex, G1, pVp);
 
-    n += gridDim.x*blockDim.x;
+    i += gridDim.x*blockDim.x;
   }
 }
 
 //#########################################################################
-/*! Reflecting boundary conditions are implemented "weakly" by adding a corrective flux that counteracts any flow through the boundary.
+/*! Reflecting boundary conditions are implemented "weakly" by adding a corrective flux that counteracts any flow through the boundary. Only triangles with an edge on the boundary are considered.
 
   \param dt Time step*/
 //#########################################################################
@@ -575,9 +580,17 @@ void Simulation<realNeq, CL>::ReflectingBoundaries(real dt)
   const real2 *pTn3 = mesh->TriangleEdgeNormalsData(2);
   const real3 *pTl = mesh->TriangleEdgeLengthData();
 
-  int nTriangle = mesh->GetNTriangle();
+  // Only triangles with an edge on the boundary need to be considered
+  int nSegmentTriangle = mesh->GetNSegmentTriangle();
+  const int *pSt = mesh->SegmentTriangleData();
+
   int nVertex = mesh->GetNVertex();
 
+  // With local time stepping, use time step of boundary triangle
+  const real *pTdt = 0;
+  if (localTimeStepFlag == 1)
+    pTdt = triangleTimestep->GetPointer();
+
   real G = simulationParameter->specificHeatRatio;
 
   if (cudaFlag == 1) {
@@ -589,18 +602,20 @@ void Simulation<realNeq, CL>::ReflectingBoundaries(real dt)
                                        devSetReflecting<realNeq, CL>,
                                        (size_t) 0, 0);
 
-    devSetReflecting<realNeq, CL><<<nBlocks, nThreads>>>
-      (dt, pState, pTv, pTe, pEt, pVarea, pTl,
-       pTn1, pTn2, pTn3, nTriangle, nVertex, G - 1.0, pVp);
+    LaunchKernel(nBlocks, nThreads, devSetReflecting<realNeq, CL>)
+      (dt, pTdt, pState, pTv, pTe, pEt, pVarea, pTl,
+       pTn1, pTn2, pTn3, nSegmentTriangle, pSt, nVertex, G - 1.0, pVp);
 
     gpuErrchk( cudaPeekAtLastError() );
     gpuErrchk( cudaDeviceSynchronize() );
   } else {
-    for (int n = 0; n < nTriangle; n++)
-      SetReflectingSingle<realNeq, CL>(n, dt, pState,
-                                       pTv, pTe, pEt, pVarea, pTl,
+    for (int i = 0; i < nSegmentTriangle; i++) {
+      int n = pSt[i];
+      SetReflectingSingle<realNeq, CL>(n, TriangleTimestep(n, dt, pTdt),
+                                       pState, pTv, pTe, pEt, pVarea, pTl,
                                        pTn1, pTn2, pTn3,
                                        nVertex, G - 1.0, pVp);
+    }
   }
 }
 
@@ -135,7 +135,8 @@ shock, with a speed we can compute. This makes it easy to set appropriate
 boundary conditions. Note that this is specific for the 2D Riemann problem
 implemented!
 
-\param nVertex Total number of vertices in Mesh
+\param nBoundaryVertex Number of vertices on boundary
+\param *pBv Pointer to list of vertices on boundary
 \param *pState Pointer to state vector
 \param *pVc Pointer to coordinates of vertices
 \param *pVbf Pointer to array of boundary flags
@@ -145,17 +146,18 @@ implemented!
 
 template<class realNeq, ConservationLaw CL>
 __global__ void
-devSetRiemannBoundaries(int nVertex, realNeq *pState,
+devSetRiemannBoundaries(int nBoundaryVertex, const int *pBv, realNeq *pState,
                         const real2 *pVc, const int *pVbf,
                         real simulationTime, real iG1)
 {
-  // n=vertex number
-  int n = blockIdx.x*blockDim.x + threadIdx.x;
+  int i = blockIdx.x*blockDim.x + threadIdx.x;
 
-  while (n < nVertex) {
+  while (i < nBoundaryVertex) {
+    // n = vertex number
+    int n = pBv[i];
     SetBoundaryRiemannVertex(n, pState, pVc, pVbf,
                              simulationTime, iG1);
-    n += blockDim.x*gridDim.x;
+    i += blockDim.x*gridDim.x;
   }
 }
 
@@ -169,7 +171,9 @@ implemented!*/
 template <class realNeq, ConservationLaw CL>
 void Simulation<realNeq, CL>::SetRiemannBoundaries()
 {
-  int nVertex = mesh->GetNVertex();
+  // Only vertices on the boundary need to be considered
+  int nBoundaryVertex = mesh->GetNBoundaryVertex();
+  const int *pBv = mesh->BoundaryVertexData();
 
   const real2 *pVc = mesh->VertexCoordinatesData();
   const int *pVbf = mesh->VertexBoundaryFlagData();
@@ -187,15 +191,16 @@ void Simulation<realNeq, CL>::SetRiemannBoundaries()
                                        (size_t) 0, 0);
 
     // Execute kernel...
-    devSetRiemannBoundaries<realNeq, CL><<<nBlocks, nThreads>>>
-      (nVertex, pState, pVc, pVbf,
+    LaunchKernel(nBlocks, nThreads, devSetRiemannBoundaries<realNeq, CL>)
+      (nBoundaryVertex, pBv, pState, pVc, pVbf,
        simulationTime, 1.0/(G - 1.0));
 
     gpuErrchk(cudaPeekAtLastError());
     gpuErrchk(cudaDeviceSynchronize());
   } else {
-    for (int n = 0; n < nVertex; n++)
-      SetBoundaryRiemannVertex(n, pState, pVc, pVbf,
+#pragma omp parallel for
+    for (int i = 0; i < nBoundaryVertex; i++)
+      SetBoundaryRiemannVertex(pBv[i], pState, pVc, pVbf,
                                simulationTime,
                                1.0/(G - 1.0));
   }
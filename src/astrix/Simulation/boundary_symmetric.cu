@@ -139,7 +139,8 @@ void SetSymmetricSingle(int n, realNeq *pState, const int3 *pTv,
 \param *pTn1 Pointer to first edge normal of triangle
 \param *pTn2 Pointer to first edge normal of triangle
 \param *pTn3 Pointer to first edge normal of triangle
-\param nTriangle Total number of triangles in Mesh
+\param nSegmentTriangle Number of triangles with an edge on the boundary
+\param *pSt Pointer to list of triangles with an edge on the boundary
 \param nVertex Total number of vertices in Mesh*/
 //############################################################################
 
@@ -149,15 +150,15 @@ devSetSymmetry(realNeq *pState, const int3 *pTv,
                const int3* __restrict__ pTe,
                const int2* __restrict__ pEt,
                const real2 *pTn1, const real2 *pTn2, const real2 *pTn3,
-               int nTriangle, int nVertex)
+               int nSegmentTriangle, const int *pSt, int nVertex)
 {
-  unsigned int n = blockIdx.x*blockDim.x + threadIdx.x;
+  int i = blockIdx.x*blockDim.x + threadIdx.x;
 
-  while (n < nTriangle) {
-    SetSymmetricSingle<realNeq, CL>(n, pState, pTv, pTe,
+  while (i < nSegmentTriangle) {
+    SetSymmetricSingle<realNeq, CL>(pSt[i], pState, pTv, pTe,
                                     pEt, pTn1, pTn2, pTn3, nVertex);
 
-    n += gridDim.x*blockDim.x;
+    i += gridDim.x*blockDim.x;
   }
 }
 
@@ -177,7 +178,10 @@ void Simulation<realNeq, CL>::SetSymmetricBoundaries()
   const real2 *pTn2 = mesh->TriangleEdgeNormalsData(1);
   const real2 *pTn3 = mesh->TriangleEdgeNormalsData(2);
 
-  int nTriangle = mesh->GetNTriangle();
+  // Only triangles with an edge on the boundary need to be considered
+  int nSegmentTriangle = mesh->GetNSegmentTriangle();
+  const int *pSt = mesh->SegmentTriangleData();
+
   int nVertex = mesh->GetNVertex();
 
   if (cudaFlag == 1) {
@@ -189,15 +193,15 @@ void Simulation<realNeq, CL>::SetSymmetricBoundaries()
                                        devSetSymmetry<realNeq, CL>,
                                        (size_t) 0, 0);
 
-    devSetSymmetry<realNeq, CL><<<nBlocks, nThreads>>>
+    LaunchKernel(nBlocks, nThreads, devSetSymmetry<realNeq, CL>)
       (pState, pTv, pTe, pEt,
-       pTn1, pTn2, pTn3, nTriangle, nVertex);
+       pTn1, pTn2, pTn3, nSegmentTriangle, pSt, nVertex);
 
     gpuErrchk( cudaPeekAtLastError() );
     gpuErrchk( cudaDeviceSynchronize() );
   } else {
-    for (int n = 0; n < nTriangle; n++)
-      SetSymmetricSingle<realNeq, CL>(n, pState,
+    for (int i = 0; i < nSegmentTriangle; i++)
+      SetSymmetricSingle<realNeq, CL>(pSt[i], pState,
                                       pTv, pTe, pEt,
                                       pTn1, pTn2, pTn3,
                                       nVertex);
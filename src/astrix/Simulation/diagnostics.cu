@@ -105,12 +105,13 @@ real Simulation<realNeq, CL>::DensityError()
                                        devDensityError<realNeq, CL>,
                                        (size_t) 0, 0);
 
-    devDensityError<realNeq, CL><<<nBlocks, nThreads>>>
+    LaunchKernel(nBlocks, nThreads, devDensityError<realNeq, CL>)
       (nVertex, pVarea, pState, pStateExact, pE);
 
     gpuErrchk( cudaPeekAtLastError() );
     gpuErrchk( cudaDeviceSynchronize() );
   } else {
+#pragma omp parallel for
     for (unsigned int n = 0; n < nVertex; n++)
       DensityErrorSingle<realNeq, CL>(n, pVarea, pState, pStateExact, pE);
   }
@@ -157,11 +157,12 @@ void Simulation<realNeq, CL>::ReplaceEnergyWithPressure()
        devReplaceEnergyWithPressure<realNeq, CL>,
        (size_t) 0, 0);
 
-    devReplaceEnergyWithPressure<realNeq, CL><<<nBlocks, nThreads>>>
+    LaunchKernel(nBlocks, nThreads, devReplaceEnergyWithPressure<realNeq, CL>)
       (nVertex, pState, G - 1.0, pVp);
     gpuErrchk( cudaPeekAtLastError() );
     gpuErrchk( cudaDeviceSynchronize() );
   } else {
+#pragma omp parallel for
     for (int i = 0; i < nVertex; i++)
       ReplaceEnergyWithPressureSingle(i, pState, G - 1.0, pVp);
   }
@@ -193,11 +194,12 @@ void Simulation<realNeq, CL>::ReplacePressureWithEnergy()
        devReplacePressureWithEnergy<realNeq, CL>,
        (size_t) 0, 0);
 
-    devReplacePressureWithEnergy<realNeq, CL><<<nBlocks, nThreads>>>
+    LaunchKernel(nBlocks, nThreads, devReplacePressureWithEnergy<realNeq, CL>)
       (nVertex, pState, 1.0/(G - 1.0), pVp);
     gpuErrchk( cudaPeekAtLastError() );
     gpuErrchk( cudaDeviceSynchronize() );
   } else {
+#pragma omp parallel for
     for (int i = 0; i < nVertex; i++)
       ReplacePressureWithEnergySingle(i, pState, 1.0/(G - 1.0), pVp);
   }
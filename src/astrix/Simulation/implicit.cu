@@ -0,0 +1,591 @@
+// -*-c++-*-
+/*! \file implicit.cu
+\brief Functions for implicit time integration
+
+With implicit integration, the state is advanced using the backward Euler method: W - Wold + dt R(W) = 0, where R(W) is the spatial residual distributed over the vertices (the rate of change of the state in an explicit update). This nonlinear system is solved with Newton iterations. The linear systems for the Newton corrections are solved with BiCGStab without forming the Jacobian: Jacobian-vector products are approximated by finite differences of the residual, calculated by the same kernels as used for explicit updates. Since the time step is not limited by the Courant condition, this is useful for slowly evolving or steady flows.
+
+\section LICENSE
+Copyright (c) 2017 Sijme-Jan Paardekooper
+
+This file is part of Astrix.
+
+Astrix is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+
+Astrix is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Astrix.  If not, see <http://www.gnu.org/licenses/>.*/
+#include <iostream>
+#include <iomanip>
+#include <limits>
+#include <chrono>
+#include <utility>
+
+#include "../Common/definitions.h"
+#include "../Array/array.h"
+#include "../Mesh/mesh.h"
+#include "./simulation.h"
+#include "../Common/cudaLow.h"
+#include "../Common/nvtxEvent.h"
+#include "../Common/profile.h"
+#include "./Param/simulationparameter.h"
+
+namespace astrix {
+
+//######################################################################
+/*! \brief Calculate nonlinear residual for element \a i
+
+State vectors are treated as vectors of reals, of which \a i is one element.
+
+\param i Element to consider
+\param *pW Pointer to state for which to calculate residual
+\param *pWold Pointer to state at start of time step
+\param *pWexp Pointer to state after explicit update of \a pW with time step h
+\param idt 1/dt, with dt the implicit time step
+\param ih 1/h
+\param *pG Pointer to nonlinear residual (output)*/
+//######################################################################
+
+__host__ __device__
+void CalcImplicitResidualSingle(int i, const real *pW, const real *pWold,
+                                const real *pWexp, real idt, real ih,
+                                real *pG)
+{
+  pG[i] = (pW[i] - pWold[i])*idt + (pW[i] - pWexp[i])*ih;
+}
+
+//######################################################################
+/*! \brief Kernel calculating nonlinear residual
+
+\param N Total number of elements (number of vertices times number of equations)
+\param *pW Pointer to state for which to calculate residual
+\param *pWold Pointer to state at start of time step
+\param *pWexp Pointer to state after explicit update of \a pW with time step h
+\param idt 1/dt, with dt the implicit time step
+\param ih 1/h
+\param *pG Pointer to nonlinear residual (output)*/
+//######################################################################
+
+__global__ void
+devCalcImplicitResidual(int N, const real *pW, const real *pWold,
+                        const real *pWexp, real idt, real ih, real *pG)
+{
+  int i = blockIdx.x*blockDim.x + threadIdx.x;
+
+  while (i < N) {
+    CalcImplicitResidualSingle(i, pW, pWold, pWexp, idt, ih, pG);
+
+    i += blockDim.x*gridDim.x;
+  }
+}
+
+//######################################################################
+/*! \brief Set element \a i of \a pOut to \a pA + \a f \a pB
+
+\param i Element to consider
+\param *pA Pointer to first vector
+\param f Factor to multiply second vector with
+\param *pB Pointer to second vector
+\param *pOut Pointer to output vector, may be equal to \a pA*/
+//######################################################################
+
+__host__ __device__
+void AddScaledVectorSingle(int i, const real *pA, real f, const real *pB,
+                           real *pOut)
+{
+  pOut[i] = pA[i] + f*pB[i];
+}
+
+//######################################################################
+/*! \brief Kernel setting \a pOut = \a pA + \a f \a pB
+
+\param N Total number of elements
+\param *pA Pointer to first vector
+\param f Factor to multiply second vector with
+\param *pB Pointer to second vector
+\param *pOut Pointer to output vector, may be equal to \a pA*/
+//######################################################################
+
+__global__ void
+devAddScaledVector(int N, const real *pA, real f, const real *pB, real *pOut)
+{
+  int i = blockIdx.x*blockDim.x + threadIdx.x;
+
+  while (i < N) {
+    AddScaledVectorSingle(i, pA, f, pB, pOut);
+
+    i += blockDim.x*gridDim.x;
+  }
+}
+
+//######################################################################
+/*! \brief Apply preconditioner to element \a i
+
+The preconditioner is a diagonal approximation to the Jacobian of the nonlinear residual. The residual at a vertex changes with the local state at a rate of roughly the inverse of the maximum explicit time step at the vertex, so that this amounts to a local time step.
+
+\param i Element to consider
+\param nEq Number of equations
+\param *pVts Pointer to maximum explicit time step at vertices
+\param idt 1/dt, with dt the implicit time step
+\param *pIn Pointer to input vector
+\param *pOut Pointer to output vector*/
+//######################################################################
+
+__host__ __device__
+void ImplicitPreconditionSingle(int i, int nEq, const real *pVts, real idt,
+                                const real *pIn, real *pOut)
+{
+  const real one = (real) 1.0;
+
+  pOut[i] = pIn[i]/(idt + one/pVts[i/nEq]);
+}
+
+//######################################################################
+/*! \brief Kernel applying preconditioner
+
+\param N Total number of elements
+\param nEq Number of equations
+\param *pVts Pointer to maximum explicit time step at vertices
+\param idt 1/dt, with dt the implicit time step
+\param *pIn Pointer to input vector
+\param *pOut Pointer to output vector*/
+//######################################################################
+
+__global__ void
+devImplicitPrecondition(int N, int nEq, const real *pVts, real idt,
+                        const real *pIn, real *pOut)
+{
+  int i = blockIdx.x*blockDim.x + threadIdx.x;
+
+  while (i < N) {
+    ImplicitPreconditionSingle(i, nEq, pVts, idt, pIn, pOut);
+
+    i += blockDim.x*gridDim.x;
+  }
+}
+
+//######################################################################
+/*! \brief Set \a pOut = \a pA + \a f \a pB for vectors of \a N elements
+
+\param N Total number of elements
+\param *pA Pointer to first vector
+\param f Factor to multiply second vector with
+\param *pB Pointer to second vector
+\param *pOut Pointer to output vector, may be equal to \a pA
+\param cudaFlag Flag whether vectors live on device*/
+//######################################################################
+
+void AddScaledVector(int N, const real *pA, real f, const real *pB,
+                     real *pOut, int cudaFlag)
+{
+  if (cudaFlag == 1) {
+    int nBlocks = 128;
+    int nThreads = 128;
+
+    // Base nThreads and nBlocks on maximum occupancy
+    cudaOccupancyMaxPotentialBlockSize(&nBlocks, &nThreads,
+                                       devAddScaledVector,
+                                       (size_t) 0, 0);
+
+    LaunchKernel(nBlocks, nThreads, devAddScaledVector)
+      (N, pA, f, pB, pOut);
+
+    gpuErrchk( cudaPeekAtLastError() );
+    gpuErrchk( cudaDeviceSynchronize() );
+  } else {
+#pragma omp parallel for
+    for (int i = 0; i < N; i++)
+      AddScaledVectorSingle(i, pA, f, pB, pOut);
+  }
+}
+
+//#########################################################################
+/*! Calculate nonlinear residual G(W) = (W - Wold)/dt + R(W) of the backward Euler update, where R(W) is the rate of change of W in an explicit first order update. This is evaluated by doing an explicit update with a time step h that satisfies the Courant condition: R(W) = (W - W')/h, with W' the updated state. Since the update is linear in h, the result does not depend on h. On return, \a vertexState holds the current Newton iterate.
+
+\param *state State for which to calculate residual
+\param *G Nonlinear residual, stored as vector of reals (output)*/
+//#########################################################################
+
+template <class realNeq, ConservationLaw CL>
+void Simulation<realNeq, CL>::CalcImplicitResidual(Array<realNeq> *state,
+                                                   Array<real> *G)
+{
+  int nVertex = mesh->GetNVertex();
+  int N = nVertex*sizeof(realNeq)/sizeof(real);
+
+  vertexState->SetEqual(state);
+
+  // Calculate source term
+  (this->*problemPipeline.source)();
+
+  // Calculate parameter vector Z at nodes
+  CalculateParameterVector(0);
+
+  // Calculate (space) residuals at triangles
+  CalcResidual();
+
+  // Explicit update with time step h
+  if (simulationParameter->intScheme == SCHEME_BX) CalcShockSensor();
+  AddResidue(implicitResidualStep);
+
+  // Reflecting boundaries add a flux through the boundary
+  (this->*problemPipeline.fluxBoundaries)(implicitResidualStep);
+
+  G->SetSize(N);
+
+  const real *pW = (const real *) state->GetPointer();
+  const real *pWold = (const real *) vertexStateOld->GetPointer();
+  const real *pWexp = (const real *) vertexState->GetPointer();
+  real *pG = G->GetPointer();
+
+  real idt = 1.0/implicitTimestep;
+  real ih = 1.0/implicitResidualStep;
+
+  if (cudaFlag == 1) {
+    int nBlocks = 128;
+    int nThreads = 128;
+
+    // Base nThreads and nBlocks on maximum occupancy
+    cudaOccupancyMaxPotentialBlockSize(&nBlocks, &nThreads,
+                                       devCalcImplicitResidual,
+                                       (size_t) 0, 0);
+
+    LaunchKernel(nBlocks, nThreads, devCalcImplicitResidual)
+      (N, pW, pWold, pWexp, idt, ih, pG);
+
+    gpuErrchk( cudaPeekAtLastError() );
+    gpuErrchk( cudaDeviceSynchronize() );
+  } else {
+#pragma omp parallel for
+    for (int i = 0; i < N; i++)
+      CalcImplicitResidualSingle(i, pW, pWold, pWexp, idt, ih, pG);
+  }
+
+  vertexState->SetEqual(vertexStateNewton);
+}
+
+//#########################################################################
+/*! Approximate the product of the Jacobian of the nonlinear residual G at the current Newton iterate W and vector \a vIn by a finite difference: J v = (G(W + eps v) - G(W))/eps.
+
+\param *vIn Input vector
+\param *vOut Output vector J vIn*/
+//#########################################################################
+
+template <class realNeq, ConservationLaw CL>
+void Simulation<realNeq, CL>::MultiplyByMatrix(Array<real> *vIn,
+                                               Array<real> *vOut)
+{
+  int nVertex = mesh->GetNVertex();
+  int N = nVertex*sizeof(realNeq)/sizeof(real);
+
+  vOut->SetSize(N);
+
+  real vNorm = sqrt(vIn->InnerProduct(vIn));
+  if (vNorm == (real) 0.0) {
+    vOut->SetToValue(0.0);
+    return;
+  }
+
+  // Perturbation size balancing truncation and round-off error
+  real eps = sqrt(std::numeric_limits<real>::epsilon())*
+    ((real) 1.0 + implicitStateNorm)/vNorm;
+
+  // Perturbed state W + eps*v
+  vertexStatePerturbed->SetSize(nVertex);
+  AddScaledVector(N, (const real *) vertexStateNewton->GetPointer(),
+                  eps, vIn->GetPointer(),
+                  (real *) vertexStatePerturbed->GetPointer(), cudaFlag);
+
+  CalcImplicitResidual(vertexStatePerturbed, vOut);
+
+  // (G(W + eps*v) - G(W))/eps
+  vOut->LinComb(1.0/eps, vOut, -1.0/eps, implicitResidual);
+}
+
+//#########################################################################
+/*! Apply diagonal preconditioner, see ImplicitPreconditionSingle(). Requires the maximum explicit time step at the vertices as calculated by CalcVertexTimeStep().
+
+\param *vIn Input vector
+\param *vOut Output vector M^-1 vIn*/
+//#########################################################################
+
+template <class realNeq, ConservationLaw CL>
+void Simulation<realNeq, CL>::Precondition(Array<real> *vIn,
+                                           Array<real> *vOut)
+{
+  int nVertex = mesh->GetNVertex();
+  int nEq = sizeof(realNeq)/sizeof(real);
+  int N = nVertex*nEq;
+
+  vOut->SetSize(N);
+
+  const real *pVts = vertexTimestep->GetPointer();
+  const real *pIn = vIn->GetPointer();
+  real *pOut = vOut->GetPointer();
+
+  real idt = 1.0/implicitTimestep;
+
+  if (cudaFlag == 1) {
+    int nBlocks = 128;
+    int nThreads = 128;
+
+    // Base nThreads and nBlocks on maximum occupancy
+    cudaOccupancyMaxPotentialBlockSize(&nBlocks, &nThreads,
+                                       devImplicitPrecondition,
+                                       (size_t) 0, 0);
+
+    LaunchKernel(nBlocks, nThreads, devImplicitPrecondition)
+      (N, nEq, pVts, idt, pIn, pOut);
+
+    gpuErrchk( cudaPeekAtLastError() );
+    gpuErrchk( cudaDeviceSynchronize() );
+  } else {
+#pragma omp parallel for
+    for (int i = 0; i < N; i++)
+      ImplicitPreconditionSingle(i, nEq, pVts, idt, pIn, pOut);
+  }
+}
+
+//#########################################################################
+/*! Advance the state over a time step \a dt with the backward Euler method, using Newton iterations. Every Newton iteration solves J dW = -G(W) with BiCGStab, where J is the Jacobian of the nonlinear residual G. Iterations stop when |G| has dropped by a factor newtonTolerance, or after maxNewtonIter iterations. An iterate that does not decrease |G| is rejected, and iterations stop with the previous iterate. If a Newton correction leads to an unphysical state it is halved until the state is physical. Returns 0 if |G| was reduced; otherwise returns 1 and the caller should restore the state and retry with a smaller time step.
+
+\param dt Time step*/
+//#########################################################################
+
+template <class realNeq, ConservationLaw CL>
+int Simulation<realNeq, CL>::ImplicitUpdate(real dt)
+{
+  int nVertex = mesh->GetNVertex();
+  int N = nVertex*sizeof(realNeq)/sizeof(real);
+
+  implicitTimestep = dt;
+
+  vertexStateNewton->SetSize(nVertex);
+  vertexStateTrial->SetSize(nVertex);
+  vertexUnphysicalFlag->SetSize(nVertex);
+  implicitRhs->SetSize(N);
+  implicitCorrection->SetSize(N);
+  implicitState->SetSize(N);
+
+  // Set Wold = W
+  vertexStateOld->SetEqual(vertexState);
+
+  int maxNewtonIter = simulationParameter->maxNewtonIter;
+  real newtonTolerance = simulationParameter->newtonTolerance;
+
+  real norm0 = 0.0;
+  real norm = 0.0;
+  int nIter = 0;
+  int nKrylovIter = 0;
+
+  for (;;) {
+    // Problem-specific boundary conditions
+    (this->*problemPipeline.stateBoundaries)();
+
+    // Trial iterate; vertexStateNewton holds the last accepted iterate
+    vertexStateTrial->SetEqual(vertexState);
+    if (nIter == 0) vertexStateNewton->SetEqual(vertexState);
+
+    // Nonlinear residual at trial iterate; on return vertexState holds
+    // the last accepted iterate
+    CalcImplicitResidual(vertexStateTrial, implicitResidual);
+
+    real normTrial = sqrt(implicitResidual->InnerProduct(implicitResidual));
+    if (nIter == 0) norm0 = normTrial;
+
+    if (verboseLevel > 1)
+      std::cout << "Newton iteration " << nIter
+                << ", |G| = " << normTrial << std::endl;
+
+    // Reject trial iterate if residual no longer decreases, for example
+    // because the blend parameter of the B scheme is not smooth or
+    // BiCGStab did not converge. Keep the last accepted iterate.
+    if (nIter > 0 && normTrial >= norm) break;
+
+    // Accept trial iterate
+    std::swap(vertexStateNewton, vertexStateTrial);
+    vertexState->SetEqual(vertexStateNewton);
+    norm = normTrial;
+
+    if (norm <= newtonTolerance*norm0 || nIter == maxNewtonIter) break;
+
+    nIter++;
+
+    // Copy current iterate to vector of reals to find its norm, which sets
+    // the size of the finite difference perturbation
+    AddScaledVector(N, (const real *) vertexStateNewton->GetPointer(),
+                    0.0, (const real *) vertexStateNewton->GetPointer(),
+                    implicitState->GetPointer(), cudaFlag);
+    implicitStateNorm = sqrt(implicitState->InnerProduct(implicitState));
+
+    // Solve J*dW = -G
+    implicitRhs->LinComb(-1.0, implicitResidual);
+    implicitCorrection->SetToValue(0.0);
+    nKrylovIter += linSys->BiCGStab(this, implicitCorrection, implicitRhs,
+                                    simulationParameter->maxKrylovIter,
+                                    simulationParameter->krylovTolerance);
+
+    // W = W + f*dW, halving f until state is physical
+    real f = 1.0;
+    int failFlag = 1;
+    while (failFlag > 0) {
+      AddScaledVector(N, (const real *) vertexStateNewton->GetPointer(),
+                      f, implicitCorrection->GetPointer(),
+                      (real *) vertexState->GetPointer(), cudaFlag);
+
+      FlagUnphysical(vertexUnphysicalFlag);
+      failFlag = vertexUnphysicalFlag->Maximum();
+
+      if (failFlag > 0) {
+        f = 0.5*f;
+        if (f < (real) 1.0e-3) {
+          if (verboseLevel > 0)
+            std::cout << "Unphysical state in Newton iteration "
+                      << nIter << " ";
+          nNewtonIteration += nIter;
+          return 1;
+        }
+      }
+    }
+
+    // Symmetric and nonreflecting boundaries
+    (this->*problemPipeline.updateBoundaries)();
+  }
+
+  nNewtonIteration += nIter;
+
+  if (verboseLevel > 0)
+    std::cout << "(" << nIter << " Newton, "
+              << nKrylovIter << " BiCGStab iterations) ";
+
+  // Failure if Newton iterations did not reduce |G|
+  if (norm > newtonTolerance*norm0 && norm >= norm0) return 1;
+
+  return 0;
+}
+
+//#########################################################################
+/*! Do a single implicit time step. The time step is set by implicitCFLnumber rather than CFLnumber, which is only used for evaluating residuals. If the Newton iterations fail to reduce the nonlinear residual, the step is rejected and retried with half the time step.*/
+//#########################################################################
+
+template <class realNeq, ConservationLaw CL>
+void Simulation<realNeq, CL>::DoImplicitTimeStep()
+{
+  nvtxEvent *nvtxHydro = new nvtxEvent("Implicit", 2);
+
+  auto start = std::chrono::high_resolution_clock::now();
+
+  // Number of time steps taken
+  nTimeStep++;
+
+  if (verboseLevel > 0)
+    std::cout << std::setprecision(12)
+              << "Starting time step " << nTimeStep << ", ";
+
+  // Maximum explicit time step at vertices
+  CalcVertexTimeStep();
+  real dtMin = vertexTimestep->Minimum();
+  implicitResidualStep = simulationParameter->CFLnumber*dtMin;
+
+  real dt = simulationParameter->implicitCFLnumber*dtMin;
+
+  // End exactly on maxSimulationTime
+  if (simulationTime + dt > simulationParameter->maxSimulationTime)
+    dt = simulationParameter->maxSimulationTime - simulationTime;
+
+  real dtStart = dt;
+
+  for (;;) {
+    if (verboseLevel > 0)
+      std::cout << std::setprecision(6)
+                << "t = " << simulationTime << " dt = " << dt << " ";
+
+    int failFlag = 0;
+    try {
+      failFlag = ImplicitUpdate(dt);
+    }
+    catch (...) {
+      std::cout << "Implicit update failed!" << std::endl;
+      throw;
+    }
+
+    if (failFlag == 0) break;
+
+    // Reject step: restore state and retry with smaller time step
+    vertexState->SetEqual(vertexStateOld);
+    nImplicitReject++;
+    dt = 0.5*dt;
+
+    if (dt < (real) 1.0e-3*dtStart) {
+      std::cout << "Newton iterations failed to reduce residual"
+                << std::endl;
+      throw std::runtime_error("");
+    }
+
+    if (verboseLevel > 0)
+      std::cout << "rejected, ";
+  }
+
+  // Increase time
+  simulationTime += dt;
+
+  auto finish = std::chrono::high_resolution_clock::now();
+  std::chrono::duration<double> elapsed = finish - start;
+
+  nImplicitStep++;
+  implicitTime += elapsed.count();
+
+  if (verboseLevel > 0)
+    std::cout << elapsed.count() << " s" << std::endl;
+
+#ifdef TIME_ASTRIX
+  AddProfile("ImplicitTimeStep", mesh->GetNVertex(),
+             1000.0*elapsed.count(), cudaFlag);
+#endif
+
+  // Kernel timings, if compiled with TIME_ASTRIX
+  WriteProfileInterval(nTimeStep);
+
+  delete nvtxHydro;
+}
+
+//##############################################################################
+// Instantiate
+//##############################################################################
+
+template void Simulation<real, CL_ADVECT>::DoImplicitTimeStep();
+template void Simulation<real, CL_BURGERS>::DoImplicitTimeStep();
+template void Simulation<real3, CL_CART_ISO>::DoImplicitTimeStep();
+template void Simulation<real4, CL_CART_EULER>::DoImplicitTimeStep();
+
+//##############################################################################
+
+template void
+Simulation<real, CL_ADVECT>::MultiplyByMatrix(Array<real> *vIn,
+                                              Array<real> *vOut);
+template void
+Simulation<real, CL_BURGERS>::MultiplyByMatrix(Array<real> *vIn,
+                                               Array<real> *vOut);
+template void
+Simulation<real3, CL_CART_ISO>::MultiplyByMatrix(Array<real> *vIn,
+                                                 Array<real> *vOut);
+template void
+Simulation<real4, CL_CART_EULER>::MultiplyByMatrix(Array<real> *vIn,
+                                                   Array<real> *vOut);
+
+//##############################################################################
+
+template void
+Simulation<real, CL_ADVECT>::Precondition(Array<real> *vIn,
+                                          Array<real> *vOut);
+template void
+Simulation<real, CL_BURGERS>::Precondition(Array<real> *vIn,
+                                           Array<real> *vOut);
+template void
+Simulation<real3, CL_CART_ISO>::Precondition(Array<real> *vIn,
+                                             Array<real> *vOut);
+template void
+Simulation<real4, CL_CART_EULER>::Precondition(Array<real> *vIn,
+                                               Array<real> *vOut);
+
+}  // namespace astrix
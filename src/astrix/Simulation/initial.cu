@@ -176,7 +176,6 @@ void SetInitialSingle(int n, const real2 *pVc, ProblemDefinition problemDef,
     // Right state
     real dR = 0.125;
     real pR = 0.1;
-    real cR = sqrt(G*pR/dR);
 
     real G1 = G - 1.0;
     real m = G1/(G + 1.0);
@@ -602,12 +601,13 @@ void Simulation<realNeq, CL>::SetInitial(real time)
                                        devSetInitial<realNeq, CL>,
                                        (size_t) 0, 0);
 
-    devSetInitial<realNeq, CL><<<nBlocks, nThreads>>>
+    LaunchKernel(nBlocks, nThreads, devSetInitial<realNeq, CL>)
       (nVertex, pVc, p, pVertexPotential, state, G, time, Px, Py);
 
     gpuErrchk( cudaPeekAtLastError() );
     gpuErrchk( cudaDeviceSynchronize() );
   } else {
+#pragma omp parallel for
     for (int n = 0; n < nVertex; n++)
       SetInitialSingle(n, pVc, p, pVertexPotential, state, G, time, Px, Py);
   }
@@ -234,13 +234,14 @@ void Simulation<realNeq, CL>::KHAddEigenVector()
                                        devAddEigenVectorKH<realNeq, CL>,
                                        (size_t) 0, 0);
 
-    devAddEigenVectorKH<realNeq, CL><<<nBlocks, nThreads>>>
+    LaunchKernel(nBlocks, nThreads, devAddEigenVectorKH<realNeq, CL>)
       (nVertex, pVc, pState, pDens, pVelx, pVely, kxKH, pyKH,
        miny, maxy, G, G - 1.0);
 
     gpuErrchk( cudaPeekAtLastError() );
     gpuErrchk( cudaDeviceSynchronize() );
   } else {
+#pragma omp parallel for
     for (unsigned int n = 0; n < nVertex; n++)
       AddEigenVectorSingleKH(n, pVc, pState, pDens, pVelx, pVely,
                              kxKH, pyKH, miny, maxy, G, G - 1.0);
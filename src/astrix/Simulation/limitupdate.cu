@@ -98,7 +98,8 @@ void FlagLimitVertex(const int v, real *pState, real *pStateOld,
 //######################################################################
 /*! \brief Kernel checking if vertices experienced too large an update
 
-\param nVertex Total number of vertices in Mesh
+\param nVertex Number of vertices to check
+\param *pVl Pointer to list of vertices to check; if zero, check vertices 0 up to \a nVertex
 \param *pState Pointer to state at vertices
 \param *pStateOld Pointer to old state at vertices
 \param *pVertexLimitFlag Pointer to array of flags indicating whether change in state is small (0) or too big (1) (output)
@@ -107,30 +108,41 @@ void FlagLimitVertex(const int v, real *pState, real *pStateOld,
 
 template<class realNeq, ConservationLaw CL>
 __global__ void
-devFlagLimit(const int nVertex, realNeq *pState, realNeq *pStateOld,
+devFlagLimit(const int nVertex, const int *pVl,
+             realNeq *pState, realNeq *pStateOld,
              int *pVertexLimitFlag, const real G1)
 {
-  // n=vertex number
   int n = blockIdx.x*blockDim.x + threadIdx.x;
 
   while (n < nVertex) {
-    FlagLimitVertex(n, pState, pStateOld, pVertexLimitFlag, G1);
+    // v = vertex number
+    int v = n;
+    if (pVl != 0) v = pVl[n];
+
+    FlagLimitVertex(v, pState, pStateOld, pVertexLimitFlag, G1);
 
     n += blockDim.x*gridDim.x;
   }
 }
 
 //######################################################################
-/*! Check all vertices for too large updates.
+/*! Check vertices in \a vertexList for too large updates.
 
-  \param *vertexLimitFlag Pointer to Array of flags indicating whether change in state is small (0) or too big (1) (output)*/
+  \param *vertexLimitFlag Pointer to Array of flags indicating whether change in state is small (0) or too big (1) (output)
+  \param *vertexList List of vertices to check; if zero, check all vertices*/
 //######################################################################
 
 template <class realNeq, ConservationLaw CL>
-void Simulation<realNeq, CL>::FlagLimit(Array<int> *vertexLimitFlag)
+void Simulation<realNeq, CL>::FlagLimit(Array<int> *vertexLimitFlag,
+                                        Array<int> *vertexList)
 {
-  // Total number of vertices in Mesh
+  // Number of vertices to check
   int nVertex = mesh->GetNVertex();
+  const int *pVl = 0;
+  if (vertexList != 0) {
+    nVertex = vertexList->GetSize();
+    pVl = vertexList->GetPointer();
+  }
 
   // State vector at vertices
   realNeq *state = vertexState->GetPointer();
@@ -152,13 +164,18 @@ void Simulation<realNeq, CL>::FlagLimit(Array<int> *vertexLimitFlag)
                                        (size_t) 0, 0);
 
     // Execute kernel...
-    devFlagLimit<realNeq, CL><<<nBlocks, nThreads>>>
-      (nVertex, state, stateOld, pVertexLimitFlag, G - 1.0);
+    LaunchKernel(nBlocks, nThreads, devFlagLimit<realNeq, CL>)
+      (nVertex, pVl, state, stateOld, pVertexLimitFlag, G - 1.0);
     gpuErrchk( cudaPeekAtLastError() );
     gpuErrchk( cudaDeviceSynchronize() );
   } else {
-    for (int v = 0; v < nVertex; v++)
+#pragma omp parallel for
+    for (int n = 0; n < nVertex; n++) {
+      int v = n;
+      if (pVl != 0) v = pVl[n];
+
       FlagLimitVertex(v, state, stateOld, pVertexLimitFlag, G - 1.0);
+    }
   }
 }
 
@@ -167,12 +184,16 @@ void Simulation<realNeq, CL>::FlagLimit(Array<int> *vertexLimitFlag)
 //##############################################################################
 
 template void
-Simulation<real, CL_ADVECT>::FlagLimit(Array<int> *vertexLimitFlag);
+Simulation<real, CL_ADVECT>::FlagLimit(Array<int> *vertexLimitFlag,
+                                       Array<int> *vertexList);
 template void
-Simulation<real, CL_BURGERS>::FlagLimit(Array<int> *vertexLimitFlag);
+Simulation<real, CL_BURGERS>::FlagLimit(Array<int> *vertexLimitFlag,
+                                        Array<int> *vertexList);
 template void
-Simulation<real3, CL_CART_ISO>::FlagLimit(Array<int> *vertexLimitFlag);
+Simulation<real3, CL_CART_ISO>::FlagLimit(Array<int> *vertexLimitFlag,
+                                          Array<int> *vertexList);
 template void
-Simulation<real4, CL_CART_EULER>::FlagLimit(Array<int> *vertexLimitFlag);
+Simulation<real4, CL_CART_EULER>::FlagLimit(Array<int> *vertexLimitFlag,
+                                            Array<int> *vertexList);
 
 }  // namespace astrix
@@ -19,7 +19,9 @@ along with Astrix.  If not, see <http://www.gnu.org/licenses/>.*/
 #include "../Array/array.h"
 #include "../Mesh/mesh.h"
 #include "./simulation.h"
+#include "./timelevel.h"
 #include "../Common/cudaLow.h"
+#include "../Common/state.h"
 #include "../Common/inlineMath.h"
 #include "./Param/simulationparameter.h"
 #include "./upwind.h"
@@ -51,10 +53,11 @@ template<ConservationLaw CL>
 __host__ __device__
 void MassMatrixF34Single(int n, real dt, int massMatrix,
                          const int3* __restrict__ pTv,
-                         const real4* __restrict__ pVz,
+                         state::ConstPointer<real4> pVz,
                          const real4* __restrict__ pDstate,
-                         real4 *pTresLDA0, real4 *pTresLDA1,
-                         real4 *pTresLDA2, const real2 *pTn1,
+                         state::Pointer<real4> pTresLDA0,
+                         state::Pointer<real4> pTresLDA1,
+                         state::Pointer<real4> pTresLDA2, const real2 *pTn1,
                          const real2 *pTn2, const real2 *pTn3,
                          const real3 *pTl, int nVertex,
                          real G, real G1, real G2, real *pVp)
@@ -67,12 +70,6 @@ void MassMatrixF34Single(int n, real dt, int massMatrix,
   int vs1 = pTv[n].x;
   int vs2 = pTv[n].y;
   int vs3 = pTv[n].z;
-  while (vs1 >= nVertex) vs1 -= nVertex;
-  while (vs2 >= nVertex) vs2 -= nVertex;
-  while (vs3 >= nVertex) vs3 -= nVertex;
-  while (vs1 < 0) vs1 += nVertex;
-  while (vs2 < 0) vs2 += nVertex;
-  while (vs3 < 0) vs3 += nVertex;
 
   // External potential at vertices
   real pot0 = pVp[vs1];
@@ -464,10 +461,11 @@ template<ConservationLaw CL>
 __host__ __device__
 void MassMatrixF34Single(int n, real dt, int massMatrix,
                          const int3* __restrict__ pTv,
-                         const real3* __restrict__ pVz,
+                         state::ConstPointer<real3> pVz,
                          const real3* __restrict__ pDstate,
-                         real3 *pTresLDA0, real3 *pTresLDA1,
-                         real3 *pTresLDA2, const real2 *pTn1,
+                         state::Pointer<real3> pTresLDA0,
+                         state::Pointer<real3> pTresLDA1,
+                         state::Pointer<real3> pTresLDA2, const real2 *pTn1,
                          const real2 *pTn2, const real2 *pTn3,
                          const real3 *pTl, int nVertex,
                          real G, real G1, real G2, real *pVp)
@@ -480,12 +478,6 @@ void MassMatrixF34Single(int n, real dt, int massMatrix,
   int vs1 = pTv[n].x;
   int vs2 = pTv[n].y;
   int vs3 = pTv[n].z;
-  while (vs1 >= nVertex) vs1 -= nVertex;
-  while (vs2 >= nVertex) vs2 -= nVertex;
-  while (vs3 >= nVertex) vs3 -= nVertex;
-  while (vs1 < 0) vs1 += nVertex;
-  while (vs2 < 0) vs2 += nVertex;
-  while (vs3 < 0) vs3 += nVertex;
 
   // State differences
   real dW00 = pDstate[vs1].x;
@@ -780,10 +772,11 @@ template<ConservationLaw CL>
 __host__ __device__
 void MassMatrixF34Single(int n, real dt, int massMatrix,
                          const int3* __restrict__ pTv,
-                         const real* __restrict__ pVz,
+                         state::ConstPointer<real> pVz,
                          const real* __restrict__ pDstate,
-                         real *pTresLDA0, real *pTresLDA1,
-                         real *pTresLDA2, const real2 *pTn1,
+                         state::Pointer<real> pTresLDA0,
+                         state::Pointer<real> pTresLDA1,
+                         state::Pointer<real> pTresLDA2, const real2 *pTn1,
                          const real2 *pTn2, const real2 *pTn3,
                          const real3 *pTl, int nVertex,
                          real G, real G1, real G2, real *pVp)
@@ -795,12 +788,6 @@ void MassMatrixF34Single(int n, real dt, int massMatrix,
   int vs1 = pTv[n].x;
   int vs2 = pTv[n].y;
   int vs3 = pTv[n].z;
-  while (vs1 >= nVertex) vs1 -= nVertex;
-  while (vs2 >= nVertex) vs2 -= nVertex;
-  while (vs3 >= nVertex) vs3 -= nVertex;
-  while (vs1 < 0) vs1 += nVertex;
-  while (vs2 < 0) vs2 += nVertex;
-  while (vs3 < 0) vs3 += nVertex;
 
   // State differences
   real dW0 = pDstate[vs1];
@@ -925,7 +912,9 @@ void MassMatrixF34Single(int n, real dt, int massMatrix,
 /*! \brief Kernel calculating contribution of F3/F4 formulation to residuals
 
 \param nTriangle Total number of triangles in Mesh
+\param *pTa Pointer to list of active triangles, or zero
 \param dt Time step
+\param *pTdt Pointer to time step of triangles with local time stepping, or zero
 \param massMatrix Mass matrix to use (should be 3 or 4)
 \param *pTv Pointer to triangle vertices
 \param *pVz Pointer to parameter vector
@@ -944,25 +933,30 @@ void MassMatrixF34Single(int n, real dt, int massMatrix,
 
 template<class realNeq, ConservationLaw CL>
 __global__ void
-devMassMatrixF34(int nTriangle, real dt, int massMatrix,
+devMassMatrixF34(int nTriangle, const int *pTa, real dt, const real *pTdt,
+                 int massMatrix,
                  const int3* __restrict__ pTv,
-                 const realNeq* __restrict__ pVz,
+                 state::ConstPointer<realNeq> pVz,
                  const realNeq* __restrict__ pDstate,
-                 realNeq *pTresLDA0, realNeq *pTresLDA1,
-                 realNeq *pTresLDA2, const real2 *pTn1, const real2 *pTn2,
+                 state::Pointer<realNeq> pTresLDA0,
+                 state::Pointer<realNeq> pTresLDA1,
+                 state::Pointer<realNeq> pTresLDA2, const real2 *pTn1,
+                 const real2 *pTn2,
                  const real2 *pTn3, const real3 *pTl,
                  int nVertex, real G, real G1, real G2, real *pVp)
 {
-  int n = blockIdx.x*blockDim.x + threadIdx.x;
+  int i = blockIdx.x*blockDim.x + threadIdx.x;
 
-  while (n < nTriangle) {
-    MassMatrixF34Single<CL>(n, dt, massMatrix, pTv, pVz, pDstate,
+  while (i < nTriangle) {
+    int n = ActiveTriangle(i, pTa);
+    MassMatrixF34Single<CL>(n, TriangleTimestep(n, dt, pTdt),
+                            massMatrix, pTv, pVz, pDstate,
                             pTresLDA0, pTresLDA1, pTresLDA2,
                             pTn1, pTn2, pTn3, pTl,
                             nVertex, G, G1, G2, pVp);
 
     // Next triangle
-    n += blockDim.x*gridDim.x;
+    i += blockDim.x*gridDim.x;
   }
 }
 
@@ -976,16 +970,25 @@ void Simulation<realNeq, CL>::MassMatrixF34(real dt, int massMatrix)
   int nTriangle = mesh->GetNTriangle();
   int nVertex = mesh->GetNVertex();
 
-  realNeq *pVz = vertexParameterVector->GetPointer();
+  // With local time stepping, only update active triangles
+  const int *pTa = 0;
+  const real *pTdt = 0;
+  if (localTimeStepFlag == 1) {
+    nTriangle = triangleActive->GetSize();
+    pTa = triangleActive->GetPointer();
+    pTdt = triangleTimestep->GetPointer();
+  }
+
+  state::Pointer<realNeq> pVz = state::GetPointer(vertexParameterVector);
   realNeq *pDstate = vertexStateDiff->GetPointer();
   real G = simulationParameter->specificHeatRatio;
   real *pVp = vertexPotential->GetPointer();
 
-  realNeq *pTresLDA0 = triangleResidueLDA->GetPointer(0);
-  realNeq *pTresLDA1 = triangleResidueLDA->GetPointer(1);
-  realNeq *pTresLDA2 = triangleResidueLDA->GetPointer(2);
+  state::Pointer<realNeq> pTresLDA0 = state::GetPointer(triangleResidueLDA, 0);
+  state::Pointer<realNeq> pTresLDA1 = state::GetPointer(triangleResidueLDA, 1);
+  state::Pointer<realNeq> pTresLDA2 = state::GetPointer(triangleResidueLDA, 2);
 
-  const int3 *pTv = mesh->TriangleVerticesData();
+  const int3 *pTv = mesh->TriangleVerticesWrappedData();
   const real2 *pTn1 = mesh->TriangleEdgeNormalsData(0);
   const real2 *pTn2 = mesh->TriangleEdgeNormalsData(1);
   const real2 *pTn3 = mesh->TriangleEdgeNormalsData(2);
@@ -1000,8 +1003,8 @@ void Simulation<realNeq, CL>::MassMatrixF34(real dt, int massMatrix)
                                        devMassMatrixF34<realNeq, CL>,
                                        (size_t) 0, 0);
 
-    devMassMatrixF34<realNeq, CL><<<nBlocks, nThreads>>>
-      (nTriangle, dt, massMatrix, pTv, pVz, pDstate,
+    LaunchKernel(nBlocks, nThreads, devMassMatrixF34<realNeq, CL>)
+      (nTriangle, pTa, dt, pTdt, massMatrix, pTv, pVz, pDstate,
        pTresLDA0, pTresLDA1, pTresLDA2,
        pTn1, pTn2, pTn3, pTl, nVertex,
        G, G - 1.0, G - 2.0, pVp);
@@ -1010,11 +1013,15 @@ void Simulation<realNeq, CL>::MassMatrixF34(real dt, int massMatrix)
     gpuErrchk( cudaDeviceSynchronize() );
 
   } else {
-    for (int n = 0; n < nTriangle; n++)
-      MassMatrixF34Single<CL>(n, dt, massMatrix, pTv, pVz, pDstate,
+#pragma omp parallel for
+    for (int i = 0; i < nTriangle; i++) {
+      int n = ActiveTriangle(i, pTa);
+      MassMatrixF34Single<CL>(n, TriangleTimestep(n, dt, pTdt),
+                              massMatrix, pTv, pVz, pDstate,
                               pTresLDA0, pTresLDA1, pTresLDA2,
                               pTn1, pTn2, pTn3, pTl, nVertex,
                               G, G - 1.0, G - 2.0, pVp);
+    }
   }
 }
 
@@ -19,7 +19,9 @@ along with Astrix.  If not, see <http://www.gnu.org/licenses/>.*/
 #include "../Array/array.h"
 #include "../Mesh/mesh.h"
 #include "./simulation.h"
+#include "./timelevel.h"
 #include "../Common/cudaLow.h"
+#include "../Common/state.h"
 #include "../Common/inlineMath.h"
 #include "./Param/simulationparameter.h"
 #include "./upwind.h"
@@ -51,9 +53,9 @@ template<ConservationLaw CL>
 __host__ __device__
 void MassMatrixF34TotSingle(int n, real dt, int massMatrix,
                             const int3* __restrict__ pTv,
-                            const real4* __restrict__ pVz,
+                            state::ConstPointer<real4> pVz,
                             const real4* __restrict__ pDstate,
-                            real4 *pTresTot, const real2 *pTn1,
+                            state::Pointer<real4> pTresTot, const real2 *pTn1,
                             const real2 *pTn2, const real2 *pTn3,
                             const real3 *pTl, int nVertex,
                             real G, real G1, real G2, real *pVp)
@@ -66,12 +68,6 @@ void MassMatrixF34TotSingle(int n, real dt, int massMatrix,
   int vs1 = pTv[n].x;
   int vs2 = pTv[n].y;
   int vs3 = pTv[n].z;
-  while (vs1 >= nVertex) vs1 -= nVertex;
-  while (vs2 >= nVertex) vs2 -= nVertex;
-  while (vs3 >= nVertex) vs3 -= nVertex;
-  while (vs1 < 0) vs1 += nVertex;
-  while (vs2 < 0) vs2 += nVertex;
-  while (vs3 < 0) vs3 += nVertex;
 
   // External potential at vertices
   real pot0 = pVp[vs1];
@@ -462,9 +458,9 @@ template<ConservationLaw CL>
 __host__ __device__
 void MassMatrixF34TotSingle(int n, real dt, int massMatrix,
                             const int3* __restrict__ pTv,
-                            const real3* __restrict__ pVz,
+                            state::ConstPointer<real3> pVz,
                             const real3* __restrict__ pDstate,
-                            real3 *pTresTot, const real2 *pTn1,
+                            state::Pointer<real3> pTresTot, const real2 *pTn1,
                             const real2 *pTn2, const real2 *pTn3,
                             const real3 *pTl, int nVertex,
                             real G, real G1, real G2, real *pVp)
@@ -477,12 +473,6 @@ void MassMatrixF34TotSingle(int n, real dt, int massMatrix,
   int vs1 = pTv[n].x;
   int vs2 = pTv[n].y;
   int vs3 = pTv[n].z;
-  while (vs1 >= nVertex) vs1 -= nVertex;
-  while (vs2 >= nVertex) vs2 -= nVertex;
-  while (vs3 >= nVertex) vs3 -= nVertex;
-  while (vs1 < 0) vs1 += nVertex;
-  while (vs2 < 0) vs2 += nVertex;
-  while (vs3 < 0) vs3 += nVertex;
 
   // State differences
   real dW00 = pDstate[vs1].x;
@@ -778,9 +768,9 @@ template<ConservationLaw CL>
 __host__ __device__
 void MassMatrixF34TotSingle(int n, real dt, int massMatrix,
                             const int3* __restrict__ pTv,
-                            const real* __restrict__ pVz,
+                            state::ConstPointer<real> pVz,
                             const real* __restrict__ pDstate,
-                            real *pTresTot, const real2 *pTn1,
+                            state::Pointer<real> pTresTot, const real2 *pTn1,
                             const real2 *pTn2, const real2 *pTn3,
                             const real3 *pTl, int nVertex,
                             real G, real G1, real G2, real *pVp)
@@ -792,12 +782,6 @@ void MassMatrixF34TotSingle(int n, real dt, int massMatrix,
   int vs1 = pTv[n].x;
   int vs2 = pTv[n].y;
   int vs3 = pTv[n].z;
-  while (vs1 >= nVertex) vs1 -= nVertex;
-  while (vs2 >= nVertex) vs2 -= nVertex;
-  while (vs3 >= nVertex) vs3 -= nVertex;
-  while (vs1 < 0) vs1 += nVertex;
-  while (vs2 < 0) vs2 += nVertex;
-  while (vs3 < 0) vs3 += nVertex;
 
   // State differences
   real dW0 = pDstate[vs1];
@@ -920,7 +904,9 @@ void MassMatrixF34TotSingle(int n, real dt, int massMatrix,
 /*! \brief Kernel calculating space-time LDA residue for all triangles
 
 \param nTriangle Total number of triangles in Mesh
+\param *pTa Pointer to list of active triangles, or zero
 \param dt Time step
+\param *pTdt Pointer to time step of triangles with local time stepping, or zero
 \param massMatrix Mass matrix to use (should be 3 or 4)
 \param *pTv Pointer to triangle vertices
 \param *pVz Pointer to parameter vector
@@ -939,23 +925,27 @@ void MassMatrixF34TotSingle(int n, real dt, int massMatrix,
 
 template<class realNeq, ConservationLaw CL>
 __global__ void
-devMassMatrixF34Tot(int nTriangle, real dt, int massMatrix,
+devMassMatrixF34Tot(int nTriangle, const int *pTa, real dt, const real *pTdt,
+                    int massMatrix,
                     const int3* __restrict__ pTv,
-                    const realNeq* __restrict__ pVz,
+                    state::ConstPointer<realNeq> pVz,
                     const realNeq* __restrict__ pDstate,
-                    realNeq *pTresTot, const real2 *pTn1, const real2 *pTn2,
+                    state::Pointer<realNeq> pTresTot, const real2 *pTn1,
+                    const real2 *pTn2,
                     const real2 *pTn3, const real3 *pTl,
                     int nVertex, real G, real G1, real G2, real *pVp)
 {
-  int n = blockIdx.x*blockDim.x + threadIdx.x;
+  int i = blockIdx.x*blockDim.x + threadIdx.x;
 
-  while (n < nTriangle) {
-    MassMatrixF34TotSingle<CL>(n, dt, massMatrix, pTv, pVz, pDstate,
+  while (i < nTriangle) {
+    int n = ActiveTriangle(i, pTa);
+    MassMatrixF34TotSingle<CL>(n, TriangleTimestep(n, dt, pTdt),
+                               massMatrix, pTv, pVz, pDstate,
                                pTresTot, pTn1, pTn2, pTn3, pTl,
                                nVertex, G, G1, G2, pVp);
 
     // Next triangle
-    n += blockDim.x*gridDim.x;
+    i += blockDim.x*gridDim.x;
   }
 }
 
@@ -969,14 +959,23 @@ void Simulation<realNeq, CL>::MassMatrixF34Tot(real dt, int massMatrix)
   int nTriangle = mesh->GetNTriangle();
   int nVertex = mesh->GetNVertex();
 
-  realNeq *pVz = vertexParameterVector->GetPointer();
+  // With local time stepping, only update active triangles
+  const int *pTa = 0;
+  const real *pTdt = 0;
+  if (localTimeStepFlag == 1) {
+    nTriangle = triangleActive->GetSize();
+    pTa = triangleActive->GetPointer();
+    pTdt = triangleTimestep->GetPointer();
+  }
+
+  state::Pointer<realNeq> pVz = state::GetPointer(vertexParameterVector);
   realNeq *pDstate = vertexStateDiff->GetPointer();
   real G = simulationParameter->specificHeatRatio;
   real *pVp = vertexPotential->GetPointer();
 
-  realNeq *pTresTot = triangleResidueTotal->GetPointer();
+  state::Pointer<realNeq> pTresTot = state::GetPointer(triangleResidueTotal);
 
-  const int3 *pTv = mesh->TriangleVerticesData();
+  const int3 *pTv = mesh->TriangleVerticesWrappedData();
   const real2 *pTn1 = mesh->TriangleEdgeNormalsData(0);
   const real2 *pTn2 = mesh->TriangleEdgeNormalsData(1);
   const real2 *pTn3 = mesh->TriangleEdgeNormalsData(2);
@@ -991,8 +990,8 @@ void Simulation<realNeq, CL>::MassMatrixF34Tot(real dt, int massMatrix)
                                        devMassMatrixF34Tot<realNeq, CL>,
                                        (size_t) 0, 0);
 
-    devMassMatrixF34Tot<realNeq, CL><<<nBlocks, nThreads>>>
-      (nTriangle, dt, massMatrix, pTv, pVz, pDstate,
+    LaunchKernel(nBlocks, nThreads, devMassMatrixF34Tot<realNeq, CL>)
+      (nTriangle, pTa, dt, pTdt, massMatrix, pTv, pVz, pDstate,
        pTresTot, pTn1, pTn2, pTn3, pTl, nVertex,
        G, G - 1.0, G - 2.0, pVp);
 
@@ -1000,10 +999,14 @@ void Simulation<realNeq, CL>::MassMatrixF34Tot(real dt, int massMatrix)
     gpuErrchk( cudaDeviceSynchronize() );
 
   } else {
-    for (int n = 0; n < nTriangle; n++)
-      MassMatrixF34TotSingle<CL>(n, dt, massMatrix, pTv, pVz, pDstate,
+#pragma omp parallel for
+    for (int i = 0; i < nTriangle; i++) {
+      int n = ActiveTriangle(i, pTa);
+      MassMatrixF34TotSingle<CL>(n, TriangleTimestep(n, dt, pTdt),
+                                 massMatrix, pTv, pVz, pDstate,
                                  pTresTot, pTn1, pTn2, pTn3, pTl, nVertex,
                                  G, G - 1.0, G - 2.0, pVp);
+    }
   }
 }
 
@@ -148,11 +148,12 @@ real2 Simulation<realNeq, CL>::FindMinMaxVelocity()
                                        devFillMinMaxVelocity<realNeq, CL>,
                                        (size_t) 0, 0);
 
-    devFillMinMaxVelocity<realNeq, CL><<<nBlocks, nThreads>>>
+    LaunchKernel(nBlocks, nThreads, devFillMinMaxVelocity<realNeq, CL>)
       (nVertex, pState, pMinVel, pMaxVel);
     gpuErrchk( cudaPeekAtLastError() );
     gpuErrchk( cudaDeviceSynchronize() );
   } else {
+#pragma omp parallel for
     for (unsigned int i = 0; i < nVertex; i++)
       FillMinMaxVelocitySingle<CL>(i, pState, pMinVel, pMaxVel);
   }
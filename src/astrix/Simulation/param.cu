@@ -17,77 +17,20 @@ along with Astrix.  If not, see <http://www.gnu.org/licenses/>.*/
 #include "../Array/array.h"
 #include "../Mesh/mesh.h"
 #include "./simulation.h"
+#include "./paramvec.h"
 #include "../Common/cudaLow.h"
 #include "../Common/profile.h"
 #include "./Param/simulationparameter.h"
 
 namespace astrix {
 
-//######################################################################
-/*! \brief Calculate Roe's parameter vector at vertex \a n.
-
-This function calculates Roe's parameter vector Z at vertex \a n.
-
- \param n index of vertex.
- \param *pState Pointer to state vector at vertices
- \param *pVz Pointer to parameter vector at vertices (output)
- \param G1 Ratio of specific heats - 1
-\param *pVp Pointer to external potential at vertices*/
-//######################################################################
-
-__host__ __device__
-void CalcParamVecSingle(int n, real4 *pState, real4 *pVz, real G1, real *pVp)
-{
-  real half = (real) 0.5;
-
-  real dens = pState[n].x;
-  real momx = pState[n].y;
-  real momy = pState[n].z;
-  real ener = pState[n].w;
-
-  real d = sqrt(dens);
-  real u = momx/dens;
-  real v = momy/dens;
-
-  // Pressure
-  real p = G1*(ener - half*dens*(u*u + v*v) - dens*pVp[n]);
-
-  // Roe parameter vector
-  pVz[n].x = d;
-  pVz[n].y = d*u;
-  pVz[n].z = d*v;
-  pVz[n].w = d*(ener + p)/dens;
-}
-
-__host__ __device__
-void CalcParamVecSingle(int n, real3 *pState, real3 *pVz, real G1, real *pVp)
-{
-  real dens = pState[n].x;
-  real momx = pState[n].y;
-  real momy = pState[n].z;
-
-  real d = sqrt(dens);
-  real u = momx/dens;
-  real v = momy/dens;
-
-  // Roe parameter vector
-  pVz[n].x = d;
-  pVz[n].y = d*u;
-  pVz[n].z = d*v;
-}
-
-__host__ __device__
-void CalcParamVecSingle(int n, real *pState, real *pVz, real G1, real *pVp)
-{
-  pVz[n] = pState[n];
-}
-
 //######################################################################
 /*! \brief Kernel to calculate Roe's parameter vector at all vertices.
 
-This kernel function calculates Roe's parameter vector Z for all vertices in the mesh.
+This kernel function calculates Roe's parameter vector Z for all vertices in the mesh, or for all vertices in a list.
 
- \param nVertex total number of vertices.
+ \param nVertex Number of vertices to consider
+ \param *pVl Pointer to list of vertices; if zero, consider vertices 0 up to \a nVertex
  \param *pState Pointer to state vector at vertices
  \param *pVz Pointer to parameter vector at vertices (output)
  \param G1 Ratio of specific heats - 1
@@ -96,20 +39,24 @@ This kernel function calculates Roe's parameter vector Z for all vertices in the
 
 template<class realNeq, ConservationLaw CL>
 __global__ void
-devCalcParamVec(int nVertex, realNeq *pState, realNeq *pVz, real G1, real *pVp)
+devCalcParamVec(int nVertex, const int *pVl, realNeq *pState,
+                state::Pointer<realNeq> pVz, real G1, real *pVp)
 {
-  // n=vertex number
   int n = blockIdx.x*blockDim.x + threadIdx.x;
 
   while (n < nVertex) {
-    CalcParamVecSingle(n, pState, pVz, G1, pVp);
+    // v = vertex number
+    int v = n;
+    if (pVl != 0) v = pVl[n];
+
+    CalcParamVecSingle(v, pState, pVz, G1, pVp);
 
     n += blockDim.x*gridDim.x;
   }
 }
 
 //##############################################################################
-/*! This function calculates Roe's parameter vector Z for all vertices in the mesh, based on either \a vertexState or \a vertexStateOld.
+/*! This function calculates Roe's parameter vector Z for all vertices in the mesh, based on either \a vertexState or \a vertexStateOld. With local time stepping, only the vertices in \a vertexActive are considered.
 
   \param useOldFlag flag indicating whether to use \a vertexStateOld (1) or \a vertexState (any other value).*/
 //##############################################################################
@@ -125,6 +72,11 @@ void Simulation<realNeq, CL>::CalculateParameterVector(int useOldFlag)
 #endif
 
   int nVertex = mesh->GetNVertex();
+  const int *pVl = 0;
+  if (localTimeStepFlag == 1) {
+    nVertex = vertexActive->GetSize();
+    pVl = vertexActive->GetPointer();
+  }
 
   realNeq *pState = vertexState->GetPointer();
   real *pVp = vertexPotential->GetPointer();
@@ -134,7 +86,7 @@ void Simulation<realNeq, CL>::CalculateParameterVector(int useOldFlag)
   if (useOldFlag == 1)
     pState = vertexStateOld->GetPointer();
 
-  realNeq *pVz = vertexParameterVector->GetPointer();
+  state::Pointer<realNeq> pVz = state::GetPointer(vertexParameterVector);
 
   if (cudaFlag == 1) {
     int nThreads = 128;
@@ -149,8 +101,8 @@ void Simulation<realNeq, CL>::CalculateParameterVector(int useOldFlag)
 #ifdef TIME_ASTRIX
     gpuErrchk( cudaEventRecord(start, 0) );
 #endif
-    devCalcParamVec<realNeq, CL><<<nBlocks, nThreads>>>
-      (nVertex, pState, pVz, G - 1.0, pVp);
+    LaunchKernel(nBlocks, nThreads, devCalcParamVec<realNeq, CL>)
+      (nVertex, pVl, pState, pVz, G - 1.0, pVp);
 #ifdef TIME_ASTRIX
     gpuErrchk( cudaEventRecord(stop, 0) );
     gpuErrchk( cudaEventSynchronize(stop) );
@@ -161,8 +113,13 @@ void Simulation<realNeq, CL>::CalculateParameterVector(int useOldFlag)
 #ifdef TIME_ASTRIX
     gpuErrchk( cudaEventRecord(start, 0) );
 #endif
-    for (int n = 0; n < nVertex; n++)
-      CalcParamVecSingle(n, pState, pVz, G - 1.0, pVp);
+#pragma omp parallel for
+    for (int n = 0; n < nVertex; n++) {
+      int v = n;
+      if (pVl != 0) v = pVl[n];
+
+      CalcParamVecSingle(v, pState, pVz, G - 1.0, pVp);
+    }
 #ifdef TIME_ASTRIX
     gpuErrchk( cudaEventRecord(stop, 0) );
     gpuErrchk( cudaEventSynchronize(stop) );
@@ -171,7 +128,7 @@ void Simulation<realNeq, CL>::CalculateParameterVector(int useOldFlag)
 
 #ifdef TIME_ASTRIX
   gpuErrchk( cudaEventElapsedTime(&elapsedTime, start, stop) );
-  WriteProfileFile("Param.prof2", nVertex, elapsedTime, cudaFlag);
+  AddProfile("Param", nVertex, elapsedTime, cudaFlag);
 #endif
 }
 
@@ -0,0 +1,126 @@
+/*! \file paramvec.h
+\brief Roe's parameter vector at a single vertex
+
+\section LICENSE
+Copyright (c) 2017 Sijme-Jan Paardekooper
+
+This file is part of Astrix.
+
+Astrix is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+
+Astrix is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Astrix.  If not, see <http://www.gnu.org/licenses/>.*/
+#ifndef ASTRIX_PARAMVEC_H
+#define ASTRIX_PARAMVEC_H
+
+#include "../Common/state.h"
+
+namespace astrix {
+
+//######################################################################
+/*! \brief Calculate Roe's parameter vector at vertex \a n.
+
+This function calculates Roe's parameter vector Z at vertex \a n.
+
+ \param n index of vertex.
+ \param *pState Pointer to state vector at vertices
+ \param *pVz Pointer to parameter vector at vertices (output)
+ \param G1 Ratio of specific heats - 1
+\param *pVp Pointer to external potential at vertices*/
+//######################################################################
+
+__host__ __device__ inline
+void CalcParamVecSingle(int n, real4 *pState, state::Pointer<real4> pVz,
+                        real G1, real *pVp)
+{
+  real half = (real) 0.5;
+
+  real dens = pState[n].x;
+  real momx = pState[n].y;
+  real momy = pState[n].z;
+  real ener = pState[n].w;
+
+  real d = sqrt(dens);
+  real u = momx/dens;
+  real v = momy/dens;
+
+  // Pressure
+  real p = G1*(ener - half*dens*(u*u + v*v) - dens*pVp[n]);
+
+  // Roe parameter vector
+  pVz[n].x = d;
+  pVz[n].y = d*u;
+  pVz[n].z = d*v;
+  pVz[n].w = d*(ener + p)/dens;
+}
+
+__host__ __device__ inline
+void CalcParamVecSingle(int n, real3 *pState, state::Pointer<real3> pVz,
+                        real G1, real *pVp)
+{
+  real dens = pState[n].x;
+  real momx = pState[n].y;
+  real momy = pState[n].z;
+
+  real d = sqrt(dens);
+  real u = momx/dens;
+  real v = momy/dens;
+
+  // Roe parameter vector
+  pVz[n].x = d;
+  pVz[n].y = d*u;
+  pVz[n].z = d*v;
+}
+
+__host__ __device__ inline
+void CalcParamVecSingle(int n, real *pState, state::Pointer<real> pVz,
+                        real G1, real *pVp)
+{
+  pVz[n] = pState[n];
+}
+
+//######################################################################
+/*! \brief Check for negative pressure at vertex \a n.
+
+Returns 1 if the pressure at vertex \a n is negative, in which case the parameter vector is not defined, and 0 otherwise.
+
+ \param n index of vertex.
+ \param *pState Pointer to state vector at vertices
+ \param G1 Ratio of specific heats - 1
+\param *pVp Pointer to external potential at vertices*/
+//######################################################################
+
+__host__ __device__ inline
+int NegativePressureSingle(int n, real4 *pState, real G1, real *pVp)
+{
+  real zero = (real) 0.0;
+  real half = (real) 0.5;
+
+  real dens = pState[n].x;
+  real momx = pState[n].y;
+  real momy = pState[n].z;
+  real ener = pState[n].w;
+
+  // Pressure
+  real p = G1*(ener - half*(momx*momx + momy*momy)/dens - dens*pVp[n]);
+
+  return (p < zero);
+}
+
+__host__ __device__ inline
+int NegativePressureSingle(int n, real3 *pState, real G1, real *pVp)
+{
+  return 0;
+}
+
+__host__ __device__ inline
+int NegativePressureSingle(int n, real *pState, real G1, real *pVp)
+{
+  return 0;
+}
+
+}  // namespace astrix
+
+#endif  // ASTRIX_PARAMVEC_H
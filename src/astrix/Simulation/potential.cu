@@ -106,12 +106,13 @@ void Simulation<realNeq, CL>::CalcPotential()
                                        devCalcPotential,
                                        (size_t) 0, 0);
 
-    devCalcPotential<<<nBlocks, nThreads>>>
+    LaunchKernel(nBlocks, nThreads, devCalcPotential)
       (nVertex, p, pVc, vertPot);
 
     gpuErrchk( cudaPeekAtLastError() );
     gpuErrchk( cudaDeviceSynchronize() );
   } else {
+#pragma omp parallel for
     for (int i = 0; i < nVertex; i++)
       CalcPotentialSingle(i, p, pVc, vertPot);
   }
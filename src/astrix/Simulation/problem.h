@@ -0,0 +1,109 @@
+/*! \file problem.h
+\brief Compile-time description of problem-specific boundary conditions and source terms
+
+\section LICENSE
+Copyright (c) 2017 Sijme-Jan Paardekooper
+
+This file is part of Astrix.
+
+Astrix is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+
+Astrix is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Astrix.  If not, see <http://www.gnu.org/licenses/>.*/
+#ifndef ASTRIX_PROBLEM_H
+#define ASTRIX_PROBLEM_H
+
+namespace astrix {
+
+//! List of problems for which a time step pipeline is compiled
+/*! Every entry X(P) leads to a version of the time step specialised for problem P, selected at start-up by Simulation::SelectProblemPipeline(). A new problem only needs an entry here, plus a ProblemPolicy specialisation if it needs boundary conditions or a source term.*/
+#define ASTRIX_PROBLEM_LIST(X)                  \
+  X(PROBLEM_LINEAR)                             \
+  X(PROBLEM_SOD)                                \
+  X(PROBLEM_BLAST)                              \
+  X(PROBLEM_KH)                                 \
+  X(PROBLEM_CYL)                                \
+  X(PROBLEM_RIEMANN)                            \
+  X(PROBLEM_VORTEX)                             \
+  X(PROBLEM_NOH)                                \
+  X(PROBLEM_SOURCE)
+
+//! ProblemPolicy: boundary conditions and source terms of a problem
+/*! Default: periodic boundaries, no source term.*/
+
+template <ProblemDefinition P, ConservationLaw CL>
+struct ProblemPolicy
+{
+  //! Add source term to residual
+  static const bool source = false;
+  //! Set state at boundary from the analytic 2D Riemann solution
+  static const bool riemannBoundaries = false;
+  //! Set state at boundary from the analytic Noh solution
+  static const bool nohBoundaries = false;
+  //! Add flux through reflecting boundaries after update
+  static const bool reflectingBoundaries = false;
+  //! Impose symmetry at boundaries after update
+  static const bool symmetricBoundaries = false;
+  //! Non-reflecting boundaries after update
+  static const bool nonReflectingBoundaries = false;
+};
+
+//! Sod shock tube: reflecting boundaries
+template <ConservationLaw CL>
+struct ProblemPolicy<PROBLEM_SOD, CL> : ProblemPolicy<PROBLEM_UNDEFINED, CL>
+{
+  static const bool reflectingBoundaries = true;
+};
+
+//! Interacting blast waves: reflecting boundaries
+template <ConservationLaw CL>
+struct ProblemPolicy<PROBLEM_BLAST, CL> : ProblemPolicy<PROBLEM_UNDEFINED, CL>
+{
+  static const bool reflectingBoundaries = true;
+};
+
+//! Flow around cylinder: reflecting boundaries
+template <ConservationLaw CL>
+struct ProblemPolicy<PROBLEM_CYL, CL> : ProblemPolicy<PROBLEM_UNDEFINED, CL>
+{
+  static const bool reflectingBoundaries = true;
+};
+
+//! 2D Riemann problem: analytic state at boundary, symmetric otherwise
+template <ConservationLaw CL>
+struct ProblemPolicy<PROBLEM_RIEMANN, CL>
+  : ProblemPolicy<PROBLEM_UNDEFINED, CL>
+{
+  static const bool riemannBoundaries = true;
+  static const bool symmetricBoundaries = true;
+};
+
+//! Isentropic vortex: non-reflecting boundaries
+template <ConservationLaw CL>
+struct ProblemPolicy<PROBLEM_VORTEX, CL> : ProblemPolicy<PROBLEM_UNDEFINED, CL>
+{
+  static const bool nonReflectingBoundaries = true;
+};
+
+//! Noh problem: analytic state at boundary
+template <ConservationLaw CL>
+struct ProblemPolicy<PROBLEM_NOH, CL> : ProblemPolicy<PROBLEM_UNDEFINED, CL>
+{
+  static const bool nohBoundaries = true;
+};
+
+//! Source problem: non-reflecting boundaries for advection, symmetric otherwise
+template <ConservationLaw CL>
+struct ProblemPolicy<PROBLEM_SOURCE, CL>
+  : ProblemPolicy<PROBLEM_UNDEFINED, CL>
+{
+  static const bool source = true;
+  static const bool symmetricBoundaries = (CL != CL_ADVECT);
+  static const bool nonReflectingBoundaries = (CL == CL_ADVECT);
+};
+
+}  // namespace astrix
+
+#endif  // ASTRIX_PROBLEM_H
@@ -20,6 +20,7 @@ along with Astrix.  If not, see <http://www.gnu.org/licenses/>.*/
 #include "../Mesh/mesh.h"
 #include "./simulation.h"
 #include "../Common/cudaLow.h"
+#include "../Common/state.h"
 
 namespace astrix {
 
@@ -44,8 +45,12 @@ If any of the vertices of \a n has an unphysical state, replace the triangle res
 __host__ __device__
 void SingleReplaceLDA(int n, const int3* __restrict__ pTv,
                       const int* __restrict__ pVuf,
-                      real4 *pTresN0, real4 *pTresN1, real4 *pTresN2,
-                      real4 *pTresLDA0, real4 *pTresLDA1, real4 *pTresLDA2,
+                      state::Pointer<real4> pTresN0,
+                      state::Pointer<real4> pTresN1,
+                      state::Pointer<real4> pTresN2,
+                      state::Pointer<real4> pTresLDA0,
+                      state::Pointer<real4> pTresLDA1,
+                      state::Pointer<real4> pTresLDA2,
                       const int RKStep, const int nVertex)
 {
   //const real zero = (real) 0.0;
@@ -54,12 +59,6 @@ void SingleReplaceLDA(int n, const int3* __restrict__ pTv,
   int a = pTv[n].x;
   int b = pTv[n].y;
   int c = pTv[n].z;
-  while (a >= nVertex) a -= nVertex;
-  while (b >= nVertex) b -= nVertex;
-  while (c >= nVertex) c -= nVertex;
-  while (a < 0) a += nVertex;
-  while (b < 0) b += nVertex;
-  while (c < 0) c += nVertex;
 
   // Check whether any vertex state is flagged as unphysical
   int correct_flag = 0;
@@ -96,20 +95,18 @@ void SingleReplaceLDA(int n, const int3* __restrict__ pTv,
 __host__ __device__
 void SingleReplaceLDA(int n, const int3* __restrict__ pTv,
                       const int* __restrict__ pVuf,
-                      real3 *pTresN0, real3 *pTresN1, real3 *pTresN2,
-                      real3 *pTresLDA0, real3 *pTresLDA1, real3 *pTresLDA2,
+                      state::Pointer<real3> pTresN0,
+                      state::Pointer<real3> pTresN1,
+                      state::Pointer<real3> pTresN2,
+                      state::Pointer<real3> pTresLDA0,
+                      state::Pointer<real3> pTresLDA1,
+                      state::Pointer<real3> pTresLDA2,
                       const int RKStep, const int nVertex)
 {
   // Triangle vertices
   int a = pTv[n].x;
   int b = pTv[n].y;
   int c = pTv[n].z;
-  while (a >= nVertex) a -= nVertex;
-  while (b >= nVertex) b -= nVertex;
-  while (c >= nVertex) c -= nVertex;
-  while (a < 0) a += nVertex;
-  while (b < 0) b += nVertex;
-  while (c < 0) c += nVertex;
 
   // Check whether any vertex state is flagged as unphysical
   int correct_flag = 0;
@@ -129,8 +126,12 @@ void SingleReplaceLDA(int n, const int3* __restrict__ pTv,
 __host__ __device__
 void SingleReplaceLDA(int n, const int3* __restrict__ pTv,
                       const int* __restrict__ pVuf,
-                      real *pTresN0, real *pTresN1, real *pTresN2,
-                      real *pTresLDA0, real *pTresLDA1, real *pTresLDA2,
+                      state::Pointer<real> pTresN0,
+                      state::Pointer<real> pTresN1,
+                      state::Pointer<real> pTresN2,
+                      state::Pointer<real> pTresLDA0,
+                      state::Pointer<real> pTresLDA1,
+                      state::Pointer<real> pTresLDA2,
                       const int RKStep, const int nVertex)
 {
   // Dummy function; nothing to do if solving only one equation
@@ -141,7 +142,8 @@ void SingleReplaceLDA(int n, const int3* __restrict__ pTv,
 
 If any of the vertices of a triangle has an unphysical state, replace the triangle residue with N only. If we are at the second stage of the Runge Kutta integration, just set all residues to zero, forcing a first-order update
 
-\param nTriangle Total number of triangles in Mesh
+\param nTriangle Number of triangles to consider
+\param *pTl Pointer to list of triangles to consider; if zero, consider triangles 0 up to \a nTriangle
 \param *pTv Pointer to triangle vertices
 \param *pVuf Pointer to array of flags indicating whether vertex has an unphysical state
 \param *pTresN0 Triangle residue N direction 0
@@ -156,22 +158,28 @@ If any of the vertices of a triangle has an unphysical state, replace the triang
 
 template<class realNeq, ConservationLaw CL>
 __global__ void
-devReplaceLDA(int nTriangle,
+devReplaceLDA(int nTriangle, const int *pTl,
               const int3* __restrict__ pTv,
               const int* __restrict__ pVuf,
-              realNeq *pTresN0, realNeq *pTresN1, realNeq *pTresN2,
-              realNeq *pTresLDA0, realNeq *pTresLDA1, realNeq *pTresLDA2,
+              state::Pointer<realNeq> pTresN0, state::Pointer<realNeq> pTresN1,
+              state::Pointer<realNeq> pTresN2,
+              state::Pointer<realNeq> pTresLDA0,
+              state::Pointer<realNeq> pTresLDA1,
+              state::Pointer<realNeq> pTresLDA2,
               int RKStep, int nVertex)
 {
-  int n = blockIdx.x*blockDim.x + threadIdx.x;
+  int i = blockIdx.x*blockDim.x + threadIdx.x;
+
+  while (i < nTriangle) {
+    int n = i;
+    if (pTl != 0) n = pTl[i];
 
-  while (n < nTriangle) {
     SingleReplaceLDA(n, pTv, pVuf,
                      pTresN0, pTresN1, pTresN2,
                      pTresLDA0, pTresLDA1, pTresLDA2,
                      RKStep, nVertex);
 
-    n += blockDim.x*gridDim.x;
+    i += blockDim.x*gridDim.x;
   }
 }
 
@@ -185,18 +193,39 @@ devReplaceLDA(int nTriangle,
 template <class realNeq, ConservationLaw CL>
 void Simulation<realNeq, CL>::ReplaceLDA(Array<int> *vertexUnphysicalFlag,
                                          int RKStep)
+{
+  ReplaceLDA(vertexUnphysicalFlag, RKStep, 0);
+}
+
+//######################################################################
+/*! As above, but only consider triangles in \a triangleList.
+
+\param *vertexUnphysicalFlag Pointer to array of flags indicating whether vertex has an unphysical state
+\param RKStep Stage of Runge-Kutta integration
+\param *triangleList List of triangles to consider; if zero, consider all triangles*/
+//######################################################################
+
+template <class realNeq, ConservationLaw CL>
+void Simulation<realNeq, CL>::ReplaceLDA(Array<int> *vertexUnphysicalFlag,
+                                         int RKStep, Array<int> *triangleList)
 {
   int nTriangle = mesh->GetNTriangle();
   int nVertex = mesh->GetNVertex();
 
-  const int3 *pTv = mesh->TriangleVerticesData();
+  const int *pTl = 0;
+  if (triangleList != 0) {
+    nTriangle = triangleList->GetSize();
+    pTl = triangleList->GetPointer();
+  }
 
-  realNeq *pTresN0 = triangleResidueN->GetPointer(0);
-  realNeq *pTresN1 = triangleResidueN->GetPointer(1);
-  realNeq *pTresN2 = triangleResidueN->GetPointer(2);
-  realNeq *pTresLDA0 = triangleResidueLDA->GetPointer(0);
-  realNeq *pTresLDA1 = triangleResidueLDA->GetPointer(1);
-  realNeq *pTresLDA2 = triangleResidueLDA->GetPointer(2);
+  const int3 *pTv = mesh->TriangleVerticesWrappedData();
+
+  state::Pointer<realNeq> pTresN0 = state::GetPointer(triangleResidueN, 0);
+  state::Pointer<realNeq> pTresN1 = state::GetPointer(triangleResidueN, 1);
+  state::Pointer<realNeq> pTresN2 = state::GetPointer(triangleResidueN, 2);
+  state::Pointer<realNeq> pTresLDA0 = state::GetPointer(triangleResidueLDA, 0);
+  state::Pointer<realNeq> pTresLDA1 = state::GetPointer(triangleResidueLDA, 1);
+  state::Pointer<realNeq> pTresLDA2 = state::GetPointer(triangleResidueLDA, 2);
 
   int *pVuf = vertexUnphysicalFlag->GetPointer();
 
@@ -211,19 +240,24 @@ void Simulation<realNeq, CL>::ReplaceLDA(Array<int> *vertexUnphysicalFlag,
                                        (size_t) 0, 0);
 
     // Execute kernel...
-    devReplaceLDA<realNeq, CL><<<nBlocks, nThreads>>>
-      (nTriangle, pTv, pVuf,
+    LaunchKernel(nBlocks, nThreads, devReplaceLDA<realNeq, CL>)
+      (nTriangle, pTl, pTv, pVuf,
        pTresN0, pTresN1, pTresN2,
        pTresLDA0, pTresLDA1, pTresLDA2,
        RKStep, nVertex);
     gpuErrchk( cudaPeekAtLastError() );
     gpuErrchk( cudaDeviceSynchronize() );
   } else {
-    for (int n = 0; n < nTriangle; n++)
+#pragma omp parallel for
+    for (int i = 0; i < nTriangle; i++) {
+      int n = i;
+      if (pTl != 0) n = pTl[i];
+
       SingleReplaceLDA(n, pTv, pVuf,
                        pTresN0, pTresN1, pTresN2,
                        pTresLDA0, pTresLDA1, pTresLDA2,
                        RKStep, nVertex);
+    }
   }
 }
 
@@ -248,4 +282,24 @@ void Simulation<real4,
                 CL_CART_EULER>::ReplaceLDA(Array<int> *vertexUnphysicalFlag,
                                            int RKStep);
 
+//##############################################################################
+
+template
+void Simulation<real,
+                CL_ADVECT>::ReplaceLDA(Array<int> *vertexUnphysicalFlag,
+                                       int RKStep, Array<int> *triangleList);
+template
+void Simulation<real,
+                CL_BURGERS>::ReplaceLDA(Array<int> *vertexUnphysicalFlag,
+                                        int RKStep, Array<int> *triangleList);
+template
+void Simulation<real3,
+                CL_CART_ISO>::ReplaceLDA(Array<int> *vertexUnphysicalFlag,
+                                         int RKStep, Array<int> *triangleList);
+template
+void Simulation<real4,
+                CL_CART_EULER>::ReplaceLDA(Array<int> *vertexUnphysicalFlag,
+                                           int RKStep,
+                                           Array<int> *triangleList);
+
 }  // namespace astrix
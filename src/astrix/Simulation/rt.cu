@@ -230,13 +230,14 @@ void Simulation<realNeq, CL>::RTAddEigenVector()
                                        devAddEigenVectorRT<realNeq, CL>,
                                        (size_t) 0, 0);
 
-    devAddEigenVectorRT<realNeq, CL><<<nBlocks, nThreads>>>
+    LaunchKernel(nBlocks, nThreads, devAddEigenVectorRT<realNeq, CL>)
       (nVertex, pVc, pState, pVp, pDens, pVelx, pVely, pPres,
        kxRT, pyRT, miny, maxy, G, G - 1.0, simulationTime, omega2);
 
     gpuErrchk( cudaPeekAtLastError() );
     gpuErrchk( cudaDeviceSynchronize() );
   } else {
+#pragma omp parallel for
     for (unsigned int n = 0; n < nVertex; n++)
       AddEigenVectorSingleRT(n, pVc, pState, pVp, pDens, pVelx, pVely, pPres,
                              kxRT, pyRT, miny, maxy,
@@ -13,7 +13,7 @@ Astrix is distributed in the hope that it will be useful, but WITHOUT ANY WARRAN
 
 You should have received a copy of the GNU General Public License
 along with Astrix.  If not, see <http://www.gnu.org/licenses/>.*/
-#include <cuda_runtime_api.h>
+#include "../Common/cudaRuntime.h"
 #include <iostream>
 #include <iomanip>
 #include <fstream>
@@ -67,14 +67,12 @@ void Simulation<realNeq, CL>::Save()
   // Copy data to host
   if (cudaFlag == 1) vertexState->CopyToHost();
 
-  Array<real> *dens = new Array<real>(1, 0, nVertex);
-  Array<real> *momx = new Array<real>(1, 0, nVertex);
-  Array<real> *momy = new Array<real>(1, 0, nVertex);
-  Array<real> *ener = new Array<real>(1, 0, nVertex);
-  real *pDens = dens->GetPointer();
-  real *pMomx = momx->GetPointer();
-  real *pMomy = momy->GetPointer();
-  real *pEner = ener->GetPointer();
+  // Host buffer for density, momenta and energy
+  vertexOutput->SetSize(nVertex);
+  real *pDens = vertexOutput->GetPointer(0);
+  real *pMomx = vertexOutput->GetPointer(1);
+  real *pMomy = vertexOutput->GetPointer(2);
+  real *pEner = vertexOutput->GetPointer(3);
 
   realNeq *pState = vertexState->GetHostPointer();
   for (int n = 0; n < nVertex; n++) {
@@ -147,11 +145,6 @@ void Simulation<realNeq, CL>::Save()
     throw std::runtime_error("");
   }
 
-  delete dens;
-  delete momx;
-  delete momy;
-  delete ener;
-
   // Output save number so that we can restore latest save if wanted
   outFile.open("lastsave.dat");
   outFile << nSave << std::endl;
@@ -213,14 +206,12 @@ void Simulation<realNeq, CL>::Restore(int nRestore)
   // Copy data to host
   if (cudaFlag == 1) vertexState->CopyToHost();
 
-  Array<real> *dens = new Array<real>(1, 0, nVertex);
-  Array<real> *momx = new Array<real>(1, 0, nVertex);
-  Array<real> *momy = new Array<real>(1, 0, nVertex);
-  Array<real> *ener = new Array<real>(1, 0, nVertex);
-  real *pDens = dens->GetPointer();
-  real *pMomx = momx->GetPointer();
-  real *pMomy = momy->GetPointer();
-  real *pEner = ener->GetPointer();
+  // Host buffer for density, momenta and energy
+  vertexOutput->SetSize(nVertex);
+  real *pDens = vertexOutput->GetPointer(0);
+  real *pMomx = vertexOutput->GetPointer(1);
+  real *pMomy = vertexOutput->GetPointer(2);
+  real *pEner = vertexOutput->GetPointer(3);
 
   // Read density binary
   snprintf(fname, sizeof(fname), "dens%4.4d.dat", nSave);
@@ -345,7 +336,7 @@ void Simulation<realNeq, CL>::FineGrainSave()
   outFile << std::setprecision(10)
           << simulationTime << " "
           << DensityError() << " ";
-  for (int i = 0; i < d->result->GetSize(); i++)
+  for (unsigned int i = 0; i < d->result->GetSize(); i++)
     outFile << pResult[i] << " ";
   outFile << std::endl;
 
@@ -18,7 +18,9 @@ along with Astrix.  If not, see <http://www.gnu.org/licenses/>.*/
 #include "../Array/array.h"
 #include "../Mesh/mesh.h"
 #include "./simulation.h"
+#include "./timelevel.h"
 #include "../Common/cudaLow.h"
+#include "../Common/state.h"
 #include "../Common/inlineMath.h"
 #include "../Common/helper_math.h"
 
@@ -47,9 +49,12 @@ template<class realNeq, ConservationLaw CL>
 __host__ __device__
 void SelectLumpSingle(int n, real dt, int massMatrix, int selectLumpFlag,
                       const int3* __restrict__ pTv, realNeq *pDstate,
-                      realNeq *pTresLDA0, realNeq *pTresLDA1,
-                      realNeq *pTresLDA2, realNeq *pTresN0,
-                      realNeq *pTresN1, realNeq *pTresN2,
+                      state::Pointer<realNeq> pTresLDA0,
+                      state::Pointer<realNeq> pTresLDA1,
+                      state::Pointer<realNeq> pTresLDA2,
+                      state::Pointer<realNeq> pTresN0,
+                      state::Pointer<realNeq> pTresN1,
+                      state::Pointer<realNeq> pTresN2,
                       const real3 *pTl, int nVertex)
 {
   real half = (real) 0.5;
@@ -63,12 +68,6 @@ void SelectLumpSingle(int n, real dt, int massMatrix, int selectLumpFlag,
   int v1 = pTv[n].x;
   int v2 = pTv[n].y;
   int v3 = pTv[n].z;
-  while (v1 >= nVertex) v1 -= nVertex;
-  while (v2 >= nVertex) v2 -= nVertex;
-  while (v3 >= nVertex) v3 -= nVertex;
-  while (v1 < 0) v1 += nVertex;
-  while (v2 < 0) v2 += nVertex;
-  while (v3 < 0) v3 += nVertex;
 
   realNeq dW0 = pDstate[v1];
   realNeq dW1 = pDstate[v2];
@@ -102,7 +101,9 @@ void SelectLumpSingle(int n, real dt, int massMatrix, int selectLumpFlag,
 /*! \brief Kernel computing contribution of second mass matrix and selective lumping for all triangles
 
 \param nTriangle Total number of triangles in Mesh
+\param *pTa Pointer to list of active triangles, or zero
 \param dt Time step
+\param *pTdt Pointer to time step of triangles with local time stepping, or zero
 \param massMatrix Mass matrix used
 \param selectLumpFlag Flag whether to use selective lumping
 \param *pTv Pointer to triangle vertices
@@ -119,23 +120,29 @@ void SelectLumpSingle(int n, real dt, int massMatrix, int selectLumpFlag,
 
 template<class realNeq, ConservationLaw CL>
 __global__ void
-devSelectLump(int nTriangle, real dt, int massMatrix, int selectLumpFlag,
+devSelectLump(int nTriangle, const int *pTa, real dt, const real *pTdt,
+              int massMatrix, int selectLumpFlag,
               const int3* __restrict__ pTv, realNeq *pDstate,
-              realNeq *pTresLDA0, realNeq *pTresLDA1, realNeq *pTresLDA2,
-              realNeq *pTresN0, realNeq *pTresN1, realNeq *pTresN2,
+              state::Pointer<realNeq> pTresLDA0,
+              state::Pointer<realNeq> pTresLDA1,
+              state::Pointer<realNeq> pTresLDA2,
+              state::Pointer<realNeq> pTresN0, state::Pointer<realNeq> pTresN1,
+              state::Pointer<realNeq> pTresN2,
               const real3 *pTl, int nVertex)
 {
-  int n = blockIdx.x*blockDim.x + threadIdx.x;
+  int i = blockIdx.x*blockDim.x + threadIdx.x;
 
-  while (n < nTriangle) {
-    SelectLumpSingle<realNeq, CL>(n, dt, massMatrix, selectLumpFlag,
+  while (i < nTriangle) {
+    int n = ActiveTriangle(i, pTa);
+    SelectLumpSingle<realNeq, CL>(n, TriangleTimestep(n, dt, pTdt),
+                                  massMatrix, selectLumpFlag,
                                   pTv, pDstate,
                                   pTresLDA0, pTresLDA1, pTresLDA2,
                                   pTresN0, pTresN1, pTresN2,
                                   pTl, nVertex);
 
     // Next triangle
-    n += blockDim.x*gridDim.x;
+    i += blockDim.x*gridDim.x;
   }
 }
 
@@ -154,15 +161,24 @@ void Simulation<realNeq, CL>::SelectLump(real dt, int massMatrix,
   int nTriangle = mesh->GetNTriangle();
   int nVertex = mesh->GetNVertex();
 
+  // With local time stepping, only update active triangles
+  const int *pTa = 0;
+  const real *pTdt = 0;
+  if (localTimeStepFlag == 1) {
+    nTriangle = triangleActive->GetSize();
+    pTa = triangleActive->GetPointer();
+    pTdt = triangleTimestep->GetPointer();
+  }
+
   realNeq *pDstate = vertexStateDiff->GetPointer();
-  realNeq *pTresLDA0 = triangleResidueLDA->GetPointer(0);
-  realNeq *pTresLDA1 = triangleResidueLDA->GetPointer(1);
-  realNeq *pTresLDA2 = triangleResidueLDA->GetPointer(2);
-  realNeq *pTresN0 = triangleResidueN->GetPointer(0);
-  realNeq *pTresN1 = triangleResidueN->GetPointer(1);
-  realNeq *pTresN2 = triangleResidueN->GetPointer(2);
-
-  const int3 *pTv = mesh->TriangleVerticesData();
+  state::Pointer<realNeq> pTresLDA0 = state::GetPointer(triangleResidueLDA, 0);
+  state::Pointer<realNeq> pTresLDA1 = state::GetPointer(triangleResidueLDA, 1);
+  state::Pointer<realNeq> pTresLDA2 = state::GetPointer(triangleResidueLDA, 2);
+  state::Pointer<realNeq> pTresN0 = state::GetPointer(triangleResidueN, 0);
+  state::Pointer<realNeq> pTresN1 = state::GetPointer(triangleResidueN, 1);
+  state::Pointer<realNeq> pTresN2 = state::GetPointer(triangleResidueN, 2);
+
+  const int3 *pTv = mesh->TriangleVerticesWrappedData();
   const real3 *pTl  = mesh->TriangleEdgeLengthData();
 
   if (cudaFlag == 1) {
@@ -174,8 +190,8 @@ void Simulation<realNeq, CL>::SelectLump(real dt, int massMatrix,
                                        devSelectLump<realNeq, CL>,
                                        (size_t) 0, 0);
 
-    devSelectLump<realNeq, CL><<<nBlocks, nThreads>>>
-      (nTriangle, dt, massMatrix, selectLumpFlag,
+    LaunchKernel(nBlocks, nThreads, devSelectLump<realNeq, CL>)
+      (nTriangle, pTa, dt, pTdt, massMatrix, selectLumpFlag,
        pTv, pDstate,
        pTresLDA0, pTresLDA1, pTresLDA2,
        pTresN0, pTresN1, pTresN2,
@@ -184,12 +200,16 @@ void Simulation<realNeq, CL>::SelectLump(real dt, int massMatrix,
     gpuErrchk( cudaPeekAtLastError() );
     gpuErrchk( cudaDeviceSynchronize() );
   } else {
-    for (int n = 0; n < nTriangle; n++)
-      SelectLumpSingle<realNeq, CL>(n, dt, massMatrix, selectLumpFlag,
+#pragma omp parallel for
+    for (int i = 0; i < nTriangle; i++) {
+      int n = ActiveTriangle(i, pTa);
+      SelectLumpSingle<realNeq, CL>(n, TriangleTimestep(n, dt, pTdt),
+                                    massMatrix, selectLumpFlag,
                                     pTv, pDstate,
                                     pTresLDA0, pTresLDA1, pTresLDA2,
                                     pTresN0, pTresN1, pTresN2,
                                     pTl, nVertex);
+    }
   }
 }
 
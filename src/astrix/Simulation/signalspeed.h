@@ -0,0 +1,209 @@
+/*! \file signalspeed.h
+\brief Maximum signal speed in triangles, used for the time step
+
+\section LICENSE
+Copyright (c) 2017 Sijme-Jan Paardekooper
+
+This file is part of Astrix.
+
+Astrix is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+
+Astrix is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Astrix.  If not, see <http://www.gnu.org/licenses/>.*/
+#ifndef ASTRIX_SIGNALSPEED_H
+#define ASTRIX_SIGNALSPEED_H
+
+namespace astrix {
+
+//######################################################################
+/*! \brief Find maximum signal speed for triangle t
+
+\param t Triangle to consider
+\param a First vertex of triangle
+\param b Second vertex of triangle
+\param c Third vertex of triangle
+\param *pState Pointer to vertex state vector
+\param *pTl Pointer to triangle edge lengths
+\param G Ratio of specific heats
+\param G1 G - 1
+\param *pVp Pointer to external potential at vertices
+
+\tparam warnFlag If 1, warn on host about negative pressure. Loops that need to vectorise use 0; negative pressure is also flagged when checking for unphysical states.*/
+//######################################################################
+
+template<ConservationLaw CL, int warnFlag = 1>
+__host__ __device__ __forceinline__
+real FindMaxSignalSpeed(int t, int a, int b, int c,
+                        real4 *pState, const real3* __restrict__ pTl,
+                        real G, real G1, real *pVp)
+{
+  real zero = (real) 0.0;
+  real half = (real) 0.5;
+  real one = (real) 1.0;
+
+  real vmax = zero;
+
+  // First vertex
+  real dens = pState[a].x;
+  real momx = pState[a].y;
+  real momy = pState[a].z;
+  real ener = pState[a].w;
+
+  real id = one/dens;
+  real u = momx;
+  real v = momy;
+  real absv = sqrt(u*u+v*v)*id;
+
+  // Pressure
+  real p = G1*(ener - half*id*(u*u + v*v) - dens*pVp[a]);
+#ifndef __CUDA_ARCH__
+  if (warnFlag == 1 && p < zero)
+    std::cout << "Negative pressure in timestep calculation!" << std::endl;
+#endif
+
+  // Sound speed
+  real cs = sqrt(G*p*id);
+
+  // Maximum signal speed
+  vmax = absv + cs;
+
+  // Second vertex
+  dens = pState[b].x;
+  momx = pState[b].y;
+  momy = pState[b].z;
+  ener = pState[b].w;
+
+  id = one/dens;
+  u = momx;
+  v = momy;
+  absv = sqrt(u*u+v*v)*id;
+
+  p = G1*(ener - half*id*(u*u + v*v) - dens*pVp[b]);
+#ifndef __CUDA_ARCH__
+  if (warnFlag == 1 && p < zero)
+    std::cout << "Negative pressure in timestep calculation!" << std::endl;
+#endif
+  cs = sqrt(G*p*id);
+
+  vmax = max(vmax, absv + cs);
+
+  // Third vertex
+  dens = pState[c].x;
+  momx = pState[c].y;
+  momy = pState[c].z;
+  ener = pState[c].w;
+
+  id = one/dens;
+  u = momx;
+  v = momy;
+  absv = sqrt(u*u+v*v)*id;
+
+  p = G1*(ener - half*id*(u*u + v*v) - dens*pVp[c]);
+#ifndef __CUDA_ARCH__
+  if (warnFlag == 1 && p < zero)
+    std::cout << "Negative pressure in timestep calculation!" << std::endl;
+#endif
+  cs = sqrt(G*p*id);
+
+  vmax = max(vmax, absv + cs);
+
+  // Triangle edge lengths
+  real tl1 = pTl[t].x;
+  real tl2 = pTl[t].y;
+  real tl3 = pTl[t].z;
+
+  // Scale with maximum edge length
+  vmax = vmax*max(tl1, max(tl2, tl3));
+
+  return vmax;
+}
+
+template<ConservationLaw CL, int warnFlag = 1>
+__host__ __device__ __forceinline__
+real FindMaxSignalSpeed(int t, int a, int b, int c,
+                        real3 *pState, const real3* __restrict__ pTl,
+                        real G, real G1, real *pVp)
+{
+  real zero = (real) 0.0;
+  real one = (real) 1.0;
+
+  real vmax = zero;
+
+  // First vertex
+  real dens = pState[a].x;
+  real momx = pState[a].y;
+  real momy = pState[a].z;
+
+  real id = one/dens;
+  real u = momx;
+  real v = momy;
+  real absv = sqrt(u*u+v*v)*id;
+
+  // Sound speed
+  real cs = 1.0;
+
+  // Maximum signal speed
+  vmax = absv + cs;
+
+  // Second vertex
+  dens = pState[b].x;
+  momx = pState[b].y;
+  momy = pState[b].z;
+
+  id = one/dens;
+  u = momx;
+  v = momy;
+  absv = sqrt(u*u+v*v)*id;
+
+  vmax = max(vmax, absv + cs);
+
+  // Third vertex
+  dens = pState[c].x;
+  momx = pState[c].y;
+  momy = pState[c].z;
+
+  id = one/dens;
+  u = momx;
+  v = momy;
+  absv = sqrt(u*u+v*v)*id;
+
+  vmax = max(vmax, absv + cs);
+
+  // Triangle edge lengths
+  real tl1 = pTl[t].x;
+  real tl2 = pTl[t].y;
+  real tl3 = pTl[t].z;
+
+  // Scale with maximum edge length
+  vmax = vmax*max(tl1, max(tl2, tl3));
+
+  return vmax;
+}
+
+template<ConservationLaw CL, int warnFlag = 1>
+__host__ __device__ __forceinline__
+real FindMaxSignalSpeed(int t, int a, int b, int c,
+                        real *pState, const real3* __restrict__ pTl,
+                        real G, real G1, real *pVp)
+{
+  // Triangle edge lengths
+  real tl1 = pTl[t].x;
+  real tl2 = pTl[t].y;
+  real tl3 = pTl[t].z;
+
+  if (CL == CL_BURGERS) {
+    real vmax = fabs(pState[a]);
+    vmax = max(vmax, fabs(pState[b]));
+    vmax = max(vmax, fabs(pState[c]));
+    return vmax*max(tl1, max(tl2, tl3));
+  } else {
+    // Scalar advection with velocity unity
+    return 1.0*max(tl1, max(tl2, tl3));
+  }
+}
+
+}  // namespace astrix
+
+#endif  // ASTRIX_SIGNALSPEED_H
@@ -14,7 +14,7 @@ Astrix is distributed in the hope that it will be useful, but WITHOUT ANY WARRAN
 You should have received a copy of the GNU General Public License
 along with Astrix.  If not, see <http://www.gnu.org/licenses/>.*/
 
-#include <cuda_runtime_api.h>
+#include "../Common/cudaRuntime.h"
 #include <fstream>
 #include <iostream>
 #include <sstream>
@@ -22,6 +22,7 @@ along with Astrix.  If not, see <http://www.gnu.org/licenses/>.*/
 
 #include "../Common/definitions.h"
 #include "../Array/array.h"
+#include "../Common/state.h"
 #include "../Mesh/mesh.h"
 #include "../Device/device.h"
 #include "./simulation.h"
@@ -93,6 +94,50 @@ Simulation<realNeq, CL>::Simulation(int _verboseLevel,
   triangleShockSensor = new Array<real>(1, cudaFlag);
   triangleResidueSource  = new Array<realNeq>(1, cudaFlag);
 
+  // Arrays accessed through state::Pointer
+  state::SetLayout(vertexParameterVector);
+  state::SetLayout(triangleResidueN);
+  state::SetLayout(triangleResidueLDA);
+  state::SetLayout(triangleResidueTotal);
+  state::SetLayout(triangleResidueSource);
+
+  // Workspace arrays, reused every time step
+  vertexUnphysicalFlag = new Array<int>(1, cudaFlag);
+  vertexRetryList      = new Array<int>(1, cudaFlag);
+  triangleRetryList    = new Array<int>(1, cudaFlag);
+  vertexUpdateList     = new Array<int>(1, cudaFlag);
+  triangleRetryMark    = new Array<int>(1, cudaFlag);
+  vertexRetryMark      = new Array<int>(1, cudaFlag);
+  retryCount           = new Array<int>(1, cudaFlag, 1);
+  vertexTimestep       = new Array<real>(1, cudaFlag);
+  triangleSignalSpeed  = new Array<real>(1, cudaFlag);
+  vertexOutput         = new Array<real>(4, 0);
+
+  // Local time stepping, only used if maxTimeLevel > 0
+  triangleTimeLevel     = new Array<int>(1, cudaFlag);
+  triangleTimeLevelOld  = new Array<int>(1, cudaFlag);
+  triangleTimestep      = new Array<real>(1, cudaFlag);
+  triangleActive        = new Array<int>(1, cudaFlag);
+  vertexActive          = new Array<int>(1, cudaFlag);
+  activeFlag            = new Array<int>(1, cudaFlag);
+  activeFlagScan        = new Array<int>(1, cudaFlag);
+  triangleInterfaceFlux = new Array<realNeq>(3, cudaFlag);
+  localTimeStepFlag = 0;
+
+  // Implicit integration, only used if implicitFlag = 1
+  linSys               = new LinSys(verboseLevel, debugLevel, device);
+  vertexStateNewton    = new Array<realNeq>(1, cudaFlag);
+  vertexStateTrial     = new Array<realNeq>(1, cudaFlag);
+  vertexStatePerturbed = new Array<realNeq>(1, cudaFlag);
+  implicitResidual     = new Array<real>(1, cudaFlag);
+  implicitRhs          = new Array<real>(1, cudaFlag);
+  implicitCorrection   = new Array<real>(1, cudaFlag);
+  implicitState        = new Array<real>(1, cudaFlag);
+  nImplicitStep = 0;
+  nNewtonIteration = 0;
+  nImplicitReject = 0;
+  implicitTime = 0.0;
+
   try {
     // Initialize simulation
     Init(restartNumber);
@@ -113,6 +158,35 @@ Simulation<realNeq, CL>::Simulation(int _verboseLevel,
     delete triangleShockSensor;
     delete triangleResidueSource;
 
+    delete vertexUnphysicalFlag;
+    delete vertexRetryList;
+    delete triangleRetryList;
+    delete vertexUpdateList;
+    delete triangleRetryMark;
+    delete vertexRetryMark;
+    delete retryCount;
+    delete vertexTimestep;
+    delete triangleSignalSpeed;
+    delete vertexOutput;
+
+    delete triangleTimeLevel;
+    delete triangleTimeLevelOld;
+    delete triangleTimestep;
+    delete triangleActive;
+    delete vertexActive;
+    delete activeFlag;
+    delete activeFlagScan;
+    delete triangleInterfaceFlux;
+
+    delete linSys;
+    delete vertexStateNewton;
+    delete vertexStateTrial;
+    delete vertexStatePerturbed;
+    delete implicitResidual;
+    delete implicitRhs;
+    delete implicitCorrection;
+    delete implicitState;
+
     delete mesh;
     delete simulationParameter;
 
@@ -139,6 +213,35 @@ Simulation<realNeq, CL>::~Simulation()
   delete triangleShockSensor;
   delete triangleResidueSource;
 
+  delete vertexUnphysicalFlag;
+  delete vertexRetryList;
+  delete triangleRetryList;
+  delete vertexUpdateList;
+  delete triangleRetryMark;
+  delete vertexRetryMark;
+  delete retryCount;
+  delete vertexTimestep;
+  delete triangleSignalSpeed;
+  delete vertexOutput;
+
+  delete triangleTimeLevel;
+  delete triangleTimeLevelOld;
+  delete triangleTimestep;
+  delete triangleActive;
+  delete vertexActive;
+  delete activeFlag;
+  delete activeFlagScan;
+  delete triangleInterfaceFlux;
+
+  delete linSys;
+  delete vertexStateNewton;
+  delete vertexStateTrial;
+  delete vertexStatePerturbed;
+  delete implicitResidual;
+  delete implicitRhs;
+  delete implicitCorrection;
+  delete implicitState;
+
   delete mesh;
   delete simulationParameter;
 }
@@ -17,6 +17,8 @@ along with Astrix.  If not, see <http://www.gnu.org/licenses/>.*/
 
 #define CONTOUR
 
+#include "../LinSys/linsys.h"
+
 namespace astrix {
 
 class Mesh;
@@ -28,7 +30,7 @@ class SimulationParameter;
 /*! This is the basic class needed to run an Astrix simulation.  */
 
 template <class realNeq, ConservationLaw CL>
-class Simulation
+class Simulation : private LinearOperator
 {
  public:
   //! Constructor for Simulation object.
@@ -88,6 +90,77 @@ class Simulation
   //! Source contribution to residual
   Array <realNeq> *triangleResidueSource;
 
+  //! Workspace: flag whether state at vertex is unphysical
+  Array<int> *vertexUnphysicalFlag;
+  //! Workspace: vertices with unphysical state in current update cycle
+  Array<int> *vertexRetryList;
+  //! Workspace: triangles sharing a vertex in \a vertexRetryList
+  Array<int> *triangleRetryList;
+  //! Workspace: vertices of triangles in \a triangleRetryList
+  Array<int> *vertexUpdateList;
+  //! Workspace: marks for triangles while building \a triangleRetryList
+  Array<int> *triangleRetryMark;
+  //! Workspace: marks for vertices while building \a vertexUpdateList
+  Array<int> *vertexRetryMark;
+  //! Workspace: number of entries while building retry lists
+  Array<int> *retryCount;
+  //! Workspace: maximum allowed time step at vertex
+  Array<real> *vertexTimestep;
+  //! Workspace: maximum signal speed in triangles
+  Array<real> *triangleSignalSpeed;
+  //! Workspace: host buffer for density, momenta and energy when saving
+  Array<real> *vertexOutput;
+
+  //! Local time stepping: time level of triangles
+  Array<int> *triangleTimeLevel;
+  //! Local time stepping workspace: time levels before a smoothing sweep
+  Array<int> *triangleTimeLevelOld;
+  //! Local time stepping: time step of triangles in current substep
+  Array<real> *triangleTimestep;
+  //! Local time stepping: triangles updated in current substep
+  Array<int> *triangleActive;
+  //! Local time stepping: vertices of active triangles plus boundary vertices
+  Array<int> *vertexActive;
+  //! Local time stepping workspace: flag whether triangle or vertex is active
+  Array<int> *activeFlag;
+  //! Local time stepping workspace: exclusive scan of \a activeFlag
+  Array<int> *activeFlagScan;
+  //! Local time stepping: flux through edges at time level interfaces
+  Array<realNeq> *triangleInterfaceFlux;
+  //! Flag whether only triangles in \a triangleActive are updated
+  int localTimeStepFlag;
+
+  //! Implicit integration: linear solver for Newton iterations
+  LinSys *linSys;
+  //! Implicit integration: current Newton iterate
+  Array<realNeq> *vertexStateNewton;
+  //! Implicit integration: trial Newton iterate, accepted if |G| decreases
+  Array<realNeq> *vertexStateTrial;
+  //! Implicit integration: perturbed state for Jacobian-vector products
+  Array<realNeq> *vertexStatePerturbed;
+  //! Implicit integration: nonlinear residual at current Newton iterate
+  Array<real> *implicitResidual;
+  //! Implicit integration: right-hand side of linear system
+  Array<real> *implicitRhs;
+  //! Implicit integration: Newton correction
+  Array<real> *implicitCorrection;
+  //! Implicit integration: current Newton iterate as vector of reals
+  Array<real> *implicitState;
+  //! Implicit integration: time step
+  real implicitTimestep;
+  //! Implicit integration: explicit time step used to evaluate residuals
+  real implicitResidualStep;
+  //! Implicit integration: norm of current Newton iterate
+  real implicitStateNorm;
+  //! Implicit integration: number of time steps taken
+  int64_t nImplicitStep;
+  //! Implicit integration: total number of Newton iterations
+  int64_t nNewtonIteration;
+  //! Implicit integration: number of rejected time steps
+  int64_t nImplicitReject;
+  //! Implicit integration: total wall clock time (s)
+  double implicitTime;
+
   //! Set up the simulation
   void Init(int restartNumber);
 
@@ -106,8 +179,40 @@ class Simulation
   //! Add eigenvector perturbation for RT problem
   void RTAddEigenVector();
 
+  //! Problem-specific parts of a time step, see problem.h
+  struct ProblemPipeline
+  {
+    //! Explicit time step specialised for problem
+    void (Simulation::*timeStep)();
+    //! Set state at boundaries before calculating residuals
+    void (Simulation::*stateBoundaries)();
+    //! Add source term
+    void (Simulation::*source)();
+    //! Add flux through boundaries after update
+    void (Simulation::*fluxBoundaries)(real dt);
+    //! Constrain state at boundaries after update
+    void (Simulation::*updateBoundaries)();
+  };
+  //! Pipeline for current problem
+  ProblemPipeline problemPipeline;
+
+  //! Select time step pipeline for problemDef
+  void SelectProblemPipeline();
+  //! Do one time step for problem P
+  template<ProblemDefinition P> void DoProblemTimeStep();
+  //! Set state at boundaries before calculating residuals for problem P
+  template<ProblemDefinition P> void SetProblemStateBoundaries();
+  //! Add source term for problem P
+  template<ProblemDefinition P> void CalcProblemSource();
+  //! Add flux through boundaries after update for problem P
+  template<ProblemDefinition P> void SetProblemFluxBoundaries(real dt);
+  //! Constrain state at boundaries after update for problem P
+  template<ProblemDefinition P> void SetProblemUpdateBoundaries();
+
   //! Do one time step
   void DoTimeStep();
+  //! Do one implicit (backward Euler) time step
+  void DoImplicitTimeStep();
 
   //! Set initial conditions according to problemSpec.
   void SetInitial(real time);
@@ -118,6 +223,18 @@ class Simulation
   void CalcSource(Array<realNeq> *state);
   //! For every vertex, calculate the maximum allowed timestep.
   real CalcVertexTimeStep();
+  //! Calculate maximum allowed timestep from signal speeds of triangles
+  real CalcVertexTimeStep(Array<real> *triangleVmax);
+  //! Assign local time step levels to triangles
+  int CalcTriangleTimeLevel(real dt);
+  //! Select triangles to update in substep of local time step
+  void SelectActiveTriangles(int subStep, real dt);
+  //! Calculate state difference for second stage with local time stepping
+  void CalcLocalStateDiff();
+  //! Calculate flux through edges between triangles of different time level
+  void CalcInterfaceFlux(real dt, real weight, int addFlag);
+  //! Restore conservation at edges between triangles of different time level
+  void AddInterfaceFlux();
 
   //! Set reflecting boundary conditions
   void ReflectingBoundaries(real dt);
@@ -136,6 +253,8 @@ class Simulation
   void CalculateParameterVector(int useOldFlag);
   //! Calculate space residual on triangles
   void CalcResidual();
+  //! Calculate parameter vector, space residual and signal speed in one pass
+  void CalcResidualFused(Array<real> *triangleVmax);
   //! Calculate space-time residual N plus total
   void CalcTotalResNtot(real dt);
   //! Calculate space-time LDA residual
@@ -151,14 +270,39 @@ class Simulation
   void UpdateState(real dt, int RKStep);
   //! Add residue to state at vertices
   void AddResidue(real dt);
+  //! Add residue to state at vertices in list
+  void AddResidue(real dt, Array<int> *vertexList);
   //! Find unphysical state and put in vertexUnphysicalFlag
   void FlagUnphysical(Array<int> *vertexUnphysicalFlag);
-  //! Find changes that are too large
-  void FlagLimit(Array<int> *vertexLimitFlag);
+  //! Find unphysical state at vertices in list
+  void FlagUnphysical(Array<int> *vertexUnphysicalFlag,
+                      Array<int> *vertexList);
+  //! Find changes that are too large at vertices in list
+  void FlagLimit(Array<int> *vertexLimitFlag, Array<int> *vertexList);
   //! Replace LDA with N wherever unphysical state
   void ReplaceLDA(Array<int> *vertexUnphysicalFlag, int RKStep);
+  //! Replace LDA with N wherever unphysical state for triangles in list
+  void ReplaceLDA(Array<int> *vertexUnphysicalFlag, int RKStep,
+                  Array<int> *triangleList);
+  //! Put vertices with unphysical state in vertexRetryList
+  int SelectUnphysical(Array<int> *vertexList);
+  //! Find triangles and vertices affected by retrying update
+  void FindRetryLists();
+  //! Restore old state at vertices in list
+  void RestoreState(Array<int> *vertexList);
+  //! Set old state equal to current state at vertices in list
+  void StoreState(Array<int> *vertexList);
   //! Calculate shock sensor for BX scheme
   void CalcShockSensor();
+
+  //! Update state implicitly using Newton-Krylov iterations
+  int ImplicitUpdate(real dt);
+  //! Calculate nonlinear residual of implicit update for \a state
+  void CalcImplicitResidual(Array<realNeq> *state, Array<real> *G);
+  //! Jacobian-vector product for implicit update (finite difference)
+  void MultiplyByMatrix(Array<real> *vIn, Array<real> *vOut);
+  //! Apply preconditioner for implicit update
+  void Precondition(Array<real> *vIn, Array<real> *vOut);
   //! Find minimum and maximum velocity in domain
   real2 FindMinMaxVelocity();
 
@@ -21,6 +21,7 @@ along with Astrix.  If not, see <http://www.gnu.org/licenses/>.*/
 #include "../Mesh/mesh.h"
 #include "./simulation.h"
 #include "../Common/cudaLow.h"
+#include "../Common/state.h"
 #include "./Param/simulationparameter.h"
 
 namespace astrix {
@@ -46,7 +47,7 @@ void CalcSourceSingle(int n, ProblemDefinition problemDef,
                       int nVertex, const int3 *pTv,
                       const real2 *pTn1, const real2 *pTn2, const real2 *pTn3,
                       const real3 *pTl, const real *pVp,
-                      const real4 *pState, real4 *pSource)
+                      const real4 *pState, state::Pointer<real4> pSource)
 {
   pSource[n].x = 0.0;
   pSource[n].y = 0.0;
@@ -61,12 +62,6 @@ void CalcSourceSingle(int n, ProblemDefinition problemDef,
     int v1 = pTv[n].x;
     int v2 = pTv[n].y;
     int v3 = pTv[n].z;
-    while (v1 >= nVertex) v1 -= nVertex;
-    while (v2 >= nVertex) v2 -= nVertex;
-    while (v3 >= nVertex) v3 -= nVertex;
-    while (v1 < 0) v1 += nVertex;
-    while (v2 < 0) v2 += nVertex;
-    while (v3 < 0) v3 += nVertex;
 
     real tl1 = pTl[n].x;
     real tl2 = pTl[n].y;
@@ -110,7 +105,7 @@ void CalcSourceSingle(int n, ProblemDefinition problemDef,
                       int nVertex, const int3 *pTv,
                       const real2 *pTn1, const real2 *pTn2, const real2 *pTn3,
                       const real3 *pTl, const real *pVp,
-                      const real3 *pState, real3 *pSource)
+                      const real3 *pState, state::Pointer<real3> pSource)
 {
   pSource[n].x = 0.0;
   pSource[n].y = 0.0;
@@ -124,12 +119,6 @@ void CalcSourceSingle(int n, ProblemDefinition problemDef,
     int v1 = pTv[n].x;
     int v2 = pTv[n].y;
     int v3 = pTv[n].z;
-    while (v1 >= nVertex) v1 -= nVertex;
-    while (v2 >= nVertex) v2 -= nVertex;
-    while (v3 >= nVertex) v3 -= nVertex;
-    while (v1 < 0) v1 += nVertex;
-    while (v2 < 0) v2 += nVertex;
-    while (v3 < 0) v3 += nVertex;
 
     real tl1 = pTl[n].x;
     real tl2 = pTl[n].y;
@@ -160,7 +149,7 @@ void CalcSourceSingle(int n, ProblemDefinition problemDef,
                       int nVertex, const int3 *pTv,
                       const real2 *pTn1, const real2 *pTn2, const real2 *pTn3,
                       const real3 *pTl, const real *pVp,
-                      const real *pState, real *pSource)
+                      const real *pState, state::Pointer<real> pSource)
 {
   pSource[n] = 0.0;
 
@@ -171,12 +160,6 @@ void CalcSourceSingle(int n, ProblemDefinition problemDef,
     int v1 = pTv[n].x;
     int v2 = pTv[n].y;
     int v3 = pTv[n].z;
-    while (v1 >= nVertex) v1 -= nVertex;
-    while (v2 >= nVertex) v2 -= nVertex;
-    while (v3 >= nVertex) v3 -= nVertex;
-    while (v1 < 0) v1 += nVertex;
-    while (v2 < 0) v2 += nVertex;
-    while (v3 < 0) v3 += nVertex;
 
     real tl1 = pTl[n].x;
     real tl2 = pTl[n].y;
@@ -216,7 +199,7 @@ devCalcSource(int nTriangle, ProblemDefinition problemDef,
               int nVertex, const int3 *pTv,
               const real2 *pTn1, const real2 *pTn2, const real2 *pTn3,
               const real3 *pTl, const real *pVp,
-              const realNeq *pState, realNeq *pSource)
+              const realNeq *pState, state::Pointer<realNeq> pSource)
 {
   // n = vertex number
   int n = blockIdx.x*blockDim.x + threadIdx.x;
@@ -244,10 +227,10 @@ void Simulation<realNeq, CL>::CalcSource(Array<realNeq> *state)
 
   ProblemDefinition problemDef = simulationParameter->problemDef;
 
-  const int3 *pTv = mesh->TriangleVerticesData();
+  const int3 *pTv = mesh->TriangleVerticesWrappedData();
   const real *pVp = vertexPotential->GetPointer();
   const realNeq *pState = state->GetPointer();
-  realNeq *pSource = triangleResidueSource->GetPointer();
+  state::Pointer<realNeq> pSource = state::GetPointer(triangleResidueSource);
 
   const real2 *pTn1 = mesh->TriangleEdgeNormalsData(0);
   const real2 *pTn2 = mesh->TriangleEdgeNormalsData(1);
@@ -264,13 +247,14 @@ void Simulation<realNeq, CL>::CalcSource(Array<realNeq> *state)
                                        devCalcSource<realNeq, CL>,
                                        (size_t) 0, 0);
 
-    devCalcSource<realNeq, CL><<<nBlocks, nThreads>>>
+    LaunchKernel(nBlocks, nThreads, devCalcSource<realNeq, CL>)
       (nTriangle, problemDef, nVertex,
        pTv, pTn1, pTn2, pTn3, pTl, pVp, pState, pSource);
 
     gpuErrchk( cudaPeekAtLastError() );
     gpuErrchk( cudaDeviceSynchronize() );
   } else {
+#pragma omp parallel for
     for (int i = 0; i < nTriangle; i++)
       CalcSourceSingle(i, problemDef, nVertex,
                        pTv, pTn1, pTn2, pTn3, pTl,
@@ -21,9 +21,13 @@ along with Astrix.  If not, see <http://www.gnu.org/licenses/>.*/
 #include "../Array/array.h"
 #include "../Mesh/mesh.h"
 #include "./simulation.h"
+#include "./timelevel.h"
+#include "../Common/atomic.h"
 #include "../Common/cudaLow.h"
 #include "../Common/inlineMath.h"
 #include "./upwind.h"
+#include "./paramvec.h"
+#include "./signalspeed.h"
 #include "../Common/profile.h"
 #include "./Param/simulationparameter.h"
 
@@ -55,14 +59,19 @@ namespace astrix {
 //######################################################################
 
 template<ConservationLaw CL>
-__host__ __device__
-void CalcSpaceResSingle(int n, const int3 *pTv, real4 *pVz,
+__host__ __device__ __forceinline__
+void CalcSpaceResSingle(int n, const int3 *pTv, state::Pointer<real4> pVz,
                         const real2 *pTn1, const real2 *pTn2,
                         const real2 *pTn3, const real3 *pTl,
-                        real4 *pResSource,
-                        real4 *pTresN0, real4 *pTresN1, real4 *pTresN2,
-                        real4 *pTresLDA0, real4 *pTresLDA1, real4 *pTresLDA2,
-                        real4 *pTresTot, int nVertex, real G, real G1, real G2,
+                        state::Pointer<real4> pResSource,
+                        state::Pointer<real4> pTresN0,
+                        state::Pointer<real4> pTresN1,
+                        state::Pointer<real4> pTresN2,
+                        state::Pointer<real4> pTresLDA0,
+                        state::Pointer<real4> pTresLDA1,
+                        state::Pointer<real4> pTresLDA2,
+                        state::Pointer<real4> pTresTot, int nVertex, real G,
+                        real G1, real G2,
                         real *pVp)
 {
   const real zero  = (real) 0.0;
@@ -75,12 +84,6 @@ void CalcSpaceResSingle(int n, const int3 *pTv, real4 *pVz,
   int v1 = pTv[n].x;
   int v2 = pTv[n].y;
   int v3 = pTv[n].z;
-  while (v1 >= nVertex) v1 -= nVertex;
-  while (v2 >= nVertex) v2 -= nVertex;
-  while (v3 >= nVertex) v3 -= nVertex;
-  while (v1 < 0) v1 += nVertex;
-  while (v2 < 0) v2 += nVertex;
-  while (v3 < 0) v3 += nVertex;
 
   // External potential at vertices
   real pot0 = pVp[v1];
@@ -974,14 +977,19 @@ void CalcSpaceResSingle(int n, const int3 *pTv, real4 *pVz,
 }
 
 template<ConservationLaw CL>
-__host__ __device__
-void CalcSpaceResSingle(int n, const int3 *pTv, real3 *pVz,
+__host__ __device__ __forceinline__
+void CalcSpaceResSingle(int n, const int3 *pTv, state::Pointer<real3> pVz,
                         const real2 *pTn1, const real2 *pTn2,
                         const real2 *pTn3, const real3 *pTl,
-                        real3 *pResSource,
-                        real3 *pTresN0, real3 *pTresN1, real3 *pTresN2,
-                        real3 *pTresLDA0, real3 *pTresLDA1, real3 *pTresLDA2,
-                        real3 *pTresTot, int nVertex, real G, real G1, real G2,
+                        state::Pointer<real3> pResSource,
+                        state::Pointer<real3> pTresN0,
+                        state::Pointer<real3> pTresN1,
+                        state::Pointer<real3> pTresN2,
+                        state::Pointer<real3> pTresLDA0,
+                        state::Pointer<real3> pTresLDA1,
+                        state::Pointer<real3> pTresLDA2,
+                        state::Pointer<real3> pTresTot, int nVertex, real G,
+                        real G1, real G2,
                         real *pVp)
 {
   const real zero  = (real) 0.0;
@@ -994,12 +1002,6 @@ void CalcSpaceResSingle(int n, const int3 *pTv, real3 *pVz,
   int v1 = pTv[n].x;
   int v2 = pTv[n].y;
   int v3 = pTv[n].z;
-  while (v1 >= nVertex) v1 -= nVertex;
-  while (v2 >= nVertex) v2 -= nVertex;
-  while (v3 >= nVertex) v3 -= nVertex;
-  while (v1 < 0) v1 += nVertex;
-  while (v2 < 0) v2 += nVertex;
-  while (v3 < 0) v3 += nVertex;
 
   // Parameter vector at vertices: 12 uncoalesced loads
   real Zv00 = pVz[v1].x;
@@ -1625,14 +1627,19 @@ void CalcSpaceResSingle(int n, const int3 *pTv, real3 *pVz,
 }
 
 template<ConservationLaw CL>
-__host__ __device__
-void CalcSpaceResSingle(int n, const int3 *pTv, real *pVz,
+__host__ __device__ __forceinline__
+void CalcSpaceResSingle(int n, const int3 *pTv, state::Pointer<real> pVz,
                         const real2 *pTn1, const real2 *pTn2,
                         const real2 *pTn3, const real3 *pTl,
-                        real *pResSource,
-                        real *pTresN0, real *pTresN1, real *pTresN2,
-                        real *pTresLDA0, real *pTresLDA1, real *pTresLDA2,
-                        real *pTresTot, int nVertex, real G, real G1, real G2,
+                        state::Pointer<real> pResSource,
+                        state::Pointer<real> pTresN0,
+                        state::Pointer<real> pTresN1,
+                        state::Pointer<real> pTresN2,
+                        state::Pointer<real> pTresLDA0,
+                        state::Pointer<real> pTresLDA1,
+                        state::Pointer<real> pTresLDA2,
+                        state::Pointer<real> pTresTot, int nVertex, real G,
+                        real G1, real G2,
                         real *pVp)
 {
   const real zero  = (real) 0.0;
@@ -1643,12 +1650,6 @@ void CalcSpaceResSingle(int n, const int3 *pTv, real *pVz,
   int v1 = pTv[n].x;
   int v2 = pTv[n].y;
   int v3 = pTv[n].z;
-  while (v1 >= nVertex) v1 -= nVertex;
-  while (v2 >= nVertex) v2 -= nVertex;
-  while (v3 >= nVertex) v3 -= nVertex;
-  while (v1 < 0) v1 += nVertex;
-  while (v2 < 0) v2 += nVertex;
-  while (v3 < 0) v3 += nVertex;
 
   // Parameter vector at vertices: 12 uncoalesced loads
   real Zv0 = pVz[v1];
@@ -1833,6 +1834,7 @@ void CalcSpaceResSingle(int n, const int3 *pTv, real *pVz,
 /*! \brief Kernel calculating spacial residue for all triangles
 
 \param nTriangle Total number of triangles in Mesh
+\param *pTa Pointer to list of active triangles, or zero
 \param *pTv Pointer to triangle vertices
 \param *pVz Pointer to parameter vector
 \param *pTn1 Pointer first triangle edge normal
@@ -1856,23 +1858,163 @@ void CalcSpaceResSingle(int n, const int3 *pTv, real *pVz,
 
 template<class realNeq, ConservationLaw CL>
 __global__ void
-devCalcSpaceRes(int nTriangle, const int3 *pTv, realNeq *pVz,
+devCalcSpaceRes(int nTriangle, const int *pTa, const int3 *pTv,
+                state::Pointer<realNeq> pVz,
                 const real2 *pTn1, const real2 *pTn2,
-                const real2 *pTn3, const real3 *pTl, realNeq *pResSource,
-                realNeq *pTresN0, realNeq *pTresN1, realNeq *pTresN2,
-                realNeq *pTresLDA0, realNeq *pTresLDA1, realNeq *pTresLDA2,
-                realNeq *pTresTot, int nVertex, real G, real G1, real G2,
+                const real2 *pTn3, const real3 *pTl,
+                state::Pointer<realNeq> pResSource,
+                state::Pointer<realNeq> pTresN0,
+                state::Pointer<realNeq> pTresN1,
+                state::Pointer<realNeq> pTresN2,
+                state::Pointer<realNeq> pTresLDA0,
+                state::Pointer<realNeq> pTresLDA1,
+                state::Pointer<realNeq> pTresLDA2,
+                state::Pointer<realNeq> pTresTot, int nVertex, real G, real G1,
+                real G2,
                 real *pVp)
 {
-  int n = blockIdx.x*blockDim.x + threadIdx.x;
-
+  int i = blockIdx.x*blockDim.x + threadIdx.x;
 
-  while (n < nTriangle) {
+  while (i < nTriangle) {
+    int n = ActiveTriangle(i, pTa);
     CalcSpaceResSingle<CL>(n, pTv, pVz, pTn1, pTn2, pTn3, pTl, pResSource,
                            pTresN0, pTresN1, pTresN2,
                            pTresLDA0, pTresLDA1, pTresLDA2,
                            pTresTot, nVertex, G, G1, G2, pVp);
 
+    // Next triangle
+    i += blockDim.x*gridDim.x;
+  }
+}
+
+//######################################################################
+/*! \brief Calculate parameter vector, spatial residue and maximum signal speed at triangle n
+
+Roe's parameter vector at the three vertices is computed on the fly rather than read from a vertex array. The vertices are renumbered 0, 1, 2 so that CalcSpaceResSingle works on these local copies. Results are identical to CalcParamVecSingle followed by CalcSpaceResSingle and CalcVmaxTriangleSingle. Instead of printing a warning for negative pressure, which would prevent host loops from vectorising, 1 is returned if the pressure is negative at any of the vertices and 0 otherwise.
+
+\param n Triangle to consider
+\param *pTv Pointer to triangle vertices
+\param *pState Pointer to state at vertices
+\param *pTn1 Pointer first triangle edge normal
+\param *pTn2 Pointer second triangle edge normal
+\param *pTn3 Pointer third triangle edge normal
+\param *pTl Pointer to triangle edge lengths
+\param *pResSource Pointer to source term contribution to residual
+\param *pTresN0 Triangle residue N direction 0
+\param *pTresN1 Triangle residue N direction 1
+\param *pTresN2 Triangle residue N direction 2
+\param *pTresLDA0 Triangle residue LDA direction 0
+\param *pTresLDA1 Triangle residue LDA direction 1
+\param *pTresLDA2 Triangle residue LDA direction 2
+\param *pTresTot Triangle total residue
+\param *pTvmax Pointer to maximum signal speed of triangles (output)
+\param nVertex Total number of vertices in Mesh
+\param G Ratio of specific heats
+\param G1 G - 1
+\param G2 G - 2
+\param *pVp Pointer to external potential at vertices*/
+//######################################################################
+
+template<class realNeq, ConservationLaw CL>
+__host__ __device__ __forceinline__
+int CalcSpaceResFusedSingle(int n, const int3 *pTv, realNeq *pState,
+                             const real2 *pTn1, const real2 *pTn2,
+                             const real2 *pTn3, const real3 *pTl,
+                             state::Pointer<realNeq> pResSource,
+                             state::Pointer<realNeq> pTresN0,
+                             state::Pointer<realNeq> pTresN1,
+                             state::Pointer<realNeq> pTresN2,
+                             state::Pointer<realNeq> pTresLDA0,
+                             state::Pointer<realNeq> pTresLDA1,
+                             state::Pointer<realNeq> pTresLDA2,
+                             state::Pointer<realNeq> pTresTot, real *pTvmax,
+                             int nVertex,
+                             real G, real G1, real G2, real *pVp)
+{
+  int a = pTv[n].x;
+  int b = pTv[n].y;
+  int c = pTv[n].z;
+
+  // Potential at vertices, renumbered 0, 1, 2
+  real pot[3] = {pVp[a], pVp[b], pVp[c]};
+
+  // Parameter vector at vertices, renumbered 0, 1, 2. The state is read
+  // component by component, so that host loops can vectorise the loads
+  realNeq Zlocal[3];
+  state::Pointer<realNeq> Z = state::MakePointer(Zlocal, 3);
+  CalcParamVecSingle(0, pState + a, Z + 0, G1, pVp + a);
+  CalcParamVecSingle(0, pState + b, Z + 1, G1, pVp + b);
+  CalcParamVecSingle(0, pState + c, Z + 2, G1, pVp + c);
+
+  const int3 tv = make_int3(0, 1, 2);
+
+  CalcSpaceResSingle<CL>(0, &tv, Z, pTn1 + n, pTn2 + n, pTn3 + n,
+                         pTl + n, pResSource + n,
+                         pTresN0 + n, pTresN1 + n, pTresN2 + n,
+                         pTresLDA0 + n, pTresLDA1 + n, pTresLDA2 + n,
+                         pTresTot + n, 3, G, G1, G2, pot);
+
+  pTvmax[n] = FindMaxSignalSpeed<CL, 0>(n, a, b, c, pState, pTl, G, G1, pVp);
+
+  return (NegativePressureSingle(a, pState, G1, pVp) |
+          NegativePressureSingle(b, pState, G1, pVp) |
+          NegativePressureSingle(c, pState, G1, pVp));
+}
+
+//######################################################################
+/*! \brief Kernel calculating parameter vector, spatial residue and maximum signal speed for all triangles
+
+\param nTriangle Total number of triangles in Mesh
+\param *pTv Pointer to triangle vertices
+\param *pState Pointer to state at vertices
+\param *pTn1 Pointer first triangle edge normal
+\param *pTn2 Pointer second triangle edge normal
+\param *pTn3 Pointer third triangle edge normal
+\param *pTl Pointer to triangle edge lengths
+\param *pResSource Pointer to source term contribution to residual
+\param *pTresN0 Triangle residue N direction 0
+\param *pTresN1 Triangle residue N direction 1
+\param *pTresN2 Triangle residue N direction 2
+\param *pTresLDA0 Triangle residue LDA direction 0
+\param *pTresLDA1 Triangle residue LDA direction 1
+\param *pTresLDA2 Triangle residue LDA direction 2
+\param *pTresTot Triangle total residue
+\param *pTvmax Pointer to maximum signal speed of triangles (output)
+\param nVertex Total number of vertices in Mesh
+\param G Ratio of specific heats
+\param G1 G - 1
+\param G2 G - 2
+\param *pVp Pointer to external potential at vertices
+\param *pNegativePressure Pointer to flag set to 1 if negative pressure is encountered (output)*/
+//######################################################################
+
+template<class realNeq, ConservationLaw CL>
+__global__ void
+devCalcSpaceResFused(int nTriangle, const int3 *pTv, realNeq *pState,
+                     const real2 *pTn1, const real2 *pTn2,
+                     const real2 *pTn3, const real3 *pTl,
+                     state::Pointer<realNeq> pResSource,
+                     state::Pointer<realNeq> pTresN0,
+                     state::Pointer<realNeq> pTresN1,
+                     state::Pointer<realNeq> pTresN2,
+                     state::Pointer<realNeq> pTresLDA0,
+                     state::Pointer<realNeq> pTresLDA1,
+                     state::Pointer<realNeq> pTresLDA2,
+                     state::Pointer<realNeq> pTresTot, real *pTvmax,
+                     int nVertex, real G, real G1, real G2, real *pVp,
+                     int *pNegativePressure)
+{
+  int n = blockIdx.x*blockDim.x + threadIdx.x;
+
+  while (n < nTriangle) {
+    if (CalcSpaceResFusedSingle<realNeq, CL>(n, pTv, pState, pTn1, pTn2, pTn3,
+                                         pTl, pResSource,
+                                         pTresN0, pTresN1, pTresN2,
+                                         pTresLDA0, pTresLDA1, pTresLDA2,
+                                         pTresTot, pTvmax, nVertex,
+                                         G, G1, G2, pVp) == 1)
+      AtomicExch(pNegativePressure, 1);
+
     // Next triangle
     n += blockDim.x*gridDim.x;
   }
@@ -1919,22 +2061,29 @@ void Simulation<realNeq, CL>::CalcResidual()
   int nTriangle = mesh->GetNTriangle();
   int nVertex = mesh->GetNVertex();
 
-  realNeq *pResSource = triangleResidueSource->GetPointer();
-  realNeq *pVz = vertexParameterVector->GetPointer();
+  // With local time stepping, only update active triangles
+  const int *pTa = 0;
+  if (localTimeStepFlag == 1) {
+    nTriangle = triangleActive->GetSize();
+    pTa = triangleActive->GetPointer();
+  }
+
+  state::Pointer<realNeq> pResSource = state::GetPointer(triangleResidueSource);
+  state::Pointer<realNeq> pVz = state::GetPointer(vertexParameterVector);
   real *pVp = vertexPotential->GetPointer();
   real G = simulationParameter->specificHeatRatio;
 
-  realNeq *pTresN0 = triangleResidueN->GetPointer(0);
-  realNeq *pTresN1 = triangleResidueN->GetPointer(1);
-  realNeq *pTresN2 = triangleResidueN->GetPointer(2);
+  state::Pointer<realNeq> pTresN0 = state::GetPointer(triangleResidueN, 0);
+  state::Pointer<realNeq> pTresN1 = state::GetPointer(triangleResidueN, 1);
+  state::Pointer<realNeq> pTresN2 = state::GetPointer(triangleResidueN, 2);
 
-  realNeq *pTresLDA0 = triangleResidueLDA->GetPointer(0);
-  realNeq *pTresLDA1 = triangleResidueLDA->GetPointer(1);
-  realNeq *pTresLDA2 = triangleResidueLDA->GetPointer(2);
+  state::Pointer<realNeq> pTresLDA0 = state::GetPointer(triangleResidueLDA, 0);
+  state::Pointer<realNeq> pTresLDA1 = state::GetPointer(triangleResidueLDA, 1);
+  state::Pointer<realNeq> pTresLDA2 = state::GetPointer(triangleResidueLDA, 2);
 
-  realNeq *pTresTot = triangleResidueTotal->GetPointer();
+  state::Pointer<realNeq> pTresTot = state::GetPointer(triangleResidueTotal);
 
-  const int3 *pTv = mesh->TriangleVerticesData();
+  const int3 *pTv = mesh->TriangleVerticesWrappedData();
 
   const real2 *pTn1 = mesh->TriangleEdgeNormalsData(0);
   const real2 *pTn2 = mesh->TriangleEdgeNormalsData(1);
@@ -1954,8 +2103,8 @@ void Simulation<realNeq, CL>::CalcResidual()
 #ifdef TIME_ASTRIX
     gpuErrchk( cudaEventRecord(start, 0) );
 #endif
-    devCalcSpaceRes<realNeq, CL><<<nBlocks, nThreads>>>
-      (nTriangle, pTv, pVz,
+    LaunchKernel(nBlocks, nThreads, devCalcSpaceRes<realNeq, CL>)
+      (nTriangle, pTa, pTv, pVz,
        pTn1, pTn2, pTn3, pTl, pResSource,
        pTresN0, pTresN1, pTresN2,
        pTresLDA0, pTresLDA1, pTresLDA2,
@@ -1971,12 +2120,17 @@ void Simulation<realNeq, CL>::CalcResidual()
 #ifdef TIME_ASTRIX
     gpuErrchk( cudaEventRecord(start, 0) );
 #endif
-    for (int n = 0; n < nTriangle; n++)
+    // Triangles are independent: one triangle per vector lane
+    int hostSimdFlag = simulationParameter->hostSimdFlag;
+#pragma omp parallel for simd if(simd: hostSimdFlag == 1)
+    for (int i = 0; i < nTriangle; i++) {
+      int n = ActiveTriangle(i, pTa);
       CalcSpaceResSingle<CL>(n, pTv, pVz,
                              pTn1, pTn2, pTn3, pTl, pResSource,
                              pTresN0, pTresN1, pTresN2,
                              pTresLDA0, pTresLDA1, pTresLDA2,
                              pTresTot, nVertex, G, G - 1.0, G - 2.0, pVp);
+    }
 #ifdef TIME_ASTRIX
     gpuErrchk( cudaEventRecord(stop, 0) );
     gpuErrchk( cudaEventSynchronize(stop) );
@@ -1985,7 +2139,7 @@ void Simulation<realNeq, CL>::CalcResidual()
 
 #ifdef TIME_ASTRIX
   gpuErrchk( cudaEventElapsedTime(&elapsedTime, start, stop) );
-  WriteProfileFile("CalcResidual.prof2", nTriangle, elapsedTime, cudaFlag);
+  AddProfile("CalcResidual", nTriangle, elapsedTime, cudaFlag);
 #endif
 
   if (transformFlag == 1) {
@@ -2012,6 +2166,126 @@ void Simulation<realNeq, CL>::CalcResidual()
   }
 }
 
+//######################################################################
+/*! Calculate spatial residue for all triangles as CalcResidual(), but
+computing Roe's parameter vector on the fly from \a vertexState and finding the
+maximum signal speed of every triangle in the same pass. This replaces
+CalculateParameterVector(), CalcResidual() and the signal speed part of
+CalcVertexTimeStep() by a single traversal of the triangles, saving the memory
+traffic of reading the triangle vertices, normals and edge lengths three times
+and of storing \a vertexParameterVector. Note that \a vertexParameterVector is
+not updated.
+
+\param *triangleVmax Maximum signal speed of triangles (output), to be passed on to CalcVertexTimeStep()*/
+//######################################################################
+
+template <class realNeq, ConservationLaw CL>
+void Simulation<realNeq, CL>::CalcResidualFused(Array<real> *triangleVmax)
+{
+#ifdef TIME_ASTRIX
+  cudaEvent_t start, stop;
+  float elapsedTime = 0.0f;
+  gpuErrchk( cudaEventCreate(&start) );
+  gpuErrchk( cudaEventCreate(&stop) );
+#endif
+
+  int nTriangle = mesh->GetNTriangle();
+  int nVertex = mesh->GetNVertex();
+
+  realNeq *pState = vertexState->GetPointer();
+  state::Pointer<realNeq> pResSource = state::GetPointer(triangleResidueSource);
+  real *pVp = vertexPotential->GetPointer();
+  real G = simulationParameter->specificHeatRatio;
+
+  state::Pointer<realNeq> pTresN0 = state::GetPointer(triangleResidueN, 0);
+  state::Pointer<realNeq> pTresN1 = state::GetPointer(triangleResidueN, 1);
+  state::Pointer<realNeq> pTresN2 = state::GetPointer(triangleResidueN, 2);
+
+  state::Pointer<realNeq> pTresLDA0 = state::GetPointer(triangleResidueLDA, 0);
+  state::Pointer<realNeq> pTresLDA1 = state::GetPointer(triangleResidueLDA, 1);
+  state::Pointer<realNeq> pTresLDA2 = state::GetPointer(triangleResidueLDA, 2);
+
+  state::Pointer<realNeq> pTresTot = state::GetPointer(triangleResidueTotal);
+
+  triangleVmax->SetSize(nTriangle);
+  real *pTvmax = triangleVmax->GetPointer();
+
+  const int3 *pTv = mesh->TriangleVerticesWrappedData();
+
+  const real2 *pTn1 = mesh->TriangleEdgeNormalsData(0);
+  const real2 *pTn2 = mesh->TriangleEdgeNormalsData(1);
+  const real2 *pTn3 = mesh->TriangleEdgeNormalsData(2);
+
+  const real3 *pTl = mesh->TriangleEdgeLengthData();
+
+  // Flag whether negative pressure was encountered
+  int negativePressure = 0;
+
+  if (cudaFlag == 1) {
+    int nBlocks = 128;
+    int nThreads = 128;
+
+    Array<int> *negativePressureFlag = new Array<int>(1, cudaFlag, 1);
+    negativePressureFlag->SetToValue(0);
+    int *pNegativePressure = negativePressureFlag->GetPointer();
+
+    // Base nThreads and nBlocks on maximum occupancy
+    cudaOccupancyMaxPotentialBlockSize(&nBlocks, &nThreads,
+                                       devCalcSpaceResFused<realNeq, CL>,
+                                       (size_t) 0, 0);
+
+#ifdef TIME_ASTRIX
+    gpuErrchk( cudaEventRecord(start, 0) );
+#endif
+    LaunchKernel(nBlocks, nThreads, devCalcSpaceResFused<realNeq, CL>)
+      (nTriangle, pTv, pState,
+       pTn1, pTn2, pTn3, pTl, pResSource,
+       pTresN0, pTresN1, pTresN2,
+       pTresLDA0, pTresLDA1, pTresLDA2,
+       pTresTot, pTvmax, nVertex, G, G - 1.0, G - 2.0, pVp,
+       pNegativePressure);
+#ifdef TIME_ASTRIX
+    gpuErrchk( cudaEventRecord(stop, 0) );
+    gpuErrchk( cudaEventSynchronize(stop) );
+#endif
+
+    gpuErrchk( cudaPeekAtLastError() );
+    gpuErrchk( cudaDeviceSynchronize() );
+
+    negativePressure = negativePressureFlag->Maximum();
+    delete negativePressureFlag;
+  } else {
+#ifdef TIME_ASTRIX
+    gpuErrchk( cudaEventRecord(start, 0) );
+#endif
+    // Triangles are independent: one triangle per vector lane
+    int hostSimdFlag = simulationParameter->hostSimdFlag;
+#pragma omp parallel for simd if(simd: hostSimdFlag == 1) \
+  reduction(|:negativePressure)
+    for (int n = 0; n < nTriangle; n++)
+      negativePressure |=
+        CalcSpaceResFusedSingle<realNeq, CL>(n, pTv, pState,
+                                             pTn1, pTn2, pTn3, pTl,
+                                             pResSource,
+                                             pTresN0, pTresN1, pTresN2,
+                                             pTresLDA0, pTresLDA1, pTresLDA2,
+                                             pTresTot, pTvmax, nVertex,
+                                             G, G - 1.0, G - 2.0, pVp);
+#ifdef TIME_ASTRIX
+    gpuErrchk( cudaEventRecord(stop, 0) );
+    gpuErrchk( cudaEventSynchronize(stop) );
+#endif
+  }
+
+  if (negativePressure == 1)
+    std::cout << "Negative pressure in timestep calculation!" << std::endl;
+
+#ifdef TIME_ASTRIX
+  gpuErrchk( cudaEventElapsedTime(&elapsedTime, start, stop) );
+  AddProfile("CalcResidualFused", nTriangle, elapsedTime, cudaFlag);
+#endif
+}
+
 //##############################################################################
 // Instantiate
 //##############################################################################
@@ -2021,4 +2295,13 @@ template void Simulation<real, CL_BURGERS>::CalcResidual();
 template void Simulation<real3, CL_CART_ISO>::CalcResidual();
 template void Simulation<real4, CL_CART_EULER>::CalcResidual();
 
+template void
+Simulation<real, CL_ADVECT>::CalcResidualFused(Array<real> *triangleVmax);
+template void
+Simulation<real, CL_BURGERS>::CalcResidualFused(Array<real> *triangleVmax);
+template void
+Simulation<real3, CL_CART_ISO>::CalcResidualFused(Array<real> *triangleVmax);
+template void
+Simulation<real4, CL_CART_EULER>::CalcResidualFused(Array<real> *triangleVmax);
+
 }  // namespace astrix
@@ -0,0 +1,1189 @@
+// -*-c++-*-
+/*! \file timelevel.cu
+\brief File containing functions for local time stepping
+
+With local time stepping, every triangle is assigned a time level l, and is updated with time step 2^l dt every 2^l substeps of size dt, where dt is the global minimum time step. After 2^L substeps, with L the maximum time level, all triangles have been advanced by the same amount of time.
+
+Neighbouring triangles at different time levels evaluate the flux through their common edge at different times, so that the update is not conservative by itself. The difference is computed for every edge at a time level interface and added to the vertices of that edge.
+
+Time levels of neighbouring triangles differ by at most one. The correction only depends on the flux through the interface edge and not on how the residue is distributed over the vertices, so that it remains valid when the LDA residue is replaced by the N residue (see ReplaceLDA()): both distribute the same triangle total. Remaining limitation: the correction is added at the end of the substep in which the larger triangle is updated, split equally over the two vertices of the edge. This restores conservation but not time accuracy at level interfaces. Boundary conditions are applied every substep and are as (non-)conservative as without local time stepping.
+
+\section LICENSE
+Copyright (c) 2017 Sijme-Jan Paardekooper
+
+This file is part of Astrix.
+
+Astrix is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+
+Astrix is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Astrix.  If not, see <http://www.gnu.org/licenses/>.*/
+#include <iostream>
+#include <algorithm>
+
+#include "../Common/definitions.h"
+#include "../Array/array.h"
+#include "../Mesh/mesh.h"
+#include "./simulation.h"
+#include "./timelevel.h"
+#include "../Common/atomic.h"
+#include "../Common/cudaLow.h"
+#include "../Common/state.h"
+#include "./Param/simulationparameter.h"
+
+namespace astrix {
+
+//######################################################################
+// Multiply state \a s by \a f
+//######################################################################
+
+__host__ __device__ __forceinline__
+void ScaleState(real& s, real f)
+{
+  s *= f;
+}
+
+__host__ __device__ __forceinline__
+void ScaleState(real3& s, real f)
+{
+  s.x *= f;
+  s.y *= f;
+  s.z *= f;
+}
+
+__host__ __device__ __forceinline__
+void ScaleState(real4& s, real f)
+{
+  s.x *= f;
+  s.y *= f;
+  s.z *= f;
+  s.w *= f;
+}
+
+//######################################################################
+// Add \a f times state \a b to state \a a
+//######################################################################
+
+__host__ __device__ __forceinline__
+void AddScaledState(real& a, real b, real f)
+{
+  a += f*b;
+}
+
+__host__ __device__ __forceinline__
+void AddScaledState(real3& a, real3 b, real f)
+{
+  a.x += f*b.x;
+  a.y += f*b.y;
+  a.z += f*b.z;
+}
+
+__host__ __device__ __forceinline__
+void AddScaledState(real4& a, real4 b, real f)
+{
+  a.x += f*b.x;
+  a.y += f*b.y;
+  a.z += f*b.z;
+  a.w += f*b.w;
+}
+
+//######################################################################
+// Atomically add \a f times state \a b to state \a *a
+//######################################################################
+
+__host__ __device__ __forceinline__
+void AtomicAddScaledState(real *a, real b, real f)
+{
+  AtomicAdd(a, f*b);
+}
+
+__host__ __device__ __forceinline__
+void AtomicAddScaledState(real3 *a, real3 b, real f)
+{
+  AtomicAdd(&(a->x), f*b.x);
+  AtomicAdd(&(a->y), f*b.y);
+  AtomicAdd(&(a->z), f*b.z);
+}
+
+__host__ __device__ __forceinline__
+void AtomicAddScaledState(real4 *a, real4 b, real f)
+{
+  AtomicAdd(&(a->x), f*b.x);
+  AtomicAdd(&(a->y), f*b.y);
+  AtomicAdd(&(a->z), f*b.z);
+  AtomicAdd(&(a->w), f*b.w);
+}
+
+//######################################################################
+/*! \brief Normal flux F.n as a function of parameter vector \a Z
+
+\param Z Parameter vector
+\param nx x component of normal, scaled with edge length
+\param ny y component of normal, scaled with edge length
+\param G1iG (G - 1)/G
+\param pot External potential*/
+//######################################################################
+
+template<ConservationLaw CL>
+__host__ __device__ __forceinline__
+real4 NormalFlux(real4 Z, real nx, real ny, real G1iG, real pot)
+{
+  const real half = (real) 0.5;
+
+  real wn = Z.y*nx + Z.z*ny;
+  real p = G1iG*(Z.x*Z.w - half*(Z.y*Z.y + Z.z*Z.z) - Z.x*Z.x*pot);
+
+  real4 F;
+  F.x = Z.x*wn;
+  F.y = Z.y*wn + p*nx;
+  F.z = Z.z*wn + p*ny;
+  F.w = Z.w*wn;
+
+  return F;
+}
+
+template<ConservationLaw CL>
+__host__ __device__ __forceinline__
+real3 NormalFlux(real3 Z, real nx, real ny, real G1iG, real pot)
+{
+  real wn = Z.y*nx + Z.z*ny;
+  // Sound speed is unity
+  real p = Z.x*Z.x;
+
+  real3 F;
+  F.x = Z.x*wn;
+  F.y = Z.y*wn + p*nx;
+  F.z = Z.z*wn + p*ny;
+
+  return F;
+}
+
+template<ConservationLaw CL>
+__host__ __device__ __forceinline__
+real NormalFlux(real Z, real nx, real ny, real G1iG, real pot)
+{
+  // Advection velocity is (1, 0)
+  if (CL == CL_ADVECT) return Z*nx;
+
+  const real half = (real) 0.5;
+  return half*Z*Z*(nx + ny);
+}
+
+//######################################################################
+/*! \brief Flux through edge with parameter vector \a Za and \a Zb at its end points
+
+Since Z varies linearly along the edge and the flux is quadratic in Z, Simpson's rule gives the exact integral, equal to the contribution of the edge to the total residue of the triangle.
+
+\param Za Parameter vector at first vertex
+\param Zb Parameter vector at second vertex
+\param nx x component of outward normal, scaled with edge length
+\param ny y component of outward normal, scaled with edge length
+\param G1iG (G - 1)/G
+\param pot External potential*/
+//######################################################################
+
+template<ConservationLaw CL, class realNeq>
+__host__ __device__ __forceinline__
+realNeq EdgeFlux(realNeq Za, realNeq Zb, real nx, real ny, real G1iG, real pot)
+{
+  const real half = (real) 0.5;
+  const real one = (real) 1.0;
+  const real four = (real) 4.0;
+  const real onesixth = (real) (1.0/6.0);
+
+  realNeq Zm = Za;
+  ScaleState(Zm, half);
+  AddScaledState(Zm, Zb, half);
+
+  realNeq F = NormalFlux<CL>(Za, nx, ny, G1iG, pot);
+  AddScaledState(F, NormalFlux<CL>(Zb, nx, ny, G1iG, pot), one);
+  AddScaledState(F, NormalFlux<CL>(Zm, nx, ny, G1iG, pot), four);
+  ScaleState(F, onesixth);
+
+  return F;
+}
+
+//######################################################################
+/*! \brief Find time level of triangle \a n
+
+The time level is the largest l <= \a maxLevel for which 2^l \a dt does not exceed the allowed time step at any of the vertices of \a n.
+
+\param n Triangle to consider
+\param *pTv Pointer to triangle vertices
+\param *pVts Pointer to maximum time step at vertices
+\param cfl Courant number
+\param dt Global time step
+\param maxLevel Maximum time level
+\param *pTlev Pointer to triangle time levels (output)*/
+//######################################################################
+
+__host__ __device__
+void CalcTriangleTimeLevelSingle(int n, const int3* __restrict__ pTv,
+                                 const real *pVts, real cfl, real dt,
+                                 int maxLevel, int *pTlev)
+{
+  real dtMax = cfl*min(pVts[pTv[n].x], min(pVts[pTv[n].y], pVts[pTv[n].z]));
+
+  int level = 0;
+  real dtLevel = 2.0*dt;
+  while (level < maxLevel && dtLevel <= dtMax) {
+    level++;
+    dtLevel *= 2.0;
+  }
+
+  pTlev[n] = level;
+}
+
+//######################################################################
+/*! \brief Kernel finding time level of triangles
+
+\param nTriangle Total number of triangles in Mesh
+\param *pTv Pointer to triangle vertices
+\param *pVts Pointer to maximum time step at vertices
+\param cfl Courant number
+\param dt Global time step
+\param maxLevel Maximum time level
+\param *pTlev Pointer to triangle time levels (output)*/
+//######################################################################
+
+__global__ void
+devCalcTriangleTimeLevel(int nTriangle, const int3* __restrict__ pTv,
+                         const real *pVts, real cfl, real dt,
+                         int maxLevel, int *pTlev)
+{
+  int n = blockIdx.x*blockDim.x + threadIdx.x;
+
+  while (n < nTriangle) {
+    CalcTriangleTimeLevelSingle(n, pTv, pVts, cfl, dt, maxLevel, pTlev);
+
+    n += blockDim.x*gridDim.x;
+  }
+}
+
+//######################################################################
+/*! \brief Limit time level of triangle \a n to one above that of its neighbours
+
+One Jacobi sweep: the new level of \a n is at most one larger than the old level of any triangle sharing an edge with \a n. Repeating this maxLevel times ensures that neighbouring triangles differ by at most one time level.
+
+\param n Triangle to consider
+\param *pTe Pointer to triangle edges
+\param *pEt Pointer to edge triangles
+\param *pTlevOld Pointer to triangle time levels before sweep
+\param *pTlev Pointer to triangle time levels (output)*/
+//######################################################################
+
+__host__ __device__
+void LimitTriangleTimeLevelSingle(int n, const int3* __restrict__ pTe,
+                                  const int2* __restrict__ pEt,
+                                  const int *pTlevOld, int *pTlev)
+{
+  int level = pTlevOld[n];
+
+  int e[3] = {pTe[n].x, pTe[n].y, pTe[n].z};
+  for (int j = 0; j < 3; j++) {
+    int t = pEt[e[j]].x;
+    if (t == n) t = pEt[e[j]].y;
+    if (t != -1) level = min(level, pTlevOld[t] + 1);
+  }
+
+  pTlev[n] = level;
+}
+
+//######################################################################
+/*! \brief Kernel limiting time level of triangles to one above that of their neighbours
+
+\param nTriangle Total number of triangles in Mesh
+\param *pTe Pointer to triangle edges
+\param *pEt Pointer to edge triangles
+\param *pTlevOld Pointer to triangle time levels before sweep
+\param *pTlev Pointer to triangle time levels (output)*/
+//######################################################################
+
+__global__ void
+devLimitTriangleTimeLevel(int nTriangle, const int3* __restrict__ pTe,
+                          const int2* __restrict__ pEt,
+                          const int *pTlevOld, int *pTlev)
+{
+  int n = blockIdx.x*blockDim.x + threadIdx.x;
+
+  while (n < nTriangle) {
+    LimitTriangleTimeLevelSingle(n, pTe, pEt, pTlevOld, pTlev);
+
+    n += blockDim.x*gridDim.x;
+  }
+}
+
+//######################################################################
+/*! \brief Set time step of triangle \a n in substep \a subStep
+
+A triangle at time level l is updated in every substep that is a multiple of 2^l, with time step 2^l \a dt. In all other substeps its time step is set to zero.
+
+\param n Triangle to consider
+\param subStep Current substep
+\param dt Global time step
+\param *pTlev Pointer to triangle time levels
+\param *pTdt Pointer to triangle time steps (output)
+\param *pActive Pointer to flag whether triangle is updated (output)*/
+//######################################################################
+
+__host__ __device__
+void SelectActiveTriangleSingle(int n, int subStep, real dt,
+                                const int *pTlev, real *pTdt, int *pActive)
+{
+  int period = 1 << pTlev[n];
+
+  int active = (subStep % period == 0);
+  pTdt[n] = active*period*dt;
+  pActive[n] = active;
+}
+
+//######################################################################
+/*! \brief Kernel setting time step of triangles in substep \a subStep
+
+\param nTriangle Total number of triangles in Mesh
+\param subStep Current substep
+\param dt Global time step
+\param *pTlev Pointer to triangle time levels
+\param *pTdt Pointer to triangle time steps (output)
+\param *pActive Pointer to flag whether triangle is updated (output)*/
+//######################################################################
+
+__global__ void
+devSelectActiveTriangles(int nTriangle, int subStep, real dt,
+                         const int *pTlev, real *pTdt, int *pActive)
+{
+  int n = blockIdx.x*blockDim.x + threadIdx.x;
+
+  while (n < nTriangle) {
+    SelectActiveTriangleSingle(n, subStep, dt, pTlev, pTdt, pActive);
+
+    n += blockDim.x*gridDim.x;
+  }
+}
+
+//######################################################################
+/*! \brief Flag vertices of active triangle \a pTa[i], or boundary vertex \a pBv[i - nActive] if \a i >= \a nActive
+
+\param i Entry to consider
+\param nActive Number of active triangles
+\param *pTa Pointer to list of active triangles
+\param *pTv Pointer to triangle vertices
+\param *pBv Pointer to list of boundary vertices
+\param *pVa Pointer to flag whether vertex is active (output)*/
+//######################################################################
+
+__host__ __device__
+void FlagActiveVertexSingle(int i, int nActive, const int *pTa,
+                            const int3* __restrict__ pTv, const int *pBv,
+                            int *pVa)
+{
+  if (i < nActive) {
+    int n = pTa[i];
+    AtomicExch(&(pVa[pTv[n].x]), 1);
+    AtomicExch(&(pVa[pTv[n].y]), 1);
+    AtomicExch(&(pVa[pTv[n].z]), 1);
+  } else {
+    AtomicExch(&(pVa[pBv[i - nActive]]), 1);
+  }
+}
+
+//######################################################################
+/*! \brief Kernel flagging vertices of active triangles and boundary vertices
+
+\param N Number of active triangles plus number of boundary vertices
+\param nActive Number of active triangles
+\param *pTa Pointer to list of active triangles
+\param *pTv Pointer to triangle vertices
+\param *pBv Pointer to list of boundary vertices
+\param *pVa Pointer to flag whether vertex is active (output)*/
+//######################################################################
+
+__global__ void
+devFlagActiveVertices(int N, int nActive, const int *pTa,
+                      const int3* __restrict__ pTv, const int *pBv, int *pVa)
+{
+  int i = blockIdx.x*blockDim.x + threadIdx.x;
+
+  while (i < N) {
+    FlagActiveVertexSingle(i, nActive, pTa, pTv, pBv, pVa);
+
+    i += blockDim.x*gridDim.x;
+  }
+}
+
+//######################################################################
+/*! \brief Kernel putting all flagged entries in a list
+
+\param N Number of entries
+\param *pFlag Pointer to flags
+\param *pFlagScan Pointer to exclusive scan of \a pFlag
+\param *pList Pointer to output list*/
+//######################################################################
+
+__global__ void
+devFillActiveList(int N, const int *pFlag, const int *pFlagScan, int *pList)
+{
+  int i = blockIdx.x*blockDim.x + threadIdx.x;
+
+  while (i < N) {
+    if (pFlag[i] == 1) pList[pFlagScan[i]] = i;
+
+    i += blockDim.x*gridDim.x;
+  }
+}
+
+//######################################################################
+/*! \brief Calculate scaled state difference at vertex \a v
+
+In the second stage, the mass matrix contribution of the triangles updated in this substep should add up to the full state difference at \a v. Since only these triangles contributed to the first stage, the state difference is divided by the fraction of the area around \a v covered by updated triangles.
+
+\param v Vertex to consider
+\param *pVt Pointer to list of triangles sharing vertices
+\param *pVtOffset Pointer to start of every vertex in \a pVt
+\param *pTl Pointer to triangle edge lengths
+\param *pVarea Pointer to vertex areas
+\param *pTdt Pointer to triangle time steps
+\param *pState Pointer to state at vertices
+\param *pStateOld Pointer to old state at vertices
+\param *pDstate Pointer to state difference at vertices (output)*/
+//######################################################################
+
+template<class realNeq>
+__host__ __device__
+void CalcLocalStateDiffSingle(int v,
+                              const int* __restrict__ pVt,
+                              const int* __restrict__ pVtOffset,
+                              const real3 *pTl, const real *pVarea,
+                              const real *pTdt, const realNeq *pState,
+                              const realNeq *pStateOld, realNeq *pDstate)
+{
+  const real one = (real) 1.0;
+  const real half = (real) 0.5;
+  const real zero = (real) 0.0;
+  const real three = (real) 3.0;
+
+  real areaActive = zero;
+
+  for (int i = pVtOffset[v]; i < pVtOffset[v + 1]; i++) {
+    int n = pVt[i]/3;
+
+    if (pTdt[n] != zero) {
+      real Tl1 = pTl[n].x;
+      real Tl2 = pTl[n].y;
+      real Tl3 = pTl[n].z;
+
+      real s = half*(Tl1 + Tl2 + Tl3);
+      areaActive += sqrt(s*(s - Tl1)*(s - Tl2)*(s - Tl3));
+    }
+  }
+
+  // Vertex area is one third of the area of surrounding triangles
+  real f = zero;
+  if (areaActive > zero) f = three*pVarea[v]/areaActive;
+
+  realNeq dState = pState[v];
+  AddScaledState(dState, pStateOld[v], -one);
+  ScaleState(dState, f);
+
+  pDstate[v] = dState;
+}
+
+//######################################################################
+/*! \brief Kernel calculating scaled state difference at active vertices
+
+\param nVertex Number of active vertices
+\param *pVa Pointer to list of active vertices
+\param *pVt Pointer to list of triangles sharing vertices
+\param *pVtOffset Pointer to start of every vertex in \a pVt
+\param *pTl Pointer to triangle edge lengths
+\param *pVarea Pointer to vertex areas
+\param *pTdt Pointer to triangle time steps
+\param *pState Pointer to state at vertices
+\param *pStateOld Pointer to old state at vertices
+\param *pDstate Pointer to state difference at vertices (output)*/
+//######################################################################
+
+template<class realNeq>
+__global__ void
+devCalcLocalStateDiff(int nVertex, const int *pVa,
+                      const int* __restrict__ pVt,
+                      const int* __restrict__ pVtOffset,
+                      const real3 *pTl, const real *pVarea,
+                      const real *pTdt, const realNeq *pState,
+                      const realNeq *pStateOld, realNeq *pDstate)
+{
+  int i = blockIdx.x*blockDim.x + threadIdx.x;
+
+  while (i < nVertex) {
+    CalcLocalStateDiffSingle(pVa[i], pVt, pVtOffset, pTl, pVarea, pTdt,
+                             pState, pStateOld, pDstate);
+
+    i += blockDim.x*gridDim.x;
+  }
+}
+
+//######################################################################
+/*! \brief Calculate flux through edges of triangle \a n at time level interfaces
+
+For every edge of \a n shared with a triangle at a different time level, the flux out of \a n through the edge, multiplied by the time step of \a n and by \a weight, is stored (\a addFlag = 0) or added (\a addFlag = 1) to \a pTflux. Edges are ordered as in \a pTe: (a, b), (b, c), (c, a).
+
+\param n Triangle to consider
+\param *pTdt Pointer to triangle time steps
+\param *pTlev Pointer to triangle time levels
+\param *pTv Pointer to triangle vertices
+\param *pTe Pointer to triangle edges
+\param *pEt Pointer to edge triangles
+\param *pTn1 Pointer to first edge normal of triangle
+\param *pTn2 Pointer to second edge normal of triangle
+\param *pTn3 Pointer to third edge normal of triangle
+\param *pTl Pointer to triangle edge lengths
+\param *pVz Pointer to parameter vector at vertices
+\param *pVp Pointer to external potential at vertices
+\param G1iG (G - 1)/G
+\param weight Weight of this stage
+\param addFlag Flag whether to add to (1) or overwrite (0) \a pTflux
+\param *pTflux0 Pointer to flux through first edge (output)
+\param *pTflux1 Pointer to flux through second edge (output)
+\param *pTflux2 Pointer to flux through third edge (output)*/
+//######################################################################
+
+template<class realNeq, ConservationLaw CL>
+__host__ __device__
+void CalcInterfaceFluxSingle(int n, const real *pTdt, const int *pTlev,
+                             const int3* __restrict__ pTv,
+                             const int3* __restrict__ pTe,
+                             const int2* __restrict__ pEt,
+                             const real2 *pTn1, const real2 *pTn2,
+                             const real2 *pTn3, const real3 *pTl,
+                             state::ConstPointer<realNeq> pVz,
+                             const real *pVp, real G1iG,
+                             real weight, int addFlag,
+                             realNeq *pTflux0, realNeq *pTflux1,
+                             realNeq *pTflux2)
+{
+  const real half = (real) 0.5;
+
+  int a = pTv[n].x;
+  int b = pTv[n].y;
+  int c = pTv[n].z;
+
+  int lev = pTlev[n];
+  real w = weight*pTdt[n];
+
+  for (int j = 0; j < 3; j++) {
+    // Edge, its vertices and inward normal opposite the third vertex
+    int e = pTe[n].x;
+    int va = a;
+    int vb = b;
+    real2 tn = pTn3[n];
+    real tl = pTl[n].z;
+    realNeq *pTflux = pTflux0;
+    if (j == 1) {
+      e = pTe[n].y;
+      va = b;
+      vb = c;
+      tn = pTn1[n];
+      tl = pTl[n].x;
+      pTflux = pTflux1;
+    }
+    if (j == 2) {
+      e = pTe[n].z;
+      va = c;
+      vb = a;
+      tn = pTn2[n];
+      tl = pTl[n].y;
+      pTflux = pTflux2;
+    }
+
+    // Only consider edges at time level interfaces
+    int t = pEt[e].x;
+    if (t == n) t = pEt[e].y;
+    if (t == -1 || pTlev[t] == lev) continue;
+
+    realNeq F = EdgeFlux<CL, realNeq>(pVz[va], pVz[vb], -tn.x*tl, -tn.y*tl,
+                                      G1iG, half*(pVp[va] + pVp[vb]));
+
+    if (addFlag == 0) {
+      ScaleState(F, w);
+      pTflux[n] = F;
+    } else {
+      AddScaledState(pTflux[n], F, w);
+    }
+  }
+}
+
+//######################################################################
+/*! \brief Kernel calculating flux through edges at time level interfaces
+
+\param nTriangle Number of triangles to consider
+\param *pTa Pointer to list of active triangles
+\param *pTdt Pointer to triangle time steps
+\param *pTlev Pointer to triangle time levels
+\param *pTv Pointer to triangle vertices
+\param *pTe Pointer to triangle edges
+\param *pEt Pointer to edge triangles
+\param *pTn1 Pointer to first edge normal of triangle
+\param *pTn2 Pointer to second edge normal of triangle
+\param *pTn3 Pointer to third edge normal of triangle
+\param *pTl Pointer to triangle edge lengths
+\param *pVz Pointer to parameter vector at vertices
+\param *pVp Pointer to external potential at vertices
+\param G1iG (G - 1)/G
+\param weight Weight of this stage
+\param addFlag Flag whether to add to (1) or overwrite (0) \a pTflux
+\param *pTflux0 Pointer to flux through first edge (output)
+\param *pTflux1 Pointer to flux through second edge (output)
+\param *pTflux2 Pointer to flux through third edge (output)*/
+//######################################################################
+
+template<class realNeq, ConservationLaw CL>
+__global__ void
+devCalcInterfaceFlux(int nTriangle, const int *pTa, const real *pTdt,
+                     const int *pTlev, const int3* __restrict__ pTv,
+                     const int3* __restrict__ pTe,
+                     const int2* __restrict__ pEt,
+                     const real2 *pTn1, const real2 *pTn2,
+                     const real2 *pTn3, const real3 *pTl,
+                     state::ConstPointer<realNeq> pVz,
+                     const real *pVp, real G1iG,
+                     real weight, int addFlag,
+                     realNeq *pTflux0, realNeq *pTflux1, realNeq *pTflux2)
+{
+  int i = blockIdx.x*blockDim.x + threadIdx.x;
+
+  while (i < nTriangle) {
+    CalcInterfaceFluxSingle<realNeq, CL>(pTa[i], pTdt, pTlev, pTv, pTe, pEt,
+                                         pTn1, pTn2, pTn3, pTl, pVz, pVp,
+                                         G1iG, weight, addFlag,
+                                         pTflux0, pTflux1, pTflux2);
+
+    i += blockDim.x*gridDim.x;
+  }
+}
+
+//######################################################################
+/*! \brief Restore conservation at edges of triangle \a n at time level interfaces
+
+Fluxes through edges at time level interfaces of the two triangles sharing the edge should cancel over a full time step. The remainder is added to the vertices of the edge.
+
+\param n Triangle to consider
+\param *pTlev Pointer to triangle time levels
+\param *pTv Pointer to triangle vertices
+\param *pTe Pointer to triangle edges
+\param *pEt Pointer to edge triangles
+\param *pVarea Pointer to vertex areas
+\param *pTflux0 Pointer to flux through first edge
+\param *pTflux1 Pointer to flux through second edge
+\param *pTflux2 Pointer to flux through third edge
+\param *pState Pointer to state at vertices (output)*/
+//######################################################################
+
+template<class realNeq>
+__host__ __device__
+void AddInterfaceFluxSingle(int n, const int *pTlev,
+                            const int3* __restrict__ pTv,
+                            const int3* __restrict__ pTe,
+                            const int2* __restrict__ pEt,
+                            const real *pVarea,
+                            const realNeq *pTflux0, const realNeq *pTflux1,
+                            const realNeq *pTflux2, realNeq *pState)
+{
+  const real half = (real) 0.5;
+
+  int a = pTv[n].x;
+  int b = pTv[n].y;
+  int c = pTv[n].z;
+
+  int lev = pTlev[n];
+
+  for (int j = 0; j < 3; j++) {
+    int e = pTe[n].x;
+    int va = a;
+    int vb = b;
+    const realNeq *pTflux = pTflux0;
+    if (j == 1) {
+      e = pTe[n].y;
+      va = b;
+      vb = c;
+      pTflux = pTflux1;
+    }
+    if (j == 2) {
+      e = pTe[n].z;
+      va = c;
+      vb = a;
+      pTflux = pTflux2;
+    }
+
+    int t = pEt[e].x;
+    if (t == n) t = pEt[e].y;
+    if (t == -1 || pTlev[t] == lev) continue;
+
+    AtomicAddScaledState(&pState[va], pTflux[n], half/pVarea[va]);
+    AtomicAddScaledState(&pState[vb], pTflux[n], half/pVarea[vb]);
+  }
+}
+
+//######################################################################
+/*! \brief Kernel restoring conservation at time level interfaces
+
+\param nTriangle Number of triangles to consider
+\param *pTa Pointer to list of active triangles
+\param *pTlev Pointer to triangle time levels
+\param *pTv Pointer to triangle vertices
+\param *pTe Pointer to triangle edges
+\param *pEt Pointer to edge triangles
+\param *pVarea Pointer to vertex areas
+\param *pTflux0 Pointer to flux through first edge
+\param *pTflux1 Pointer to flux through second edge
+\param *pTflux2 Pointer to flux through third edge
+\param *pState Pointer to state at vertices (output)*/
+//######################################################################
+
+template<class realNeq>
+__global__ void
+devAddInterfaceFlux(int nTriangle, const int *pTa, const int *pTlev,
+                    const int3* __restrict__ pTv,
+                    const int3* __restrict__ pTe,
+                    const int2* __restrict__ pEt,
+                    const real *pVarea,
+                    const realNeq *pTflux0, const realNeq *pTflux1,
+                    const realNeq *pTflux2, realNeq *pState)
+{
+  int i = blockIdx.x*blockDim.x + threadIdx.x;
+
+  while (i < nTriangle) {
+    AddInterfaceFluxSingle(pTa[i], pTlev, pTv, pTe, pEt, pVarea,
+                           pTflux0, pTflux1, pTflux2, pState);
+
+    i += blockDim.x*gridDim.x;
+  }
+}
+
+//#########################################################################
+/*! Assign a time level to every triangle, based on the maximum time step at its vertices as calculated by CalcVertexTimeStep(). Levels are then lowered so that neighbouring triangles differ by at most one level. Levels are limited by \a maxTimeLevel and by the requirement not to step beyond \a maxSimulationTime. Returns the number of substeps of size \a dt needed to advance all triangles by the same amount of time. If this is 1, local time stepping is not necessary.
+
+\param dt Global (minimum) time step*/
+//#########################################################################
+
+template <class realNeq, ConservationLaw CL>
+int Simulation<realNeq, CL>::CalcTriangleTimeLevel(real dt)
+{
+  int maxLevel = simulationParameter->maxTimeLevel;
+  if (maxLevel == 0 || dt <= 0.0) return 1;
+
+  int nTriangle = mesh->GetNTriangle();
+  triangleTimeLevel->SetSize(nTriangle);
+
+  triangleTimeLevelOld->SetSize(nTriangle);
+
+  const int3 *pTv = mesh->TriangleVerticesWrappedData();
+  const int3 *pTe = mesh->TriangleEdgesData();
+  const int2 *pEt = mesh->EdgeTrianglesData();
+  const real *pVts = vertexTimestep->GetPointer();
+  int *pTlev = triangleTimeLevel->GetPointer();
+  real cfl = simulationParameter->CFLnumber;
+
+  int level = maxLevel;
+  for (;;) {
+    if (cudaFlag == 1) {
+      int nBlocks = 128;
+      int nThreads = 128;
+
+      // Base nThreads and nBlocks on maximum occupancy
+      cudaOccupancyMaxPotentialBlockSize(&nBlocks, &nThreads,
+                                         devCalcTriangleTimeLevel,
+                                         (size_t) 0, 0);
+
+      LaunchKernel(nBlocks, nThreads, devCalcTriangleTimeLevel)
+        (nTriangle, pTv, pVts, cfl, dt, level, pTlev);
+
+      gpuErrchk( cudaPeekAtLastError() );
+      gpuErrchk( cudaDeviceSynchronize() );
+    } else {
+#pragma omp parallel for
+      for (int n = 0; n < nTriangle; n++)
+        CalcTriangleTimeLevelSingle(n, pTv, pVts, cfl, dt, level, pTlev);
+    }
+
+    // Neighbouring triangles differ by at most one level
+    for (int sweep = 0; sweep < level; sweep++) {
+      triangleTimeLevelOld->SetEqual(triangleTimeLevel);
+      const int *pTlevOld = triangleTimeLevelOld->GetPointer();
+
+      if (cudaFlag == 1) {
+        int nBlocks = 128;
+        int nThreads = 128;
+
+        // Base nThreads and nBlocks on maximum occupancy
+        cudaOccupancyMaxPotentialBlockSize(&nBlocks, &nThreads,
+                                           devLimitTriangleTimeLevel,
+                                           (size_t) 0, 0);
+
+        LaunchKernel(nBlocks, nThreads, devLimitTriangleTimeLevel)
+          (nTriangle, pTe, pEt, pTlevOld, pTlev);
+
+        gpuErrchk( cudaPeekAtLastError() );
+        gpuErrchk( cudaDeviceSynchronize() );
+      } else {
+#pragma omp parallel for
+        for (int n = 0; n < nTriangle; n++)
+          LimitTriangleTimeLevelSingle(n, pTe, pEt, pTlevOld, pTlev);
+      }
+    }
+
+    // Do not step beyond maxSimulationTime
+    int maxLevelFound = triangleTimeLevel->Maximum();
+    level = maxLevelFound;
+    while (level > 0 &&
+           simulationTime + dt*(real) (1 << level) >
+           simulationParameter->maxSimulationTime)
+      level--;
+
+    // Recalculate with lower maximum level if necessary
+    if (level == maxLevelFound) break;
+  }
+
+  return 1 << level;
+}
+
+//#########################################################################
+/*! Set time step of all triangles for substep \a subStep and make a list of triangles that are updated in this substep. Subsequent residual calculations and updates only consider these triangles. Also make a list of the vertices of these triangles, together with all boundary vertices since boundary conditions may change the state there. Only the state at these vertices is updated, so that the cost of a substep scales with the number of active triangles.
+
+\param subStep Current substep
+\param dt Global (minimum) time step*/
+//#########################################################################
+
+template <class realNeq, ConservationLaw CL>
+void Simulation<realNeq, CL>::SelectActiveTriangles(int subStep, real dt)
+{
+  int nTriangle = mesh->GetNTriangle();
+  int nVertex = mesh->GetNVertex();
+  int nBoundaryVertex = mesh->GetNBoundaryVertex();
+
+  // The number of active triangles and vertices varies between substeps.
+  // Growing in steps larger than the maximum size keeps the physical size of
+  // the lists and flags fixed, so that they are never reallocated.
+  int maxSize = std::max(nTriangle, nVertex) + 1;
+  triangleActive->dynArrayStep = nTriangle + 1;
+  vertexActive->dynArrayStep = nVertex + 1;
+  activeFlag->dynArrayStep = maxSize;
+  activeFlagScan->dynArrayStep = maxSize;
+
+  triangleTimestep->SetSize(nTriangle);
+  activeFlag->SetSize(nTriangle);
+  activeFlagScan->SetSize(nTriangle);
+
+  const int *pTlev = triangleTimeLevel->GetPointer();
+  real *pTdt = triangleTimestep->GetPointer();
+  int *pActive = activeFlag->GetPointer();
+
+  if (cudaFlag == 1) {
+    int nBlocks = 128;
+    int nThreads = 128;
+
+    // Base nThreads and nBlocks on maximum occupancy
+    cudaOccupancyMaxPotentialBlockSize(&nBlocks, &nThreads,
+                                       devSelectActiveTriangles,
+                                       (size_t) 0, 0);
+
+    LaunchKernel(nBlocks, nThreads, devSelectActiveTriangles)
+      (nTriangle, subStep, dt, pTlev, pTdt, pActive);
+
+    gpuErrchk( cudaPeekAtLastError() );
+    gpuErrchk( cudaDeviceSynchronize() );
+  } else {
+#pragma omp parallel for
+    for (int n = 0; n < nTriangle; n++)
+      SelectActiveTriangleSingle(n, subStep, dt, pTlev, pTdt, pActive);
+  }
+
+  // List of triangles to update
+  int nActive = activeFlag->ExclusiveScan(activeFlagScan, nTriangle);
+  triangleActive->SetSize(nActive);
+
+  const int *pActiveScan = activeFlagScan->GetPointer();
+  int *pTa = triangleActive->GetPointer();
+
+  if (cudaFlag == 1) {
+    int nBlocks = 128;
+    int nThreads = 128;
+
+    // Base nThreads and nBlocks on maximum occupancy
+    cudaOccupancyMaxPotentialBlockSize(&nBlocks, &nThreads,
+                                       devFillActiveList,
+                                       (size_t) 0, 0);
+
+    LaunchKernel(nBlocks, nThreads, devFillActiveList)
+      (nTriangle, pActive, pActiveScan, pTa);
+
+    gpuErrchk( cudaPeekAtLastError() );
+    gpuErrchk( cudaDeviceSynchronize() );
+  } else {
+#pragma omp parallel for
+    for (int n = 0; n < nTriangle; n++)
+      if (pActive[n] == 1) pTa[pActiveScan[n]] = n;
+  }
+
+  // Flag vertices of active triangles and boundary vertices
+  activeFlag->SetSize(nVertex);
+  activeFlag->SetToValue(0);
+  activeFlagScan->SetSize(nVertex);
+
+  const int3 *pTv = mesh->TriangleVerticesWrappedData();
+  const int *pBv = mesh->BoundaryVertexData();
+  pActive = activeFlag->GetPointer();
+
+  if (cudaFlag == 1) {
+    int nBlocks = 128;
+    int nThreads = 128;
+
+    // Base nThreads and nBlocks on maximum occupancy
+    cudaOccupancyMaxPotentialBlockSize(&nBlocks, &nThreads,
+                                       devFlagActiveVertices,
+                                       (size_t) 0, 0);
+
+    LaunchKernel(nBlocks, nThreads, devFlagActiveVertices)
+      (nActive + nBoundaryVertex, nActive, pTa, pTv, pBv, pActive);
+
+    gpuErrchk( cudaPeekAtLastError() );
+    gpuErrchk( cudaDeviceSynchronize() );
+  } else {
+#pragma omp parallel for
+    for (int i = 0; i < nActive + nBoundaryVertex; i++)
+      FlagActiveVertexSingle(i, nActive, pTa, pTv, pBv, pActive);
+  }
+
+  // List of vertices to update
+  int nActiveVertex = activeFlag->ExclusiveScan(activeFlagScan, nVertex);
+  vertexActive->SetSize(nActiveVertex);
+
+  pActiveScan = activeFlagScan->GetPointer();
+  int *pVa = vertexActive->GetPointer();
+
+  if (cudaFlag == 1) {
+    int nBlocks = 128;
+    int nThreads = 128;
+
+    // Base nThreads and nBlocks on maximum occupancy
+    cudaOccupancyMaxPotentialBlockSize(&nBlocks, &nThreads,
+                                       devFillActiveList,
+                                       (size_t) 0, 0);
+
+    LaunchKernel(nBlocks, nThreads, devFillActiveList)
+      (nVertex, pActive, pActiveScan, pVa);
+
+    gpuErrchk( cudaPeekAtLastError() );
+    gpuErrchk( cudaDeviceSynchronize() );
+  } else {
+#pragma omp parallel for
+    for (int v = 0; v < nVertex; v++)
+      if (pActive[v] == 1) pVa[pActiveScan[v]] = v;
+  }
+
+  localTimeStepFlag = 1;
+}
+
+//#########################################################################
+/*! Set vertexStateDiff = vertexState - vertexStateOld at all vertices in \a vertexActive, scaled for the second stage of a substep with local time stepping (see CalcLocalStateDiffSingle()). The state difference at other vertices is not used.*/
+//#########################################################################
+
+template <class realNeq, ConservationLaw CL>
+void Simulation<realNeq, CL>::CalcLocalStateDiff()
+{
+  int nVertex = mesh->GetNVertex();
+  vertexStateDiff->SetSize(nVertex);
+
+  int nActiveVertex = vertexActive->GetSize();
+  const int *pVa = vertexActive->GetPointer();
+
+  const int *pVt = mesh->VertexTriangleData();
+  const int *pVtOffset = mesh->VertexTriangleOffsetData();
+  const real3 *pTl = mesh->TriangleEdgeLengthData();
+  const real *pVarea = mesh->VertexAreaData();
+  const real *pTdt = triangleTimestep->GetPointer();
+  const realNeq *pState = vertexState->GetPointer();
+  const realNeq *pStateOld = vertexStateOld->GetPointer();
+  realNeq *pDstate = vertexStateDiff->GetPointer();
+
+  if (cudaFlag == 1) {
+    int nBlocks = 128;
+    int nThreads = 128;
+
+    // Base nThreads and nBlocks on maximum occupancy
+    cudaOccupancyMaxPotentialBlockSize(&nBlocks, &nThreads,
+                                       devCalcLocalStateDiff<realNeq>,
+                                       (size_t) 0, 0);
+
+    LaunchKernel(nBlocks, nThreads, devCalcLocalStateDiff<realNeq>)
+      (nActiveVertex, pVa, pVt, pVtOffset, pTl, pVarea, pTdt,
+       pState, pStateOld, pDstate);
+
+    gpuErrchk( cudaPeekAtLastError() );
+    gpuErrchk( cudaDeviceSynchronize() );
+  } else {
+#pragma omp parallel for
+    for (int i = 0; i < nActiveVertex; i++)
+      CalcLocalStateDiffSingle(pVa[i], pVt, pVtOffset, pTl, pVarea, pTdt,
+                               pState, pStateOld, pDstate);
+  }
+}
+
+//#########################################################################
+/*! For all active triangles, calculate the flux through edges shared with a triangle at a different time level, using the current parameter vector. The effective flux of a substep is the weighted sum of the fluxes of its stages: \a weight = 1 for first order, and \a weight = 1/2 for both stages for second order.
+
+\param dt Global (minimum) time step
+\param weight Weight of current stage
+\param addFlag Flag whether to add to (1) or overwrite (0) the fluxes*/
+//#########################################################################
+
+template <class realNeq, ConservationLaw CL>
+void Simulation<realNeq, CL>::CalcInterfaceFlux(real dt, real weight,
+                                                int addFlag)
+{
+  int nTriangle = mesh->GetNTriangle();
+  triangleInterfaceFlux->SetSize(nTriangle);
+
+  int nActive = triangleActive->GetSize();
+  const int *pTa = triangleActive->GetPointer();
+  const real *pTdt = triangleTimestep->GetPointer();
+  const int *pTlev = triangleTimeLevel->GetPointer();
+
+  const int3 *pTv = mesh->TriangleVerticesWrappedData();
+  const int3 *pTe = mesh->TriangleEdgesData();
+  const int2 *pEt = mesh->EdgeTrianglesData();
+  const real2 *pTn1 = mesh->TriangleEdgeNormalsData(0);
+  const real2 *pTn2 = mesh->TriangleEdgeNormalsData(1);
+  const real2 *pTn3 = mesh->TriangleEdgeNormalsData(2);
+  const real3 *pTl = mesh->TriangleEdgeLengthData();
+
+  state::ConstPointer<realNeq> pVz = state::GetPointer(vertexParameterVector);
+  const real *pVp = vertexPotential->GetPointer();
+
+  realNeq *pTflux0 = triangleInterfaceFlux->GetPointer(0);
+  realNeq *pTflux1 = triangleInterfaceFlux->GetPointer(1);
+  realNeq *pTflux2 = triangleInterfaceFlux->GetPointer(2);
+
+  real G = simulationParameter->specificHeatRatio;
+
+  if (cudaFlag == 1) {
+    int nBlocks = 128;
+    int nThreads = 128;
+
+    // Base nThreads and nBlocks on maximum occupancy
+    cudaOccupancyMaxPotentialBlockSize(&nBlocks, &nThreads,
+                                       devCalcInterfaceFlux<realNeq, CL>,
+                                       (size_t) 0, 0);
+
+    LaunchKernel(nBlocks, nThreads, devCalcInterfaceFlux<realNeq, CL>)
+      (nActive, pTa, pTdt, pTlev, pTv, pTe, pEt, pTn1, pTn2, pTn3, pTl,
+       pVz, pVp, (G - 1.0)/G, weight, addFlag, pTflux0, pTflux1, pTflux2);
+
+    gpuErrchk( cudaPeekAtLastError() );
+    gpuErrchk( cudaDeviceSynchronize() );
+  } else {
+#pragma omp parallel for
+    for (int i = 0; i < nActive; i++)
+      CalcInterfaceFluxSingle<realNeq, CL>(pTa[i], pTdt, pTlev,
+                                           pTv, pTe, pEt,
+                                           pTn1, pTn2, pTn3, pTl, pVz, pVp,
+                                           (G - 1.0)/G, weight, addFlag,
+                                           pTflux0, pTflux1, pTflux2);
+  }
+}
+
+//#########################################################################
+/*! At the end of a substep, add the fluxes calculated by CalcInterfaceFlux() for all active triangles to the vertices of the edges at time level interfaces. Summed over a full time step, this makes the flux through these edges cancel, so that the update is conservative.*/
+//#########################################################################
+
+template <class realNeq, ConservationLaw CL>
+void Simulation<realNeq, CL>::AddInterfaceFlux()
+{
+  int nActive = triangleActive->GetSize();
+  const int *pTa = triangleActive->GetPointer();
+  const int *pTlev = triangleTimeLevel->GetPointer();
+
+  const int3 *pTv = mesh->TriangleVerticesWrappedData();
+  const int3 *pTe = mesh->TriangleEdgesData();
+  const int2 *pEt = mesh->EdgeTrianglesData();
+  const real *pVarea = mesh->VertexAreaData();
+
+  const realNeq *pTflux0 = triangleInterfaceFlux->GetPointer(0);
+  const realNeq *pTflux1 = triangleInterfaceFlux->GetPointer(1);
+  const realNeq *pTflux2 = triangleInterfaceFlux->GetPointer(2);
+
+  realNeq *pState = vertexState->GetPointer();
+
+  if (cudaFlag == 1) {
+    int nBlocks = 128;
+    int nThreads = 128;
+
+    // Base nThreads and nBlocks on maximum occupancy
+    cudaOccupancyMaxPotentialBlockSize(&nBlocks, &nThreads,
+                                       devAddInterfaceFlux<realNeq>,
+                                       (size_t) 0, 0);
+
+    LaunchKernel(nBlocks, nThreads, devAddInterfaceFlux<realNeq>)
+      (nActive, pTa, pTlev, pTv, pTe, pEt, pVarea,
+       pTflux0, pTflux1, pTflux2, pState);
+
+    gpuErrchk( cudaPeekAtLastError() );
+    gpuErrchk( cudaDeviceSynchronize() );
+  } else {
+#pragma omp parallel for
+    for (int i = 0; i < nActive; i++)
+      AddInterfaceFluxSingle(pTa[i], pTlev, pTv, pTe, pEt, pVarea,
+                             pTflux0, pTflux1, pTflux2, pState);
+  }
+}
+
+//##############################################################################
+// Instantiate
+//##############################################################################
+
+template int Simulation<real, CL_ADVECT>::CalcTriangleTimeLevel(real dt);
+template int Simulation<real, CL_BURGERS>::CalcTriangleTimeLevel(real dt);
+template int Simulation<real3, CL_CART_ISO>::CalcTriangleTimeLevel(real dt);
+template int Simulation<real4, CL_CART_EULER>::CalcTriangleTimeLevel(real dt);
+
+//##############################################################################
+
+template void
+Simulation<real, CL_ADVECT>::SelectActiveTriangles(int subStep, real dt);
+template void
+Simulation<real, CL_BURGERS>::SelectActiveTriangles(int subStep, real dt);
+template void
+Simulation<real3, CL_CART_ISO>::SelectActiveTriangles(int subStep, real dt);
+template void
+Simulation<real4, CL_CART_EULER>::SelectActiveTriangles(int subStep, real dt);
+
+//##############################################################################
+
+template void Simulation<real, CL_ADVECT>::CalcLocalStateDiff();
+template void Simulation<real, CL_BURGERS>::CalcLocalStateDiff();
+template void Simulation<real3, CL_CART_ISO>::CalcLocalStateDiff();
+template void Simulation<real4, CL_CART_EULER>::CalcLocalStateDiff();
+
+//##############################################################################
+
+template void
+Simulation<real, CL_ADVECT>::CalcInterfaceFlux(real dt, real weight,
+                                               int addFlag);
+template void
+Simulation<real, CL_BURGERS>::CalcInterfaceFlux(real dt, real weight,
+                                                int addFlag);
+template void
+Simulation<real3, CL_CART_ISO>::CalcInterfaceFlux(real dt, real weight,
+                                                  int addFlag);
+template void
+Simulation<real4, CL_CART_EULER>::CalcInterfaceFlux(real dt, real weight,
+                                                    int addFlag);
+
+//##############################################################################
+
+template void Simulation<real, CL_ADVECT>::AddInterfaceFlux();
+template void Simulation<real, CL_BURGERS>::AddInterfaceFlux();
+template void Simulation<real3, CL_CART_ISO>::AddInterfaceFlux();
+template void Simulation<real4, CL_CART_EULER>::AddInterfaceFlux();
+
+}  // namespace astrix
@@ -0,0 +1,53 @@
+/*! \file timelevel.h
+\brief Triangle selection for local time stepping
+
+\section LICENSE
+Copyright (c) 2017 Sijme-Jan Paardekooper
+
+This file is part of Astrix.
+
+Astrix is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+
+Astrix is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Astrix.  If not, see <http://www.gnu.org/licenses/>.*/
+#ifndef ASTRIX_TIMELEVEL_H
+#define ASTRIX_TIMELEVEL_H
+
+namespace astrix {
+
+//######################################################################
+/*! \brief Triangle handled by iteration \a i of a loop over triangles
+
+With local time stepping, loops over triangles only visit the triangles that are updated in the current substep, listed in \a pTa. Otherwise (\a pTa = 0) all triangles are visited in order.
+
+\param i Loop iteration
+\param *pTa Pointer to list of active triangles, or zero*/
+//######################################################################
+
+__host__ __device__ __forceinline__
+int ActiveTriangle(int i, const int *pTa)
+{
+  if (pTa == 0) return i;
+  return pTa[i];
+}
+
+//######################################################################
+/*! \brief Time step of triangle \a n
+
+\param n Triangle to consider
+\param dt Global time step
+\param *pTdt Pointer to time step of triangles with local time stepping, or zero*/
+//######################################################################
+
+__host__ __device__ __forceinline__
+real TriangleTimestep(int n, real dt, const real *pTdt)
+{
+  if (pTdt == 0) return dt;
+  return pTdt[n];
+}
+
+}  // namespace astrix
+
+#endif  // ASTRIX_TIMELEVEL_H
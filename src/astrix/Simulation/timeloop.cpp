@@ -13,7 +13,7 @@ Astrix is distributed in the hope that it will be useful, but WITHOUT ANY WARRAN
 
 You should have received a copy of the GNU General Public License
 along with Astrix.  If not, see <http://www.gnu.org/licenses/>.*/
-#include <cuda_runtime_api.h>
+#include "../Common/cudaRuntime.h"
 #include <iostream>
 #include <iomanip>
 #include <ctime>
@@ -25,11 +25,33 @@ along with Astrix.  If not, see <http://www.gnu.org/licenses/>.*/
 #include "../Array/array.h"
 #include "../Mesh/mesh.h"
 #include "./simulation.h"
+#include "./problem.h"
 #include "../Common/nvtxEvent.h"
+#include "../Common/profile.h"
 #include "./Param/simulationparameter.h"
 
 namespace astrix {
 
+//#########################################################################
+/*! Return total number of host and device allocations made by all Array's so
+far. The difference between two calls counts the allocations in between.*/
+//#########################################################################
+
+int64_t ArrayAllocationCount()
+{
+  return
+    Array<real>::nAllocationHost + Array<real>::nAllocationDevice +
+    Array<real2>::nAllocationHost + Array<real2>::nAllocationDevice +
+    Array<real3>::nAllocationHost + Array<real3>::nAllocationDevice +
+    Array<real4>::nAllocationHost + Array<real4>::nAllocationDevice +
+    Array<int>::nAllocationHost + Array<int>::nAllocationDevice +
+    Array<int2>::nAllocationHost + Array<int2>::nAllocationDevice +
+    Array<int3>::nAllocationHost + Array<int3>::nAllocationDevice +
+    Array<int4>::nAllocationHost + Array<int4>::nAllocationDevice +
+    Array<unsigned int>::nAllocationHost +
+    Array<unsigned int>::nAllocationDevice;
+}
+
 //#########################################################################
 /*! Run simulation, possibly restarting from saved state, for a maximum
 amount of wall clock hours.
@@ -57,17 +79,24 @@ void Simulation<realNeq, CL>::Run(real maxWallClockHours)
     throw;
   }
 
+  // Time step specialised for problem
+  SelectProblemPipeline();
+
   if (verboseLevel > 0)
     std::cout << "Starting time loop... " << nSave << std::endl;
 
-  //auto start = std::chrono::high_resolution_clock::now();
+  auto start = std::chrono::high_resolution_clock::now();
+  int nTimeStepStart = nTimeStep;
 
   while (warning == 0 &&
          simulationTime < simulationParameter->maxSimulationTime &&
          elapsedTimeHours < maxWallClockHours) {
     try {
       // Do one time step
-      DoTimeStep();
+      if (simulationParameter->implicitFlag == 1)
+        DoImplicitTimeStep();
+      else
+        DoTimeStep();
     }
     catch (...) {
       std::cout << "Error after DoTimeStep()" << std::endl;
@@ -100,15 +129,31 @@ void Simulation<realNeq, CL>::Run(real maxWallClockHours)
     elapsedTimeHours = difftime(time(NULL), startTime)/3600.0;
   }
 
-  /*
   auto finish = std::chrono::high_resolution_clock::now();
   std::chrono::duration<double> elapsed = finish - start;
 
-  std::cout << std::setprecision(6)
-            << "Time/cell/step (mus): "
-            << 1.0e6*elapsed.count()/(real) (nTimeStep*mesh->GetNVertex())
-            << std::endl;
-  */
+  // Wall clock time per vertex per time step, including saves
+  if (nTimeStep > nTimeStepStart)
+    std::cout << std::setprecision(6)
+              << "Time/cell/step (mus): "
+              << 1.0e6*elapsed.count()/
+      ((double) (nTimeStep - nTimeStepStart)*(double) mesh->GetNVertex())
+              << std::endl;
+
+  if (verboseLevel > 0) {
+    ArrayPool::PrintStatistics();
+    mesh->PrintStatistics();
+  }
+
+  if (verboseLevel > 0 && nImplicitStep > 0) {
+    std::cout << std::setprecision(6)
+              << "Implicit: " << nImplicitStep << " steps, "
+              << (double) nNewtonIteration/(double) nImplicitStep
+              << " Newton iterations/step, "
+              << nImplicitReject << " rejected, "
+              << implicitTime << " s" << std::endl;
+    linSys->PrintStatistics();
+  }
 
   try {
     // Save if end of simulation reached
@@ -128,32 +173,133 @@ void Simulation<realNeq, CL>::Run(real maxWallClockHours)
 }
 
 //#########################################################################
-/*! Do a single time step. Update mesh, calculate time step, and update
-  state. */
+/*! Select the problem-specific parts of a time step. Every problem in ASTRIX_PROBLEM_LIST has its own version of the time step, in which boundary conditions and source terms are fixed at compile time by ProblemPolicy.*/
+//#########################################################################
+
+template <class TTT, ConservationLaw CL>
+void Simulation<TTT, CL>::SelectProblemPipeline()
+{
+  ProblemDefinition problemDef = simulationParameter->problemDef;
+
+#define ASTRIX_SELECT_PROBLEM(P)                                        \
+  if (problemDef == P) {                                                \
+    problemPipeline.timeStep = &Simulation::DoProblemTimeStep<P>;       \
+    problemPipeline.stateBoundaries =                                   \
+      &Simulation::SetProblemStateBoundaries<P>;                        \
+    problemPipeline.source = &Simulation::CalcProblemSource<P>;         \
+    problemPipeline.fluxBoundaries =                                    \
+      &Simulation::SetProblemFluxBoundaries<P>;                         \
+    problemPipeline.updateBoundaries =                                  \
+      &Simulation::SetProblemUpdateBoundaries<P>;                       \
+    return;                                                             \
+  }
+
+  ASTRIX_PROBLEM_LIST(ASTRIX_SELECT_PROBLEM)
+
+#undef ASTRIX_SELECT_PROBLEM
+
+  std::cout << "No time step pipeline for problem " << problemDef
+            << std::endl;
+  throw std::runtime_error("");
+}
+
+//#########################################################################
+// Set state at boundaries before calculating residuals
+//#########################################################################
+
+template <class TTT, ConservationLaw CL>
+template <ProblemDefinition P>
+void Simulation<TTT, CL>::SetProblemStateBoundaries()
+{
+  // Boundary conditions for 2D Riemann
+  if (ProblemPolicy<P, CL>::riemannBoundaries)
+    SetRiemannBoundaries();
+
+  // Boundary conditions for 2D Noh
+  if (ProblemPolicy<P, CL>::nohBoundaries)
+    SetNohBoundaries();
+}
+
+//#########################################################################
+// Add source term for current state
+//#########################################################################
+
+template <class TTT, ConservationLaw CL>
+template <ProblemDefinition P>
+void Simulation<TTT, CL>::CalcProblemSource()
+{
+  if (ProblemPolicy<P, CL>::source)
+    CalcSource(vertexState);
+}
+
+//#########################################################################
+/*! Add flux through boundaries after an update with time step \a dt
+
+\param dt Time step of update*/
+//#########################################################################
+
+template <class TTT, ConservationLaw CL>
+template <ProblemDefinition P>
+void Simulation<TTT, CL>::SetProblemFluxBoundaries(real dt)
+{
+  // Reflecting boundaries
+  if (ProblemPolicy<P, CL>::reflectingBoundaries)
+    ReflectingBoundaries(dt);
+}
+
+//#########################################################################
+// Constrain state at boundaries after update
+//#########################################################################
+
+template <class TTT, ConservationLaw CL>
+template <ProblemDefinition P>
+void Simulation<TTT, CL>::SetProblemUpdateBoundaries()
+{
+  if (ProblemPolicy<P, CL>::symmetricBoundaries)
+    SetSymmetricBoundaries();
+
+  // Nonreflecting boundaries
+  if (ProblemPolicy<P, CL>::nonReflectingBoundaries)
+    SetNonReflectingBoundaries();
+}
+
+//#########################################################################
+/*! Do a single time step using the pipeline selected by SelectProblemPipeline(). */
 //#########################################################################
 
 template <class TTT, ConservationLaw CL>
 void Simulation<TTT, CL>::DoTimeStep()
+{
+  (this->*problemPipeline.timeStep)();
+}
+
+//#########################################################################
+/*! Do a single time step for problem \a P. Update mesh (every \a nStepAdapt time steps if adaptive), calculate time step, and update state. */
+//#########################################################################
+
+template <class TTT, ConservationLaw CL>
+template <ProblemDefinition P>
+void Simulation<TTT, CL>::DoProblemTimeStep()
 {
   //auto start = std::chrono::high_resolution_clock::now();
   //std::cout << "Mass: " << TotalMass() - 4.0 << " ";
 
-  ProblemDefinition problemDef = simulationParameter->problemDef;
-
   // Number of time steps taken
   nTimeStep++;
 
+  // Array allocations before this step
+  int64_t nAllocationStart = ArrayAllocationCount();
+
   if (verboseLevel > 0)
     std::cout << std::setprecision(12)
               << "Starting time step " << nTimeStep << ", ";
 
-  // Refine / coarsen mesh
-  /*
-  if (mesh->adaptiveMeshFlag == 1) {
-
+  // Refine / coarsen mesh every nStepAdapt time steps, if requested
+  int nStepAdapt = mesh->GetAdaptInterval();
+  if (mesh->IsAdaptive() == 1 && nStepAdapt > 0 &&
+      nTimeStep % nStepAdapt == 0) {
     ReplaceEnergyWithPressure();
     Coarsen(-1);
-    std::cout << "Mass: " << TotalMass() << " ";
     try {
       Refine();
     }
@@ -164,146 +310,176 @@ void Simulation<TTT, CL>::DoTimeStep()
 
     ReplacePressureWithEnergy();
   }
-  */
 
   nvtxEvent *nvtxHydro = new nvtxEvent("Hydro", 2);
 
-  // Calculate time step
-  real dt = CalcVertexTimeStep();
+  // Single pass over triangles for time step and residual, only possible if
+  // the state is not changed in between by boundary conditions, and if all
+  // triangles take the same time step
+  int fusedFlag = simulationParameter->fusedResidualFlag;
+  if (ProblemPolicy<P, CL>::riemannBoundaries ||
+      ProblemPolicy<P, CL>::nohBoundaries ||
+      simulationParameter->maxTimeLevel > 0)
+    fusedFlag = 0;
+
+  real dt = 0.0;
+  // Number of substeps of size dt with local time stepping
+  int nSubStep = 1;
+  real startTime = simulationTime;
+
+  if (fusedFlag == 1) {
+    // Set Wold = W
+    vertexStateOld->SetEqual(vertexState);
 
-  /*
-  if (problemDef == PROBLEM_VORTEX ||
-      problemDef == PROBLEM_SOD)
-    ExtrapolateBoundaries();
-  */
+    // Calculate source term
+    CalcProblemSource<P>();
 
-  // Boundary conditions for 2D Riemann
-  if (problemDef == PROBLEM_RIEMANN)
-    SetRiemannBoundaries();
+    // Calculate (space) residuals and signal speeds at triangles
+    CalcResidualFused(triangleSignalSpeed);
 
-  // Boundary conditions for 2D Noh
-  if (problemDef == PROBLEM_NOH)
-    SetNohBoundaries();
+    // Calculate time step
+    dt = CalcVertexTimeStep(triangleSignalSpeed);
+  } else {
+    // Calculate time step
+    dt = CalcVertexTimeStep();
 
-  // Set Wold = W
-  vertexStateOld->SetEqual(vertexState);
+    // Time levels of triangles for local time stepping
+    nSubStep = CalcTriangleTimeLevel(dt);
+  }
 
-  // Calculate source term
-  if (problemDef == PROBLEM_SOURCE)
-    CalcSource(vertexState);
+  for (int subStep = 0; subStep < nSubStep; subStep++) {
+    // Only update triangles at the right time level
+    if (nSubStep > 1)
+      SelectActiveTriangles(subStep, dt);
 
-  // Calculate parameter vector Z at nodes
-  CalculateParameterVector(0);
+    if (fusedFlag == 0) {
+      /*
+      if (problemDef == PROBLEM_VORTEX ||
+          problemDef == PROBLEM_SOD)
+        ExtrapolateBoundaries();
+      */
 
-  // Calculate (space) residuals at triangles
-  CalcResidual();
+      // Problem-specific boundary conditions
+      SetProblemStateBoundaries<P>();
 
-  // Update state at vertices
-  try {
-    UpdateState(dt, 0);
-  }
-  catch (...) {
-    std::cout << "Updating state RK1 failed!" << std::endl;
-    throw;
-  }
+      // Set Wold = W, only where W can change with local time stepping
+      if (localTimeStepFlag == 1)
+        StoreState(vertexActive);
+      else
+        vertexStateOld->SetEqual(vertexState);
 
+      // Calculate source term
+      CalcProblemSource<P>();
 
-  // Reflecting boundaries
-  if (problemDef == PROBLEM_CYL ||
-      problemDef == PROBLEM_SOD ||
-      problemDef == PROBLEM_BLAST)
-    ReflectingBoundaries(dt);
+      // Calculate parameter vector Z at nodes
+      CalculateParameterVector(0);
 
-  if ((problemDef == PROBLEM_SOURCE && CL != CL_ADVECT) ||
-      problemDef == PROBLEM_RIEMANN)
-    SetSymmetricBoundaries();
+      // Calculate (space) residuals at triangles
+      CalcResidual();
+    }
 
-  // Nonreflecting boundaries
-  if (problemDef == PROBLEM_VORTEX ||
-      (problemDef == PROBLEM_SOURCE && CL == CL_ADVECT))
-    SetNonReflectingBoundaries();
+    // Flux through edges at time level interfaces
+    if (localTimeStepFlag == 1)
+      CalcInterfaceFlux(dt, simulationParameter->integrationOrder == 2 ?
+                        (real) 0.5 : (real) 1.0, 0);
+
+    // Update state at vertices
+    try {
+      UpdateState(dt, 0);
+    }
+    catch (...) {
+      std::cout << "Updating state RK1 failed!" << std::endl;
+      throw;
+    }
 
-  if (simulationParameter->integrationOrder == 2) {
-    /*
-    if (problemDef == PROBLEM_VORTEX ||
-        problemDef == PROBLEM_SOD)
-      ExtrapolateBoundaries();
-    */
+    // Problem-specific boundary conditions
+    SetProblemFluxBoundaries<P>(dt);
+    SetProblemUpdateBoundaries<P>();
 
-    // Boundary conditions for 2D Riemann
-    if (problemDef == PROBLEM_RIEMANN)
-      SetRiemannBoundaries();
+    if (simulationParameter->integrationOrder == 2) {
+      /*
+      if (problemDef == PROBLEM_VORTEX ||
+          problemDef == PROBLEM_SOD)
+        ExtrapolateBoundaries();
+      */
 
-    // Boundary conditions for 2D Noh
-    if (problemDef == PROBLEM_NOH)
-      SetNohBoundaries();
+      // Problem-specific boundary conditions
+      SetProblemStateBoundaries<P>();
 
-    // Calculate source term
-    if (problemDef == PROBLEM_SOURCE)
-      CalcSource(vertexState);
+      // Calculate source term
+      CalcProblemSource<P>();
 
-    // Calculate parameter vector Z at nodes
-    CalculateParameterVector(0);
+      // Calculate parameter vector Z at nodes
+      CalculateParameterVector(0);
 
-    // dW = W - Wold
-    vertexStateDiff->SetToDiff(vertexState, vertexStateOld);
+      // dW = W - Wold
+      if (localTimeStepFlag == 1) {
+        CalcLocalStateDiff();
+        CalcInterfaceFlux(dt, (real) 0.5, 1);
+      } else {
+        vertexStateDiff->SetToDiff(vertexState, vertexStateOld);
+      }
 
-    // Calculate space-time residual N + total
-    CalcTotalResNtot(dt);
+      // Calculate space-time residual N + total
+      CalcTotalResNtot(dt);
 
-    // Calculate parameter vector Z at nodes from old state
-    CalculateParameterVector(1);
+      // Calculate parameter vector Z at nodes from old state
+      CalculateParameterVector(1);
 
-    int massMatrix = simulationParameter->massMatrix;
-    int selectiveLumpFlag = simulationParameter->selectiveLumpFlag;
+      int massMatrix = simulationParameter->massMatrix;
+      int selectiveLumpFlag = simulationParameter->selectiveLumpFlag;
 
-    if (massMatrix == 3 || massMatrix == 4)
-      MassMatrixF34Tot(dt, massMatrix);
+      if (massMatrix == 3 || massMatrix == 4)
+        MassMatrixF34Tot(dt, massMatrix);
 
-    // Calculate space-time residual LDA
-    CalcTotalResLDA();
+      // Calculate space-time residual LDA
+      CalcTotalResLDA();
 
-    if (massMatrix == 3 || massMatrix == 4)
-      MassMatrixF34(dt, massMatrix);
+      if (massMatrix == 3 || massMatrix == 4)
+        MassMatrixF34(dt, massMatrix);
 
-    if (selectiveLumpFlag == 1 || massMatrix == 2)
-      SelectLump(dt, massMatrix, selectiveLumpFlag);
+      if (selectiveLumpFlag == 1 || massMatrix == 2)
+        SelectLump(dt, massMatrix, selectiveLumpFlag);
 
-    // Set Wold = W
-    vertexStateOld->SetEqual(vertexState);
+      // Set Wold = W
+      if (localTimeStepFlag == 1)
+        StoreState(vertexActive);
+      else
+        vertexStateOld->SetEqual(vertexState);
 
-    // Update state at vertices
-    try {
-      UpdateState(dt, 1);
-    }
-    catch (...) {
-      std::cout << "Updating state RK2 failed!" << std::endl;
-      throw;
-    }
+      // Update state at vertices
+      try {
+        UpdateState(dt, 1);
+      }
+      catch (...) {
+        std::cout << "Updating state RK2 failed!" << std::endl;
+        throw;
+      }
 
-    // Reflecting boundaries
-    if (problemDef == PROBLEM_CYL ||
-        problemDef == PROBLEM_SOD ||
-        problemDef == PROBLEM_BLAST)
-      ReflectingBoundaries(dt);
+      // Problem-specific boundary conditions
+      SetProblemFluxBoundaries<P>(dt);
+      SetProblemUpdateBoundaries<P>();
+    }
 
-    if ((problemDef == PROBLEM_SOURCE && CL != CL_ADVECT) ||
-        problemDef == PROBLEM_RIEMANN)
-      SetSymmetricBoundaries();
+    // Restore conservation at time level interfaces
+    if (localTimeStepFlag == 1)
+      AddInterfaceFlux();
 
-    // Nonreflecting boundaries
-    if (problemDef == PROBLEM_VORTEX ||
-        (problemDef == PROBLEM_SOURCE && CL == CL_ADVECT))
-      SetNonReflectingBoundaries();
+    // Increase time
+    simulationTime += dt;
   }
 
+  localTimeStepFlag = 0;
+
   //auto finish = std::chrono::high_resolution_clock::now();
   //std::chrono::duration<double> elapsed = finish - start;
 
   if (verboseLevel > 0) {
     std::cout << std::setprecision(6)
-              << "t = " << simulationTime << " dt = " << dt << " ";
+              << "t = " << startTime << " dt = " << dt << " ";
       //<< elapsed.count() << " ";
+    if (nSubStep > 1)
+      std::cout << "(" << nSubStep << " substeps) ";
     if (cudaFlag == 0) {
       std::cout << ((real)(Array<real>::memAllocatedHost) +
                     (real)(Array<real2>::memAllocatedHost) +
@@ -314,8 +490,9 @@ void Simulation<TTT, CL>::DoTimeStep()
                     (real)(Array<int3>::memAllocatedHost) +
                     (real)(Array<int4>::memAllocatedHost) +
                     (real)(Array<unsigned int>::memAllocatedHost))/
-        (real) (1073741824) << " Gb"
-                << std::endl;
+        (real) (1073741824) << " Gb, "
+                << ArrayAllocationCount() - nAllocationStart
+                << " allocations" << std::endl;
     } else {
       std::cout << ((real)(Array<real>::memAllocatedDevice) +
                     (real)(Array<real2>::memAllocatedDevice) +
@@ -326,13 +503,14 @@ void Simulation<TTT, CL>::DoTimeStep()
                     (real)(Array<int3>::memAllocatedDevice) +
                     (real)(Array<int4>::memAllocatedDevice) +
                     (real)(Array<unsigned int>::memAllocatedDevice))/
-        (real) (1073741824)<< " Gb"
-                << std::endl;
+        (real) (1073741824)<< " Gb, "
+                << ArrayAllocationCount() - nAllocationStart
+                << " allocations" << std::endl;
     }
   }
 
-  // Increase time
-  simulationTime += dt;
+  // Kernel timings, if compiled with TIME_ASTRIX
+  WriteProfileInterval(nTimeStep);
 
   delete nvtxHydro;
 }
@@ -18,6 +18,7 @@ along with Astrix.  If not, see <http://www.gnu.org/licenses/>.*/
 #include "../Array/array.h"
 #include "../Mesh/mesh.h"
 #include "./simulation.h"
+#include "./signalspeed.h"
 #include "../Common/atomic.h"
 #include "../Common/cudaLow.h"
 #include "../Common/profile.h"
@@ -26,196 +27,78 @@ along with Astrix.  If not, see <http://www.gnu.org/licenses/>.*/
 namespace astrix {
 
 //######################################################################
-/*! \brief Find maximum signal speed for triangle t
+/*! \brief Find maximum signal speed for triangle t and add it atomically to all of its vertices
 
 \param t Triangle to consider
-\param a First vertex of triangle
-\param b Second vertex of triangle
-\param c Third vertex of triangle
+\param *pTv Pointer to vertices of triangle
 \param *pState Pointer to vertex state vector
 \param *pTl Pointer to triangle edge lengths
+\param *pVts Pointer to maximum time step at vertex (output)
+\param nVertex Total number of vertices in Mesh
 \param G Ratio of specific heats
 \param G1 G - 1
 \param *pVp Pointer to external potential at vertices*/
 //######################################################################
 
-template<ConservationLaw CL>
+template<class realNeq, ConservationLaw CL>
 __host__ __device__
-real FindMaxSignalSpeed(int t, int a, int b, int c,
-                        real4 *pState, const real3* __restrict__ pTl,
-                        real G, real G1, real *pVp)
+void CalcVmaxSingle(int t, const int3* __restrict__ pTv, realNeq *pState,
+                    const real3* __restrict__ pTl, real *pVts,
+                    int nVertex, real G, real G1, real *pVp)
 {
-  real zero = (real) 0.0;
-  real half = (real) 0.5;
-  real one = (real) 1.0;
-
-  real vmax = zero;
-
-  // First vertex
-  real dens = pState[a].x;
-  real momx = pState[a].y;
-  real momy = pState[a].z;
-  real ener = pState[a].w;
-
-  real id = one/dens;
-  real u = momx;
-  real v = momy;
-  real absv = sqrt(u*u+v*v)*id;
-
-  // Pressure
-  real p = G1*(ener - half*id*(u*u + v*v) - dens*pVp[a]);
-#ifndef __CUDA_ARCH__
-  if (p < zero)
-    std::cout << "Negative pressure in timestep calculation!" << std::endl;
-#endif
-
-  // Sound speed
-  real cs = sqrt(G*p*id);
-
-  // Maximum signal speed
-  vmax = absv + cs;
-
-  // Second vertex
-  dens = pState[b].x;
-  momx = pState[b].y;
-  momy = pState[b].z;
-  ener = pState[b].w;
-
-  id = one/dens;
-  u = momx;
-  v = momy;
-  absv = sqrt(u*u+v*v)*id;
-
-  p = G1*(ener - half*id*(u*u + v*v) - dens*pVp[b]);
-#ifndef __CUDA_ARCH__
-  if (p < zero)
-    std::cout << "Negative pressure in timestep calculation!" << std::endl;
-#endif
-  cs = sqrt(G*p*id);
-
-  vmax = max(vmax, absv + cs);
-
-  // Third vertex
-  dens = pState[c].x;
-  momx = pState[c].y;
-  momy = pState[c].z;
-  ener = pState[c].w;
-
-  id = one/dens;
-  u = momx;
-  v = momy;
-  absv = sqrt(u*u+v*v)*id;
-
-  p = G1*(ener - half*id*(u*u + v*v) - dens*pVp[c]);
-#ifndef __CUDA_ARCH__
-  if (p < zero)
-    std::cout << "Negative pressure in timestep calculation!" << std::endl;
-#endif
-  cs = sqrt(G*p*id);
-
-  vmax = max(vmax, absv + cs);
-
-  // Triangle edge lengths
-  real tl1 = pTl[t].x;
-  real tl2 = pTl[t].y;
-  real tl3 = pTl[t].z;
+  int a = pTv[t].x;
+  int b = pTv[t].y;
+  int c = pTv[t].z;
 
-  // Scale with maximum edge length
-  vmax = vmax*max(tl1, max(tl2, tl3));
+  real vMax = FindMaxSignalSpeed<CL>(t, a, b, c, pState, pTl, G, G1, pVp);
 
-  return vmax;
+  ScatterAdd(&pVts[a], vMax);
+  ScatterAdd(&pVts[b], vMax);
+  ScatterAdd(&pVts[c], vMax);
 }
 
-template<ConservationLaw CL>
-__host__ __device__
-real FindMaxSignalSpeed(int t, int a, int b, int c,
-                        real3 *pState, const real3* __restrict__ pTl,
-                        real G, real G1, real *pVp)
-{
-  real zero = (real) 0.0;
-  real one = (real) 1.0;
-
-  real vmax = zero;
-
-  // First vertex
-  real dens = pState[a].x;
-  real momx = pState[a].y;
-  real momy = pState[a].z;
-
-  real id = one/dens;
-  real u = momx;
-  real v = momy;
-  real absv = sqrt(u*u+v*v)*id;
-
-  // Sound speed
-  real cs = 1.0;
-
-  // Maximum signal speed
-  vmax = absv + cs;
-
-  // Second vertex
-  dens = pState[b].x;
-  momx = pState[b].y;
-  momy = pState[b].z;
-
-  id = one/dens;
-  u = momx;
-  v = momy;
-  absv = sqrt(u*u+v*v)*id;
-
-  vmax = max(vmax, absv + cs);
-
-  // Third vertex
-  dens = pState[c].x;
-  momx = pState[c].y;
-  momy = pState[c].z;
-
-  id = one/dens;
-  u = momx;
-  v = momy;
-  absv = sqrt(u*u+v*v)*id;
-
-  vmax = max(vmax, absv + cs);
+//######################################################################
+/*! \brief Kernel finding maximum signal speed for triangles and add it atomically to all of the vertices
 
-  // Triangle edge lengths
-  real tl1 = pTl[t].x;
-  real tl2 = pTl[t].y;
-  real tl3 = pTl[t].z;
+\param nTriangle Total number of triangles in Mesh
+\param *tv1 Pointer to first vertex of triangle
+\param *tv2 Pointer to second vertex of triangle
+\param *tv3 Pointer to third vertex of triangle
+\param *dens Pointer to density
+\param *momx Pointer to x momentum
+\param *momy Pointer to y momentum
+\param *ener Pointer to energy
+\param *pTriangleEdgeLengths Pointer to triangle edge lengths
+\param *pVts Pointer to maximum time step at vertex (output)
+\param nVertex Total number of vertices in Mesh
+\param G Ratio of specific heats
+\param *pVp Pointer to external potential at vertices*/
+//######################################################################
 
-  // Scale with maximum edge length
-  vmax = vmax*max(tl1, max(tl2, tl3));
+template<class realNeq, ConservationLaw CL>
+__global__ void
+devCalcVmax(int nTriangle, const int3* __restrict__ pTv, realNeq *pState,
+            const real3* __restrict__ pTl, real *pVts,
+            int nVertex, real G, real G1, real *pVp)
+{
+  // n = triangle number
+  int n = blockIdx.x*blockDim.x + threadIdx.x;
 
-  return vmax;
-}
+  while (n < nTriangle) {
+    CalcVmaxSingle<realNeq, CL>(n, pTv, pState, pTl, pVts, nVertex, G, G1, pVp);
 
-template<ConservationLaw CL>
-__host__ __device__
-real FindMaxSignalSpeed(int t, int a, int b, int c,
-                        real *pState, const real3* __restrict__ pTl,
-                        real G, real G1, real *pVp)
-{
-  // Triangle edge lengths
-  real tl1 = pTl[t].x;
-  real tl2 = pTl[t].y;
-  real tl3 = pTl[t].z;
-
-  if (CL == CL_BURGERS) {
-    real vmax = max(fabs(pState[a]), max(fabs(pState[b]), fabs(pState[c])));
-    return vmax*max(tl1, max(tl2, tl3));
-  } else {
-    // Scalar advection with velocity unity
-    return 1.0*max(tl1, max(tl2, tl3));
+    n += blockDim.x*gridDim.x;
   }
 }
 
 //######################################################################
-/*! \brief Find maximum signal speed for triangle t and add it atomically to all of its vertices
+/*! \brief Find maximum signal speed for triangle t
 
 \param t Triangle to consider
 \param *pTv Pointer to vertices of triangle
 \param *pState Pointer to vertex state vector
 \param *pTl Pointer to triangle edge lengths
-\param *pVts Pointer to maximum time step at vertex (output)
+\param *pTvmax Pointer to maximum signal speed of triangles (output)
 \param nVertex Total number of vertices in Mesh
 \param G Ratio of specific heats
 \param G1 G - 1
@@ -224,56 +107,90 @@ real FindMaxSignalSpeed(int t, int a, int b, int c,
 
 template<class realNeq, ConservationLaw CL>
 __host__ __device__
-void CalcVmaxSingle(int t, const int3* __restrict__ pTv, realNeq *pState,
-                    const real3* __restrict__ pTl, real *pVts,
-                    int nVertex, real G, real G1, real *pVp)
+void CalcVmaxTriangleSingle(int t, const int3* __restrict__ pTv,
+                            realNeq *pState,
+                            const real3* __restrict__ pTl, real *pTvmax,
+                            int nVertex, real G, real G1, real *pVp)
 {
   int a = pTv[t].x;
   int b = pTv[t].y;
   int c = pTv[t].z;
-  while (a >= nVertex) a -= nVertex;
-  while (b >= nVertex) b -= nVertex;
-  while (c >= nVertex) c -= nVertex;
-  while (a < 0) a += nVertex;
-  while (b < 0) b += nVertex;
-  while (c < 0) c += nVertex;
-
-  real vMax = FindMaxSignalSpeed<CL>(t, a, b, c, pState, pTl, G, G1, pVp);
 
-  AtomicAdd(&pVts[a], vMax);
-  AtomicAdd(&pVts[b], vMax);
-  AtomicAdd(&pVts[c], vMax);
+  pTvmax[t] = FindMaxSignalSpeed<CL>(t, a, b, c, pState, pTl, G, G1, pVp);
 }
 
 //######################################################################
-/*! \brief Kernel finding maximum signal speed for triangles and add it atomically to all of the vertices
+/*! \brief Kernel finding maximum signal speed for triangles
 
 \param nTriangle Total number of triangles in Mesh
-\param *tv1 Pointer to first vertex of triangle
-\param *tv2 Pointer to second vertex of triangle
-\param *tv3 Pointer to third vertex of triangle
-\param *dens Pointer to density
-\param *momx Pointer to x momentum
-\param *momy Pointer to y momentum
-\param *ener Pointer to energy
-\param *pTriangleEdgeLengths Pointer to triangle edge lengths
-\param *pVts Pointer to maximum time step at vertex (output)
+\param *pTv Pointer to vertices of triangle
+\param *pState Pointer to vertex state vector
+\param *pTl Pointer to triangle edge lengths
+\param *pTvmax Pointer to maximum signal speed of triangles (output)
 \param nVertex Total number of vertices in Mesh
 \param G Ratio of specific heats
+\param G1 G - 1
 \param *pVp Pointer to external potential at vertices*/
 //######################################################################
 
 template<class realNeq, ConservationLaw CL>
 __global__ void
-devCalcVmax(int nTriangle, const int3* __restrict__ pTv, realNeq *pState,
-            const real3* __restrict__ pTl, real *pVts,
-            int nVertex, real G, real G1, real *pVp)
+devCalcVmaxTriangle(int nTriangle, const int3* __restrict__ pTv,
+                    realNeq *pState, const real3* __restrict__ pTl,
+                    real *pTvmax, int nVertex, real G, real G1, real *pVp)
 {
   // n = triangle number
   int n = blockIdx.x*blockDim.x + threadIdx.x;
 
   while (n < nTriangle) {
-    CalcVmaxSingle<realNeq, CL>(n, pTv, pState, pTl, pVts, nVertex, G, G1, pVp);
+    CalcVmaxTriangleSingle<realNeq, CL>(n, pTv, pState, pTl, pTvmax,
+                                        nVertex, G, G1, pVp);
+
+    n += blockDim.x*gridDim.x;
+  }
+}
+
+//######################################################################
+/*! \brief Sum maximum signal speeds of all triangles sharing vertex \a v
+
+\param v Vertex to consider
+\param *pVt Pointer to list of triangles sharing vertices
+\param *pVtOffset Pointer to start of every vertex in \a pVt
+\param *pTvmax Pointer to maximum signal speed of triangles
+\param *pVts Pointer to sum of maximum signal speeds at vertex (output)*/
+//######################################################################
+
+__host__ __device__
+void GatherVmaxSingle(int v, const int* __restrict__ pVt,
+                      const int* __restrict__ pVtOffset,
+                      const real *pTvmax, real *pVts)
+{
+  real vSum = pVts[v];
+  for (int i = pVtOffset[v]; i < pVtOffset[v + 1]; i++)
+    vSum += pTvmax[pVt[i]/3];
+  pVts[v] = vSum;
+}
+
+//######################################################################
+/*! \brief Kernel summing maximum signal speeds of triangles at vertices
+
+\param nVertex Total number of vertices in Mesh
+\param *pVt Pointer to list of triangles sharing vertices
+\param *pVtOffset Pointer to start of every vertex in \a pVt
+\param *pTvmax Pointer to maximum signal speed of triangles
+\param *pVts Pointer to sum of maximum signal speeds at vertex (output)*/
+//######################################################################
+
+__global__ void
+devGatherVmax(int nVertex, const int* __restrict__ pVt,
+              const int* __restrict__ pVtOffset,
+              const real *pTvmax, real *pVts)
+{
+  // n = vertex number
+  int n = blockIdx.x*blockDim.x + threadIdx.x;
+
+  while (n < nVertex) {
+    GatherVmaxSingle(n, pVt, pVtOffset, pTvmax, pVts);
 
     n += blockDim.x*gridDim.x;
   }
@@ -321,6 +238,20 @@ devCalcVertexTimeStep(int nVertex, real *pVts, const real *pVarea)
 
 template <class realNeq, ConservationLaw CL>
 real Simulation<realNeq, CL>::CalcVertexTimeStep()
+{
+  return CalcVertexTimeStep(0);
+}
+
+//######################################################################
+/*! Calculate maximum possible time step. If \a triangleVmax is not zero, it
+should contain the maximum signal speed of all triangles, as computed by
+CalcResidualFused(), and these are gathered at the vertices directly.
+
+\param *triangleVmax Maximum signal speed of triangles; if zero, signal speeds are computed from the current state.*/
+//######################################################################
+
+template <class realNeq, ConservationLaw CL>
+real Simulation<realNeq, CL>::CalcVertexTimeStep(Array<real> *triangleVmax)
 {
 #ifdef TIME_ASTRIX
   cudaEvent_t start, stop;
@@ -336,16 +267,83 @@ real Simulation<realNeq, CL>::CalcVertexTimeStep()
   real *pVp = vertexPotential->GetPointer();
   real G = simulationParameter->specificHeatRatio;
 
-  const int3 *pTv = mesh->TriangleVerticesData();
+  const int3 *pTv = mesh->TriangleVerticesWrappedData();
   const real3 *pTl = mesh->TriangleEdgeLengthData();
   const real *pVarea = mesh->VertexAreaData();
 
-  Array<real> *vertexTimestep = new Array<real>(1, cudaFlag, nVertex);
+  vertexTimestep->SetSize(nVertex);
   vertexTimestep->SetToValue(0.0);
   real *pVts = vertexTimestep->GetPointer();
 
   // First calculate maximum signal speed
-  if (cudaFlag == 1) {
+  if (triangleVmax != 0 ||
+      simulationParameter->gatherResidueFlag == 1) {
+    // Vertices gather signal speed from triangles
+    const int *pVt = mesh->VertexTriangleData();
+    const int *pVtOffset = mesh->VertexTriangleOffsetData();
+
+    // Signal speed of triangles, unless provided by CalcResidualFused()
+    Array<real> *vmax = triangleVmax;
+    if (triangleVmax == 0) {
+      vmax = triangleSignalSpeed;
+      vmax->SetSize(nTriangle);
+    }
+    real *pTvmax = vmax->GetPointer();
+
+    if (cudaFlag == 1) {
+      int nThreads = 128;
+      int nBlocks  = 128;
+
+#ifdef TIME_ASTRIX
+      gpuErrchk( cudaEventRecord(start, 0) );
+#endif
+      if (triangleVmax == 0) {
+        // Base nThreads and nBlocks on maximum occupancy
+        cudaOccupancyMaxPotentialBlockSize(&nBlocks, &nThreads,
+                                           devCalcVmaxTriangle<realNeq, CL>,
+                                           (size_t) 0, 0);
+
+        // Execute kernel...
+        LaunchKernel(nBlocks, nThreads, devCalcVmaxTriangle<realNeq, CL>)
+          (nTriangle, pTv, pState, pTl, pTvmax, nVertex, G, G - 1.0, pVp);
+
+        gpuErrchk( cudaPeekAtLastError() );
+        gpuErrchk( cudaDeviceSynchronize() );
+      }
+
+      // Base nThreads and nBlocks on maximum occupancy
+      cudaOccupancyMaxPotentialBlockSize(&nBlocks, &nThreads,
+                                         devGatherVmax,
+                                         (size_t) 0, 0);
+
+      LaunchKernel(nBlocks, nThreads, devGatherVmax)
+        (nVertex, pVt, pVtOffset, pTvmax, pVts);
+#ifdef TIME_ASTRIX
+      gpuErrchk( cudaEventRecord(stop, 0) );
+      gpuErrchk( cudaEventSynchronize(stop) );
+#endif
+
+      gpuErrchk( cudaPeekAtLastError() );
+      gpuErrchk( cudaDeviceSynchronize() );
+    } else {
+#ifdef TIME_ASTRIX
+      gpuErrchk( cudaEventRecord(start, 0) );
+#endif
+      if (triangleVmax == 0) {
+#pragma omp parallel for
+        for (int n = 0; n < nTriangle; n++)
+          CalcVmaxTriangleSingle<realNeq, CL>(n, pTv, pState, pTl, pTvmax,
+                                              nVertex, G, G - 1.0, pVp);
+      }
+#pragma omp parallel for
+      for (unsigned int n = 0; n < nVertex; n++)
+        GatherVmaxSingle(n, pVt, pVtOffset, pTvmax, pVts);
+#ifdef TIME_ASTRIX
+      gpuErrchk( cudaEventRecord(stop, 0) );
+      gpuErrchk( cudaEventSynchronize(stop) );
+#endif
+    }
+  } else if (cudaFlag == 1) {
     int nThreads = 128;
     int nBlocks  = 128;
 
@@ -358,7 +356,7 @@ real Simulation<realNeq, CL>::CalcVertexTimeStep()
 #ifdef TIME_ASTRIX
     gpuErrchk( cudaEventRecord(start, 0) );
 #endif
-    devCalcVmax<realNeq, CL><<<nBlocks, nThreads>>>
+    LaunchKernel(nBlocks, nThreads, devCalcVmax<realNeq, CL>)
       (nTriangle, pTv, pState, pTl, pVts, nVertex, G, G - 1.0, pVp);
 #ifdef TIME_ASTRIX
     gpuErrchk( cudaEventRecord(stop, 0) );
@@ -371,9 +369,17 @@ real Simulation<realNeq, CL>::CalcVertexTimeStep()
 #ifdef TIME_ASTRIX
     gpuErrchk( cudaEventRecord(start, 0) );
 #endif
-    for (int n = 0; n < nTriangle; n++)
-      CalcVmaxSingle<realNeq, CL>(n, pTv, pState, pTl, pVts,
-                                  nVertex, G, G - 1.0, pVp);
+    int nColour = mesh->GetNTriangleColour();
+    const int *pTc = mesh->TriangleColourData();
+    const int *pTcOffset = mesh->TriangleColourOffsetData();
+
+    // Triangles of one colour share no vertices: no conflicts
+    for (int i = 0; i < nColour; i++) {
+#pragma omp parallel for
+      for (int j = pTcOffset[i]; j < pTcOffset[i + 1]; j++)
+        CalcVmaxSingle<realNeq, CL>(pTc[j], pTv, pState, pTl, pVts,
+                                    nVertex, G, G - 1.0, pVp);
+    }
 #ifdef TIME_ASTRIX
     gpuErrchk( cudaEventRecord(stop, 0) );
     gpuErrchk( cudaEventSynchronize(stop) );
@@ -382,7 +388,7 @@ real Simulation<realNeq, CL>::CalcVertexTimeStep()
 
 #ifdef TIME_ASTRIX
   gpuErrchk( cudaEventElapsedTime(&elapsedTime, start, stop) );
-  WriteProfileFile("SignalSpeed.prof2", nTriangle, elapsedTime, cudaFlag);
+  AddProfile("SignalSpeed", nTriangle, elapsedTime, cudaFlag);
 #endif
 
   // Convert maximum signal speed into vertex time step
@@ -399,7 +405,7 @@ real Simulation<realNeq, CL>::CalcVertexTimeStep()
 #ifdef TIME_ASTRIX
     gpuErrchk( cudaEventRecord(start, 0) );
 #endif
-    devCalcVertexTimeStep<<<nBlocks, nThreads>>>
+    LaunchKernel(nBlocks, nThreads, devCalcVertexTimeStep)
       (nVertex, pVts, pVarea);
 #ifdef TIME_ASTRIX
     gpuErrchk( cudaEventRecord(stop, 0) );
@@ -412,6 +418,7 @@ real Simulation<realNeq, CL>::CalcVertexTimeStep()
 #ifdef TIME_ASTRIX
     gpuErrchk( cudaEventRecord(start, 0) );
 #endif
+#pragma omp parallel for
     for (unsigned int n = 0; n < nVertex; n++)
       CalcVertexTimeStepSingle(n, pVts, pVarea);
 #ifdef TIME_ASTRIX
@@ -422,7 +429,7 @@ real Simulation<realNeq, CL>::CalcVertexTimeStep()
 
 #ifdef TIME_ASTRIX
   gpuErrchk( cudaEventElapsedTime(&elapsedTime, start, stop) );
-  WriteProfileFile("CalcTimeStep.prof2", nVertex, elapsedTime, cudaFlag);
+  AddProfile("CalcTimeStep", nVertex, elapsedTime, cudaFlag);
 #endif
 
   // Find the minimum
@@ -432,8 +439,6 @@ real Simulation<realNeq, CL>::CalcVertexTimeStep()
   if (simulationTime + dt > simulationParameter->maxSimulationTime)
     dt = simulationParameter->maxSimulationTime - simulationTime;
 
-  delete vertexTimestep;
-
   return dt;
 }
 
@@ -445,5 +450,13 @@ template real Simulation<real, CL_ADVECT>::CalcVertexTimeStep();
 template real Simulation<real, CL_BURGERS>::CalcVertexTimeStep();
 template real Simulation<real3, CL_CART_ISO>::CalcVertexTimeStep();
 template real Simulation<real4, CL_CART_EULER>::CalcVertexTimeStep();
+template real
+Simulation<real, CL_ADVECT>::CalcVertexTimeStep(Array<real> *triangleVmax);
+template real
+Simulation<real, CL_BURGERS>::CalcVertexTimeStep(Array<real> *triangleVmax);
+template real
+Simulation<real3, CL_CART_ISO>::CalcVertexTimeStep(Array<real> *triangleVmax);
+template real
+Simulation<real4, CL_CART_EULER>::CalcVertexTimeStep(Array<real> *triangleVmax);
 
 }  // namespace astrix
@@ -20,7 +20,9 @@ along with Astrix.  If not, see <http://www.gnu.org/licenses/>.*/
 #include "../Array/array.h"
 #include "../Mesh/mesh.h"
 #include "./simulation.h"
+#include "./timelevel.h"
 #include "../Common/cudaLow.h"
+#include "../Common/state.h"
 #include "../Common/inlineMath.h"
 #include "./upwind.h"
 #include "../Common/profile.h"
@@ -50,12 +52,14 @@ namespace astrix {
 //######################################################################
 
 template<ConservationLaw CL>
-__host__ __device__
+__host__ __device__ __forceinline__
 void CalcTotalResLDASingle(int n,
                            const int3* __restrict__ pTv,
-                           const real4* __restrict__ pVz,
-                           real4 *pTresLDA0, real4 *pTresLDA1,
-                           real4 *pTresLDA2, real4 *pTresTot,
+                           state::ConstPointer<real4> pVz,
+                           state::Pointer<real4> pTresLDA0,
+                           state::Pointer<real4> pTresLDA1,
+                           state::Pointer<real4> pTresLDA2,
+                           state::Pointer<real4> pTresTot,
                            const real2 *pTn1,
                            const real2 *pTn2,
                            const real2 *pTn3,
@@ -71,12 +75,6 @@ void CalcTotalResLDASingle(int n,
   int vs1 = pTv[n].x;
   int vs2 = pTv[n].y;
   int vs3 = pTv[n].z;
-  while (vs1 >= nVertex) vs1 -= nVertex;
-  while (vs2 >= nVertex) vs2 -= nVertex;
-  while (vs3 >= nVertex) vs3 -= nVertex;
-  while (vs1 < 0) vs1 += nVertex;
-  while (vs2 < 0) vs2 += nVertex;
-  while (vs3 < 0) vs3 += nVertex;
 
   // External potential at vertices
   real pot0 = pVp[vs1];
@@ -429,12 +427,14 @@ void CalcTotalResLDASingle(int n,
 }
 
 template<ConservationLaw CL>
-__host__ __device__
+__host__ __device__ __forceinline__
 void CalcTotalResLDASingle(int n,
                            const int3* __restrict__ pTv,
-                           const real3* __restrict__ pVz,
-                           real3 *pTresLDA0, real3 *pTresLDA1,
-                           real3 *pTresLDA2, real3 *pTresTot,
+                           state::ConstPointer<real3> pVz,
+                           state::Pointer<real3> pTresLDA0,
+                           state::Pointer<real3> pTresLDA1,
+                           state::Pointer<real3> pTresLDA2,
+                           state::Pointer<real3> pTresTot,
                            const real2 *pTn1,
                            const real2 *pTn2,
                            const real2 *pTn3,
@@ -450,12 +450,6 @@ void CalcTotalResLDASingle(int n,
   int vs1 = pTv[n].x;
   int vs2 = pTv[n].y;
   int vs3 = pTv[n].z;
-  while (vs1 >= nVertex) vs1 -= nVertex;
-  while (vs2 >= nVertex) vs2 -= nVertex;
-  while (vs3 >= nVertex) vs3 -= nVertex;
-  while (vs1 < 0) vs1 += nVertex;
-  while (vs2 < 0) vs2 += nVertex;
-  while (vs3 < 0) vs3 += nVertex;
 
   // Parameter vector at vertices: 12 uncoalesced loads
   real Zv00 = pVz[vs1].x;
@@ -715,12 +709,14 @@ void CalcTotalResLDASingle(int n,
 }
 
 template<ConservationLaw CL>
-__host__ __device__
+__host__ __device__ __forceinline__
 void CalcTotalResLDASingle(int n,
                            const int3* __restrict__ pTv,
-                           const real* __restrict__ pVz,
-                           real *pTresLDA0, real *pTresLDA1,
-                           real *pTresLDA2, real *pTresTot,
+                           state::ConstPointer<real> pVz,
+                           state::Pointer<real> pTresLDA0,
+                           state::Pointer<real> pTresLDA1,
+                           state::Pointer<real> pTresLDA2,
+                           state::Pointer<real> pTresTot,
                            const real2 *pTn1,
                            const real2 *pTn2,
                            const real2 *pTn3,
@@ -735,12 +731,6 @@ void CalcTotalResLDASingle(int n,
   int v1 = pTv[n].x;
   int v2 = pTv[n].y;
   int v3 = pTv[n].z;
-  while (v1 >= nVertex) v1 -= nVertex;
-  while (v2 >= nVertex) v2 -= nVertex;
-  while (v3 >= nVertex) v3 -= nVertex;
-  while (v1 < 0) v1 += nVertex;
-  while (v2 < 0) v2 += nVertex;
-  while (v3 < 0) v3 += nVertex;
 
   // Average parameter vector
   real vx = one;
@@ -833,6 +823,7 @@ void CalcTotalResLDASingle(int n,
 /*! \brief Kernel calculating space-time LDA residue for all triangles
 
 \param nTriangle Total number of triangles in Mesh
+\param *pTa Pointer to list of active triangles, or zero
 \param *pTv Pointer to triangle vertices
 \param *pVz Pointer to parameter vector
 \param *pTresLDA0 Triangle residue LDA direction 0
@@ -852,23 +843,28 @@ void CalcTotalResLDASingle(int n,
 
 template<class realNeq, ConservationLaw CL>
 __global__ void
-devCalcTotalResLDA(int nTriangle, const int3* __restrict__ pTv,
-                   const realNeq* __restrict__ pVz,
-                   realNeq *pTresLDA0, realNeq *pTresLDA1, realNeq *pTresLDA2,
-                   realNeq *pTresTot, const real2 *pTn1, const real2 *pTn2,
+devCalcTotalResLDA(int nTriangle, const int *pTa,
+                   const int3* __restrict__ pTv,
+                   state::ConstPointer<realNeq> pVz,
+                   state::Pointer<realNeq> pTresLDA0,
+                   state::Pointer<realNeq> pTresLDA1,
+                   state::Pointer<realNeq> pTresLDA2,
+                   state::Pointer<realNeq> pTresTot, const real2 *pTn1,
+                   const real2 *pTn2,
                    const real2 *pTn3,
                    const real3* __restrict__ pTl,
                    int nVertex, real G, real G1, real G2,  const real *pVp)
 {
-  int n = blockIdx.x*blockDim.x + threadIdx.x;
+  int i = blockIdx.x*blockDim.x + threadIdx.x;
 
-  while (n < nTriangle) {
+  while (i < nTriangle) {
+    int n = ActiveTriangle(i, pTa);
     CalcTotalResLDASingle<CL>(n, pTv, pVz, pTresLDA0, pTresLDA1, pTresLDA2,
                               pTresTot, pTn1, pTn2, pTn3, pTl,
                               nVertex, G, G1, G2, pVp);
 
     // Next triangle
-    n += blockDim.x*gridDim.x;
+    i += blockDim.x*gridDim.x;
   }
 }
 
@@ -910,17 +906,24 @@ void Simulation<realNeq, CL>::CalcTotalResLDA()
   int nTriangle = mesh->GetNTriangle();
   int nVertex = mesh->GetNVertex();
 
-  realNeq *pVz = vertexParameterVector->GetPointer();
+  // With local time stepping, only update active triangles
+  const int *pTa = 0;
+  if (localTimeStepFlag == 1) {
+    nTriangle = triangleActive->GetSize();
+    pTa = triangleActive->GetPointer();
+  }
+
+  state::Pointer<realNeq> pVz = state::GetPointer(vertexParameterVector);
   real *pVp = vertexPotential->GetPointer();
   real G = simulationParameter->specificHeatRatio;
 
-  realNeq *pTresLDA0 = triangleResidueLDA->GetPointer(0);
-  realNeq *pTresLDA1 = triangleResidueLDA->GetPointer(1);
-  realNeq *pTresLDA2 = triangleResidueLDA->GetPointer(2);
+  state::Pointer<realNeq> pTresLDA0 = state::GetPointer(triangleResidueLDA, 0);
+  state::Pointer<realNeq> pTresLDA1 = state::GetPointer(triangleResidueLDA, 1);
+  state::Pointer<realNeq> pTresLDA2 = state::GetPointer(triangleResidueLDA, 2);
 
-  realNeq *pTresTot = triangleResidueTotal->GetPointer();
+  state::Pointer<realNeq> pTresTot = state::GetPointer(triangleResidueTotal);
 
-  const int3 *pTv = mesh->TriangleVerticesData();
+  const int3 *pTv = mesh->TriangleVerticesWrappedData();
   const real2 *pTn1 = mesh->TriangleEdgeNormalsData(0);
   const real2 *pTn2 = mesh->TriangleEdgeNormalsData(1);
   const real2 *pTn3 = mesh->TriangleEdgeNormalsData(2);
@@ -938,8 +941,8 @@ void Simulation<realNeq, CL>::CalcTotalResLDA()
 #ifdef TIME_ASTRIX
     gpuErrchk( cudaEventRecord(start, 0) );
 #endif
-    devCalcTotalResLDA<realNeq, CL><<<nBlocks, nThreads>>>
-      (nTriangle, pTv, pVz,
+    LaunchKernel(nBlocks, nThreads, devCalcTotalResLDA<realNeq, CL>)
+      (nTriangle, pTa, pTv, pVz,
        pTresLDA0, pTresLDA1, pTresLDA2, pTresTot,
        pTn1, pTn2, pTn3, pTl, nVertex, G, G - 1.0, G - 2.0, pVp);
 #ifdef TIME_ASTRIX
@@ -954,11 +957,16 @@ void Simulation<realNeq, CL>::CalcTotalResLDA()
 #ifdef TIME_ASTRIX
     gpuErrchk( cudaEventRecord(start, 0) );
 #endif
-    for (int n = 0; n < nTriangle; n++)
+    // Triangles are independent: one triangle per vector lane
+    int hostSimdFlag = simulationParameter->hostSimdFlag;
+#pragma omp parallel for simd if(simd: hostSimdFlag == 1)
+    for (int i = 0; i < nTriangle; i++) {
+      int n = ActiveTriangle(i, pTa);
       CalcTotalResLDASingle<CL>(n, pTv, pVz,
                                 pTresLDA0, pTresLDA1, pTresLDA2, pTresTot,
                                 pTn1, pTn2, pTn3, pTl, nVertex,
                                 G, G - 1.0, G - 2.0, pVp);
+    }
 #ifdef TIME_ASTRIX
     gpuErrchk( cudaEventRecord(stop, 0) );
     gpuErrchk( cudaEventSynchronize(stop) );
@@ -967,7 +975,7 @@ void Simulation<realNeq, CL>::CalcTotalResLDA()
 
 #ifdef TIME_ASTRIX
   gpuErrchk( cudaEventElapsedTime(&elapsedTime, start, stop) );
-  WriteProfileFile("CalcTotalResLDA.prof2", nTriangle, elapsedTime, cudaFlag);
+  AddProfile("CalcTotalResLDA", nTriangle, elapsedTime, cudaFlag);
 #endif
 
   if (transformFlag == 1) {
@@ -19,7 +19,9 @@ along with Astrix.  If not, see <http://www.gnu.org/licenses/>.*/
 #include "../Array/array.h"
 #include "../Mesh/mesh.h"
 #include "./simulation.h"
+#include "./timelevel.h"
 #include "../Common/cudaLow.h"
+#include "../Common/state.h"
 #include "../Common/inlineMath.h"
 #include "./upwind.h"
 #include "../Common/profile.h"
@@ -53,20 +55,20 @@ namespace astrix {
 //######################################################################
 
 template<ConservationLaw CL>
-__host__ __device__
+__host__ __device__ __forceinline__
 void CalcTotalResNtotSingle(const int n, const real dt,
                             const int3* __restrict__ pTv,
-                            const real4* __restrict__ pVz,
+                            state::ConstPointer<real4> pVz,
                             real4 *pDstate,
                             const real2 *pTn1,
                             const real2 *pTn2,
                             const real2 *pTn3,
                             const real3* __restrict__ pTl,
-                            real4 *pResSource,
-                            real4 *pTresN0,
-                            real4 *pTresN1,
-                            real4 *pTresN2,
-                            real4 *pTresTot,
+                            state::Pointer<real4> pResSource,
+                            state::Pointer<real4> pTresN0,
+                            state::Pointer<real4> pTresN1,
+                            state::Pointer<real4> pTresN2,
+                            state::Pointer<real4> pTresTot,
                             int nVertex, const real G, const real G1,
                             const real G2, const real iG, const real *pVp)
 {
@@ -80,12 +82,6 @@ void CalcTotalResNtotSingle(const int n, const real dt,
   int v1 = pTv[n].x;
   int v2 = pTv[n].y;
   int v3 = pTv[n].z;
-  while (v1 >= nVertex) v1 -= nVertex;
-  while (v2 >= nVertex) v2 -= nVertex;
-  while (v3 >= nVertex) v3 -= nVertex;
-  while (v1 < 0) v1 += nVertex;
-  while (v2 < 0) v2 += nVertex;
-  while (v3 < 0) v3 += nVertex;
 
   // State difference between old and RK1
   real dW00 = pDstate[v1].x;
@@ -882,14 +878,17 @@ void CalcTotalResNtotSingle(const int n, const real dt,
 }
 
 template<ConservationLaw CL>
-__host__ __device__
+__host__ __device__ __forceinline__
 void CalcTotalResNtotSingle(const int n, const real dt,
                             const int3* __restrict__ pTv,
-                            const real3* __restrict__ pVz, real3 *pDstate,
+                            state::ConstPointer<real3> pVz, real3 *pDstate,
                             const real2 *pTn1, const real2 *pTn2,
                             const real2 *pTn3, const real3* __restrict__ pTl,
-                            real3 *pResSource, real3 *pTresN0, real3 *pTresN1,
-                            real3 *pTresN2, real3 *pTresTot, int nVertex,
+                            state::Pointer<real3> pResSource,
+                            state::Pointer<real3> pTresN0,
+                            state::Pointer<real3> pTresN1,
+                            state::Pointer<real3> pTresN2,
+                            state::Pointer<real3> pTresTot, int nVertex,
                             const real G, const real G1,
                             const real G2, const real iG, const real *pVp)
 {
@@ -903,12 +902,6 @@ void CalcTotalResNtotSingle(const int n, const real dt,
   int v1 = pTv[n].x;
   int v2 = pTv[n].y;
   int v3 = pTv[n].z;
-  while (v1 >= nVertex) v1 -= nVertex;
-  while (v2 >= nVertex) v2 -= nVertex;
-  while (v3 >= nVertex) v3 -= nVertex;
-  while (v1 < 0) v1 += nVertex;
-  while (v2 < 0) v2 += nVertex;
-  while (v3 < 0) v3 += nVertex;
 
   // State difference between old and RK1
   real dW00 = pDstate[v1].x;
@@ -1483,14 +1476,17 @@ void CalcTotalResNtotSingle(const int n, const real dt,
 }
 
 template<ConservationLaw CL>
-__host__ __device__
+__host__ __device__ __forceinline__
 void CalcTotalResNtotSingle(const int n, const real dt,
                             const int3* __restrict__ pTv,
-                            const real* __restrict__ pVz, real *pDstate,
+                            state::ConstPointer<real> pVz, real *pDstate,
                             const real2 *pTn1, const real2 *pTn2,
                             const real2 *pTn3, const real3* __restrict__ pTl,
-                            real *pResSource, real *pTresN0, real *pTresN1,
-                            real *pTresN2, real *pTresTot, int nVertex,
+                            state::Pointer<real> pResSource,
+                            state::Pointer<real> pTresN0,
+                            state::Pointer<real> pTresN1,
+                            state::Pointer<real> pTresN2,
+                            state::Pointer<real> pTresTot, int nVertex,
                             const real G, const real G1,
                             const real G2, const real iG, const real *pVp)
 {
@@ -1504,12 +1500,6 @@ void CalcTotalResNtotSingle(const int n, const real dt,
   int v1 = pTv[n].x;
   int v2 = pTv[n].y;
   int v3 = pTv[n].z;
-  while (v1 >= nVertex) v1 -= nVertex;
-  while (v2 >= nVertex) v2 -= nVertex;
-  while (v3 >= nVertex) v3 -= nVertex;
-  while (v1 < 0) v1 += nVertex;
-  while (v2 < 0) v2 += nVertex;
-  while (v3 < 0) v3 += nVertex;
 
   real dW0 = pDstate[v1];
   real dW1 = pDstate[v2];
@@ -1714,7 +1704,9 @@ void CalcTotalResNtotSingle(const int n, const real dt,
 /*! Kernel calculating space-time N + total residue for all triangles
 
 \param nTriangle Total number of triangles in Mesh
+\param *pTa Pointer to list of active triangles, or zero
 \param dt Time step
+\param *pTdt Pointer to time step of triangles with local time stepping, or zero
 \param *pTv Pointer to triangle vertices
 \param *pVz Pointer to parameter vector
 \param *pDstate Pointer to state differences (new - old)
@@ -1737,25 +1729,30 @@ void CalcTotalResNtotSingle(const int n, const real dt,
 
 template<class realNeq, ConservationLaw CL>
 __global__ void
-devCalcTotalResNtot(int nTriangle, real dt,
+devCalcTotalResNtot(int nTriangle, const int *pTa, real dt, const real *pTdt,
                     const int3* __restrict__ pTv,
-                    const realNeq* __restrict__ pVz, realNeq *pDstate,
+                    state::ConstPointer<realNeq> pVz, realNeq *pDstate,
                     const real2 *pTn1, const real2 *pTn2, const real2 *pTn3,
-                    const real3* __restrict__  pTl, realNeq *pResSource,
-                    realNeq *pTresN0, realNeq *pTresN1, realNeq *pTresN2,
-                    realNeq *pTresTot, int nVertex,
+                    const real3* __restrict__  pTl,
+                    state::Pointer<realNeq> pResSource,
+                    state::Pointer<realNeq> pTresN0,
+                    state::Pointer<realNeq> pTresN1,
+                    state::Pointer<realNeq> pTresN2,
+                    state::Pointer<realNeq> pTresTot, int nVertex,
                     real G, real G1, real G2, real iG, const real *pVp)
 {
-  int n = blockIdx.x*blockDim.x + threadIdx.x;
+  int i = blockIdx.x*blockDim.x + threadIdx.x;
 
-  while (n < nTriangle) {
-    CalcTotalResNtotSingle<CL>(n, dt, pTv, pVz, pDstate,
+  while (i < nTriangle) {
+    int n = ActiveTriangle(i, pTa);
+    CalcTotalResNtotSingle<CL>(n, TriangleTimestep(n, dt, pTdt),
+                               pTv, pVz, pDstate,
                                pTn1, pTn2, pTn3, pTl, pResSource,
                                pTresN0, pTresN1, pTresN2,
                                pTresTot, nVertex, G, G1, G2, iG, pVp);
 
     // Next triangle
-    n += blockDim.x*gridDim.x;
+    i += blockDim.x*gridDim.x;
   }
 }
 
@@ -1802,21 +1799,30 @@ void Simulation<realNeq, CL>::CalcTotalResNtot(real dt)
   int nTriangle = mesh->GetNTriangle();
   int nVertex = mesh->GetNVertex();
 
+  // With local time stepping, only update active triangles
+  const int *pTa = 0;
+  const real *pTdt = 0;
+  if (localTimeStepFlag == 1) {
+    nTriangle = triangleActive->GetSize();
+    pTa = triangleActive->GetPointer();
+    pTdt = triangleTimestep->GetPointer();
+  }
+
   realNeq *pDstate = vertexStateDiff->GetPointer();
   real *pVp = vertexPotential->GetPointer();
 
   real G = simulationParameter->specificHeatRatio;
 
-  realNeq *pVz = vertexParameterVector->GetPointer();
+  state::Pointer<realNeq> pVz = state::GetPointer(vertexParameterVector);
 
-  realNeq *pTresN0 = triangleResidueN->GetPointer(0);
-  realNeq *pTresN1 = triangleResidueN->GetPointer(1);
-  realNeq *pTresN2 = triangleResidueN->GetPointer(2);
+  state::Pointer<realNeq> pTresN0 = state::GetPointer(triangleResidueN, 0);
+  state::Pointer<realNeq> pTresN1 = state::GetPointer(triangleResidueN, 1);
+  state::Pointer<realNeq> pTresN2 = state::GetPointer(triangleResidueN, 2);
 
-  realNeq *pTresTot = triangleResidueTotal->GetPointer();
-  realNeq *pResSource = triangleResidueSource->GetPointer();
+  state::Pointer<realNeq> pTresTot = state::GetPointer(triangleResidueTotal);
+  state::Pointer<realNeq> pResSource = state::GetPointer(triangleResidueSource);
 
-  const int3 *pTv = mesh->TriangleVerticesData();
+  const int3 *pTv = mesh->TriangleVerticesWrappedData();
   const real2 *pTn1 = mesh->TriangleEdgeNormalsData(0);
   const real2 *pTn2 = mesh->TriangleEdgeNormalsData(1);
   const real2 *pTn3 = mesh->TriangleEdgeNormalsData(2);
@@ -1834,8 +1840,8 @@ void Simulation<realNeq, CL>::CalcTotalResNtot(real dt)
 #ifdef TIME_ASTRIX
     gpuErrchk( cudaEventRecord(start, 0) );
 #endif
-    devCalcTotalResNtot<realNeq, CL><<<nBlocks, nThreads>>>
-      (nTriangle, dt, pTv, pVz, pDstate,
+    LaunchKernel(nBlocks, nThreads, devCalcTotalResNtot<realNeq, CL>)
+      (nTriangle, pTa, dt, pTdt, pTv, pVz, pDstate,
        pTn1, pTn2, pTn3, pTl, pResSource,
        pTresN0, pTresN1, pTresN2,
        pTresTot, nVertex, G, G - 1.0, G - 2.0, 1.0/G, pVp);
@@ -1850,12 +1856,18 @@ void Simulation<realNeq, CL>::CalcTotalResNtot(real dt)
 #ifdef TIME_ASTRIX
     gpuErrchk( cudaEventRecord(start, 0) );
 #endif
-    for (int n = 0; n < nTriangle; n++)
-      CalcTotalResNtotSingle<CL>(n, dt, pTv, pVz, pDstate,
+    // Triangles are independent: one triangle per vector lane
+    int hostSimdFlag = simulationParameter->hostSimdFlag;
+#pragma omp parallel for simd if(simd: hostSimdFlag == 1)
+    for (int i = 0; i < nTriangle; i++) {
+      int n = ActiveTriangle(i, pTa);
+      CalcTotalResNtotSingle<CL>(n, TriangleTimestep(n, dt, pTdt),
+                                 pTv, pVz, pDstate,
                                  pTn1, pTn2, pTn3, pTl, pResSource,
                                  pTresN0, pTresN1, pTresN2,
                                  pTresTot, nVertex, G, G - 1.0, G - 2.0,
                                  1.0/G, pVp);
+    }
 #ifdef TIME_ASTRIX
     gpuErrchk( cudaEventRecord(stop, 0) );
     gpuErrchk( cudaEventSynchronize(stop) );
@@ -1864,7 +1876,7 @@ void Simulation<realNeq, CL>::CalcTotalResNtot(real dt)
 
 #ifdef TIME_ASTRIX
   gpuErrchk( cudaEventElapsedTime(&elapsedTime, start, stop) );
-  WriteProfileFile("CalcTotalResNtot.prof2", nTriangle, elapsedTime, cudaFlag);
+  AddProfile("CalcTotalResNtot", nTriangle, elapsedTime, cudaFlag);
 #endif
 
   if (transformFlag == 1) {
@@ -89,7 +89,8 @@ void FlagUnphysicalVertex(const int v, real *pState, real *pVp,
 //######################################################################
 /*! \brief Kernel checking vertices for unphysical state
 
-\param nVertex Total number of vertices in Mesh
+\param nVertex Number of vertices to check
+\param *pVl Pointer to list of vertices to check; if zero, check vertices 0 up to \a nVertex
 \param *pState Pointer to state at vertices
 \param *pVp Pointer to external potential at vertices
 \param *pVertexUnphysicalFlag Pointer to array of flags indicating whether state is physical (0) or unphysical (1) (output)
@@ -98,14 +99,17 @@ void FlagUnphysicalVertex(const int v, real *pState, real *pVp,
 
 template<class realNeq, ConservationLaw CL>
 __global__ void
-devFlagUnphysical(const int nVertex, realNeq *pState, real *pVp,
-                  int *pVertexUnphysicalFlag, const real G1)
+devFlagUnphysical(const int nVertex, const int *pVl, realNeq *pState,
+                  real *pVp, int *pVertexUnphysicalFlag, const real G1)
 {
-  // n=vertex number
   int n = blockIdx.x*blockDim.x + threadIdx.x;
 
   while (n < nVertex) {
-    FlagUnphysicalVertex(n, pState, pVp, pVertexUnphysicalFlag, G1);
+    // v = vertex number
+    int v = n;
+    if (pVl != 0) v = pVl[n];
+
+    FlagUnphysicalVertex(v, pState, pVp, pVertexUnphysicalFlag, G1);
 
     n += blockDim.x*gridDim.x;
   }
@@ -120,8 +124,27 @@ devFlagUnphysical(const int nVertex, realNeq *pState, real *pVp,
 template <class realNeq, ConservationLaw CL>
 void Simulation<realNeq, CL>::FlagUnphysical(Array<int> *vertexUnphysicalFlag)
 {
-  // Total number of vertices in Mesh
+  FlagUnphysical(vertexUnphysicalFlag, 0);
+}
+
+//######################################################################
+/*! Check vertices in \a vertexList for unphysical state. Flags of vertices not in the list are left untouched.
+
+  \param *vertexUnphysicalFlag Pointer to Array of flags indicating whether state is physical (0) or unphysical (1) (output)
+  \param *vertexList List of vertices to check; if zero, check all vertices*/
+//######################################################################
+
+template <class realNeq, ConservationLaw CL>
+void Simulation<realNeq, CL>::FlagUnphysical(Array<int> *vertexUnphysicalFlag,
+                                             Array<int> *vertexList)
+{
+  // Number of vertices to check
   int nVertex = mesh->GetNVertex();
+  const int *pVl = 0;
+  if (vertexList != 0) {
+    nVertex = vertexList->GetSize();
+    pVl = vertexList->GetPointer();
+  }
 
   // State vector at vertices
   realNeq *state = vertexState->GetPointer();
@@ -143,13 +166,18 @@ void Simulation<realNeq, CL>::FlagUnphysical(Array<int> *vertexUnphysicalFlag)
                                        (size_t) 0, 0);
 
     // Execute kernel...
-    devFlagUnphysical<realNeq, CL><<<nBlocks, nThreads>>>
-      (nVertex, state, pVp, pVertexUnphysicalFlag, G - 1.0);
+    LaunchKernel(nBlocks, nThreads, devFlagUnphysical<realNeq, CL>)
+      (nVertex, pVl, state, pVp, pVertexUnphysicalFlag, G - 1.0);
     gpuErrchk( cudaPeekAtLastError() );
     gpuErrchk( cudaDeviceSynchronize() );
   } else {
-    for (int v = 0; v < nVertex; v++)
+#pragma omp parallel for
+    for (int n = 0; n < nVertex; n++) {
+      int v = n;
+      if (pVl != 0) v = pVl[n];
+
       FlagUnphysicalVertex(v, state, pVp, pVertexUnphysicalFlag, G - 1.0);
+    }
   }
 }
 
@@ -166,4 +194,15 @@ FlagUnphysical(Array<int> *vertexUnphysicalFlag);
 template void Simulation<real4, CL_CART_EULER>::
 FlagUnphysical(Array<int> *vertexUnphysicalFlag);
 
+//##############################################################################
+
+template void Simulation<real, CL_ADVECT>::
+FlagUnphysical(Array<int> *vertexUnphysicalFlag, Array<int> *vertexList);
+template void Simulation<real, CL_BURGERS>::
+FlagUnphysical(Array<int> *vertexUnphysicalFlag, Array<int> *vertexList);
+template void Simulation<real3, CL_CART_ISO>::
+FlagUnphysical(Array<int> *vertexUnphysicalFlag, Array<int> *vertexList);
+template void Simulation<real4, CL_CART_EULER>::
+FlagUnphysical(Array<int> *vertexUnphysicalFlag, Array<int> *vertexList);
+
 }  // namespace astrix
@@ -12,7 +12,7 @@ Astrix is distributed in the hope that it will be useful, but WITHOUT ANY WARRAN
 
 You should have received a copy of the GNU General Public License
 along with Astrix.  If not, see <http://www.gnu.org/licenses/>.*/
-#include <cuda_runtime_api.h>
+#include "../Common/cudaRuntime.h"
 #include <iostream>
 
 #include "../Common/definitions.h"
@@ -28,7 +28,10 @@ namespace astrix {
 the vertices. First we calculate the blend parameter (if using the B scheme) to
 combine N and LDA residuals. Then we try an update and check if this leads to
 an unphysical state. Wherever we find an unphysical state we force a first
-order update using the N-scheme.*/
+order update using the N-scheme. Only triangles sharing an unphysical vertex
+and their vertices are involved in this retry, so that its cost scales with the
+number of unphysical vertices rather than with the size of the Mesh. With local
+time stepping, only the vertices in vertexActive are updated and checked.*/
 //##############################################################################
 
 template <class realNeq, ConservationLaw CL>
@@ -43,6 +46,15 @@ void Simulation<realNeq, CL>::UpdateState(real dt, int RKStep)
       triangleResidueN->TransformToDevice();
       triangleResidueLDA->TransformToDevice();
       triangleShockSensor->TransformToDevice();
+      vertexUnphysicalFlag->TransformToDevice();
+      vertexRetryList->TransformToDevice();
+      triangleRetryList->TransformToDevice();
+      vertexUpdateList->TransformToDevice();
+      vertexRetryMark->TransformToDevice();
+      triangleRetryMark->TransformToDevice();
+      retryCount->TransformToDevice();
+      vertexActive->TransformToDevice();
+      triangleTimestep->TransformToDevice();
 
       cudaFlag = 1;
     } else {
@@ -51,6 +63,15 @@ void Simulation<realNeq, CL>::UpdateState(real dt, int RKStep)
       triangleResidueN->TransformToHost();
       triangleResidueLDA->TransformToHost();
       triangleShockSensor->TransformToHost();
+      vertexUnphysicalFlag->TransformToHost();
+      vertexRetryList->TransformToHost();
+      triangleRetryList->TransformToHost();
+      vertexUpdateList->TransformToHost();
+      vertexRetryMark->TransformToHost();
+      triangleRetryMark->TransformToHost();
+      retryCount->TransformToHost();
+      vertexActive->TransformToHost();
+      triangleTimestep->TransformToHost();
 
       cudaFlag = 0;
     }
@@ -59,7 +80,7 @@ void Simulation<realNeq, CL>::UpdateState(real dt, int RKStep)
   int nVertex = mesh->GetNVertex();
 
   // Flag whether state at vertex is unphysical
-  Array<int> *vertexUnphysicalFlag = new Array<int>(1, cudaFlag, nVertex);
+  vertexUnphysicalFlag->SetSize(nVertex);
 
   // Calculateshock sensor if necessary
   if (simulationParameter->intScheme == SCHEME_BX) CalcShockSensor();
@@ -67,6 +88,10 @@ void Simulation<realNeq, CL>::UpdateState(real dt, int RKStep)
   int nCycle = 0;
   int maxCycle = mesh->GetNTriangle();
 
+  // Vertices to update; if zero, update all vertices
+  Array<int> *vertexList = 0;
+  if (localTimeStepFlag == 1) vertexList = vertexActive;
+
   int failFlag = 1;
   while (failFlag > 0) {
     nCycle++;
@@ -89,21 +114,33 @@ void Simulation<realNeq, CL>::UpdateState(real dt, int RKStep)
       throw std::runtime_error("");
     }
 
-    // Distribute residue over vertices
-    AddResidue(dt);
-
-    // Check for unphysical states
-    FlagUnphysical(vertexUnphysicalFlag);
+    if (nCycle == 1) {
+      // Distribute residue over vertices
+      AddResidue(dt, vertexList);
 
-    // Replace LDA if relative change too big
-    if (simulationParameter->intScheme != SCHEME_N &&
-        nCycle == 1)
-      FlagLimit(vertexUnphysicalFlag);
+      // Check for unphysical states
+      FlagUnphysical(vertexUnphysicalFlag, vertexList);
 
-    // Check if unphysical state anywhere
-    failFlag = vertexUnphysicalFlag->Maximum();
+      // Replace LDA if relative change too big
+      if (simulationParameter->intScheme != SCHEME_N)
+        FlagLimit(vertexUnphysicalFlag, vertexList);
 
+      // Check if unphysical state anywhere; flags of vertices not in
+      // vertexList are not up to date
+      if (vertexList == 0) {
+        failFlag = vertexUnphysicalFlag->Maximum();
+        if (failFlag > 0 && simulationParameter->intScheme != SCHEME_N)
+          failFlag = SelectUnphysical(0);
+      } else {
+        failFlag = SelectUnphysical(vertexList);
+      }
+    } else {
+      // Only vertices of triangles where LDA was replaced can change
+      AddResidue(dt, vertexUpdateList);
+      FlagUnphysical(vertexUnphysicalFlag, vertexUpdateList);
 
+      failFlag = SelectUnphysical(vertexUpdateList);
+    }
 
     if (failFlag > 0) {
       if (simulationParameter->intScheme == SCHEME_N) {
@@ -112,22 +149,23 @@ void Simulation<realNeq, CL>::UpdateState(real dt, int RKStep)
         if (verboseLevel > 1) {
           if (nCycle == 1) std::cout << std::endl;
           std::cout << "Found unphysical state at "
-                    << vertexUnphysicalFlag->Sum()
+                    << failFlag
                     << " vertices in cycle " << nCycle
                     << std::endl;
         }
 
+        // Triangles sharing unphysical vertices, and their vertices
+        FindRetryLists();
+
         // Replace LDA residue with N residue for all unphysical states
-        ReplaceLDA(vertexUnphysicalFlag, RKStep);
+        ReplaceLDA(vertexUnphysicalFlag, RKStep, triangleRetryList);
 
         // Return to old state so that we can update again
-        vertexState->SetEqual(vertexStateOld);
+        RestoreState(vertexUpdateList);
       }
     }
   }
 
-  delete vertexUnphysicalFlag;
-
   if (transformFlag == 1) {
     mesh->Transform();
     if (cudaFlag == 0) {
@@ -136,6 +174,15 @@ void Simulation<realNeq, CL>::UpdateState(real dt, int RKStep)
       triangleResidueN->TransformToDevice();
       triangleResidueLDA->TransformToDevice();
       triangleShockSensor->TransformToDevice();
+      vertexUnphysicalFlag->TransformToDevice();
+      vertexRetryList->TransformToDevice();
+      triangleRetryList->TransformToDevice();
+      vertexUpdateList->TransformToDevice();
+      vertexRetryMark->TransformToDevice();
+      triangleRetryMark->TransformToDevice();
+      retryCount->TransformToDevice();
+      vertexActive->TransformToDevice();
+      triangleTimestep->TransformToDevice();
 
       cudaFlag = 1;
     } else {
@@ -144,6 +191,15 @@ void Simulation<realNeq, CL>::UpdateState(real dt, int RKStep)
       triangleResidueN->TransformToHost();
       triangleResidueLDA->TransformToHost();
       triangleShockSensor->TransformToHost();
+      vertexUnphysicalFlag->TransformToHost();
+      vertexRetryList->TransformToHost();
+      triangleRetryList->TransformToHost();
+      vertexUpdateList->TransformToHost();
+      vertexRetryMark->TransformToHost();
+      triangleRetryMark->TransformToHost();
+      retryCount->TransformToHost();
+      vertexActive->TransformToHost();
+      triangleTimestep->TransformToHost();
 
       cudaFlag = 0;
     }
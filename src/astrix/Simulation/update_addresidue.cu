@@ -19,8 +19,10 @@ along with Astrix.  If not, see <http://www.gnu.org/licenses/>.*/
 #include "../Array/array.h"
 #include "../Mesh/mesh.h"
 #include "./simulation.h"
+#include "./timelevel.h"
 #include "../Common/atomic.h"
 #include "../Common/cudaLow.h"
+#include "../Common/state.h"
 #include "../Common/profile.h"
 #include "./Param/simulationparameter.h"
 
@@ -53,9 +55,14 @@ void AddResidueSingle(int n,
                       const int3* __restrict__ pTv,
                       const real3 *pTl,
                       const real *pVarea,
-                      real *pShock, real4 *pState, real4 *pTresTot,
-                      real4 *pTresN0, real4 *pTresN1, real4 *pTresN2,
-                      real4 *pTresLDA0, real4 *pTresLDA1, real4 *pTresLDA2,
+                      real *pShock, real4 *pState,
+                      state::Pointer<real4> pTresTot,
+                      state::Pointer<real4> pTresN0,
+                      state::Pointer<real4> pTresN1,
+                      state::Pointer<real4> pTresN2,
+                      state::Pointer<real4> pTresLDA0,
+                      state::Pointer<real4> pTresLDA1,
+                      state::Pointer<real4> pTresLDA2,
                       real dt, int nVertex, IntegrationScheme intScheme,
                       int setToMinMaxFlag)
 {
@@ -65,12 +72,6 @@ void AddResidueSingle(int n,
   int a = pTv[n].x;
   int b = pTv[n].y;
   int c = pTv[n].z;
-  while (a >= nVertex) a -= nVertex;
-  while (a < 0) a += nVertex;
-  while (b >= nVertex) b -= nVertex;
-  while (b < 0) b += nVertex;
-  while (c >= nVertex) c -= nVertex;
-  while (c < 0) c += nVertex;
 
   // Triangle edge lengths
   real tl1 = pTl[n].x;
@@ -193,13 +194,13 @@ void AddResidueSingle(int n,
   }
 
   dW = -dtdx*res0;
-  AtomicAdd(&(pState[a].x), dW);
+  ScatterAdd(&(pState[a].x), dW);
   dW = -dtdx*res1;
-  AtomicAdd(&(pState[a].y), dW);
+  ScatterAdd(&(pState[a].y), dW);
   dW = -dtdx*res2;
-  AtomicAdd(&(pState[a].z), dW);
+  ScatterAdd(&(pState[a].z), dW);
   dW = -dtdx*res3;
-  AtomicAdd(&(pState[a].w), dW);
+  ScatterAdd(&(pState[a].w), dW);
 
   dtdx = dt*tl2/pVarea[b];
 
@@ -234,13 +235,13 @@ void AddResidueSingle(int n,
   }
 
   dW = -dtdx*res0;
-  AtomicAdd(&(pState[b].x), dW);
+  ScatterAdd(&(pState[b].x), dW);
   dW = -dtdx*res1;
-  AtomicAdd(&(pState[b].y), dW);
+  ScatterAdd(&(pState[b].y), dW);
   dW = -dtdx*res2;
-  AtomicAdd(&(pState[b].z), dW);
+  ScatterAdd(&(pState[b].z), dW);
   dW = -dtdx*res3;
-  AtomicAdd(&(pState[b].w), dW);
+  ScatterAdd(&(pState[b].w), dW);
 
   dtdx = dt*tl3/pVarea[c];
 
@@ -275,13 +276,13 @@ void AddResidueSingle(int n,
   }
 
   dW = -dtdx*res0;
-  AtomicAdd(&(pState[c].x), dW);
+  ScatterAdd(&(pState[c].x), dW);
   dW = -dtdx*res1;
-  AtomicAdd(&(pState[c].y), dW);
+  ScatterAdd(&(pState[c].y), dW);
   dW = -dtdx*res2;
-  AtomicAdd(&(pState[c].z), dW);
+  ScatterAdd(&(pState[c].z), dW);
   dW = -dtdx*res3;
-  AtomicAdd(&(pState[c].w), dW);
+  ScatterAdd(&(pState[c].w), dW);
 }
 
 __host__ __device__
@@ -289,9 +290,14 @@ void AddResidueSingle(int n,
                       const int3* __restrict__ pTv,
                       const real3 *pTl,
                       const real *pVarea,
-                      real *pShock, real3 *pState, real3 *pTresTot,
-                      real3 *pTresN0, real3 *pTresN1, real3 *pTresN2,
-                      real3 *pTresLDA0, real3 *pTresLDA1, real3 *pTresLDA2,
+                      real *pShock, real3 *pState,
+                      state::Pointer<real3> pTresTot,
+                      state::Pointer<real3> pTresN0,
+                      state::Pointer<real3> pTresN1,
+                      state::Pointer<real3> pTresN2,
+                      state::Pointer<real3> pTresLDA0,
+                      state::Pointer<real3> pTresLDA1,
+                      state::Pointer<real3> pTresLDA2,
                       real dt, int nVertex, IntegrationScheme intScheme,
                       int setToMinMaxFlag)
 {
@@ -301,12 +307,6 @@ void AddResidueSingle(int n,
   int a = pTv[n].x;
   int b = pTv[n].y;
   int c = pTv[n].z;
-  while (a >= nVertex) a -= nVertex;
-  while (a < 0) a += nVertex;
-  while (b >= nVertex) b -= nVertex;
-  while (b < 0) b += nVertex;
-  while (c >= nVertex) c -= nVertex;
-  while (c < 0) c += nVertex;
 
   // Triangle edge lengths
   real tl1 = pTl[n].x;
@@ -410,11 +410,11 @@ void AddResidueSingle(int n,
   }
 
   dW = -dtdx*res0;
-  AtomicAdd(&(pState[a].x), dW);
+  ScatterAdd(&(pState[a].x), dW);
   dW = -dtdx*res1;
-  AtomicAdd(&(pState[a].y), dW);
+  ScatterAdd(&(pState[a].y), dW);
   dW = -dtdx*res2;
-  AtomicAdd(&(pState[a].z), dW);
+  ScatterAdd(&(pState[a].z), dW);
 
   dtdx = dt*tl2/pVarea[b];
 
@@ -444,11 +444,11 @@ void AddResidueSingle(int n,
   }
 
   dW = -dtdx*res0;
-  AtomicAdd(&(pState[b].x), dW);
+  ScatterAdd(&(pState[b].x), dW);
   dW = -dtdx*res1;
-  AtomicAdd(&(pState[b].y), dW);
+  ScatterAdd(&(pState[b].y), dW);
   dW = -dtdx*res2;
-  AtomicAdd(&(pState[b].z), dW);
+  ScatterAdd(&(pState[b].z), dW);
 
   dtdx = dt*tl3/pVarea[c];
 
@@ -478,19 +478,23 @@ void AddResidueSingle(int n,
   }
 
   dW = -dtdx*res0;
-  AtomicAdd(&(pState[c].x), dW);
+  ScatterAdd(&(pState[c].x), dW);
   dW = -dtdx*res1;
-  AtomicAdd(&(pState[c].y), dW);
+  ScatterAdd(&(pState[c].y), dW);
   dW = -dtdx*res2;
-  AtomicAdd(&(pState[c].z), dW);
+  ScatterAdd(&(pState[c].z), dW);
 }
 
 __host__ __device__
 void AddResidueSingle(int n, const int3* __restrict__ pTv,
                       const real3 *pTl, const real *pVarea,
-                      real *pShock, real *pState, real *pTresTot,
-                      real *pTresN0, real *pTresN1, real *pTresN2,
-                      real *pTresLDA0, real *pTresLDA1, real *pTresLDA2,
+                      real *pShock, real *pState, state::Pointer<real> pTresTot,
+                      state::Pointer<real> pTresN0,
+                      state::Pointer<real> pTresN1,
+                      state::Pointer<real> pTresN2,
+                      state::Pointer<real> pTresLDA0,
+                      state::Pointer<real> pTresLDA1,
+                      state::Pointer<real> pTresLDA2,
                       real dt, int nVertex, IntegrationScheme intScheme,
                       int setToMinMaxFlag)
 {
@@ -500,12 +504,6 @@ void AddResidueSingle(int n, const int3* __restrict__ pTv,
   int a = pTv[n].x;
   int b = pTv[n].y;
   int c = pTv[n].z;
-  while (a >= nVertex) a -= nVertex;
-  while (a < 0) a += nVertex;
-  while (b >= nVertex) b -= nVertex;
-  while (b < 0) b += nVertex;
-  while (c >= nVertex) c -= nVertex;
-  while (c < 0) c += nVertex;
 
   // Triangle edge lengths
   real tl1 = pTl[n].x;
@@ -545,7 +543,7 @@ void AddResidueSingle(int n, const int3* __restrict__ pTv,
   }
 
   dW = -dtdx*res0;
-  AtomicAdd(&(pState[a]), dW);
+  ScatterAdd(&(pState[a]), dW);
 
   dtdx = dt*tl2/pVarea[b];
 
@@ -558,7 +556,7 @@ void AddResidueSingle(int n, const int3* __restrict__ pTv,
   }
 
   dW = -dtdx*res0;
-  AtomicAdd(&(pState[b]), dW);
+  ScatterAdd(&(pState[b]), dW);
 
   dtdx = dt*tl3/pVarea[c];
 
@@ -571,7 +569,383 @@ void AddResidueSingle(int n, const int3* __restrict__ pTv,
   }
 
   dW = -dtdx*res0;
-  AtomicAdd(&(pState[c]), dW);
+  ScatterAdd(&(pState[c]), dW);
+}
+
+//######################################################################
+/*! \brief Gather residue of all triangles sharing vertex \a v
+
+Triangles sharing \a v are found from the compressed list \a pVt, which holds 3*t + k for every triangle t that has \a v as corner k. Since every vertex is only updated by a single thread, no atomic operations are needed, and contributions are added in order of triangle index.
+
+\param v Vertex to consider
+\param *pVt Pointer to list of triangles sharing vertices
+\param *pVtOffset Pointer to start of every vertex in \a pVt
+\param *pTl Pointer to triangle edge lengths
+\param *pVarea Pointer to vertex areas (Voronoi cells)
+\param *pShock Pointer to shock sensor
+\param *pState Pointer to state vector
+\param *pTresTot Triangle total residue
+\param *pTresN0 Triangle residue N direction 0
+\param *pTresN1 Triangle residue N direction 1
+\param *pTresN2 Triangle residue N direction 2
+\param *pTresLDA0 Triangle residue LDA direction 0
+\param *pTresLDA1 Triangle residue LDA direction 1
+\param *pTresLDA2 Triangle residue LDA direction 2
+\param dt Time step
+\param *pTdt Pointer to time step of triangles with local time stepping, or zero
+\param intScheme Integration scheme
+\param setToMinMaxFlag Flag to use maximum or minimum in blend parameter*/
+//######################################################################
+
+__host__ __device__
+void AddResidueGatherSingle(int v,
+                            const int* __restrict__ pVt,
+                            const int* __restrict__ pVtOffset,
+                            const real3 *pTl,
+                            const real *pVarea,
+                            real *pShock, real4 *pState,
+                            state::Pointer<real4> pTresTot,
+                            state::Pointer<real4> pTresN0,
+                            state::Pointer<real4> pTresN1,
+                            state::Pointer<real4> pTresN2,
+                            state::Pointer<real4> pTresLDA0,
+                            state::Pointer<real4> pTresLDA1,
+                            state::Pointer<real4> pTresLDA2,
+                            real dt, const real *pTdt,
+                            IntegrationScheme intScheme,
+                            int setToMinMaxFlag)
+{
+  const real one = (real) 1.0;
+  const real small = (real) 1.0e-10;
+
+  real4 state = pState[v];
+  real area = pVarea[v];
+
+  for (int i = pVtOffset[v]; i < pVtOffset[v + 1]; i++) {
+    int n = pVt[i]/3;
+    int k = pVt[i] - 3*n;
+
+    // Skip triangles not updated in this substep (local time stepping)
+    real dtT = TriangleTimestep(n, dt, pTdt);
+    if (dtT == (real) 0.0) continue;
+
+    // Triangle edge length associated with this corner
+    real tl1 = pTl[n].x;
+    real tl = tl1;
+    if (k == 1) tl = pTl[n].y;
+    if (k == 2) tl = pTl[n].z;
+
+    // Residue directed at this corner
+    state::Pointer<real4> pTresN = pTresN0;
+    state::Pointer<real4> pTresLDA = pTresLDA0;
+    if (k == 1) {
+      pTresN = pTresN1;
+      pTresLDA = pTresLDA1;
+    }
+    if (k == 2) {
+      pTresN = pTresN2;
+      pTresLDA = pTresLDA2;
+    }
+
+    real lb0 = one;
+    real lb1 = one;
+    real lb2 = one;
+    real lb3 = one;
+
+    if (intScheme == SCHEME_B) {
+      real blend0 = fabs(pTresN0[n].x)*tl1;
+      real blend1 = fabs(pTresN0[n].y)*tl1;
+      real blend2 = fabs(pTresN0[n].z)*tl1;
+      real blend3 = fabs(pTresN0[n].w)*tl1;
+
+      blend0 += fabs(pTresN1[n].x)*tl1;
+      blend1 += fabs(pTresN1[n].y)*tl1;
+      blend2 += fabs(pTresN1[n].z)*tl1;
+      blend3 += fabs(pTresN1[n].w)*tl1;
+
+      blend0 += fabs(pTresN2[n].x)*tl1;
+      blend1 += fabs(pTresN2[n].y)*tl1;
+      blend2 += fabs(pTresN2[n].z)*tl1;
+      blend3 += fabs(pTresN2[n].w)*tl1;
+
+      blend0 = fabs(pTresTot[n].x)/(blend0 + small);
+      blend1 = fabs(pTresTot[n].y)/(blend1 + small);
+      blend2 = fabs(pTresTot[n].z)/(blend2 + small);
+      blend3 = fabs(pTresTot[n].w)/(blend3 + small);
+
+      // Set all to minimum
+      if (setToMinMaxFlag == -1) {
+        real blendMin = min(blend0, min(blend1, min(blend2, blend3)));
+        blend0 = blendMin;
+        blend1 = blendMin;
+        blend2 = blendMin;
+        blend3 = blendMin;
+      }
+
+      // Set all to maximum
+      if (setToMinMaxFlag == 1) {
+        real blendMax = max(blend0, max(blend1, max(blend2, blend3)));
+        blend0 = blendMax;
+        blend1 = blendMax;
+        blend2 = blendMax;
+        blend3 = blendMax;
+      }
+
+      lb0 = blend0;
+      lb1 = blend1;
+      lb2 = blend2;
+      lb3 = blend3;
+    }
+
+    if (intScheme == SCHEME_BX) {
+      lb0 = pShock[n];
+      lb1 = lb0;
+      lb2 = lb0;
+      lb3 = lb0;
+    }
+
+    real res0 = one;
+    real res1 = one;
+    real res2 = one;
+    real res3 = one;
+
+    if (intScheme == SCHEME_N) {
+      res0 = pTresN[n].x;
+      res1 = pTresN[n].y;
+      res2 = pTresN[n].z;
+      res3 = pTresN[n].w;
+    }
+
+    if (intScheme == SCHEME_LDA) {
+      res0 = pTresLDA[n].x;
+      res1 = pTresLDA[n].y;
+      res2 = pTresLDA[n].z;
+      res3 = pTresLDA[n].w;
+    }
+
+    if (intScheme == SCHEME_B || intScheme == SCHEME_BX) {
+      res0 = lb0*pTresN[n].x + (one - lb0)*pTresLDA[n].x;
+      res1 = lb1*pTresN[n].y + (one - lb1)*pTresLDA[n].y;
+      res2 = lb2*pTresN[n].z + (one - lb2)*pTresLDA[n].z;
+      res3 = lb3*pTresN[n].w + (one - lb3)*pTresLDA[n].w;
+    }
+
+    real dtdx = dtT*tl/area;
+
+    state.x += -dtdx*res0;
+    state.y += -dtdx*res1;
+    state.z += -dtdx*res2;
+    state.w += -dtdx*res3;
+  }
+
+  pState[v] = state;
+}
+
+__host__ __device__
+void AddResidueGatherSingle(int v,
+                            const int* __restrict__ pVt,
+                            const int* __restrict__ pVtOffset,
+                            const real3 *pTl,
+                            const real *pVarea,
+                            real *pShock, real3 *pState,
+                            state::Pointer<real3> pTresTot,
+                            state::Pointer<real3> pTresN0,
+                            state::Pointer<real3> pTresN1,
+                            state::Pointer<real3> pTresN2,
+                            state::Pointer<real3> pTresLDA0,
+                            state::Pointer<real3> pTresLDA1,
+                            state::Pointer<real3> pTresLDA2,
+                            real dt, const real *pTdt,
+                            IntegrationScheme intScheme,
+                            int setToMinMaxFlag)
+{
+  const real one = (real) 1.0;
+  const real small = (real) 1.0e-10;
+
+  real3 state = pState[v];
+  real area = pVarea[v];
+
+  for (int i = pVtOffset[v]; i < pVtOffset[v + 1]; i++) {
+    int n = pVt[i]/3;
+    int k = pVt[i] - 3*n;
+
+    // Skip triangles not updated in this substep (local time stepping)
+    real dtT = TriangleTimestep(n, dt, pTdt);
+    if (dtT == (real) 0.0) continue;
+
+    // Triangle edge length associated with this corner
+    real tl1 = pTl[n].x;
+    real tl = tl1;
+    if (k == 1) tl = pTl[n].y;
+    if (k == 2) tl = pTl[n].z;
+
+    // Residue directed at this corner
+    state::Pointer<real3> pTresN = pTresN0;
+    state::Pointer<real3> pTresLDA = pTresLDA0;
+    if (k == 1) {
+      pTresN = pTresN1;
+      pTresLDA = pTresLDA1;
+    }
+    if (k == 2) {
+      pTresN = pTresN2;
+      pTresLDA = pTresLDA2;
+    }
+
+    real lb0 = one;
+    real lb1 = one;
+    real lb2 = one;
+
+    if (intScheme == SCHEME_B) {
+      real blend0 = fabs(pTresN0[n].x)*tl1;
+      real blend1 = fabs(pTresN0[n].y)*tl1;
+      real blend2 = fabs(pTresN0[n].z)*tl1;
+
+      blend0 += fabs(pTresN1[n].x)*tl1;
+      blend1 += fabs(pTresN1[n].y)*tl1;
+      blend2 += fabs(pTresN1[n].z)*tl1;
+
+      blend0 += fabs(pTresN2[n].x)*tl1;
+      blend1 += fabs(pTresN2[n].y)*tl1;
+      blend2 += fabs(pTresN2[n].z)*tl1;
+
+      blend0 = fabs(pTresTot[n].x)/(blend0 + small);
+      blend1 = fabs(pTresTot[n].y)/(blend1 + small);
+      blend2 = fabs(pTresTot[n].z)/(blend2 + small);
+
+      // Set all to minimum
+      if (setToMinMaxFlag == -1) {
+        real blendMin = min(blend0, min(blend1, blend2));
+        blend0 = blendMin;
+        blend1 = blendMin;
+        blend2 = blendMin;
+      }
+
+      // Set all to maximum
+      if (setToMinMaxFlag == 1) {
+        real blendMax = max(blend0, max(blend1, blend2));
+        blend0 = blendMax;
+        blend1 = blendMax;
+        blend2 = blendMax;
+      }
+
+      lb0 = blend0;
+      lb1 = blend1;
+      lb2 = blend2;
+    }
+
+    if (intScheme == SCHEME_BX) {
+      lb0 = pShock[n];
+      lb1 = lb0;
+      lb2 = lb0;
+    }
+
+    real res0 = one;
+    real res1 = one;
+    real res2 = one;
+
+    if (intScheme == SCHEME_N) {
+      res0 = pTresN[n].x;
+      res1 = pTresN[n].y;
+      res2 = pTresN[n].z;
+    }
+
+    if (intScheme == SCHEME_LDA) {
+      res0 = pTresLDA[n].x;
+      res1 = pTresLDA[n].y;
+      res2 = pTresLDA[n].z;
+    }
+
+    if (intScheme == SCHEME_B || intScheme == SCHEME_BX) {
+      res0 = lb0*pTresN[n].x + (one - lb0)*pTresLDA[n].x;
+      res1 = lb1*pTresN[n].y + (one - lb1)*pTresLDA[n].y;
+      res2 = lb2*pTresN[n].z + (one - lb2)*pTresLDA[n].z;
+    }
+
+    real dtdx = dtT*tl/area;
+
+    state.x += -dtdx*res0;
+    state.y += -dtdx*res1;
+    state.z += -dtdx*res2;
+  }
+
+  pState[v] = state;
+}
+
+__host__ __device__
+void AddResidueGatherSingle(int v,
+                            const int* __restrict__ pVt,
+                            const int* __restrict__ pVtOffset,
+                            const real3 *pTl,
+                            const real *pVarea,
+                            real *pShock, real *pState,
+                            state::Pointer<real> pTresTot,
+                            state::Pointer<real> pTresN0,
+                            state::Pointer<real> pTresN1,
+                            state::Pointer<real> pTresN2,
+                            state::Pointer<real> pTresLDA0,
+                            state::Pointer<real> pTresLDA1,
+                            state::Pointer<real> pTresLDA2,
+                            real dt, const real *pTdt,
+                            IntegrationScheme intScheme,
+                            int setToMinMaxFlag)
+{
+  const real one = (real) 1.0;
+  const real small = (real) 1.0e-10;
+
+  real state = pState[v];
+  real area = pVarea[v];
+
+  for (int i = pVtOffset[v]; i < pVtOffset[v + 1]; i++) {
+    int n = pVt[i]/3;
+    int k = pVt[i] - 3*n;
+
+    // Skip triangles not updated in this substep (local time stepping)
+    real dtT = TriangleTimestep(n, dt, pTdt);
+    if (dtT == (real) 0.0) continue;
+
+    // Triangle edge length associated with this corner
+    real tl1 = pTl[n].x;
+    real tl = tl1;
+    if (k == 1) tl = pTl[n].y;
+    if (k == 2) tl = pTl[n].z;
+
+    // Residue directed at this corner
+    state::Pointer<real> pTresN = pTresN0;
+    state::Pointer<real> pTresLDA = pTresLDA0;
+    if (k == 1) {
+      pTresN = pTresN1;
+      pTresLDA = pTresLDA1;
+    }
+    if (k == 2) {
+      pTresN = pTresN2;
+      pTresLDA = pTresLDA2;
+    }
+
+    real lb0 = one;
+
+    if (intScheme == SCHEME_B) {
+      real blend = fabs(pTresN0[n])*tl1;
+      blend += fabs(pTresN1[n])*tl1;
+      blend += fabs(pTresN2[n])*tl1;
+
+      lb0 = fabs(pTresTot[n])/(blend + small);
+    }
+
+    if (intScheme == SCHEME_BX) lb0 = pShock[n];
+
+    real res0 = one;
+
+    if (intScheme == SCHEME_N) res0 = pTresN[n];
+    if (intScheme == SCHEME_LDA) res0 = pTresLDA[n];
+    if (intScheme == SCHEME_B || intScheme == SCHEME_BX)
+      res0 = lb0*pTresN[n] + (one - lb0)*pTresLDA[n];
+
+    real dtdx = dtT*tl/area;
+
+    state += -dtdx*res0;
+  }
+
+  pState[v] = state;
 }
 
 //######################################################################
@@ -600,9 +974,12 @@ template<class realNeq, ConservationLaw CL>
 __global__ void
 devAddResidue(int nTriangle, const int3* __restrict__ pTv, const real3 *pTl,
               const real *pVarea, real *pShock,
-              realNeq *pState, realNeq *pTresTot,
-              realNeq *pTresN0, realNeq *pTresN1, realNeq *pTresN2,
-              realNeq *pTresLDA0, realNeq *pTresLDA1, realNeq *pTresLDA2,
+              realNeq *pState, state::Pointer<realNeq> pTresTot,
+              state::Pointer<realNeq> pTresN0, state::Pointer<realNeq> pTresN1,
+              state::Pointer<realNeq> pTresN2,
+              state::Pointer<realNeq> pTresLDA0,
+              state::Pointer<realNeq> pTresLDA1,
+              state::Pointer<realNeq> pTresLDA2,
               real dt, int nVertex, IntegrationScheme intScheme,
               int setToMinMaxFlag)
 {
@@ -619,6 +996,63 @@ devAddResidue(int nTriangle, const int3* __restrict__ pTv, const real3 *pTl,
   }
 }
 
+//######################################################################
+/*! \brief Gather residue of triangles at their vertices
+
+\param nVertex Number of vertices to update
+\param *pVl Pointer to list of vertices to update; if zero, update vertices 0 up to \a nVertex
+\param *pVt Pointer to list of triangles sharing vertices
+\param *pVtOffset Pointer to start of every vertex in \a pVt
+\param *pTl Pointer to triangle edge lengths
+\param *pVarea Pointer to vertex areas (Voronoi cells)
+\param *pShock Pointer to shock sensor
+\param *pState Pointer to state vector
+\param *pTresTot Triangle total residue
+\param *pTresN0 Triangle residue N direction 0
+\param *pTresN1 Triangle residue N direction 1
+\param *pTresN2 Triangle residue N direction 2
+\param *pTresLDA0 Triangle residue LDA direction 0
+\param *pTresLDA1 Triangle residue LDA direction 1
+\param *pTresLDA2 Triangle residue LDA direction 2
+\param dt Time step
+\param *pTdt Pointer to time step of triangles with local time stepping, or zero
+\param intScheme Integration scheme
+\param setToMinMaxFlag Flag to use maximum or minimum in blend parameter*/
+//######################################################################
+
+template<class realNeq, ConservationLaw CL>
+__global__ void
+devAddResidueGather(int nVertex, const int *pVl,
+                    const int* __restrict__ pVt,
+                    const int* __restrict__ pVtOffset, const real3 *pTl,
+                    const real *pVarea, real *pShock,
+                    realNeq *pState, state::Pointer<realNeq> pTresTot,
+                    state::Pointer<realNeq> pTresN0,
+                    state::Pointer<realNeq> pTresN1,
+                    state::Pointer<realNeq> pTresN2,
+                    state::Pointer<realNeq> pTresLDA0,
+                    state::Pointer<realNeq> pTresLDA1,
+                    state::Pointer<realNeq> pTresLDA2,
+                    real dt, const real *pTdt,
+                    IntegrationScheme intScheme,
+                    int setToMinMaxFlag)
+{
+  int n = blockIdx.x*blockDim.x + threadIdx.x;
+
+  while (n < nVertex) {
+    // v = vertex number
+    int v = n;
+    if (pVl != 0) v = pVl[n];
+
+    AddResidueGatherSingle(v, pVt, pVtOffset, pTl, pVarea, pShock, pState,
+                           pTresTot, pTresN0, pTresN1, pTresN2,
+                           pTresLDA0, pTresLDA1, pTresLDA2,
+                           dt, pTdt, intScheme, setToMinMaxFlag);
+
+    n += blockDim.x*gridDim.x;
+  }
+}
+
 //######################################################################
 /*! Distribute triangle residuals over their vertices
 
@@ -627,6 +1061,19 @@ devAddResidue(int nTriangle, const int3* __restrict__ pTv, const real3 *pTl,
 
 template <class realNeq, ConservationLaw CL>
 void Simulation<realNeq, CL>::AddResidue(real dt)
+{
+  AddResidue(dt, 0);
+}
+
+//######################################################################
+/*! Distribute triangle residuals over their vertices. If \a vertexList is given, only vertices in the list are updated, gathering the residuals of all their triangles.
+
+\param dt Time step
+\param *vertexList List of vertices to update; if zero, update all vertices*/
+//######################################################################
+
+template <class realNeq, ConservationLaw CL>
+void Simulation<realNeq, CL>::AddResidue(real dt, Array<int> *vertexList)
 {
 #ifdef TIME_ASTRIX
   cudaEvent_t start, stop;
@@ -639,26 +1086,88 @@ void Simulation<realNeq, CL>::AddResidue(real dt)
 
   realNeq *state    = vertexState->GetPointer();
 
-  realNeq *pTresN0 = triangleResidueN->GetPointer(0);
-  realNeq *pTresN1 = triangleResidueN->GetPointer(1);
-  realNeq *pTresN2 = triangleResidueN->GetPointer(2);
+  state::Pointer<realNeq> pTresN0 = state::GetPointer(triangleResidueN, 0);
+  state::Pointer<realNeq> pTresN1 = state::GetPointer(triangleResidueN, 1);
+  state::Pointer<realNeq> pTresN2 = state::GetPointer(triangleResidueN, 2);
 
-  realNeq *pTresLDA0 = triangleResidueLDA->GetPointer(0);
-  realNeq *pTresLDA1 = triangleResidueLDA->GetPointer(1);
-  realNeq *pTresLDA2 = triangleResidueLDA->GetPointer(2);
+  state::Pointer<realNeq> pTresLDA0 = state::GetPointer(triangleResidueLDA, 0);
+  state::Pointer<realNeq> pTresLDA1 = state::GetPointer(triangleResidueLDA, 1);
+  state::Pointer<realNeq> pTresLDA2 = state::GetPointer(triangleResidueLDA, 2);
 
-  realNeq *pTresTot = triangleResidueTotal->GetPointer();
+  state::Pointer<realNeq> pTresTot = state::GetPointer(triangleResidueTotal);
 
   real *pShock = triangleShockSensor->GetPointer();
 
-  const int3 *pTv = mesh->TriangleVerticesData();
+  const int3 *pTv = mesh->TriangleVerticesWrappedData();
   const real3 *triL = mesh->TriangleEdgeLengthData();
   const real *vertArea = mesh->VertexAreaData();
 
   IntegrationScheme intScheme = simulationParameter->intScheme;
   int preferMinMaxBlend = simulationParameter->preferMinMaxBlend;
 
-  if (cudaFlag == 1) {
+  // With local time stepping, triangles have individual time steps (zero if
+  // not updated in this substep), which only the gather path supports
+  const real *pTdt = 0;
+  if (localTimeStepFlag == 1)
+    pTdt = triangleTimestep->GetPointer();
+
+  // Only a gather can update a subset of vertices
+  int nUpdate = nVertex;
+  const int *pVl = 0;
+  if (vertexList != 0) {
+    nUpdate = vertexList->GetSize();
+    pVl = vertexList->GetPointer();
+  }
+
+  if (simulationParameter->gatherResidueFlag == 1 || localTimeStepFlag == 1 ||
+      vertexList != 0) {
+    // Vertices gather residue from triangles
+    const int *pVt = mesh->VertexTriangleData();
+    const int *pVtOffset = mesh->VertexTriangleOffsetData();
+
+    if (cudaFlag == 1) {
+      int nThreads = 128;
+      int nBlocks  = 128;
+
+      // Base nThreads and nBlocks on maximum occupancy
+      cudaOccupancyMaxPotentialBlockSize(&nBlocks, &nThreads,
+                                         devAddResidueGather<realNeq, CL>,
+                                         (size_t) 0, 0);
+
+#ifdef TIME_ASTRIX
+      gpuErrchk( cudaEventRecord(start, 0) );
+#endif
+      // Execute kernel...
+      LaunchKernel(nBlocks, nThreads, devAddResidueGather<realNeq, CL>)
+        (nUpdate, pVl, pVt, pVtOffset, triL, vertArea, pShock, state, pTresTot,
+         pTresN0, pTresN1, pTresN2, pTresLDA0, pTresLDA1, pTresLDA2,
+         dt, pTdt, intScheme, preferMinMaxBlend);
+#ifdef TIME_ASTRIX
+      gpuErrchk( cudaEventRecord(stop, 0) );
+      gpuErrchk( cudaEventSynchronize(stop) );
+#endif
+      gpuErrchk( cudaPeekAtLastError() );
+      gpuErrchk( cudaDeviceSynchronize() );
+    } else {
+#ifdef TIME_ASTRIX
+      gpuErrchk( cudaEventRecord(start, 0) );
+#endif
+#pragma omp parallel for
+      for (int n = 0; n < nUpdate; n++) {
+        int v = n;
+        if (pVl != 0) v = pVl[n];
+
+        AddResidueGatherSingle(v, pVt, pVtOffset, triL, vertArea, pShock,
+                               state, pTresTot, pTresN0, pTresN1, pTresN2,
+                               pTresLDA0, pTresLDA1, pTresLDA2,
+                               dt, pTdt, intScheme, preferMinMaxBlend);
+      }
+#ifdef TIME_ASTRIX
+      gpuErrchk( cudaEventRecord(stop, 0) );
+      gpuErrchk( cudaEventSynchronize(stop) );
+#endif
+    }
+  } else if (cudaFlag == 1) {
     int nThreads = 128;
     int nBlocks  = 128;
 
@@ -671,7 +1180,7 @@ void Simulation<realNeq, CL>::AddResidue(real dt)
     gpuErrchk( cudaEventRecord(start, 0) );
 #endif
     // Execute kernel...
-    devAddResidue<realNeq, CL><<<nBlocks, nThreads>>>
+    LaunchKernel(nBlocks, nThreads, devAddResidue<realNeq, CL>)
       (nTriangle, pTv, triL, vertArea, pShock, state, pTresTot,
        pTresN0, pTresN1, pTresN2, pTresLDA0, pTresLDA1, pTresLDA2,
        dt, nVertex, intScheme, preferMinMaxBlend);
@@ -685,11 +1194,19 @@ void Simulation<realNeq, CL>::AddResidue(real dt)
 #ifdef TIME_ASTRIX
     gpuErrchk( cudaEventRecord(start, 0) );
 #endif
-    for (int n = 0; n < nTriangle; n++)
-      AddResidueSingle(n, pTv, triL, vertArea, pShock, state, pTresTot,
-                       pTresN0, pTresN1, pTresN2,
-                       pTresLDA0, pTresLDA1, pTresLDA2,
-                       dt, nVertex, intScheme, preferMinMaxBlend);
+    int nColour = mesh->GetNTriangleColour();
+    const int *pTc = mesh->TriangleColourData();
+    const int *pTcOffset = mesh->TriangleColourOffsetData();
+
+    // Triangles of one colour share no vertices: no conflicts
+    for (int i = 0; i < nColour; i++) {
+#pragma omp parallel for
+      for (int j = pTcOffset[i]; j < pTcOffset[i + 1]; j++)
+        AddResidueSingle(pTc[j], pTv, triL, vertArea, pShock, state,
+                         pTresTot, pTresN0, pTresN1, pTresN2,
+                         pTresLDA0, pTresLDA1, pTresLDA2,
+                         dt, nVertex, intScheme, preferMinMaxBlend);
+    }
 #ifdef TIME_ASTRIX
     gpuErrchk( cudaEventRecord(stop, 0) );
     gpuErrchk( cudaEventSynchronize(stop) );
@@ -698,7 +1215,7 @@ void Simulation<realNeq, CL>::AddResidue(real dt)
 
 #ifdef TIME_ASTRIX
   gpuErrchk( cudaEventElapsedTime(&elapsedTime, start, stop) );
-  WriteProfileFile("AddResidual.prof2", nTriangle, elapsedTime, cudaFlag);
+  AddProfile("AddResidual", nTriangle, elapsedTime, cudaFlag);
 #endif
 }
 
@@ -711,4 +1228,15 @@ template void Simulation<real, CL_BURGERS>::AddResidue(real dt);
 template void Simulation<real3, CL_CART_ISO>::AddResidue(real dt);
 template void Simulation<real4, CL_CART_EULER>::AddResidue(real dt);
 
+//##############################################################################
+
+template void Simulation<real, CL_ADVECT>::
+AddResidue(real dt, Array<int> *vertexList);
+template void Simulation<real, CL_BURGERS>::
+AddResidue(real dt, Array<int> *vertexList);
+template void Simulation<real3, CL_CART_ISO>::
+AddResidue(real dt, Array<int> *vertexList);
+template void Simulation<real4, CL_CART_EULER>::
+AddResidue(real dt, Array<int> *vertexList);
+
 }  // namespace astrix
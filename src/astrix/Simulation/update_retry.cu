@@ -0,0 +1,548 @@
+// -*-c++-*-
+/*! \file update_retry.cu
+\brief File containing functions to build work lists for retrying an update that led to unphysical states
+
+When an update leads to an unphysical state, the LDA residue is replaced by the N residue in all triangles sharing a flagged vertex, and the update is tried again. Only the vertices of these triangles can change, so only these need to be restored and updated. The lists of triangles and vertices involved are built here, so that the cost of a retry scales with the number of unphysical vertices rather than with the size of the Mesh.
+
+Lists are built in two passes: the first counts the number of entries, the second fills the list. Entries are marked so that they are added only once; marks are reset afterwards for listed entries only.
+
+\section LICENSE
+Copyright (c) 2017 Sijme-Jan Paardekooper
+
+This file is part of Astrix.
+
+Astrix is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+
+Astrix is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Astrix.  If not, see <http://www.gnu.org/licenses/>.*/
+#include <iostream>
+
+#include "../Common/definitions.h"
+#include "../Array/array.h"
+#include "../Mesh/mesh.h"
+#include "./simulation.h"
+#include "../Common/atomic.h"
+#include "../Common/cudaLow.h"
+
+namespace astrix {
+
+//######################################################################
+/*! \brief Add vertex to list if its state is unphysical
+
+\param i Entry to consider
+\param *pVl Pointer to list of vertices to consider; if zero, consider vertex \a i
+\param *pVuf Pointer to array of flags indicating whether vertex has an unphysical state
+\param *pList Pointer to output list; if zero, only count
+\param *pCount Pointer to number of entries in list (output)*/
+//######################################################################
+
+__host__ __device__
+void SelectUnphysicalSingle(int i, const int *pVl, const int *pVuf,
+                            int *pList, int *pCount)
+{
+  int v = i;
+  if (pVl != 0) v = pVl[i];
+
+  if (pVuf[v] != 0) {
+    int j = AtomicAdd(pCount, 1);
+    if (pList != 0) pList[j] = v;
+  }
+}
+
+//######################################################################
+/*! \brief Kernel adding vertices with unphysical state to list
+
+\param nVertex Number of vertices to consider
+\param *pVl Pointer to list of vertices to consider; if zero, consider vertices 0 up to \a nVertex
+\param *pVuf Pointer to array of flags indicating whether vertex has an unphysical state
+\param *pList Pointer to output list; if zero, only count
+\param *pCount Pointer to number of entries in list (output)*/
+//######################################################################
+
+__global__ void
+devSelectUnphysical(int nVertex, const int *pVl, const int *pVuf,
+                    int *pList, int *pCount)
+{
+  int i = blockIdx.x*blockDim.x + threadIdx.x;
+
+  while (i < nVertex) {
+    SelectUnphysicalSingle(i, pVl, pVuf, pList, pCount);
+
+    i += blockDim.x*gridDim.x;
+  }
+}
+
+//######################################################################
+/*! \brief Add triangles sharing vertex \a pVl[i] to list
+
+A triangle is added only if its mark equals \a mark, after which the mark is incremented. Marks therefore go from 0 to 1 in the counting pass, and from 1 to 2 in the filling pass. With local time stepping, triangles that are not updated in the current substep are skipped.
+
+\param i Entry in vertex list to consider
+\param *pVl Pointer to list of vertices
+\param *pVt Pointer to list of triangles sharing vertices
+\param *pVtOffset Pointer to start of every vertex in \a pVt
+\param *pTdt Pointer to triangle time steps; if zero, consider all triangles
+\param *pTm Pointer to triangle marks
+\param mark Mark of triangles not yet added
+\param *pList Pointer to output list; if zero, only count
+\param *pCount Pointer to number of entries in list (output)*/
+//######################################################################
+
+__host__ __device__
+void FindRetryTrianglesSingle(int i, const int *pVl,
+                              const int *pVt, const int *pVtOffset,
+                              const real *pTdt, int *pTm, int mark,
+                              int *pList, int *pCount)
+{
+  int v = pVl[i];
+
+  for (int j = pVtOffset[v]; j < pVtOffset[v + 1]; j++) {
+    int n = pVt[j]/3;
+    if (pTdt != 0 && pTdt[n] == (real) 0.0) continue;
+
+    if (AtomicCAS(&pTm[n], mark, mark + 1) == mark) {
+      int k = AtomicAdd(pCount, 1);
+      if (pList != 0) pList[k] = n;
+    }
+  }
+}
+
+//######################################################################
+/*! \brief Kernel adding triangles sharing listed vertices to list
+
+\param nVertex Number of vertices in list
+\param *pVl Pointer to list of vertices
+\param *pVt Pointer to list of triangles sharing vertices
+\param *pVtOffset Pointer to start of every vertex in \a pVt
+\param *pTdt Pointer to triangle time steps; if zero, consider all triangles
+\param *pTm Pointer to triangle marks
+\param mark Mark of triangles not yet added
+\param *pList Pointer to output list; if zero, only count
+\param *pCount Pointer to number of entries in list (output)*/
+//######################################################################
+
+__global__ void
+devFindRetryTriangles(int nVertex, const int *pVl,
+                      const int *pVt, const int *pVtOffset,
+                      const real *pTdt, int *pTm, int mark,
+                      int *pList, int *pCount)
+{
+  int i = blockIdx.x*blockDim.x + threadIdx.x;
+
+  while (i < nVertex) {
+    FindRetryTrianglesSingle(i, pVl, pVt, pVtOffset,
+                             pTdt, pTm, mark, pList, pCount);
+
+    i += blockDim.x*gridDim.x;
+  }
+}
+
+//######################################################################
+/*! \brief Add vertices of triangle \a pTl[i] to list
+
+A vertex is added only if its mark equals \a mark, after which the mark is incremented.
+
+\param i Entry in triangle list to consider
+\param *pTl Pointer to list of triangles
+\param *pTv Pointer to triangle vertices
+\param *pVm Pointer to vertex marks
+\param mark Mark of vertices not yet added
+\param *pList Pointer to output list; if zero, only count
+\param *pCount Pointer to number of entries in list (output)*/
+//######################################################################
+
+__host__ __device__
+void FindRetryVerticesSingle(int i, const int *pTl, const int3 *pTv,
+                             int *pVm, int mark, int *pList, int *pCount)
+{
+  int n = pTl[i];
+  int V[] = {pTv[n].x, pTv[n].y, pTv[n].z};
+
+  for (int k = 0; k < 3; k++) {
+    if (AtomicCAS(&pVm[V[k]], mark, mark + 1) == mark) {
+      int j = AtomicAdd(pCount, 1);
+      if (pList != 0) pList[j] = V[k];
+    }
+  }
+}
+
+//######################################################################
+/*! \brief Kernel adding vertices of listed triangles to list
+
+\param nTriangle Number of triangles in list
+\param *pTl Pointer to list of triangles
+\param *pTv Pointer to triangle vertices
+\param *pVm Pointer to vertex marks
+\param mark Mark of vertices not yet added
+\param *pList Pointer to output list; if zero, only count
+\param *pCount Pointer to number of entries in list (output)*/
+//######################################################################
+
+__global__ void
+devFindRetryVertices(int nTriangle, const int *pTl, const int3 *pTv,
+                     int *pVm, int mark, int *pList, int *pCount)
+{
+  int i = blockIdx.x*blockDim.x + threadIdx.x;
+
+  while (i < nTriangle) {
+    FindRetryVerticesSingle(i, pTl, pTv, pVm, mark, pList, pCount);
+
+    i += blockDim.x*gridDim.x;
+  }
+}
+
+//######################################################################
+/*! \brief Kernel resetting marks of listed entries
+
+\param N Number of entries in list
+\param *pList Pointer to list
+\param *pMark Pointer to marks*/
+//######################################################################
+
+__global__ void
+devClearRetryMark(int N, const int *pList, int *pMark)
+{
+  int i = blockIdx.x*blockDim.x + threadIdx.x;
+
+  while (i < N) {
+    pMark[pList[i]] = 0;
+
+    i += blockDim.x*gridDim.x;
+  }
+}
+
+//######################################################################
+/*! \brief Kernel copying state at listed vertices
+
+\param nVertex Number of vertices in list
+\param *pVl Pointer to list of vertices
+\param *pDst Pointer to state vector to copy to (output)
+\param *pSrc Pointer to state vector to copy from*/
+//######################################################################
+
+template<class realNeq>
+__global__ void
+devCopyState(int nVertex, const int *pVl,
+             realNeq *pDst, const realNeq *pSrc)
+{
+  int i = blockIdx.x*blockDim.x + threadIdx.x;
+
+  while (i < nVertex) {
+    pDst[pVl[i]] = pSrc[pVl[i]];
+
+    i += blockDim.x*gridDim.x;
+  }
+}
+
+//######################################################################
+/*! Put all vertices with an unphysical state in \a vertexRetryList. Returns the number of vertices found.
+
+\param *vertexList List of vertices to consider; if zero, consider all vertices*/
+//######################################################################
+
+template <class realNeq, ConservationLaw CL>
+int Simulation<realNeq, CL>::SelectUnphysical(Array<int> *vertexList)
+{
+  int nVertex = mesh->GetNVertex();
+  const int *pVl = 0;
+  if (vertexList != 0) {
+    nVertex = vertexList->GetSize();
+    pVl = vertexList->GetPointer();
+  }
+
+  const int *pVuf = vertexUnphysicalFlag->GetPointer();
+
+  int nSelect = 0;
+  for (int pass = 0; pass < 2; pass++) {
+    // Count in first pass, fill list in second pass
+    int *pList = 0;
+    if (pass == 1) {
+      vertexRetryList->SetSize(nSelect);
+      pList = vertexRetryList->GetPointer();
+    }
+
+    retryCount->SetToValue(0);
+    int *pCount = retryCount->GetPointer();
+
+    if (cudaFlag == 1) {
+      int nThreads = 128;
+      int nBlocks  = 128;
+
+      // Base nThreads and nBlocks on maximum occupancy
+      cudaOccupancyMaxPotentialBlockSize(&nBlocks, &nThreads,
+                                         devSelectUnphysical,
+                                         (size_t) 0, 0);
+
+      // Execute kernel...
+      LaunchKernel(nBlocks, nThreads, devSelectUnphysical)
+        (nVertex, pVl, pVuf, pList, pCount);
+      gpuErrchk( cudaPeekAtLastError() );
+      gpuErrchk( cudaDeviceSynchronize() );
+    } else {
+      for (int i = 0; i < nVertex; i++)
+        SelectUnphysicalSingle(i, pVl, pVuf, pList, pCount);
+    }
+
+    retryCount->GetSingleValue(&nSelect, 0);
+  }
+
+  return nSelect;
+}
+
+//######################################################################
+/*! Starting from the vertices in \a vertexRetryList, put all triangles sharing these vertices in \a triangleRetryList, and all vertices of these triangles in \a vertexUpdateList.*/
+//######################################################################
+
+template <class realNeq, ConservationLaw CL>
+void Simulation<realNeq, CL>::FindRetryLists()
+{
+  int nVertex = mesh->GetNVertex();
+  int nTriangle = mesh->GetNTriangle();
+
+  // Marks are zero outside FindRetryLists; only reset if Mesh has changed
+  if ((int) triangleRetryMark->GetSize() != nTriangle) {
+    triangleRetryMark->SetSize(nTriangle);
+    triangleRetryMark->SetToValue(0);
+  }
+  if ((int) vertexRetryMark->GetSize() != nVertex) {
+    vertexRetryMark->SetSize(nVertex);
+    vertexRetryMark->SetToValue(0);
+  }
+
+  const int *pVt = mesh->VertexTriangleData();
+  const int *pVtOffset = mesh->VertexTriangleOffsetData();
+  const int3 *pTv = mesh->TriangleVerticesWrappedData();
+
+  int *pTm = triangleRetryMark->GetPointer();
+  int *pVm = vertexRetryMark->GetPointer();
+
+  // With local time stepping, only retry triangles updated in this substep
+  const real *pTdt = 0;
+  if (localTimeStepFlag == 1)
+    pTdt = triangleTimestep->GetPointer();
+
+  // Triangles sharing an unphysical vertex
+  int nRetry = vertexRetryList->GetSize();
+  const int *pVr = vertexRetryList->GetPointer();
+
+  int nRetryTriangle = 0;
+  for (int pass = 0; pass < 2; pass++) {
+    // Count in first pass, fill list in second pass
+    int *pList = 0;
+    if (pass == 1) {
+      triangleRetryList->SetSize(nRetryTriangle);
+      pList = triangleRetryList->GetPointer();
+    }
+
+    retryCount->SetToValue(0);
+    int *pCount = retryCount->GetPointer();
+
+    if (cudaFlag == 1) {
+      int nThreads = 128;
+      int nBlocks  = 128;
+
+      // Base nThreads and nBlocks on maximum occupancy
+      cudaOccupancyMaxPotentialBlockSize(&nBlocks, &nThreads,
+                                         devFindRetryTriangles,
+                                         (size_t) 0, 0);
+
+      // Execute kernel...
+      LaunchKernel(nBlocks, nThreads, devFindRetryTriangles)
+        (nRetry, pVr, pVt, pVtOffset, pTdt, pTm, pass, pList, pCount);
+      gpuErrchk( cudaPeekAtLastError() );
+      gpuErrchk( cudaDeviceSynchronize() );
+    } else {
+      for (int i = 0; i < nRetry; i++)
+        FindRetryTrianglesSingle(i, pVr, pVt, pVtOffset,
+                                 pTdt, pTm, pass, pList, pCount);
+    }
+
+    retryCount->GetSingleValue(&nRetryTriangle, 0);
+  }
+
+  // Vertices of these triangles
+  const int *pTr = triangleRetryList->GetPointer();
+
+  int nUpdate = 0;
+  for (int pass = 0; pass < 2; pass++) {
+    // Count in first pass, fill list in second pass
+    int *pList = 0;
+    if (pass == 1) {
+      vertexUpdateList->SetSize(nUpdate);
+      pList = vertexUpdateList->GetPointer();
+    }
+
+    retryCount->SetToValue(0);
+    int *pCount = retryCount->GetPointer();
+
+    if (cudaFlag == 1) {
+      int nThreads = 128;
+      int nBlocks  = 128;
+
+      // Base nThreads and nBlocks on maximum occupancy
+      cudaOccupancyMaxPotentialBlockSize(&nBlocks, &nThreads,
+                                         devFindRetryVertices,
+                                         (size_t) 0, 0);
+
+      // Execute kernel...
+      LaunchKernel(nBlocks, nThreads, devFindRetryVertices)
+        (nRetryTriangle, pTr, pTv, pVm, pass, pList, pCount);
+      gpuErrchk( cudaPeekAtLastError() );
+      gpuErrchk( cudaDeviceSynchronize() );
+    } else {
+      for (int i = 0; i < nRetryTriangle; i++)
+        FindRetryVerticesSingle(i, pTr, pTv, pVm, pass, pList, pCount);
+    }
+
+    retryCount->GetSingleValue(&nUpdate, 0);
+  }
+
+  // Reset marks of listed entries
+  const int *pVu = vertexUpdateList->GetPointer();
+
+  if (cudaFlag == 1) {
+    int nThreads = 128;
+    int nBlocks  = 128;
+
+    // Base nThreads and nBlocks on maximum occupancy
+    cudaOccupancyMaxPotentialBlockSize(&nBlocks, &nThreads,
+                                       devClearRetryMark,
+                                       (size_t) 0, 0);
+
+    // Execute kernel...
+    LaunchKernel(nBlocks, nThreads, devClearRetryMark)
+      (nRetryTriangle, pTr, pTm);
+    gpuErrchk( cudaPeekAtLastError() );
+    gpuErrchk( cudaDeviceSynchronize() );
+
+    LaunchKernel(nBlocks, nThreads, devClearRetryMark)
+      (nUpdate, pVu, pVm);
+    gpuErrchk( cudaPeekAtLastError() );
+    gpuErrchk( cudaDeviceSynchronize() );
+  } else {
+#pragma omp parallel for
+    for (int i = 0; i < nRetryTriangle; i++)
+      pTm[pTr[i]] = 0;
+#pragma omp parallel for
+    for (int i = 0; i < nUpdate; i++)
+      pVm[pVu[i]] = 0;
+  }
+}
+
+//######################################################################
+/*! Set state at vertices in \a vertexList back to \a vertexStateOld.
+
+\param *vertexList List of vertices to restore*/
+//######################################################################
+
+template <class realNeq, ConservationLaw CL>
+void Simulation<realNeq, CL>::RestoreState(Array<int> *vertexList)
+{
+  int nVertex = vertexList->GetSize();
+  const int *pVl = vertexList->GetPointer();
+
+  realNeq *pState = vertexState->GetPointer();
+  const realNeq *pStateOld = vertexStateOld->GetPointer();
+
+  if (cudaFlag == 1) {
+    int nThreads = 128;
+    int nBlocks  = 128;
+
+    // Base nThreads and nBlocks on maximum occupancy
+    cudaOccupancyMaxPotentialBlockSize(&nBlocks, &nThreads,
+                                       devCopyState<realNeq>,
+                                       (size_t) 0, 0);
+
+    // Execute kernel...
+    LaunchKernel(nBlocks, nThreads, devCopyState<realNeq>)
+      (nVertex, pVl, pState, pStateOld);
+    gpuErrchk( cudaPeekAtLastError() );
+    gpuErrchk( cudaDeviceSynchronize() );
+  } else {
+#pragma omp parallel for
+    for (int i = 0; i < nVertex; i++)
+      pState[pVl[i]] = pStateOld[pVl[i]];
+  }
+}
+
+//######################################################################
+/*! Set \a vertexStateOld equal to \a vertexState at vertices in \a vertexList.
+
+\param *vertexList List of vertices to store*/
+//######################################################################
+
+template <class realNeq, ConservationLaw CL>
+void Simulation<realNeq, CL>::StoreState(Array<int> *vertexList)
+{
+  int nVertex = vertexList->GetSize();
+  const int *pVl = vertexList->GetPointer();
+
+  const realNeq *pState = vertexState->GetPointer();
+  realNeq *pStateOld = vertexStateOld->GetPointer();
+
+  if (cudaFlag == 1) {
+    int nThreads = 128;
+    int nBlocks  = 128;
+
+    // Base nThreads and nBlocks on maximum occupancy
+    cudaOccupancyMaxPotentialBlockSize(&nBlocks, &nThreads,
+                                       devCopyState<realNeq>,
+                                       (size_t) 0, 0);
+
+    // Execute kernel...
+    LaunchKernel(nBlocks, nThreads, devCopyState<realNeq>)
+      (nVertex, pVl, pStateOld, pState);
+    gpuErrchk( cudaPeekAtLastError() );
+    gpuErrchk( cudaDeviceSynchronize() );
+  } else {
+#pragma omp parallel for
+    for (int i = 0; i < nVertex; i++)
+      pStateOld[pVl[i]] = pState[pVl[i]];
+  }
+}
+
+//##############################################################################
+// Instantiate
+//##############################################################################
+
+template int Simulation<real, CL_ADVECT>::
+SelectUnphysical(Array<int> *vertexList);
+template int Simulation<real, CL_BURGERS>::
+SelectUnphysical(Array<int> *vertexList);
+template int Simulation<real3, CL_CART_ISO>::
+SelectUnphysical(Array<int> *vertexList);
+template int Simulation<real4, CL_CART_EULER>::
+SelectUnphysical(Array<int> *vertexList);
+
+//##############################################################################
+
+template void Simulation<real, CL_ADVECT>::FindRetryLists();
+template void Simulation<real, CL_BURGERS>::FindRetryLists();
+template void Simulation<real3, CL_CART_ISO>::FindRetryLists();
+template void Simulation<real4, CL_CART_EULER>::FindRetryLists();
+
+//##############################################################################
+
+template void Simulation<real, CL_ADVECT>::
+RestoreState(Array<int> *vertexList);
+template void Simulation<real, CL_BURGERS>::
+RestoreState(Array<int> *vertexList);
+template void Simulation<real3, CL_CART_ISO>::
+RestoreState(Array<int> *vertexList);
+template void Simulation<real4, CL_CART_EULER>::
+RestoreState(Array<int> *vertexList);
+
+//##############################################################################
+
+template void Simulation<real, CL_ADVECT>::
+StoreState(Array<int> *vertexList);
+template void Simulation<real, CL_BURGERS>::
+StoreState(Array<int> *vertexList);
+template void Simulation<real3, CL_CART_ISO>::
+StoreState(Array<int> *vertexList);
+template void Simulation<real4, CL_CART_EULER>::
+StoreState(Array<int> *vertexList);
+
+}  // namespace astrix
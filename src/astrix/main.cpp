@@ -13,7 +13,7 @@ Astrix is distributed in the hope that it will be useful, but WITHOUT ANY WARRAN
 You should have received a copy of the GNU General Public License
 along with Astrix.  If not, see <http://www.gnu.org/licenses/>.*/
 
-#include <cuda_runtime_api.h>
+#include "./Common/cudaRuntime.h"
 #include <cstring>
 #include <cstdlib>
 #include <iostream>
@@ -23,6 +23,8 @@ along with Astrix.  If not, see <http://www.gnu.org/licenses/>.*/
 #include "./Common/definitions.h"
 #include "./Simulation/simulation.h"
 #include "./Device/device.h"
+#include "./Common/profile.h"
+#include "./Common/nvtxEvent.h"
 
 //###########################################################################
 // main
@@ -35,7 +37,10 @@ int main(int argc, char *argv[])
   int debugLevel = 0;                    // Level of debugging
   int nSwitches = 0;                     // Number of command line switches
   int cudaFlag = 0;                      // Flag whether to use CUDA device
+  int nThreads = 0;                      // Host threads (0: use default)
   int restartNumber = 0;                 // Save number to restart from
+  int profileInterval = 0;               // Time steps between profile dumps
+  int traceFlag = 0;                     // Flag whether to write time line
   double maxWallClockHours = 1.0e10;     // Maximum wallclock hours to run
   astrix::ConservationLaw CL =
     astrix::CL_CART_EULER;
@@ -49,6 +54,12 @@ int main(int argc, char *argv[])
       cudaFlag = 1;
       nSwitches++;
     }
+    // Set number of host threads
+    if (strcmp(argv[i], "--threads") == 0 ||
+        strcmp(argv[i], "-t") == 0) {
+      nThreads = atoi(argv[i+1]);
+      nSwitches += 2;
+    }
     // Set verbose level
     if (strcmp(argv[i], "--verbose") == 0 ||
         strcmp(argv[i], "-v") == 0) {
@@ -70,6 +81,18 @@ int main(int argc, char *argv[])
       std::cout << "Restart number: " << restartNumber << std::endl;
       nSwitches += 2;
     }
+    // Write profile every profileInterval time steps
+    if (strcmp(argv[i], "--profile") == 0 ||
+        strcmp(argv[i], "-p") == 0) {
+      profileInterval = atoi(argv[i+1]);
+      nSwitches += 2;
+    }
+    // Record time line of events
+    if (strcmp(argv[i], "--trace") == 0 ||
+        strcmp(argv[i], "-T") == 0) {
+      traceFlag = 1;
+      nSwitches++;
+    }
     // Max wall clock hours
     if (strcmp(argv[i], "--wallclocklimit") == 0 ||
         strcmp(argv[i], "-wcl") == 0) {
@@ -125,19 +148,30 @@ int main(int argc, char *argv[])
     // Print usage
     std::cout << "Usage: " << cmand.substr(found + 1)
               << " [-d]"
+              << " [-t nThreads]"
               << " [-v verboseLevel]"
               << " [-D debugLevel]"
               << " [-r restartNumber]"
+              << " [-p profileInterval]"
+              << " [-T]"
               << " [-cl conservationLaw]"
               << " filename"
               << std::endl;
     std::cout << "-d                  : run on GPU device" << std::endl;
+    std::cout << "-t nThreads         : number of threads for host computations"
+              << std::endl;
     std::cout << "-v verboseLevel     : amount of output to stdout (0 - 2)"
               << std::endl;
     std::cout << "-D debugLevel       : amount of extra checks for debugging"
               << std::endl;
     std::cout << "-r restartNumber    : try to restart from previous dump"
               << std::endl;
+    std::cout << "-p profileInterval  : write timings every profileInterval"
+              << std::endl
+              << "                      time steps (needs ASTRIX_TIMING=1)"
+              << std::endl;
+    std::cout << "-T                  : write time line to trace.json"
+              << std::endl;
     std::cout << "-cl conservationLaw : use different conservation law. Can be"
               << std::endl
               << "                      either \"advect\", \"burgers\" "
@@ -151,11 +185,14 @@ int main(int argc, char *argv[])
 
   std::cout << "Welcome to Astrix!" << std::endl;
 
+  astrix::SetProfileInterval(profileInterval);
+  if (traceFlag == 1) astrix::nvtxEvent::EnableTrace();
+
 
   // Initialise CUDA device
   astrix::Device *device;
   try {
-    device = new astrix::Device(cudaFlag);
+    device = new astrix::Device(cudaFlag, nThreads);
   }
   catch (...) {
     std::cout << "Device initialisation failed; exiting..." << std::endl;
@@ -281,6 +318,21 @@ int main(int argc, char *argv[])
     delete simulation;
   }
 
+  // Kernel timings, if compiled with TIME_ASTRIX
+  try {
+    astrix::WriteProfile("profile.json");
+  }
+  catch (...) {
+    std::cout << "Could not write profile" << std::endl;
+  }
+
+  // Time line of events, if requested
+  try {
+    astrix::nvtxEvent::WriteTrace("trace.json");
+  }
+  catch (...) {
+    std::cout << "Could not write trace" << std::endl;
+  }
 
   delete device;
 